@@ -0,0 +1,115 @@
+/*
+ * Fujisan Benchmarks - Audio Pipeline
+ *
+ * Times the work of one audio device callback the way UnifiedAudioBackend
+ * does it (ring read, mix into the float bus, resample from POKEY's rate to
+ * the device rate, volume and conversion to 16-bit), for each resampler
+ * quality, plus the emulator-side decimation of one frame of audio at
+ * fast-forward speeds. Results are per callback / per frame.
+ */
+
+#include "audiodecimator.h"
+#include "audiokernels.h"
+#include "audioresampler.h"
+#include "audioring.h"
+
+#include <QtTest/QtTest>
+#include <vector>
+
+namespace {
+
+constexpr int kChannels = 2;
+constexpr int kSourceRate = 44100;   // what libatari800 is asked for
+constexpr int kDeviceRate = 48000;
+constexpr int kDeviceFrames = 512;   // a typical SDL callback
+constexpr int kPalFrameSamples = kSourceRate / 50;
+
+std::vector<qint16> squareWave(int frames)
+{
+    std::vector<qint16> samples(frames * kChannels);
+    for (int i = 0; i < frames; ++i) {
+        const qint16 value = (i / 37) % 2 ? 8000 : -8000;  // POKEY-like square wave
+        samples[i * kChannels] = value;
+        samples[i * kChannels + 1] = qint16(value / 2);
+    }
+    return samples;
+}
+
+}  // namespace
+
+class BenchAudioPipeline : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        qInfo("sample kernels: %s", AudioKernels::instructionSet());
+    }
+
+    void benchDeviceCallback_data()
+    {
+        QTest::addColumn<int>("quality");
+        QTest::newRow("linear") << int(AudioResampler::Linear);
+        QTest::newRow("sinc") << int(AudioResampler::Sinc);
+    }
+
+    void benchDeviceCallback()
+    {
+        QFETCH(int, quality);
+        const double ratio = double(kSourceRate) / kDeviceRate;
+        AudioResampler resampler;
+        resampler.configure(kChannels, ratio, kDeviceFrames, AudioResampler::Quality(quality));
+
+        const int frameBytes = kChannels * int(sizeof(qint16));
+        const int maxInput = resampler.maxInputFrames(kDeviceFrames);
+        AudioRing ring(1 << 16);
+        const std::vector<qint16> source = squareWave(maxInput);
+        std::vector<qint16> scratch(maxInput * kChannels);
+        std::vector<float> bus(maxInput * kChannels);
+        std::vector<float> resampled(kDeviceFrames * kChannels);
+        std::vector<qint16> device(kDeviceFrames * kChannels);
+
+        QBENCHMARK {
+            const int needed = resampler.inputFramesNeeded(kDeviceFrames);
+            if (ring.available() < needed * frameBytes) {
+                ring.write(source.data(), maxInput * frameBytes);
+            }
+            const int bytes = ring.read(scratch.data(), needed * frameBytes);
+            std::fill(bus.begin(), bus.begin() + needed * kChannels, 0.0f);
+            AudioKernels::accumulateS16(scratch.data(), bus.data(), bytes / int(sizeof(qint16)), 1.0f);
+            resampler.process(bus.data(), needed, resampled.data(), kDeviceFrames);
+            AudioKernels::scaleToS16(resampled.data(), device.data(), kDeviceFrames * kChannels, 0.8f);
+        }
+    }
+
+    void benchFastForwardDecimation_data()
+    {
+        QTest::addColumn<int>("mode");
+        QTest::addColumn<double>("speed");
+        QTest::newRow("time-compress x4") << int(AudioDecimator::TimeCompress) << 4.0;
+        QTest::newRow("time-compress x16") << int(AudioDecimator::TimeCompress) << 16.0;
+        QTest::newRow("pitch-preserve x4") << int(AudioDecimator::PitchPreserve) << 4.0;
+    }
+
+    void benchFastForwardDecimation()
+    {
+        QFETCH(int, mode);
+        QFETCH(double, speed);
+        AudioDecimator decimator;
+        decimator.configure(kChannels, int(sizeof(qint16)));
+        decimator.setMode(AudioDecimator::Mode(mode));
+
+        const std::vector<qint16> frame = squareWave(kPalFrameSamples);
+        const auto* input = reinterpret_cast<const unsigned char*>(frame.data());
+        const int bytes = int(frame.size() * sizeof(qint16));
+        int produced = 0;
+        QBENCHMARK {
+            const unsigned char* output = nullptr;
+            produced += decimator.process(input, bytes, speed, &output);
+        }
+        QVERIFY(produced >= 0);
+    }
+};
+
+QTEST_GUILESS_MAIN(BenchAudioPipeline)
+#include "bench_audio_pipeline.moc"
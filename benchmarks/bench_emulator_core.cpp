@@ -0,0 +1,230 @@
+/*
+ * Fujisan Benchmarks - Emulator Core
+ *
+ * Frames per second at unlimited speed (runFramesUnpaced: no frame timer,
+ * audio or frame publishing) for three reference workloads: a BASIC loop,
+ * an ANTIC-heavy screen (full-height mode E display list, player/missile DMA
+ * and a WSYNC colour-bar kernel) and an SIO disk boot; plus frame rendering
+ * and save-state save/load.
+ *
+ * Everything runs on the built-in Altirra ROMs, so no ROM files are needed.
+ * libatari800 keeps its state in globals: one emulator serves every slot and
+ * is re-initialized per workload.
+ */
+
+#include "atariemulator.h"
+
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+
+extern "C" {
+    extern unsigned char MEMORY_mem[65536];
+}
+
+namespace {
+
+constexpr int kBootFrames = 300;       // power-on to READY / the memo pad
+constexpr int kMeasuredFrames = 3000;  // one minute of PAL emulation per workload
+constexpr int kDiskBootMaxFrames = 3000;
+constexpr int kDiskBootMarker = 0x0600;
+
+// Display list at $3000: 24 blank lines, 192 lines of mode E (160x192, 4
+// colours, 40 bytes a line) from $4000, jump and wait for VBL.
+// Code at $2000: point SDLSTL at it, turn on playfield + player/missile DMA,
+// then change COLBK on every scanline (VCOUNT -> WSYNC -> COLBK) forever.
+QByteArray anticHeavyXex()
+{
+    QByteArray displayList("\x70\x70\x70\x4E\x00\x40", 6);
+    displayList += QByteArray(191, '\x0E');
+    displayList += QByteArray("\x41\x00\x30", 3);
+
+    const QByteArray code(
+        "\xA9\x00\x8D\x30\x02"  // LDA #<DL : STA SDLSTL
+        "\xA9\x30\x8D\x31\x02"  // LDA #>DL : STA SDLSTH
+        "\xA9\x3E\x8D\x2F\x02"  // LDA #$3E : STA SDMCTL (normal playfield, PM DMA, 1-line PM)
+        "\xA9\x03\x8D\x1D\xD0"  // LDA #$03 : STA GRACTL
+        "\xAD\x0B\xD4"          // loop: LDA VCOUNT
+        "\x8D\x0A\xD4"          //       STA WSYNC
+        "\x8D\x1A\xD0"          //       STA COLBK
+        "\x4C\x14\x20",         //       JMP loop
+        32);
+
+    QByteArray screen(192 * 40, '\0');
+    for (int i = 0; i < screen.size(); ++i) {
+        screen[i] = char((i * 0x1B) & 0xFF);
+    }
+
+    auto segment = [](quint16 start, const QByteArray& data) {
+        const quint16 end = quint16(start + data.size() - 1);
+        QByteArray out;
+        out.append(char(start & 0xFF)).append(char(start >> 8));
+        out.append(char(end & 0xFF)).append(char(end >> 8));
+        return out + data;
+    };
+    QByteArray xex("\xFF\xFF", 2);
+    xex += segment(0x2000, code);
+    xex += segment(0x3000, displayList);
+    xex += segment(0x4000, screen);
+    xex += segment(0x02E0, QByteArray("\x00\x20", 2));  // RUNAD
+    return xex;
+}
+
+// 720-sector single density ATR whose boot sector asks the OS for 64 sectors
+// (8 KB, the SIO work being measured) at $0700, then stores the marker and spins.
+QByteArray bootableAtr()
+{
+    const int sectors = 720;
+    const int dataBytes = sectors * 128;
+    QByteArray image(16 + dataBytes, '\0');
+    image[0] = char(0x96);
+    image[1] = char(0x02);
+    image[2] = char((dataBytes / 16) & 0xFF);
+    image[3] = char(((dataBytes / 16) >> 8) & 0xFF);
+    image[4] = char(128);
+    image[6] = char((dataBytes / 16) >> 16);
+
+    const QByteArray boot(
+        "\x00\x40\x00\x07\x0B\x07"  // flags, 64 sectors, load $0700, DOSINI $070B
+        "\xA9\x42\x8D\x00\x06"      // $0706: LDA #$42 : STA $0600
+        "\x4C\x0B\x07",             // $070B: JMP $070B
+        14);
+    image.replace(16, boot.size(), boot);
+    for (int i = 128; i < 64 * 128; ++i) {
+        image[16 + i] = char(i & 0xFF);
+    }
+    return image;
+}
+
+}  // namespace
+
+class BenchEmulatorCore : public QObject {
+    Q_OBJECT
+
+private:
+    AtariEmulator* m_emulator = nullptr;
+    QTemporaryDir m_tempDir;
+
+    bool boot(bool basic)
+    {
+        m_emulator->setAltirraOSEnabled(true);
+        m_emulator->setAltirraBASICEnabled(true);
+        if (!m_emulator->initializeWithConfig(basic, QStringLiteral("-xl"), QStringLiteral("-pal"),
+                                              QStringLiteral("none"))) {
+            return false;
+        }
+        return m_emulator->runFramesUnpaced(kBootFrames) == kBootFrames;
+    }
+
+    // Frames per second of the current workload, reported as the benchmark result
+    void measureFrames()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        const int frames = m_emulator->runFramesUnpaced(kMeasuredFrames);
+        const qint64 elapsedNs = qMax<qint64>(1, timer.nsecsElapsed());
+        QCOMPARE(frames, kMeasuredFrames);
+        const qreal fps = frames * 1e9 / elapsedNs;
+        qInfo("%d frames in %.1f ms: %.0f fps, %.1fx real time", frames, elapsedNs / 1e6, fps,
+              fps * m_emulator->getFrameTimeMs() / 1000.0);
+        QTest::setBenchmarkResult(fps, QTest::FramesPerSecond);
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_tempDir.isValid());
+        m_emulator = new AtariEmulator(nullptr);
+        m_emulator->setDeferTimerStart(true);  // frames are driven by the benchmarks only
+        m_emulator->enableAudio(false);
+    }
+
+    void cleanupTestCase()
+    {
+        m_emulator->shutdown();
+        delete m_emulator;
+        m_emulator = nullptr;
+    }
+
+    void benchBasicLoop()
+    {
+        QVERIFY(boot(true));
+        // Typed through the key queue, like a paste; processFrame() types it
+        m_emulator->queueText("10 FOR I=1 TO 200:A=SIN(I)*I:B$=STR$(A):NEXT I:GOTO 10\nRUN\n");
+        for (int i = 0; i < 2000 && !m_emulator->isCharacterInjectionIdle(); ++i) {
+            m_emulator->processFrame();
+        }
+        QVERIFY2(m_emulator->isCharacterInjectionIdle(), "program was not typed in");
+        measureFrames();
+    }
+
+    void benchAnticHeavy()
+    {
+        QVERIFY(boot(false));
+        QString error;
+        QVERIFY2(m_emulator->fastLoadXex(anticHeavyXex(), &error), qPrintable(error));
+        measureFrames();
+    }
+
+    void benchSioDiskBoot()
+    {
+        QVERIFY(boot(false));
+        const QString path = m_tempDir.filePath("boot.atr");
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(bootableAtr());
+        file.close();
+        QVERIFY(m_emulator->mountDiskImage(1, path, true));
+
+        int frames = 0;
+        QBENCHMARK {
+            MEMORY_mem[kDiskBootMarker] = 0;
+            m_emulator->coldRestart();
+            frames = 0;
+            while (frames < kDiskBootMaxFrames && MEMORY_mem[kDiskBootMarker] != 0x42) {
+                if (m_emulator->runFramesUnpaced(1) == 0) {
+                    break;
+                }
+                ++frames;
+            }
+        }
+        QVERIFY2(MEMORY_mem[kDiskBootMarker] == 0x42, "disk did not boot");
+        qInfo("boot took %d emulated frames", frames);
+        m_emulator->dismountDiskImage(1);
+    }
+
+    void benchRenderFrame()
+    {
+        QVERIFY(boot(false));
+        QString error;
+        QVERIFY2(m_emulator->fastLoadXex(anticHeavyXex(), &error), qPrintable(error));
+        m_emulator->runFramesUnpaced(10);
+        // renderCurrentFrame() is renderFrameImage() into a new 384x240 RGB32 image
+        QImage image;
+        QBENCHMARK {
+            image = m_emulator->renderCurrentFrame();
+        }
+        QCOMPARE(image.size(), QSize(384, 240));
+    }
+
+    void benchStateSave()
+    {
+        QVERIFY(boot(true));
+        const QString path = m_tempDir.filePath("bench.a8s");
+        QBENCHMARK {
+            QVERIFY(m_emulator->saveState(path));
+        }
+    }
+
+    void benchStateLoad()
+    {
+        const QString path = m_tempDir.filePath("bench.a8s");
+        QVERIFY(QFile::exists(path));
+        QBENCHMARK {
+            QVERIFY(m_emulator->loadState(path));
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(BenchEmulatorCore)
+#include "bench_emulator_core.moc"
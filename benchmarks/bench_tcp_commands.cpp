@@ -0,0 +1,177 @@
+/*
+ * Fujisan Benchmarks - TCP Command Throughput
+ *
+ * Round-trip time of JSON API commands against a real (hidden) MainWindow
+ * and TCP server on an ephemeral port: one request at a time, a burst of
+ * pipelined requests, and the same burst as one "batch" request. Settings go
+ * to a temporary INI so the user's configuration is neither read nor changed.
+ */
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSettings>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+#include "mainwindow.h"
+#include "tcpserver.h"
+
+namespace {
+constexpr int kBurst = 100;
+constexpr int kTimeoutMs = 20000;
+}
+
+class BenchTcpCommands : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_tempDir;
+    QByteArray m_readBuffer;
+    MainWindow* m_mainWindow = nullptr;
+    TCPServer* m_tcp = nullptr;
+    QTcpSocket* m_socket = nullptr;
+    int m_nextId = 0;
+
+    static QByteArray request(const QString& command, const QString& id,
+                              const QJsonObject& params = QJsonObject())
+    {
+        QJsonObject req;
+        req["command"] = command;
+        req["id"] = id;
+        if (!params.isEmpty()) {
+            req["params"] = params;
+        }
+        return QJsonDocument(req).toJson(QJsonDocument::Compact) + "\n";
+    }
+
+    // Reads until `count` responses have arrived (events are skipped)
+    bool waitForResponses(int count)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        while (count > 0 && timer.elapsed() < kTimeoutMs) {
+            QCoreApplication::processEvents();
+            if (m_socket->bytesAvailable() > 0 || m_socket->waitForReadyRead(5)) {
+                m_readBuffer += m_socket->readAll();
+            }
+            int nl;
+            while (count > 0 && (nl = m_readBuffer.indexOf('\n')) >= 0) {
+                const QJsonObject o = QJsonDocument::fromJson(m_readBuffer.left(nl)).object();
+                m_readBuffer.remove(0, nl + 1);
+                if (o.value("type").toString() == "response") {
+                    if (o.value("status").toString() != "success") {
+                        qWarning() << "command failed:" << o;
+                        return false;
+                    }
+                    --count;
+                }
+            }
+        }
+        return count == 0;
+    }
+
+    bool roundTrip(const QString& command, const QJsonObject& params = QJsonObject())
+    {
+        m_socket->write(request(command, QString::number(m_nextId++), params));
+        return waitForResponses(1);
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_tempDir.isValid());
+        QCoreApplication::setOrganizationName("8bitrelics");
+        QCoreApplication::setApplicationName("Fujisan");
+        QSettings::setDefaultFormat(QSettings::IniFormat);
+        QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, m_tempDir.path());
+        {
+            QSettings s;
+            s.setValue("emulator/tcpServerEnabled", false);
+            s.sync();
+        }
+
+        m_mainWindow = new MainWindow();
+        m_mainWindow->hide();
+        m_tcp = m_mainWindow->findChild<TCPServer*>();
+        QVERIFY(m_tcp);
+        QVERIFY(m_tcp->startServer(0));
+
+        m_socket = new QTcpSocket();
+        m_socket->connectToHost(QHostAddress::LocalHost, m_tcp->serverPort());
+        QElapsedTimer timer;
+        timer.start();
+        while (m_socket->state() != QAbstractSocket::ConnectedState && timer.elapsed() < kTimeoutMs) {
+            QCoreApplication::processEvents();
+            m_socket->waitForConnected(50);
+        }
+        QCOMPARE(m_socket->state(), QAbstractSocket::ConnectedState);
+        // Let the emulator boot and the welcome event arrive before timing anything
+        QVERIFY(roundTrip("status.get_state"));
+    }
+
+    void cleanupTestCase()
+    {
+        if (m_socket) {
+            m_socket->disconnectFromHost();
+            delete m_socket;
+            m_socket = nullptr;
+        }
+        if (m_tcp && m_tcp->isRunning()) {
+            m_tcp->stopServer();
+        }
+        delete m_mainWindow;
+        m_mainWindow = nullptr;
+    }
+
+    void benchRoundTrip_data()
+    {
+        QTest::addColumn<QString>("command");
+        QTest::addColumn<QJsonObject>("params");
+        QTest::newRow("status.get_state") << QString("status.get_state") << QJsonObject();
+        QTest::newRow("system.get_speed") << QString("system.get_speed") << QJsonObject();
+        QTest::newRow("debug.read_memory 256") << QString("debug.read_memory")
+                                               << QJsonObject{{"address", 0x0600}, {"length", 256}};
+    }
+
+    void benchRoundTrip()
+    {
+        QFETCH(QString, command);
+        QFETCH(QJsonObject, params);
+        QBENCHMARK {
+            QVERIFY(roundTrip(command, params));
+        }
+    }
+
+    void benchPipelinedBurst()
+    {
+        QByteArray burst;
+        for (int i = 0; i < kBurst; ++i) {
+            burst += request("system.get_speed", QString("p%1").arg(i));
+        }
+        QBENCHMARK {
+            m_socket->write(burst);
+            QVERIFY(waitForResponses(kBurst));
+        }
+    }
+
+    void benchBatchRequest()
+    {
+        QJsonArray commands;
+        for (int i = 0; i < kBurst; ++i) {
+            commands.append(QJsonObject{{"command", "system.get_speed"}, {"id", QString("b%1").arg(i)}});
+        }
+        const QByteArray batch = request("batch", "batch", QJsonObject{{"commands", commands}});
+        QBENCHMARK {
+            m_socket->write(batch);
+            QVERIFY(waitForResponses(1));
+        }
+    }
+};
+
+QTEST_MAIN(BenchTcpCommands)
+#include "bench_tcp_commands.moc"
@@ -0,0 +1,66 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef ACCESSTRACERING_H
+#define ACCESSTRACERING_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <atomic>
+#include <vector>
+
+// One memory access reported by a watchpoint.
+struct AccessTraceEntry {
+    quint64 frame;     // emulated frame number the access happened in
+    quint16 pc;        // address of the instruction
+    quint16 address;   // accessed address (== pc for execute)
+    quint8 access;     // AccessRead | AccessWrite | AccessExecute
+    quint8 value;      // byte stored for writes, current byte otherwise
+};
+
+// Fixed-size single-producer/single-consumer ring for the watchpoint trace.
+//
+// The emulator thread push()es from inside the CPU callback; another thread
+// (e.g. the TCP server) drain()s in bulk. No locks and no allocation after
+// construction. When the consumer falls behind, new entries are dropped and
+// counted rather than overwriting unread ones.
+class AccessTraceRing
+{
+public:
+    enum Access : quint8 {
+        AccessRead = 1,
+        AccessWrite = 2,
+        AccessExecute = 4
+    };
+
+    /// capacity is rounded up to a power of two.
+    explicit AccessTraceRing(int capacity = 65536);
+
+    // Producer side
+    bool push(const AccessTraceEntry& entry);
+
+    // Consumer side
+    /// Remove and return up to maxEntries of the oldest entries.
+    QVector<AccessTraceEntry> drain(int maxEntries);
+    /// Discard everything currently queued.
+    void clear();
+
+    int capacity() const { return static_cast<int>(m_entries.size()); }
+    int size() const;
+    /// Entries lost because the ring was full; reset by takeDropped().
+    quint64 dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    quint64 takeDropped() { return m_dropped.exchange(0, std::memory_order_relaxed); }
+
+private:
+    std::vector<AccessTraceEntry> m_entries;
+    quint32 m_mask;
+    std::atomic<quint32> m_head{0};  // next write, owned by the producer
+    std::atomic<quint32> m_tail{0};  // next read, owned by the consumer
+    std::atomic<quint64> m_dropped{0};
+};
+
+#endif // ACCESSTRACERING_H
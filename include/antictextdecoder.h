@@ -0,0 +1,47 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef ANTICTEXTDECODER_H
+#define ANTICTEXTDECODER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+// Reads the text on screen the way ANTIC fetches it: walks the display list in
+// the 64 KB address space, follows LMS and jump instructions, and turns the
+// character codes of every text mode line (ANTIC 2-7, i.e. GRAPHICS 0, 1 and 2
+// plus the 4-colour and 10-scanline modes) into ATASCII text. Graphics mode
+// lines are skipped but still advance the screen memory counter, so text below
+// a graphics window is found. Cheap enough to run every frame.
+class AnticTextDecoder
+{
+public:
+    struct Line {
+        int mode = 0;            // ANTIC mode, 2-7
+        int scanline = 0;        // first scan line, counted from the top of the display list
+        quint16 address = 0;     // screen memory of the line
+        QByteArray codes;        // internal character codes as fetched, inverse bit included
+        QString text;            // printable ATASCII; graphics characters become spaces
+    };
+
+    /// Decode the display list at displayList. dmactl supplies the playfield
+    /// width (bits 0-1: narrow, normal, wide); 0 (DMA off) yields no lines.
+    static QVector<Line> decode(const unsigned char* memory, quint16 displayList, int dmactl);
+
+    /// The ATASCII character an internal screen code shows in an ANTIC mode;
+    /// modes 6 and 7 use the top two bits for colour instead of inverse.
+    static unsigned char internalToAtascii(unsigned char code, int mode);
+    /// ATASCII as text: printable ASCII stays, everything else becomes a space.
+    static QChar atasciiToChar(unsigned char atascii);
+
+private:
+    static int bytesPerLine(int mode, int width);
+    static int scanlinesPerLine(int mode);
+};
+
+#endif // ANTICTEXTDECODER_H
@@ -22,10 +22,37 @@
 #include <QBuffer>
 #include <functional>
 #include <QSet>
+#include <QMap>
+#include <QJsonArray>
 #include <QJsonObject>
 #include <QMutex>
 #include <QImage>
+#include <QVector>
 #include <atomic>
+#include "frameexchange.h"
+#include "rewindbuffer.h"
+#include "statefileworker.h"
+#include "accesstracering.h"
+#include "audiodecimator.h"
+#include "audioring.h"
+#include "audiotelemetry.h"
+#include "antictextdecoder.h"
+#include "sharedstateregion.h"
+#include "mediarecorder.h"
+#include "codeanalyzer.h"
+#include "inputlatencymonitor.h"
+#include "tracerecorder.h"
+#include "cycleprofiler.h"
+#include "diskimagecache.h"
+#include "romimagecache.h"
+#include "inputmovie.h"
+#include "framechecksumstream.h"
+#include "latencyhistogram.h"
+#include "threadscheduling.h"
+#include "tapeaccelerator.h"
+#include "machinesnapshot.h"
+#include "performancemonitor.h"
+#include <memory>
 
 #ifdef HAVE_SDL2_AUDIO
 // Forward declaration to avoid including SDL headers here
@@ -129,12 +156,30 @@ extern "C" {
     extern int Devices_SetPrintCommand(const char *command);
     // State save functions
     #include "statesav.h"
+    // Cassette recorder (C: device and the SIO patch's tape path)
+    #include "cassette.h"
+    // PIA port control; PACTL bit 3 low runs the cassette motor
+    extern unsigned char PIA_PACTL;
     
     // Disk activity callback function
     extern void libatari800_set_disk_activity_callback(void (*callback)(int drive, int operation));
     
     // Single-instruction stepping for debugger
     extern void libatari800_step_instruction(void);
+
+    // Instruction-precise breakpoints (patch 0019)
+    extern void libatari800_set_breakpoint_map(const unsigned char *map);
+    extern int libatari800_get_breakpoint_halt(void);
+    extern void libatari800_clear_breakpoint_halt(int skip_current);
+    // Memory watchpoints (patch 0020)
+    extern void libatari800_set_watch_map(const unsigned char *map,
+                                          int (*callback)(unsigned short pc, unsigned short addr,
+                                                          int access, unsigned char value));
+    // XE extended RAM banks (patch 0021)
+    extern unsigned char* libatari800_get_xe_memory(int *bank_count, int *current_bank);
+    // Instruction trace (patch 0022)
+    extern void libatari800_set_trace_buffer(void *buf, int capacity, int lo, int hi);
+    extern int libatari800_take_trace(int *overflow);
     
     // NOTE: libatari800_exit and Atari800_InitialiseMachine are already declared
     // in libatari800.h and atari.h respectively, so we don't redeclare them here
@@ -183,8 +228,37 @@ public:
     bool mountDiskImage(int driveNumber, const QString& filename, bool readOnly = false);
     void dismountDiskImage(int driveNumber);
     void disableDrive(int driveNumber);
+    /// Copy-on-write for a drive: from its next mount on, the image is served from
+    /// DiskImageCache through a scratch copy, so the machine's writes never reach the
+    /// host file unless commitDiskOverlay() is called. Off by default.
+    void setDiskOverlayEnabled(int driveNumber, bool enabled);
+    bool isDiskOverlayEnabled(int driveNumber) const;
+    bool hasDiskOverlay(int driveNumber) const { return m_diskCache.hasOverlay(driveNumber); }
+    /// Whether an overlaid drive differs from its image, and which 1-based sectors do,
+    /// as of the core's last completed sector access.
+    bool diskOverlayChanged(int driveNumber) const { return m_diskCache.overlayChanged(driveNumber); }
+    QVector<int> diskOverlayChangedSectors(int driveNumber) const { return m_diskCache.changedSectors(driveNumber); }
+    QByteArray diskOverlaySector(int driveNumber, int sector) const { return m_diskCache.overlaySector(driveNumber, sector); }
+    /// Unmounts an overlaid drive and writes its changes back to the image, leaving
+    /// the drive empty. Fails, with the drive untouched, when it has no overlay.
+    bool commitDiskOverlay(int driveNumber, QString* error = nullptr);
     Q_INVOKABLE void coldRestart();
     QString getDiskImagePath(int driveNumber) const;
+
+    // Cassette recorder (C:)
+    /// Insert a CAS or raw tape image. bootTape cold boots with START held and
+    /// SPACE pressed at the beep, so the OS boots from the tape.
+    Q_INVOKABLE bool insertCassette(const QString& filename, bool readOnly = false, bool bootTape = false);
+    Q_INVOKABLE void ejectCassette();
+    QString getCassettePath() const { return m_cassettePath; }
+    /// path, position and size (in blocks), motor, recording, and tape_acceleration:
+    /// TapeAccelerator::status() plus "enabled".
+    Q_INVOKABLE QJsonObject getCassetteStatus() const;
+    /// While a tape loads through the cassette port (see TapeAccelerator), run at
+    /// unlimited speed without sound or video (a speed boost, see setEmulationSpeed()).
+    /// Thread-safe; on by default ("machine/tapeAcceleration").
+    void setTapeAccelerationEnabled(bool enabled);
+    bool isTapeAccelerationEnabled() const { return m_tapeAccelerationEnabled.load(std::memory_order_relaxed); }
     
     // Printer functions
     void setPrinterEnabled(bool enabled);
@@ -241,6 +315,16 @@ public:
     /// netsio_recv_byte() / select() so finalizeShutdown can run (requires atari800 0018 patch).
     /// Safe to call even when NetSIO is toggled off: netsio_shutdown() is a no-op if uninitialized.
     void netsioShutdownFromOtherThreadForQuit();
+    /// NetSIO link health for status.get_netsio: whether FujiNet-PC is heard, the
+    /// sync round-trip estimate and adaptive timeout, and how long SIO waits have
+    /// stalled the emulation thread (atari800 0024/0025 patches). Safe from any thread.
+    QJsonObject netsioLinkStatus() const;
+    /// The settings libatari800 was last initialised with (its argv, plus the ROM
+    /// and NetSIO/R-Time choices). Empty until the first successful init.
+    QJsonObject bootConfig() const { return m_bootConfig; }
+    /// Boot settings changed through the setters since that init (machine, video
+    /// system, BASIC, Altirra ROMs, ROM paths): only these need a restart.
+    QStringList pendingRestartChanges() const;
     void setDeferTimerStart(bool defer) { m_deferTimerStart = defer; }
     void startDeferredTimers();
     Q_INVOKABLE bool shouldAutoColdBootForFujiNet();
@@ -261,11 +345,16 @@ public:
     
     QString getVideoSystem() const { return m_videoSystem; }
     void setVideoSystem(const QString& videoSystem) { m_videoSystem = videoSystem; }
+    /// The speed the machine runs at: 0 (unlimited) while a speed boost is active.
     int getCurrentEmulationSpeed() const;
 
     /// True after a successful libatari800_init() until shutdown() clears the core.
     /// Used to avoid deferred Qt callbacks touching lib globals after libatari800_exit().
     bool isLibatari800Initialized() const { return m_libatari800Initialized; }
+    /// The instance that has libatari800 initialized, or nullptr. The core keeps its
+    /// machine in process globals, so a second instance fails to initialize until the
+    /// owner shuts down; separate machines need separate processes.
+    static AtariEmulator* coreOwner();
     
     QString getOSRomPath() const { return m_osRomPath; }
     void setOSRomPath(const QString& path) { m_osRomPath = path; }
@@ -273,6 +362,15 @@ public:
     QString getBasicRomPath() const { return m_basicRomPath; }
     void setBasicRomPath(const QString& path) { m_basicRomPath = path; }
     
+    /// OS, BASIC and cartridge images are handed to the core from a content-addressed
+    /// store in this directory (see RomImageCache); empty turns it off. Defaults to
+    /// $FUJISAN_ROM_CACHE. Takes effect at the next initialization or cartridge insert.
+    void setRomImageCacheDirectory(const QString& directory) { m_romImageCache.setDirectory(directory); }
+    const RomImageCache& romImageCache() const { return m_romImageCache; }
+    /// Hashes already known from the media library (see RomImageCache::addKnownImage()).
+    /// Same thread as the cache itself; returns how many were usable.
+    Q_INVOKABLE int addKnownRomImages(const QJsonArray& images);
+    
     // Joystick keyboard emulation settings
     bool isKbdJoy0Enabled() const { return m_kbdJoy0Enabled; }
     void setKbdJoy0Enabled(bool enabled);
@@ -281,7 +379,7 @@ public:
     void setKbdJoy1Enabled(bool enabled);
     
     bool isJoysticksSwapped() const { return m_swapJoysticks; }
-    void setJoysticksSwapped(bool swapped) { m_swapJoysticks = swapped; }
+    void setJoysticksSwapped(bool swapped) { m_swapJoysticks = swapped; resolveJoystickPorts(); }
 
     void setJoystick0Preset(const QString& preset);
     void setJoystick1Preset(const QString& preset);
@@ -309,6 +407,16 @@ public slots:
     
     float getTargetFPS() const { return m_targetFps; }
     float getFrameTimeMs() const { return m_frameTimeMs; }
+    /// V-sync frame pacing: when refreshHz is within kRefreshLockTolerance of the
+    /// machine's frame rate (59.92 Hz NTSC on a 60 Hz panel), frames are timed at
+    /// refreshHz instead, so each one lines up with a display refresh. The unified
+    /// audio backend's drift compensation resamples the small difference away.
+    /// 0 turns it off. Emulator thread.
+    Q_INVOKABLE void setDisplayRefreshLock(double refreshHz);
+    /// Rate frames are timed at before the speed multiplier: the display's while
+    /// locked to it, otherwise getTargetFPS().
+    double pacedFps() const;
+    bool isRefreshLocked() const { return pacedFps() != static_cast<double>(m_targetFps > 0 ? m_targetFps : 50); }
     
     // Joystick control methods for TCP server
     void setJoystickState(int player, int direction, bool fire);
@@ -318,13 +426,67 @@ public slots:
     int getJoystickState(int player) const;
     bool getJoystickFire(int player) const;
     QJsonObject getAllJoystickStates() const;
+    /// Name of a libatari800 (inverted) stick value, e.g. "UP_LEFT"; "UNKNOWN_<n>" otherwise.
+    static QString joystickDirectionName(int value);
+
+    // Bits of the keys/previousKeys arguments of consoleInputChanged()
+    enum ConsoleKey {
+        ConsoleStart = 1,
+        ConsoleSelect = 2,
+        ConsoleOption = 4
+    };
     
-    // State save/load methods
+    // State save/load methods. saveState()/loadState() block until the file is done;
+    // the async variants snapshot (or apply) on the emulator thread and leave compression
+    // and file I/O to a worker thread, then emit stateSaved()/stateLoaded().
     Q_INVOKABLE bool saveState(const QString& filename);
     Q_INVOKABLE bool loadState(const QString& filename);
+    Q_INVOKABLE void saveStateAsync(const QString& filename);
+    Q_INVOKABLE void loadStateAsync(const QString& filename);
+    /// Asynchronous; false only if there is nothing to load. Completion via stateSaved()/stateLoaded().
     Q_INVOKABLE bool quickSaveState();
     Q_INVOKABLE bool quickLoadState();
+
+    // In-memory rewind history (see RewindBuffer). Snapshots are taken every
+    // intervalFrames frames on the emulator thread into a preallocated budget.
+    Q_INVOKABLE void configureRewind(bool enabled, int intervalFrames, int budgetMB);
+    bool isRewindEnabled() const { return m_rewindBuffer != nullptr; }
+    /// Restore the newest snapshot at least `frames` frames old (0 = newest snapshot).
+    /// Must run on the emulator thread.
+    Q_INVOKABLE bool rewindFrames(int frames);
+    /// Restore the snapshot `steps` snapshots back (1 = the one before the newest).
+    Q_INVOKABLE bool rewindSteps(int steps);
+    Q_INVOKABLE QJsonObject getRewindStatus() const;
+
+    // Run-ahead: each frame is followed by `frames` silent frames with the same
+    // input whose screen is shown, then the state is restored, hiding the
+    // game's own input lag. Thread-safe; 0 turns it off (max kMaxRunAheadFrames).
+    static constexpr int kMaxRunAheadFrames = 4;
+    void setRunAheadFrames(int frames);
+    int runAheadFrames() const { return m_runAheadFrames.load(std::memory_order_relaxed); }
+    /// frames and active (false while suppressed, e.g. by turbo, NetSIO, breakpoints or
+    /// an attached disk, cartridge or cassette).
+    QJsonObject getRunAheadStatus() const;
+    /// Called for every SIO disk access (emulator thread). Records the drive's last
+    /// access; ignored while running ahead.
+    void noteDiskActivity(int drive, bool writing);
+    /// True if drive (1-8) was accessed in the last holdMs milliseconds; writing tells
+    /// whether that access was a write. Lock-free, meant to be polled by the GUI.
+    bool driveActivity(int drive, int holdMs, bool* writing = nullptr) const;
     QString getQuickSaveStatePath() const;
+    QString getHibernatePath() const;
+    /// Instant resume: write the current machine (see HibernateImage) together with
+    /// the boot settings, mounted media and profile it depends on. Emulator thread.
+    Q_INVOKABLE bool hibernate(const QString& path);
+    /// Restore a hibernate image from its memory mapping, in place of the boot
+    /// that has just started, if it was written with the same boot settings, media
+    /// and profile that are in effect now. The image is deleted first either way,
+    /// so a bad one cannot fail every launch. Emulator thread; returns "resumed",
+    /// and "reason" when it did not.
+    Q_INVOKABLE QJsonObject resumeFromHibernation(const QString& path);
+    /// Have finalizeShutdownOnWorkerAndRehomeToGui() hibernate to getHibernatePath().
+    /// Set from the GUI thread right before queuing it.
+    void setHibernateOnQuit(bool enabled) { m_hibernateOnQuit = enabled; }
     void setCurrentProfileName(const QString& profileName) { m_currentProfileName = profileName; }
     QString getCurrentProfileName() const { return m_currentProfileName; }
     
@@ -336,16 +498,171 @@ public slots:
     // FUTURE: Scanlines methods (commented out - not working)
     // bool needsScanlineRestart() const;
     
-    // Speed control
+    // Speed control: the user's speed. While a speed boost (turbo paste, tape
+    // load) is active the machine runs unlimited instead, and returns to the
+    // user's speed as of the moment the last boost ends.
     void setEmulationSpeed(int percentage);
-    void setAudioDiagnosticsEnabled(bool enabled) { m_enableAudioDiagnostics = enabled; }
+    /// Write the audio telemetry ring to audio_diagnostics.csv (in the app data
+    /// directory) from a background thread. The ring itself is always recorded.
+    void setAudioDiagnosticsEnabled(bool enabled);
+    /// Per-frame audio timing samples (see AudioTelemetryRing); readable from any thread.
+    const AudioTelemetryRing& audioTelemetry() const { return m_audioTelemetry; }
+    /// Input-to-frame and input-to-paint latency (see InputLatencyMonitor); thread-safe.
+    InputLatencyMonitor& inputLatency() { return m_inputLatency; }
+    /// Per-frame timing, audio and SIO counters (see PerformanceMonitor); lock-free.
+    PerformanceMonitor& performance() { return m_performance; }
+    /// Audio-master pacing: at normal speed, run a frame whenever the unified audio
+    /// backend's device has drained its ring to the target instead of on the frame
+    /// timer. Switches to the unified backend (SDL2 builds only).
+    void setAudioMasterSync(bool enabled);
+    bool isAudioMasterSync() const { return m_audioMasterSync; }
+    /// Emulator thread scheduling: priority (ThreadScheduling::Priority), CPU to pin
+    /// to (-1 for any) and precise timing, where the frame timer is started up to
+    /// kPreciseWakeMarginMs early and processFrame() waits out the rest with
+    /// ThreadScheduling::waitUntil(). Emulator thread; returns what the OS granted.
+    Q_INVOKABLE QJsonObject setThreadScheduling(int priority, int cpu, bool preciseTiming);
+    Q_INVOKABLE QJsonObject threadSchedulingStatus() const;
+    /// setThreadScheduling() from "emulator/threadPriority", "emulator/cpuAffinity"
+    /// and "emulator/preciseTiming".
+    Q_INVOKABLE void applyThreadSchedulingSetting();
+    /// How far timer-paced frames started after their deadline ("lateness") and
+    /// the time between consecutive ones ("interval"), as latency histograms, with
+    /// counts of late (over kLateFrameUs) and missed (over a whole frame) frames.
+    /// Emulator thread.
+    Q_INVOKABLE QJsonObject framePacingStatus() const;
+    Q_INVOKABLE void resetFramePacing();
+    static constexpr int kPreciseWakeMarginMs = 2;
+    static constexpr int kLateFrameUs = 1000;
+
+    /// Triple buffer holding the rendered frames. The emulator thread publishes into it;
+    /// the GUI thread calls acquire()/frontBuffer() after frameReady().
+    FrameExchange* frameExchange() { return &m_frameExchange; }
+    /// Same as frameExchange() but holding the raw Format_Indexed8 screen with the current
+    /// palette as colorTable(); only filled while indexed output is enabled (GPU path).
+    FrameExchange* indexedFrameExchange() { return &m_indexedFrameExchange; }
+    /// Indexed frames for the TCP screen stream, published every interval-th frame with
+    /// the emulated frame number as sequence; 0 (the default) stops publishing.
+    FrameExchange* screenStreamExchange() { return &m_screenStreamExchange; }
+    /// Above 1x, frames are rendered and published to frameExchange() at most this many
+    /// times per second (the display refresh rate); the others are skipped before any
+    /// conversion. Thread-safe; defaults to 60 Hz.
+    void setPresentationRate(double hz);
+    double presentationRate() const;
+    /// Emulated frames that were not presented because of the rate limit.
+    quint64 skippedPresentations() const { return m_skippedPresentations.load(std::memory_order_relaxed); }
+    /// Frames not published because no pixel changed since the last presented frame.
+    quint64 unchangedFrames() const { return m_unchangedFrames.load(std::memory_order_relaxed); }
+    void setScreenStreamInterval(int frames) { m_screenStreamInterval.store(qMax(0, frames)); }
+    int screenStreamInterval() const { return m_screenStreamInterval.load(); }
+    /// While enabled, every frame's POKEY audio (before turbo decimation) is also
+    /// copied into a ring for the remote screen stream. Safe to call from any thread.
+    void setStreamAudio(bool enabled) { m_streamAudio.store(enabled); }
+    /// Reader side of that ring (one thread only): appends everything buffered to
+    /// pcm and returns the number of bytes read.
+    int readStreamAudio(QByteArray& pcm);
+    /// Bytes the emulator could not put in the ring because nobody drained it.
+    quint64 streamAudioOverrunBytes() const { return m_streamAudioOverrunBytes.load(std::memory_order_relaxed); }
+    /// sample_rate, channels and bits_per_sample of the audio above.
+    QJsonObject streamAudioFormat() const;
+    /// Emit joystickInputChanged()/consoleInputChanged() whenever the input a frame runs
+    /// with differs from the previous frame's. Off by default; safe to call from any thread.
+    void setInputChangeReporting(bool enabled) { m_inputChangeReporting.store(enabled); }
+    /// Publish frame number, registers, screen, palette and the given RAM ranges
+    /// ([{address, length}]) to a memory-mapped file at path after every frame,
+    /// replacing any region already open. Returns its layout, or {"error": ...}.
+    Q_INVOKABLE QJsonObject openSharedState(const QString& path, const QJsonArray& ranges);
+    Q_INVOKABLE void closeSharedState();
+    /// Layout of the open region; empty while none is open.
+    Q_INVOKABLE QJsonObject sharedStateLayout() const;
+    /// Text mode lines of the display list ANTIC is showing (AnticTextDecoder), read
+    /// on the emulator thread: rows, text, display_list and, with detail, per-line
+    /// mode, scan line, address and codes. A displayList of -1 uses ANTIC's current one.
+    Q_INVOKABLE QJsonObject getScreenText(int displayList, bool detail);
+    /// Emit screenTextChanged() after every frame whose text differs from the
+    /// previous one; the first frame after switching on always reports.
+    void setScreenTextEvents(bool enabled) { m_screenTextEvents.store(enabled); }
+    /// Copy of the current screen as Format_Indexed8 with the palette as colour table.
+    Q_INVOKABLE QImage renderIndexedScreen();
+    /// The core's own screenshot writer (PCX/PNG by extension, interlaced over two
+    /// frames), emulator thread only so it never reads a frame being drawn.
+    Q_INVOKABLE bool saveCoreScreenshot(const QString& path, bool interlaced);
+    /// Record every emulated frame and its POKEY audio (before turbo decimation)
+    /// to an AVI file at path, encoded off the emulator thread (MediaRecorder).
+    /// Returns recordingStatus(), or {"error": ...}.
+    Q_INVOKABLE QJsonObject startRecording(const QString& path);
+    /// Finish the file(s); returns the final recordingStatus().
+    Q_INVOKABLE QJsonObject stopRecording();
+    Q_INVOKABLE QJsonObject recordingStatus() const { return m_mediaRecorder.status(); }
+    /// Input movie (InputMovie), emulator thread only: snapshots the machine, then
+    /// records the input of every frame, with RAM and screen checksums every
+    /// verifyInterval frames, until stopMovieRecording() writes it to path. Loading a
+    /// state or file, fast loading, writing memory, stepping an instruction, a run-to
+    /// or step over, rewinding, a cold or warm boot and shutdown also end it, since
+    /// they change the machine outside the input. Returns movieStatus(), or {"error": ...}.
+    Q_INVOKABLE QJsonObject startMovieRecording(const QString& path, int verifyInterval);
+    Q_INVOKABLE QJsonObject stopMovieRecording();
+    Q_INVOKABLE QJsonObject movieStatus() const;
+    /// Restores a movie's starting state and replays its frames unpaced, comparing the
+    /// checksums it recorded. Stops at the first mismatch when stopOnMismatch is set.
+    /// Returns frames, checked, mismatches, first_mismatch_frame, elapsed_ms and
+    /// speed_x, or {"error": ...}. Same media must be mounted as when it was recorded.
+    Q_INVOKABLE QJsonObject playMovie(const QString& path, bool stopOnMismatch);
+    /// Frame checksum stream (FrameChecksumStream), emulator thread only: an XXH64 of
+    /// RAM and of the indexed screen after every frame in every run mode, kept in a
+    /// ring of capacity entries and, if path is set, appended to a text file. Returns
+    /// frameChecksumStatus(), or {"error": ...}.
+    Q_INVOKABLE QJsonObject startFrameChecksums(const QString& path, int capacity);
+    Q_INVOKABLE QJsonObject stopFrameChecksums();
+    Q_INVOKABLE QJsonObject frameChecksumStatus() const;
+    /// Up to max entries from cursor on (see FrameChecksumStream::read()) as
+    /// [frame, ram, screen] rows with hex hashes, plus next_cursor and dropped.
+    Q_INVOKABLE QJsonObject readFrameChecksums(qint64 cursor, int max) const;
+    /// Choose which exchange processFrame() publishes to. Safe to call from any thread.
+    void setIndexedFrameOutput(bool enabled) { m_indexedFrameOutput.store(enabled); }
+    bool isIndexedFrameOutput() const { return m_indexedFrameOutput.load(); }
     void requestNextFrame();  // Public so timer callback can schedule the next frame
+
+    /// Headless fast-forward: run up to frameCount frames back-to-back on the calling
+    /// thread, bypassing the frame timer, audio and frame publishing. Returns the number
+    /// of frames actually run (fewer if a breakpoint paused emulation).
+    int runFramesUnpaced(int frameCount);
+    /// Render the current screen into a new RGB32 image, independent of the frame exchange.
+    QImage renderCurrentFrame();
     
     // Direct input injection for paste functionality
     void injectCharacter(char ch);
+
+    /// Queues Latin-1 text for processFrame() to type, with no GUI timer. A queued
+    /// key is let go as soon as the OS has latched it into CH ($02FC) and the next
+    /// one goes in once CH is free again, so a character takes two or three frames
+    /// (a repeated key waits out the OS debounce). With turbo the emulator runs at
+    /// host speed until the queue drains. Thread-safe.
+    void queueText(const QByteArray& latin1, bool turbo = false);
+    /// Queues a raw AKEY code (e.g. AKEY_CAPSTOGGLE) in the same FIFO. Thread-safe.
+    void queueAKey(int akeyCode);
+    /// Drops whatever has not been typed yet and ends a turbo burst. Thread-safe.
+    void cancelQueuedText();
+    /// Keys still waiting in the FIFO. Thread-safe.
+    int queuedKeyCount() const;
     
     // XEX loading for debugging - loads and sets entry point breakpoint
     bool loadXexForDebug(const QString& filename);
+
+    /// Loads a binary file straight into RAM between two frames, with no coldstart
+    /// and no trip through the OS loader: each segment is copied in, its INIT routine
+    /// (if any) runs until it returns, and the CPU then jumps to RUNAD with a return
+    /// to the OS warm start on the stack. Refuses, leaving the machine untouched, a
+    /// malformed image or one that loads into I/O, ROM, a cartridge or missing RAM,
+    /// so the caller can fall back to loadFile(). Emulator thread only.
+    bool fastLoadXex(const QByteArray& image, QString* error = nullptr);
+    /// Puts a tokenized (SAVE format) BASIC program into BASIC's tables the way LOAD
+    /// does, relocated to the current LOMEM; meant for the READY prompt, with RUN
+    /// typed afterwards if wanted. Needs BASIC mapped in. Emulator thread only.
+    bool fastLoadBasic(const QByteArray& program, QString* error = nullptr);
+
+    /// Thread-safe: background code/data analysis and symbol labels for the
+    /// debugger and the debug.* TCP commands.
+    CodeAnalyzer& codeAnalyzer() { return m_codeAnalyzer; }
     
     void injectAKey(int akeyCode);  // For raw AKEY code injection
     void clearInput();
@@ -355,8 +672,9 @@ public slots:
     /// Thread-safe. True when inject hold/post-release counters are zero (ignores OS CH).
     /// Use in unit tests; production paste uses isCharacterInjectionIdle() which also polls CH.
     bool injectionTimersIdleForTest() const;
-    /// Thread-safe. False while hold/post-release frames are pending, or until CH ($02FC) is clear
-    /// (OS keyboard buffer) when libatari800 is initialized — see kInjectPostReleaseFrameCount.
+    /// Thread-safe. False while hold/post-release frames are pending, queueText() keys remain,
+    /// or until CH ($02FC) is clear (OS keyboard buffer) when libatari800 is initialized —
+    /// see kInjectPostReleaseFrameCount.
     bool isCharacterInjectionIdle() const;
 
     // Caps lock control
@@ -369,9 +687,23 @@ public slots:
     // Debug/execution control
     Q_INVOKABLE void pauseEmulation();
     Q_INVOKABLE void resumeEmulation();
+    /// Nestable: while held, no frame (or run-to slice) starts, but queued calls still
+    /// run, so a group of commands sees one consistent machine state. Frames that
+    /// came due while held start as soon as the last hold is released.
+    Q_INVOKABLE void holdFrames();
+    Q_INVOKABLE void releaseFrames();
     bool isEmulationPaused() const;
     void stepOneFrame();
     void stepOneInstruction();
+    /// Step over a JSR: run at full speed until the subroutine returns to the caller's
+    /// stack depth, with no instruction limit. Any other opcode is single-stepped.
+    /// Returns true when a run was started; its end is reported by runToFinished().
+    Q_INVOKABLE bool stepOver();
+    /// Run at full speed until the PC reaches address with the stack pointer back at
+    /// (or above) stackPointer; -1 matches any depth. Stops early at an enabled breakpoint.
+    Q_INVOKABLE void runToAddress(unsigned short address, int stackPointer = -1);
+    Q_INVOKABLE void cancelRunTo();
+    bool isRunToActive() const { return m_runToAddress >= 0; }
     
     // Breakpoint management - core debugging support
     void addBreakpoint(unsigned short address);
@@ -381,6 +713,65 @@ public slots:
     QSet<unsigned short> getBreakpoints() const;
     void setBreakpointsEnabled(bool enabled);
     bool areBreakpointsEnabled() const;
+
+    // Memory watchpoints (patch 0020), emulator thread only. access is a mask of
+    // AccessTraceRing::Access bits over the inclusive range start..end. Every matching
+    // access is logged to accessTrace(); breakOnHit also pauses in front of the
+    // instruction. Returns the new watchpoint id, or -1 for an invalid range.
+    Q_INVOKABLE int addWatchpoint(int start, int end, int access, bool breakOnHit);
+    Q_INVOKABLE bool removeWatchpoint(int id);
+    Q_INVOKABLE void clearWatchpoints();
+    Q_INVOKABLE QJsonArray getWatchpoints() const;
+    /// Lock-free trace of watched accesses; drain it from any one consumer thread.
+    AccessTraceRing& accessTrace() { return m_accessTrace; }
+
+    // Instruction trace (patch 0022), emulator thread only. Every instruction executed
+    // at start..end is recorded to a memory-mapped ring file of sizeMB (TraceRecorder);
+    // run-ahead is off while tracing. start returns instructionTraceStatus(), or
+    // {"error": ...}; tail returns the newest count records as objects.
+    Q_INVOKABLE QJsonObject startInstructionTrace(const QString& path, int sizeMB, int start, int end);
+    Q_INVOKABLE QJsonObject stopInstructionTrace();
+    Q_INVOKABLE QJsonObject instructionTraceStatus() const;
+    Q_INVOKABLE QJsonArray instructionTraceTail(int count) const;
+
+    // Cycle profiler on the same instruction trace, emulator thread only: exact cycles
+    // per address (optionally per XE bank in $4000-$7FFF) and a JSR/interrupt call
+    // graph while enabled; run-ahead is off meanwhile. getProfile returns the top count
+    // addresses and functions.
+    Q_INVOKABLE void startProfiling(bool splitBanks);
+    Q_INVOKABLE void stopProfiling();
+    Q_INVOKABLE void resetProfile();
+    Q_INVOKABLE QJsonObject getProfile(int count);
+    /// Thread-safe: the report published every kProfilePublishFrames frames while
+    /// profiling (top kProfileReportRows of each), or nullptr before the first.
+    std::shared_ptr<const CycleProfiler::Report> profileReport() const;
+    bool isProfiling() const { return m_profiling.load(); }
+    static constexpr int kProfilePublishFrames = 25;
+    static constexpr int kProfileReportRows = 64;
+
+    // Frame-synchronous actions, emulator thread only. An action for frame N runs right
+    // before the frame that advances the emulated frame count (getCurrentFrame()) from N,
+    // in every run mode; actions that are already due run before the next frame. Types:
+    // "joystick", "console", "char", "write_memory", "save_state", "capture" and "pause".
+    // Parameters are validated by the caller. Returns the action id.
+    Q_INVOKABLE int scheduleAction(quint64 frame, const QString& type, const QJsonObject& params);
+    Q_INVOKABLE bool cancelScheduledAction(int id);
+    Q_INVOKABLE void clearScheduledActions();
+    Q_INVOKABLE QJsonArray getScheduledActions() const;
+    Q_INVOKABLE quint64 getCurrentFrame() const { return m_emulatedFrames; }
+
+    // Bulk memory access, emulator thread only, so a block is never torn by a frame.
+    // Bank 0 is the CPU view of the 64 KB address space; banks 1..extendedBankCount()
+    // are the XE extended RAM banks (patch 0021), addressed 0..16383 whether or not
+    // PORTB currently maps them. Invalid ranges read as an empty array / fail to write;
+    // a write ends an input movie recording.
+    Q_INVOKABLE QByteArray readMemoryBlock(int bank, int address, int length) const;
+    Q_INVOKABLE bool writeMemoryBlock(int bank, int address, const QByteArray& data);
+    Q_INVOKABLE int extendedBankCount() const;
+    // The CPU registers, chip registers and banking state plus the memory of the
+    // MachineSnapshot::Section flags, in one pass. Emulator thread only, so the
+    // capture always falls between two frames.
+    MachineSnapshot captureSnapshot(int sections = MachineSnapshot::AllSections) const;
     
     // Dynamic speed adjustment for audio sync
     double calculateSpeedAdjustment();
@@ -389,35 +780,109 @@ public slots:
 public slots:
     void processFrame();
 
+private slots:
+    void continueRunTo();
+    void onStateFileLoaded(const QString& filename, const QByteArray& rawState,
+                           const QString& profileName, bool success);
+
 signals:
     void diskActivity(int driveNumber, bool isWriting);  // Legacy blinking
-    void diskIOStart(int driveNumber, bool isWriting);   // Turn LED ON
-    void diskIOEnd(int driveNumber);                     // Turn LED OFF
-    void frameReady(const QImage& image);
+    /// A new frame was published to frameExchange() (or indexedFrameExchange() while
+    /// indexed output is enabled). Emitted at most once per frame the
+    /// consumer has picked up, so a stalled GUI thread never accumulates queued frames.
+    void frameReady();
+    /// A frame was published to screenStreamExchange(); same coalescing as frameReady().
+    void screenStreamFrameReady();
     void xexLoadedForDebug(unsigned short entryPoint);
     
     // Core debugging signals
     void breakpointHit(unsigned short address);
+    /// A breakOnHit watchpoint paused emulation in front of the instruction at pc.
+    void watchpointHit(unsigned short pc, unsigned short address, int access);
     void breakpointAdded(unsigned short address);
     void breakpointRemoved(unsigned short address);
     void breakpointsCleared();
     void executionPaused();
     void executionResumed();
     void debugStepped();
+    /// A runToAddress()/stepOver() run ended: reachedTarget is false when it stopped at a
+    /// user breakpoint or was cancelled.
+    void runToFinished(unsigned short pc, bool reachedTarget);
+    /// A scheduleAction() action ran before frame `frame`; result carries e.g. the capture.
+    void scheduledActionExecuted(int id, quint64 frame, const QString& type, const QJsonObject& result);
+    /// Frame `frame` runs with a different stick or trigger on port 1-4 than the frame
+    /// before it; directions are libatari800 stick values. Only while input change
+    /// reporting is on, and never for the first frame after it was switched on.
+    void joystickInputChanged(quint64 frame, int port, int direction, bool fire,
+                              int previousDirection, bool previousFire);
+    /// Same for the console keys; keys and previousKeys are ConsoleKey bits.
+    void consoleInputChanged(quint64 frame, int keys, int previousKeys);
+    /// The text lines on screen changed (see setScreenTextEvents()); right-trimmed.
+    void screenTextChanged(quint64 frame, const QStringList& rows);
+
+    /// The last queueText()/queueAKey() key has been typed and released.
+    void textQueueDrained();
+    /// A tape load started or finished running at unlimited speed (see setTapeAccelerationEnabled()).
+    void tapeAccelerationChanged(bool active);
+
+    /// Emitted once the state file is durable on disk (or the save failed).
+    void stateSaved(const QString& filename, bool success);
+    /// Emitted after a loadStateAsync() state was applied (or failed to read).
+    void stateLoaded(const QString& filename, bool success);
 
 private:
     unsigned char convertQtKeyToAtari(int key, Qt::KeyboardModifiers modifiers);
     char getShiftedSymbol(int key, bool shiftPressed);
     void setupAudio();
+    /// Loads "audio/syncToAudio"; called before the first setupAudio().
+    void applyAudioSyncSetting();
+    bool audioPacingActive() const;
     /// Caller must hold m_inputMutex. Uses lib clear only while the core is initialized.
     void clearCurrentInputLocked();
+    /// Caller must hold m_inputMutex. Presses ch for kInjectKeyHoldFrameCount frames;
+    /// false (and nothing pressed) when ch has no Atari key.
+    bool startInjectedCharacterLocked(char ch);
+    /// Caller must hold m_inputMutex. Starts the next queued key once the previous one
+    /// is released and consumed; true when the queue has just finished.
+    bool advanceKeyQueueLocked();
     void triggerDiskActivity();
     QString quotePath(const QString& path);  // Helper to quote paths with spaces
     bool m_enableAudioDiagnostics = false;   // Enable CSV logging for audio diagnostics
 
-    // Frame rendering: converts libatari800 screen buffer to a QImage on the emulator thread.
-    // Called at the end of processFrame() before emitting frameReady().
-    QImage renderFrameImage();
+    // Audio telemetry: one sample per frame, always on (see recordAudioTelemetry)
+    AudioTelemetryRing m_audioTelemetry;
+    quint32 m_audioUnderruns = 0;   // Qt and legacy SDL2 backends; unified counts its own
+    quint32 m_audioOverruns = 0;
+    qint64 m_lastAudioTelemetryUs = 0;
+    QThread* m_audioTelemetryLogThread = nullptr;  // CSV writer while diagnostics are on
+    std::atomic<bool> m_audioTelemetryLogStop{false};
+    void recordAudioTelemetry(int producedBytes);
+    void recordSioWait();  // NetSIO stall time of the frame that just ran, into m_performance
+
+    // Turbo audio: at more than 1x the frame's samples are time-compressed or
+    // thinned out to a real-time stream before they reach any output ring
+    AudioDecimator m_audioDecimator;
+    bool m_turboAudioEnabled = true;
+    double m_turboMeasuredSpeed = 1.0;  // smoothed host speed at unlimited
+    std::chrono::steady_clock::time_point m_turboLastFrameTime;
+    void adaptAudioToSpeed(const unsigned char*& buffer, int& length);
+    void startAudioTelemetryLog();
+    void stopAudioTelemetryLog();
+
+    // Frame rendering: converts libatari800 screen buffer into the exchange's back buffer on
+    // the emulator thread. Called at the end of processFrame() before emitting frameReady().
+    void renderFrameImage(QImage& target);
+    // Indexed variant for the GPU path: copies palette indices and attaches the palette.
+    void renderIndexedFrame(QImage& target);
+
+    // Packed 0xffRRGGBB copy of Colours_table used by renderFrameImage(). Rebuilt on the
+    // emulator thread only when m_paletteLutDirty is set, i.e. after libatari800_init(),
+    // Colours_Update() or an artifact mode change — never per pixel.
+    void rebuildPaletteLut();
+    quint32 m_paletteLut[256] = {};
+    QVector<QRgb> m_paletteColorTable;  // Same palette as a QImage colour table (shared, not copied)
+    std::atomic<bool> m_paletteLutDirty{true};
+    quint32 m_paletteGeneration = 0;  // bumped by every rebuildPaletteLut()
 
     // Protects m_currentInput against concurrent access between the main thread
     // (keyboard/joystick events) and the emulator thread (processFrame snapshot).
@@ -430,6 +895,28 @@ private:
     int m_injectKeyFramesRemaining = 0;
     int m_injectPostReleaseFrames = 0;
 
+    // queueText() FIFO, drained by processFrame() under m_inputMutex
+    struct QueuedKey {
+        bool raw;   // akey is an AKEY code rather than a character
+        int akey;   // character (Latin-1) or AKEY code
+    };
+    QVector<QueuedKey> m_keyQueue;
+    int m_keyQueueHead = 0;
+    bool m_keyQueueActive = false;    // a queued key is pending or still held/releasing
+    bool m_injectFromQueue = false;   // the key being held came from m_keyQueue
+    int m_lastQueuedKey = 0;
+    bool m_keyQueueTurbo = false;      // holds a speed boost
+
+    // Tape acceleration (see setTapeAccelerationEnabled); emulator thread except the flag
+    QString m_cassettePath;
+    TapeAccelerator m_tapeAccelerator;
+    std::atomic<bool> m_tapeAccelerationEnabled{true};
+    void updateTapeAcceleration();  // a load in progress holds a speed boost
+    void endTapeAcceleration();
+    // Frames at AKEY_NONE between two different queued keys; the same key again waits
+    // kInjectPostReleaseFrameCount so the OS debounce (KEYDEL) has run out
+    static constexpr int kQueuedKeyReleaseFrameCount = 1;
+
     // Minimum frame-hold guarantee for direct keyboard input.
     // If a key is pressed and released faster than one frame period (~17 ms at 60 fps /
     // ~20 ms at 50 fps), handleKeyRelease() fires before processFrame() has ever seen
@@ -439,16 +926,110 @@ private:
     int  m_directKeyMinHoldFrames  = 0;
     bool m_directKeyPendingRelease = false;
 
-    // Reusable frame image buffer; its shared data is detached (copy-on-write) each
-    // time the emulator thread writes a new frame while the previous one is still
-    // referenced by the main-thread signal queue.
-    QImage m_frameImage;
+    // Preallocated frame buffers shared with EmulatorWidget. Frames are rendered in place,
+    // so no QImage is copied or detached across the thread boundary.
+    FrameExchange m_frameExchange{384, 240, QImage::Format_RGB32};
+    FrameExchange m_indexedFrameExchange{384, 240, QImage::Format_Indexed8};
+    std::atomic<bool> m_indexedFrameOutput{false};
+    FrameExchange m_screenStreamExchange{384, 240, QImage::Format_Indexed8};
+    std::atomic<int> m_screenStreamInterval{0};
+    int m_screenStreamCountdown = 0;
+    void publishScreenStreamFrame(bool force);
+    // Remote stream audio: ~1.5 s of 16-bit mono at 44.1 kHz before frames are lost
+    std::atomic<bool> m_streamAudio{false};
+    AudioRing m_streamAudioRing{128 * 1024};
+    std::atomic<quint64> m_streamAudioOverrunBytes{0};
+    // Last SIO access per drive in steady-clock ms, negated for writes; 0 = never
+    static constexpr int kDriveActivitySlots = 8;
+    std::atomic<qint64> m_driveActivityMs[kDriveActivitySlots] = {};
+    bool claimCore();
+    void releaseCore();
+    // Renders and publishes the current screen unless it is identical to the last
+    // presented one; force publishes the whole frame regardless.
+    void presentFrame(bool force = false);
+    bool presentationDue();
+    std::atomic<qint64> m_presentIntervalNs{16666667};
+    std::chrono::steady_clock::time_point m_lastPresentTime;
+    std::atomic<quint64> m_skippedPresentations{0};
+    bool m_presentationPending = false;
+    QByteArray m_presentedScreen;  // palette indices of the last presented frame
+    bool m_presentedIndexed = false;
+    quint32 m_presentedPaletteGeneration = 0;
+    std::atomic<quint64> m_unchangedFrames{0};
+    SharedStateRegion m_sharedState;  // emulator thread only
+    MediaRecorder m_mediaRecorder;    // submitted to from processFrame()
+    InputMovie m_movie;
+    QString m_moviePath;
+    bool m_movieRecording = false;
+    void recordMovieFrame(const input_template_t& input);
+    void endMovieRecording();
+    quint64 ramChecksum() const;
+    quint64 screenChecksum() const;
+    FrameChecksumStream m_frameChecksums;
+    void recordFrameChecksum();
+    CodeAnalyzer m_codeAnalyzer;
+    InputLatencyMonitor m_inputLatency;
+    PerformanceMonitor m_performance;
+    qint64 m_performanceFrameStartUs = 0;      // 0: no previous frame to measure from
+    quint32 m_performanceUnderruns = 0;        // cumulative count at the previous frame
+    unsigned long long m_performanceSioStallUs = 0;  // NetSIO stall total at the previous frame
+    void publishSharedState();
+    std::atomic<bool> m_screenTextEvents{false};
+    bool m_screenTextReported = false;
+    QStringList m_lastScreenText;
+    QVector<AnticTextDecoder::Line> decodeScreenText(int displayList) const;
+    static QString trimmedRow(const QString& text);
+    void reportScreenText();
 
     // High-resolution frame timing using absolute time scheduling.
     // Each frame is scheduled at firstFrameTime + frameCount * frameTimeMs,
     // so Qt timer overshoot/undershoot is automatically compensated next frame.
     std::chrono::steady_clock::time_point m_firstFrameTime;
     int64_t m_frameCount = 0;
+
+    // Deadline of the frame the timer was last started for (see setThreadScheduling)
+    std::chrono::steady_clock::time_point m_frameDeadline;
+    bool m_frameDeadlineValid = false;
+    std::chrono::steady_clock::time_point m_lastPacedFrameStart;
+    bool m_lastPacedFrameValid = false;
+    bool m_preciseTiming = false;
+    QJsonObject m_threadScheduling;
+    LatencyHistogram m_frameLateness;
+    LatencyHistogram m_frameIntervals;
+    quint64 m_lateFrames = 0;
+    quint64 m_missedFrames = 0;
+    void recordFramePacing();
+
+    // Rewind snapshots: null while rewind is disabled
+    std::unique_ptr<RewindBuffer> m_rewindBuffer;
+    std::unique_ptr<UBYTE[]> m_rewindScratch;  // STATESAV_MAX_SIZE, one LIBATARI800_StateSave target
+    int m_rewindInterval = 10;
+    int m_rewindFramesUntilSnapshot = 0;
+    void captureRewindSnapshotIfDue();
+
+    // Machine-wide frame count that scheduled actions, checksums, streams and
+    // traces are stamped with: every loop around libatari800_next_frame() calls
+    // advanceFrameCounter() once per real frame (run-ahead's ahead frames are not)
+    quint64 m_emulatedFrames = 0;              // frames since init; rewinding moves it back
+    void advanceFrameCounter() { m_emulatedFrames++; }
+
+    // Run-ahead (see setRunAheadFrames); the state buffer is allocated on first use
+    std::atomic<int> m_runAheadFrames{0};
+    std::atomic<bool> m_runAheadActive{false};
+    std::unique_ptr<UBYTE[]> m_runAheadState;  // STATESAV_MAX_SIZE
+    bool m_runningAhead = false;
+    void runAhead(const input_template_t& frameInput);
+    QByteArray snapshotState();
+    void publishCurrentFrame();  // Render and hand the current screen to the widget, e.g. while paused
+    int m_frameHoldDepth = 0;            // holdFrames() nesting, emulator thread only
+    bool m_frameDeferredByHold = false;  // processFrame() came due while held
+    bool m_runToDeferredByHold = false;  // same for a continueRunTo() slice
+
+    // Save-state compression and file I/O thread
+    QThread* m_stateIoThread = nullptr;
+    StateFileWorker* m_stateIoWorker = nullptr;
+    int saveStateToBuffer(UBYTE* buffer);
+    void loadStateFromBuffer(const UBYTE* buffer);
     
     bool m_basicEnabled = true;
     bool m_altirraOSEnabled = false;
@@ -457,6 +1038,9 @@ private:
     QString m_videoSystem = "-pal";
     QString m_osRomPath;
     QString m_basicRomPath;
+    QJsonObject m_bootConfig;  // see bootConfig()
+    bool m_hibernateOnQuit = false;
+    QJsonObject hibernateMedia() const;
     
     // Joystick keyboard emulation settings
     std::atomic<bool> m_joystickInputEnabled{true};
@@ -467,6 +1051,8 @@ private:
     QString m_joystick1Preset = "wasd";
     float m_targetFps = 59.92f;
     float m_frameTimeMs = 16.67f;
+    static constexpr double kRefreshLockTolerance = 0.01;
+    double m_displayRefreshHz = 0.0;  // setDisplayRefreshLock(); 0 while off
     input_template_t m_currentInput;
     bool m_capsLockEnabled = false;  // Track caps lock state
     QTimer* m_frameTimer;
@@ -474,14 +1060,89 @@ private:
     // Debug/execution state
     bool m_emulationPaused = false;
     
-    // Core breakpoint management
-    QSet<unsigned short> m_breakpoints;
+    // Core breakpoint management. One bit per address; the CPU core tests it
+    // before every instruction while armed (enabled and non-empty), see patch 0019.
+    unsigned char m_breakpointMap[65536 / 8] = {};
+    int m_breakpointCount = 0;
     bool m_breakpointsEnabled = true;
-    unsigned short m_lastPC = 0xFFFF;  // Track last PC for breakpoint detection
-    void checkBreakpoints();  // Internal breakpoint checking
+    void updateBreakpointArming();
+
+    // Run-to target (temporary breakpoint); -1 while no run is active. The core then
+    // gets m_armedBreakpointMap: the enabled user breakpoints plus the target bit.
+    int m_runToAddress = -1;
+    int m_runToStackPointer = -1;
+    unsigned char m_armedBreakpointMap[65536 / 8] = {};
+    void finishRunTo(bool reachedTarget);
+
+    // fastLoadXex() calls each INIT routine with this address as its return; the
+    // core halts in front of it (it is WARMSV, where the RUN routine returns to)
+    static constexpr unsigned short kFastLoadReturnAddress = 0xE474;
+    static constexpr int kFastLoadInitMaxFrames = 600;
+    static constexpr unsigned char kFastLoadStackTop = 0xFF;  // S for a freshly loaded program
+    bool runFastLoadInit(unsigned short address);
+    void reportHalt(unsigned short pc);  // breakpointHit or watchpointHit for a core halt
+
+    // Watchpoints: the map holds the logged access bits in the low nibble and the
+    // break-on-hit bits in the high nibble; null (and the core disarmed) when empty.
+    struct Watchpoint {
+        int id;
+        quint16 start;
+        quint16 end;
+        quint8 access;
+        bool breakOnHit;
+    };
+    QVector<Watchpoint> m_watchpoints;
+    int m_nextWatchpointId = 1;
+    std::unique_ptr<unsigned char[]> m_watchMap;
+    AccessTraceRing m_accessTrace;
+    bool m_watchHaltPending = false;
+    quint16 m_watchHitAddress = 0;
+    int m_watchHitAccess = 0;
+    void rebuildWatchMap();
+    static int watchCallback(unsigned short pc, unsigned short address, int access, unsigned char value);
+
+    // Instruction trace: the core fills m_traceBuffer during a frame and
+    // collectInstructionTrace() moves it into the recorder and the profiler
+    // after each one. Collect before re-arming: arming empties the buffer.
+    static constexpr int kTraceBufferRecords = 32768;
+    std::vector<TraceRecorder::RawRecord> m_traceBuffer;
+    std::vector<TraceRecorder::RawRecord> m_traceFiltered;
+    TraceRecorder m_traceRecorder;
+    quint16 m_traceStart = 0;
+    quint16 m_traceEnd = 0xFFFF;
+    CycleProfiler m_profiler;
+    std::atomic<bool> m_profiling{false};
+    int m_profileFramesSincePublish = 0;
+    mutable QMutex m_profileMutex;
+    std::shared_ptr<const CycleProfiler::Report> m_profileReport;
+    void armInstructionTrace();
+    void collectInstructionTrace();
+    void publishProfile();
+
+    struct ScheduledAction {
+        int id;
+        QString type;
+        QJsonObject params;
+    };
+    QMultiMap<quint64, ScheduledAction> m_scheduledActions;  // by target frame, FIFO within a frame
+    int m_nextScheduledActionId = 1;
+    bool runDueScheduledActions();  // false when a "pause" action stopped the frame
+
+    // Input change reporting: diffs the snapshot each frame is run with, so every
+    // source (keyboard, SDL, TCP, scheduled actions) is seen at the frame it applies to
+    std::atomic<bool> m_inputChangeReporting{false};
+    bool m_reportedInputValid = false;
+    input_template_t m_reportedInput;
+    void reportInputChanges(const input_template_t& input);
+    unsigned char* memoryBlock(int bank, int address, int length) const;
+    QJsonObject executeScheduledAction(const ScheduledAction& action);
+    void checkBreakpoints();  // Report a halt raised by the CPU core during the last frame
     
     // Disk drive tracking
     QString m_diskImages[8]; // Paths for D1: through D8:
+    DiskImageCache m_diskCache;
+    RomImageCache m_romImageCache;
+    bool m_diskOverlayEnabled[8] = {};
     
     // Disk I/O detection using libatari800 API
     QSet<int> m_mountedDrives;
@@ -496,10 +1157,8 @@ private:
     
     // Double buffering for audio (inspired by Atari800MacX)
     static const int DSP_BUFFER_FRAGS = 5;  // Number of fragments in DSP buffer
-    QByteArray m_dspBuffer;
-    int m_dspBufferBytes;
-    int m_dspWritePos;
-    int m_dspReadPos;
+    // Producer and consumer are both processFrame(), so it may drop its oldest data
+    AudioRing m_dspRing;
     // Staging buffer: assembles a contiguous chunk for one write() to QIODevice.
     // Must be able to hold the largest single write: min(DSP ring span, Qt bytesFree()),
     // which on Linux is often up to the QAudioOutput buffer size (8192), not merely
@@ -522,8 +1181,20 @@ private:
     static constexpr double PI_KI      = 0.0000005; // Integral gain
     static constexpr double PI_MAX_TRIM = 0.005;    // ±0.5% max correction
 
-    // User-requested speed multiplier (separate from audio sync adjustment)
+    // Audio-master pacing (see setAudioMasterSync); the PI trim is not used then
+    bool m_audioMasterSync = false;
+    bool m_audioPacedLastFrame = false;
+
+    // Applied speed multiplier (separate from audio sync adjustment): the user's,
+    // or unlimited while a speed boost is active
     double m_userRequestedSpeedMultiplier;  // 1.0 = normal, 2.0 = 2x, 0.5 = 0.5x, 0.0 = unlimited
+    // setEmulationSpeed() percentage, and how many boosts (each of a turbo paste and
+    // a tape load holds at most one) run the machine unlimited on top of it
+    std::atomic<int> m_userSpeedPercent{100};
+    std::atomic<int> m_speedBoosts{0};
+    void beginSpeedBoost();
+    void endSpeedBoost();
+    void applyEmulationSpeed(int percentage);
     double m_currentSpeed;  // Effective combined speed (user × PI trim) — kept for legacy API
     double m_targetSpeed;   // Target speed (kept for legacy API)
     
@@ -535,11 +1206,8 @@ private:
     SDL2AudioBackend* m_sdl2Audio;
 
     // SDL2 audio ring buffer (legacy)
-    QByteArray m_sdl2AudioBuffer;
-    int m_sdl2WritePos;
-    int m_sdl2ReadPos;
-    QMutex m_sdl2AudioMutex;
     static const int SDL2_BUFFER_SIZE = 32768;  // 32KB ring buffer for better stability
+    AudioRing m_sdl2Ring{SDL2_BUFFER_SIZE};
 
     // Dynamic buffer management (legacy)
     int m_sdl2TargetBufferLevel;  // Target amount of data to maintain in buffer
@@ -557,7 +1225,15 @@ private:
     // Device assignment tracking
     QString m_joystick1AssignedDevice;  // "keyboard", "none", or "sdl_X"
     QString m_joystick2AssignedDevice;  // "keyboard", "none", or "sdl_X"
+
+    // SDL joystick index feeding Atari port 0/1, or -1. Resolved from the
+    // assigned devices and the swap flag whenever they change, so the frame
+    // loop only loads these and the manager's packed state words.
+    std::atomic<int> m_port0SdlJoystick{-1};
+    std::atomic<int> m_port1SdlJoystick{-1};
+    quint32 m_portAppliedJoystick[2] = {0, 0};  // emulator thread: last state copied to m_currentInput
 #endif
+    void resolveJoystickPorts();
     
     // Printer components
     bool m_printerEnabled;
@@ -576,13 +1252,7 @@ private:
 
     // Current profile name for state saves
     QString m_currentProfileName;
-    
-    // Partial frame execution for precise breakpoints
-    bool m_usePartialFrameExecution;
-    int m_cyclesThisFrame;
-    static constexpr int CYCLES_PER_FRAME = 29833;  // NTSC: 29833, PAL: 35568
-    static constexpr int BREAKPOINT_CHECK_CHUNK = 500;  // Check every 500 cycles
-    
+
 };
 
 #endif // ATARIEMULATOR_H
\ No newline at end of file
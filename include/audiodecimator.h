@@ -0,0 +1,72 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef AUDIODECIMATOR_H
+#define AUDIODECIMATOR_H
+
+#include <vector>
+
+// Fits the emulator's POKEY output to the audio device when emulation runs
+// faster than real time. Each emulated frame's samples go through process()
+// together with the current speed multiple, and what comes out is, on average,
+// one real-time frame's worth, so the output rings neither overrun nor lag.
+//
+// TimeCompress averages every `speed` input frames into one output frame (a
+// box filter, so the decimation does not alias badly); everything is heard,
+// pitched up. PitchPreserve instead passes whole emulated frames through at
+// 1/speed of the rate and drops the rest, with short fades where frames were
+// dropped; the pitch stays, the sound is choppy. At speed 1 or below the
+// input is returned as is. Samples are interleaved unsigned 8-bit or signed
+// 16-bit, as libatari800 produces them. Not thread-safe: the emulator thread.
+class AudioDecimator
+{
+public:
+    enum Mode {
+        TimeCompress = 0,
+        PitchPreserve = 1
+    };
+
+    static constexpr double kMaxSpeed = 100.0;
+    // Fade length (frames) at the edges of dropped audio in PitchPreserve
+    static constexpr int kFadeFrames = 64;
+
+    void configure(int channels, int sampleSize);
+    void setMode(Mode mode);
+    Mode mode() const { return m_mode; }
+    /// Forget partial output frames and the drop schedule.
+    void reset();
+
+    /// Adapt one emulated frame of audio to speed (multiple of real time).
+    /// Returns the number of bytes to queue and points *output at them: the
+    /// input itself at speed <= 1, otherwise an internal buffer valid until
+    /// the next call. May return 0.
+    int process(const unsigned char* input, int bytes, double speed, const unsigned char** output);
+
+private:
+    int timeCompress(const unsigned char* input, int frames, double speed);
+    int pitchPreserve(const unsigned char* input, int frames, double speed);
+    float sampleAt(const unsigned char* data, int index) const;
+    void storeSample(int index, float value);
+    void fade(int firstFrame, int frames, bool fadeIn);
+
+    Mode m_mode = TimeCompress;
+    int m_channels = 1;
+    int m_sampleSize = 2;
+    bool m_active = false;
+
+    // TimeCompress: the output frame being averaged
+    std::vector<double> m_sums;
+    double m_windowLeft = 0.0;  // input frames still missing from it
+
+    // PitchPreserve
+    double m_credit = 0.0;
+    bool m_previousDropped = false;
+
+    std::vector<unsigned char> m_output;
+};
+
+#endif // AUDIODECIMATOR_H
@@ -0,0 +1,39 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef AUDIOKERNELS_H
+#define AUDIOKERNELS_H
+
+#include <QtGlobal>
+
+// Sample conversion loops of the real-time audio callback. They work on
+// caller-owned buffers and never allocate, and use SSE2 on x86-64 and NEON on
+// ARM64 (both baseline on those targets, so no extra compiler flags), with a
+// scalar tail and a scalar build everywhere else. Mixing and conversion give
+// identical results on every path (conversion truncates like the scalar code);
+// dotProduct() may differ in the last bit, as it sums in a different order.
+class AudioKernels
+{
+public:
+    /// output[i] += input[i] / 32768 * gain, for mixing a 16-bit source into a float bus.
+    static void accumulateS16(const qint16* input, float* output, int samples, float gain);
+    /// output[i] += (input[i] - 128) / 128 * gain, for 8-bit unsigned sources.
+    static void accumulateU8(const quint8* input, float* output, int samples, float gain);
+
+    /// Volume, clamp to [-1, 1] and convert to 16-bit signed in one pass.
+    static void scaleToS16(const float* input, qint16* output, int samples, float volume);
+    /// Volume, clamp to [-1, 1] and convert to 8-bit unsigned in one pass.
+    static void scaleToU8(const float* input, quint8* output, int samples, float volume);
+
+    /// Sum of a[i] * b[i], for the resampler's filter taps.
+    static float dotProduct(const float* a, const float* b, int samples);
+
+    /// Whether a vector path is compiled in ("sse2", "neon" or "scalar").
+    static const char* instructionSet();
+};
+
+#endif // AUDIOKERNELS_H
@@ -0,0 +1,75 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef AUDIORESAMPLER_H
+#define AUDIORESAMPLER_H
+
+#include <vector>
+
+// Streaming sample rate converter for UnifiedAudioBackend. Input history and
+// the fractional read position carry over from one call to the next, so
+// consecutive device buffers join without discontinuities. Sinc quality
+// applies a 32-tap Blackman-windowed sinc. It has 256 precomputed phases and
+// interpolates linearly between them, and band-limits to the lower of the
+// two rates, so POKEY's square waves do not alias. Linear quality is plain
+// two-point interpolation.
+//
+// configure() allocates. reset(), setRatio(), inputFramesNeeded() and process()
+// do not, so they are safe on the audio thread. The ratio is input frames per
+// output frame, and setRatio() may move it a few percent around the configured
+// value to absorb clock drift. The filter is designed for the configured ratio.
+class AudioResampler
+{
+public:
+    enum Quality {
+        Linear = 0,
+        Sinc = 1
+    };
+
+    static constexpr int kSincHalfTaps = 16;
+    static constexpr int kPhases = 256;
+    // setRatio() keeps the ratio within this fraction of the configured one
+    static constexpr double kMaxRatioDeviation = 0.05;
+
+    void configure(int channels, double ratio, int maxOutputFrames, Quality quality);
+    /// Forget the history and phase (after a pause or a stream restart).
+    void reset();
+
+    void setRatio(double ratio);
+    double ratio() const { return m_ratio; }
+    Quality quality() const { return m_quality; }
+    /// Input frames the filter reads ahead of the current position; this much
+    /// input stays queued between calls.
+    int latencyFrames() const { return m_halfTaps; }
+
+    /// New input frames process() needs to produce outputFrames frames.
+    int inputFramesNeeded(int outputFrames) const;
+    /// Upper bound of inputFramesNeeded() for any ratio setRatio() accepts.
+    int maxInputFrames(int outputFrames) const;
+
+    /// Consume inputFrames interleaved frames and write up to outputFrames
+    /// interleaved frames; returns how many were written. A short count means
+    /// the input ran out, and the rest of the output is left untouched.
+    int process(const float* input, int inputFrames, float* output, int outputFrames);
+
+private:
+    void buildCoefficients();
+    float interpolate(const float* history, double time) const;
+
+    Quality m_quality = Sinc;
+    int m_channels = 0;
+    int m_halfTaps = 1;
+    int m_capacity = 0;         // history frames per channel
+    int m_buffered = 0;         // history frames held
+    double m_nominalRatio = 1.0;
+    double m_ratio = 1.0;
+    double m_time = 0.0;        // read position in history frames
+    std::vector<float> m_history;       // planar: channel c starts at c * m_capacity
+    std::vector<float> m_coefficients;  // (kPhases + 1) rows of 2 * m_halfTaps taps
+};
+
+#endif // AUDIORESAMPLER_H
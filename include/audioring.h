@@ -0,0 +1,74 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef AUDIORING_H
+#define AUDIORING_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+
+// Single-producer/single-consumer byte ring shared by every audio output: the
+// emulator thread writes each frame's samples; the Qt output path, the SDL2
+// callback or UnifiedAudioBackend's callback reads them. No locks and no
+// allocation after setCapacity(). The capacity is a power of two and the
+// indices run freely, so a transfer is at most two memcpy()s, one on each side
+// of the wrap point. The two indices sit on separate cache lines so the two
+// threads do not contend for the same line.
+class AudioRing
+{
+public:
+    /// A readable region: up to two spans, the second one after the wrap.
+    struct Spans {
+        const unsigned char* first = nullptr;
+        int firstBytes = 0;
+        const unsigned char* second = nullptr;
+        int secondBytes = 0;
+
+        int bytes() const { return firstBytes + secondBytes; }
+    };
+
+    /// capacity is rounded up to a power of two; 0 leaves the ring unallocated.
+    explicit AudioRing(int capacity = 0);
+
+    /// Reallocate and empty the ring. Neither side may be running.
+    void setCapacity(int capacity);
+    int capacity() const { return m_data ? static_cast<int>(m_mask + 1) : 0; }
+
+    /// Bytes queued. Exact on the consumer side, a lower bound on the producer side.
+    int available() const;
+    /// Bytes that can be written. Exact on the producer side.
+    int freeSpace() const { return capacity() - available(); }
+
+    // Producer side
+    /// Queue all of data or nothing; false (and nothing written) if it does not fit.
+    bool write(const void* data, int bytes);
+    /// Queue bytes of silence (zero bytes); returns how many fit.
+    int writeSilence(int bytes);
+
+    // Consumer side
+    /// Copy out and remove up to bytes; returns how many were read.
+    int read(void* data, int bytes);
+    /// Copy out up to bytes without removing them.
+    int peek(void* data, int bytes) const;
+    /// Zero-copy view of up to maxBytes queued bytes; release them with consume().
+    Spans readSpans(int maxBytes) const;
+    void consume(int bytes);
+    /// Discard everything queued.
+    void clear();
+
+private:
+    std::unique_ptr<unsigned char[]> m_data;
+    quint32 m_mask = 0;
+    char m_padding0[64];
+    std::atomic<quint32> m_head{0};  // next write, owned by the producer
+    char m_padding1[64];
+    std::atomic<quint32> m_tail{0};  // next read, owned by the consumer
+    char m_padding2[64];
+};
+
+#endif // AUDIORING_H
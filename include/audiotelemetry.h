@@ -0,0 +1,77 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef AUDIOTELEMETRY_H
+#define AUDIOTELEMETRY_H
+
+#include <QJsonArray>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+
+// The audio output's state after one emulated frame.
+struct AudioTelemetrySample {
+    quint64 frame = 0;            // emulated frame number
+    qint64 timeUs = 0;            // steady clock when the frame's audio was queued
+    qint64 deviceClockUs = 0;     // Qt: processedUSecs(); unified: steady clock of the last callback
+    qint32 frameIntervalUs = 0;   // time since the previous sample
+    qint32 producedBytes = 0;     // bytes the frame generated
+    qint32 queuedBytes = 0;       // bytes waiting in the output ring afterwards
+    qint32 deviceFreeBytes = -1;  // QAudioOutput::bytesFree(), -1 for SDL backends
+    quint32 underruns = 0;        // cumulative since the backend was set up
+    quint32 overruns = 0;         // cumulative: frames (partly) dropped because the ring was full
+    float speedTrim = 0.0f;       // Qt: PI trim of the frame time; unified: resampler rate factor - 1
+    quint8 backend = 0;           // AtariEmulator::AudioBackend
+    quint8 deviceState = 0;       // QAudio::State for the Qt backend
+};
+
+// Fixed-size flight recorder for audio timing, cheap enough to leave on: the
+// emulator thread record()s one sample per frame and, unlike AccessTraceRing,
+// overwrites the oldest when nobody reads. Readers never modify the ring, so
+// any number of them (the TCP API, the diagnostics CSV writer) can follow it
+// from other threads, each with its own cursor. Every slot carries a sequence
+// number written before and after the sample, so a reader detects a slot the
+// producer lapped while it was copying and reports it as lost.
+class AudioTelemetryRing
+{
+public:
+    /// capacity is rounded up to a power of two.
+    explicit AudioTelemetryRing(int capacity = 4096);
+
+    // Producer side (one thread)
+    void record(const AudioTelemetrySample& sample);
+
+    // Reader side (any thread)
+    /// Up to maxSamples samples from cursor on (0 = the oldest still held),
+    /// oldest first. cursor is advanced past what was returned; *lost gets the
+    /// number of samples after the old cursor that were overwritten unread.
+    QVector<AudioTelemetrySample> read(quint64& cursor, int maxSamples, quint64* lost = nullptr) const;
+    /// Samples recorded so far; the cursor of the next one.
+    quint64 recorded() const { return m_recorded.load(std::memory_order_acquire); }
+    int capacity() const { return static_cast<int>(m_mask + 1); }
+
+    static QString csvHeader();
+    static QString toCsv(const AudioTelemetrySample& sample);
+    /// Compact row in csvHeader() column order.
+    static QJsonArray toJson(const AudioTelemetrySample& sample);
+
+private:
+    static constexpr int kWords = (sizeof(AudioTelemetrySample) + 7) / 8;
+
+    struct Slot {
+        std::atomic<quint64> sequence{0};  // 2 * index + 1 while writing, 2 * index + 2 when done
+        std::atomic<quint64> words[kWords];
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    quint32 m_mask;
+    std::atomic<quint64> m_recorded{0};
+};
+
+#endif // AUDIOTELEMETRY_H
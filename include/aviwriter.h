@@ -0,0 +1,91 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef AVIWRITER_H
+#define AVIWRITER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+// Writes an AVI file with lossless 8-bit palettised video and PCM audio, from
+// the emulator's indexed screen and POKEY samples as they are.
+//
+// Video is Microsoft RLE8 (BI_RLE8), which every common player and FFmpeg
+// decode: screens are mostly runs of one colour, and between keyframes only
+// the pixels that changed are stored (the rest is skipped with RLE8 delta
+// codes), so a static screen costs a few bytes per frame. The palette is fixed
+// at open(). Files are plain AVI 1.0 with an idx1 index; stop below
+// kMaxFileBytes and continue in a new file to stay within its limits.
+class AviWriter
+{
+public:
+    struct Format {
+        int width = 384;
+        int height = 240;
+        double fps = 59.92;
+        quint32 palette[256] = {};  // 0xAARRGGBB
+        int sampleRate = 44100;     // 0: no audio stream
+        int channels = 1;
+        int bitsPerSample = 16;     // 8 (unsigned) or 16 (signed)
+    };
+
+    static constexpr qint64 kMaxFileBytes = qint64(1) << 30;
+    static constexpr int kKeyframeInterval = 300;
+
+    ~AviWriter();
+
+    bool open(const QString& path, const Format& format, QString* error = nullptr);
+    /// One frame of width * height palette indices, top row first. A null
+    /// frame repeats the previous one (an empty chunk).
+    bool writeVideoFrame(const unsigned char* pixels);
+    bool writeAudio(const unsigned char* data, int bytes);
+    /// Write the index and the final lengths. Safe to call twice.
+    bool close();
+
+    bool isOpen() const { return m_file.isOpen(); }
+    qint64 bytesWritten() const { return m_file.isOpen() ? m_file.pos() : m_finalSize; }
+    quint32 videoFrames() const { return m_videoFrames; }
+    quint64 audioBytes() const { return m_audioBytes; }
+
+    /// RLE8-encode one bottom-up bitmap. With previous, unchanged pixels are
+    /// skipped with delta codes (a non-key frame). Public for the tests.
+    static void encodeRle8(const unsigned char* pixels, const unsigned char* previous, int width,
+                           int height, QByteArray& out);
+    /// Reverse of encodeRle8() into a width * height frame (top row first)
+    /// already holding the previous frame. Returns false on malformed data.
+    static bool decodeRle8(const QByteArray& data, int width, int height, unsigned char* pixels);
+
+private:
+    bool writeChunk(const char* fourcc, const char* data, int bytes, bool keyframe);
+    bool patch(qint64 offset, quint32 value);
+
+    struct IndexEntry {
+        quint32 fourcc;
+        quint32 flags;
+        quint32 offset;
+        quint32 size;
+    };
+
+    QFile m_file;
+    Format m_format;
+    QByteArray m_previous;     // last frame's pixels
+    QByteArray m_encoded;      // reused encoder output
+    QVector<IndexEntry> m_index;
+    qint64 m_moviStart = 0;    // offset of the 'movi' fourcc
+    qint64 m_patchTotalFrames = 0;
+    qint64 m_patchVideoLength = 0;
+    qint64 m_patchAudioLength = -1;  // -1: no audio stream
+    quint32 m_videoFrames = 0;
+    quint64 m_audioBytes = 0;
+    qint64 m_finalSize = 0;
+    bool m_failed = false;
+};
+
+#endif // AVIWRITER_H
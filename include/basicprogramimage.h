@@ -0,0 +1,49 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef BASICPROGRAMIMAGE_H
+#define BASICPROGRAMIMAGE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+// A tokenized Atari BASIC program as SAVE writes it, ready to be placed in
+// memory the way LOAD would.
+//
+// The file opens with BASIC's seven table pointers (LOMEM, VNTP, VNTD, VVTP,
+// STMTAB, STMCUR, STARP), saved relative to LOMEM so LOMEM itself is always
+// 0, followed by everything from the variable name table up to the string and
+// array area. The 256 bytes between LOMEM and VNTP are BASIC's token buffer
+// and are not saved. Loading adds the machine's LOMEM to every pointer.
+class BasicProgramImage
+{
+public:
+    bool parse(const QByteArray& file, QString* error = nullptr);
+
+    /// The tables from the variable name table on, to be written at lomem + bodyOffset().
+    const QByteArray& body() const { return m_body; }
+    int bodyOffset() const { return m_pointers[VNTP]; }
+    /// First byte past the program when loaded at lomem.
+    int endAddress(quint16 lomem) const { return lomem + m_pointers[STARP]; }
+
+    /// BASIC's zero page from LOMEM ($80) to its MEMTOP ($90-$91) for a
+    /// program loaded at lomem: the seven pointers, then RUNSTK and MEMTOP
+    /// both at STARP, i.e. empty runtime and string/array stacks.
+    QByteArray zeroPage(quint16 lomem) const;
+
+    static constexpr quint16 kZeroPageAddress = 0x80;
+    static constexpr int kHeaderBytes = 14;
+
+private:
+    enum Pointer { LOMEM, VNTP, VNTD, VVTP, STMTAB, STMCUR, STARP, PointerCount };
+
+    int m_pointers[PointerCount] = {};
+    QByteArray m_body;
+};
+
+#endif // BASICPROGRAMIMAGE_H
@@ -0,0 +1,140 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef CODEANALYZER_H
+#define CODEANALYZER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+#include <memory>
+#include <vector>
+
+class QThread;
+
+// Recursive-descent code/data classification of the 64 KB address space.
+//
+// From a set of roots (entry points, observed PCs and the OS vectors found in
+// memory) it follows branches, jumps, calls and JMP ($xxxx) vectors with the
+// shared 6502 decoder, marking each byte as an instruction start, an operand
+// byte or unknown. Flow ends at RTS/RTI/BRK, unconditional jumps, undocumented
+// opcodes and bytes already claimed by another instruction.
+//
+// The result is kept per 256-byte page: update() compares the new memory with
+// the previous snapshot and re-traces only from pages whose bytes changed,
+// re-seeding from known code elsewhere that flows into them. The tracer has no
+// locking; CodeAnalyzer runs it on a background thread.
+class CodeFlowTracer
+{
+public:
+    enum ByteKind : unsigned char {
+        Unknown = 0,
+        CodeStart = 1,
+        CodeOperand = 2
+    };
+
+    static constexpr int kPageSize = 256;
+    static constexpr int kPages = 0x10000 / kPageSize;
+
+    CodeFlowTracer();
+
+    /// memory is the full 64 KB address space. Returns the number of pages
+    /// re-analysed: all of them the first time, then only those that changed.
+    int update(const unsigned char* memory, const QVector<unsigned short>& entryPoints);
+    void reset();
+
+    const unsigned char* kinds() const { return m_kinds.data(); }
+    int codeBytes() const;
+
+    /// NMI/RESET/IRQ, DOSVEC/DOSINI, RUNAD/INITAD and the display list and
+    /// VBI vectors read from memory.
+    static QVector<unsigned short> vectorEntryPoints(const unsigned char* memory);
+
+    /// Walks back up to `instructions` known instruction starts from address,
+    /// so a listing from the result stays aligned with the code. Where address
+    /// is not known code (or kinds is null) it is address - fallbackBytes.
+    static unsigned short instructionStartBefore(const unsigned char* kinds, const unsigned char* memory,
+                                                 unsigned short address, int instructions, int fallbackBytes);
+
+private:
+    void trace(const unsigned char* memory, QVector<unsigned short>& pending);
+    void invalidatePage(int page, const unsigned char* memory);
+    void clearInstruction(unsigned short start, const unsigned char* memory);
+
+    std::vector<unsigned char> m_kinds;
+    std::vector<unsigned char> m_snapshot;
+    bool m_primed = false;
+};
+
+// Owns a CodeFlowTracer on a worker thread plus the loaded symbol labels.
+//
+// submit() is called from the debugger (GUI thread) with the current memory:
+// it only copies the 64 KB into a pending buffer and wakes the worker, and a
+// newer submit replaces a snapshot the worker has not picked up yet. Each
+// finished pass is published as an immutable Analysis that readers hold by
+// shared_ptr, so the GUI never waits on the trace.
+class CodeAnalyzer
+{
+public:
+    static constexpr int kMaxObservedPCs = 64;
+
+    struct Analysis {
+        quint64 generation = 0;
+        std::vector<unsigned char> kinds;  // CodeFlowTracer::ByteKind per address
+    };
+
+    typedef QHash<unsigned short, QByteArray> Labels;
+
+    CodeAnalyzer();
+    ~CodeAnalyzer();
+
+    /// Any thread: queue memory for analysis, adding pc to the roots.
+    void submit(const unsigned char* memory, int pc = -1);
+    /// Any thread: roots kept across passes (e.g. XEX RUNAD/INITAD).
+    /// Clearing them does not forget code already traced from them.
+    void addEntryPoint(unsigned short address);
+    void clearEntryPoints();
+
+    /// The latest finished pass, or nullptr before the first one.
+    std::shared_ptr<const Analysis> analysis() const;
+
+    /// Parse MADS (.lab) or ca65/VICE (.lbl) label text; the first name
+    /// for an address wins.
+    static Labels parseLabels(const QByteArray& text);
+    /// Replaces the labels with the file's; keeps them on error.
+    bool loadLabels(const QString& path, QString* error = nullptr);
+    void clearLabels();
+    std::shared_ptr<const Labels> labels() const;
+
+    /// For formatInstructionSymbolic6502 with a Labels* context.
+    static const char* lookupLabel(unsigned short address, const void* context);
+
+private:
+    void analyzeLoop();
+    void stop();
+
+    // Worker thread
+    CodeFlowTracer m_tracer;
+    std::vector<unsigned char> m_working;  // swapped with m_pending
+
+    mutable QMutex m_mutex;  // guards everything below
+    QWaitCondition m_wake;
+    QThread* m_thread = nullptr;
+    bool m_stopping = false;
+    std::vector<unsigned char> m_pending;
+    bool m_hasPending = false;
+    QVector<unsigned short> m_entryPoints;
+    QVector<unsigned short> m_observedPCs;
+    quint64 m_generation = 0;
+    std::shared_ptr<const Analysis> m_analysis;
+    std::shared_ptr<const Labels> m_labels;
+};
+
+#endif // CODEANALYZER_H
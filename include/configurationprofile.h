@@ -40,6 +40,7 @@ struct ConfigurationProfile {
     // Performance
     bool turboMode = false;
     int emulationSpeedIndex = 1; // 1x speed
+    int runAheadFrames = 0;      // 0 = off
     
     // Audio Configuration
     bool audioEnabled = true;
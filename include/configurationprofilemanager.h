@@ -8,16 +8,28 @@
 #ifndef CONFIGURATIONPROFILEMANAGER_H
 #define CONFIGURATIONPROFILEMANAGER_H
 
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QHash>
 #include <QObject>
 #include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+#include <atomic>
 #include "configurationprofile.h"
 
+// Profiles are kept in an in-memory index, parsed once per file and refreshed
+// when the profile directory changes on disk, so listing, lookups and
+// loadProfile() do not touch the disk. The lastUsed write-back and media
+// preloading run on a single background I/O thread.
+
 class ConfigurationProfileManager : public QObject
 {
     Q_OBJECT
 
 public:
     explicit ConfigurationProfileManager(QObject *parent = nullptr);
+    ~ConfigurationProfileManager() override;
     
     // Profile management
     QStringList getProfileNames() const;
@@ -47,6 +59,14 @@ public:
     // Default profiles
     void createDefaultProfilesIfNeeded();
     
+    // Reads the profile's ROM, cartridge, disk and cassette images in the
+    // background so a following switch finds them in the OS file cache.
+    // A newer request cancels an older one that is still running.
+    void preloadProfileMedia(const QString& name);
+    
+    // Media files larger than this are not preloaded
+    static constexpr qint64 kMaxPreloadFileBytes = 16 * 1024 * 1024;
+    
 signals:
     void profileChanged(const QString& profileName);
     void profileListChanged();
@@ -58,10 +78,25 @@ public slots:
     void refreshProfileList();
 
 private:
+    struct IndexEntry {
+        ConfigurationProfile profile;
+        QDateTime modified;
+        qint64 size = 0;
+    };
+    
     QString m_currentProfileName;
     QStringList m_cachedProfileList;
+    QHash<QString, IndexEntry> m_profileIndex;
+    
+    QFileSystemWatcher m_watcher;
+    QTimer m_rescanTimer;           // coalesces bursts of watcher notifications
+    QThreadPool m_ioPool;           // one thread: lastUsed writes and preloads, in order
+    std::atomic<int> m_preloadGeneration{0};
     
     void updateProfileCache();
+    void onProfileDirectoryChanged();
+    void watchProfileFiles();
+    void waitForPendingWrites();
     bool validateProfile(const ConfigurationProfile& profile) const;
 };
 
@@ -0,0 +1,129 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef CYCLEPROFILER_H
+#define CYCLEPROFILER_H
+
+#include "tracerecorder.h"
+
+#include <QVector>
+#include <QtGlobal>
+#include <unordered_map>
+#include <vector>
+
+// Exact per-address cycle profile built from the CPU's instruction trace
+// (patch 0022), with JSR/RTS and interrupt call-graph attribution.
+//
+// An instruction's cost is the distance in (scanline, cycle) to the next
+// instruction, so it includes the cycles ANTIC DMA stole and WSYNC stalls:
+// the time it really took on the machine. Counters are a flat 64K array,
+// with a separate $4000-$7FFF window per XE bank when banks are split.
+//
+// The call graph is a shadow stack keyed on the stack pointer: JSR, BRK and
+// interrupts (S dropping by 3 more than the instruction explains) push a
+// frame whose entry is the next PC; RTS, RTI and TXS pop every frame whose
+// caller's S has been reached again, so PLA/PLA-style returns and stack
+// resets do not leave stale frames. Each function gets calls, self cycles
+// and inclusive cycles (once per recursion).
+//
+// Not thread-safe; the emulator thread feeds it and publishes report()s.
+class CycleProfiler
+{
+public:
+    struct Hotspot {
+        quint16 address;
+        quint8 bank;     // 0 unless banks are split and the address is in $4000-$7FFF
+        quint64 cycles;
+        quint64 instructions;
+    };
+
+    struct Function {
+        quint16 entry;
+        quint8 bank;
+        bool interrupt;  // entered by NMI/IRQ/BRK rather than JSR
+        quint64 calls;
+        quint64 selfCycles;
+        quint64 inclusiveCycles;
+    };
+
+    struct Report {
+        quint64 generation = 0;
+        quint64 frames = 0;
+        quint64 cycles = 0;
+        quint64 instructions = 0;
+        bool splitBanks = false;
+        QVector<Hotspot> hotspots;    // by cycles, descending
+        QVector<Function> functions;  // by inclusive cycles, descending
+    };
+
+    static constexpr int kCyclesPerLine = 114;
+    static constexpr int kMaxCallDepth = 64;
+
+    CycleProfiler();
+
+    /// 312 for PAL, 262 for NTSC; used where a frame wraps between two records.
+    void setLinesPerFrame(int lines) { m_linesPerFrame = lines; }
+    /// Count $4000-$7FFF per XE bank; takes effect after reset().
+    void setSplitBanks(bool split) { m_splitBanksRequested = split; }
+    void reset();
+
+    /// Feed one frame's records in execution order. continuous is false when
+    /// records were lost since the previous frame (the core's buffer overflowed),
+    /// so the last instruction of the previous frame is not timed across the gap.
+    void addFrame(const TraceRecorder::RawRecord* records, int count, bool continuous = true);
+
+    quint64 cycles() const { return m_cycles; }
+    quint64 instructions() const { return m_instructions; }
+    quint64 frames() const { return m_frames; }
+    quint64 cyclesAt(quint16 address, int bank = 0) const;
+    int callDepth() const { return static_cast<int>(m_stack.size()); }
+
+    /// The top addresses and functions; open frames count up to now.
+    Report report(int topAddresses, int topFunctions) const;
+
+private:
+    struct Counter {
+        quint64 cycles = 0;
+        quint64 instructions = 0;
+    };
+
+    struct FunctionStats {
+        quint64 calls = 0;
+        quint64 selfCycles = 0;
+        quint64 inclusiveCycles = 0;
+    };
+
+    struct Frame {
+        quint32 key;
+        FunctionStats* stats;
+        int callerStack;    // S to return to
+        quint64 startCycles;
+    };
+
+    void account(const TraceRecorder::RawRecord& record, const TraceRecorder::RawRecord& next);
+    Counter& counter(quint16 address, quint8 bank);
+    quint32 functionKey(quint16 entry, quint8 bank, bool interrupt) const;
+    void push(quint16 entry, quint8 bank, bool interrupt, int callerStack);
+    void unwind(int stack);
+
+    int m_linesPerFrame = 312;
+    bool m_splitBanksRequested = false;
+    bool m_splitBanks = false;
+    std::vector<Counter> m_counters;
+    std::unordered_map<int, std::vector<Counter>> m_bankCounters;  // bank -> $4000-$7FFF
+    std::unordered_map<quint32, FunctionStats> m_functions;         // element addresses are stable
+    FunctionStats m_root;
+    std::vector<Frame> m_stack;
+    TraceRecorder::RawRecord m_pending = {};
+    bool m_hasPending = false;
+    quint64 m_cycles = 0;
+    quint64 m_instructions = 0;
+    quint64 m_frames = 0;
+    quint64 m_generation = 0;
+};
+
+#endif // CYCLEPROFILER_H
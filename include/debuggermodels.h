@@ -0,0 +1,104 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef DEBUGGERMODELS_H
+#define DEBUGGERMODELS_H
+
+#include <QAbstractListModel>
+#include <QAbstractTableModel>
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <vector>
+
+// The whole 64 KB address space (or, after setRegion(), an XE bank or a
+// cartridge image) as rows of 16 bytes plus an ATASCII column, for a
+// QTableView that only paints the visible rows. refresh()
+// compares memory with the previous snapshot and emits dataChanged() just
+// for the rows that differ; bytes changed by the latest refresh are shown
+// highlighted until the next one.
+class MemoryViewModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kBytesPerRow = 16;
+    static constexpr int kRows = 0x10000 / kBytesPerRow;
+    static constexpr int kAsciiColumn = kBytesPerRow;
+
+    explicit MemoryViewModel(QObject* parent = nullptr);
+
+    /// Shows size bytes (a multiple of kBytesPerRow) with rows labelled from
+    /// baseAddress, primed by the next refresh(). The default is the 64 KB CPU view.
+    void setRegion(int size, int baseAddress = 0);
+    int regionSize() const { return static_cast<int>(m_snapshot.size()); }
+    int baseAddress() const { return m_baseAddress; }
+
+    /// memory holds regionSize() bytes. Returns the number of changed rows.
+    int refresh(const unsigned char* memory);
+    bool isChanged(int address) const { return m_changed[address] != 0; }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    std::vector<unsigned char> m_snapshot;
+    std::vector<unsigned char> m_changed;  // per byte, set by the latest refresh
+    QVector<int> m_highlightedRows;        // rows holding m_changed bytes
+    int m_baseAddress = 0;
+    int m_addressDigits = 4;
+    bool m_primed = false;
+};
+
+// The disassembly listing around the PC: one row per instruction, formatted
+// with the shared 6502 decoder. refresh() rebuilds the lines and emits
+// dataChanged() only for rows whose text changed (a full reset only when the
+// line count changes); the PC row is highlighted, and so are instructions
+// whose bytes changed at an unchanged address (self-modifying code). With
+// symbol labels, labelled addresses get a "START:" row of their own and
+// operands are shown by name.
+class DisassemblyModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kLineLength = 72;  // "-> E477: AD 00 D0 LDA $D000" with a 32-character label, plus NUL
+
+    explicit DisassemblyModel(QObject* parent = nullptr);
+
+    /// Decode up to maxLines instructions from start, stopping once more than
+    /// maxForward bytes past currentPC. Returns the number of changed rows.
+    int refresh(const unsigned char* memory, unsigned short start, unsigned short currentPC,
+                int maxLines, int maxForward, const QSet<unsigned short>& breakpoints,
+                const QHash<unsigned short, QByteArray>* labels = nullptr);
+    void clear();
+    /// Row of the instruction at the PC, -1 if it is not in the listing.
+    int currentRow() const { return m_currentRow; }
+    QString lineText(int row) const;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    struct Line {
+        unsigned short address;
+        bool changed;
+        bool label;  // a "NAME:" row ahead of the instruction at address
+        char text[kLineLength];
+    };
+
+    static int formatLine(const unsigned char* memory, unsigned short pc, bool isCurrent,
+                          bool isBreakpoint, const QHash<unsigned short, QByteArray>* labels, char* out);
+
+    QVector<Line> m_lines;
+    int m_currentRow = -1;
+};
+
+#endif // DEBUGGERMODELS_H
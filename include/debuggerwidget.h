@@ -14,16 +14,24 @@
 #include <QGroupBox>
 #include <QLabel>
 #include <QPushButton>
-#include <QTextEdit>
+#include <QListView>
+#include <QTableView>
 #include <QLineEdit>
 #include <QFont>
 #include <QTimer>
 #include <QSpinBox>
 #include <QListWidget>
+#include <QTableWidget>
+#include <QComboBox>
+#include <QCheckBox>
 #include <QSet>
 #include <QPointer>
+#include <QPlainTextEdit>
 #include "atariemulator.h"
 
+class MemoryViewModel;
+class DisassemblyModel;
+
 class DebuggerWidget : public QWidget
 {
     Q_OBJECT
@@ -49,6 +57,9 @@ public slots:
     void onAddBreakpointClicked();
     void onRemoveBreakpointClicked();
     void onBreakpointSelectionChanged();
+    void onLoadLabelsClicked();
+    void onProfileToggleClicked();
+    void onProfileResetClicked();
 
 private slots:
     void refreshDebugInfo();
@@ -69,11 +80,13 @@ private:
     void updateMemoryDisplay();
     void updateCurrentInstruction();
     void updateDisassemblyDisplay();
+    void updateProfilerDisplay(bool force = false);
+    void updateMemoryBanks(int extendedBanks, int cartridgeSize);
+    void updateHardwareRegisters(const MachineSnapshot& snapshot);
+    MachineSnapshot captureSnapshot(int sections) const;
     QString formatHexByte(unsigned char value);
     QString formatHexWord(unsigned short value);
     QString formatCurrentInstruction(unsigned short pc);
-    QString formatInstructionLine(unsigned short pc, bool isCurrent = false);
-    int getInstructionSize(unsigned char opcode);
     bool isSubroutineCall(unsigned char opcode);
     void stepSingleInstruction();
     void stepOverSubroutine();
@@ -107,12 +120,20 @@ private:
     // Memory Viewer UI
     QGroupBox* m_memoryGroup;
     QSpinBox* m_memoryAddressSpinBox;
-    QTextEdit* m_memoryTextEdit;
+    QComboBox* m_memoryBankCombo;          // 0: CPU view, 1..n: XE bank, -1: cartridge
+    MemoryViewModel* m_memoryModel;
+    QTableView* m_memoryView;
+
+    // Chip registers from a machine snapshot, captured only while shown
+    QGroupBox* m_hardwareGroup;
+    QPlainTextEdit* m_hardwareView;
     
     // Disassembly UI
     QGroupBox* m_disassemblyGroup;
     QLabel* m_currentInstructionLabel;
-    QTextEdit* m_disassemblyTextEdit;
+    QPushButton* m_loadLabelsButton;
+    DisassemblyModel* m_disassemblyModel;
+    QListView* m_disassemblyView;
     
     // Breakpoint UI
     QGroupBox* m_breakpointGroup;
@@ -121,6 +142,16 @@ private:
     QPushButton* m_removeBreakpointButton;
     QPushButton* m_clearBreakpointsButton;
     QListWidget* m_breakpointListWidget;
+
+    // Profiler: the emulator's published report, repainted when it changes
+    QGroupBox* m_profilerGroup;
+    QPushButton* m_profileToggleButton;
+    QPushButton* m_profileResetButton;
+    QCheckBox* m_profileSplitBanksCheck;
+    QComboBox* m_profileViewCombo;
+    QLabel* m_profileSummaryLabel;
+    QTableWidget* m_profileTable;
+    quint64 m_profileGeneration = 0;
     
     // State tracking
     bool m_isRunning;
@@ -130,9 +161,6 @@ private:
     // Breakpoint data
     QSet<unsigned short> m_breakpoints;
     unsigned short m_lastPC;  // Track PC changes for breakpoint detection
-    
-    static const int MEMORY_DISPLAY_ROWS = 20;  // Increased to 20 for more memory context
-    static const int MEMORY_DISPLAY_COLS = 16;
 };
 
 #endif // DEBUGGERWIDGET_H
\ No newline at end of file
@@ -8,19 +8,80 @@
 #ifndef DISASM6502_H
 #define DISASM6502_H
 
-#include <QString>
+// 6502 addressing modes
+enum class AddressMode6502 : unsigned char {
+    Implied,      // No operand
+    Accumulator,  // Operates on accumulator
+    Immediate,    // #$nn
+    ZeroPage,     // $nn
+    ZeroPageX,    // $nn,X
+    ZeroPageY,    // $nn,Y
+    Absolute,     // $nnnn
+    AbsoluteX,    // $nnnn,X
+    AbsoluteY,    // $nnnn,Y
+    Indirect,     // ($nnnn)
+    IndirectX,    // ($nn,X)
+    IndirectY,    // ($nn),Y
+    Relative      // Branch instructions
+};
+
+// How an instruction changes the flow of control, for step over and code walks
+enum class FlowKind6502 : unsigned char {
+    None,                // falls through to the next instruction
+    Branch,              // conditional, relative
+    Jump,                // JMP $nnnn
+    JumpIndirect,        // JMP ($nnnn)
+    Call,                // JSR
+    Return,              // RTS
+    ReturnFromInterrupt, // RTI
+    Break                // BRK
+};
 
-struct DisassembledInstruction {
-    QString mnemonic;      // Instruction mnemonic (e.g., "LDA")
-    QString operand;       // Operand string (e.g., "#$FF", "$1234,X")
-    int bytes;             // Total instruction length
-    unsigned char opcode;  // The opcode byte
+struct OpcodeInfo6502 {
+    char mnemonic[4];      // "LDA"; "???" for undocumented opcodes
+    AddressMode6502 mode;
+    unsigned char bytes;   // total length including the opcode
+    unsigned char cycles;  // base count: +1 on a page cross or a taken branch; 0 if undocumented
+    FlowKind6502 flow;
 };
 
-// Disassemble a single 6502 instruction at the given address
-// memory: pointer to memory array
-// address: current address to disassemble
-// maxAddress: maximum valid address (usually 65535)
-DisassembledInstruction disassemble6502(const unsigned char* memory, unsigned short address, unsigned short maxAddress = 65535);
+// The one 6502 decoding table, shared by the debugger window, debug.disassemble
+// and step over; indexed by opcode.
+extern const OpcodeInfo6502 kOpcodeTable6502[256];
+
+inline const OpcodeInfo6502& opcodeInfo6502(unsigned char opcode)
+{
+    return kOpcodeTable6502[opcode];
+}
+
+// Longest text written by the formatters below, including the terminating NUL
+constexpr int kInstructionText6502 = 16;
+
+// Write the instruction at address as text ("LDA $1234,X", branch targets
+// resolved) into out, which needs kInstructionText6502 bytes, and return its
+// length in bytes. memory is the full 64 KB address space; operands wrap at $FFFF.
+int formatInstruction6502(const unsigned char* memory, unsigned short address, char* out);
+
+// Label lookup for formatInstructionSymbolic6502: the name for an address, or nullptr
+typedef const char* (*LabelLookup6502)(unsigned short address, const void* context);
+
+// Longest label formatInstructionSymbolic6502 writes; longer ones are cut
+constexpr int kMaxLabelText6502 = 32;
+// Output size needed by formatInstructionSymbolic6502, including the NUL
+constexpr int kSymbolicText6502 = kInstructionText6502 + kMaxLabelText6502;
+
+// As formatInstruction6502, but an operand address that has a label is written
+// as the label ("JSR PRINT", "LDA (PTR),Y"); immediates stay numeric. out needs
+// kSymbolicText6502 bytes.
+int formatInstructionSymbolic6502(const unsigned char* memory, unsigned short address,
+                                  LabelLookup6502 lookup, const void* context, char* out);
+
+// The address an instruction's operand refers to (branch targets resolved);
+// false for implied, accumulator and immediate operands.
+bool operandAddress6502(const unsigned char* memory, unsigned short address, unsigned short* target);
+
+// Write the instruction's bytes as hex ("AD 00 D0") into out, which needs
+// kInstructionText6502 bytes, and return the number of characters written.
+int formatInstructionBytes6502(const unsigned char* memory, unsigned short address, char* out);
 
-#endif // DISASM6502_H
\ No newline at end of file
+#endif // DISASM6502_H
@@ -0,0 +1,99 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef DISKIMAGECACHE_H
+#define DISKIMAGECACHE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <QTemporaryDir>
+#include <QVector>
+
+// Disk images kept in memory across mounts, with copy-on-write overlays.
+//
+// image() reads a file once and hands out the same (implicitly shared) bytes
+// until the file's size or timestamp changes, so mounting one ATR hundreds of
+// times costs one read. An overlay gives a drive a scratch copy of the image,
+// written from the cache into a private directory (the runtime directory,
+// which is RAM-backed on most Linux systems, else the temp directory): the
+// core reads and writes that copy and the original is never touched until
+// commitOverlay() writes the changes back. changedSectors() diffs the scratch
+// copy against the pristine bytes.
+//
+// Not thread-safe; AtariEmulator uses it from the thread that mounts disks.
+class DiskImageCache
+{
+public:
+    /// Scratch copies go in a new directory under workBase (default as above).
+    explicit DiskImageCache(const QString& workBase = QString());
+
+    /// Pristine contents of the image at path, or an empty array on a read error.
+    QByteArray image(const QString& path, QString* error = nullptr);
+    int cachedImageCount() const { return m_images.size(); }
+    qint64 cachedBytes() const { return m_cachedBytes; }
+    /// Least recently used images are dropped past this; overlays keep their own.
+    void setMaxCachedBytes(qint64 bytes);
+    static constexpr qint64 kDefaultMaxCachedBytes = 64 * 1024 * 1024;
+
+    /// Starts an overlay for drive and returns the scratch copy to mount,
+    /// or an empty string on failure. Replaces any overlay the drive had.
+    QString beginOverlay(int drive, const QString& imagePath, QString* error = nullptr);
+    bool hasOverlay(int drive) const { return m_overlays.contains(drive); }
+    /// The image the overlay was made from.
+    QString overlaySource(int drive) const { return m_overlays.value(drive).source; }
+    QString overlayWorkingPath(int drive) const { return m_overlays.value(drive).workingPath; }
+    /// True when the scratch copy differs from the image it was made from.
+    bool overlayChanged(int drive) const;
+    /// 1-based sectors that differ; empty for formats without plain sectors (ATX, PRO).
+    QVector<int> changedSectors(int drive) const;
+    /// Contents of one sector of the scratch copy, or empty if out of range.
+    QByteArray overlaySector(int drive, int sector) const;
+    /// Writes the scratch copy over its source and ends the overlay. The core
+    /// must have closed the copy first, so nothing is left in its buffers.
+    bool commitOverlay(int drive, QString* error = nullptr);
+    /// Ends the overlay and deletes the scratch copy.
+    void discardOverlay(int drive);
+
+    // Where the sectors of an ATR or XFD image are
+    struct Layout {
+        int headerBytes = 0;
+        int bootSectorSize = 128;  // sectors 1-3
+        int sectorSize = 128;
+        int sectorCount = 0;
+        int offset(int sector) const;
+        int size(int sector) const { return sector <= 3 ? bootSectorSize : sectorSize; }
+    };
+    static bool layoutOf(const QByteArray& image, Layout* layout);
+    static QVector<int> diffSectors(const QByteArray& before, const QByteArray& after);
+
+private:
+    struct Entry {
+        qint64 size = 0;
+        QDateTime modified;
+        QByteArray bytes;
+        quint64 lastUse = 0;
+    };
+    struct Overlay {
+        QString source;
+        QString workingPath;
+        QByteArray pristine;
+    };
+
+    QByteArray readWorkingCopy(int drive) const;
+    void evict();
+
+    QHash<QString, Entry> m_images;  // by canonical path
+    qint64 m_cachedBytes = 0;
+    qint64 m_maxCachedBytes = kDefaultMaxCachedBytes;
+    quint64 m_useCounter = 0;
+    QHash<int, Overlay> m_overlays;
+    QTemporaryDir m_workDirectory;
+};
+
+#endif // DISKIMAGECACHE_H
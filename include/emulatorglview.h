@@ -0,0 +1,105 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef EMULATORGLVIEW_H
+#define EMULATORGLVIEW_H
+
+#include <QOpenGLWidget>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLFramebufferObject>
+#include <QImage>
+#include <QVector>
+#include <QRect>
+
+// Optional GPU presentation path for EmulatorWidget.
+//
+// Displays the raw 8-bit indexed Atari frame (Format_Indexed8, palette in
+// colorTable()) by uploading the indices as a texture and resolving the palette
+// and scaling in a fragment shader, so neither colour conversion nor scaling
+// runs on the CPU. The view is a mouse-transparent child covering its parent;
+// keyboard focus and drag-and-drop stay with EmulatorWidget.
+//
+// With CRT effects on, drawing takes two passes. The decode pass resolves the
+// frame into an RGB framebuffer at source resolution (twice as wide for NTSC
+// composite decoding, which models the luma/chroma crosstalk that makes hi-res
+// artifact colours) and keeps a share of the previous decoded frame for
+// phosphor persistence. The present pass scales that to the display rect with
+// barrel curvature and scanlines. With every effect off the single-pass path
+// above is used unchanged.
+class EmulatorGLView : public QOpenGLWidget, protected QOpenGLFunctions
+{
+    Q_OBJECT
+
+public:
+    explicit EmulatorGLView(QWidget* parent = nullptr);
+    ~EmulatorGLView() override;
+
+    /// Frame to draw on the next paint. Must remain valid until the next call
+    /// (EmulatorWidget passes the FrameExchange front buffer).
+    void setFrame(const QImage* indexedFrame);
+    /// Target rectangle in widget coordinates (EmulatorWidget::calculateDisplayRect()).
+    void setDisplayRect(const QRect& rect);
+    /// Bilinear filtering of the palette-resolved colours; nearest-neighbour when false.
+    void setSmoothScaling(bool smooth);
+    /// Swap interval 1 (buffer swaps wait for the display's vertical blank) or 0.
+    /// The context takes it when it is created, so call it before the first show().
+    void setVSync(bool enabled);
+
+    struct CrtEffects {
+        bool ntscComposite = false;  // decode the frame as an NTSC composite signal
+        float scanlines = 0.0f;      // 0..1: how dark the gaps between source rows get
+        float persistence = 0.0f;    // 0..0.9: share of the previous frame that lingers
+        float curvature = 0.0f;      // 0..1: barrel distortion of the picture
+
+        bool operator==(const CrtEffects& other) const
+        {
+            return ntscComposite == other.ntscComposite && scanlines == other.scanlines &&
+                   persistence == other.persistence && curvature == other.curvature;
+        }
+        bool operator!=(const CrtEffects& other) const { return !(*this == other); }
+        bool isEnabled() const { return ntscComposite || scanlines > 0.0f || persistence > 0.0f || curvature > 0.0f; }
+    };
+    void setCrtEffects(const CrtEffects& effects);
+
+signals:
+    /// Shader compilation or context creation failed; the owner should fall back to
+    /// the QPainter path.
+    void initializationFailed();
+
+protected:
+    void initializeGL() override;
+    void paintGL() override;
+
+private:
+    void uploadPalette(const QVector<QRgb>& colors);
+    void uploadFrame();
+    void drawQuad(QOpenGLShaderProgram* program);
+    void setViewportToDisplayRect();
+    bool ensureDecodeTargets(int width, int height);
+    void paintCrt();
+    void releaseGL();
+
+    const QImage* m_frame = nullptr;
+    QRect m_displayRect;
+    bool m_smoothScaling = true;
+
+    QOpenGLShaderProgram* m_program = nullptr;
+    QOpenGLShaderProgram* m_decodeProgram = nullptr;   // CRT pass 1: frame -> RGB target
+    QOpenGLShaderProgram* m_presentProgram = nullptr;  // CRT pass 2: target -> display rect
+    // Decode targets, swapped each new frame so the previous one feeds persistence
+    QOpenGLFramebufferObject* m_decodeTargets[2] = {nullptr, nullptr};
+    int m_currentTarget = 0;
+    bool m_frameDecoded = false;  // the current frame is already in m_decodeTargets[m_currentTarget]
+    CrtEffects m_crtEffects;
+    GLuint m_indexTexture = 0;
+    GLuint m_paletteTexture = 0;
+    QVector<QRgb> m_uploadedPalette;
+    bool m_glReady = false;
+};
+
+#endif // EMULATORGLVIEW_H
@@ -20,6 +20,9 @@
 #include <QDropEvent>
 #include "atariemulator.h"
 
+class EmulatorGLView;
+class PerformanceOverlay;
+
 class EmulatorWidget : public QWidget
 {
     Q_OBJECT
@@ -29,6 +32,20 @@ public:
 
     void setEmulator(AtariEmulator* emulator);
     void setScalingSettings(bool integerScaling, bool scalingFilter, const QString& fitScreen, bool keepAspectRatio, double overscanFactor);
+    /// Present through EmulatorGLView (GPU palette lookup + scaling) instead of QPainter.
+    void setGpuPresentation(bool enabled);
+    bool isGpuPresentation() const { return m_glView != nullptr; }
+    /// CRT effects of the GPU path (EmulatorGLView::CrtEffects), in percent; kept
+    /// while the QPainter path is active and applied when GPU presentation starts.
+    void setCrtEffects(bool ntscComposite, int scanlinesPercent, int persistencePercent, int curvaturePercent);
+    /// V-sync: the GPU path swaps on the display's vertical blank and presents at
+    /// most one frame per refresh, always the newest one the emulator published,
+    /// and the emulator's frame pacing is locked to the refresh rate when it is
+    /// close enough (AtariEmulator::setDisplayRefreshLock()).
+    void setVSync(bool enabled);
+    /// Show the emulator's PerformanceMonitor over the top-left corner of the display.
+    void setPerformanceOverlay(bool enabled);
+    bool isPerformanceOverlay() const { return m_performanceOverlay != nullptr; }
 
 signals:
     void diskDroppedOnEmulator(const QString& filename);
@@ -36,6 +53,7 @@ signals:
 protected:
     void paintEvent(QPaintEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
+    void showEvent(QShowEvent *event) override;
     bool event(QEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
     void keyReleaseEvent(QKeyEvent *event) override;
@@ -47,15 +65,23 @@ protected:
     void dropEvent(QDropEvent* event) override;
 
 private slots:
-    void updateDisplay(const QImage& image);
+    void updateDisplay();
 
 private:
     QRect calculateDisplayRect() const;
+    // Widget area showing the given rectangle of the 384x240 frame
+    QRect frameToWidgetRect(const QRect& frameRect) const;
+    void updateGlViewGeometry();
+    void applyCrtEffects();
+    void updateRefreshLock();
+    void presentNextGlFrame();
+    void recordPresentLatency(const FrameExchange* exchange);
     bool isValidExecutableFile(const QString& fileName) const;
     bool isValidDiskFile(const QString& fileName) const;
 
     AtariEmulator* m_emulator;
-    QImage m_screenImage;
+    QImage m_screenImage;  // Black placeholder until an emulator is attached
+    EmulatorGLView* m_glView;  // Non-null while GPU presentation is active
 
     // Video scaling settings
     bool m_integerScaling;
@@ -63,6 +89,22 @@ private:
     QString m_fitScreen;
     bool m_keepAspectRatio;
     double m_overscanFactor;
+
+    // CRT effects for the GPU path
+    bool m_ntscComposite = false;
+    int m_scanlinesPercent = 0;
+    int m_persistencePercent = 0;
+    int m_curvaturePercent = 0;
+
+    // V-sync presentation: while a frame waits for its buffer swap, newer frames
+    // stay in the exchange and the swap picks up the latest
+    bool m_vSync = false;
+    bool m_glSwapPending = false;
+    QTimer* m_glSwapWatchdog;  // gives up on a swap that never comes (hidden window)
+    bool m_screenChangeConnected = false;
+
+    PerformanceOverlay* m_performanceOverlay = nullptr;
+    quint64 m_lastMeasuredSequence = 0;  // newest frame whose present latency was recorded
     
     // Screen buffer constants - show full screen without cropping
     static const int SCREEN_WIDTH = 384;
@@ -74,6 +116,7 @@ private:
     static constexpr double MIN_OVERSCAN_FACTOR = 0.95;
     static constexpr double MAX_OVERSCAN_FACTOR = 1.05;
     static constexpr double DEFAULT_OVERSCAN_FACTOR = 1.0;
+    static constexpr int kGlSwapTimeoutMs = 100;
 };
 
 #endif // EMULATORWIDGET_H
\ No newline at end of file
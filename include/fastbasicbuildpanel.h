@@ -11,11 +11,16 @@
 #include <QWidget>
 #include <QComboBox>
 #include <QPushButton>
+#include <QCheckBox>
 #include <QProcess>
 #include <QString>
 #include <QLabel>
+#include <QHash>
+#include <QByteArray>
 
 class MainWindow;
+class QFileSystemWatcher;
+class QTimer;
 
 class FastbasicBuildPanel : public QWidget
 {
@@ -36,6 +41,8 @@ private slots:
     void onShowOutput();
     void onProcessFinished(int exitCode, QProcess::ExitStatus status);
     void onProcessError(QProcess::ProcessError error);
+    void onWatchToggled(bool enabled);
+    void onSourceChanged();
 
 private:
     QString resolveCompilerPath() const;
@@ -44,6 +51,19 @@ private:
     void updatePathLabel();
     void rescanFileListKeepingSelection();
     void showOutputDialog();
+    void reportBuildFailure(const QString& status);
+    void deployXex(const QByteArray& xex, const QString& stem);
+    QByteArray buildKey(const QString& basPath, const QString& compiler) const;
+    void updateWatchedFile();
+
+    // Last good build of each source, so an unchanged source is never recompiled
+    struct Artifact {
+        QByteArray key;  // hash of the source and the compiler that built it
+        QByteArray xex;
+    };
+    QHash<QString, Artifact> m_artifacts;  // by source path
+    QString m_buildSource;
+    QByteArray m_buildKey;
 
     MainWindow* m_mainWindow;
     QComboBox* m_fileCombo;
@@ -51,6 +71,10 @@ private:
     QLabel* m_pathLabel;
     QPushButton* m_runButton;
     QPushButton* m_showOutputButton;
+    QCheckBox* m_watchCheck;
+    QFileSystemWatcher* m_watcher;
+    QTimer* m_rebuildTimer;  // debounces editors that save in several steps
+    bool m_autoBuild = false;  // the running build was started by the watcher
     QProcess* m_process;
     QString m_lastOutput;
     QString m_currentFolder;
@@ -0,0 +1,85 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef FRAMECHECKSUMSTREAM_H
+#define FRAMECHECKSUMSTREAM_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+// Per-frame fingerprints of RAM and the indexed screen, for diffing two runs
+// (two builds, or two libatari800 patch sets) down to the first frame where
+// they diverge without storing snapshots.
+//
+// The newest capacity entries stay in a ring that clients read by cursor: an
+// entry's sequence number counts every entry added since start(), so reads
+// stay consistent when rewinding moves the frame number back. Optionally every
+// entry is also appended to a text file, one line per frame:
+//
+//   <frame> <ram xxh64> <screen xxh64>      decimal, then 16 hex digits each
+//
+// so `cmp` or `diff` of two files from the same start finds the divergence.
+//
+// Not thread-safe; AtariEmulator uses it on the emulator thread.
+class FrameChecksumStream
+{
+public:
+    struct Entry {
+        quint64 sequence = 0;
+        quint64 frame = 0;
+        quint64 ram = 0;
+        quint64 screen = 0;
+    };
+
+    FrameChecksumStream() = default;
+    ~FrameChecksumStream();
+    FrameChecksumStream(const FrameChecksumStream&) = delete;
+    FrameChecksumStream& operator=(const FrameChecksumStream&) = delete;
+
+    /// Clears the ring and starts recording; path may be empty for ring only.
+    bool start(int capacity, const QString& path, QString* error = nullptr);
+    /// Flushes and closes the file; the ring stays readable until the next start().
+    void stop();
+    bool isActive() const { return m_active; }
+
+    void add(quint64 frame, const void* ram, int ramSize, const void* screen, int screenSize);
+
+    /// Up to max entries with sequence >= cursor, oldest first. *dropped is set
+    /// to the number of entries after cursor that the ring has already overwritten.
+    QVector<Entry> read(quint64 cursor, int max, quint64* dropped = nullptr) const;
+
+    /// Sequence number the next entry will get, i.e. the cursor after the newest
+    quint64 nextSequence() const { return m_added; }
+    int size() const { return m_size; }
+    int capacity() const { return m_ring.size(); }
+    QString path() const { return m_path; }
+
+    /// 64-bit xxHash (XXH64) of size bytes; four independent lanes per 32-byte stripe.
+    static quint64 hash(const void* data, int size, quint64 seed = 0);
+    /// The file format's line for an entry, including the newline
+    static QByteArray formatLine(const Entry& entry);
+
+    static constexpr int kDefaultCapacity = 3600;
+    static constexpr int kMaxCapacity = 1 << 20;
+
+private:
+    void flushFile();
+
+    QVector<Entry> m_ring;
+    int m_head = 0;   // slot the next entry goes to
+    int m_size = 0;
+    quint64 m_added = 0;
+    bool m_active = false;
+    QString m_path;
+    QFile m_file;
+    QByteArray m_pending;  // lines not yet written to m_file
+};
+
+#endif // FRAMECHECKSUMSTREAM_H
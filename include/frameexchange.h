@@ -0,0 +1,70 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef FRAMEEXCHANGE_H
+#define FRAMEEXCHANGE_H
+
+#include <QImage>
+#include <QRect>
+#include <atomic>
+
+// Lock-free triple buffer for handing rendered frames from the emulator thread
+// to the GUI thread without per-frame allocation.
+//
+// The producer renders into backBuffer() and calls publish(); the consumer calls
+// acquire() and paints frontBuffer(). Each side owns one buffer exclusively and
+// the third ("middle") one is swapped atomically, so neither side ever waits and
+// the QImages are never shared, i.e. never detached. If the producer publishes
+// again before the consumer acquired the previous frame, that frame is dropped
+// and the consumer always sees the newest one.
+class FrameExchange
+{
+public:
+    FrameExchange(int width, int height, QImage::Format format);
+
+    // Producer side (emulator thread)
+    QImage& backBuffer() { return m_buffers[m_back]; }
+    /// Publish the back buffer. Returns true when the consumer had already taken the
+    /// previous frame, i.e. when it needs a new notification; false when an unseen
+    /// frame was replaced (a notification for it is still pending). sequence travels
+    /// with the buffer, e.g. the emulated frame number it was rendered at. dirty is the
+    /// part that differs from the previously published frame (null: all of it); when an
+    /// unseen frame is replaced its dirty area is carried over.
+    bool publish(quint64 sequence = 0, const QRect& dirty = QRect());
+
+    // Consumer side (GUI thread)
+    /// Swap in the newest published frame. Returns false if nothing new was published.
+    bool acquire();
+    const QImage& frontBuffer() const { return m_buffers[m_front]; }
+    /// Sequence number the front buffer was published with.
+    quint64 frontSequence() const { return m_sequences[m_front]; }
+    /// Area of the front buffer that changed since the previously acquired frame.
+    QRect frontDirtyRect() const { return m_dirtyRects[m_front]; }
+    /// Steady clock (microseconds since its epoch) when the front buffer was published.
+    qint64 frontPublishTimeUs() const { return m_publishTimesUs[m_front]; }
+
+    /// Frames that were published but replaced before the consumer acquired them.
+    quint64 droppedFrames() const { return m_droppedFrames.load(std::memory_order_relaxed); }
+    quint64 publishedFrames() const { return m_publishedFrames.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int kIndexMask = 0x3;
+    static constexpr int kFreshBit  = 0x4;
+
+    QImage m_buffers[3];
+    quint64 m_sequences[3] = {};      // owned with the buffer of the same index
+    QRect m_dirtyRects[3];            // likewise
+    qint64 m_publishTimesUs[3] = {};  // likewise
+    QRect m_lastPublishedDirty;       // owned by the producer
+    int m_back;                       // owned by the producer
+    int m_front;                      // owned by the consumer
+    std::atomic<int> m_middle;        // index | kFreshBit when unseen
+    std::atomic<quint64> m_droppedFrames{0};
+    std::atomic<quint64> m_publishedFrames{0};
+};
+
+#endif // FRAMEEXCHANGE_H
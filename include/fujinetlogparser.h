@@ -0,0 +1,98 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef FUJINETLOGPARSER_H
+#define FUJINETLOGPARSER_H
+
+#include <QByteArray>
+#include <QByteArrayMatcher>
+#include <QRegularExpression>
+#include <QString>
+#include <QVector>
+
+// Streaming parser for FujiNet-PC's stdout/stderr.
+//
+// Output arrives in arbitrary chunks. The parser splits them into lines on
+// QByteArray, without converting to QString, and keeps a trailing partial line
+// for the next chunk. Real newlines and the literal "\n" / "\r\n" that
+// FujiNet-PC sometimes prints both end a line. Each line is scanned for SIO
+// disk activity with precompiled matchers: a "CF: 3x ..." command frame names
+// the drive, a following "ATR/ATX/XEX READ" or "ATR WRITE" starts an operation
+// and "COMPLETE" ends one. Lines that pass the log filter are handed back for
+// logging. The filter is set once, not looked up per line.
+class FujiNetLogParser
+{
+public:
+    struct DriveEvent {
+        enum Type { Start, Complete };
+        Type type = Start;
+        int drive = 0;         // 1-8 for Start; Complete ends the oldest pending operation
+        bool writing = false;
+    };
+
+    FujiNetLogParser();
+
+    /// Include-only filter on log lines: empty shows everything, as does an invalid regex.
+    void setFilter(const QString& filter, bool useRegex);
+    bool acceptsLine(const QByteArray& line) const;
+
+    /// Consumes one chunk of output. Drive activity in each complete line is appended
+    /// to events; the trimmed non-empty lines the filter accepts are appended to
+    /// logLines unless it is null. nowMs is any monotonic clock in milliseconds.
+    void feed(const QByteArray& chunk, qint64 nowMs, QVector<DriveEvent>& events,
+              QVector<QByteArray>* logLines);
+    /// Processes a pending partial line, e.g. when the process exits.
+    void flush(qint64 nowMs, QVector<DriveEvent>& events, QVector<QByteArray>* logLines);
+    void reset();
+
+    /// A command frame's drive is forgotten if no operation follows within this time.
+    static constexpr qint64 kDeviceIdTimeoutMs = 500;
+    /// A partial line longer than this is processed as it is.
+    static constexpr int kMaxLineBytes = 4096;
+
+private:
+    void processLine(const QByteArray& rawLine, qint64 nowMs, QVector<DriveEvent>& events,
+                     QVector<QByteArray>* logLines);
+    void parseDeviceId(const QByteArray& line, int cfIndex, qint64 nowMs);
+
+    QByteArray m_partial;
+    int m_deviceId = -1;
+    qint64 m_deviceIdMs = 0;
+
+    QByteArray m_filter;  // UTF-8, for substring filters
+    bool m_useRegex = false;
+    QRegularExpression m_regex;
+
+    QByteArrayMatcher m_commandFrame;
+    QByteArrayMatcher m_atrRead;
+    QByteArrayMatcher m_atrWrite;
+    QByteArrayMatcher m_atxRead;
+    QByteArrayMatcher m_xexRead;
+    QByteArrayMatcher m_complete;
+};
+
+// Keeps the last capacity bytes of a stream in a fixed ring: appending never
+// reallocates or copies what is already kept.
+class LogTailBuffer
+{
+public:
+    explicit LogTailBuffer(int capacity);
+
+    void append(const QByteArray& data);
+    /// The kept bytes, oldest first.
+    QByteArray toByteArray() const;
+    int size() const { return m_size; }
+    int capacity() const { return m_ring.size(); }
+    void clear();
+
+private:
+    QByteArray m_ring;
+    int m_head = 0;  // next write position
+    int m_size = 0;
+};
+
+#endif // FUJINETLOGPARSER_H
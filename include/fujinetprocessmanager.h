@@ -14,6 +14,9 @@
 #include <QTimer>
 #include <QMap>
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QVector>
+#include "fujinetlogparser.h"
 
 class FujiNetProcessManager : public QObject
 {
@@ -47,8 +50,8 @@ public:
     ProcessState getState() const { return m_state; }
     bool isRunning() const { return m_state == Running; }
     QString getLastError() const { return m_lastError; }
-    QString getStdout() const { return m_stdoutBuffer; }
-    QString getStderr() const { return m_stderrBuffer; }
+    QString getStdout() const { return QString::fromLocal8Bit(m_stdoutTail.toByteArray()); }
+    QString getStderr() const { return QString::fromLocal8Bit(m_stderrTail.toByteArray()); }
     int getLastExitCode() const { return m_lastExitCode; }
     QProcess::ExitStatus getLastExitStatus() const { return m_lastExitStatus; }
 
@@ -64,6 +67,9 @@ public:
 
     // Output buffer management
     void clearOutputBuffers();
+    /// Re-read log/hideFujiNetLogs and the log filter from QSettings. They are cached,
+    /// not looked up per chunk of output; start() reloads them too.
+    void reloadLogSettings();
 
     // Process detection
     static bool isProcessRunningExternally(const QString& processName = "fujinet");
@@ -100,14 +106,13 @@ private:
 
     void setState(ProcessState newState);
     QString processErrorToString(QProcess::ProcessError error);
-    /** When log/filterString is set: hide lines that do not match (include-only). */
-    bool shouldFilterLogMessage(const QString& message);
 
     // FujiNet log parsing for LED activity
-    void parseFujiNetLogsForLEDActivity(const QString& output);
-    void parseDeviceId(const QString& line);
+    void ingestOutput(const QByteArray& output, bool isStderr);
+    void flushOutputParsers();
+    void dispatchLogResults(bool isStderr);
     void startDriveOperation(int driveNumber, bool isWriting);
-    void parseCompletion(const QString& line);
+    void completePendingOperation();
     void completeDriveOperation(int driveNumber);
 
     QProcess* m_process;
@@ -120,10 +125,16 @@ private:
     int m_lastExitCode;
     QProcess::ExitStatus m_lastExitStatus;
 
-    // Output buffers
-    QString m_stdoutBuffer;
-    QString m_stderrBuffer;
+    // Output: the last MAX_BUFFER_SIZE bytes of each stream, and its line parser
     static const int MAX_BUFFER_SIZE = 100000;  // 100KB max buffer
+    LogTailBuffer m_stdoutTail;
+    LogTailBuffer m_stderrTail;
+    FujiNetLogParser m_stdoutParser;
+    FujiNetLogParser m_stderrParser;
+    bool m_hideFujiNetLogs = false;
+    QElapsedTimer m_logClock;
+    QVector<FujiNetLogParser::DriveEvent> m_driveEvents;  // scratch, reused per chunk
+    QVector<QByteArray> m_logLines;
 
     // Start timeout
     QTimer* m_startTimer;
@@ -131,7 +142,6 @@ private:
 
     // FujiNet disk I/O state tracking (for LED activity)
     QMap<int, DriveIOState> m_driveStates;  // D1-D8 state tracking
-    int m_lastDeviceId = -1;                // Temporary device ID storage
 };
 
 #endif // FUJINETPROCESSMANAGER_H
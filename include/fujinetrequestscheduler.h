@@ -0,0 +1,88 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef FUJINETREQUESTSCHEDULER_H
+#define FUJINETREQUESTSCHEDULER_H
+
+#include <QHash>
+#include <QList>
+#include <QNetworkReply>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <functional>
+
+// Queue in front of the FujiNet-PC web API. FujiNet-PC serves one request at a
+// time, so firing every poll and mount at once only stacks them up behind a
+// slow one: the scheduler keeps at most maxInFlight() requests open (reusing
+// QNetworkAccessManager's keep-alive connections) and starts the rest in
+// order, user actions before background polls.
+//
+// Requests with a key coalesce: while one with the same key is queued, another
+// is dropped (raising the queued one's priority if needed); while one is in
+// flight, at most one more waits behind it, so a reply that may predate a
+// change is always followed by a fresh one but polls never pile up.
+//
+// Long-lived streams (/events, /printer/events) do not go through here.
+class FujiNetRequestScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority {
+        UserPriority,        // mounts, ejects, configuration: the user is waiting
+        BackgroundPriority   // polls and refreshes
+    };
+    /// Creates the reply when the request's turn comes; may return nullptr to skip it.
+    using Starter = std::function<QNetworkReply*()>;
+
+    explicit FujiNetRequestScheduler(QObject* parent = nullptr);
+
+    void setMaxInFlight(int requests);
+    int maxInFlight() const { return m_maxInFlight; }
+
+    /// Queues a request and starts it if there is room. Returns false when it
+    /// was coalesced into one already waiting.
+    bool enqueue(Priority priority, const QString& key, Starter start);
+
+    /// Drops queued requests of that priority or lower without starting them.
+    void cancelQueued(Priority from = UserPriority);
+    /// Drops everything queued and aborts what is in flight.
+    void cancelAll();
+
+    int queuedCount() const { return m_queues[UserPriority].size() + m_queues[BackgroundPriority].size(); }
+    int inFlightCount() const { return m_inFlight.size(); }
+    bool isPending(const QString& key) const;
+    quint64 startedCount() const { return m_started; }
+    quint64 coalescedCount() const { return m_coalesced; }
+
+    static constexpr int kDefaultMaxInFlight = 2;
+
+private:
+    struct Job {
+        QString key;
+        Starter start;
+    };
+    struct Running {
+        QPointer<QNetworkReply> reply;
+        QString key;
+    };
+
+    void pump();
+    void onReplyFinished(QNetworkReply* reply);
+    int findQueued(Priority priority, const QString& key) const;
+
+    QList<Job> m_queues[2];
+    QList<Running> m_inFlight;
+    QHash<QString, int> m_inFlightKeys;  // key -> requests in flight
+    int m_maxInFlight = kDefaultMaxInFlight;
+    bool m_pumping = false;
+    quint64 m_started = 0;
+    quint64 m_coalesced = 0;
+};
+
+#endif // FUJINETREQUESTSCHEDULER_H
@@ -14,9 +14,13 @@
 #include <QNetworkReply>
 #include <QUrl>
 #include <QTimer>
+#include <QJsonObject>
 #include <QString>
 #include <QStringList>
+#include <QSet>
 #include <functional>
+#include "fujinetrequestscheduler.h"
+#include "ssestreamparser.h"
 
 // Structure to hold disk slot information (legacy format)
 struct FujiNetDiskSlot {
@@ -71,10 +75,21 @@ public:
     void abortAllRequests();  // Abort all pending network requests
     void resetConnectionState();  // Force m_isConnected=false so next successful check re-emits connected()
 
-    // Drive polling
+    // Drive polling. Also opens the event channel; while it is live the
+    // drive, health and printer polls stop and changes arrive as pushed events.
     void startDrivePolling(int intervalMs = 2500);  // Poll drive status every 2.5 seconds
     void stopDrivePolling();
 
+    // Event channel: one persistent SSE stream (GET /events) pushing drive,
+    // mount, host and printer changes. Falls back to polling when the server
+    // does not offer it or the stream drops, and reconnects with backoff.
+    void openEventChannel();
+    void closeEventChannel();
+    bool isEventChannelLive() const { return m_eventChannelLive; }
+
+    // Every HTTP request except the streams goes through this queue
+    const FujiNetRequestScheduler* requestScheduler() const { return m_scheduler; }
+
     // Printer operations
     void configurePrinter(const QString& printerType, bool enabled);
     void checkPrinterStatus();
@@ -89,6 +104,9 @@ public:
     void mount(int deviceSlot, int hostSlot, const QString& filename, bool readOnly);
     void unmount(int deviceSlot);
     void mountAll();  // Mount all pre-configured images
+    // Mount or eject several slots (isEmpty or no filename = eject) as one batch:
+    // the requests queue ahead of polls and the status is refreshed once at the end
+    void applyDiskSlots(const QVector<FujiNetDiskSlot>& diskSlots);
 
     // File operations
     QString copyToSD(const QString& localPath, const QString& sdFolderPath);  // Copy file to SD, return SD-relative path
@@ -157,9 +175,18 @@ private:
     void parseDriveStatus(const QString& html);  // New parser for / endpoint
     QStringList parseHosts(const QString& response);
     QString mapPrinterTypeToAPI(const QString& type);
-    void parseSSEData(QByteArray& buffer);
+    void handlePrinterEvent(const QJsonObject& event);
+    void onEventChannelData();
+    void onEventChannelFinished();
+    void handleChannelEvent(const SseStreamParser::Event& event);
+    void setEventChannelLive(bool live);
+    void resumePolling(bool fetchNow);
+    void scheduleMount(int deviceSlot, int hostSlot, const QString& filename, bool readOnly, bool batched);
+    void scheduleUnmount(int deviceSlot, bool batched);
+    void refreshAfterMountChange(QNetworkReply* reply);
 
     QNetworkAccessManager* m_networkManager;
+    FujiNetRequestScheduler* m_scheduler;
     QString m_serverUrl;
     bool m_isConnected;
     QPointer<QNetworkReply> m_healthCheckReply;
@@ -172,14 +199,30 @@ private:
     QString m_currentPrinterType;
     static const int PRINTER_POLL_INTERVAL_MS = 2000;  // 2 seconds - allows complete output generation
 
-    // SSE connection for printer events
+    // SSE connection for printer events (used while the event channel is down)
     QNetworkReply* m_sseConnection;
-    QByteArray m_sseBuffer;
+    SseStreamParser m_sseParser;
+
+    // Event channel
+    QPointer<QNetworkReply> m_eventReply;
+    SseStreamParser m_eventParser;
+    QTimer* m_eventIdleTimer;       // no bytes (not even a keepalive) for this long: reconnect
+    QTimer* m_eventRetryTimer;
+    bool m_eventChannelLive = false;
+    bool m_eventChannelWanted = false;
+    int m_eventRetryMs;
+    int m_healthCheckIntervalMs = 0;  // 0 while health checks are stopped
+    bool m_drivePollingWanted = false;
+    static const int EVENT_RETRY_MIN_MS = 2000;
+    static const int EVENT_RETRY_MAX_MS = 30000;
+    static const int EVENT_IDLE_TIMEOUT_MS = 20000;  // servers send ": keepalive" comments more often
 
     // Track pending operations for reply handling
     QMap<QNetworkReply*, int> m_pendingMounts;      // reply -> deviceSlot
     QMap<QNetworkReply*, int> m_pendingUnmounts;    // reply -> deviceSlot
     QMap<QNetworkReply*, int> m_pendingBrowse;      // reply -> hostSlot
+    QSet<QNetworkReply*> m_batchedReplies;          // applyDiskSlots() operations
+    int m_batchRefreshPending = 0;                  // batched operations not answered yet
 };
 
 #endif // FUJINETSERVICE_H
@@ -0,0 +1,65 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <QJsonArray>
+
+// Headless "fast-forward farm" for batch regression runs.
+//
+//   fujisan --headless-farm jobs.json [--workers N]
+//
+// The coordinator reads a job description and runs each job in its own worker
+// process (libatari800 keeps its state in globals, so one emulator per process),
+// with at most N workers at a time, each pinned to its own core. Workers run
+// the emulator unpaced: no window, no audio and no frame timer.
+//
+// Job file format (relative paths are resolved against the job file's directory):
+//
+//   {
+//     "workers": 8,                                  // optional, default: core count
+//     "defaults": { "machine": "-xl", "video": "-pal", "frames": 600,
+//                   "rom_cache": "/dev/shm/fujisan-roms" },   // optional, see RomImageCache
+//     "jobs": [
+//       { "name": "boot", "file": "game.xex", "disks": ["d1.atr"], "frames": 3000,
+//         "breakpoints": ["$2000"], "screenshot": "out/boot.png",
+//         "state": "out/boot.a8s", "memory": "out/boot.bin",
+//         "checksums": "out/boot.sums" },               // per-frame FrameChecksumStream file
+//       { "name": "replay", "movie": "level1.fjm" },  // replays and verifies an InputMovie
+//       { "name": "title", "file": "game.xex", "frames": 1800,
+//         "script": [...], "expect": { "screen_text": "PRESS START" } }  // see ScenarioCase
+//     ]
+//   }
+//
+// Each worker prints one JSON result line on stdout, with setup_ms (boot and
+// media), elapsed_ms (the frames alone) and total_ms; a job whose expectations
+// do not hold fails with the first unmet one as its error. The coordinator adds
+// each job's wall_ms, prints a single JSON summary with the slowest jobs and
+// exits non-zero if any job failed.
+class HeadlessRunner
+{
+public:
+    /// Returns true if argv requests a headless mode (checked before any Q*Application exists).
+    static bool isHeadlessInvocation(int argc, char* argv[]);
+    /// Entry point for headless modes; creates its own QCoreApplication.
+    static int run(int argc, char* argv[]);
+
+private:
+    static int runFarm(const QString& jobFile, int workers);
+    static int runWorker(const QString& jobFile, int jobIndex, int cpu);
+
+    static bool loadJobFile(const QString& jobFile, QJsonObject& root, QString& error);
+    static QJsonObject resolveJob(const QJsonObject& root, int jobIndex);
+    static QString resolvePath(const QString& jobFile, const QString& path);
+    static void pinToCpu(int cpu);
+};
+
+#endif // HEADLESSRUNNER_H
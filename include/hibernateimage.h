@@ -0,0 +1,68 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef HIBERNATEIMAGE_H
+#define HIBERNATEIMAGE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QJsonObject>
+#include <QString>
+
+// Instant-resume image written on quit (see AtariEmulator::hibernate()).
+//
+// Unlike a save state it is stored uncompressed, so on launch the file is
+// memory-mapped and the core restores straight from the mapping, without a
+// read or a decompression pass:
+//
+//   "FUJIHBR1"                8-byte magic
+//   u32 LE                    metadata length
+//   metadata                  compact JSON: boot_config, media, profile, frame,
+//                             state_size and anything else the writer adds
+//   zero padding              to the next kStateAlignment boundary
+//   state                     raw LIBATARI800_StateSave buffer, state_size bytes
+//
+// Writes go through QSaveFile, so a quit interrupted mid-write leaves no image.
+class HibernateImage
+{
+public:
+    static constexpr int kStateAlignment = 64;
+    /// Larger metadata is treated as a corrupt file.
+    static constexpr quint32 kMaxMetadataBytes = 1024 * 1024;
+
+    HibernateImage() = default;
+    ~HibernateImage();
+    HibernateImage(const HibernateImage&) = delete;
+    HibernateImage& operator=(const HibernateImage&) = delete;
+
+    /// "state_size" is added to metadata.
+    static bool write(const QString& path, const QJsonObject& metadata, const QByteArray& state);
+
+    /// Map and validate the image; false (with errorString()) when it is missing,
+    /// has another format or is truncated.
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const { return m_state != nullptr; }
+
+    QJsonObject metadata() const { return m_metadata; }
+    /// Points into the mapping; valid until close().
+    const uchar* stateData() const { return m_state; }
+    qint64 stateSize() const { return m_stateSize; }
+    QString errorString() const { return m_error; }
+
+private:
+    bool fail(const QString& error);
+
+    QFile m_file;
+    uchar* m_mapping = nullptr;
+    const uchar* m_state = nullptr;
+    qint64 m_stateSize = 0;
+    QJsonObject m_metadata;
+    QString m_error;
+};
+
+#endif // HIBERNATEIMAGE_H
@@ -0,0 +1,74 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef INPUTLATENCYMONITOR_H
+#define INPUTLATENCYMONITOR_H
+
+#include "latencyhistogram.h"
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+// Measures input lag in two stages: from an input event to the end of the
+// emulated frame that first saw it (input-to-frame), and on to the paint that
+// first showed that frame or a later one (input-to-present, i.e. key to
+// photon as far as the application can tell).
+//
+// markInput() may be called from any thread and keeps the oldest unconsumed
+// input per source; beginFrame()/endFrame() run on the emulator thread around
+// libatari800_next_frame(), and framePresented() on the GUI thread. Off by
+// default: while disabled every call is one relaxed atomic load.
+class InputLatencyMonitor
+{
+public:
+    enum Source { Keyboard, Joystick, SdlJoystick, kSourceCount };
+    static constexpr int kMaxInFlight = 64;  // frames waiting for a paint
+
+    InputLatencyMonitor();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    void markInput(Source source);
+    /// Emulator thread, before the frame's input snapshot: claims pending inputs.
+    void beginFrame();
+    /// Emulator thread, after the frame ran: the claimed inputs were consumed by frame.
+    void endFrame(quint64 frame);
+    /// GUI thread: frame (a FrameExchange sequence) is on screen.
+    void framePresented(quint64 frame);
+
+    /// enabled, per-source {to_frame, to_present} histograms, frame_to_present
+    /// and unpresented (in-flight frames evicted before a paint).
+    QJsonObject toJson() const;
+    void reset();
+
+    static QString sourceName(Source source);
+
+private:
+    struct InFlight {
+        quint64 frame;
+        qint64 inputUs;
+        qint64 consumedUs;
+        int source;
+    };
+
+    std::atomic<bool> m_enabled{false};
+    std::atomic<qint64> m_pending[kSourceCount];
+    qint64 m_claimed[kSourceCount] = {};  // emulator thread, between beginFrame/endFrame
+
+    std::atomic<int> m_inFlightCount{0};  // lets framePresented() skip the lock
+    mutable QMutex m_mutex;               // guards everything below
+    QVector<InFlight> m_inFlight;
+    LatencyHistogram m_toFrame[kSourceCount];
+    LatencyHistogram m_toPresent[kSourceCount];
+    LatencyHistogram m_frameToPresent;
+    quint64 m_unpresented = 0;
+};
+
+#endif // INPUTLATENCYMONITOR_H
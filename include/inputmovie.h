@@ -0,0 +1,101 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef INPUTMOVIE_H
+#define INPUTMOVIE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+// A deterministic input movie: the machine state a recording started from,
+// the input passed to every frame after it, and checksums of RAM and the
+// screen every verifyInterval frames to prove a replay matches.
+//
+// File layout (little-endian):
+//   header    48 bytes: "FJMOVIE1", u32 version, u32 header size,
+//             u32 input size, u32 verify interval, u64 frames,
+//             u32 state size, u32 runs, u32 checksums, u32 reserved
+//   state     the snapshot the movie starts from
+//   runs      u32 frame count, then the input bytes: consecutive frames
+//             with identical input share one run, so a minute of a held
+//             joystick costs one record
+//   checksums u64 frame, u64 RAM checksum, u64 screen checksum
+//
+// Inputs are opaque fixed-size records (libatari800's input_template_t for
+// AtariEmulator); a movie only plays back on a build with the same size.
+class InputMovie
+{
+public:
+    struct Checksum {
+        quint64 frame = 0;  // frames completed when it was taken
+        quint64 ram = 0;
+        quint64 screen = 0;
+    };
+
+    static constexpr quint32 kVersion = 1;
+    static constexpr int kHeaderBytes = 48;
+    static constexpr int kDefaultVerifyInterval = 60;
+
+    /// Starts a new movie from state; verifyInterval 0 records no checksums.
+    void begin(const QByteArray& state, int inputSize, int verifyInterval = kDefaultVerifyInterval);
+    void clear();
+
+    /// Appends one frame's input (inputSize bytes).
+    void appendFrame(const void* input);
+    /// True when the frame just appended should be followed by addChecksum().
+    bool checksumDue() const;
+    void addChecksum(quint64 ram, quint64 screen);
+
+    bool save(const QString& path, QString* error = nullptr) const;
+    bool load(const QString& path, QString* error = nullptr);
+
+    const QByteArray& state() const { return m_state; }
+    int inputSize() const { return m_inputSize; }
+    int verifyInterval() const { return m_verifyInterval; }
+    quint64 frameCount() const { return m_frames; }
+    int runCount() const { return m_runs.size(); }
+    const QVector<Checksum>& checksums() const { return m_checksums; }
+
+    // Sequential playback: frames come out in order from the first
+    class Player
+    {
+    public:
+        explicit Player(const InputMovie& movie) : m_movie(movie) {}
+        /// Copies the next frame's input to input; false after the last frame.
+        bool nextFrame(void* input);
+        quint64 framesPlayed() const { return m_frame; }
+        /// The checksum recorded after the frame just played, or nullptr.
+        const Checksum* checksumAfterFrame();
+
+    private:
+        const InputMovie& m_movie;
+        int m_run = 0;
+        quint32 m_usedInRun = 0;
+        int m_checksum = 0;
+        quint64 m_frame = 0;
+    };
+
+    /// 64-bit FNV-1a, for RAM and screen checksums.
+    static quint64 checksum(const void* data, int size);
+
+private:
+    struct Run {
+        quint32 frames = 0;
+        QByteArray input;
+    };
+
+    QByteArray m_state;
+    int m_inputSize = 0;
+    int m_verifyInterval = 0;
+    quint64 m_frames = 0;
+    QVector<Run> m_runs;
+    QVector<Checksum> m_checksums;
+};
+
+#endif // INPUTMOVIE_H
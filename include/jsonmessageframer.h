@@ -0,0 +1,78 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef JSONMESSAGEFRAMER_H
+#define JSONMESSAGEFRAMER_H
+
+#include <QByteArray>
+#include <QString>
+
+// Splits a client's TCP byte stream into JSON request messages.
+//
+// The scan is resumable: position, brace depth and string/escape state survive
+// between append() calls, so each byte is looked at once no matter how many
+// reads a message arrives in, and consumed bytes are dropped in bulk instead of
+// shifting the buffer after every message. Three framings are supported:
+//   Braces         one top-level {...} object after another, any whitespace
+//                  in between (the default, compatible with all clients)
+//   Newline        one message per line; the line is not scanned
+//   LengthPrefixed a 4-byte big-endian length, then that many bytes
+class JsonMessageFramer
+{
+public:
+    enum Framing {
+        FramingBraces,
+        FramingNewline,
+        FramingLengthPrefixed
+    };
+
+    enum Result {
+        NeedMoreData,
+        MessageReady,
+        FramingError
+    };
+
+    /// Largest message (or incomplete message) accepted before the buffer is discarded.
+    static constexpr int kMaxMessageSize = 1048576;
+
+    JsonMessageFramer() = default;
+
+    Framing framing() const { return m_framing; }
+    /// Takes effect from the next unconsumed byte, e.g. right after the message
+    /// that asked for it.
+    void setFraming(Framing framing);
+    static bool parseFraming(const QString& name, Framing* framing);
+    static QString framingName(Framing framing);
+
+    void append(const QByteArray& data);
+    /// Extract the next complete message. On FramingError, error describes the
+    /// bytes that were skipped and the framer has already resynchronised.
+    Result next(QByteArray& message, QString& error);
+
+    /// Bytes received but not yet returned as messages.
+    int pendingBytes() const { return m_buffer.size() - m_readPos; }
+    void clear();
+
+private:
+    Result nextBraces(QByteArray& message, QString& error);
+    Result nextLine(QByteArray& message, QString& error);
+    Result nextLengthPrefixed(QByteArray& message, QString& error);
+    void consume(int endPos);
+    void resetScan();
+    void compact();
+
+    Framing m_framing = FramingBraces;
+    QByteArray m_buffer;
+    int m_readPos = 0;        // first unconsumed byte
+    int m_scanPos = 0;        // next byte to scan
+    int m_messageStart = -1;  // '{' of the message being scanned, -1 before it
+    int m_depth = 0;
+    bool m_inString = false;
+    bool m_escapeNext = false;
+};
+
+#endif // JSONMESSAGEFRAMER_H
@@ -0,0 +1,47 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QJsonObject>
+#include <QtGlobal>
+
+// Fixed-size histogram of durations in microseconds for the TCP API metrics
+// (status.get_metrics). Bucket 0 holds 0-1 us, bucket i holds [2^i, 2^(i+1))
+// us and the last one everything longer, so recording is a few instructions and needs no
+// allocation; percentiles are reported as the upper bound of their bucket,
+// never above the largest value seen. Not thread-safe: one owner thread.
+class LatencyHistogram
+{
+public:
+    static constexpr int kBuckets = 32;
+
+    /// Monotonic clock shared by all threads, in microseconds; use it to stamp
+    /// a request on one thread and measure its wait on another.
+    static qint64 nowMicroseconds();
+
+    void record(qint64 microseconds);
+    void reset();
+
+    quint64 count() const { return m_count; }
+    qint64 maxMicroseconds() const { return m_max; }
+    qint64 totalMicroseconds() const { return m_total; }
+    /// Upper bound of the bucket holding the given fraction (0-1) of the samples.
+    qint64 percentile(double fraction) const;
+
+    /// count, total_us, mean_us, max_us, p50_us, p90_us and p99_us.
+    QJsonObject toJson() const;
+
+private:
+    quint64 m_buckets[kBuckets] = {};
+    quint64 m_count = 0;
+    qint64 m_total = 0;
+    qint64 m_max = 0;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,87 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef MACHINESNAPSHOT_H
+#define MACHINESNAPSHOT_H
+
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+// Everything a debugger looks at, captured between two frames in one pass
+// (see AtariEmulator::captureSnapshot()): the CPU registers, the 64 KB CPU
+// view, every XE extended RAM bank, the cartridge image and the chip
+// registers. Memory is held in implicitly shared QByteArrays, so a snapshot
+// is copied once out of the core and passed around for free.
+//
+// Chip registers are the values last written (the core's shadows of the
+// write-only registers) followed by the read-side status registers; the
+// order of each block is registerNames(). GTIA, POKEY (up to AUDCTL) and
+// PIA follow their address order, so offset n is the register at $Dx00+n.
+class MachineSnapshot
+{
+public:
+    static constexpr int kMemorySize = 0x10000;
+    static constexpr int kBankSize = 0x4000;
+
+    enum Section {
+        CpuMemory = 0x1,
+        ExtendedRam = 0x2,
+        CartridgeImage = 0x4,
+        AllSections = CpuMemory | ExtendedRam | CartridgeImage
+    };
+
+    enum Chip {
+        Antic,
+        Gtia,
+        Pokey,
+        Pia,
+        ChipCount
+    };
+
+    quint64 frame = 0;
+    int sections = 0;               // Section flags that were captured
+    quint16 pc = 0;
+    quint8 a = 0, x = 0, y = 0, s = 0, p = 0;
+
+    QByteArray memory;              // CpuMemory: the CPU view, kMemorySize bytes
+    QByteArray extendedRam;         // ExtendedRam: banks 1..n back to back, kBankSize each
+    int extendedBanks = 0;          // n, also when ExtendedRam was not captured
+    int mappedBank = 0;             // XE bank in the $4000-$7FFF window, 0 for base RAM
+
+    int cartridgeType = 0;          // 0: no cartridge
+    int cartridgeState = 0;         // bank select state, meaning depends on the type
+    int cartridgeSize = 0;          // bytes
+    QByteArray cartridge;           // CartridgeImage: the whole image
+
+    QByteArray registers[ChipCount];
+
+    bool isValid() const { return registers[Antic].size() == registerNames(Antic).size(); }
+
+    /// Bank 0 is the CPU view, 1..extendedBanks the XE banks; empty when not captured.
+    QByteArray bank(int index) const;
+    /// A bankSize slice of the cartridge image; empty past its end.
+    QByteArray cartridgeBank(int index, int bankSize) const;
+
+    static QString chipName(Chip chip);
+    static QStringList registerNames(Chip chip);
+    /// -1 when the chip has no such register
+    int registerValue(Chip chip, const QString& name) const;
+
+    /// CPU, banking, cartridge and registers by name; no memory contents.
+    QJsonObject toJson() const;
+    /// The captured memory sections of the Section flags in `sections`, back to
+    /// back in the order memory, extended, cartridge; layout gets one
+    /// {section, offset, length} per section included.
+    QByteArray payload(int sections, QJsonArray* layout) const;
+    /// "memory", "extended" and "cartridge" to Section flags; false on other names.
+    static bool parseSections(const QStringList& names, int* sections);
+};
+
+#endif // MACHINESNAPSHOT_H
@@ -28,6 +28,8 @@
 #include <QPixmap>
 #include <QEvent>
 #include <QShowEvent>
+#include <QSet>
+#include <QElapsedTimer>
 #include "atariemulator.h"
 #include "emulatorwidget.h"
 #include "toggleswitch.h"
@@ -42,9 +44,11 @@
 #include "tcpserver.h"
 #include "fastbasicbuildpanel.h"
 #include "fujinetservice.h"
+#include "medialibrary.h"
 
 class FujiNetProcessManager;
 class FujiNetBinaryManager;
+class MediaLibraryWidget;
 
 class MainWindow : public QMainWindow
 {
@@ -78,9 +82,11 @@ private slots:
     void toggleFullscreen();
     void showAbout();
     void toggleDebugger();
+    void toggleMediaLibrary();
+    void togglePerformanceOverlay(bool enabled);
     void toggleTCPServer();
+    void showInputLatency();
     void pasteText();
-    void sendNextCharacter();
     void toggleMediaDock();
     void togglePause();
 
@@ -98,6 +104,8 @@ private slots:
     void quickLoadState();
     void saveState();
     void loadState();
+    void onStateSaved(const QString& filename, bool success);
+    void onStateLoaded(const QString& filename, bool success);
     void onDiskInserted(int driveNumber, const QString& diskPath);
     void onDiskEjected(int driveNumber);
     void onDiskDroppedOnEmulator(const QString& filename);
@@ -116,6 +124,10 @@ private slots:
 public:
     // Public method for TCP server to request proper emulator restart
     void requestEmulatorRestart();
+    // Applies the current configuration, re-initialising libatari800 only when a
+    // boot setting changed (or when forced). Returns what forced the restart;
+    // empty when everything was applied live.
+    QStringList reconfigureEmulator(bool forceRestart = false);
     
     // Public methods for TCP server to control disk drives properly
     bool insertDiskViaTCP(int driveNumber, const QString& diskPath);
@@ -125,6 +137,10 @@ public:
     // Public methods for TCP server to control cartridge properly
     bool insertCartridgeViaTCP(const QString& cartridgePath);
     bool ejectCartridgeViaTCP();
+
+    // Public methods for TCP server to control the cassette recorder
+    bool insertCassetteViaTCP(const QString& cassettePath, bool readOnly, bool bootTape);
+    bool ejectCassetteViaTCP();
     
     // Public method for TCP server to access profile manager
     ConfigurationProfileManager* getProfileManager() const { return m_profileManager; }
@@ -142,6 +158,9 @@ public:
     void stopFujiNetViaTCP();
     void startFujiNetViaTCP();
 
+    // The debugger dock is built on first use (F12 or a debug.* TCP command)
+    DebuggerWidget* ensureDebugger();
+
 private:
     void createMenus();
     void createToolBar();
@@ -149,10 +168,17 @@ private:
     void createAudioToolbarSection();
     void createProfileToolbarSection();
     void createLogoSection();
+    void createMediaLibrary();
+    void seedRomCacheFromLibrary();
+    void applyPerformanceSettings();
+    void probeGuiStall();
+    void openLibraryMedia(const QString& path, MediaLibrary::Kind kind);
     void createStatusBarWidgets();
     void createEmulatorWidget();
-    void createDebugger();
+    void setFastbasicBuildPanelVisible(bool visible);
     void createMediaPeripheralsDock();
+    void setDriveActivityLED(int driveNumber, bool active, bool isWriting);
+    void pollDiskActivity();
     void restartEmulator();
     void updateToolbarFromSettings();
     /// Read input/joystick* from QSettings and apply via AtariEmulator::applyJoystickInputBundle (worker thread).
@@ -217,6 +243,7 @@ private:
     
     // TCP Server for remote control
     TCPServer* m_tcpServer;
+    QSet<QString> m_guiStateRequests;  // State files saved/loaded from the menu, awaiting completion
 
     // FujiNet-PC process management
     FujiNetProcessManager* m_fujinetProcessManager;
@@ -237,11 +264,22 @@ private:
     DebuggerWidget* m_debuggerWidget;
     QDockWidget* m_debuggerDock;
 
+    // Media library (indexed on a background thread, dock built on first use)
+    MediaLibrary* m_mediaLibrary;
+    MediaLibraryWidget* m_mediaLibraryWidget;
+    QDockWidget* m_mediaLibraryDock;
+
     // Media & Peripherals Dock
     DiskDriveWidget* m_diskDrive1;              // D1 stays on toolbar
     CartridgeWidget* m_cartridgeWidget;         // Cartridge moved to toolbar
     MediaPeripheralsDock* m_mediaPeripheralsDock; // D2-D8, cassette, printer (cartridge moved out)
     QDockWidget* m_mediaPeripheralsDockWidget;
+    // Disk LEDs follow AtariEmulator::driveActivity(), sampled by this timer
+    static constexpr int kDiskActivityPollMs = 33;
+    static constexpr int kDiskActivityHoldMs = 100;  // LED stays lit this long after an access
+    enum DriveLedState { DriveLedOff, DriveLedRead, DriveLedWrite };
+    QTimer* m_diskActivityTimer = nullptr;
+    DriveLedState m_driveLedStates[8] = {};
     QPushButton* m_mediaToggleButton;
 
     // Console buttons
@@ -315,9 +353,18 @@ private:
     // View menu actions
     QAction* m_fullscreenAction;
     QAction* m_debuggerAction;
+    QAction* m_mediaLibraryAction;
+    QAction* m_performanceOverlayAction;
+
+    // GUI thread stall probe for PerformanceMonitor::GuiStall
+    static constexpr int kGuiStallProbeMs = 20;
+    QTimer* m_guiStallProbe = nullptr;
+    QElapsedTimer m_guiStallClock;
     
     // TCP Server actions
     QAction* m_tcpServerAction;
+    QAction* m_inputLatencyAction;
+    QDialog* m_inputLatencyDialog = nullptr;
 
     // Fullscreen state
     bool m_isInCustomFullscreen;
@@ -326,12 +373,6 @@ private:
 
     // NetSIO state tracking (for BASIC toggle disabling)
     bool m_netSIOEnabled;
-
-    // Paste functionality
-    QTimer* m_pasteTimer;
-    QString m_pasteBuffer;
-    int m_pasteIndex;
-    int m_originalEmulationSpeed;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,163 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef MEDIALIBRARY_H
+#define MEDIALIBRARY_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QMetaType>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+
+class QThread;
+class MediaLibraryScanner;
+
+// Catalog of the disk, executable, cassette and cartridge images under a set
+// of folders, for searching and mounting without a file dialog.
+//
+// rescan() walks the folders on a background thread. Each new or changed file
+// (by size and timestamp) is read once, hashed (SHA-1) and inspected: ATR/XFD
+// geometry and DOS 2 directory, XEX segment table and run address, CAR type
+// and checksum, CAS description and block count. Unchanged files keep their
+// entry without being read, so a rescan of an indexed archive costs a stat per
+// file. Results arrive in batches on the library's thread; files that are gone
+// are dropped when the scan finishes, and the index is saved to indexPath().
+//
+// The library itself is not thread-safe: use it from the thread it lives on.
+class MediaLibrary : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Kind {
+        Disk,
+        Executable,
+        Cassette,
+        Cartridge
+    };
+
+    struct Entry {
+        QString path;
+        Kind kind = Disk;
+        qint64 size = 0;
+        qint64 modifiedMs = 0;    // last modification, ms since the epoch
+        QByteArray sha1;          // hex
+        QString title;            // CAS description, else the file's base name
+        QJsonObject details;      // per kind, see inspect()
+        QStringList files;        // DOS 2 directory of a disk, "NAME.EXT"
+    };
+
+    /// Larger files are not indexed
+    static constexpr qint64 kMaxImageBytes = 16 * 1024 * 1024;
+    /// Entries per batch handed from the scanner
+    static constexpr int kBatchSize = 256;
+
+    /// An empty indexPath keeps the index in memory only.
+    explicit MediaLibrary(const QString& indexPath = QString(), QObject* parent = nullptr);
+    ~MediaLibrary() override;
+
+    /// Default index location in the application data directory
+    static QString defaultIndexPath();
+
+    QString indexPath() const { return m_indexPath; }
+    bool load();
+    bool save() const;
+
+    void setFolders(const QStringList& folders) { m_folders = folders; }
+    QStringList folders() const { return m_folders; }
+
+    /// Starts a background scan of folders(); a scan in progress is cancelled first.
+    void rescan();
+    void cancelScan();
+    /// Cancels any scan and empties the index (and its file).
+    void clear();
+    bool isScanning() const { return m_scanning; }
+
+    int count() const { return m_entries.size(); }
+    bool contains(const QString& path) const { return m_entries.contains(path); }
+    Entry entry(const QString& path) const { return m_entries.value(path); }
+    /// All words of query (case-insensitive) in the file name, title or directory;
+    /// sorted by file name. An empty query matches everything.
+    QVector<Entry> search(const QString& query, int limit = 200) const;
+    QVector<Entry> entriesOfKind(Kind kind) const;
+    /// Paths of the files with these contents
+    QStringList pathsForHash(const QByteArray& sha1) const { return m_byHash.values(sha1); }
+
+    static QString kindName(Kind kind);
+    static bool parseKind(const QString& name, Kind* kind);
+    /// The kind a file name's extension indexes as; false for other files.
+    static bool kindForPath(const QString& path, Kind* kind);
+    /// File name patterns of every indexed extension
+    static QStringList nameFilters();
+
+    /// Reads path into entry (synchronously). details holds, per kind:
+    ///   Disk        format, sector_size, sectors, bootable, dos (directory found)
+    ///   Executable  segments, run_address, first_address, last_address (or error)
+    ///   Cassette    blocks, baud
+    ///   Cartridge   format ("car" or "raw"), cart_type, checksum_ok
+    static bool inspect(const QString& path, Entry* entry, QString* error = nullptr);
+    /// The file names in the DOS 2.x directory of an ATR/XFD image (sectors
+    /// 361-368), or an empty list when it has none.
+    static QStringList dosDirectory(const QByteArray& image);
+
+    static QJsonObject toJson(const Entry& entry);
+    static bool fromJson(const QJsonObject& object, Entry* entry);
+
+signals:
+    /// Entries were added, updated or removed
+    void indexChanged();
+    void scanProgress(int filesSeen, int filesRead);
+    /// The scan ran to completion (not when cancelled); the index has been saved.
+    void scanFinished(int filesSeen, int filesRead, qint64 elapsedMs);
+
+private slots:
+    void onBatch(quint64 generation, const QVector<MediaLibrary::Entry>& entries, int filesSeen, int filesRead);
+    void onScanDone(quint64 generation, int filesSeen, int filesRead, qint64 elapsedMs, bool cancelled);
+
+private:
+    void insert(const Entry& entry);
+    void remove(const QString& path);
+
+    QString m_indexPath;
+    QStringList m_folders;
+    QHash<QString, Entry> m_entries;          // by absolute path
+    QMultiHash<QByteArray, QString> m_byHash;
+    QSet<QString> m_seen;                     // paths reported by the current scan
+    QThread* m_thread = nullptr;
+    MediaLibraryScanner* m_scanner = nullptr;
+    std::atomic<quint64> m_generation{0};  // of the current scan; the scanner stops when it moves on
+    bool m_scanning = false;
+};
+
+Q_DECLARE_METATYPE(MediaLibrary::Entry)
+
+// Background half of MediaLibrary::rescan(); lives on the library's thread.
+class MediaLibraryScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MediaLibraryScanner(const std::atomic<quint64>* generation) : m_generation(generation) {}
+
+    /// known: the entries indexed so far, reused when size and timestamp match
+    void scan(quint64 generation, const QStringList& folders, const QHash<QString, MediaLibrary::Entry>& known);
+
+signals:
+    void batch(quint64 generation, const QVector<MediaLibrary::Entry>& entries, int filesSeen, int filesRead);
+    void done(quint64 generation, int filesSeen, int filesRead, qint64 elapsedMs, bool cancelled);
+
+private:
+    const std::atomic<quint64>* m_generation;
+};
+
+#endif // MEDIALIBRARY_H
@@ -0,0 +1,60 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef MEDIALIBRARYWIDGET_H
+#define MEDIALIBRARYWIDGET_H
+
+#include <QWidget>
+#include "medialibrary.h"
+
+class QLabel;
+class QLineEdit;
+class QListWidget;
+class QListWidgetItem;
+class QPushButton;
+class QTimer;
+
+// Search panel over a MediaLibrary. Results can be dragged onto a disk drive,
+// the cassette or the cartridge slot like files from the desktop, or
+// double-clicked to open them. Folders are kept in "library/folders".
+class MediaLibraryWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit MediaLibraryWidget(MediaLibrary* library, QWidget* parent = nullptr);
+
+    /// Shown results are capped; refine the search to see the rest
+    static constexpr int kMaxResults = 500;
+
+signals:
+    void openRequested(const QString& path, MediaLibrary::Kind kind);
+
+private slots:
+    void refresh();
+    void onAddFolder();
+    void onRemoveFolders();
+    void onItemActivated(QListWidgetItem* item);
+    void onScanProgress(int filesSeen, int filesRead);
+    void onScanFinished(int filesSeen, int filesRead, qint64 elapsedMs);
+
+private:
+    void updateStatus();
+    static QString describe(const MediaLibrary::Entry& entry);
+
+    MediaLibrary* m_library;
+    QLineEdit* m_searchEdit;
+    QListWidget* m_results;
+    QLabel* m_statusLabel;
+    QPushButton* m_addFolderButton;
+    QPushButton* m_removeFoldersButton;
+    QPushButton* m_rescanButton;
+    QTimer* m_refreshTimer;
+    QString m_scanStatus;
+};
+
+#endif // MEDIALIBRARYWIDGET_H
@@ -0,0 +1,95 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef MEDIARECORDER_H
+#define MEDIARECORDER_H
+
+#include "aviwriter.h"
+#include <QJsonObject>
+#include <QMutex>
+#include <QSemaphore>
+#include <QStringList>
+#include <atomic>
+#include <memory>
+
+class QThread;
+
+// Records the emulator's indexed frames and POKEY audio to AVI (see
+// AviWriter) on a background encoder thread.
+//
+// submitFrame() runs on the emulator thread and only copies the frame into
+// one of kSlots preallocated slots; it never waits for the encoder. When all
+// slots are still queued the frame is dropped and counted, and its audio is
+// carried into the next accepted slot, so the sound stays continuous and the
+// encoder repeats the previous picture for the missing frame numbers. Files
+// roll over to name_001.avi, name_002.avi, ... before AviWriter::kMaxFileBytes.
+class MediaRecorder
+{
+public:
+    static constexpr int kSlots = 8;
+    static constexpr int kMaxSlotAudioBytes = 32 * 1024;  // ~8 frames of 16-bit stereo
+
+    MediaRecorder();
+    ~MediaRecorder();
+
+    /// Starts the encoder thread writing to path. Fails if already recording.
+    bool start(const QString& path, const AviWriter::Format& format, QString* error = nullptr);
+    /// Encodes what is queued, closes the file and joins the thread.
+    void stop();
+    bool isRecording() const { return m_recording.load(std::memory_order_relaxed); }
+
+    /// Emulator thread only: queues one width * height frame and its audio.
+    void submitFrame(quint64 frame, const unsigned char* pixels, const unsigned char* audio, int audioBytes);
+
+    /// recording, files, frames, dropped_frames, bytes and seconds.
+    QJsonObject status() const;
+
+private:
+    enum SlotState { Free, Filled };
+
+    struct Slot {
+        std::atomic<int> state{Free};
+        quint64 frame = 0;
+        std::unique_ptr<unsigned char[]> pixels;
+        unsigned char audio[kMaxSlotAudioBytes];
+        int audioBytes = 0;
+    };
+
+    void encodeLoop();
+    bool encodeSlot(Slot& slot);
+    bool rollOver();
+
+    std::unique_ptr<Slot[]> m_slots;
+    QSemaphore m_filled;
+    QThread* m_thread = nullptr;
+    std::atomic<bool> m_recording{false};
+    std::atomic<bool> m_stopping{false};
+
+    // Emulator thread
+    int m_writeSlot = 0;
+    unsigned char m_pendingAudio[kMaxSlotAudioBytes];
+    int m_pendingAudioBytes = 0;
+
+    // Encoder thread
+    AviWriter m_writer;
+    AviWriter::Format m_format;
+    QString m_basePath;
+    int m_readSlot = 0;
+    quint64 m_lastFrame = 0;
+    bool m_haveFrame = false;
+
+    mutable QMutex m_filesMutex;  // guards m_files, appended on rollover
+    QStringList m_files;
+
+    std::atomic<quint64> m_framesWritten{0};  // including repeated frames
+    std::atomic<quint64> m_framesDropped{0};
+    std::atomic<quint64> m_audioDropped{0};
+    std::atomic<qint64> m_bytesWritten{0};  // finished files plus the open one
+    qint64 m_closedBytes = 0;
+};
+
+#endif // MEDIARECORDER_H
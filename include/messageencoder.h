@@ -0,0 +1,70 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef MESSAGEENCODER_H
+#define MESSAGEENCODER_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+
+// Wire encoding of the responses and events sent to one TCP API client.
+//
+// Json is the default: compact JSON, one message per line. Cbor (RFC 8949)
+// and MsgPack carry the same message tree in binary, and turn the "$XXXX" hex
+// strings of the address, register and memory byte fields (pc, address, data,
+// ...), as well as integral numbers, into native integers so the client does
+// not parse them back. Strings in every other field, the id included, stay
+// strings.
+//
+// Binary encodings, and JSON once compression is enabled, are framed as a
+// 4-byte big-endian length followed by the payload. The top bit of the length
+// is set when the payload is a zlib stream (RFC 1950) of the encoded message;
+// only messages of at least compressThreshold bytes are compressed.
+class MessageEncoder
+{
+public:
+    enum Encoding {
+        EncodingJson,
+        EncodingCbor,
+        EncodingMsgPack
+    };
+
+    static constexpr quint32 kCompressedFlag = 0x80000000u;
+    /// Messages below this size rarely shrink enough to pay for deflating them.
+    static constexpr int kMinCompressThreshold = 256;
+
+    MessageEncoder() = default;
+    MessageEncoder(Encoding encoding, int compressThreshold)
+        : m_encoding(encoding), m_compressThreshold(compressThreshold) {}
+
+    Encoding encoding() const { return m_encoding; }
+    /// 0 when compression is off.
+    int compressThreshold() const { return m_compressThreshold; }
+    /// False only for the default newline-delimited JSON.
+    bool isFramed() const { return m_encoding != EncodingJson || m_compressThreshold > 0; }
+
+    /// One message ready to write; compressed is set if it was deflated.
+    QByteArray encode(const QJsonObject& message, bool* compressed = nullptr) const;
+
+    static QByteArray toCbor(const QJsonObject& message);
+    static QByteArray toMsgPack(const QJsonObject& message);
+    static bool parseEncoding(const QString& name, Encoding* encoding);
+    static QString encodingName(Encoding encoding);
+
+    bool operator==(const MessageEncoder& other) const
+    {
+        return m_encoding == other.m_encoding && m_compressThreshold == other.m_compressThreshold;
+    }
+    bool operator!=(const MessageEncoder& other) const { return !(*this == other); }
+
+private:
+    Encoding m_encoding = EncodingJson;
+    int m_compressThreshold = 0;
+};
+
+#endif // MESSAGEENCODER_H
@@ -0,0 +1,87 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef PERFORMANCEMONITOR_H
+#define PERFORMANCEMONITOR_H
+
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+#include <atomic>
+
+// Per-frame performance counters for the overlay (PerformanceOverlay) and
+// status.get_performance, cheap enough to leave on in the field.
+//
+// Every metric keeps its last kWindow samples in a ring of atomics plus an
+// all-time count, total and maximum; the rolling percentiles and histograms
+// are computed by readers from a copy of the ring. Each metric has exactly
+// one producer thread: the emulator thread for everything but PresentLatency
+// and GuiStall, which the GUI thread records. record() is a few relaxed
+// atomic stores and is skipped entirely while disabled; readers on any
+// thread never block a producer and drop the samples it overwrote while
+// they were copying.
+class PerformanceMonitor
+{
+public:
+    enum Metric {
+        FrameInterval,      // us between the starts of two emulated frames
+        EmulatedFrame,      // us inside libatari800_next_frame()
+        Render,             // us converting the screen for presentation
+        PresentLatency,     // us from the frame's publish to the paint that showed it
+        AudioFill,          // percent of the audio output buffer queued after the frame
+        AudioUnderruns,     // underruns since the previous frame
+        SioWait,            // us the frame waited on the NetSIO link
+        GuiStall,           // us a GUI thread tick ran late
+        kMetricCount
+    };
+    static constexpr int kWindow = 512;  // ~10 s of PAL frames; a power of two
+
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    /// The frame time emulation_percent is measured against.
+    void setNominalFrameUs(qint32 microseconds) { m_nominalFrameUs.store(microseconds, std::memory_order_relaxed); }
+    qint32 nominalFrameUs() const { return m_nominalFrameUs.load(std::memory_order_relaxed); }
+
+    // Producer side, one thread per metric
+    void record(Metric metric, qint32 value);
+
+    // Reader side (any thread)
+    /// The samples in the window, oldest first.
+    QVector<qint32> window(Metric metric) const;
+    /// Nominal frame time over the mean frame interval in the window, in percent;
+    /// 0 before two frames ran.
+    double emulationPercent() const;
+    /// Every metric by name with its summary(), plus emulation_percent, enabled
+    /// and window; history adds up to that many of the newest samples per metric.
+    QJsonObject toJson(int history = 0) const;
+    /// Forget the samples and all-time figures; producers carry on undisturbed.
+    void reset();
+
+    /// window count, last, min, mean, p50, p90, p99 and max of the samples, plus a
+    /// histogram: log2 microsecond buckets for durations, 10 % steps for AudioFill,
+    /// and the sum for AudioUnderruns.
+    static QJsonObject summary(Metric metric, const QVector<qint32>& samples);
+    static QString metricName(Metric metric);
+    /// "us", "percent" or "count"
+    static QString unit(Metric metric);
+
+private:
+    struct Series {
+        std::atomic<qint32> samples[kWindow];
+        std::atomic<quint64> recorded{0};
+        std::atomic<quint64> resetAt{0};    // samples before this index were reset away
+        std::atomic<qint64> total{0};
+        std::atomic<qint32> max{0};
+    };
+
+    std::atomic<bool> m_enabled{false};
+    std::atomic<qint32> m_nominalFrameUs{20000};
+    Series m_series[kMetricCount];
+};
+
+#endif // PERFORMANCEMONITOR_H
@@ -0,0 +1,47 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef PERFORMANCEOVERLAY_H
+#define PERFORMANCEOVERLAY_H
+
+#include "performancemonitor.h"
+#include <QWidget>
+
+class QTimer;
+
+// Translucent panel over the emulator display (EmulatorWidget) with the
+// emulation speed and, per PerformanceMonitor metric, the median, p99 and
+// maximum of the rolling window above a graph of its recent samples. It only
+// reads the monitor's rings, a few times a second, and lets mouse events
+// through to the display.
+class PerformanceOverlay : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit PerformanceOverlay(PerformanceMonitor* monitor, QWidget* parent = nullptr);
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private:
+    static constexpr int kRefreshMs = 250;
+    static constexpr int kGraphSamples = 150;
+    static constexpr int kRowHeight = 30;
+    static constexpr int kWidth = 280;
+
+    static QString formatValue(PerformanceMonitor::Metric metric, qint32 value);
+
+    PerformanceMonitor* m_monitor;
+    QTimer* m_refreshTimer;
+};
+
+#endif // PERFORMANCEOVERLAY_H
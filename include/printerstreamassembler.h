@@ -0,0 +1,56 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef PRINTERSTREAMASSEMBLER_H
+#define PRINTERSTREAMASSEMBLER_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+// Turns FujiNet-PC's printer payloads into appended chunks.
+//
+// GET /print hands back the whole job printed so far on every poll, so a long
+// listing arrives again and again, each time a little longer. Rather than
+// hashing and re-rendering the whole thing, the assembler remembers how much
+// of the job it has seen plus a small window at its start and at its end: a
+// payload that is the same length and still matches those windows is a
+// duplicate, a longer one that matches is the same job grown by its tail, and
+// anything else starts a new job. Each check costs O(window + new bytes).
+class PrinterStreamAssembler
+{
+public:
+    enum Kind {
+        Duplicate,  // nothing new
+        Appended,   // same job, delta is the new tail
+        NewJob      // a different job, delta is the whole payload
+    };
+    struct Update {
+        Kind kind = Duplicate;
+        QByteArray delta;
+    };
+
+    /// Feeds the whole job as the server currently holds it.
+    Update feed(const QByteArray& payload);
+    /// Forgets the current job, so the next payload counts as new.
+    void reset();
+
+    /// Bytes of the current job seen so far.
+    qint64 received() const { return m_received; }
+
+    /// Bytes compared at each end of what has been seen.
+    static constexpr int kWindowBytes = 64;
+
+private:
+    bool continuesCurrentJob(const QByteArray& payload) const;
+    void remember(const QByteArray& payload);
+
+    QByteArray m_head;
+    QByteArray m_tail;
+    qint64 m_received = 0;
+};
+
+#endif // PRINTERSTREAMASSEMBLER_H
@@ -24,6 +24,7 @@
 #include <QScrollBar>
 #include <QPropertyAnimation>
 #include <QPixmap>
+#include "printerstreamassembler.h"
 
 class PrinterWidget : public QWidget
 {
@@ -86,6 +87,7 @@ private:
     void updateControls();
     QString formatTextForOutput(const QString& rawText);
     void showOutputViewer();
+    void appendToViewer(const QString& text);
     void updateViewerForCurrentState();
     void savePrinterOutput(const QByteArray& data, const QString& extension);
     bool validatePrinterOutput(const QByteArray& data, const QString& contentType);
@@ -133,7 +135,8 @@ private:
     QString m_lastSavedPath;  // Track last saved file for opening
     QByteArray m_lastPrinterData;  // Last binary data received from FujiNet
     QString m_lastContentType;     // Content type of last received data
-    QByteArray m_lastReceivedHash; // MD5 hash of last received data for deduplication
+    PrinterStreamAssembler m_printerStream; // Splits repeated /print payloads into appended chunks
+    bool m_viewerEndsWithNewline;  // Viewer text ends a line (for collapsing split line ends)
     qint64 m_lastProcessedTime;    // Timestamp when data was last processed
     int m_duplicateCount;          // Track consecutive duplicate receives
 
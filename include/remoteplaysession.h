@@ -0,0 +1,101 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef REMOTEPLAYSESSION_H
+#define REMOTEPLAYSESSION_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QVector>
+#include <QtGlobal>
+
+// Per-viewer state of the remote play stream (screen.stream_start with input):
+// an input jitter buffer and a round-trip estimate that drives frame skipping.
+//
+// Input packets carry the client's own sequence number. Each is given a release
+// frame at least delay frames after it arrived and one frame after the packet
+// before it, so a burst that arrives together after a network stall still
+// plays out one packet per frame. Packets older than the newest one queued are
+// late and dropped. A backlog is never held more than twice the delay.
+//
+// Clients acknowledge the frames they receive; the time from sending a frame
+// to its acknowledgement is smoothed as in RFC 6298. With adaptive skipping on,
+// only every frameSkip()-th due frame is sent while the smoothed round trip is
+// above the target, up to kMaxFrameSkip.
+class RemotePlaySession
+{
+public:
+    struct JoystickInput {
+        int player = 1;
+        int direction = 15;  // 0-15, 15 = centred
+        bool fire = false;
+    };
+
+    struct InputPacket {
+        quint32 sequence = 0;
+        QVector<JoystickInput> joysticks;
+        QVector<int> keys;  // AKEY codes, typed in order
+    };
+
+    static constexpr int kDefaultJitterFrames = 2;
+    static constexpr int kMaxJitterFrames = 30;
+    static constexpr int kMaxFrameSkip = 8;
+    /// Frames sent but never acknowledged are forgotten beyond this many.
+    static constexpr int kMaxFramesInFlight = 120;
+
+    RemotePlaySession() = default;
+    RemotePlaySession(int jitterFrames, bool adaptive, int targetRttMs);
+
+    int jitterFrames() const { return m_jitterFrames; }
+    bool isAdaptive() const { return m_adaptive; }
+    int targetRttMs() const { return m_targetRttMs; }
+
+    /// Queue a packet that arrived while the emulator was at frame. Returns false
+    /// (and counts it) when it is a duplicate or older than the newest queued.
+    bool queueInput(const InputPacket& packet, quint64 frame);
+    /// Packets whose release frame has come, in order. A frame number lower than
+    /// the last one seen (rewind, state load) releases everything.
+    QVector<InputPacket> takeDueInput(quint64 frame);
+    int queuedInput() const { return m_queue.size(); }
+
+    void frameSent(quint64 frame, qint64 nowUs);
+    /// Returns false for frames that were not sent, or already acknowledged.
+    bool acknowledge(quint64 frame, qint64 nowUs);
+    /// Smoothed round trip in microseconds; 0 before the first acknowledgement.
+    qint64 smoothedRttUs() const { return m_srttUs; }
+    /// 1 unless adaptive skipping is on and the round trip is over target.
+    int frameSkip() const;
+
+    /// jitter_frames, queued_input, late_input, applied_input, rtt_ms, rtt_var_ms,
+    /// frame_skip, frames_in_flight and acknowledged.
+    QJsonObject stats() const;
+
+private:
+    struct QueuedInput {
+        InputPacket packet;
+        quint64 releaseFrame = 0;
+    };
+
+    int m_jitterFrames = kDefaultJitterFrames;
+    bool m_adaptive = false;
+    int m_targetRttMs = 50;
+
+    QVector<QueuedInput> m_queue;
+    bool m_hasSequence = false;
+    quint32 m_lastSequence = 0;
+    quint64 m_lastRelease = 0;
+    quint64 m_lastFrame = 0;
+    quint64 m_lateInput = 0;
+    quint64 m_appliedInput = 0;
+
+    QHash<quint64, qint64> m_sentAtUs;  // by frame, until acknowledged
+    qint64 m_srttUs = 0;
+    qint64 m_rttVarUs = 0;
+    quint64 m_acknowledged = 0;
+};
+
+#endif // REMOTEPLAYSESSION_H
@@ -0,0 +1,73 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef REWINDBUFFER_H
+#define REWINDBUFFER_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <vector>
+
+// Fixed-budget history of emulator save states for instant rewind.
+//
+// The newest state ("head") is kept uncompressed. Every older state is stored
+// as the XOR of itself with its successor, zero-run-length encoded: consecutive
+// snapshots differ in a few KB, so a delta is typically a small fraction of the
+// full state. Rewinding walks the deltas backwards from the head.
+//
+// All memory is allocated up front: the head, a scratch buffer and a circular
+// arena of budgetBytes for the encoded deltas. When the arena is full the
+// oldest deltas are discarded. Not thread-safe; owned by the emulator thread.
+class RewindBuffer
+{
+public:
+    RewindBuffer(int maxStateSize, qint64 budgetBytes);
+
+    void clear();
+
+    /// Record a new newest state. The previous head is re-encoded as a delta.
+    void push(const unsigned char* state, int size, quint64 frame);
+
+    /// Number of states that can be restored (head included); 0 when empty.
+    int depth() const { return m_hasHead ? m_entries.size() + 1 : 0; }
+    /// Frame number of the state `steps` back from the newest (0 = head).
+    quint64 frameAt(int steps) const;
+
+    /// Drop the `steps` newest states and return the state that becomes the new head.
+    /// Returns nullptr when steps >= depth(). The pointer stays valid until the next push().
+    const unsigned char* rewind(int steps, int* size, quint64* frame);
+
+    /// Bytes of arena in use by encoded deltas (excludes the head).
+    qint64 usedBytes() const { return m_usedBytes; }
+    qint64 budgetBytes() const { return static_cast<qint64>(m_arena.size()); }
+    int maxStateSize() const { return static_cast<int>(m_head.size()); }
+
+private:
+    struct Entry {
+        qint64 offset;   // in m_arena
+        int encodedSize;
+        int stateSize;   // size of the older state this delta reconstructs
+        quint64 frame;
+    };
+
+    int encodeDelta(const unsigned char* older, int olderSize, const unsigned char* newer, int newerSize);
+    void decodeDeltaInto(const Entry& entry, unsigned char* state, int stateSize);
+    qint64 reserve(int bytes);
+    void dropOldest();
+
+    std::vector<unsigned char> m_head;
+    std::vector<unsigned char> m_scratch;
+    std::vector<unsigned char> m_arena;
+    QVector<Entry> m_entries;          // oldest first
+    int m_headSize = 0;
+    quint64 m_headFrame = 0;
+    bool m_hasHead = false;
+    qint64 m_writeOffset = 0;
+    qint64 m_usedBytes = 0;
+};
+
+#endif // REWINDBUFFER_H
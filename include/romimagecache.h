@@ -0,0 +1,81 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef ROMIMAGECACHE_H
+#define ROMIMAGECACHE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QSharedPointer>
+#include <QString>
+
+// Content-addressed store for OS, BASIC and cartridge images.
+//
+// libatari800 only takes ROMs and cartridges by path, so resolve() returns the
+// path the core should open instead of the user's: a copy in the store
+// directory named by the SHA-1 of its contents. A source is read and hashed
+// once per process, and again only when its size or timestamp changes; after
+// that a cold boot costs one stat. Every copy in use is kept mapped, so its
+// pages stay resident and are shared with any other process using the same
+// store: point all headless workers at one directory (a tmpfs such as
+// /dev/shm keeps it off disk entirely) and each image is read from its source
+// once per farm, not once per boot. The store survives restarts; copies are
+// written atomically, so workers importing the same image at once are safe.
+//
+// State files record the cartridge path the core opened, i.e. the copy in the
+// store, so keep a store that states must be restored from.
+//
+// Not thread-safe; AtariEmulator uses it from the thread that initializes the core.
+class RomImageCache
+{
+public:
+    /// An empty directory (the default) turns the cache off.
+    void setDirectory(const QString& directory);
+    QString directory() const { return m_directory; }
+    bool isEnabled() const { return !m_directory.isEmpty(); }
+
+    /// The path to hand libatari800 for sourcePath: its copy in the store, or
+    /// sourcePath itself when the cache is off, the file is missing or too
+    /// large, or the store cannot be written.
+    QString resolve(const QString& sourcePath);
+    /// Tells the cache that sourcePath, at this size and timestamp, has contents
+    /// with this hex SHA-1 (e.g. from MediaLibrary). If the store already holds
+    /// that copy, the next resolve() is a hit without reading the source. Returns
+    /// whether the copy was there.
+    bool addKnownImage(const QString& sourcePath, qint64 size, const QDateTime& modified, const QByteArray& hash);
+
+    /// Resolves served from the index without reading the source
+    int hits() const { return m_hits; }
+    /// Sources read and hashed
+    int reads() const { return m_reads; }
+    /// Copies written to the store (a read whose contents were already there adds none)
+    int imports() const { return m_imports; }
+
+    /// Larger files are passed through uncached
+    static constexpr qint64 kMaxImageBytes = 16 * 1024 * 1024;
+
+private:
+    struct Entry {
+        qint64 size = 0;
+        QDateTime modified;
+        QByteArray hash;      // hex SHA-1
+        QString cachedPath;
+    };
+
+    bool mapCopy(const QByteArray& hash, const QString& cachedPath);
+
+    QString m_directory;
+    QHash<QString, Entry> m_entries;                       // source path -> copy
+    QHash<QByteArray, QSharedPointer<QFile>> m_mapped;     // hash -> open, mapped copy
+    int m_hits = 0;
+    int m_reads = 0;
+    int m_imports = 0;
+};
+
+#endif // ROMIMAGECACHE_H
@@ -0,0 +1,85 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef SCENARIOCASE_H
+#define SCENARIOCASE_H
+
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// The input script and expectations of one headless farm job (see HeadlessRunner).
+//
+// The script is a list of TCP requests, so a case can be tried against a live
+// instance with the same JSON: "system.schedule" requests and "batch" requests
+// holding them. Every action is queued with AtariEmulator::scheduleAction()
+// before the first frame runs; "frame" is the emulated frame count as
+// system.schedule sees it, "in_frames" counts from the start of the run.
+//
+//   "script": [
+//     {"command": "system.schedule", "params": {"in_frames": 100, "action": "console",
+//                                                "params": {"start": true}}},
+//     {"command": "batch", "params": {"commands": [
+//       {"command": "system.schedule", "params": {"in_frames": 300, "action": "joystick",
+//                                                  "params": {"player": 1, "value": 11}}},
+//       {"command": "system.schedule", "params": {"in_frames": 300, "action": "char",
+//                                                  "params": {"char": "Y"}}}]}}
+//   ],
+//   "expect": {
+//     "screen_text": ["READY"],                       // each must appear on screen
+//     "memory": [{"address": "$0600", "length": 16, "sha1": "..."},
+//                {"address": "$02C8", "bytes": [148]}],
+//     "memory_sha1": "...",                           // all 64 KB, as the farm reports it
+//     "pc": "$E459",
+//     "check_every": 10                               // stop once all of them hold
+//   }
+class ScenarioCase
+{
+public:
+    struct Action {
+        bool relative = false;      // frame counts from the start of the run
+        quint64 frame = 0;
+        QString type;
+        QJsonObject params;
+    };
+
+    struct MemoryCheck {
+        int address = 0;
+        int length = 0;
+        QString sha1;               // lower-case hex of the range, or
+        QByteArray bytes;           // the exact contents
+    };
+
+    QVector<Action> actions;        // in script order, FIFO within a frame
+    QStringList screenText;
+    QVector<MemoryCheck> memoryChecks;
+    QString memorySha1;
+    int pc = -1;                    // -1: not checked
+    int checkEvery = 0;             // frames between checks while running; 0: only at the end
+
+    bool hasExpectations() const;
+
+    /// Reads "script" and "expect" of a resolved job; false with error on an invalid one.
+    bool parse(const QJsonObject& job, QString* error);
+
+    /// Checks the expectations against the screen text rows, the 64 KB CPU view
+    /// and the PC: {"ok", "failures": [...]}, one message per unmet expectation.
+    QJsonObject verify(const QStringList& screenRows, const QByteArray& memory, int currentPc) const;
+
+    /// The checks system.schedule applies to an action before queueing it.
+    static bool validateAction(const QString& type, const QJsonObject& params, QString* error);
+    /// An address as an integer, "$hex" or a C literal ("0x600", "1536").
+    static bool parseAddress(const QJsonValue& value, int* address);
+
+private:
+    bool parseRequest(const QJsonObject& request, bool inBatch, QString* error);
+};
+
+#endif // SCENARIOCASE_H
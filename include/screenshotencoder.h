@@ -0,0 +1,64 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef SCREENSHOTENCODER_H
+#define SCREENSHOTENCODER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+
+// Lossless screenshot encoding off the caller's thread.
+//
+// The caller hands over a copy of the indexed frame taken at a frame boundary
+// (AtariEmulator::renderIndexedScreen()), so encoding never races the emulator.
+// Encoding, and writing the file if a path is given, run on a small worker
+// pool; finished() is delivered to the encoder's own thread.
+//
+// PNG keeps the frame as 8-bit indexed with its palette. QOI
+// (https://qoiformat.org) is an RGB format that encodes several times faster
+// than PNG, for CI runs that capture every few frames.
+class ScreenshotEncoder : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Format {
+        FormatPng,
+        FormatQoi
+    };
+
+    explicit ScreenshotEncoder(QObject* parent = nullptr);
+    ~ScreenshotEncoder() override;
+
+    /// Queues frame (Format_Indexed8 with a colour table) for encoding and, if
+    /// path is not empty, for writing to path. Returns the ticket finished() reports.
+    quint64 submit(const QImage& frame, Format format, const QString& path = QString());
+    /// Blocks until every submitted frame has been encoded (tests, shutdown).
+    void waitForDone();
+
+    static QByteArray encode(const QImage& frame, Format format, QString* error = nullptr);
+    static QByteArray encodeQoi(const QImage& frame);
+    /// "png" or "qoi", case-insensitive
+    static bool parseFormat(const QString& name, Format* format);
+    static QString formatName(Format format);
+    static QString mimeType(Format format);
+
+signals:
+    /// data is the encoded image; error is set (and data empty) if encoding or
+    /// writing path failed.
+    void finished(quint64 ticket, const QByteArray& data, const QString& path, const QString& error);
+
+private:
+    QThreadPool m_pool;
+    std::atomic<quint64> m_nextTicket{1};
+};
+
+#endif // SCREENSHOTENCODER_H
@@ -0,0 +1,95 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef SCREENSTREAMENCODER_H
+#define SCREENSTREAMENCODER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QRgb>
+
+// Encodes 8-bit indexed frames into the binary packets of the TCP screen stream
+// (screen.stream_start). One encoder per subscriber: it remembers the last frame
+// and palette it sent, so row and delta packets are always relative to what that
+// client already has, even when frames were skipped in between.
+//
+// Every packet is a 20-byte little-endian header followed by the payload:
+//   u8 magic (0xFB)  u8 type  u16 width  u16 height  u16 reserved
+//   u64 frame  u32 payload length
+// The magic byte never starts a JSON line, so packets can share the socket with
+// the newline-delimited JSON messages.
+//
+// Payloads:
+//   Palette  256 x RGB (768 bytes); sent before the first frame and on change
+//   Full     width * height palette indices
+//   Rows     u16 row count, then per changed row: u16 y + width indices
+//   Delta    tokens <skip varint> <count varint> <count indices> over the frame
+//            in raster order; untouched bytes keep their previous value
+//   Audio    u64 index of the first sample since the stream started, then
+//            little-endian PCM as POKEY produced it; width, height and reserved
+//            carry sample rate, channels and bits per sample instead
+// Rows and Delta fall back to Full for the first frame and whenever the
+// encoded delta would be larger than the frame itself.
+class ScreenStreamEncoder
+{
+public:
+    static constexpr quint8 kMagic = 0xFB;
+    static constexpr int kHeaderSize = 20;
+
+    enum PacketType : quint8 {
+        PacketPalette = 1,
+        PacketFull = 2,
+        PacketRows = 3,
+        PacketDelta = 4,
+        PacketAudio = 5
+    };
+
+    enum Encoding {
+        EncodingFull,
+        EncodingRows,
+        EncodingDelta
+    };
+
+    explicit ScreenStreamEncoder(Encoding encoding = EncodingFull);
+
+    Encoding encoding() const { return m_encoding; }
+    static bool parseEncoding(const QString& name, Encoding* encoding);
+    static QString encodingName(Encoding encoding);
+    /// 256 RGB triplets (768 bytes), the palette payload; missing entries are black.
+    static QByteArray paletteToRgb(const QVector<QRgb>& palette);
+
+    /// Forget the previous frame and palette so the next encode() starts with a
+    /// palette and full frame again.
+    void reset();
+
+    /// Append the packets for one frame to out: a palette packet when palette
+    /// differs from the last one sent, then one frame packet.
+    void encode(const unsigned char* pixels, int width, int height, int stride,
+                const QVector<QRgb>& palette, quint64 frame, QByteArray& out);
+
+    /// Append one audio packet; frame is the latest frame sent with it.
+    static void appendAudio(QByteArray& out, int sampleRate, int channels, int bitsPerSample,
+                            quint64 frame, quint64 firstSample, const QByteArray& pcm);
+
+private:
+    static void appendHeader(QByteArray& out, PacketType type, int width, int height,
+                             quint64 frame, int payloadSize, int reserved = 0);
+    void appendPalette(QByteArray& out, const QVector<QRgb>& palette, int width, int height, quint64 frame);
+    bool appendRows(QByteArray& out, const unsigned char* pixels, int width, int height, quint64 frame);
+    bool appendDelta(QByteArray& out, const unsigned char* pixels, int size, int width, int height,
+                     quint64 frame);
+
+    Encoding m_encoding;
+    QByteArray m_previous;          // last frame sent, packed width * height
+    int m_width = 0;
+    int m_height = 0;
+    QVector<QRgb> m_palette;        // last palette sent; empty until the first frame
+    QByteArray m_packed;            // input repacked when its stride differs from its width
+};
+
+#endif // SCREENSTREAMENCODER_H
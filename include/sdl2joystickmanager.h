@@ -15,6 +15,8 @@
 #include <QString>
 #include <QStringList>
 #include <QMap>
+#include <QElapsedTimer>
+#include <atomic>
 
 // Forward declare SDL types to avoid including SDL headers in the header
 typedef struct _SDL_Joystick SDL_Joystick;
@@ -42,12 +44,25 @@ public:
     bool initialize();
     void shutdown();
 
-    // Joystick state polling
+    // Joystick state polling: pumps SDL and applies the pending joystick events.
+    // The emulator calls this right before each frame; the poll timer only
+    // covers the time the emulator is not running frames.
     void pollJoysticks();
 
     // Get current joystick state for emulation
     JoystickState getJoystickState(int joystickIndex) const;
 
+    // Lock-free form of the stick and trigger for the frame loop (any thread):
+    // bits 0-7 stick, kPackedTrigger and kPackedConnected. 0 when disconnected.
+    static constexpr quint32 kPackedTrigger = 0x100;
+    static constexpr quint32 kPackedConnected = 0x200;
+    quint32 packedState(int joystickIndex) const
+    {
+        return joystickIndex >= 0 && joystickIndex < MAX_JOYSTICKS
+                   ? m_packedStates[joystickIndex].load(std::memory_order_acquire)
+                   : 0;
+    }
+
     // Joystick information
     bool isJoystickConnected(int joystickIndex) const;
     QString getJoystickName(int joystickIndex) const;
@@ -81,6 +96,10 @@ private:
     void handleJoystickAdded(int sdlDeviceIndex);
     void handleJoystickRemoved(SDL_JoystickID instanceId);
 
+    // Read one joystick's axes and buttons into m_joystickStates/m_packedStates
+    void updateJoystickState(int index);
+    void publishPackedState(int index);
+
     // Convert SDL values to Atari format
     int convertSDLAxisToAtariStick(int xAxis, int yAxis) const;
     bool isWithinDeadZone(int axis) const;
@@ -91,6 +110,8 @@ private:
     QMap<int, JoystickState> m_joystickStates;  // Current state for each joystick
     QMap<int, SDL_JoystickID> m_joystickIds;  // Map our index to SDL instance ID
 
+    QElapsedTimer m_sinceLastPoll;  // lets the timer skip polls the frame loop already did
+
     int m_deadZone;  // Analog stick deadzone (0-32767)
     bool m_enabled;  // Whether joystick polling is enabled
     bool m_initialized;  // Whether SDL joystick subsystem is initialized
@@ -98,6 +119,8 @@ private:
     static const int MAX_JOYSTICKS = 4;  // Maximum joysticks supported
     static const int DEFAULT_DEADZONE = 8000;  // Default deadzone value
     static const int POLL_INTERVAL_MS = 16;  // ~60fps polling
+
+    std::atomic<quint32> m_packedStates[MAX_JOYSTICKS];
 };
 
 #endif // HAVE_SDL2_JOYSTICK
@@ -149,6 +149,11 @@ private:
     QCheckBox* m_turboModeCheck;
     QSlider* m_speedSlider;
     QLabel* m_speedLabel;
+    QSpinBox* m_runAheadSpinBox;
+    QComboBox* m_threadPriorityCombo;
+    QComboBox* m_cpuAffinityCombo;
+    QCheckBox* m_preciseTimingCheck;
+    QCheckBox* m_hibernateOnQuitCheck;
     
     // Cartridge Configuration controls
     QCheckBox* m_cartridgeEnabledCheck;
@@ -171,6 +176,7 @@ private:
     
     QCheckBox* m_stereoPokey;
     QCheckBox* m_sioAcceleration;
+    QCheckBox* m_tapeAcceleration;
     
     // 80-Column Cards
     QCheckBox* m_xep80Enabled;
@@ -190,11 +196,14 @@ private:
     QCheckBox* m_soundEnabled;
     QComboBox* m_audioFrequency;
     QComboBox* m_audioBits;
+    QComboBox* m_audioResampler;
+    QComboBox* m_audioTurboMode;
     QSlider* m_volumeSlider;
     QLabel* m_volumeLabel;
     QSpinBox* m_bufferLengthSpinBox;
     QSpinBox* m_audioLatencySpinBox;
     QCheckBox* m_audioDiagnosticsCheck;
+    QCheckBox* m_audioSyncCheck;
     QCheckBox* m_consoleSound;
     QCheckBox* m_serialSound;
     
@@ -204,6 +213,7 @@ private:
     QCheckBox* m_showFPS;
     QCheckBox* m_scalingFilter;
     QCheckBox* m_integerScaling;
+    QCheckBox* m_gpuPresentation;
     QCheckBox* m_keepAspectRatio;
     QCheckBox* m_fullscreenMode;
     
@@ -216,6 +226,12 @@ private:
     QDoubleSpinBox* m_overscanFactor;
     QCheckBox* m_show80Column;
     QCheckBox* m_vSyncEnabled;
+
+    // CRT effects (GPU rendering only)
+    QGroupBox* m_crtGroup;
+    QSpinBox* m_crtScanlines;
+    QSpinBox* m_crtPersistence;
+    QSpinBox* m_crtCurvature;
     
     // PAL-specific controls
     QGroupBox* m_palGroup;
@@ -307,6 +323,7 @@ private:
     QWidget* m_emulatorTab;
     QCheckBox* m_tcpServerEnabled;
     QSpinBox* m_tcpServerPort;
+    QLineEdit* m_localServerName;
 
     // Log Filtering controls
     QLineEdit* m_logFilterString;
@@ -0,0 +1,102 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef SHAREDSTATEREGION_H
+#define SHAREDSTATEREGION_H
+
+#include <QFile>
+#include <QJsonObject>
+#include <QRgb>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+// Memory-mapped file the emulator thread rewrites after every frame with the
+// frame number, CPU registers, the 384x240 screen (palette indices), the
+// palette and chosen RAM ranges, so a harness on the same host can read the
+// machine state without a request or a syscall per frame (opened with
+// system.open_shared_state).
+//
+// Everything is little-endian. The 64-byte header:
+//   0  u32 magic "FJSS"    4 u16 version   6 u16 header size
+//   8  u32 sequence        12 u32 total size
+//   16 u64 frame           24 u16 PC       26 u8 A X Y S P   31 u8 reserved
+//   32 u16 screen width    34 u16 screen height  36 u32 screen offset
+//   40 u32 palette offset  44 u32 RAM offset
+//   48 u32 range count     52 u32 range table offset  56 u64 publish count
+// The range table holds per range u32 address, u32 length, u32 offset and
+// u32 reserved; the palette is 256 x RGB.
+//
+// The sequence is a seqlock: it is odd while a frame is being written. A
+// reader copies what it needs between two reads of the sequence and retries
+// when they differ or the first one was odd.
+class SharedStateRegion
+{
+public:
+    static constexpr quint32 kMagic = 0x53534A46;  // "FJSS"
+    static constexpr quint16 kVersion = 1;
+    static constexpr int kHeaderSize = 64;
+    static constexpr int kScreenWidth = 384;
+    static constexpr int kScreenHeight = 240;
+    static constexpr int kMaxRanges = 64;
+
+    struct Range {
+        int address = 0;
+        int length = 0;
+    };
+
+    struct Registers {
+        quint16 pc = 0;
+        quint8 a = 0;
+        quint8 x = 0;
+        quint8 y = 0;
+        quint8 s = 0;
+        quint8 p = 0;
+    };
+
+    SharedStateRegion() = default;
+    ~SharedStateRegion();
+    SharedStateRegion(const SharedStateRegion&) = delete;
+    SharedStateRegion& operator=(const SharedStateRegion&) = delete;
+
+    /// Where a region with this name lives: /dev/shm when the system has it
+    /// (never written back to disk), the temporary directory otherwise.
+    static QString pathForName(const QString& name);
+
+    /// Create (or replace) the file at path and map it. Ranges must lie inside
+    /// the 64 KB address space.
+    bool open(const QString& path, const QVector<Range>& ranges, QString* error);
+    /// Unmap and delete the file.
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+    QString path() const { return m_file.fileName(); }
+
+    /// Offsets and sizes of the open region, as reported to the client.
+    QJsonObject layout() const;
+
+    /// Write one frame's state; memory is the 64 KB CPU address space.
+    void publish(quint64 frame, const Registers& registers, const unsigned char* screen,
+                 const QVector<QRgb>& palette, const unsigned char* memory);
+
+private:
+    void writeU16(int offset, quint16 value);
+    void writeU32(int offset, quint32 value);
+    void writeU64(int offset, quint64 value);
+
+    QFile m_file;
+    uchar* m_data = nullptr;
+    std::atomic<quint32>* m_sequence = nullptr;  // placed in the header at offset 8
+    QVector<Range> m_ranges;
+    QVector<int> m_rangeOffsets;
+    int m_screenOffset = 0;
+    int m_paletteOffset = 0;
+    int m_ramOffset = 0;
+    int m_size = 0;
+    quint64 m_publishCount = 0;
+};
+
+#endif // SHAREDSTATEREGION_H
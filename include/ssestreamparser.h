@@ -0,0 +1,53 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef SSESTREAMPARSER_H
+#define SSESTREAMPARSER_H
+
+#include <QByteArray>
+#include <QVector>
+
+// Incremental parser for a text/event-stream (Server-Sent Events) body, fed
+// with whatever chunks the network hands over.
+//
+// Lines may end in LF, CRLF or a lone CR, and a chunk may split a line (or a
+// CRLF pair) anywhere. "event:", "data:", "id:" and "retry:" fields build up
+// an event that a blank line dispatches; multi-line data is joined with LF.
+// Comment lines (": keepalive") carry nothing but still count as traffic.
+class SseStreamParser
+{
+public:
+    struct Event {
+        QByteArray name = "message";  // "event:" field
+        QByteArray data;
+        QByteArray id;
+    };
+
+    /// Returns the events completed by this chunk, in order.
+    QVector<Event> feed(const QByteArray& chunk);
+    void reset();
+
+    /// Last "retry:" value in ms, or -1 if the server sent none.
+    int retryMs() const { return m_retryMs; }
+    /// Bytes of an unfinished line waiting for more input.
+    int pendingBytes() const { return m_line.size(); }
+
+    /// Lines longer than this are dropped so a broken stream cannot grow without bound.
+    static constexpr int kMaxLineBytes = 1 << 20;
+
+private:
+    void processLine(QVector<Event>& events);
+
+    QByteArray m_line;
+    Event m_event;
+    bool m_hasData = false;
+    bool m_lastWasCR = false;
+    bool m_discardingLine = false;
+    int m_retryMs = -1;
+};
+
+#endif // SSESTREAMPARSER_H
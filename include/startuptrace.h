@@ -0,0 +1,86 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtGlobal>
+
+// Records where startup time goes, from main() to the first frame on screen,
+// as Chrome trace events (load the file in chrome://tracing or Perfetto).
+//
+//   fujisan --startup-trace trace.json       (or FUJISAN_STARTUP_TRACE=trace.json)
+//   fujisan --startup-benchmark              print time-to-first-frame and quit
+//
+// Phases are marked with StartupTrace::Scope on whichever thread runs them
+// (the emulator init runs on the worker thread); markFirstFrame() ends the
+// trace, writes the file and, in benchmark mode, prints one JSON summary line
+// and quits. Until enable() is called every call is a cheap no-op.
+class StartupTrace
+{
+public:
+    struct Event {
+        QByteArray name;
+        qint64 startUs = 0;
+        qint64 durationUs = -1;  // -1: instant event
+        int thread = 0;          // index in threadNames()
+    };
+
+    /// Times the enclosing block as one event.
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* m_name;
+        qint64 m_startUs;
+    };
+
+    /// Parses --startup-trace/--startup-benchmark and FUJISAN_STARTUP_TRACE;
+    /// call first thing in main() so the clock starts there.
+    static void enableFromArguments(int argc, char* argv[]);
+    static void enable(const QString& outputPath, bool benchmark);
+    static bool isEnabled();
+    static bool isBenchmark();
+
+    static void addComplete(const char* name, qint64 startUs, qint64 durationUs);
+    static void addInstant(const char* name);
+    /// Microseconds since enable().
+    static qint64 nowUs();
+
+    /// Records the first frame reaching the GUI and finishes the trace; later calls do nothing.
+    static void markFirstFrame();
+    static bool firstFrameSeen();
+
+    static QVector<Event> events();
+    static QStringList threadNames();
+    /// Trace Event Format document ({"traceEvents": [...]}).
+    static QByteArray toChromeJson();
+    /// {"time_to_first_frame_ms": ..., "phases": {name: ms}} with the longest
+    /// span of each named phase.
+    static QJsonObject summary();
+    static bool writeTo(const QString& path, QString* error = nullptr);
+
+    /// Drops everything and disables tracing (tests).
+    static void reset();
+
+    static constexpr int kBenchmarkTimeoutMs = 30000;
+
+private:
+    static int threadIndex();
+};
+
+#endif // STARTUPTRACE_H
@@ -0,0 +1,46 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef STATEFILEWORKER_H
+#define STATEFILEWORKER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+
+// Save-state file I/O, run on its own thread so compression and slow storage
+// never stall the emulator thread (and with it the audio stream).
+//
+// Files are written compressed: an 8-byte "FUJISANZ" magic followed by a
+// qCompress() (zlib) payload of the raw LIBATARI800_StateSave buffer. Reading
+// also accepts legacy uncompressed .a8s files. Writes go through QSaveFile, so
+// saved() is emitted only after the data was synced and atomically renamed.
+class StateFileWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StateFileWorker(QObject* parent = nullptr);
+
+    /// Synchronous helpers, also used directly by AtariEmulator::saveState()/loadState().
+    static bool writeStateFile(const QString& filename, const QByteArray& rawState,
+                               const QString& profileName);
+    static bool readStateFile(const QString& filename, QByteArray& rawState, QString& profileName);
+
+    static QByteArray encode(const QByteArray& rawState);
+    static bool decode(const QByteArray& fileData, QByteArray& rawState);
+
+public slots:
+    void save(const QString& filename, const QByteArray& rawState, const QString& profileName);
+    void load(const QString& filename);
+
+signals:
+    void saved(const QString& filename, bool success);
+    void loaded(const QString& filename, const QByteArray& rawState, const QString& profileName, bool success);
+};
+
+#endif // STATEFILEWORKER_H
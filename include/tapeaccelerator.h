@@ -0,0 +1,53 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef TAPEACCELERATOR_H
+#define TAPEACCELERATOR_H
+
+#include <QJsonObject>
+#include <QtGlobal>
+
+// Decides, once per frame, when a tape is being loaded through the cassette
+// port rather than served by the SIO patch, so the emulator can run unlimited
+// and silent until it is done (see AtariEmulator::updateTapeAcceleration()).
+//
+// The cassette motor line (PACTL bit 3) is the signal: standard OS loads,
+// BASIC CLOAD and custom turbo loaders all have to switch the motor on to read
+// a block. A load starts after kStartFrames frames of motor with a tape that
+// has data left, and ends after kStopFrames frames without motor (the OS stops
+// it between records, so this spans a record gap), at the end of the tape or
+// when the tape is removed or switched to recording.
+class TapeAccelerator
+{
+public:
+    enum Transition {
+        NoChange,
+        Start,
+        Stop
+    };
+
+    static constexpr int kStartFrames = 3;
+    static constexpr int kStopFrames = 100;
+
+    /// position and size are in CAS blocks, as the core reports them.
+    Transition update(bool tapeMounted, bool motorOn, bool recording, int position, int size);
+    /// Forget the current load without reporting a Stop (reboot, new tape).
+    void reset();
+
+    bool isActive() const { return m_active; }
+    /// active, loads, accelerated_frames
+    QJsonObject status() const;
+
+private:
+    bool m_active = false;
+    int m_motorOnFrames = 0;
+    int m_motorOffFrames = 0;
+    quint64 m_loads = 0;
+    quint64 m_acceleratedFrames = 0;
+};
+
+#endif // TAPEACCELERATOR_H
@@ -0,0 +1,149 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef TCPCONNECTIONHUB_H
+#define TCPCONNECTIONHUB_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "jsonmessageframer.h"
+#include "latencyhistogram.h"
+#include "messageencoder.h"
+
+class QIODevice;
+class QLocalServer;
+class QTcpServer;
+
+// Socket side of the TCP API, run on its own thread by TCPServer so accepting,
+// reading, framing, JSON parsing and writing never wait for the GUI thread and
+// a client flooding requests cannot stall painting. Besides the loopback TCP
+// port it can listen on a local socket (Unix domain socket, or named pipe on
+// Windows) carrying the exact same protocol, for clients on the same host.
+//
+// Clients are identified by a connection id that is never reused, so TCPServer
+// can keep per-client state and answer long after a socket went away without
+// touching socket objects from another thread. Requests arrive in order as
+// requestReceived(); anything sent to an id that has disconnected is dropped.
+//
+// Events are the only traffic that may be shed: once a client has more than its
+// limit of written-but-unsent bytes, new events are dropped or, with the coalesce
+// policy, only the latest event of each type is kept and written when the socket
+// has drained below half the limit. Responses and raw data always go out.
+//
+// Each connection also has its own MessageEncoder: newline-delimited JSON by
+// default, or CBOR / MessagePack and optional deflate, chosen by the client.
+class TCPConnectionHub : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum BackpressurePolicy {
+        DropEvents,
+        CoalesceEvents
+    };
+
+    static constexpr qint64 kDefaultEventBacklogLimit = 1024 * 1024;
+
+    explicit TCPConnectionHub(QObject* parent = nullptr);
+    ~TCPConnectionHub() override;
+
+    /// Thread-safe: queue a message (serialised on the I/O thread in the client's
+    /// encoding) or raw bytes for a client. The serialisation time of a message
+    /// is recorded under metricKey, typically the command it answers.
+    void sendMessage(quint32 client, const QJsonObject& message, const QString& metricKey = QString());
+    void sendData(quint32 client, const QByteArray& data);
+    /// Thread-safe: queue an event, subject to the client's backpressure policy. The
+    /// broadcast variant serialises the event once for all clients.
+    void sendEvent(quint32 client, const QString& eventType, const QJsonObject& event);
+    void broadcastEvent(const QVector<quint32>& clients, const QString& eventType, const QJsonObject& event);
+    /// Thread-safe: bytes handed to the client's socket that it has not written yet.
+    qint64 queuedBytes(quint32 client) const;
+
+    static QJsonObject parseJsonMessage(const QByteArray& data, bool& success);
+    static bool parsePolicy(const QString& name, BackpressurePolicy* policy);
+    static QString policyName(BackpressurePolicy policy);
+
+public slots:
+    // I/O thread; TCPServer calls these with a blocking queued connection
+    bool listen(quint16 port);
+    quint16 serverPort() const;
+    /// Listen on a local socket as well; replaces a stale socket left by a crash.
+    bool listenLocal(const QString& name);
+    /// Full path of the local socket, empty while not listening locally.
+    QString localServerPath() const;
+    /// Stop accepting local connections; local clients already connected stay.
+    void closeLocal();
+    void close();
+    void setBackpressure(quint32 client, int policy, qint64 eventBacklogLimit);
+    /// Messages queued after this call use the new encoding; earlier ones keep the old.
+    void setEncoding(quint32 client, int encoding, int compressThreshold);
+    /// Counters and backpressure settings of one connection (empty if unknown).
+    QJsonObject connectionStats(quint32 client) const;
+    /// Serialisation time histograms by metric key (events as "event:<type>").
+    QJsonObject serialisationMetrics(bool reset);
+
+signals:
+    void clientConnected(quint32 client, const QString& address);
+    void clientDisconnected(quint32 client);
+    /// receivedAt is LatencyHistogram::nowMicroseconds() when the request was cut.
+    void requestReceived(quint32 client, const QJsonObject& request, qint64 receivedAt);
+    /// Bytes that did not frame or parse as a JSON object; answered as an error.
+    void requestRejected(quint32 client, const QString& error);
+
+private slots:
+    void onNewConnection();
+    void onNewLocalConnection();
+    void onReadyRead();
+    void onDisconnected();
+    void onBytesWritten(qint64 bytes);
+    void writeData(quint32 client, const QByteArray& data);
+
+private:
+    struct Connection {
+        QIODevice* socket = nullptr;    // QTcpSocket or QLocalSocket
+        JsonMessageFramer framer;
+        BackpressurePolicy policy = DropEvents;
+        MessageEncoder encoder;
+        qint64 eventBacklogLimit = kDefaultEventBacklogLimit;
+        // Coalesced events waiting for the socket to drain, latest per type, in first-seen order
+        QStringList coalescedOrder;
+        QHash<QString, QByteArray> coalesced;
+        quint64 eventsSent = 0;
+        quint64 eventsDropped = 0;
+        quint64 eventsCoalesced = 0;
+        quint64 messagesCompressed = 0;
+        qint64 peakQueuedBytes = 0;
+        quint64 bytesIn = 0;
+        quint64 bytesOut = 0;
+    };
+
+    void addConnection(QIODevice* socket, const QString& address);
+    void applyFramingRequest(Connection& connection, const QJsonObject& request);
+    void writeEvent(quint32 client, const QString& eventType, const QByteArray& line);
+    void queueBytes(quint32 client, Connection& connection, const QByteArray& data);
+    QByteArray serialise(const QJsonObject& message, const QString& metricKey,
+                         const MessageEncoder& encoder, bool* compressed = nullptr);
+
+    QTcpServer* m_server;
+    QLocalServer* m_localServer;
+    QHash<quint32, Connection> m_connections;   // I/O thread only
+    QHash<QIODevice*, quint32> m_socketClients;
+    quint32 m_nextClientId = 1;
+
+    QHash<QString, LatencyHistogram> m_serialisationTimes;
+
+    mutable QMutex m_queuedMutex;
+    QHash<quint32, qint64> m_queuedBytes;
+};
+
+#endif // TCPCONNECTIONHUB_H
@@ -9,16 +9,26 @@
 #define TCPSERVER_H
 
 #include <QObject>
-#include <QTcpServer>
-#include <QTcpSocket>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QJsonArray>
 #include <QJsonValue>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QList>
 #include <QMap>
+#include <QMultiHash>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include "latencyhistogram.h"
+#include "remoteplaysession.h"
+#include "screenstreamencoder.h"
+#include "screenshotencoder.h"
 
 // Forward declarations
+class QThread;
+class TCPConnectionHub;
 class AtariEmulator;
 class DebuggerWidget;
 class MainWindow;
@@ -36,6 +46,11 @@ public:
     void stopServer();
     bool isRunning() const;
     quint16 serverPort() const;
+    /// Also serve the API on a local socket (Unix domain socket / named pipe) with
+    /// this name while the server runs; empty turns it off. Applies immediately.
+    void setLocalServerName(const QString& name);
+    /// Full path of the local socket, empty while it is not listening.
+    QString localServerPath() const;
     
     // Client management
     int connectedClientCount() const;
@@ -52,51 +67,151 @@ public slots:
     void sendEventToAllClients(const QString& eventType, const QJsonObject& data);
 
 private slots:
-    void onNewConnection();
-    void onClientDisconnected();
-    void onClientDataReady();
-    void processCommand(QTcpSocket* client, const QJsonObject& request);
-    void streamJoystickStates();  // Timer callback for joystick streaming
+    void onClientConnected(quint32 client, const QString& address);
+    void onClientDisconnected(quint32 client);
+    void onRequestReceived(quint32 client, const QJsonObject& request, qint64 receivedAt);
+    void onRequestRejected(quint32 client, const QString& error);
+    void onJoystickInputChanged(quint64 frame, int port, int direction, bool fire,
+                                int previousDirection, bool previousFire);
+    void onConsoleInputChanged(quint64 frame, int keys, int previousKeys);
+    void onScreenTextChanged(quint64 frame, const QStringList& rows);
+    void onStateSaved(const QString& filename, bool success);
+    void onStateLoaded(const QString& filename, bool success);
+    void onRunToFinished(unsigned short pc, bool reachedTarget);
+    void onWatchpointHit(unsigned short pc, unsigned short address, int access);
+    void onScreenStreamFrameReady();
+    void onScheduledActionExecuted(int id, quint64 frame, const QString& type, const QJsonObject& result);
+    void onScreenshotEncoded(quint64 ticket, const QByteArray& data, const QString& path, const QString& error);
 
 private:
+    // Connection id from TCPConnectionHub; sockets themselves live on the I/O thread
+    using ClientId = quint32;
+    
+    void processCommand(ClientId client, const QJsonObject& request);
+    void routeCommand(ClientId client, const QJsonObject& request);
+    void startLocalListener();
+    
     // Command handlers
-    void handleMediaCommand(QTcpSocket* client, const QJsonObject& request, const QString& subCommand);
-    void handleSystemCommand(QTcpSocket* client, const QJsonObject& request, const QString& subCommand);
-    void handleInputCommand(QTcpSocket* client, const QJsonObject& request, const QString& subCommand);
-    void handleDebugCommand(QTcpSocket* client, const QJsonObject& request, const QString& subCommand);
-    void handleConfigCommand(QTcpSocket* client, const QJsonObject& request, const QString& subCommand);
-    void handleStatusCommand(QTcpSocket* client, const QJsonObject& request, const QString& subCommand);
-    void handleScreenCommand(QTcpSocket* client, const QJsonObject& request, const QString& subCommand);
+    void handleMediaCommand(ClientId client, const QJsonObject& request, const QString& subCommand);
+    void handleSystemCommand(ClientId client, const QJsonObject& request, const QString& subCommand);
+    void handleInputCommand(ClientId client, const QJsonObject& request, const QString& subCommand);
+    void handleDebugCommand(ClientId client, const QJsonObject& request, const QString& subCommand);
+    void handleConfigCommand(ClientId client, const QJsonObject& request, const QString& subCommand);
+    void handleStatusCommand(ClientId client, const QJsonObject& request, const QString& subCommand);
+    void handleScreenCommand(ClientId client, const QJsonObject& request, const QString& subCommand);
+    void handleBatch(ClientId client, const QJsonObject& request);
     
     // Utility methods
-    void sendResponse(QTcpSocket* client, const QJsonValue& requestId, bool success, 
+    static QJsonObject buildResponse(const QJsonValue& requestId, bool success, const QJsonValue& result,
+                                     const QString& error);
+    void sendResponse(ClientId client, const QJsonValue& requestId, bool success, 
                      const QJsonValue& result = QJsonValue(), const QString& error = QString());
-    void sendEvent(QTcpSocket* client, const QString& eventType, const QJsonObject& data);
-    QJsonObject parseJsonMessage(const QByteArray& data, bool& success);
+    void sendEvent(ClientId client, const QString& eventType, const QJsonObject& data);
+    bool isClientConnected(ClientId client) const { return m_clients.contains(client); }
     QString validateAndNormalizePath(const QString& path);
+    Qt::ConnectionType emulatorCallType() const;
+    void updateScreenStreamInterval();
     
     // Member variables
-    QTcpServer* m_server;
-    QList<QTcpSocket*> m_clients;
-    QMap<QTcpSocket*, QByteArray> m_clientBuffers; // For handling partial JSON messages
+    // Sockets, framing and JSON (de)serialisation on their own thread
+    QThread* m_ioThread;
+    TCPConnectionHub* m_hub;
+    QList<ClientId> m_clients;
     
     AtariEmulator* m_emulator;
     DebuggerWidget* m_debugger;
     MainWindow* m_mainWindow;
     
     quint16 m_port;
+    QString m_localServerName;
+    QString m_localServerPath;
     bool m_isRunning;
     
-    // Command statistics (for debugging/monitoring)
-    QMap<QString, int> m_commandStats;
+    // Per-command timings for status.get_metrics: queue wait is from the I/O
+    // thread cutting the request to this thread picking it up
+    struct CommandMetrics {
+        LatencyHistogram queueWait;
+        LatencyHistogram execution;
+    };
+    QHash<QString, CommandMetrics> m_commandMetrics;
+    // Command being executed; its response's serialisation time is recorded under it
+    QString m_currentCommand;
+    
+    // Requests answered when the emulator reports async completion
+    struct PendingRequest {
+        ClientId client;
+        QJsonValue requestId;
+        QString type;  // "quick" or "file" for states, "step_over"
+    };
+    // Save/load requests, keyed by file
+    QMultiHash<QString, PendingRequest> m_pendingStateSaves;
+    QMultiHash<QString, PendingRequest> m_pendingStateLoads;
+    // debug.step_over requests waiting for the subroutine to return
+    QList<PendingRequest> m_pendingStepOvers;
+    
+    // Event types each client subscribed to with config.subscribe_events; clients
+    // without an entry receive every broadcast event
+    QHash<ClientId, QSet<QString>> m_eventSubscriptions;
+    
+    // Last debug.read_memory_block diff read per client, keyed "bank:address:length"
+    QHash<ClientId, QHash<QString, QByteArray>> m_memoryDiffBases;
+    
+    // system.schedule clients, by action id, to route their "scheduled_action" events
+    QHash<int, ClientId> m_scheduledActionOwners;
     
-    // Joystick streaming infrastructure
-    QTimer* m_joystickStreamTimer;
-    QSet<QTcpSocket*> m_joystickStreamClients;
-    int m_lastJoy0State;
-    int m_lastJoy1State;
-    bool m_lastTrig0;
-    bool m_lastTrig1;
+    // While a batch runs, responses to its client are collected here instead of written
+    ClientId m_batchClient = 0;
+    QJsonArray* m_batchResponses = nullptr;
+    
+    // Binary screen stream (screen.stream_start), one encoder per subscribed socket;
+    // remote play adds audio packets, buffered input back and RTT-driven skipping
+    struct ScreenStreamSubscriber {
+        ScreenStreamEncoder encoder;
+        RemotePlaySession session;
+        int interval = 1;
+        bool audio = false;
+        quint64 lastFrame = 0;
+        bool started = false;
+        quint64 audioSamples = 0;  // sent so far, the next audio packet's first sample
+    };
+    QHash<ClientId, ScreenStreamSubscriber> m_screenStreamClients;
+    quint64 m_lastStreamFrame = 0;
+    QJsonObject m_streamAudioFormat;  // emulator's audio format; empty while nobody takes audio
+    int m_streamAudioBytesPerSample = 0;
+    void applyStreamInput(ScreenStreamSubscriber& subscriber, quint64 frame);
+
+    // screen.capture requests waiting for the encoder pool, by ticket
+    struct PendingCapture {
+        ClientId client = 0;
+        QJsonValue requestId;
+        QString inlineMode;  // empty (file only), "base64" or "binary"
+        ScreenshotEncoder::Format format = ScreenshotEncoder::FormatPng;
+        qint64 frame = 0;
+        qint64 timestamp = 0;
+    };
+    ScreenshotEncoder* m_screenshotEncoder;
+    QHash<quint64, PendingCapture> m_pendingCaptures;
+    
+    // Joystick streaming: the emulator reports input changes per frame while anyone listens
+    QSet<ClientId> m_joystickStreamClients;
+    void updateInputChangeReporting();
+    void sendToJoystickStreamClients(const QString& eventType, const QJsonObject& data);
+
+    // Clients of screen.start_text_events
+    QSet<ClientId> m_screenTextClients;
+    void updateScreenTextEvents();
+
+    // status.get_performance with stream_ms: a "performance" event per interval
+    struct PerformanceSubscriber {
+        int intervalMs = 0;
+        int history = 0;
+        qint64 lastSentMs = 0;
+    };
+    QHash<ClientId, PerformanceSubscriber> m_performanceClients;
+    QTimer* m_performanceTimer = nullptr;
+    QElapsedTimer m_performanceClock;
+    void updatePerformanceTimer();
+    void sendPerformanceEvents();
 };
 
 #endif // TCPSERVER_H
\ No newline at end of file
@@ -0,0 +1,56 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef THREADSCHEDULING_H
+#define THREADSCHEDULING_H
+
+#include <QJsonObject>
+#include <QString>
+#include <chrono>
+
+// OS scheduling for the emulator thread: priority class, CPU affinity, the
+// system timer resolution and a precise wait for frame deadlines.
+//
+// Priorities map to what each OS offers without elevated rights where it can:
+//   High      Windows: MMCSS "Games" task; Linux: nice -10; macOS: QoS user-interactive
+//   Realtime  Windows: MMCSS "Games" at critical priority; Linux: SCHED_FIFO, then
+//             SCHED_RR; macOS: time-constraint policy for the frame period
+// A request the OS refuses (e.g. SCHED_FIFO without CAP_SYS_NICE or an
+// rtprio limit) falls back to the next lower level, and the result says what
+// was actually granted.
+class ThreadScheduling
+{
+public:
+    enum Priority {
+        PriorityNormal,
+        PriorityHigh,
+        PriorityRealtime
+    };
+
+    /// The precise wait sleeps until this long before the deadline, then spins.
+    static constexpr int kDefaultSpinUs = 500;
+
+    static bool parsePriority(const QString& name, Priority* priority);
+    static QString priorityName(Priority priority);
+
+    /// Apply priority and, with cpu >= 0, pin to that CPU (-1 allows all CPUs)
+    /// for the calling thread. periodUs is the frame period, for the macOS
+    /// real-time policy. Returns requested and granted priority, scheduler,
+    /// cpu and affinity_applied, plus "error" for anything refused.
+    static QJsonObject applyToCurrentThread(Priority priority, int cpu, int periodUs);
+
+    /// Windows: 1 ms system timer resolution (timeBeginPeriod) while enabled, so
+    /// sleeps and QTimer intervals are not rounded up to 15.6 ms. Elsewhere a no-op.
+    static void setHighResolutionTimer(bool enabled);
+
+    /// Sleep until spinUs before deadline, then yield-spin until it has passed.
+    static void waitUntil(std::chrono::steady_clock::time_point deadline, int spinUs = kDefaultSpinUs);
+
+    static int cpuCount();
+};
+
+#endif // THREADSCHEDULING_H
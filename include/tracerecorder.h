@@ -0,0 +1,119 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <QFile>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+#include <deque>
+#include <vector>
+
+// Records the CPU's instruction trace (patch 0022) into a memory-mapped ring
+// file, one chunk per drained batch.
+//
+// File layout (little-endian):
+//   header   64 bytes: "FJTRACE1", u32 version, u32 header size,
+//            u64 ring size, u64 head, u64 tail, u64 records, u64 dropped,
+//            u32 flags (kFlagRecording | kFlagWrapped), u32 chunks
+//   ring     chunks from head to tail, wrapping to the start of the ring at
+//            a "WRAP" marker or where fewer than 4 bytes are left
+//   chunk    u32 "TRCK", u32 payload size, u64 frame, u32 records,
+//            then the delta-encoded records
+//
+// Each record starts with a flags byte saying which fields differ from the
+// previous record, followed by those fields and then the opcode and cycle;
+// the first record of a chunk carries every field. The PC is only stored when
+// it is not the previous PC plus the previous instruction's length, and the
+// scanline only when it moved by other than 0 or 1, so straight-line code
+// costs 3-4 bytes an instruction instead of 12. When the ring is full the
+// oldest chunks are overwritten.
+//
+// Emulator thread only; the header is rewritten after every chunk, so the
+// file is readable (readFile()) while recording and after stop().
+class TraceRecorder
+{
+public:
+    // Same layout as libatari800_trace_record
+    struct RawRecord {
+        quint16 pc;
+        quint16 scanline;
+        quint8 a, x, y, s, p;
+        quint8 opcode;
+        quint8 cycle;
+        quint8 bank;  // XE bank (patch 0023); not stored in the file
+    };
+
+    struct Entry {
+        quint64 frame;
+        RawRecord record;
+    };
+
+    static constexpr quint32 kVersion = 1;
+    static constexpr int kHeaderBytes = 64;
+    static constexpr int kChunkHeaderBytes = 20;
+    static constexpr int kMaxChunkRecords = 4096;
+    static constexpr qint64 kMinRingBytes = 1 << 20;
+    static constexpr quint32 kFlagRecording = 1;
+    static constexpr quint32 kFlagWrapped = 2;
+
+    TraceRecorder();
+    ~TraceRecorder();
+
+    /// Create (or truncate) path with a ring of ringBytes and start recording.
+    bool start(const QString& path, qint64 ringBytes, QString* error = nullptr);
+    /// Stop appending; the file stays mapped for tail() until the next start().
+    void stop();
+    bool isRecording() const { return m_recording; }
+
+    /// Append records executed in frame; dropped counts records the core could
+    /// not store (its buffer was full).
+    void append(quint64 frame, const RawRecord* records, int count, int dropped = 0);
+
+    /// The newest count records still in the ring, oldest first.
+    QVector<Entry> tail(int count) const;
+    QJsonObject status() const;
+
+    /// Delta-encode records (the first one in full) into out, which needs
+    /// maxEncodedBytes(count). Returns the bytes written.
+    static int encode(const RawRecord* records, int count, unsigned char* out);
+    static int maxEncodedBytes(int count) { return count * 12; }
+    /// Decode count records from bytes; false if they run past the end.
+    static bool decode(const unsigned char* data, int bytes, int count, RawRecord* out);
+
+    /// Every record in a trace file, oldest first, or false with error.
+    static bool readFile(const QString& path, QVector<Entry>* entries, QString* error = nullptr);
+
+private:
+    struct Chunk {
+        qint64 offset;  // in the ring
+        int bytes;      // header plus payload
+        int records;
+        quint64 frame;
+    };
+
+    void appendChunk(quint64 frame, const RawRecord* records, int count);
+    void writeHeader();
+
+    QFile m_file;
+    unsigned char* m_map = nullptr;
+    unsigned char* m_ring = nullptr;
+    qint64 m_ringBytes = 0;
+    qint64 m_writeOffset = 0;
+    bool m_wrapped = false;
+    bool m_recording = false;
+    std::deque<Chunk> m_chunks;
+    quint64 m_records = 0;   // since start(), including overwritten ones
+    quint64 m_dropped = 0;
+    std::vector<unsigned char> m_scratch;
+    QString m_path;
+};
+
+#endif // TRACERECORDER_H
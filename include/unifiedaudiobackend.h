@@ -8,6 +8,8 @@
 
 #include <QObject>
 #include <SDL.h>
+#include "audioresampler.h"
+#include "audioring.h"
 #include <atomic>
 #include <memory>
 
@@ -37,6 +39,27 @@ public:
     // Audio data submission (thread-safe, lockless)
     bool submitAudio(const unsigned char* data, int length, AudioPriority priority = LOW_PRIORITY);
 
+    // Resampler used when the device rate differs from the emulator's (applies
+    // from the next initialize())
+    void setResamplerQuality(AudioResampler::Quality quality) { m_resamplerQuality = quality; }
+    AudioResampler::Quality resamplerQuality() const { return m_resamplerQuality; }
+
+    // Clock drift: with compensation on (the default) the resampler's ratio
+    // follows the ring fill level. Otherwise the ratio is nominal times
+    // setRateAdjustment() (e.g. 1.001 consumes 0.1% more input).
+    void setDriftCompensation(bool enabled) { m_driftCompensation.store(enabled); }
+    void setRateAdjustment(double factor) { m_rateAdjustment.store(factor); }
+    double getRateAdjustment() const { return m_rateAdjustment.load(); }
+
+    // Audio-master pacing (emulator thread): block until the device has drained
+    // the low priority ring to maxBytes or timeoutMs passes. Returns whether it
+    // drained in time. The callback wakes the waiter; it never takes a lock.
+    bool waitForQueuedBelow(int maxBytes, int timeoutMs);
+    // Ring fill the drift compensation and audio-master pacing aim for: two
+    // device buffers at the emulator's rate
+    int targetQueuedBytes() const;
+    bool isInitialized() const { return m_initialized; }
+
     // Volume control (0.0 to 1.0)
     void setVolume(float volume);
     float getVolume() const { return m_volume.load(); }
@@ -47,6 +70,9 @@ public:
     // Get buffer status for monitoring
     float getBufferFillPercent() const;
     int getUnderrunCount() const { return m_underrunCount.load(); }
+    // Low priority ring fill and steady clock time (us) of the last device callback
+    int queuedBytes() const { return m_lowPriorityBuffer.available(); }
+    long long lastCallbackMicroseconds() const { return m_lastCallbackUs.load(std::memory_order_relaxed); }
     int getOverrunCount() const { return m_overrunCount.load(); }
 
     // Reset statistics
@@ -60,17 +86,15 @@ private:
     // SDL audio callback (static, calls instance method)
     static void sdlAudioCallback(void* userdata, Uint8* stream, int len);
 
-    // Instance audio callback (real-time safe)
+    // Instance audio callback (real-time safe: no allocation, no locks)
     void audioCallback(Uint8* stream, int len);
 
-    // Sample rate conversion (real-time safe)
-    void resample(const float* input, int inputFrames, float* output, int outputFrames, int channels);
-
-    // High-quality resampling with linear interpolation
-    void resampleLinear(const float* input, int inputFrames, float* output, int outputFrames, int channels);
+    // Resampler ratio adjustment from the ring fill level (audio thread)
+    void updateDriftCompensation();
 
     // Audio mixing (real-time safe)
     void mixChannels(float* output, int frames);
+    void mixInto(const unsigned char* data, int bytes, float* output, int frames, float gain);
 
     // Ring buffer operations (lockless)
     bool writeToRingBuffer(const unsigned char* data, int length, AudioPriority priority);
@@ -94,30 +118,41 @@ private:
     // Ring buffers (separate for high/low priority)
     static const int RING_BUFFER_SIZE = 65536;  // 64KB per priority level
 
-    struct RingBuffer {
-        std::unique_ptr<unsigned char[]> data;
-        std::atomic<int> writePos;
-        std::atomic<int> readPos;
-        std::atomic<int> size;
-
-        RingBuffer() : writePos(0), readPos(0), size(0) {
-            data = std::make_unique<unsigned char[]>(RING_BUFFER_SIZE);
-        }
-    };
-
-    RingBuffer m_lowPriorityBuffer;
-    RingBuffer m_highPriorityBuffer;
+    AudioRing m_lowPriorityBuffer{RING_BUFFER_SIZE};
+    AudioRing m_highPriorityBuffer{RING_BUFFER_SIZE};
 
-    // Resampling state
+    // Resampling state: m_resampleRatio is device rate / emulator rate. The
+    // resampler keeps its history and phase between callbacks.
     float m_resampleRatio;
-    float m_resamplePhase;
+    AudioResampler m_resampler;
+    AudioResampler::Quality m_resamplerQuality;
+    bool m_resampling;
     std::unique_ptr<float[]> m_tempResampleBuffer;
     int m_tempResampleBufferSize;
 
+    // Drift compensation
+    std::atomic<bool> m_driftCompensation;
+    std::atomic<double> m_rateAdjustment;
+    double m_smoothedFillBytes;
+
+    // Posted by the callback after draining while an audio-master waiter exists
+    SDL_sem* m_spaceAvailable;
+    std::atomic<bool> m_spaceWaiter;
+
+    // Callback work buffers, sized in initialize() for one device buffer so the
+    // callback never allocates: resampled output and the raw bytes drained from
+    // each ring (m_tempResampleBuffer above is the mix bus)
+    std::unique_ptr<float[]> m_outputBuffer;
+    int m_outputBufferSize;
+    std::unique_ptr<unsigned char[]> m_highPriorityScratch;
+    std::unique_ptr<unsigned char[]> m_lowPriorityScratch;
+    int m_scratchSize;
+
     // Performance monitoring (atomic)
     std::atomic<int> m_underrunCount;
     std::atomic<int> m_overrunCount;
     std::atomic<long long> m_totalFramesProcessed;
+    std::atomic<long long> m_lastCallbackUs{0};  // steady clock
 
     // Dynamic latency management
     int m_targetLatencyMs;
@@ -0,0 +1,53 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifndef XEXIMAGE_H
+#define XEXIMAGE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+// An Atari binary load file (XEX/COM/EXE) split into its segments, for
+// writing straight into memory instead of feeding it through the OS loader.
+//
+// The file opens with $FFFF and each segment is a start and end address
+// (inclusive, little-endian) followed by its bytes; further $FFFF markers
+// between segments are allowed. As DOS does, a segment that writes INITAD
+// ($02E2) runs that routine once the segment is in memory, and the last value
+// written to RUNAD ($02E0) is where the program starts. Without a RUNAD the
+// program starts at its first segment, as atari800's loader has it.
+class XexImage
+{
+public:
+    struct Segment {
+        quint16 start = 0;
+        QByteArray data;
+        int initAddress = -1;  // INIT routine to call after this segment, or -1
+        int end() const { return start + data.size() - 1; }
+    };
+
+    /// Parses a whole file. Truncated or malformed files fail; the OS loader
+    /// is more forgiving and remains the fallback for those.
+    bool parse(const QByteArray& file, QString* error = nullptr);
+
+    const QVector<Segment>& segments() const { return m_segments; }
+    /// Start address of the program, or -1 for an empty image.
+    int runAddress() const { return m_runAddress; }
+    /// True when any segment writes a byte in first..last.
+    bool touches(int first, int last) const;
+
+    static constexpr quint16 kRunVector = 0x02E0;
+    static constexpr quint16 kInitVector = 0x02E2;
+
+private:
+    QVector<Segment> m_segments;
+    int m_runAddress = -1;
+};
+
+#endif // XEXIMAGE_H
@@ -99,6 +99,83 @@ UPGRADE_EOF
         fi
     fi
 
+    # 0019 upgrade: instruction-precise breakpoint bitmap in the CPU core.
+    if [ -f "src/libatari800/api.c" ] && ! grep -q 'libatari800_set_breakpoint_map' src/libatari800/api.c; then
+        echo "Upgrade: applying 0019 cpu-breakpoint-bitmap.patch"
+        if [ -f "$PATCHES_DIR/0019-cpu-breakpoint-bitmap.patch" ]; then
+            git apply --ignore-whitespace "$PATCHES_DIR/0019-cpu-breakpoint-bitmap.patch" </dev/null 2>/dev/null || \
+            patch -p1 --force --no-backup-if-mismatch < "$PATCHES_DIR/0019-cpu-breakpoint-bitmap.patch" </dev/null || true
+            rm -f src/cpu.o src/libatari800/api.o src/libatari800.a
+            echo "✓ cpu.c upgraded with 0019 breakpoint bitmap"
+        fi
+    fi
+
+    # 0020 upgrade: memory watchpoints (on top of 0019).
+    if [ -f "src/libatari800/api.c" ] && ! grep -q 'libatari800_set_watch_map' src/libatari800/api.c; then
+        echo "Upgrade: applying 0020 cpu-memory-watchpoints.patch"
+        if [ -f "$PATCHES_DIR/0020-cpu-memory-watchpoints.patch" ]; then
+            git apply --ignore-whitespace "$PATCHES_DIR/0020-cpu-memory-watchpoints.patch" </dev/null 2>/dev/null || \
+            patch -p1 --force --no-backup-if-mismatch < "$PATCHES_DIR/0020-cpu-memory-watchpoints.patch" </dev/null || true
+            rm -f src/cpu.o src/libatari800/api.o src/libatari800.a
+            echo "✓ cpu.c upgraded with 0020 memory watchpoints"
+        fi
+    fi
+
+    # 0021 upgrade: host access to XE extended RAM banks.
+    if [ -f "src/libatari800/api.c" ] && ! grep -q 'libatari800_get_xe_memory' src/libatari800/api.c; then
+        echo "Upgrade: applying 0021 memory-xe-bank-access.patch"
+        if [ -f "$PATCHES_DIR/0021-memory-xe-bank-access.patch" ]; then
+            git apply --ignore-whitespace "$PATCHES_DIR/0021-memory-xe-bank-access.patch" </dev/null 2>/dev/null || \
+            patch -p1 --force --no-backup-if-mismatch < "$PATCHES_DIR/0021-memory-xe-bank-access.patch" </dev/null || true
+            rm -f src/memory.o src/libatari800/api.o src/libatari800.a
+            echo "✓ memory.c upgraded with 0021 XE bank access"
+        fi
+    fi
+
+    # 0022 upgrade: per-instruction trace buffer in the CPU core.
+    if [ -f "src/libatari800/api.c" ] && ! grep -q 'libatari800_set_trace_buffer' src/libatari800/api.c; then
+        echo "Upgrade: applying 0022 cpu-instruction-trace.patch"
+        if [ -f "$PATCHES_DIR/0022-cpu-instruction-trace.patch" ]; then
+            git apply --ignore-whitespace "$PATCHES_DIR/0022-cpu-instruction-trace.patch" </dev/null 2>/dev/null || \
+            patch -p1 --force --no-backup-if-mismatch < "$PATCHES_DIR/0022-cpu-instruction-trace.patch" </dev/null || true
+            rm -f src/cpu.o src/libatari800/api.o src/libatari800.a
+            echo "✓ cpu.c upgraded with 0022 instruction trace"
+        fi
+    fi
+
+    # 0023 upgrade: XE bank in trace records.
+    if [ -f "src/cpu.c" ] && grep -q 'CPU_trace_buffer' src/cpu.c && ! grep -q 'record->bank' src/cpu.c; then
+        echo "Upgrade: applying 0023 cpu-trace-xe-bank.patch"
+        if [ -f "$PATCHES_DIR/0023-cpu-trace-xe-bank.patch" ]; then
+            git apply --ignore-whitespace "$PATCHES_DIR/0023-cpu-trace-xe-bank.patch" </dev/null 2>/dev/null || \
+            patch -p1 --force --no-backup-if-mismatch < "$PATCHES_DIR/0023-cpu-trace-xe-bank.patch" </dev/null || true
+            rm -f src/cpu.o src/libatari800.a
+            echo "✓ cpu.c upgraded with 0023 trace XE bank"
+        fi
+    fi
+
+    # 0024 upgrade: NetSIO link health and adaptive sync/recv timeouts.
+    if [ -f "src/netsio.c" ] && ! grep -q 'netsio_get_link_stats' src/netsio.c; then
+        echo "Upgrade: applying 0024 netsio-link-health.patch"
+        if [ -f "$PATCHES_DIR/0024-netsio-link-health.patch" ]; then
+            git apply --ignore-whitespace "$PATCHES_DIR/0024-netsio-link-health.patch" </dev/null 2>/dev/null || \
+            patch -p1 --force --no-backup-if-mismatch < "$PATCHES_DIR/0024-netsio-link-health.patch" </dev/null || true
+            rm -f src/netsio.o src/libatari800.a
+            echo "✓ netsio.c upgraded with 0024 link health"
+        fi
+    fi
+
+    # 0025 upgrade: the same for netsiowin.c (Windows build)
+    if [ -f "src/netsiowin.c" ] && ! grep -q 'netsio_get_link_stats' src/netsiowin.c; then
+        echo "Upgrade: applying 0025 netsio-windows-link-health.patch"
+        if [ -f "$PATCHES_DIR/0025-netsio-windows-link-health.patch" ]; then
+            git apply --ignore-whitespace "$PATCHES_DIR/0025-netsio-windows-link-health.patch" </dev/null 2>/dev/null || \
+            patch -p1 --force --no-backup-if-mismatch < "$PATCHES_DIR/0025-netsio-windows-link-health.patch" </dev/null || true
+            rm -f src/netsiowin.o src/libatari800.a
+            echo "✓ netsiowin.c upgraded with 0025 link health"
+        fi
+    fi
+
     echo "Patches already applied in this source tree ($PATCH_MARKER present), skipping."
     exit 0
 fi
@@ -114,6 +191,12 @@ if [ -f "src/netsio.c" ] && [ -f "src/libatari800/api.c" ] && \
    grep -q 'recvfrom exit (n=%zd errno=%d)' src/netsio.c && \
    grep -q 'Close the write end first so any thread blocked in select' src/netsio.c && \
    grep -q 'int libatari800_execute_cycles(int target_cycles)' src/libatari800/api.c && \
+   grep -q 'libatari800_set_breakpoint_map' src/libatari800/api.c && \
+   grep -q 'libatari800_set_watch_map' src/libatari800/api.c && \
+   grep -q 'libatari800_get_xe_memory' src/libatari800/api.c && \
+   grep -q 'libatari800_set_trace_buffer' src/libatari800/api.c && \
+   grep -q 'record->bank' src/cpu.c && \
+   grep -q 'netsio_get_link_stats' src/netsio.c && \
    grep -q 'CPU_GetInstructionCycles' src/cpu.h; then
     echo "Detected previously patched source tree; writing $PATCH_MARKER and skipping."
     touch "$PATCH_MARKER"
@@ -0,0 +1,66 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "accesstracering.h"
+
+namespace {
+
+quint32 roundUpToPowerOfTwo(int value)
+{
+    quint32 size = 1;
+    while (size < static_cast<quint32>(qMax(1, value))) {
+        size <<= 1;
+    }
+    return size;
+}
+
+}  // namespace
+
+AccessTraceRing::AccessTraceRing(int capacity)
+    : m_entries(roundUpToPowerOfTwo(capacity))
+    , m_mask(static_cast<quint32>(m_entries.size()) - 1)
+{
+}
+
+bool AccessTraceRing::push(const AccessTraceEntry& entry)
+{
+    const quint32 head = m_head.load(std::memory_order_relaxed);
+    const quint32 tail = m_tail.load(std::memory_order_acquire);
+    // Indices run freely and wrap at 2^32; the difference is the fill level
+    if (head - tail > m_mask) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_entries[head & m_mask] = entry;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+QVector<AccessTraceEntry> AccessTraceRing::drain(int maxEntries)
+{
+    const quint32 tail = m_tail.load(std::memory_order_relaxed);
+    const quint32 head = m_head.load(std::memory_order_acquire);
+    const quint32 count = qMin(head - tail, static_cast<quint32>(qMax(0, maxEntries)));
+
+    QVector<AccessTraceEntry> entries;
+    entries.reserve(static_cast<int>(count));
+    for (quint32 i = 0; i < count; ++i) {
+        entries.append(m_entries[(tail + i) & m_mask]);
+    }
+    m_tail.store(tail + count, std::memory_order_release);
+    return entries;
+}
+
+void AccessTraceRing::clear()
+{
+    m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+int AccessTraceRing::size() const
+{
+    return static_cast<int>(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire));
+}
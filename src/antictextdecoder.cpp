@@ -0,0 +1,137 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "antictextdecoder.h"
+
+namespace {
+
+// A normal display is 240 scan lines; anything longer is a runaway list
+constexpr int kMaxScanlines = 240;
+constexpr int kMaxInstructions = 512;
+
+// Playfield widths from DMACTL bits 0-1
+enum Width { WidthNone = 0, WidthNarrow = 1, WidthNormal = 2, WidthWide = 3 };
+
+quint16 readWord(const unsigned char* memory, quint16 address)
+{
+    return static_cast<quint16>(memory[address] | (memory[static_cast<quint16>(address + 1)] << 8));
+}
+
+// ANTIC's counters only carry within 1 KB (display list) and 4 KB (screen memory)
+quint16 advanceDisplayList(quint16 address, int bytes)
+{
+    return static_cast<quint16>((address & 0xFC00) | ((address + bytes) & 0x03FF));
+}
+
+quint16 advanceScreen(quint16 address, int bytes)
+{
+    return static_cast<quint16>((address & 0xF000) | ((address + bytes) & 0x0FFF));
+}
+
+}  // namespace
+
+QVector<AnticTextDecoder::Line> AnticTextDecoder::decode(const unsigned char* memory, quint16 displayList,
+                                                         int dmactl)
+{
+    QVector<Line> lines;
+    const int width = dmactl & 0x03;
+    if (!memory || width == WidthNone) {
+        return lines;
+    }
+
+    quint16 pc = displayList;
+    quint16 screen = 0;
+    int scanline = 0;
+    for (int i = 0; i < kMaxInstructions && scanline < kMaxScanlines; ++i) {
+        const unsigned char instruction = memory[pc];
+        pc = advanceDisplayList(pc, 1);
+        const int mode = instruction & 0x0F;
+
+        if (mode == 0) {
+            scanline += ((instruction >> 4) & 0x07) + 1;  // blank lines
+            continue;
+        }
+        if (mode == 1) {
+            const quint16 target = readWord(memory, pc);
+            if (instruction & 0x40) {
+                break;  // JVB: the frame ends here
+            }
+            pc = target;
+            continue;
+        }
+        if (instruction & 0x40) {  // LMS
+            screen = readWord(memory, pc);
+            pc = advanceDisplayList(pc, 2);
+        }
+
+        // Horizontal scrolling fetches one width up
+        const int fetchWidth = (instruction & 0x10) && width < WidthWide ? width + 1 : width;
+        const int bytes = bytesPerLine(mode, fetchWidth);
+        if (mode <= 7) {
+            Line line;
+            line.mode = mode;
+            line.scanline = scanline;
+            line.address = screen;
+            line.codes.resize(bytes);
+            line.text.resize(bytes);
+            quint16 address = screen;
+            for (int column = 0; column < bytes; ++column) {
+                const unsigned char code = memory[address];
+                line.codes[column] = static_cast<char>(code);
+                line.text[column] = atasciiToChar(internalToAtascii(code, mode));
+                address = advanceScreen(address, 1);
+            }
+            lines.append(line);
+        }
+        screen = advanceScreen(screen, bytes);
+        scanline += scanlinesPerLine(mode);
+    }
+    return lines;
+}
+
+unsigned char AnticTextDecoder::internalToAtascii(unsigned char code, int mode)
+{
+    // Modes 6 and 7 have 64 characters; the top bits pick the colour
+    const unsigned char character = (mode == 6 || mode == 7) ? (code & 0x3F) : (code & 0x7F);
+    if (character < 0x40) {
+        return static_cast<unsigned char>(character + 0x20);
+    }
+    if (character < 0x60) {
+        return static_cast<unsigned char>(character - 0x40);
+    }
+    return character;
+}
+
+QChar AnticTextDecoder::atasciiToChar(unsigned char atascii)
+{
+    // 0x60 and 0x7B-0x7F are card suits and arrows; 0x00-0x1F are graphics
+    if ((atascii >= 0x20 && atascii <= 0x5F) || (atascii >= 0x61 && atascii <= 0x7A)) {
+        return QChar(atascii);
+    }
+    return QChar(' ');
+}
+
+int AnticTextDecoder::bytesPerLine(int mode, int width)
+{
+    // Bytes per line at normal width for modes 2-15; narrow is 4/5, wide 6/5 of it
+    static const int kNormalBytes[16] = {0, 0, 40, 40, 40, 40, 20, 20, 10, 10, 20, 20, 20, 40, 40, 40};
+    const int normal = kNormalBytes[mode & 0x0F];
+    switch (width) {
+    case WidthNarrow:
+        return normal * 4 / 5;
+    case WidthWide:
+        return normal * 6 / 5;
+    default:
+        return normal;
+    }
+}
+
+int AnticTextDecoder::scanlinesPerLine(int mode)
+{
+    static const int kScanlines[16] = {1, 1, 8, 10, 8, 16, 8, 16, 8, 4, 4, 2, 1, 2, 1, 1};
+    return kScanlines[mode & 0x0F];
+}
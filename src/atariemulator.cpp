@@ -13,6 +13,13 @@
 #endif
 
 #include "atariemulator.h"
+#include "screenstreamencoder.h"
+#include "disasm6502.h"
+#include "xeximage.h"
+#include "basicprogramimage.h"
+#include "startuptrace.h"
+#include "threadscheduling.h"
+#include "hibernateimage.h"
 #include <QDebug>
 #include <QApplication>
 #include <QMetaObject>
@@ -26,12 +33,18 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QThread>
+#include <QTextStream>
 #include <QCoreApplication>
 #include <QEvent>
+#include <QElapsedTimer>
 #include <QByteArray>
+#include <QtEndian>
+#include <algorithm>
 #include <cstring>  // for memset
+#include <iterator>
 #include <vector>   // for std::vector
 #include <chrono>   // for high-resolution logging timestamps
+#include <climits>
 
 #ifdef HAVE_SDL2_AUDIO
 #include "sdl2audiobackend.h"
@@ -56,6 +69,7 @@ extern void netsio_flush_fifo(void);
 #endif
 #include "../src/rtime.h"
 #include "../src/binload.h"
+#include "../src/sio.h"
 // Printer support functions
 void ESC_PatchOS(void);
 void Devices_UpdatePatches(void);
@@ -73,27 +87,70 @@ extern int GTIA_consol_override;
 
 // Direct Atari RAM access — used to poll CH ($02FC) for OS keyboard readiness.
 unsigned char *libatari800_get_main_memory_ptr();
+// CPU-visible memory, for scheduled writes and bulk memory access
+extern unsigned char MEMORY_mem[65536];
+// RAM size in KB and the cartridge windows, so fastLoadXex() only writes RAM
+extern int MEMORY_ram_size;
+extern int MEMORY_cartA0BF_enabled;
+extern int MEMORY_cart809F_enabled;
+// ANTIC's display list pointer and DMA control, for reading text off the screen
+extern unsigned short ANTIC_dlist;
+extern unsigned char ANTIC_DMACTL;
+// Chip register shadows (the values last written) and status, for machine snapshots
+extern unsigned char ANTIC_CHACTL, ANTIC_HSCROL, ANTIC_VSCROL, ANTIC_PMBASE, ANTIC_CHBASE;
+extern unsigned char ANTIC_NMIEN, ANTIC_NMIST;
+extern int ANTIC_ypos;
+extern unsigned char GTIA_HPOSP0, GTIA_HPOSP1, GTIA_HPOSP2, GTIA_HPOSP3;
+extern unsigned char GTIA_HPOSM0, GTIA_HPOSM1, GTIA_HPOSM2, GTIA_HPOSM3;
+extern unsigned char GTIA_SIZEP0, GTIA_SIZEP1, GTIA_SIZEP2, GTIA_SIZEP3, GTIA_SIZEM;
+extern unsigned char GTIA_GRAFP0, GTIA_GRAFP1, GTIA_GRAFP2, GTIA_GRAFP3, GTIA_GRAFM;
+extern unsigned char GTIA_COLPM0, GTIA_COLPM1, GTIA_COLPM2, GTIA_COLPM3;
+extern unsigned char GTIA_COLPF0, GTIA_COLPF1, GTIA_COLPF2, GTIA_COLPF3, GTIA_COLBK;
+extern unsigned char GTIA_PRIOR, GTIA_VDELAY, GTIA_GRACTL;
+extern unsigned char POKEY_AUDF[], POKEY_AUDC[], POKEY_AUDCTL[];
+extern unsigned char POKEY_KBCODE, POKEY_IRQEN, POKEY_IRQST, POKEY_SKCTL, POKEY_SKSTAT;
+extern unsigned char PIA_PORTA, PIA_PORTB, PIA_PBCTL;
+// The core's screenshot writer (SCREENSHOTS builds), for PCX and interlaced captures
+#include "../../src/screen.h"
 }
 
 // Static callback function for libatari800 disk activity
 static AtariEmulator* s_emulatorInstance = nullptr;
+// libatari800 keeps the whole machine (CPU, memory, palette, state buffer) in
+// process globals, so only one instance may have it initialized at a time.
+static std::atomic<AtariEmulator*> s_coreOwner{nullptr};
+
+#ifdef HAVE_SDL2_JOYSTICK
+// Copy SDL2JoystickManager::packedState() words for ports 0 and 1 into input;
+// ports without a connected joystick keep their value.
+static void applySdlJoystickState(input_template_t& input, const quint32 packed[2])
+{
+    if (packed[0] & SDL2JoystickManager::kPackedConnected) {
+        input.joy0 = packed[0] & 0xFF;
+        input.trig0 = (packed[0] & SDL2JoystickManager::kPackedTrigger) ? 1 : 0;
+    }
+    if (packed[1] & SDL2JoystickManager::kPackedConnected) {
+        input.joy1 = packed[1] & 0xFF;
+        input.trig1 = (packed[1] & SDL2JoystickManager::kPackedTrigger) ? 1 : 0;
+    }
+}
+#endif
+
+// Restoring a state re-mounts every attached disk, cartridge and cassette from
+// its file (SIO_StateRead() and friends), which must not happen every frame
+static bool mediaAttached()
+{
+    for (int drive = 0; drive < SIO_MAX_DRIVES; ++drive) {
+        if (SIO_drive_status[drive] != SIO_OFF && SIO_drive_status[drive] != SIO_NO_DISK) {
+            return true;
+        }
+    }
+    return CARTRIDGE_main.type != 0 || CASSETTE_status != CASSETTE_STATUS_NONE;
+}
+
 static void diskActivityCallback(int drive, int operation) {
     if (s_emulatorInstance) {
-        // Convert libatari800 operation to Qt signal parameters
-        bool isWriting = (operation == 1);  // SIO_LAST_WRITE = 1, SIO_LAST_READ = 0
-        
-        
-        // Emit Qt signal on the main thread
-        QMetaObject::invokeMethod(s_emulatorInstance, "diskIOStart", Qt::QueuedConnection,
-                                Q_ARG(int, drive), Q_ARG(bool, isWriting));
-        
-        // Set a timer to turn the LED off after a short time (hardware-accurate timing)
-        QTimer::singleShot(100, s_emulatorInstance, [drive]() {
-            if (!s_emulatorInstance || !s_emulatorInstance->isLibatari800Initialized())
-                return;
-            QMetaObject::invokeMethod(s_emulatorInstance, "diskIOEnd", Qt::QueuedConnection,
-                                    Q_ARG(int, drive));
-        });
+        s_emulatorInstance->noteDiskActivity(drive, operation == 1);  // SIO_LAST_WRITE = 1
     }
 }
 
@@ -108,9 +165,6 @@ AtariEmulator::AtariEmulator(QObject *parent)
     , m_audioOutput(nullptr)
     , m_audioDevice(nullptr)
     , m_audioEnabled(true)
-    , m_dspBufferBytes(0)
-    , m_dspWritePos(0)
-    , m_dspReadPos(0)
     , m_callbackTick(0)
     , m_avgGap(0.0)
     , m_targetDelay(0)
@@ -122,8 +176,6 @@ AtariEmulator::AtariEmulator(QObject *parent)
     , m_userRequestedSpeedMultiplier(1.0)
     , m_printerEnabled(false)
     , m_netSIOEnabled(false)
-    , m_usePartialFrameExecution(false)
-    , m_cyclesThisFrame(0)
 #ifdef HAVE_SDL2_JOYSTICK
     , m_joystickManager(nullptr)
     , m_realJoysticksEnabled(false)
@@ -140,8 +192,7 @@ AtariEmulator::AtariEmulator(QObject *parent)
     m_currentInput.trig0 = 0;  // 0 = released (inverted for libatari800)
     m_currentInput.trig1 = 0;  // 0 = released (inverted for libatari800)
 
-    // Set up the global instance pointer for the callback
-    s_emulatorInstance = this;
+    // The callbacks' instance pointer is set by claimCore(), once this machine owns the core
     
     // Use single-shot PreciseTimer for drift-compensated frame scheduling.
     // Single-shot mode means it fires exactly once per requestNextFrame() call,
@@ -150,6 +201,18 @@ AtariEmulator::AtariEmulator(QObject *parent)
     m_frameTimer->setSingleShot(true);
     connect(m_frameTimer, &QTimer::timeout, this, &AtariEmulator::processFrame);
 
+    // Save-state file I/O runs on its own thread; results come back queued.
+    m_stateIoThread = new QThread();
+    m_stateIoThread->setObjectName("StateFileIO");
+    m_stateIoWorker = new StateFileWorker();
+    m_stateIoWorker->moveToThread(m_stateIoThread);
+    connect(m_stateIoWorker, &StateFileWorker::saved, this, &AtariEmulator::stateSaved);
+    connect(m_stateIoWorker, &StateFileWorker::loaded, this, &AtariEmulator::onStateFileLoaded);
+    m_stateIoThread->start();
+
+    setRunAheadFrames(QSettings("8bitrelics", "Fujisan").value("machine/runAheadFrames", 0).toInt());
+    m_romImageCache.setDirectory(QString::fromLocal8Bit(qgetenv("FUJISAN_ROM_CACHE")));
+
 #ifdef HAVE_SDL2_JOYSTICK
     // SDL joystick init is deferred to the emulator worker thread (see initializeWithInputConfig)
     // so SDL open/pump/poll match the thread that owns the poll timer and processFrame().
@@ -162,12 +225,26 @@ AtariEmulator::AtariEmulator(QObject *parent)
 
 AtariEmulator::~AtariEmulator()
 {
-    if (s_emulatorInstance == this) {
+    // The core holds pointers into m_breakpointMap, m_watchMap and m_traceBuffer
+    // while this instance owns it, or last owned it and nobody has claimed it
+    // since; any other instance must leave the owner's hooks alone
+    AtariEmulator* const owner = s_coreOwner.load();
+    if (owner == this || (!owner && s_emulatorInstance == this)) {
         s_emulatorInstance = nullptr;
         libatari800_set_disk_activity_callback(nullptr);
+        libatari800_set_breakpoint_map(nullptr);
+        libatari800_set_watch_map(nullptr, nullptr);
+        libatari800_set_trace_buffer(nullptr, 0, 0, 0);
     }
     shutdown();
     teardownAudio();
+    stopAudioTelemetryLog();
+
+    // Let a pending save finish writing before the thread goes away
+    m_stateIoThread->quit();
+    m_stateIoThread->wait();
+    delete m_stateIoWorker;
+    delete m_stateIoThread;
 }
 
 bool AtariEmulator::initialize()
@@ -252,6 +329,7 @@ bool AtariEmulator::initializeWithDisplayConfig(bool basicEnabled, const QString
     // argList << "-fit-screen" << fitScreen;
     // if (show80Column) argList << "-80column"; else argList << "-no-80column";
     // if (vSyncEnabled) argList << "-vsync"; else argList << "-no-vsync";
+    // (V-sync is Fujisan's own: EmulatorWidget::setVSync() and setDisplayRefreshLock())
     
     
     // Add audio configuration
@@ -298,14 +376,14 @@ bool AtariEmulator::initializeWithDisplayConfig(bool basicEnabled, const QString
                 // Each QStringList element becomes a separate argv[] entry, so spaces are handled correctly.
                 if (machineType == "-5200") {
                     argList << "-5200-rev" << "AUTO";
-                    argList << "-5200_rom" << m_osRomPath;
+                    argList << "-5200_rom" << m_romImageCache.resolve(m_osRomPath);
                 } else if (machineType == "-atari") {
                     argList << "-800-rev" << "AUTO";
-                    argList << "-osb_rom" << m_osRomPath;  // 800 OS-B ROM
+                    argList << "-osb_rom" << m_romImageCache.resolve(m_osRomPath);  // 800 OS-B ROM
                 } else {
                     // For XL/XE machines
                     argList << "-xl-rev" << "AUTO";
-                    argList << "-xlxe_rom" << m_osRomPath;
+                    argList << "-xlxe_rom" << m_romImageCache.resolve(m_osRomPath);
                 }
             } else {
                 // File doesn't exist - fallback to Altirra OS
@@ -343,7 +421,7 @@ bool AtariEmulator::initializeWithDisplayConfig(bool basicEnabled, const QString
             // CRITICAL: Must set -basic-rev AUTO BEFORE the ROM file to reset any previously cached revision
             // NOTE: Do NOT quote - we're using char* array, not shell string
             argList << "-basic-rev" << "AUTO";
-            argList << "-basic_rom" << m_basicRomPath;
+            argList << "-basic_rom" << m_romImageCache.resolve(m_basicRomPath);
             qDebug() << "  -> Configured external BASIC ROM:" << m_basicRomPath;
         } else {
             qWarning() << "BASIC ROM file not found at" << m_basicRomPath;
@@ -378,6 +456,10 @@ bool AtariEmulator::initializeWithDisplayConfig(bool basicEnabled, const QString
     args[argBytes.size()] = nullptr;
     
     
+    if (!claimCore()) {
+        return false;
+    }
+
     // Force complete libatari800 reset to clear any persistent ROM state
     // This ensures ROM configuration changes are applied properly
     static bool libatari800_previously_initialized = false;
@@ -391,6 +473,7 @@ bool AtariEmulator::initializeWithDisplayConfig(bool basicEnabled, const QString
     if (libatari800_init(argBytes.size(), args.data())) {
         libatari800_previously_initialized = true;  // Mark as initialized for future resets
         m_libatari800Initialized = true;
+        m_paletteLutDirty.store(true);  // PAL/NTSC palette may differ after reinit
 
         // Verify ROM loading status
         if (!m_altirraOSEnabled && !m_osRomPath.isEmpty()) {
@@ -402,12 +485,13 @@ bool AtariEmulator::initializeWithDisplayConfig(bool basicEnabled, const QString
         } else if (basicEnabled && m_altirraBASICEnabled) {
         }
         m_targetFps = libatari800_get_fps();
-        m_frameTimeMs = 1000.0f / m_targetFps;
+        m_frameTimeMs = static_cast<float>(1000.0 / pacedFps());
 
         // Apply cartridge auto-reboot setting from QSettings
         QSettings settings("8bitrelics", "Fujisan");
         CARTRIDGE_autoreboot = settings.value("machine/cartridgeAutoReboot", true).toBool() ? 1 : 0;
         qDebug() << "CARTRIDGE_autoreboot initialized to:" << CARTRIDGE_autoreboot;
+        setTapeAccelerationEnabled(settings.value("machine/tapeAcceleration", true).toBool());
 
         // Set up the disk activity callback for hardware-level monitoring
         libatari800_set_disk_activity_callback(diskActivityCallback);
@@ -416,6 +500,7 @@ bool AtariEmulator::initializeWithDisplayConfig(bool basicEnabled, const QString
         debugSIOPatchStatus();
         
         // Initialize audio output if enabled
+        applyAudioSyncSetting();
         if (m_audioEnabled) {
             setupAudio();
         }
@@ -432,6 +517,7 @@ bool AtariEmulator::initializeWithDisplayConfig(bool basicEnabled, const QString
         return true;
     }
     
+    releaseCore();
     return false;
 }
 
@@ -447,6 +533,7 @@ bool AtariEmulator::initializeWithInputConfig(bool basicEnabled, const QString&
     m_kbdJoy0Enabled = kbdJoy0Enabled;
     m_kbdJoy1Enabled = kbdJoy1Enabled;
     m_swapJoysticks = swapJoysticks;
+    resolveJoystickPorts();
     
     // Build argument list with machine type, video system, artifacts, audio, BASIC setting, and input settings
     QStringList argList;
@@ -588,16 +675,16 @@ bool AtariEmulator::initializeWithInputConfig(bool basicEnabled, const QString&
                 // NOTE: Do NOT use quotePath() - we're using char* array, not shell string
                 if (machineType == "-5200") {
                     argList << "-5200-rev" << "AUTO";
-                    argList << "-5200_rom" << m_osRomPath;
+                    argList << "-5200_rom" << m_romImageCache.resolve(m_osRomPath);
                     qDebug() << "  -> Added arguments: -5200-rev AUTO -5200_rom" << m_osRomPath;
                 } else if (machineType == "-atari") {
                     argList << "-800-rev" << "AUTO";
-                    argList << "-osb_rom" << m_osRomPath;  // 800 OS-B ROM
+                    argList << "-osb_rom" << m_romImageCache.resolve(m_osRomPath);  // 800 OS-B ROM
                     qDebug() << "  -> Added arguments: -800-rev AUTO -osb_rom" << m_osRomPath;
                 } else {
                     // For XL/XE machines
                     argList << "-xl-rev" << "AUTO";
-                    argList << "-xlxe_rom" << m_osRomPath;
+                    argList << "-xlxe_rom" << m_romImageCache.resolve(m_osRomPath);
                     qDebug() << "  -> Added arguments: -xl-rev AUTO -xlxe_rom" << m_osRomPath;
                 }
             } else {
@@ -644,7 +731,7 @@ bool AtariEmulator::initializeWithInputConfig(bool basicEnabled, const QString&
             // CRITICAL: Must set -basic-rev AUTO BEFORE the ROM file to reset any previously cached revision
             // NOTE: Do NOT quote - we're using char* array, not shell string
             argList << "-basic-rev" << "AUTO";
-            argList << "-basic_rom" << m_basicRomPath;
+            argList << "-basic_rom" << m_romImageCache.resolve(m_basicRomPath);
             qDebug() << "  -> Configured external BASIC ROM:" << m_basicRomPath;
         } else {
             qWarning() << "BASIC ROM file not found at" << m_basicRomPath;
@@ -743,6 +830,10 @@ bool AtariEmulator::initializeWithInputConfig(bool basicEnabled, const QString&
     qDebug() << "  Arguments:" << argString.trimmed();
     qDebug() << "  Total argument count:" << argList.size();
 
+    if (!claimCore()) {
+        return false;
+    }
+
     // Force complete libatari800 reset to clear any persistent ROM state.
     // shutdown() already calls libatari800_exit() and clears m_libatari800Initialized,
     // so this guard only fires when initializeWithInputConfig() is called without a
@@ -758,9 +849,31 @@ bool AtariEmulator::initializeWithInputConfig(bool basicEnabled, const QString&
     }
 
     qDebug() << "  Calling libatari800_init()...";
-    if (libatari800_init(argBytes.size(), args.data())) {
+    // Includes the OS/BASIC ROM loads; only recorded while a startup trace is open
+    const qint64 initStartUs = StartupTrace::nowUs();
+    const bool initialized = libatari800_init(argBytes.size(), args.data());
+    StartupTrace::addComplete("libatari800_init", initStartUs, StartupTrace::nowUs() - initStartUs);
+    if (initialized) {
         qDebug() << "  libatari800_init() returned SUCCESS";
         m_libatari800Initialized = true;
+        m_bootConfig = QJsonObject();
+        m_bootConfig["machine_type"] = machineType;
+        m_bootConfig["video_system"] = videoSystem;
+        m_bootConfig["basic_enabled"] = basicEnabled;
+        m_bootConfig["altirra_os"] = m_altirraOSEnabled;
+        m_bootConfig["altirra_basic"] = m_altirraBASICEnabled;
+        m_bootConfig["os_rom_path"] = m_osRomPath;
+        m_bootConfig["basic_rom_path"] = m_basicRomPath;
+        m_bootConfig["horizontal_area"] = horizontalArea;
+        m_bootConfig["vertical_area"] = verticalArea;
+        m_bootConfig["horizontal_shift"] = horizontalShift;
+        m_bootConfig["vertical_shift"] = verticalShift;
+        m_bootConfig["fit_screen"] = fitScreen;
+        m_bootConfig["show_80_column"] = show80Column;
+        m_bootConfig["vsync"] = vSyncEnabled;
+        m_bootConfig["netsio"] = netSIOEnabled;
+        m_bootConfig["rtime"] = false;
+        m_paletteLutDirty.store(true);  // PAL/NTSC palette may differ after reinit
 
         // H: device is CIO-based; re-enable its patch even when -netsio disabled it
         if (anyHDriveEnabled) {
@@ -790,12 +903,13 @@ bool AtariEmulator::initializeWithInputConfig(bool basicEnabled, const QString&
 #endif
         
         m_targetFps = libatari800_get_fps();
-        m_frameTimeMs = 1000.0f / m_targetFps;
+        m_frameTimeMs = static_cast<float>(1000.0 / pacedFps());
 
         // Apply cartridge auto-reboot setting from QSettings
         QSettings settings("8bitrelics", "Fujisan");
         CARTRIDGE_autoreboot = settings.value("machine/cartridgeAutoReboot", true).toBool() ? 1 : 0;
         qDebug() << "CARTRIDGE_autoreboot initialized to:" << CARTRIDGE_autoreboot;
+        setTapeAccelerationEnabled(settings.value("machine/tapeAcceleration", true).toBool());
 
         // Set up the disk activity callback for hardware-level monitoring
         libatari800_set_disk_activity_callback(diskActivityCallback);
@@ -814,6 +928,7 @@ bool AtariEmulator::initializeWithInputConfig(bool basicEnabled, const QString&
         */
         
         // Initialize audio output if enabled
+        applyAudioSyncSetting();
         if (m_audioEnabled) {
             setupAudio();
         }
@@ -844,6 +959,7 @@ bool AtariEmulator::initializeWithInputConfig(bool basicEnabled, const QString&
 
     qDebug() << "  libatari800_init() returned FAILURE";
     qDebug() << "=== INITIALIZATION FAILED ===";
+    releaseCore();
     return false;
 }
 
@@ -892,7 +1008,10 @@ bool AtariEmulator::initializeWithNetSIOConfig(bool basicEnabled, const QString&
         extern void netsio_test_cmd(void);
         qDebug() << "[NETSIO] Sending test command for initial connection verification";
         qDebug() << "[NETSIO] netsio_enabled before test:" << netsio_enabled;
-        netsio_test_cmd();
+        {
+            StartupTrace::Scope trace("netsio_test_cmd");
+            netsio_test_cmd();
+        }
         qDebug() << "[NETSIO] netsio_enabled after test:" << netsio_enabled;
         if (!netsio_enabled) {
             // FujiNet-PC was not ready at boot time.  MainWindow::onFujiNetConnected()
@@ -915,6 +1034,7 @@ bool AtariEmulator::initializeWithNetSIOConfig(bool basicEnabled, const QString&
         extern int RTIME_enabled;
         RTIME_enabled = 1;
     }
+    m_bootConfig["rtime"] = rtimeEnabled;
     
     return true;
 }
@@ -926,8 +1046,58 @@ void AtariEmulator::netsioShutdownFromOtherThreadForQuit()
 #endif
 }
 
+QJsonObject AtariEmulator::netsioLinkStatus() const
+{
+    QJsonObject status;
+    status["enabled"] = m_netSIOEnabled;
+#ifdef NETSIO
+    status["connected"] = netsio_enabled != 0;
+    netsio_link_stats stats;
+    netsio_get_link_stats(&stats);
+    status["heard"] = stats.heard != 0;
+    status["down"] = stats.down != 0;
+    status["ms_since_rx"] = stats.ms_since_rx;  // -1 until the first packet
+    status["srtt_ms"] = stats.srtt_us / 1000.0;
+    status["rttvar_ms"] = stats.rttvar_us / 1000.0;
+    status["sync_timeout_ms"] = stats.sync_timeout_us / 1000.0;
+    status["sync_samples"] = static_cast<qint64>(stats.sync_samples);
+    status["sync_timeouts"] = static_cast<qint64>(stats.sync_timeouts);
+    status["recv_timeouts"] = static_cast<qint64>(stats.recv_timeouts);
+    status["fast_fails"] = static_cast<qint64>(stats.fast_fails);
+    status["max_stall_ms"] = stats.max_stall_us / 1000.0;
+    status["stalled_ms"] = static_cast<double>(stats.stall_us) / 1000.0;
+#else
+    status["connected"] = false;
+#endif
+    return status;
+}
+
+QStringList AtariEmulator::pendingRestartChanges() const
+{
+    QStringList changed;
+    if (!m_libatari800Initialized || m_bootConfig.isEmpty()) {
+        changed << "not_initialized";
+        return changed;
+    }
+    auto check = [&](const char* key, const QJsonValue& current) {
+        if (m_bootConfig.value(key) != current) {
+            changed << key;
+        }
+    };
+    check("machine_type", m_machineType);
+    check("video_system", m_videoSystem);
+    check("basic_enabled", m_basicEnabled);
+    check("altirra_os", m_altirraOSEnabled);
+    check("altirra_basic", m_altirraBASICEnabled);
+    check("os_rom_path", m_osRomPath);
+    check("basic_rom_path", m_basicRomPath);
+    return changed;
+}
+
 void AtariEmulator::shutdown()
 {
+    endMovieRecording();
+    m_frameChecksums.stop();
     m_shuttingDown.store(false);  // reset so restart works
     // Only stop the frame timer if we're on the thread that owns it.
     // When called after stopEmulatorWorkerIfRunning (worker already quit),
@@ -942,6 +1112,21 @@ void AtariEmulator::shutdown()
     }
 #endif
 
+    // Snapshots belong to the machine being torn down
+    if (m_rewindBuffer) {
+        m_rewindBuffer->clear();
+    }
+    m_emulatedFrames = 0;
+    m_rewindFramesUntilSnapshot = 0;
+    if (s_coreOwner.load() != this) {
+        // Another instance's machine is in the core; nothing of it is ours to stop
+        return;
+    }
+    if (m_runToAddress >= 0) {
+        cancelRunTo();
+    }
+    libatari800_clear_breakpoint_halt(0);
+
     if (!m_libatari800Initialized) {
         return;
     }
@@ -959,6 +1144,31 @@ void AtariEmulator::shutdown()
 #endif
 
     libatari800_exit();
+    releaseCore();
+}
+
+bool AtariEmulator::claimCore()
+{
+    AtariEmulator* expected = nullptr;
+    if (!s_coreOwner.compare_exchange_strong(expected, this) && expected != this) {
+        qWarning() << "libatari800 is already running another machine in this process;"
+                   << "a second machine needs its own process (e.g. --headless-farm)";
+        return false;
+    }
+    // Core callbacks (disk activity, NetSIO) follow the instance that owns the core
+    s_emulatorInstance = this;
+    return true;
+}
+
+void AtariEmulator::releaseCore()
+{
+    AtariEmulator* expected = this;
+    s_coreOwner.compare_exchange_strong(expected, nullptr);
+}
+
+AtariEmulator* AtariEmulator::coreOwner()
+{
+    return s_coreOwner.load();
 }
 
 void AtariEmulator::startDeferredTimers()
@@ -991,6 +1201,9 @@ void AtariEmulator::finalizeShutdownOnWorkerAndRehomeToGui()
     // blocking briefly inside netsio/atari800 cleanup. teardownAudio() only touches our own
     // Qt/SDL audio members, so it is safe to call before shutdown().
     teardownAudio();
+    if (m_hibernateOnQuit && m_libatari800Initialized) {
+        hibernate(getHibernatePath());
+    }
     shutdown();
     // Drop QTimer::singleShot / queued slot calls targeting this object on the worker.
     QCoreApplication::removePostedEvents(this, QEvent::MetaCall);
@@ -1045,6 +1258,34 @@ void AtariEmulator::processFrame()
     if (!m_libatari800Initialized || m_shuttingDown.load()) {
         return;
     }
+    // Only a frame the timer was started for has a deadline; a deferred or
+    // stepped one does not
+    const bool timerPaced = m_frameDeadlineValid;
+    m_frameDeadlineValid = false;
+    if (m_frameHoldDepth > 0) {
+        m_frameDeferredByHold = true;
+        return;
+    }
+    if (timerPaced) {
+        if (m_preciseTiming) {
+            ThreadScheduling::waitUntil(m_frameDeadline);
+        }
+        recordFramePacing();
+    } else {
+        m_lastPacedFrameValid = false;
+    }
+    const bool measuring = m_performance.isEnabled();
+    if (measuring) {
+        const qint64 nowUs = LatencyHistogram::nowMicroseconds();
+        if (m_performanceFrameStartUs) {
+            m_performance.record(PerformanceMonitor::FrameInterval,
+                                 static_cast<qint32>(qMin<qint64>(nowUs - m_performanceFrameStartUs, INT_MAX)));
+        }
+        m_performanceFrameStartUs = nowUs;
+        m_performance.setNominalFrameUs(static_cast<qint32>(1000000.0f / (m_targetFps > 0 ? m_targetFps : 50.0f)));
+    } else {
+        m_performanceFrameStartUs = 0;
+    }
 
     // Advance frame counter; next interval will be computed in requestNextFrame()
     // at the end of this function (absolute-time scheduling, no per-frame work needed here).
@@ -1055,71 +1296,56 @@ void AtariEmulator::processFrame()
     // Process device-specific joystick input and update m_currentInput under the
     // input mutex so the snapshot taken below is always consistent.
 #ifdef HAVE_SDL2_JOYSTICK
-    if (m_joystickInputEnabled.load() && m_joystickManager) {
-        QMutexLocker inputLock(&m_inputMutex);
-        // Process Joystick 1 based on assigned device
-        if (m_joystick1AssignedDevice.startsWith("sdl_")) {
-            // Extract SDL joystick index from device string (e.g., "sdl_0" -> 0)
-            bool ok;
-            int sdlIndex = m_joystick1AssignedDevice.mid(4).toInt(&ok);
-            if (ok) {
-                JoystickState joyState = m_joystickManager->getJoystickState(sdlIndex);
-                if (joyState.connected) {
-                    int targetJoy = m_swapJoysticks ? 1 : 0;  // Apply swapping
-                    if (targetJoy == 0) {
-                        m_currentInput.joy0 = joyState.stick;
-                        m_currentInput.trig0 = joyState.trigger ? 1 : 0;
-                    } else {
-                        m_currentInput.joy1 = joyState.stick;
-                        m_currentInput.trig1 = joyState.trigger ? 1 : 0;
-                    }
-                }
-            }
-        }
-        // Note: "keyboard" and "none" devices are handled by keyboard emulation/no input
-
-        // Process Joystick 2 based on assigned device
-        if (m_joystick2AssignedDevice.startsWith("sdl_")) {
-            // Extract SDL joystick index from device string (e.g., "sdl_1" -> 1)
-            bool ok;
-            int sdlIndex = m_joystick2AssignedDevice.mid(4).toInt(&ok);
-            if (ok) {
-                JoystickState joyState = m_joystickManager->getJoystickState(sdlIndex);
-                if (joyState.connected) {
-                    int targetJoy = m_swapJoysticks ? 0 : 1;  // Apply swapping
-                    if (targetJoy == 0) {
-                        m_currentInput.joy0 = joyState.stick;
-                        m_currentInput.trig0 = joyState.trigger ? 1 : 0;
-                    } else {
-                        m_currentInput.joy1 = joyState.stick;
-                        m_currentInput.trig1 = joyState.trigger ? 1 : 0;
-                    }
-                }
-            }
+    // Ports were resolved when the assignment changed (resolveJoystickPorts());
+    // polling here applies the SDL events up to this frame, and the states are
+    // read as one atomic word per joystick, without a lock or a device lookup.
+    quint32 sdlJoystick[2] = {0, 0};
+    const int sdlPort0 = m_port0SdlJoystick.load(std::memory_order_relaxed);
+    const int sdlPort1 = m_port1SdlJoystick.load(std::memory_order_relaxed);
+    if (m_joystickInputEnabled.load() && m_joystickManager && m_realJoysticksEnabled &&
+        (sdlPort0 >= 0 || sdlPort1 >= 0)) {
+        m_joystickManager->pollJoysticks();
+        sdlJoystick[0] = m_joystickManager->packedState(sdlPort0);
+        sdlJoystick[1] = m_joystickManager->packedState(sdlPort1);
+        // m_currentInput backs the TCP joystick queries; only a change needs the lock
+        if (sdlJoystick[0] != m_portAppliedJoystick[0] || sdlJoystick[1] != m_portAppliedJoystick[1]) {
+            m_inputLatency.markInput(InputLatencyMonitor::SdlJoystick);
+            QMutexLocker inputLock(&m_inputMutex);
+            applySdlJoystickState(m_currentInput, sdlJoystick);
+            m_portAppliedJoystick[0] = sdlJoystick[0];
+            m_portAppliedJoystick[1] = sdlJoystick[1];
         }
-        // Note: "keyboard" and "none" devices are handled by keyboard emulation/no input
     }
 #endif
 
     // Take a thread-safe snapshot of the current input state.  The snapshot
     // is copied here under the input mutex so that handleKeyPress/handleKeyRelease
     // running on the main thread cannot corrupt the struct while libatari800
-    // is blocked inside netsio_recv_byte() (up to NETSIO_RECV_BYTE_TIMEOUT_SEC).
+    // is blocked inside netsio_recv_byte() (up to NETSIO_RECV_BYTE_TIMEOUT_SEC,
+    // or not at all once the 0024 patch has marked the link down).
     //
     // Also snapshot inject counters here (same lock). injectCharacter() can run on
     // another thread after libatari800_next_frame() returns but before the block
     // below; using live m_injectKeyFramesRemaining then would decrement the *new*
     // injection on the same frame as a key-up, skipping a hold frame and letting
     // POKEY see repeated keys without an AKEY_NONE between them.
+    if (!runDueScheduledActions()) {
+        return;  // paused by a scheduled action before this frame
+    }
+
     input_template_t inputSnapshot;
     int injectHoldAtStart = 0;
     int injectPostAtStart = 0;
+    m_inputLatency.beginFrame();  // inputs marked from here on count for the next frame
     {
         QMutexLocker inputLock(&m_inputMutex);
         inputSnapshot = m_currentInput;
         injectHoldAtStart = m_injectKeyFramesRemaining;
         injectPostAtStart = m_injectPostReleaseFrames;
     }
+#ifdef HAVE_SDL2_JOYSTICK
+    applySdlJoystickState(inputSnapshot, sdlJoystick);  // a connected stick wins over other sources
+#endif
 
     // libatari800_next_frame() may rewrite inputSnapshot; post-release accounting must use
     // whether our template was keyboard-idle *before* the frame, or we never decrement
@@ -1127,39 +1353,57 @@ void AtariEmulator::processFrame()
     const bool templateKeyboardIdleBeforeFrame = inputSnapshot.keychar == 0 &&
                                                  inputSnapshot.keycode == 0 &&
                                                  inputSnapshot.special == 0;
+    reportInputChanges(inputSnapshot);
+    const input_template_t frameInput = inputSnapshot;  // next_frame may rewrite it; run-ahead replays it
+
+    // Full-frame execution; no lock held here — this call can block for up to
+    // NETSIO_RECV_BYTE_TIMEOUT_SEC (3 s) when FujiNet is slow. Armed breakpoints
+    // are checked by the CPU core itself before every instruction.
+    const qint64 coreStartUs = measuring ? LatencyHistogram::nowMicroseconds() : 0;
+    libatari800_next_frame(&inputSnapshot);
+    if (measuring) {
+        m_performance.record(PerformanceMonitor::EmulatedFrame,
+                             static_cast<qint32>(qMin<qint64>(LatencyHistogram::nowMicroseconds() - coreStartUs, INT_MAX)));
+        recordSioWait();
+    }
+    advanceFrameCounter();
+    recordMovieFrame(frameInput);
+    captureRewindSnapshotIfDue();
+    recordFrameChecksum();
+    collectInstructionTrace();
+    m_inputLatency.endFrame(m_emulatedFrames);
+    checkBreakpoints();
 
-    // Determine if we should use partial frame execution for precise breakpoints
-    m_usePartialFrameExecution = m_breakpointsEnabled && !m_breakpoints.isEmpty() && !m_emulationPaused;
-    
-    // For now, disable partial frame execution since it requires patches
-    // We'll use frame-level execution with breakpoint checking after each frame
-    // This is less precise but works with standard libatari800
-    if (false && m_usePartialFrameExecution) {
-        // Partial frame execution disabled - requires patches
-    } else {
-        // Normal full-frame execution; no lock held here — this call can block
-        // for up to NETSIO_RECV_BYTE_TIMEOUT_SEC (3 s) when FujiNet is slow.
-        libatari800_next_frame(&inputSnapshot);
-
-        // Check breakpoints once after the frame (legacy behavior)
-        if (m_breakpointsEnabled && !m_breakpoints.isEmpty()) {
-            checkBreakpoints();
-        }
-    }
-
+    bool keyQueueDrained = false;
+    bool keyQueueTurboDone = false;
     {
         QMutexLocker inputLock(&m_inputMutex);
         if (injectHoldAtStart > 0) {
             m_injectKeyFramesRemaining--;
+            // A queued key can let go as soon as the OS has it in CH: it only
+            // goes in while CH is free, so anything there now is this key
+            if (m_injectFromQueue && m_injectKeyFramesRemaining > 0 && MEMORY_mem[0x2FC] != 0xFF) {
+                m_injectKeyFramesRemaining = 0;
+            }
             if (m_injectKeyFramesRemaining == 0) {
                 clearCurrentInputLocked();
                 m_injectPostReleaseFrames = kInjectPostReleaseFrameCount;
+                if (m_injectFromQueue && m_keyQueueHead < m_keyQueue.size() &&
+                    m_keyQueue[m_keyQueueHead].akey != m_lastQueuedKey) {
+                    m_injectPostReleaseFrames = kQueuedKeyReleaseFrameCount;
+                }
             }
         } else if (injectPostAtStart > 0 && templateKeyboardIdleBeforeFrame) {
             if (m_injectPostReleaseFrames > 0) {
                 m_injectPostReleaseFrames--;
             }
         }
+        keyQueueDrained = advanceKeyQueueLocked();
+        // Taken under the lock, so only one of this and cancelQueuedText() ends the boost
+        keyQueueTurboDone = keyQueueDrained && m_keyQueueTurbo;
+        if (keyQueueTurboDone) {
+            m_keyQueueTurbo = false;
+        }
 
         // Tick the direct-key minimum-hold counter.  This runs independently of the
         // inject path so that normal typing is never blocked by paste operations.
@@ -1181,14 +1425,32 @@ void AtariEmulator::processFrame()
         }
     }
 
+    if (keyQueueTurboDone) {
+        endSpeedBoost();
+    }
+    if (keyQueueDrained) {
+        emit textQueueDrained();
+    }
+    updateTapeAcceleration();
+
     // Disk I/O monitoring is now handled by libatari800 callback
 
+    // This frame's audio, fitted to real time when running faster (see AudioDecimator)
+    const unsigned char* frameAudio = libatari800_get_sound_buffer();
+    int frameAudioLen = libatari800_get_sound_buffer_len();
+    const unsigned char* const rawAudio = frameAudio;  // recordings keep every sample
+    const int rawAudioLen = frameAudioLen;
+    adaptAudioToSpeed(frameAudio, frameAudioLen);
+    if (m_tapeAccelerator.isActive()) {
+        frameAudioLen = 0;  // a tape load is not heard, only recorded
+    }
+
 #ifdef HAVE_SDL2_AUDIO
     // Handle audio output based on backend type
     if (m_audioBackend == UnifiedAudio && m_unifiedAudio && m_audioEnabled) {
         // Unified Audio Backend - submit audio with priority classification
-        unsigned char* soundBuffer = libatari800_get_sound_buffer();
-        int soundBufferLen = libatari800_get_sound_buffer_len();
+        const unsigned char* soundBuffer = frameAudio;
+        int soundBufferLen = frameAudioLen;
 
         if (soundBuffer && soundBufferLen > 0) {
             // For now, treat all audio as low priority (background music/game sounds)
@@ -1218,28 +1480,17 @@ void AtariEmulator::processFrame()
 #ifdef HAVE_SDL2_AUDIO
     // Legacy SDL2 audio backend
     if (m_audioBackend == SDL2Audio && m_sdl2Audio && m_sdl2Audio->isInitialized()) {
-        unsigned char* soundBuffer = libatari800_get_sound_buffer();
-        int soundBufferLen = libatari800_get_sound_buffer_len();
+        const unsigned char* soundBuffer = frameAudio;
+        int soundBufferLen = frameAudioLen;
         
         if (soundBuffer && soundBufferLen > 0) {
-            QMutexLocker locker(&m_sdl2AudioMutex);
-            
-            // Calculate current buffer level
-            int currentLevel = (m_sdl2WritePos - m_sdl2ReadPos + SDL2_BUFFER_SIZE) % SDL2_BUFFER_SIZE;
-            int availableSpace = SDL2_BUFFER_SIZE - currentLevel - 1;
-            
             // Simple buffer management - SDL2 buffer now matches frame size
             // At 22050Hz: we produce 735 bytes, SDL2 consumes 736 bytes
             // At 44100Hz: we produce 1470 bytes, SDL2 consumes 1472 bytes
             // This should maintain balance without skipping
             
-            if (availableSpace >= soundBufferLen) {
-                // Write the audio data
-                for (int i = 0; i < soundBufferLen; i++) {
-                    m_sdl2AudioBuffer[m_sdl2WritePos] = soundBuffer[i];
-                    m_sdl2WritePos = (m_sdl2WritePos + 1) % SDL2_BUFFER_SIZE;
-                }
-            } else {
+            if (!m_sdl2Ring.write(soundBuffer, soundBufferLen)) {
+                m_audioOverruns++;
                 // Buffer full - this should be rare with matched sizes
                 static int skipCount = 0;
                 skipCount++;
@@ -1251,49 +1502,13 @@ void AtariEmulator::processFrame()
 #endif
     // Handle Qt audio output with double buffering (inspired by Atari800MacX)
     if (m_audioEnabled && m_audioOutput && m_audioDevice) {
-        // Audio diagnostics (enabled only when m_enableAudioDiagnostics is true)
-        static bool s_audioDiagnosticsInitialized = false;
-        static std::chrono::steady_clock::time_point s_lastFrameTime;
-        static QFile s_audioDiagFile;
-
-        if (m_enableAudioDiagnostics && !s_audioDiagnosticsInitialized) {
-            s_audioDiagnosticsInitialized = true;
-
-            // Open CSV log file in the user's writable location
-            QString logDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-            QDir().mkpath(logDir);
-            QString logPath = logDir + QDir::separator() + "audio_diagnostics.csv";
-
-            s_audioDiagFile.setFileName(logPath);
-            if (s_audioDiagFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
-                QTextStream ts(&s_audioDiagFile);
-                ts << "ms_since_start,frame_interval_ms,sound_buffer_len,dsp_gap_bytes,bytes_free,audio_state\n";
-                ts.flush();
-            } else {
-                qWarning() << "Failed to open audio diagnostics log file at" << logPath;
-            }
-
-            s_lastFrameTime = std::chrono::steady_clock::now();
-        } else if (!m_enableAudioDiagnostics && s_audioDiagnosticsInitialized) {
-            // Diagnostics disabled at runtime
-            s_audioDiagnosticsInitialized = false;
-            if (s_audioDiagFile.isOpen()) {
-                s_audioDiagFile.close();
-            }
-        }
-
-        unsigned char* soundBuffer = libatari800_get_sound_buffer();
-        int soundBufferLen = libatari800_get_sound_buffer_len();
+        const unsigned char* soundBuffer = frameAudio;
+        int soundBufferLen = frameAudioLen;
         
         // DSP buffer must exist before touching the ring (never abort the whole frame)
-        if (m_dspBufferBytes > 0 && !m_dspBuffer.isEmpty() && soundBuffer && soundBufferLen > 0) {
+        if (m_dspRing.capacity() > 0 && soundBuffer && soundBufferLen > 0) {
             // Write to DSP buffer (producer side)
-            int gap = m_dspWritePos - m_dspReadPos;
-            
-            // Handle wrap-around
-            if (gap < 0) {
-                gap += m_dspBufferBytes;
-            }
+            int gap = m_dspRing.available();
             
             // PI audio-clock feedback: gently adjusts m_frameTimeMs to keep the
             // DSP ring buffer at its target fill level.  Corrections are ±0.5% max,
@@ -1332,11 +1547,10 @@ void AtariEmulator::processFrame()
             /*
             static int debugCount = 0;
             if (++debugCount % 100 == 1) {
-                int available = m_dspWritePos - m_dspReadPos;
-                if (available < 0) available += m_dspBufferBytes;
+                int available = m_dspRing.available();
                 int bytesFree = m_audioOutput ? m_audioOutput->bytesFree() : -1;
                             .arg(debugCount).arg(frameCount);
-                            .arg(m_dspWritePos).arg(m_dspReadPos).arg(available);
+                            .arg(available);
                             .arg(soundBufferLen).arg(bytesFree).arg(gap).arg(targetGap);
             }
             */
@@ -1354,65 +1568,22 @@ void AtariEmulator::processFrame()
             // Always write audio data - use ring buffer overwrite if needed
 #endif
             {
-                // Write sound data into the ring buffer.
-                // On wrap we assemble through the staging buffer first so the
-                // ring buffer is updated in a single contiguous operation.
-                int writeOffset = m_dspWritePos % m_dspBufferBytes;
-                int newPos = m_dspWritePos + soundBufferLen;
-                if (writeOffset + soundBufferLen <= m_dspBufferBytes) {
-                    // No wrap — direct copy
-                    memcpy(m_dspBuffer.data() + writeOffset, soundBuffer, soundBufferLen);
-                } else {
-                    // Wrap: assemble contiguous copy through staging buffer then split into ring
-                    int firstPartSize = m_dspBufferBytes - writeOffset;
-                    memcpy(m_dspStagingBuffer.data(), soundBuffer, soundBufferLen);
-                    memcpy(m_dspBuffer.data() + writeOffset,
-                           m_dspStagingBuffer.data(), firstPartSize);
-                    memcpy(m_dspBuffer.data(),
-                           m_dspStagingBuffer.data() + firstPartSize,
-                           soundBufferLen - firstPartSize);
+                // Write sound data into the ring buffer. When it is full the
+                // oldest samples make room, as the old overwriting ring did;
+                // both sides run on this thread, so the consumer cannot race it.
+                const int overflow = soundBufferLen - m_dspRing.freeSpace();
+                if (overflow > 0) {
+                    m_dspRing.consume(overflow);
+                    m_audioOverruns++;
                 }
-                m_dspWritePos = newPos % (m_dspBufferBytes * 2);
-            }
-            
-            // Keep positions normalized
-            while (m_dspWritePos >= m_dspBufferBytes && m_dspReadPos >= m_dspBufferBytes) {
-                m_dspWritePos -= m_dspBufferBytes;
-                m_dspReadPos -= m_dspBufferBytes;
+                m_dspRing.write(soundBuffer, qMin(soundBufferLen, m_dspRing.capacity()));
             }
             
             // Write from DSP buffer to audio device (consumer side)
-            int available = m_dspWritePos - m_dspReadPos;
-            if (available < 0) {
-                available += m_dspBufferBytes;
-            }
+            int available = m_dspRing.available();
             
             int bytesFree = m_audioOutput->bytesFree();
 
-            // Audio diagnostics logging
-            if (m_enableAudioDiagnostics && s_audioDiagFile.isOpen()) {
-                using namespace std::chrono;
-                static steady_clock::time_point s_startTime = steady_clock::now();
-                steady_clock::time_point now = steady_clock::now();
-
-                double msSinceStart =
-                    duration_cast<duration<double, std::milli>>(now - s_startTime).count();
-                double frameIntervalMs =
-                    duration_cast<duration<double, std::milli>>(now - s_lastFrameTime).count();
-                s_lastFrameTime = now;
-
-                int audioState = m_audioOutput->state();
-
-                QTextStream ts(&s_audioDiagFile);
-                ts << QString::number(msSinceStart, 'f', 3) << ","
-                   << QString::number(frameIntervalMs, 'f', 3) << ","
-                   << soundBufferLen << ","
-                   << gap << ","
-                   << bytesFree << ","
-                   << audioState << "\n";
-                ts.flush();
-            }
-
             // Platform-specific writing strategy
 #ifdef _WIN32
             // Windows: Write in period-size chunks to match Qt's preferred rhythm
@@ -1434,36 +1605,30 @@ void AtariEmulator::processFrame()
                 // Always issue a single write() call so there is no window in which
                 // the Qt audio pull thread could observe a partial update.
                 // On wrap, assemble through the staging buffer first.
-                int readOffset  = m_dspReadPos % m_dspBufferBytes;
-                int newReadPos  = m_dspReadPos + toWrite;
+                const AudioRing::Spans spans = m_dspRing.readSpans(toWrite);
                 const char* writePtr;
-                if (readOffset + toWrite <= m_dspBufferBytes) {
+                if (spans.secondBytes == 0) {
                     // No wrap — write directly from ring buffer
-                    writePtr = m_dspBuffer.data() + readOffset;
+                    writePtr = reinterpret_cast<const char*>(spans.first);
                 } else {
                     // Wrap — assemble contiguous chunk in staging buffer (may exceed one
                     // emulator frame; size is bounded by Qt bytesFree(), e.g. 8192 bytes).
                     if (toWrite > m_dspStagingBuffer.size()) {
                         m_dspStagingBuffer.resize(toWrite);
                     }
-                    int firstPartSize = m_dspBufferBytes - readOffset;
-                    memcpy(m_dspStagingBuffer.data(),
-                           m_dspBuffer.data() + readOffset, firstPartSize);
-                    memcpy(m_dspStagingBuffer.data() + firstPartSize,
-                           m_dspBuffer.data(), toWrite - firstPartSize);
-                    writePtr = m_dspStagingBuffer.data();
+                    m_dspRing.peek(m_dspStagingBuffer.data(), toWrite);
+                    writePtr = m_dspStagingBuffer.constData();
                 }
-                m_audioDevice->write(writePtr, toWrite);
-                m_dspReadPos = newReadPos % (m_dspBufferBytes * 2);
+                const qint64 written = m_audioDevice->write(writePtr, toWrite);
+                m_dspRing.consume(static_cast<int>(qMax<qint64>(0, written)));
             }
             
             // Log double buffer stats periodically (commented out for production)
             // static int frameCount = 0;
             // if (++frameCount % 100 == 0) {
-            //     int gap = m_dspWritePos - m_dspReadPos;
-            //     if (gap < 0) gap += m_dspBufferBytes;
+            //     int gap = m_dspRing.available();
             //     
-            //     int percentFull = (m_dspBufferBytes > 0) ? (gap * 100 / m_dspBufferBytes) : 0;
+            //     int percentFull = (m_dspRing.capacity() > 0) ? (gap * 100 / m_dspRing.capacity()) : 0;
             //     qDebug() << "DSP Buffer - Gap:" << gap << "bytes"
             //              << "(" << percentFull << "%)"
             //              << "| Available:" << available
@@ -1474,13 +1639,32 @@ void AtariEmulator::processFrame()
             // }
         }
     }
+
+    recordAudioTelemetry(frameAudioLen);
+    if (m_mediaRecorder.isRecording()) {
+        m_mediaRecorder.submitFrame(m_emulatedFrames, libatari800_get_screen_ptr(), rawAudio, rawAudioLen);
+    }
+    if (m_streamAudio.load(std::memory_order_relaxed) && rawAudioLen > 0 &&
+        !m_streamAudioRing.write(rawAudio, rawAudioLen)) {
+        m_streamAudioOverrunBytes.fetch_add(static_cast<quint64>(rawAudioLen), std::memory_order_relaxed);
+    }
     
     // Don't clear input here - let it persist until key release
 
-    // Check breakpoints after frame execution
-    checkBreakpoints();
+    // Audio, recording and breakpoints above saw the real frame; the screen shown
+    // below may come from a few frames ahead
+    runAhead(frameInput);
 
-    emit frameReady(renderFrameImage());
+    // Faster than real time, frames nobody can see are skipped before conversion
+    if (presentationDue()) {
+        presentFrame();
+    } else {
+        m_presentationPending = true;
+        m_skippedPresentations.fetch_add(1, std::memory_order_relaxed);
+    }
+    publishScreenStreamFrame(false);
+    publishSharedState();
+    reportScreenText();
 
     // Schedule the next frame if emulation is running
     if (!m_emulationPaused) {
@@ -1488,144 +1672,740 @@ void AtariEmulator::processFrame()
     }
 }
 
-QImage AtariEmulator::renderFrameImage()
+void AtariEmulator::presentFrame(bool force)
 {
-    // Screen dimensions match libatari800's Screen_WIDTH / Screen_HEIGHT (384 x 240).
-    static const int W = 384;
-    static const int H = 240;
-
-    if (m_frameImage.isNull()) {
-        m_frameImage = QImage(W, H, QImage::Format_RGB32);
-    }
+    static constexpr int W = 384;
+    static constexpr int H = 240;
 
+    m_presentationPending = false;
     const unsigned char* screen = libatari800_get_screen_ptr();
-    if (!screen) {
-        return m_frameImage;
+    const bool indexed = m_indexedFrameOutput.load(std::memory_order_relaxed);
+
+    // Compare the palette indices with the last presented frame, row by row. An
+    // unchanged frame is not rendered or published at all; otherwise the changed
+    // band travels with the frame so the widget repaints only that. A palette or
+    // output-mode change counts as a change of every row.
+    QRect dirty;  // null: the whole frame
+    if (screen) {
+        const bool comparable = !force && m_presentedScreen.size() == W * H
+                                && indexed == m_presentedIndexed && !m_paletteLutDirty.load()
+                                && m_paletteGeneration == m_presentedPaletteGeneration;
+        if (comparable) {
+            unsigned char* previous = reinterpret_cast<unsigned char*>(m_presentedScreen.data());
+            int first = -1;
+            int last = -1;
+            for (int y = 0; y < H; y++) {
+                const unsigned char* row = screen + y * W;
+                if (std::memcmp(previous + y * W, row, W) != 0) {
+                    std::memcpy(previous + y * W, row, W);
+                    if (first < 0) {
+                        first = y;
+                    }
+                    last = y;
+                }
+            }
+            if (first < 0) {
+                m_unchangedFrames.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            dirty = QRect(0, first, W, last - first + 1);
+        } else {
+            m_presentedScreen = QByteArray(reinterpret_cast<const char*>(screen), W * H);
+            m_presentedIndexed = indexed;
+        }
     }
 
-    for (int y = 0; y < H; y++) {
-        QRgb* scanLine = reinterpret_cast<QRgb*>(m_frameImage.scanLine(y));
-        for (int x = 0; x < W; x++) {
-            unsigned char colorIndex = screen[y * W + x];
-            int rgb = Colours_table[colorIndex];
-            scanLine[x] = qRgb((rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF);
+    // The back buffer holds a frame from two publishes ago, so it is always rendered
+    // in full; only the repaint is limited to the dirty band.
+    const qint64 renderStartUs = m_performance.isEnabled() ? LatencyHistogram::nowMicroseconds() : 0;
+    if (indexed) {
+        renderIndexedFrame(m_indexedFrameExchange.backBuffer());
+        m_presentedPaletteGeneration = m_paletteGeneration;
+        if (m_indexedFrameExchange.publish(m_emulatedFrames, dirty)) {
+            emit frameReady();
+        }
+    } else {
+        renderFrameImage(m_frameExchange.backBuffer());
+        m_presentedPaletteGeneration = m_paletteGeneration;
+        if (m_frameExchange.publish(m_emulatedFrames, dirty)) {
+            emit frameReady();
         }
     }
-
-    // Return by value. Qt's copy-on-write ensures the data is detached when
-    // this function is called again for the next frame while the previous
-    // image is still referenced by the queued signal on the main thread.
-    return m_frameImage;
+    if (renderStartUs) {
+        m_performance.record(PerformanceMonitor::Render,
+                             static_cast<qint32>(LatencyHistogram::nowMicroseconds() - renderStartUs));
+    }
 }
 
-void AtariEmulator::requestNextFrame()
+bool AtariEmulator::presentationDue()
 {
-    if (m_shuttingDown.load()) {
-        return;
+    const auto now = std::chrono::steady_clock::now();
+    const bool turbo = m_userRequestedSpeedMultiplier == 0.0 || m_userRequestedSpeedMultiplier > 1.0;
+    // A frame that stops emulation (breakpoint, run-to) is always shown
+    if (m_tapeAccelerator.isActive() && !m_emulationPaused) {
+        return false;
     }
-    if (m_deferTimerStart) {
-        // Timer start is deferred until startDeferredTimers() is called on the worker.
-        return;
+    if (turbo && !m_emulationPaused
+        && now - m_lastPresentTime < std::chrono::nanoseconds(m_presentIntervalNs.load(std::memory_order_relaxed))) {
+        return false;
     }
-    // Absolute-time scheduling: each frame fires at firstFrameTime + frameCount * frameTimeMs.
-    // Any Qt timer overshoot or undershoot is automatically corrected on the next frame
-    // because we always measure the delay relative to the fixed absolute origin.
-    using namespace std::chrono;
+    m_lastPresentTime = now;
+    return true;
+}
 
-    // Unlimited speed: fire as fast as possible, bypass all timing logic.
-    if (m_userRequestedSpeedMultiplier == 0.0) {
-        m_frameCount++;
-        m_frameTimer->start(0);
+void AtariEmulator::setPresentationRate(double hz)
+{
+    if (hz < 1.0) {
+        hz = 60.0;
+    }
+    m_presentIntervalNs.store(qint64(1e9 / hz), std::memory_order_relaxed);
+}
+
+double AtariEmulator::presentationRate() const
+{
+    return 1e9 / double(m_presentIntervalNs.load(std::memory_order_relaxed));
+}
+
+void AtariEmulator::renderFrameImage(QImage& target)
+{
+    // Screen dimensions match libatari800's Screen_WIDTH / Screen_HEIGHT (384 x 240).
+    static constexpr int W = 384;
+    static constexpr int H = 240;
+
+    const unsigned char* screen = libatari800_get_screen_ptr();
+    if (!screen || target.width() != W || target.height() != H) {
         return;
     }
 
-    m_frameCount++;
+    if (m_paletteLutDirty.exchange(false)) {
+        rebuildPaletteLut();
+    }
+    const quint32* lut = m_paletteLut;
 
-    auto nextFrameTime = m_firstFrameTime +
-        duration<double, std::milli>(m_frameCount * static_cast<double>(m_frameTimeMs));
+    // W is a multiple of 4: load four palette indices with one 32-bit read and
+    // resolve them through the LUT. A SIMD gather does not pay off for a 1 KB
+    // table, so this unrolled form is fast on both x86-64 and ARM.
+    static_assert(W % 4 == 0, "scanline width must be a multiple of 4");
+    for (int y = 0; y < H; y++) {
+        // target is owned exclusively by the emulator thread (FrameExchange back
+        // buffer), so scanLine() never detaches or allocates here.
+        quint32* dst = reinterpret_cast<quint32*>(target.scanLine(y));
+        const unsigned char* src = screen + y * W;
+        for (int x = 0; x < W; x += 4) {
+            const quint32 quad = qFromLittleEndian<quint32>(src + x);
+            dst[x]     = lut[quad & 0xFF];
+            dst[x + 1] = lut[(quad >> 8) & 0xFF];
+            dst[x + 2] = lut[(quad >> 16) & 0xFF];
+            dst[x + 3] = lut[quad >> 24];
+        }
+    }
+}
 
-    auto now = steady_clock::now();
-    auto delayUs = duration_cast<microseconds>(nextFrameTime - now).count();
+void AtariEmulator::renderIndexedFrame(QImage& target)
+{
+    static constexpr int W = 384;
+    static constexpr int H = 240;
 
-    // Debt cap (mirrors standalone atari800's Atari800_Sync self-healing):
-    // If we've fallen more than one full frame behind wall-clock time, discard
-    // the accumulated debt by resetting the time baseline.  Without this,
-    // netsio_wait_for_sync() blocking inside ANTIC_Frame() causes an ever-growing
-    // catch-up backlog where each intervalMs=0 frame that hits another SIO command
-    // adds more blocking, creating a feedback loop of progressive slowdown.
-    const auto frameTimeUs = static_cast<int64_t>(m_frameTimeMs * 1000.0);
-    if (delayUs < -frameTimeUs) {
-        m_firstFrameTime = now;
-        // Next line in this function is m_frameCount++, so use 0 here so the first
-        // deadline after reset is firstFrameTime + 1 * frameTime (not +2).
-        m_frameCount = 0;
-        delayUs = frameTimeUs;
+    const unsigned char* screen = libatari800_get_screen_ptr();
+    if (!screen || target.width() != W || target.height() != H) {
+        return;
     }
 
-    // Convert microseconds to milliseconds, clamping to [0, frameTimeMs] range
-    int intervalMs = 0;
-    if (delayUs > 0) {
-        // Round to nearest ms; clamp so we never schedule more than one full frame ahead
-        intervalMs = static_cast<int>((delayUs + 500) / 1000);
-        int maxInterval = static_cast<int>(m_frameTimeMs) + 1;
-        if (intervalMs > maxInterval) intervalMs = maxInterval;
+    if (m_paletteLutDirty.exchange(false)) {
+        rebuildPaletteLut();
     }
 
-    m_frameTimer->start(intervalMs);
+    // Shares m_paletteColorTable's data; the GPU view re-uploads only when it changes.
+    target.setColorTable(m_paletteColorTable);
+    for (int y = 0; y < H; y++) {
+        std::memcpy(target.scanLine(y), screen + y * W, W);
+    }
 }
 
-const unsigned char* AtariEmulator::getScreen()
+QImage AtariEmulator::renderIndexedScreen()
 {
-    return libatari800_get_screen_ptr();
+    QImage image(384, 240, QImage::Format_Indexed8);
+    image.fill(0u);
+    renderIndexedFrame(image);
+    return image;
 }
 
-bool AtariEmulator::loadFile(const QString& filename)
+bool AtariEmulator::saveCoreScreenshot(const QString& path, bool interlaced)
 {
-    // Determine file type by extension
-    QFileInfo fileInfo(filename);
-    QString extension = fileInfo.suffix().toLower();
-    
-    if (extension == "xex" || extension == "exe" || extension == "com") {
-        // Load XEX/EXE/COM files as executables using BINLOAD.
-        // BINLOAD_Loader() calls Atari800_Coldstart() internally, which sends a 0xFF
-        // cold-reset packet to FujiNet-PC via netsio_cold_reset(), causing it to
-        // exit(75) and restart.  Suppress the packet the same way coldBoot() does so
-        // that loading a XEX does not kill the FujiNet connection.
-#ifdef NETSIO
-        if (m_netSIOEnabled && netsio_enabled) {
-            int savedNetsioEnabled = netsio_enabled;
-            netsio_enabled = 0;
-            int result = BINLOAD_Loader(filename.toUtf8().constData());
-            netsio_enabled = savedNetsioEnabled;
-            return result != 0;
-        }
+#ifdef SCREENSHOTS
+    return m_libatari800Initialized &&
+           Screen_SaveScreenshot(QFile::encodeName(path).constData(), interlaced ? 1 : 0);
+#else
+    Q_UNUSED(path)
+    Q_UNUSED(interlaced)
+    qWarning() << "Screenshot support not compiled in (SCREENSHOTS not defined)";
+    return false;
 #endif
-        return BINLOAD_Loader(filename.toUtf8().constData()) != 0;
-    } else {
-        // Load other files (CAR, ROM, etc.) as cartridges
+}
 
-        qDebug() << "Loading cartridge file:" << filename;
-        qDebug() << "Current CARTRIDGE_autoreboot value:" << CARTRIDGE_autoreboot;
-        qDebug() << "Current Atari800_disable_basic value:" << Atari800_disable_basic;
+void AtariEmulator::publishScreenStreamFrame(bool force)
+{
+    const int interval = m_screenStreamInterval.load(std::memory_order_relaxed);
+    if (interval <= 0 || (!force && --m_screenStreamCountdown > 0)) {
+        return;
+    }
+    m_screenStreamCountdown = interval;
+    renderIndexedFrame(m_screenStreamExchange.backBuffer());
+    if (m_screenStreamExchange.publish(m_emulatedFrames)) {
+        emit screenStreamFrameReady();
+    }
+}
 
-        // CRITICAL: Disable BASIC to allow cartridge to boot
-        // When Atari800_disable_basic = TRUE, it simulates holding the Option key
-        // during boot, which disables BASIC and allows the cartridge to run
-        Atari800_disable_basic = TRUE;
-        qDebug() << "Set Atari800_disable_basic = TRUE to allow cartridge boot";
+int AtariEmulator::readStreamAudio(QByteArray& pcm)
+{
+    const int available = m_streamAudioRing.available();
+    if (available <= 0) {
+        return 0;
+    }
+    const int offset = pcm.size();
+    pcm.resize(offset + available);
+    return m_streamAudioRing.read(pcm.data() + offset, available);
+}
 
-        // First, explicitly remove any existing cartridge with reboot
-        // This ensures a clean slate before loading the new cartridge
-        CARTRIDGE_RemoveAutoReboot();
-        qDebug() << "Removed existing cartridge";
+QJsonObject AtariEmulator::streamAudioFormat() const
+{
+    QJsonObject format;
+    format["sample_rate"] = libatari800_get_sound_frequency();
+    format["channels"] = libatari800_get_num_sound_channels();
+    format["bits_per_sample"] = 8 * libatari800_get_sound_sample_size();
+    return format;
+}
 
-        // Now insert the new cartridge with auto-reboot
-        // This provides a complete system reset with the new cartridge
-        int result = CARTRIDGE_InsertAutoReboot(filename.toUtf8().constData());
+QJsonObject AtariEmulator::openSharedState(const QString& path, const QJsonArray& ranges)
+{
+    QVector<SharedStateRegion::Range> parsed;
+    for (const QJsonValue& value : ranges) {
+        const QJsonObject entry = value.toObject();
+        SharedStateRegion::Range range;
+        range.address = entry["address"].toInt(-1);
+        range.length = entry["length"].toInt(0);
+        parsed.append(range);
+    }
 
-        qDebug() << "CARTRIDGE_InsertAutoReboot returned:" << result;
+    QString error;
+    if (!m_sharedState.open(path, parsed, &error)) {
+        return QJsonObject{{"error", error}};
+    }
+    publishSharedState();  // readers never see an all-zero region
+    return m_sharedState.layout();
+}
 
-        if (result == 0) {
+void AtariEmulator::closeSharedState()
+{
+    m_sharedState.close();
+}
+
+QJsonObject AtariEmulator::sharedStateLayout() const
+{
+    return m_sharedState.layout();
+}
+
+QVector<AnticTextDecoder::Line> AtariEmulator::decodeScreenText(int displayList) const
+{
+    if (!m_libatari800Initialized) {
+        return QVector<AnticTextDecoder::Line>();
+    }
+    const quint16 address = displayList >= 0 ? static_cast<quint16>(displayList) : ANTIC_dlist;
+    return AnticTextDecoder::decode(MEMORY_mem, address, ANTIC_DMACTL);
+}
+
+QString AtariEmulator::trimmedRow(const QString& text)
+{
+    int end = text.size();
+    while (end > 0 && text.at(end - 1) == QLatin1Char(' ')) {
+        --end;
+    }
+    return text.left(end);
+}
+
+QJsonObject AtariEmulator::getScreenText(int displayList, bool detail)
+{
+    const QVector<AnticTextDecoder::Line> lines = decodeScreenText(displayList);
+    QStringList rows;
+    QJsonArray details;
+    for (const AnticTextDecoder::Line& line : lines) {
+        rows.append(trimmedRow(line.text));
+        if (detail) {
+            QJsonObject entry;
+            entry["mode"] = line.mode;
+            entry["scanline"] = line.scanline;
+            entry["address"] = line.address;
+            entry["codes"] = QString::fromLatin1(line.codes.toHex());
+            entry["text"] = line.text;
+            details.append(entry);
+        }
+    }
+
+    QJsonObject result;
+    result["rows"] = QJsonArray::fromStringList(rows);
+    result["text"] = rows.join('\n');
+    result["display_list"] = displayList >= 0 ? displayList : static_cast<int>(ANTIC_dlist);
+    // "off" when playfield DMA is disabled, "graphics" when no line is a text mode
+    result["mode"] = !(ANTIC_DMACTL & 0x03) ? QString("off") : (lines.isEmpty() ? QString("graphics") : QString("text"));
+    if (detail) {
+        result["lines"] = details;
+    }
+    result["frame"] = static_cast<qint64>(m_emulatedFrames);
+    return result;
+}
+
+void AtariEmulator::reportScreenText()
+{
+    if (!m_screenTextEvents.load(std::memory_order_relaxed)) {
+        m_screenTextReported = false;
+        return;
+    }
+    QStringList rows;
+    for (const AnticTextDecoder::Line& line : decodeScreenText(-1)) {
+        rows.append(trimmedRow(line.text));
+    }
+    if (m_screenTextReported && rows == m_lastScreenText) {
+        return;
+    }
+    m_lastScreenText = rows;
+    m_screenTextReported = true;
+    emit screenTextChanged(m_emulatedFrames, rows);
+}
+
+void AtariEmulator::publishSharedState()
+{
+    if (!m_sharedState.isOpen() || !m_libatari800Initialized) {
+        return;
+    }
+    if (m_paletteLutDirty.exchange(false)) {
+        rebuildPaletteLut();
+    }
+    SharedStateRegion::Registers registers;
+    registers.pc = CPU_regPC;
+    registers.a = CPU_regA;
+    registers.x = CPU_regX;
+    registers.y = CPU_regY;
+    registers.s = CPU_regS;
+    registers.p = CPU_regP;
+    m_sharedState.publish(m_emulatedFrames, registers, libatari800_get_screen_ptr(),
+                          m_paletteColorTable, MEMORY_mem);
+}
+
+QJsonObject AtariEmulator::startRecording(const QString& path)
+{
+    if (!m_libatari800Initialized) {
+        return QJsonObject{{"error", "Emulator not initialized"}};
+    }
+    if (m_paletteLutDirty.exchange(false)) {
+        rebuildPaletteLut();
+    }
+    AviWriter::Format format;
+    format.fps = m_targetFps;
+    std::copy(m_paletteLut, m_paletteLut + 256, format.palette);
+    format.sampleRate = libatari800_get_sound_frequency();
+    format.channels = libatari800_get_num_sound_channels();
+    format.bitsPerSample = 8 * libatari800_get_sound_sample_size();
+
+    QString error;
+    if (!m_mediaRecorder.start(path, format, &error)) {
+        return QJsonObject{{"error", error}};
+    }
+    qDebug() << "Recording to" << path;
+    return m_mediaRecorder.status();
+}
+
+QJsonObject AtariEmulator::stopRecording()
+{
+    m_mediaRecorder.stop();
+    return m_mediaRecorder.status();
+}
+
+QJsonObject AtariEmulator::startMovieRecording(const QString& path, int verifyInterval)
+{
+    if (!m_libatari800Initialized) {
+        return QJsonObject{{"error", "Emulator not initialized"}};
+    }
+    endMovieRecording();
+    std::unique_ptr<UBYTE[]> state(new UBYTE[STATESAV_MAX_SIZE]);
+    const int size = saveStateToBuffer(state.get());
+    m_movie.begin(QByteArray(reinterpret_cast<const char*>(state.get()), size),
+                  int(sizeof(input_template_t)), verifyInterval);
+    m_moviePath = path;
+    m_movieRecording = true;
+    qDebug() << "Recording input movie to" << path;
+    return movieStatus();
+}
+
+QJsonObject AtariEmulator::stopMovieRecording()
+{
+    QJsonObject status = movieStatus();
+    if (m_movieRecording) {
+        QString error;
+        m_movieRecording = false;
+        if (!m_movie.save(m_moviePath, &error)) {
+            status["error"] = error;
+        }
+        status["recording"] = false;
+    }
+    return status;
+}
+
+void AtariEmulator::endMovieRecording()
+{
+    if (m_movieRecording) {
+        const QJsonObject status = stopMovieRecording();
+        if (status.contains("error")) {
+            qWarning() << "Input movie:" << status["error"].toString();
+        }
+    }
+}
+
+QJsonObject AtariEmulator::movieStatus() const
+{
+    QJsonObject status;
+    status["recording"] = m_movieRecording;
+    status["path"] = m_moviePath;
+    status["frames"] = static_cast<qint64>(m_movie.frameCount());
+    status["runs"] = m_movie.runCount();
+    status["checksums"] = m_movie.checksums().size();
+    status["verify_interval"] = m_movie.verifyInterval();
+    return status;
+}
+
+void AtariEmulator::recordMovieFrame(const input_template_t& input)
+{
+    if (!m_movieRecording) {
+        return;
+    }
+    m_movie.appendFrame(&input);
+    if (m_movie.checksumDue()) {
+        m_movie.addChecksum(ramChecksum(), screenChecksum());
+    }
+}
+
+quint64 AtariEmulator::ramChecksum() const
+{
+    return InputMovie::checksum(MEMORY_mem, 65536);
+}
+
+quint64 AtariEmulator::screenChecksum() const
+{
+    const unsigned char* screen = libatari800_get_screen_ptr();
+    return screen ? InputMovie::checksum(screen, 384 * 240) : 0;
+}
+
+QJsonObject AtariEmulator::playMovie(const QString& path, bool stopOnMismatch)
+{
+    if (!m_libatari800Initialized) {
+        return QJsonObject{{"error", "Emulator not initialized"}};
+    }
+    if (m_movieRecording) {
+        return QJsonObject{{"error", "A movie is being recorded"}};
+    }
+    InputMovie movie;
+    QString error;
+    if (!movie.load(path, &error)) {
+        return QJsonObject{{"error", error}};
+    }
+    if (movie.inputSize() != int(sizeof(input_template_t)) || movie.state().size() > STATESAV_MAX_SIZE) {
+        return QJsonObject{{"error", "Movie was recorded by an incompatible build"}};
+    }
+
+    // The core reads a state from a full-size buffer
+    std::unique_ptr<UBYTE[]> state(new UBYTE[STATESAV_MAX_SIZE]());
+    std::memcpy(state.get(), movie.state().constData(), static_cast<size_t>(movie.state().size()));
+    loadStateFromBuffer(state.get());
+
+    InputMovie::Player player(movie);
+    input_template_t input;
+    int checked = 0;
+    int mismatches = 0;
+    qint64 firstMismatch = -1;
+    QString firstMismatchIn;
+    QElapsedTimer timer;
+    timer.start();
+    while (!m_shuttingDown.load() && player.nextFrame(&input)) {
+        libatari800_next_frame(&input);
+        advanceFrameCounter();
+        captureRewindSnapshotIfDue();
+        recordFrameChecksum();
+        const InputMovie::Checksum* expected = player.checksumAfterFrame();
+        if (!expected) {
+            continue;
+        }
+        checked++;
+        const bool ramMatches = ramChecksum() == expected->ram;
+        const bool screenMatches = screenChecksum() == expected->screen;
+        if (ramMatches && screenMatches) {
+            continue;
+        }
+        if (mismatches++ == 0) {
+            firstMismatch = static_cast<qint64>(expected->frame);
+            firstMismatchIn = !ramMatches && !screenMatches ? "ram+screen" : (!ramMatches ? "ram" : "screen");
+        }
+        if (stopOnMismatch) {
+            break;
+        }
+    }
+    const qint64 elapsedMs = timer.elapsed();
+    publishCurrentFrame();
+    publishSharedState();
+
+    const qint64 frames = static_cast<qint64>(player.framesPlayed());
+    QJsonObject result;
+    result["path"] = path;
+    result["frames"] = frames;
+    result["movie_frames"] = static_cast<qint64>(movie.frameCount());
+    result["checked"] = checked;
+    result["mismatches"] = mismatches;
+    result["first_mismatch_frame"] = firstMismatch;
+    if (mismatches > 0) {
+        result["first_mismatch_in"] = firstMismatchIn;
+    }
+    result["elapsed_ms"] = elapsedMs;
+    result["speed_x"] = elapsedMs > 0 ? (frames * getFrameTimeMs()) / elapsedMs : 0.0;
+    return result;
+}
+
+QJsonObject AtariEmulator::startFrameChecksums(const QString& path, int capacity)
+{
+    QString error;
+    if (!m_frameChecksums.start(capacity, path, &error)) {
+        return QJsonObject{{"error", error}};
+    }
+    qDebug() << "Frame checksums on" << (path.isEmpty() ? QString("(ring only)") : path);
+    return frameChecksumStatus();
+}
+
+QJsonObject AtariEmulator::stopFrameChecksums()
+{
+    m_frameChecksums.stop();
+    return frameChecksumStatus();
+}
+
+QJsonObject AtariEmulator::frameChecksumStatus() const
+{
+    QJsonObject status;
+    status["active"] = m_frameChecksums.isActive();
+    status["path"] = m_frameChecksums.path();
+    status["capacity"] = m_frameChecksums.capacity();
+    status["size"] = m_frameChecksums.size();
+    status["next_cursor"] = static_cast<qint64>(m_frameChecksums.nextSequence());
+    return status;
+}
+
+QJsonObject AtariEmulator::readFrameChecksums(qint64 cursor, int max) const
+{
+    const quint64 from = static_cast<quint64>(qMax<qint64>(0, cursor));
+    quint64 dropped = 0;
+    const QVector<FrameChecksumStream::Entry> entries = m_frameChecksums.read(from, max, &dropped);
+    QJsonArray rows;
+    for (const FrameChecksumStream::Entry& entry : entries) {
+        rows.append(QJsonArray{static_cast<qint64>(entry.frame),
+                               QString("%1").arg(entry.ram, 16, 16, QChar('0')),
+                               QString("%1").arg(entry.screen, 16, 16, QChar('0'))});
+    }
+    QJsonObject result;
+    result["entries"] = rows;
+    result["count"] = rows.size();
+    result["next_cursor"] = static_cast<qint64>(
+        entries.isEmpty() ? qMin(from, m_frameChecksums.nextSequence()) : entries.last().sequence + 1);
+    result["dropped"] = static_cast<qint64>(dropped);
+    return result;
+}
+
+void AtariEmulator::recordFrameChecksum()
+{
+    if (m_frameChecksums.isActive()) {
+        m_frameChecksums.add(m_emulatedFrames, MEMORY_mem, 65536, libatari800_get_screen_ptr(), 384 * 240);
+    }
+}
+
+void AtariEmulator::rebuildPaletteLut()
+{
+    m_paletteGeneration++;
+    // Writing through data() detaches from colour tables still held by published
+    // frames, so consumers can detect the change without comparing contents.
+    m_paletteColorTable.resize(256);
+    QRgb* colorTable = m_paletteColorTable.data();
+    for (int i = 0; i < 256; i++) {
+        m_paletteLut[i] = 0xFF000000u | (static_cast<quint32>(Colours_table[i]) & 0x00FFFFFFu);
+        colorTable[i] = m_paletteLut[i];
+    }
+}
+
+void AtariEmulator::requestNextFrame()
+{
+    if (m_shuttingDown.load()) {
+        return;
+    }
+    if (m_deferTimerStart) {
+        // Timer start is deferred until startDeferredTimers() is called on the worker.
+        return;
+    }
+    // Absolute-time scheduling: each frame fires at firstFrameTime + frameCount * frameTimeMs.
+    // Any Qt timer overshoot or undershoot is automatically corrected on the next frame
+    // because we always measure the delay relative to the fixed absolute origin.
+    using namespace std::chrono;
+
+    // Unlimited speed: fire as fast as possible, bypass all timing logic.
+    if (m_userRequestedSpeedMultiplier == 0.0) {
+        m_frameDeadlineValid = false;
+        m_frameCount++;
+        m_frameTimer->start(0);
+        return;
+    }
+
+#ifdef HAVE_SDL2_AUDIO
+    if (audioPacingActive()) {
+        // Audio-master: the next frame runs once the device has drained the ring to
+        // its target, so the audio clock sets the pace. The wait is bounded by one
+        // frame, so a paused or stalled device degrades to about timer pacing.
+        m_unifiedAudio->waitForQueuedBelow(m_unifiedAudio->targetQueuedBytes(),
+                                           static_cast<int>(m_frameTimeMs) + 1);
+        m_audioPacedLastFrame = true;
+        m_frameDeadlineValid = false;
+        m_frameCount++;
+        m_frameTimer->start(0);
+        return;
+    }
+#endif
+    if (m_audioPacedLastFrame) {
+        // Back on the timer: start the absolute schedule from now
+        m_audioPacedLastFrame = false;
+        m_firstFrameTime = steady_clock::now();
+        m_frameCount = 0;
+    }
+
+    m_frameCount++;
+
+    auto nextFrameTime = m_firstFrameTime +
+        duration<double, std::milli>(m_frameCount * static_cast<double>(m_frameTimeMs));
+
+    auto now = steady_clock::now();
+    auto delayUs = duration_cast<microseconds>(nextFrameTime - now).count();
+
+    // Debt cap (mirrors standalone atari800's Atari800_Sync self-healing):
+    // If we've fallen more than one full frame behind wall-clock time, discard
+    // the accumulated debt by resetting the time baseline.  Without this,
+    // netsio_wait_for_sync() blocking inside ANTIC_Frame() causes an ever-growing
+    // catch-up backlog where each intervalMs=0 frame that hits another SIO command
+    // adds more blocking, creating a feedback loop of progressive slowdown.
+    const auto frameTimeUs = static_cast<int64_t>(m_frameTimeMs * 1000.0);
+    if (delayUs < -frameTimeUs) {
+        m_firstFrameTime = now;
+        // Next line in this function is m_frameCount++, so use 0 here so the first
+        // deadline after reset is firstFrameTime + 1 * frameTime (not +2).
+        m_frameCount = 0;
+        delayUs = frameTimeUs;
+    }
+    m_frameDeadline = now + microseconds(delayUs);
+    m_frameDeadlineValid = true;
+
+    // Convert microseconds to milliseconds, clamping to [0, frameTimeMs] range
+    int intervalMs = 0;
+    if (delayUs > 0) {
+        // Round to nearest ms; clamp so we never schedule more than one full frame ahead.
+        // Precise timing wakes early instead and processFrame() waits out the rest.
+        intervalMs = m_preciseTiming ? qMax(0, static_cast<int>(delayUs / 1000) - kPreciseWakeMarginMs)
+                                     : static_cast<int>((delayUs + 500) / 1000);
+        int maxInterval = static_cast<int>(m_frameTimeMs) + 1;
+        if (intervalMs > maxInterval) intervalMs = maxInterval;
+    }
+
+    m_frameTimer->start(intervalMs);
+}
+
+int AtariEmulator::runFramesUnpaced(int frameCount)
+{
+    int framesRun = 0;
+    while (framesRun < frameCount && m_libatari800Initialized &&
+           !m_shuttingDown.load() && !m_emulationPaused) {
+        if (!runDueScheduledActions()) {
+            break;
+        }
+        input_template_t inputSnapshot;
+        {
+            QMutexLocker inputLock(&m_inputMutex);
+            inputSnapshot = m_currentInput;
+        }
+        reportInputChanges(inputSnapshot);
+        const input_template_t frameInput = inputSnapshot;  // next_frame may rewrite it
+        libatari800_next_frame(&inputSnapshot);
+        advanceFrameCounter();
+        recordMovieFrame(frameInput);
+        captureRewindSnapshotIfDue();
+        recordFrameChecksum();
+        collectInstructionTrace();
+        checkBreakpoints();
+        framesRun++;
+    }
+    publishSharedState();
+    return framesRun;
+}
+
+QImage AtariEmulator::renderCurrentFrame()
+{
+    QImage image(384, 240, QImage::Format_RGB32);
+    image.fill(Qt::black);
+    renderFrameImage(image);
+    return image;
+}
+
+const unsigned char* AtariEmulator::getScreen()
+{
+    return libatari800_get_screen_ptr();
+}
+
+bool AtariEmulator::loadFile(const QString& filename)
+{
+    endMovieRecording();
+    // Determine file type by extension
+    QFileInfo fileInfo(filename);
+    QString extension = fileInfo.suffix().toLower();
+    
+    if (extension == "xex" || extension == "exe" || extension == "com") {
+        // Load XEX/EXE/COM files as executables using BINLOAD.
+        // BINLOAD_Loader() calls Atari800_Coldstart() internally, which sends a 0xFF
+        // cold-reset packet to FujiNet-PC via netsio_cold_reset(), causing it to
+        // exit(75) and restart.  Suppress the packet the same way coldBoot() does so
+        // that loading a XEX does not kill the FujiNet connection.
+#ifdef NETSIO
+        if (m_netSIOEnabled && netsio_enabled) {
+            int savedNetsioEnabled = netsio_enabled;
+            netsio_enabled = 0;
+            int result = BINLOAD_Loader(filename.toUtf8().constData());
+            netsio_enabled = savedNetsioEnabled;
+            return result != 0;
+        }
+#endif
+        return BINLOAD_Loader(filename.toUtf8().constData()) != 0;
+    } else {
+        // Load other files (CAR, ROM, etc.) as cartridges
+
+        qDebug() << "Loading cartridge file:" << filename;
+        qDebug() << "Current CARTRIDGE_autoreboot value:" << CARTRIDGE_autoreboot;
+        qDebug() << "Current Atari800_disable_basic value:" << Atari800_disable_basic;
+
+        // CRITICAL: Disable BASIC to allow cartridge to boot
+        // When Atari800_disable_basic = TRUE, it simulates holding the Option key
+        // during boot, which disables BASIC and allows the cartridge to run
+        Atari800_disable_basic = TRUE;
+        qDebug() << "Set Atari800_disable_basic = TRUE to allow cartridge boot";
+
+        // First, explicitly remove any existing cartridge with reboot
+        // This ensures a clean slate before loading the new cartridge
+        CARTRIDGE_RemoveAutoReboot();
+        qDebug() << "Removed existing cartridge";
+
+        // Now insert the new cartridge with auto-reboot
+        // This provides a complete system reset with the new cartridge
+        const QString cartridgePath = m_romImageCache.resolve(filename);
+        int result = CARTRIDGE_InsertAutoReboot(cartridgePath.toUtf8().constData());
+
+        qDebug() << "CARTRIDGE_InsertAutoReboot returned:" << result;
+
+        if (result == 0) {
             // Type was auto-detected, cartridge is ready
             qDebug() << "Cartridge type auto-detected and inserted successfully";
             return true;
@@ -1676,8 +2456,27 @@ bool AtariEmulator::mountDiskImage(int driveNumber, const QString& filename, boo
     }
     
     
+    // The core lets go of an earlier scratch copy before it is deleted
+    if (m_diskCache.hasOverlay(driveNumber) && m_mountedDrives.contains(driveNumber)) {
+        libatari800_unmount_disk(driveNumber);
+        m_diskImages[driveNumber - 1].clear();
+        m_mountedDrives.remove(driveNumber);
+    }
+    m_diskCache.discardOverlay(driveNumber);
+
+    // An overlaid drive gets a scratch copy of the cached image instead
+    QString mountPath = filename;
+    if (m_diskOverlayEnabled[driveNumber - 1]) {
+        QString error;
+        mountPath = m_diskCache.beginOverlay(driveNumber, filename, &error);
+        if (mountPath.isEmpty()) {
+            qWarning() << "Disk overlay for D" << driveNumber << "failed:" << error;
+            return false;
+        }
+    }
+
     // Mount the disk image using libatari800
-    int result = libatari800_mount_disk_image(driveNumber, filename.toUtf8().constData(), readOnly ? 1 : 0);
+    int result = libatari800_mount_disk_image(driveNumber, mountPath.toUtf8().constData(), readOnly ? 1 : 0);
     
     
     if (result) {
@@ -1690,6 +2489,7 @@ bool AtariEmulator::mountDiskImage(int driveNumber, const QString& filename, boo
 
         return true;
     } else {
+        m_diskCache.discardOverlay(driveNumber);
         return false;
     }
 }
@@ -1703,28 +2503,59 @@ void AtariEmulator::dismountDiskImage(int driveNumber)
     
     // Actually dismount from libatari800 core
     libatari800_unmount_disk(driveNumber);
+    m_diskCache.discardOverlay(driveNumber);
     
     // Clear Fujisan internal state
     m_diskImages[driveNumber - 1].clear();
     m_mountedDrives.remove(driveNumber);
 }
 
-void AtariEmulator::disableDrive(int driveNumber)
+void AtariEmulator::setDiskOverlayEnabled(int driveNumber, bool enabled)
 {
-    if (driveNumber < 1 || driveNumber > 8) {
-        qWarning() << "Invalid drive number for disable:" << driveNumber;
-        return;
+    if (driveNumber >= 1 && driveNumber <= 8) {
+        m_diskOverlayEnabled[driveNumber - 1] = enabled;
     }
-    
-    // Disable drive in libatari800 core (dismounts disk and sets status to OFF)
-    libatari800_disable_drive(driveNumber);
-    
-    // Clear Fujisan internal state
-    m_diskImages[driveNumber - 1].clear();
-    m_mountedDrives.remove(driveNumber);
 }
 
-void AtariEmulator::coldRestart()
+bool AtariEmulator::isDiskOverlayEnabled(int driveNumber) const
+{
+    return driveNumber >= 1 && driveNumber <= 8 && m_diskOverlayEnabled[driveNumber - 1];
+}
+
+bool AtariEmulator::commitDiskOverlay(int driveNumber, QString* error)
+{
+    if (!m_diskCache.hasOverlay(driveNumber)) {
+        if (error) {
+            *error = QStringLiteral("D%1: has no disk overlay").arg(driveNumber);
+        }
+        return false;
+    }
+    // Unmounting closes the core's FILE, so its last write is on disk
+    libatari800_unmount_disk(driveNumber);
+    // On failure the overlay stays, so the commit can be retried
+    const bool committed = m_diskCache.commitOverlay(driveNumber, error);
+    m_diskImages[driveNumber - 1].clear();
+    m_mountedDrives.remove(driveNumber);
+    return committed;
+}
+
+void AtariEmulator::disableDrive(int driveNumber)
+{
+    if (driveNumber < 1 || driveNumber > 8) {
+        qWarning() << "Invalid drive number for disable:" << driveNumber;
+        return;
+    }
+    
+    // Disable drive in libatari800 core (dismounts disk and sets status to OFF)
+    libatari800_disable_drive(driveNumber);
+    m_diskCache.discardOverlay(driveNumber);
+    
+    // Clear Fujisan internal state
+    m_diskImages[driveNumber - 1].clear();
+    m_mountedDrives.remove(driveNumber);
+}
+
+void AtariEmulator::coldRestart()
 {
     // Trigger Atari800 cold start to refresh boot sequence
     Atari800_Coldstart();
@@ -1747,8 +2578,110 @@ QString AtariEmulator::getDiskImagePath(int driveNumber) const
     return m_diskImages[driveNumber - 1];
 }
 
+int AtariEmulator::addKnownRomImages(const QJsonArray& images)
+{
+    int known = 0;
+    for (const QJsonValue& value : images) {
+        const QJsonObject image = value.toObject();
+        if (m_romImageCache.addKnownImage(image["path"].toString(), image["size"].toVariant().toLongLong(),
+                                          QDateTime::fromMSecsSinceEpoch(image["modified"].toVariant().toLongLong()),
+                                          image["sha1"].toString().toLatin1())) {
+            ++known;
+        }
+    }
+    return known;
+}
+
+bool AtariEmulator::insertCassette(const QString& filename, bool readOnly, bool bootTape)
+{
+    if (filename.isEmpty()) {
+        return false;
+    }
+    endTapeAcceleration();
+    m_tapeAccelerator.reset();
+    if (!CASSETTE_Insert(filename.toUtf8().constData())) {
+        qWarning() << "Failed to insert cassette:" << filename;
+        return false;
+    }
+    m_cassettePath = filename;
+    CASSETTE_write_protect = readOnly ? 1 : 0;
+    CASSETTE_record = 0;
+    qDebug() << "Cassette inserted:" << filename << (readOnly ? "(read-only)" : "(read-write)");
+
+    if (bootTape) {
+        // START held through the cold boot, SPACE at the "load" beep
+        CASSETTE_hold_start = 1;
+        CASSETTE_press_space = 1;
+        coldBoot();
+    }
+    return true;
+}
+
+void AtariEmulator::ejectCassette()
+{
+    endTapeAcceleration();
+    m_tapeAccelerator.reset();
+    CASSETTE_Remove();
+    m_cassettePath.clear();
+    qDebug() << "Cassette ejected";
+}
+
+QJsonObject AtariEmulator::getCassetteStatus() const
+{
+    QJsonObject status;
+    const bool mounted = CASSETTE_status != CASSETTE_STATUS_NONE;
+    status["path"] = mounted ? m_cassettePath : QString();
+    status["position"] = mounted ? static_cast<int>(CASSETTE_GetPosition()) : 0;
+    status["size"] = mounted ? static_cast<int>(CASSETTE_GetSize()) : 0;
+    status["motor"] = (PIA_PACTL & 0x08) == 0;
+    status["recording"] = CASSETTE_record != 0;
+    status["read_only"] = CASSETTE_write_protect != 0;
+    QJsonObject acceleration = m_tapeAccelerator.status();
+    acceleration["enabled"] = isTapeAccelerationEnabled();
+    status["tape_acceleration"] = acceleration;
+    return status;
+}
+
+void AtariEmulator::setTapeAccelerationEnabled(bool enabled)
+{
+    m_tapeAccelerationEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void AtariEmulator::updateTapeAcceleration()
+{
+    if (!isTapeAccelerationEnabled()) {
+        endTapeAcceleration();
+        return;
+    }
+    const bool mounted = CASSETTE_status != CASSETTE_STATUS_NONE;
+    const TapeAccelerator::Transition transition = m_tapeAccelerator.update(
+        mounted, (PIA_PACTL & 0x08) == 0, CASSETTE_record != 0,
+        mounted ? static_cast<int>(CASSETTE_GetPosition()) : 0,
+        mounted ? static_cast<int>(CASSETTE_GetSize()) : 0);
+    if (transition == TapeAccelerator::Start) {
+        beginSpeedBoost();
+        qDebug() << "Tape load detected: running unlimited until it finishes";
+        emit tapeAccelerationChanged(true);
+    } else if (transition == TapeAccelerator::Stop) {
+        endSpeedBoost();
+        qDebug() << "Tape load finished: back to" << getCurrentEmulationSpeed() << "%";
+        emit tapeAccelerationChanged(false);
+    }
+}
+
+void AtariEmulator::endTapeAcceleration()
+{
+    if (!m_tapeAccelerator.isActive()) {
+        return;
+    }
+    m_tapeAccelerator.reset();
+    endSpeedBoost();
+    emit tapeAccelerationChanged(false);
+}
+
 void AtariEmulator::handleKeyPress(QKeyEvent* event)
 {
+    m_inputLatency.markInput(InputLatencyMonitor::Keyboard);
     QMutexLocker inputLock(&m_inputMutex);
     // Check for joystick keyboard emulation first
     if (handleJoystickKeyboardEmulation(event)) {
@@ -2030,6 +2963,7 @@ void AtariEmulator::handleKeyPress(QKeyEvent* event)
 
 void AtariEmulator::handleKeyRelease(QKeyEvent* event)
 {
+    m_inputLatency.markInput(InputLatencyMonitor::Keyboard);
     QMutexLocker inputLock(&m_inputMutex);
     // Check for joystick keyboard emulation first  
     if (handleJoystickKeyboardEmulation(event)) {
@@ -2058,6 +2992,7 @@ void AtariEmulator::handleKeyRelease(QKeyEvent* event)
 
 void AtariEmulator::coldBoot()
 {
+    endMovieRecording();
     qDebug() << "[NETSIO] COLD BOOT START — m_netSIOEnabled:" << m_netSIOEnabled;
 #ifdef NETSIO
     qDebug() << "[NETSIO] netsio_enabled:" << netsio_enabled;
@@ -2123,6 +3058,7 @@ void AtariEmulator::coldBoot()
 
 void AtariEmulator::warmBoot()
 {
+    endMovieRecording();
     qDebug() << "[NETSIO] WARM BOOT START";
     qDebug() << "[NETSIO] m_netSIOEnabled:" << m_netSIOEnabled;
 
@@ -2336,6 +3272,20 @@ QString AtariEmulator::quotePath(const QString& path)
 
 void AtariEmulator::setupAudio()
 {
+    // Telemetry counters are per backend instance
+    m_audioUnderruns = 0;
+    m_audioOverruns = 0;
+
+    // Turbo speeds: "compress" (pitched up), "pitch" (frames dropped) or "off"
+    {
+        QSettings settings("8bitrelics", "Fujisan");
+        const QString turboMode = settings.value("audio/turboMode", "compress").toString();
+        m_turboAudioEnabled = turboMode != "off";
+        m_audioDecimator.configure(libatari800_get_num_sound_channels(), libatari800_get_sound_sample_size());
+        m_audioDecimator.setMode(turboMode == "pitch" ? AudioDecimator::PitchPreserve
+                                                      : AudioDecimator::TimeCompress);
+    }
+
 #ifdef HAVE_SDL2_AUDIO
     // Unified Audio Backend (preferred when SDL2 is available)
     if (m_audioBackend == UnifiedAudio) {
@@ -2350,7 +3300,12 @@ void AtariEmulator::setupAudio()
         if (!m_unifiedAudio) {
             m_unifiedAudio = new UnifiedAudioBackend(this);
         }
+        QSettings settings("8bitrelics", "Fujisan");
+        m_unifiedAudio->setResamplerQuality(settings.value("audio/resampler", "sinc").toString() == "linear"
+                                                ? AudioResampler::Linear
+                                                : AudioResampler::Sinc);
 
+        m_unifiedAudio->setDriftCompensation(!m_audioMasterSync);
         // Initialize with optimal settings for each platform
         if (m_unifiedAudio->initialize(sampleRate, channels, sampleSize)) {
             return;  // Successfully initialized, skip Qt audio setup
@@ -2384,11 +3339,8 @@ void AtariEmulator::setupAudio()
             m_sdl2Audio = new SDL2AudioBackend(this);
         }
         
-        // Initialize ring buffer with prefill for stability
-        m_sdl2AudioBuffer.resize(SDL2_BUFFER_SIZE);
-        m_sdl2AudioBuffer.fill(0);
-        m_sdl2WritePos = 0;
-        m_sdl2ReadPos = 0;
+        // Empty the ring buffer (allocated once, so an old callback never sees it freed)
+        m_sdl2Ring.clear();
         
         // Set target buffer level based on sample rate
         // Lower sample rates need proportionally smaller buffers
@@ -2399,19 +3351,15 @@ void AtariEmulator::setupAudio()
         // Minimal prefill to prevent initial underruns
         // Don't overfill as it contributes to accumulation
         int prefillBytes = 1024;  // Just 1 SDL callback worth
-        for (int i = 0; i < prefillBytes; i++) {
-            m_sdl2AudioBuffer[m_sdl2WritePos] = 0;
-            m_sdl2WritePos = (m_sdl2WritePos + 1) % SDL2_BUFFER_SIZE;
-        }
+        m_sdl2Ring.writeSilence(prefillBytes);
         
         // Initialize SDL2 audio
         if (m_sdl2Audio->initialize(sampleRate, channels, sampleSize)) {
             // Set the audio callback to read from our ring buffer
+            // (lock-free: this runs on SDL's audio thread, the producer is processFrame())
             m_sdl2Audio->setAudioCallback([this](unsigned char* stream, int len) {
-                QMutexLocker locker(&m_sdl2AudioMutex);
-                
                 // Calculate available data in ring buffer
-                int availableData = (m_sdl2WritePos - m_sdl2ReadPos + SDL2_BUFFER_SIZE) % SDL2_BUFFER_SIZE;
+                int availableData = m_sdl2Ring.available();
                 
                 // Track buffer level for monitoring
                 m_sdl2BufferLevelAccum += availableData;
@@ -2432,17 +3380,10 @@ void AtariEmulator::setupAudio()
                 
                 if (availableData >= len) {
                     // We have enough data
-                    for (int i = 0; i < len; i++) {
-                        stream[i] = m_sdl2AudioBuffer[m_sdl2ReadPos];
-                        m_sdl2ReadPos = (m_sdl2ReadPos + 1) % SDL2_BUFFER_SIZE;
-                    }
+                    m_sdl2Ring.read(stream, len);
                 } else if (availableData > 0) {
                     // Partial data available - underrun
-                    int i;
-                    for (i = 0; i < availableData; i++) {
-                        stream[i] = m_sdl2AudioBuffer[m_sdl2ReadPos];
-                        m_sdl2ReadPos = (m_sdl2ReadPos + 1) % SDL2_BUFFER_SIZE;
-                    }
+                    int i = m_sdl2Ring.read(stream, availableData);
                     // Fill rest with silence
                     memset(stream + i, 0, len - i);
                     
@@ -2518,22 +3459,14 @@ void AtariEmulator::setupAudio()
 #else
     int dspBufferSamples = m_fragmentSize * 10;  // Standard buffer for macOS
 #endif
-    m_dspBufferBytes = dspBufferSamples * m_bytesPerSample;
     
-    // Initialize the DSP buffer and staging buffer
-    m_dspBuffer.resize(m_dspBufferBytes);
-    m_dspBuffer.fill(0);
+    // Initialize the DSP buffer (rounded up to a power of two) and staging buffer
+    m_dspRing.setCapacity(dspBufferSamples * m_bytesPerSample);
     m_dspStagingBuffer.resize(DSP_STAGING_BYTES);
     m_dspStagingBuffer.fill(0);
     
-    // Initialize positions
-    m_dspReadPos = 0;
-#ifdef _WIN32
-    // Windows works best with lower initial buffer matching the working pattern
-    m_dspWritePos = (m_targetDelay * 1.0) * m_bytesPerSample;  // Start with target delay (matches 15% pattern)
-#else
-    m_dspWritePos = m_targetDelay * m_bytesPerSample;  // Start with target delay
-#endif
+    // Start with target delay worth of silence queued
+    m_dspRing.writeSilence(m_targetDelay * m_bytesPerSample);
     m_callbackTick = 0;
     m_avgGap = 0.0;
     
@@ -2612,6 +3545,7 @@ void AtariEmulator::setupAudio()
 
         static int underrunCount = 0;
         underrunCount++;
+        m_audioUnderruns++;
         if (underrunCount <= 5 || underrunCount % 50 == 0) {
             qDebug() << "[Audio] Underrun #" << underrunCount
                      << "- scheduling deferred recovery";
@@ -2627,9 +3561,7 @@ void AtariEmulator::setupAudio()
                 return;
 
             // Reset DSP ring buffer so the next processFrame() write starts clean
-            m_dspWritePos = 0;
-            m_dspReadPos  = 0;
-            m_dspBuffer.fill(0);
+            m_dspRing.clear();
 
             // Reset PI controller — stale integral is misleading after an underrun
             m_piIntegral  = 0.0;
@@ -2642,7 +3574,7 @@ void AtariEmulator::setupAudio()
             static int linuxUnderrunCount = 0;
             if (++linuxUnderrunCount % 5 == 0) {
                 m_targetDelay = qMin(m_targetDelay + m_fragmentSize,
-                                     m_dspBufferBytes / m_bytesPerSample / 2);
+                                     m_dspRing.capacity() / m_bytesPerSample / 2);
                 qDebug() << "[Audio] Linux: increased target delay to"
                          << m_targetDelay << "samples after repeated underruns";
             }
@@ -2722,9 +3654,8 @@ void AtariEmulator::enableAudio(bool enabled)
                 m_audioOutput->deleteLater();
                 m_audioOutput = nullptr;
                 m_audioDevice = nullptr;
-                // Clear DSP buffer positions
-                m_dspReadPos = 0;
-                m_dspWritePos = m_targetDelay * m_bytesPerSample;  // Reset to target delay
+                // Clear DSP buffer, refilled when audio is set up again
+                m_dspRing.clear();
             }
         }
         
@@ -2760,15 +3691,16 @@ void AtariEmulator::setAudioBackend(AudioBackend backend)
         return;
     }
     if (m_audioBackend != backend) {
-        // Stop current audio
-        if (m_audioEnabled) {
+        // Stop current audio (enableAudio(false) clears m_audioEnabled)
+        const bool wasEnabled = m_audioEnabled;
+        if (wasEnabled) {
             enableAudio(false);
         }
         
         m_audioBackend = backend;
         
         // Restart audio with new backend
-        if (m_audioEnabled) {
+        if (wasEnabled) {
             enableAudio(true);
         }
     }
@@ -2778,6 +3710,296 @@ void AtariEmulator::setAudioBackend(AudioBackend backend)
 #endif
 }
 
+void AtariEmulator::setAudioMasterSync(bool enabled)
+{
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, [this, enabled]() { setAudioMasterSync(enabled); }, Qt::QueuedConnection);
+        return;
+    }
+#ifdef HAVE_SDL2_AUDIO
+    m_audioMasterSync = enabled;
+    if (enabled) {
+        setAudioBackend(UnifiedAudio);
+    }
+    if (m_unifiedAudio) {
+        // The emulator follows the device clock itself; no resampler trim on top
+        m_unifiedAudio->setDriftCompensation(!enabled);
+        m_unifiedAudio->setRateAdjustment(1.0);
+    }
+#else
+    Q_UNUSED(enabled)
+    m_audioMasterSync = false;
+#endif
+}
+
+QJsonObject AtariEmulator::setThreadScheduling(int priority, int cpu, bool preciseTiming)
+{
+    const auto level = static_cast<ThreadScheduling::Priority>(
+        qBound(static_cast<int>(ThreadScheduling::PriorityNormal), priority,
+               static_cast<int>(ThreadScheduling::PriorityRealtime)));
+    const int periodUs = static_cast<int>(1000000.0 / pacedFps());
+    m_threadScheduling = ThreadScheduling::applyToCurrentThread(level, cpu, periodUs);
+    m_preciseTiming = preciseTiming;
+    // 1 ms timer granularity on Windows; without it the early wake-up alone is not enough
+    ThreadScheduling::setHighResolutionTimer(preciseTiming);
+    resetFramePacing();
+    qDebug() << "Emulator thread scheduling:" << m_threadScheduling << "precise timing:" << preciseTiming;
+    return threadSchedulingStatus();
+}
+
+void AtariEmulator::applyThreadSchedulingSetting()
+{
+    QSettings settings("8bitrelics", "Fujisan");
+    ThreadScheduling::Priority priority = ThreadScheduling::PriorityNormal;
+    ThreadScheduling::parsePriority(settings.value("emulator/threadPriority", "normal").toString(), &priority);
+    setThreadScheduling(priority, settings.value("emulator/cpuAffinity", -1).toInt(),
+                        settings.value("emulator/preciseTiming", false).toBool());
+}
+
+QJsonObject AtariEmulator::threadSchedulingStatus() const
+{
+    QJsonObject status = m_threadScheduling;
+    if (status.isEmpty()) {
+        status["priority"] = ThreadScheduling::priorityName(ThreadScheduling::PriorityNormal);
+        status["granted"] = status["priority"];
+        status["cpu"] = -1;
+    }
+    status["precise_timing"] = m_preciseTiming;
+    status["cpu_count"] = ThreadScheduling::cpuCount();
+    return status;
+}
+
+void AtariEmulator::recordFramePacing()
+{
+    using namespace std::chrono;
+    const auto start = steady_clock::now();
+    const qint64 latenessUs = qMax<qint64>(0, duration_cast<microseconds>(start - m_frameDeadline).count());
+    m_frameLateness.record(latenessUs);
+    if (latenessUs > kLateFrameUs) {
+        m_lateFrames++;
+    }
+    if (latenessUs > static_cast<qint64>(m_frameTimeMs * 1000.0f)) {
+        m_missedFrames++;
+    }
+    if (m_lastPacedFrameValid) {
+        m_frameIntervals.record(duration_cast<microseconds>(start - m_lastPacedFrameStart).count());
+    }
+    m_lastPacedFrameStart = start;
+    m_lastPacedFrameValid = true;
+}
+
+QJsonObject AtariEmulator::framePacingStatus() const
+{
+    QJsonObject status;
+    status["lateness"] = m_frameLateness.toJson();
+    status["interval"] = m_frameIntervals.toJson();
+    status["late_frames"] = static_cast<qint64>(m_lateFrames);
+    status["missed_frames"] = static_cast<qint64>(m_missedFrames);
+    status["late_threshold_us"] = kLateFrameUs;
+    status["frame_time_us"] = static_cast<qint64>(m_frameTimeMs * 1000.0f);
+    status["precise_timing"] = m_preciseTiming;
+    return status;
+}
+
+void AtariEmulator::resetFramePacing()
+{
+    m_frameLateness.reset();
+    m_frameIntervals.reset();
+    m_lateFrames = 0;
+    m_missedFrames = 0;
+    m_lastPacedFrameValid = false;
+}
+
+void AtariEmulator::applyAudioSyncSetting()
+{
+#ifdef HAVE_SDL2_AUDIO
+    QSettings settings("8bitrelics", "Fujisan");
+    m_audioMasterSync = settings.value("audio/syncToAudio", false).toBool();
+    if (m_audioMasterSync) {
+        m_audioBackend = UnifiedAudio;
+    }
+#endif
+}
+
+bool AtariEmulator::audioPacingActive() const
+{
+#ifdef HAVE_SDL2_AUDIO
+    // Only at normal speed: at other speeds the device cannot consume audio at the emulated rate
+    return m_audioMasterSync && m_audioEnabled && m_audioBackend == UnifiedAudio && m_unifiedAudio &&
+           m_unifiedAudio->isInitialized() && m_userRequestedSpeedMultiplier == 1.0 && !m_emulationPaused;
+#else
+    return false;
+#endif
+}
+
+void AtariEmulator::recordAudioTelemetry(int producedBytes)
+{
+    if (!m_audioEnabled) {
+        return;
+    }
+    AudioTelemetrySample sample;
+    sample.frame = m_emulatedFrames;
+    sample.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    sample.frameIntervalUs = m_lastAudioTelemetryUs
+        ? static_cast<qint32>(qMin<qint64>(sample.timeUs - m_lastAudioTelemetryUs, INT_MAX)) : 0;
+    m_lastAudioTelemetryUs = sample.timeUs;
+    sample.producedBytes = producedBytes;
+    sample.underruns = m_audioUnderruns;
+    sample.overruns = m_audioOverruns;
+    sample.backend = static_cast<quint8>(m_audioBackend);
+    int fillPercent = 0;
+
+#ifdef HAVE_SDL2_AUDIO
+    if (m_audioBackend == UnifiedAudio) {
+        if (!m_unifiedAudio || !m_unifiedAudio->isInitialized()) {
+            return;
+        }
+        sample.queuedBytes = m_unifiedAudio->queuedBytes();
+        sample.underruns = static_cast<quint32>(m_unifiedAudio->getUnderrunCount());
+        sample.overruns = static_cast<quint32>(m_unifiedAudio->getOverrunCount());
+        sample.speedTrim = static_cast<float>(m_unifiedAudio->getRateAdjustment() - 1.0);
+        sample.deviceClockUs = m_unifiedAudio->lastCallbackMicroseconds();
+        fillPercent = static_cast<int>(m_unifiedAudio->getBufferFillPercent());
+    } else if (m_audioBackend == SDL2Audio) {
+        if (!m_sdl2Audio || !m_sdl2Audio->isInitialized()) {
+            return;
+        }
+        sample.queuedBytes = m_sdl2Ring.available();
+        fillPercent = m_sdl2Ring.capacity() > 0 ? sample.queuedBytes * 100 / m_sdl2Ring.capacity() : 0;
+    } else
+#endif
+    {
+        if (!m_audioOutput || !m_audioDevice) {
+            return;
+        }
+        sample.queuedBytes = m_dspRing.available();
+        fillPercent = m_dspRing.capacity() > 0 ? sample.queuedBytes * 100 / m_dspRing.capacity() : 0;
+        sample.deviceFreeBytes = m_audioOutput->bytesFree();
+        sample.speedTrim = static_cast<float>(m_piSpeedTrim);
+        sample.deviceClockUs = m_audioOutput->processedUSecs();
+        sample.deviceState = static_cast<quint8>(m_audioOutput->state());
+    }
+    m_audioTelemetry.record(sample);
+
+    if (m_performance.isEnabled()) {
+        m_performance.record(PerformanceMonitor::AudioFill, qBound(0, fillPercent, 100));
+        // A backend set up again counts from zero
+        const quint32 underruns = sample.underruns >= m_performanceUnderruns
+                                      ? sample.underruns - m_performanceUnderruns : sample.underruns;
+        m_performance.record(PerformanceMonitor::AudioUnderruns, static_cast<qint32>(underruns));
+    }
+    m_performanceUnderruns = sample.underruns;
+}
+
+void AtariEmulator::recordSioWait()
+{
+#ifdef NETSIO
+    if (!m_netSIOEnabled) {
+        return;
+    }
+    // The link statistics take the NetSIO layer's own small lock, uncontended here
+    netsio_link_stats stats;
+    netsio_get_link_stats(&stats);
+    const unsigned long long stalled = stats.stall_us >= m_performanceSioStallUs
+                                           ? stats.stall_us - m_performanceSioStallUs : stats.stall_us;
+    m_performanceSioStallUs = stats.stall_us;
+    m_performance.record(PerformanceMonitor::SioWait, static_cast<qint32>(qMin<unsigned long long>(stalled, INT_MAX)));
+#endif
+}
+
+void AtariEmulator::adaptAudioToSpeed(const unsigned char*& buffer, int& length)
+{
+    using namespace std::chrono;
+    const steady_clock::time_point now = steady_clock::now();
+    const double intervalUs = duration_cast<duration<double, std::micro>>(now - m_turboLastFrameTime).count();
+    m_turboLastFrameTime = now;
+
+    // The speed the host actually achieves, smoothed over ~20 frames. Unlimited
+    // runs at exactly that; a fixed turbo speed the host cannot reach is
+    // decimated by what it does reach, or the device would be underfed.
+    const double nominalUs = 1000000.0 / (m_targetFps > 0 ? m_targetFps : 50);
+    if (intervalUs > 0.0 && intervalUs < 1000000.0) {
+        m_turboMeasuredSpeed += 0.05 * (nominalUs / intervalUs - m_turboMeasuredSpeed);
+    }
+    double speed = m_userRequestedSpeedMultiplier;
+    if (speed == 0.0) {
+        speed = m_turboMeasuredSpeed;
+    } else if (speed > 1.0) {
+        speed = qBound(1.0, m_turboMeasuredSpeed, speed);
+    }
+    if (!m_turboAudioEnabled || !buffer || length <= 0) {
+        return;
+    }
+    length = m_audioDecimator.process(buffer, length, speed, &buffer);
+}
+
+void AtariEmulator::setAudioDiagnosticsEnabled(bool enabled)
+{
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, [this, enabled]() { setAudioDiagnosticsEnabled(enabled); },
+                                  Qt::QueuedConnection);
+        return;
+    }
+    m_enableAudioDiagnostics = enabled;
+    if (enabled) {
+        startAudioTelemetryLog();
+    } else {
+        stopAudioTelemetryLog();
+    }
+}
+
+void AtariEmulator::startAudioTelemetryLog()
+{
+    if (m_audioTelemetryLogThread) {
+        return;
+    }
+    QString logDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(logDir);
+    const QString logPath = logDir + QDir::separator() + "audio_diagnostics.csv";
+
+    // The emulator thread only fills the telemetry ring; this thread owns the
+    // file, so disk I/O never lands inside a frame
+    m_audioTelemetryLogStop.store(false);
+    m_audioTelemetryLogThread = QThread::create([this, logPath]() {
+        QFile file(logPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            qWarning() << "Failed to open audio diagnostics log file at" << logPath;
+            return;
+        }
+        QTextStream ts(&file);
+        ts << AudioTelemetryRing::csvHeader() << "\n";
+
+        quint64 cursor = 0;  // start with the history already in the ring
+        bool stopping = false;
+        while (!stopping) {
+            stopping = m_audioTelemetryLogStop.load();
+            const QVector<AudioTelemetrySample> samples =
+                m_audioTelemetry.read(cursor, m_audioTelemetry.capacity());
+            for (const AudioTelemetrySample& sample : samples) {
+                ts << AudioTelemetryRing::toCsv(sample) << "\n";
+            }
+            ts.flush();
+            if (!stopping) {
+                QThread::msleep(250);
+            }
+        }
+    });
+    m_audioTelemetryLogThread->setObjectName("AudioTelemetryLog");
+    m_audioTelemetryLogThread->start(QThread::LowPriority);
+}
+
+void AtariEmulator::stopAudioTelemetryLog()
+{
+    if (!m_audioTelemetryLogThread) {
+        return;
+    }
+    m_audioTelemetryLogStop.store(true);
+    m_audioTelemetryLogThread->wait();
+    delete m_audioTelemetryLogThread;
+    m_audioTelemetryLogThread = nullptr;
+}
+
 void AtariEmulator::setKbdJoy0Enabled(bool enabled)
 {
     m_kbdJoy0Enabled = enabled;
@@ -2849,6 +4071,7 @@ void AtariEmulator::updatePalColorSettings(double saturation, double contrast, d
 
     // Update the color palette
     Colours_Update();
+    m_paletteLutDirty.store(true);
 
     qDebug() << "PAL color settings updated:"
              << "Cont:" << COLOURS_PAL_setup.contrast
@@ -2868,6 +4091,7 @@ void AtariEmulator::updateNtscColorSettings(double saturation, double contrast,
 
     // Update the color palette
     Colours_Update();
+    m_paletteLutDirty.store(true);
 
     qDebug() << "NTSC color settings updated:"
              << "Cont:" << COLOURS_NTSC_setup.contrast
@@ -2889,11 +4113,12 @@ void AtariEmulator::updateArtifactSettings(const QString& artifactMode)
     } else if (artifactMode == "ntsc-new") {
         mode = ARTIFACT_NTSC_NEW;
     } else {
-        mode = ARTIFACT_NONE;
+        mode = ARTIFACT_NONE;  // includes "gpu-ntsc": EmulatorGLView decodes the artifacts
     }
     
     // Apply the artifact setting immediately
     ARTIFACT_Set(mode);
+    m_paletteLutDirty.store(true);
 }
 
 // FUTURE: Scanlines method (commented out - not working)
@@ -2904,6 +4129,29 @@ void AtariEmulator::updateArtifactSettings(const QString& artifactMode)
 // }
 
 void AtariEmulator::setEmulationSpeed(int percentage)
+{
+    m_userSpeedPercent.store(percentage, std::memory_order_relaxed);
+    if (m_speedBoosts.load(std::memory_order_relaxed) == 0) {
+        applyEmulationSpeed(percentage);
+    }
+}
+
+void AtariEmulator::beginSpeedBoost()
+{
+    if (m_speedBoosts.fetch_add(1, std::memory_order_relaxed) == 0) {
+        applyEmulationSpeed(0);
+    }
+}
+
+void AtariEmulator::endSpeedBoost()
+{
+    // The user may have changed the speed while boosted; that is the one to return to
+    if (m_speedBoosts.fetch_sub(1, std::memory_order_relaxed) == 1) {
+        applyEmulationSpeed(m_userSpeedPercent.load(std::memory_order_relaxed));
+    }
+}
+
+void AtariEmulator::applyEmulationSpeed(int percentage)
 {
     // Set the speed:
     // 0 = unlimited/host speed (maximum turbo)
@@ -2942,8 +4190,7 @@ void AtariEmulator::setEmulationSpeed(int percentage)
     // Recalculate m_frameTimeMs for the new speed so requestNextFrame() uses the
     // correct target interval immediately (unlimited uses nominal FPS for reference only).
     if (m_userRequestedSpeedMultiplier != 0.0) {
-        double baseFps = static_cast<double>(m_targetFps > 0 ? m_targetFps : 50);
-        m_frameTimeMs = static_cast<float>((1000.0 / baseFps) / m_userRequestedSpeedMultiplier);
+        m_frameTimeMs = static_cast<float>((1000.0 / pacedFps()) / m_userRequestedSpeedMultiplier);
     }
 
     qDebug() << "Speed set to" << percentage << "% (multiplier:" << m_userRequestedSpeedMultiplier
@@ -2952,6 +4199,27 @@ void AtariEmulator::setEmulationSpeed(int percentage)
              << "frameTimeMs:" << m_frameTimeMs << "ms";
 }
 
+void AtariEmulator::setDisplayRefreshLock(double refreshHz)
+{
+    m_displayRefreshHz = qMax(0.0, refreshHz);
+    // Same baseline reset as a speed change, so the schedule starts from now
+    m_firstFrameTime = std::chrono::steady_clock::now();
+    m_frameCount = 0;
+    if (m_userRequestedSpeedMultiplier != 0.0) {
+        m_frameTimeMs = static_cast<float>((1000.0 / pacedFps()) / m_userRequestedSpeedMultiplier);
+    }
+    qDebug() << "Display refresh lock:" << m_displayRefreshHz << "Hz - frames paced at" << pacedFps() << "fps";
+}
+
+double AtariEmulator::pacedFps() const
+{
+    const double nativeFps = static_cast<double>(m_targetFps > 0 ? m_targetFps : 50);
+    if (m_displayRefreshHz > 0.0 && qAbs(m_displayRefreshHz / nativeFps - 1.0) <= kRefreshLockTolerance) {
+        return m_displayRefreshHz;
+    }
+    return nativeFps;
+}
+
 int AtariEmulator::getCurrentEmulationSpeed() const
 {
     // Return the current emulation speed percentage
@@ -3060,15 +4328,167 @@ bool AtariEmulator::loadXexForDebug(const QString& filename)
                  << QString("%1").arg(CPU_regPC, 4, 16, QChar('0')).toUpper();
     }
     
+    // Seed the code analysis with the program's entry points, and pick up the
+    // assembler's label file (MADS .lab, ca65 .lbl) if it sits next to the XEX
+    m_codeAnalyzer.clearEntryPoints();
+    m_codeAnalyzer.addEntryPoint(entryPoint);
+    if (initad != 0x0000 && initad != 0xFFFF) {
+        m_codeAnalyzer.addEntryPoint(initad);
+    }
+    const QFileInfo xexInfo(filename);
+    for (const char* suffix : {".lab", ".lbl"}) {
+        const QString labelPath = xexInfo.path() + "/" + xexInfo.completeBaseName() + suffix;
+        if (QFileInfo::exists(labelPath) && m_codeAnalyzer.loadLabels(labelPath)) {
+            qDebug() << "Loaded debug labels from" << labelPath;
+            break;
+        }
+    }
+    m_codeAnalyzer.submit(mem, CPU_regPC);
+
     // Emit signal for debugger widget to handle (could set a temporary breakpoint)
     emit xexLoadedForDebug(entryPoint);
     
     return true;
 }
 
+bool AtariEmulator::fastLoadXex(const QByteArray& image, QString* error)
+{
+    const auto fail = [error](const QString& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+    if (!m_libatari800Initialized) {
+        return fail(QStringLiteral("Emulator not initialized"));
+    }
+    if (BINLOAD_bin_file != NULL || BINLOAD_start_binloading || m_runToAddress >= 0) {
+        return fail(QStringLiteral("A load or run-to is already in progress"));
+    }
+    XexImage xex;
+    QString parseError;
+    if (!xex.parse(image, &parseError)) {
+        return fail(parseError);
+    }
+
+    // Only plain RAM can be written behind the machine's back
+    const int ramTop = qMin(0xC000, MEMORY_ram_size * 1024);
+    if (xex.touches(ramTop, 0xFFFF)) {
+        return fail(QStringLiteral("Loads above $%1 (I/O, OS ROM or missing RAM)")
+                        .arg(ramTop - 1, 4, 16, QChar('0')).toUpper());
+    }
+    if (MEMORY_cartA0BF_enabled && xex.touches(0xA000, 0xBFFF)) {
+        return fail(QStringLiteral("Loads under BASIC or a cartridge at $A000-$BFFF"));
+    }
+    if (MEMORY_cart809F_enabled && xex.touches(0x8000, 0x9FFF)) {
+        return fail(QStringLiteral("Loads under a cartridge at $8000-$9FFF"));
+    }
+    // The warm-start return pushed below holds $01FE-$01FF through every INIT
+    // until the program's final RTS; a segment over it would send that RTS, or
+    // an INIT's, into whatever was loaded there
+    if (xex.touches(0x0100 + kFastLoadStackTop - 1, 0x01FF)) {
+        return fail(QStringLiteral("Loads over the return address on the stack at $01FE-$01FF"));
+    }
+
+    // The program takes over from whatever the OS was doing, as if DOS had
+    // just loaded it: fresh stack, interrupts on, binary mode
+    endMovieRecording();
+    cancelQueuedText();
+    libatari800_clear_breakpoint_halt(0);
+    m_watchHaltPending = false;
+    CPU_regS = kFastLoadStackTop;
+    const unsigned short warmStart = kFastLoadReturnAddress - 1;
+    MEMORY_mem[0x100 + CPU_regS--] = static_cast<unsigned char>(warmStart >> 8);
+    MEMORY_mem[0x100 + CPU_regS--] = static_cast<unsigned char>(warmStart & 0xFF);
+    CPU_regP &= ~0x0C;  // D and I
+
+    for (const XexImage::Segment& segment : xex.segments()) {
+        memcpy(MEMORY_mem + segment.start, segment.data.constData(), segment.data.size());
+        if (segment.initAddress >= 0 && !runFastLoadInit(static_cast<unsigned short>(segment.initAddress))) {
+            publishCurrentFrame();
+            return fail(QStringLiteral("INIT routine at $%1 did not return within %2 frames")
+                            .arg(segment.initAddress, 4, 16, QChar('0')).toUpper()
+                            .arg(kFastLoadInitMaxFrames));
+        }
+    }
+    CPU_regPC = static_cast<unsigned short>(xex.runAddress());
+    publishCurrentFrame();
+    return true;
+}
+
+bool AtariEmulator::runFastLoadInit(unsigned short address)
+{
+    // JSR with no caller: the routine's RTS lands on kFastLoadReturnAddress,
+    // armed as the only breakpoint so the core halts in front of it
+    const unsigned short returnAddress = kFastLoadReturnAddress - 1;
+    MEMORY_mem[0x100 + CPU_regS--] = static_cast<unsigned char>(returnAddress >> 8);
+    MEMORY_mem[0x100 + CPU_regS--] = static_cast<unsigned char>(returnAddress & 0xFF);
+    CPU_regPC = address;
+    std::fill(std::begin(m_armedBreakpointMap), std::end(m_armedBreakpointMap), 0);
+    m_armedBreakpointMap[kFastLoadReturnAddress >> 3] |= static_cast<unsigned char>(1u << (kFastLoadReturnAddress & 7));
+    libatari800_set_breakpoint_map(m_armedBreakpointMap);
+
+    bool returned = false;
+    for (int frame = 0; frame < kFastLoadInitMaxFrames && !returned; ++frame) {
+        input_template_t inputSnapshot;
+        {
+            QMutexLocker inputLock(&m_inputMutex);
+            inputSnapshot = m_currentInput;
+        }
+        libatari800_next_frame(&inputSnapshot);
+        advanceFrameCounter();
+        captureRewindSnapshotIfDue();
+        recordFrameChecksum();
+        returned = libatari800_get_breakpoint_halt() == kFastLoadReturnAddress;
+    }
+    libatari800_clear_breakpoint_halt(0);
+    updateBreakpointArming();
+    return returned;
+}
+
+bool AtariEmulator::fastLoadBasic(const QByteArray& program, QString* error)
+{
+    const auto fail = [error](const QString& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+    if (!m_libatari800Initialized) {
+        return fail(QStringLiteral("Emulator not initialized"));
+    }
+    if (!MEMORY_cartA0BF_enabled) {
+        return fail(QStringLiteral("BASIC is not enabled"));
+    }
+    BasicProgramImage basic;
+    QString parseError;
+    if (!basic.parse(program, &parseError)) {
+        return fail(parseError);
+    }
+
+    // LOMEM as BASIC set it up; the program has to end below the OS's MEMTOP
+    const quint16 lomem = MEMORY_mem[0x80] | (MEMORY_mem[0x81] << 8);
+    const int memTop = MEMORY_mem[0x2E5] | (MEMORY_mem[0x2E6] << 8);
+    if (lomem < 0x0700 || basic.endAddress(lomem) > memTop) {
+        return fail(QStringLiteral("Program does not fit between LOMEM $%1 and MEMTOP $%2")
+                        .arg(lomem, 4, 16, QChar('0')).toUpper()
+                        .arg(memTop, 4, 16, QChar('0')).toUpper());
+    }
+    memcpy(MEMORY_mem + lomem + basic.bodyOffset(), basic.body().constData(), basic.body().size());
+    const QByteArray zeroPage = basic.zeroPage(lomem);
+    memcpy(MEMORY_mem + BasicProgramImage::kZeroPageAddress, zeroPage.constData(), zeroPage.size());
+    return true;
+}
+
 void AtariEmulator::injectCharacter(char ch)
 {
     QMutexLocker inputLock(&m_inputMutex);
+    m_injectFromQueue = false;
+    startInjectedCharacterLocked(ch);
+}
+
+bool AtariEmulator::startInjectedCharacterLocked(char ch)
+{
     clearCurrentInputLocked();
     m_injectPostReleaseFrames = 0;
 
@@ -3235,12 +4655,13 @@ void AtariEmulator::injectCharacter(char ch)
         m_currentInput.keycode = AKEY_CIRCUMFLEX;
     } else {
         m_injectKeyFramesRemaining = 0;
-        return;
+        return false;
     }
 
     // Keep the key asserted for several emulator-thread frames only — never call
     // libatari800_next_frame() from here (main thread / TCP thread); it races processFrame().
     m_injectKeyFramesRemaining = kInjectKeyHoldFrameCount;
+    return true;
 }
 
 void AtariEmulator::injectAKey(int akeyCode)
@@ -3277,7 +4698,7 @@ bool AtariEmulator::injectionTimersIdleForTest() const
 bool AtariEmulator::isCharacterInjectionIdle() const
 {
     QMutexLocker inputLock(&m_inputMutex);
-    if (m_injectKeyFramesRemaining != 0 || m_injectPostReleaseFrames != 0)
+    if (m_injectKeyFramesRemaining != 0 || m_injectPostReleaseFrames != 0 || m_keyQueueActive)
         return false;
     // Also wait until the Atari OS has consumed the previous keystroke.
     // CH ($02FC = 764) holds 0xFF when no key is pending in the OS buffer.
@@ -3290,15 +4711,110 @@ bool AtariEmulator::isCharacterInjectionIdle() const
     return true;
 }
 
-void AtariEmulator::clearInput()
+void AtariEmulator::queueText(const QByteArray& latin1, bool turbo)
 {
-    QMutexLocker inputLock(&m_inputMutex);
-    clearCurrentInputLocked();
+    if (latin1.isEmpty()) {
+        return;
+    }
+    bool startTurbo = false;
+    {
+        QMutexLocker inputLock(&m_inputMutex);
+        m_keyQueue.reserve(m_keyQueue.size() + latin1.size());
+        for (char ch : latin1) {
+            m_keyQueue.append(QueuedKey{false, static_cast<unsigned char>(ch)});
+        }
+        m_keyQueueActive = true;
+        if (turbo && !m_keyQueueTurbo) {
+            m_keyQueueTurbo = true;
+            startTurbo = true;
+        }
+    }
+    if (startTurbo) {
+        beginSpeedBoost();
+    }
 }
 
-void AtariEmulator::setCapsLock(bool enabled)
+void AtariEmulator::queueAKey(int akeyCode)
 {
-    // Only toggle if the current state differs from desired state
+    QMutexLocker inputLock(&m_inputMutex);
+    m_keyQueue.append(QueuedKey{true, akeyCode});
+    m_keyQueueActive = true;
+}
+
+void AtariEmulator::cancelQueuedText()
+{
+    bool endTurbo = false;
+    {
+        QMutexLocker inputLock(&m_inputMutex);
+        m_keyQueue.clear();
+        m_keyQueueHead = 0;
+        m_keyQueueActive = false;
+        if (m_injectFromQueue && m_injectKeyFramesRemaining > 0) {
+            m_injectKeyFramesRemaining = 0;
+            clearCurrentInputLocked();
+        }
+        m_injectFromQueue = false;
+        endTurbo = m_keyQueueTurbo;
+        m_keyQueueTurbo = false;
+    }
+    if (endTurbo) {
+        endSpeedBoost();
+    }
+}
+
+int AtariEmulator::queuedKeyCount() const
+{
+    QMutexLocker inputLock(&m_inputMutex);
+    return m_keyQueue.size() - m_keyQueueHead;
+}
+
+bool AtariEmulator::advanceKeyQueueLocked()
+{
+    if (!m_keyQueueActive || m_injectKeyFramesRemaining > 0 || m_injectPostReleaseFrames > 0) {
+        return false;
+    }
+    if (m_keyQueueHead >= m_keyQueue.size()) {
+        // The last key is released
+        m_keyQueue.clear();
+        m_keyQueueHead = 0;
+        m_keyQueueActive = false;
+        m_injectFromQueue = false;
+        return true;
+    }
+    // Wait for the OS to take the previous key out of CH, or it would be overwritten
+    if (m_libatari800Initialized && MEMORY_mem[0x2FC] != 0xFF) {
+        return false;
+    }
+    while (m_keyQueueHead < m_keyQueue.size()) {
+        const QueuedKey key = m_keyQueue[m_keyQueueHead++];
+        m_injectPostReleaseFrames = 0;
+        bool started = true;
+        if (key.raw) {
+            clearCurrentInputLocked();
+            m_currentInput.keycode = key.akey;
+            m_injectKeyFramesRemaining = kInjectKeyHoldFrameCount;
+        } else {
+            started = startInjectedCharacterLocked(static_cast<char>(key.akey));
+        }
+        if (started) {
+            m_injectFromQueue = true;
+            m_lastQueuedKey = key.akey;
+            break;
+        }
+        // No Atari key for that character: skip it without spending a frame
+    }
+    return false;
+}
+
+void AtariEmulator::clearInput()
+{
+    QMutexLocker inputLock(&m_inputMutex);
+    clearCurrentInputLocked();
+}
+
+void AtariEmulator::setCapsLock(bool enabled)
+{
+    // Only toggle if the current state differs from desired state
     if (m_capsLockEnabled != enabled) {
         injectAKey(AKEY_CAPSTOGGLE);
         m_capsLockEnabled = enabled;
@@ -3357,8 +4873,12 @@ void AtariEmulator::pauseEmulation()
         QMetaObject::invokeMethod(this, "pauseEmulation", Qt::QueuedConnection);
         return;
     }
+    if (m_runToAddress >= 0) {
+        cancelRunTo();
+    }
     if (!m_emulationPaused) {
         m_frameTimer->stop();
+        m_frameDeadlineValid = false;
         {
             QMutexLocker inputLock(&m_inputMutex);
             clearCurrentInputLocked();
@@ -3368,6 +4888,9 @@ void AtariEmulator::pauseEmulation()
             m_directKeyPendingRelease  = false;
         }
         m_emulationPaused = true;
+        if (m_presentationPending) {
+            presentFrame();  // the last turbo frame was skipped; show where emulation stopped
+        }
         emit executionPaused();
     }
 }
@@ -3380,6 +4903,9 @@ void AtariEmulator::resumeEmulation()
         QMetaObject::invokeMethod(this, "resumeEmulation", Qt::QueuedConnection);
         return;
     }
+    if (m_runToAddress >= 0) {
+        cancelRunTo();
+    }
     if (m_emulationPaused) {
         // Reset absolute-time scheduler and PI state when resuming
         m_firstFrameTime = std::chrono::steady_clock::now();
@@ -3389,12 +4915,36 @@ void AtariEmulator::resumeEmulation()
         m_avgGap         = 0.0;
         requestNextFrame();
         m_emulationPaused = false;
-        // Reset last PC when resuming to avoid missing breakpoints
-        m_lastPC = 0xFFFF;
+        // Step off the breakpoint we are halted at so it doesn't fire again at once
+        libatari800_clear_breakpoint_halt(1);
+        m_watchHaltPending = false;
         emit executionResumed();
     }
 }
 
+void AtariEmulator::holdFrames()
+{
+    m_frameHoldDepth++;
+}
+
+void AtariEmulator::releaseFrames()
+{
+    if (m_frameHoldDepth == 0 || --m_frameHoldDepth > 0) {
+        return;
+    }
+    if (m_frameDeferredByHold) {
+        m_frameDeferredByHold = false;
+        if (!m_emulationPaused) {
+            // The absolute-time scheduler catches up (or resyncs) from here
+            m_frameTimer->start(0);
+        }
+    }
+    if (m_runToDeferredByHold) {
+        m_runToDeferredByHold = false;
+        QMetaObject::invokeMethod(this, "continueRunTo", Qt::QueuedConnection);
+    }
+}
+
 bool AtariEmulator::isEmulationPaused() const
 {
     return m_emulationPaused;
@@ -3404,6 +4954,8 @@ void AtariEmulator::stepOneFrame()
 {
     if (m_emulationPaused) {
         // Execute one frame manually when paused
+        libatari800_clear_breakpoint_halt(1);
+        m_watchHaltPending = false;
         processFrame();
         emit debugStepped();
     } else {
@@ -3420,7 +4972,15 @@ void AtariEmulator::stepOneInstruction()
         
         // Execute one frame
         // This will execute thousands of instructions, but it's all we have
+        endMovieRecording();
+        libatari800_clear_breakpoint_halt(1);
+        m_watchHaltPending = false;
+        reportInputChanges(m_currentInput);
         libatari800_next_frame(&m_currentInput);
+        advanceFrameCounter();
+        captureRewindSnapshotIfDue();
+        recordFrameChecksum();
+        collectInstructionTrace();
         
         // Check breakpoints after execution
         checkBreakpoints();
@@ -3434,6 +4994,127 @@ void AtariEmulator::stepOneInstruction()
     }
 }
 
+bool AtariEmulator::stepOver()
+{
+    if (!m_emulationPaused || !m_libatari800Initialized || m_runToAddress >= 0) {
+        return false;
+    }
+    const unsigned short pc = CPU_regPC;
+    const unsigned char* mem = libatari800_get_main_memory_ptr();
+    if (opcodeInfo6502(mem[pc]).flow != FlowKind6502::Call) {
+        // Not a JSR, nothing to step over
+        stepOneInstruction();
+        return false;
+    }
+    // The return lands after the JSR once RTS has popped the two bytes it pushes
+    runToAddress(static_cast<unsigned short>(pc + opcodeInfo6502(mem[pc]).bytes), CPU_regS);
+    return true;
+}
+
+void AtariEmulator::runToAddress(unsigned short address, int stackPointer)
+{
+    if (QThread::currentThread() != this->thread()) {
+        QMetaObject::invokeMethod(this, [this, address, stackPointer]() {
+            runToAddress(address, stackPointer);
+        }, Qt::QueuedConnection);
+        return;
+    }
+    if (!m_emulationPaused || !m_libatari800Initialized || m_runToAddress >= 0) {
+        return;
+    }
+    // The run's frames are not recorded, and the one it halts in idles out where
+    // a replay would run on
+    endMovieRecording();
+    m_runToAddress = address;
+    m_runToStackPointer = stackPointer;
+    updateBreakpointArming();
+    // Leave the instruction we may be halted on before arming the target
+    libatari800_clear_breakpoint_halt(1);
+    m_watchHaltPending = false;
+    continueRunTo();
+}
+
+void AtariEmulator::continueRunTo()
+{
+    if (m_runToAddress < 0 || !m_libatari800Initialized || m_shuttingDown.load()) {
+        return;
+    }
+    if (m_frameHoldDepth > 0) {
+        m_runToDeferredByHold = true;
+        return;
+    }
+
+    // Run unpaced in slices so pause/cancel requests and the GUI stay responsive
+    static constexpr int kRunToSliceMs = 50;
+    QElapsedTimer slice;
+    slice.start();
+    while (slice.elapsed() < kRunToSliceMs) {
+        if (!runDueScheduledActions()) {
+            return;  // pauseEmulation() cancelled the run
+        }
+        input_template_t inputSnapshot;
+        {
+            QMutexLocker inputLock(&m_inputMutex);
+            inputSnapshot = m_currentInput;
+        }
+        reportInputChanges(inputSnapshot);
+        libatari800_next_frame(&inputSnapshot);
+        advanceFrameCounter();
+        captureRewindSnapshotIfDue();
+        recordFrameChecksum();
+        collectInstructionTrace();
+
+        const int haltPC = libatari800_get_breakpoint_halt();
+        if (haltPC < 0) {
+            continue;
+        }
+        if (haltPC == m_runToAddress) {
+            // Deeper recursion of the same routine reaches the return address with
+            // a lower stack pointer than the caller's.
+            const unsigned char depth = static_cast<unsigned char>(m_runToStackPointer - CPU_regS);
+            if (m_runToStackPointer < 0 || depth == 0 || depth >= 0x80) {
+                finishRunTo(true);
+                return;
+            }
+            if (!m_watchHaltPending && !(m_breakpointsEnabled && hasBreakpoint(static_cast<unsigned short>(haltPC)))) {
+                libatari800_clear_breakpoint_halt(1);
+                continue;
+            }
+        }
+        // An enabled user breakpoint (or watchpoint) inside the routine ends the run there
+        finishRunTo(false);
+        reportHalt(static_cast<unsigned short>(haltPC));
+        return;
+    }
+
+    publishCurrentFrame();
+    QMetaObject::invokeMethod(this, "continueRunTo", Qt::QueuedConnection);
+}
+
+void AtariEmulator::cancelRunTo()
+{
+    if (QThread::currentThread() != this->thread()) {
+        QMetaObject::invokeMethod(this, "cancelRunTo", Qt::QueuedConnection);
+        return;
+    }
+    if (m_runToAddress >= 0) {
+        finishRunTo(false);
+    }
+}
+
+void AtariEmulator::finishRunTo(bool reachedTarget)
+{
+    m_runToAddress = -1;
+    m_runToStackPointer = -1;
+    // Keeps the halt (if any): CPU_regPC stays on the instruction we stopped in front of
+    updateBreakpointArming();
+    publishCurrentFrame();
+    emit runToFinished(CPU_regPC, reachedTarget);
+    if (reachedTarget) {
+        emit debugStepped();
+    }
+}
+
 double AtariEmulator::calculateSpeedAdjustment()
 {
     // PI controller: measures DSP ring-buffer fill vs. target and returns a
@@ -3449,7 +5130,7 @@ double AtariEmulator::calculateSpeedAdjustment()
     if (m_audioBackend != QtAudio || !m_audioEnabled || !m_audioOutput)
         return 0.0;
 
-    int bufferedBytes   = (m_dspWritePos - m_dspReadPos + m_dspBufferBytes) % m_dspBufferBytes;
+    int bufferedBytes   = m_dspRing.available();
     int bufferedSamples = bufferedBytes / m_bytesPerSample;
     double error        = static_cast<double>(m_targetDelay - bufferedSamples);
 
@@ -3496,9 +5177,8 @@ void AtariEmulator::updateEmulationSpeed()
     // Feed correction into the absolute-time scheduler by adjusting the effective
     // frame time.  The scheduler in requestNextFrame() reads m_frameTimeMs, so
     // changing it here naturally shifts every future frame's target time.
-    // Base frame time = 1000ms / targetFPS; divide by combined speed multiplier.
-    double baseFps = static_cast<double>(m_targetFps);
-    m_frameTimeMs  = static_cast<float>((1000.0 / baseFps) / m_currentSpeed);
+    // Base frame time = 1000ms / pacedFps(); divide by combined speed multiplier.
+    m_frameTimeMs  = static_cast<float>((1000.0 / pacedFps()) / m_currentSpeed);
 }
 
 void AtariEmulator::setDiskActivityCallback(std::function<void(int, bool)> callback)
@@ -3832,370 +5512,1219 @@ void AtariEmulator::debugSIOPatchStatus() const
     #endif
 }
 
-// Printer support functions
-void AtariEmulator::setPrinterEnabled(bool enabled)
+// Printer support functions
+void AtariEmulator::setPrinterEnabled(bool enabled)
+{
+    if (m_printerEnabled != enabled) {
+        m_printerEnabled = enabled;
+        
+        // Note: P: device setup is now handled during emulator initialization
+        // Printer enable/disable changes trigger a full emulator restart via SettingsDialog
+    }
+}
+
+bool AtariEmulator::isPrinterEnabled() const
+{
+    return m_printerEnabled;
+}
+
+void AtariEmulator::setPrinterOutputCallback(std::function<void(const QString&)> callback)
+{
+    m_printerOutputCallback = callback;
+}
+
+void AtariEmulator::setPrintCommand(const QString& command)
+{
+    if (!command.isEmpty()) {
+        Devices_SetPrintCommand(command.toUtf8().constData());
+    }
+}
+
+// Joystick control methods for TCP server
+void AtariEmulator::setJoystickState(int player, int direction, bool fire)
+{
+    if (player < 1 || player > 2) {
+        qWarning() << "Invalid joystick player:" << player << "- must be 1 or 2";
+        return;
+    }
+    
+    // Direction should be pre-inverted value (0-255) or we can accept 0-15 and invert here
+    // Let's accept both: if direction <= 15, assume it needs inversion
+    int invertedDirection = direction;
+    if (direction <= 15) {
+        invertedDirection = direction ^ 0xff;  // Invert for libatari800
+    }
+    m_inputLatency.markInput(InputLatencyMonitor::Joystick);
+    
+    if (player == 1) {
+        m_currentInput.joy0 = invertedDirection;
+        m_currentInput.trig0 = fire ? 1 : 0;  // 1 = pressed (inverted for libatari800)
+    } else {
+        m_currentInput.joy1 = invertedDirection;
+        m_currentInput.trig1 = fire ? 1 : 0;  // 1 = pressed (inverted for libatari800)
+    }
+}
+
+void AtariEmulator::releaseJoystick(int player)
+{
+    if (player < 1 || player > 2) {
+        qWarning() << "Invalid joystick player:" << player << "- must be 1 or 2";
+        return;
+    }
+    
+    const int CENTER = 0x0f ^ 0xff;  // Center position inverted for libatari800
+    
+    if (player == 1) {
+        m_currentInput.joy0 = CENTER;
+        m_currentInput.trig0 = 0;  // 0 = released (inverted for libatari800)
+    } else {
+        m_currentInput.joy1 = CENTER;
+        m_currentInput.trig1 = 0;  // 0 = released (inverted for libatari800)
+    }
+}
+
+// Joystick monitoring methods for TCP server
+int AtariEmulator::getJoystickState(int player) const
+{
+    if (player == 1) {
+        return m_currentInput.joy0;
+    } else if (player == 2) {
+        return m_currentInput.joy1;
+    }
+    return 0x0f ^ 0xff;  // Return center if invalid player
+}
+
+bool AtariEmulator::getJoystickFire(int player) const
+{
+    if (player == 1) {
+        return m_currentInput.trig0 == 1;  // 1 = pressed in our inverted logic
+    } else if (player == 2) {
+        return m_currentInput.trig1 == 1;  // 1 = pressed in our inverted logic
+    }
+    return false;
+}
+
+QString AtariEmulator::joystickDirectionName(int value)
+{
+    // These are the inverted values we use
+    switch (value) {
+        case 0x0f ^ 0xff: return "CENTER";      // 240
+        case 0x0e ^ 0xff: return "UP";          // 241
+        case 0x0d ^ 0xff: return "DOWN";        // 242
+        case 0x0b ^ 0xff: return "LEFT";        // 244
+        case 0x07 ^ 0xff: return "RIGHT";       // 248
+        case 0x0a ^ 0xff: return "UP_LEFT";     // 245
+        case 0x06 ^ 0xff: return "UP_RIGHT";    // 249
+        case 0x09 ^ 0xff: return "DOWN_LEFT";   // 246
+        case 0x05 ^ 0xff: return "DOWN_RIGHT";  // 250
+        default: return QString("UNKNOWN_%1").arg(value);
+    }
+}
+
+QJsonObject AtariEmulator::getAllJoystickStates() const
+{
+    QJsonObject result;
+    
+    // Joystick 1
+    QJsonObject joy1;
+    joy1["direction"] = joystickDirectionName(m_currentInput.joy0);
+    joy1["direction_value"] = m_currentInput.joy0;
+    joy1["fire"] = (m_currentInput.trig0 == 1);  // 1 = pressed in our inverted logic
+    joy1["keyboard_enabled"] = m_kbdJoy0Enabled;
+    joy1["keyboard_keys"] = m_swapJoysticks ? m_joystick1Preset : m_joystick0Preset;
+    
+    // Joystick 2
+    QJsonObject joy2;
+    joy2["direction"] = joystickDirectionName(m_currentInput.joy1);
+    joy2["direction_value"] = m_currentInput.joy1;
+    joy2["fire"] = (m_currentInput.trig1 == 1);  // 1 = pressed in our inverted logic
+    joy2["keyboard_enabled"] = m_kbdJoy1Enabled;
+    joy2["keyboard_keys"] = m_swapJoysticks ? m_joystick0Preset : m_joystick1Preset;
+    
+    result["joystick1"] = joy1;
+    result["joystick2"] = joy2;
+    result["swapped"] = m_swapJoysticks;
+    result["joystick_input_enabled"] = m_joystickInputEnabled.load();
+    
+    return result;
+}
+
+bool AtariEmulator::saveState(const QString& filename)
+{
+    // Pause emulation during save
+    bool wasPaused = m_emulationPaused;
+    if (!wasPaused) {
+        pauseEmulation();
+    }
+    
+    const QByteArray rawState = snapshotState();
+    
+    // Resume if we weren't paused before
+    if (!wasPaused) {
+        resumeEmulation();
+    }
+    
+    if (!StateFileWorker::writeStateFile(filename, rawState, m_currentProfileName)) {
+        qWarning() << "Failed to save state to:" << filename;
+        return false;
+    }
+    return true;
+}
+
+int AtariEmulator::saveStateToBuffer(UBYTE* buffer)
+{
+    // Set up the global buffer pointer that libatari800 expects
+    extern UBYTE* LIBATARI800_StateSav_buffer;
+    extern statesav_tags_t* LIBATARI800_StateSav_tags;
+    LIBATARI800_StateSav_buffer = buffer;
+    
+    // Create tags structure
+    statesav_tags_t tags;
+    memset(&tags, 0, sizeof(tags));
+    LIBATARI800_StateSav_tags = &tags;
+    
+    // Save state to buffer
+    extern void LIBATARI800_StateSave(UBYTE *buffer, statesav_tags_t *tags);
+    LIBATARI800_StateSave(buffer, &tags);
+    
+    LIBATARI800_StateSav_buffer = nullptr;
+    LIBATARI800_StateSav_tags = nullptr;
+    
+    // Get actual size of saved data; fall back to max size if the size tag wasn't set
+    return tags.size != 0 ? static_cast<int>(tags.size) : STATESAV_MAX_SIZE;
+}
+
+void AtariEmulator::loadStateFromBuffer(const UBYTE* buffer)
+{
+    // Set up the global buffer pointer that libatari800 expects
+    extern UBYTE* LIBATARI800_StateSav_buffer;
+    UBYTE* data = const_cast<UBYTE*>(buffer);  // StateLoad only reads
+    LIBATARI800_StateSav_buffer = data;
+    
+    extern void LIBATARI800_StateLoad(UBYTE *buffer);
+    const int tvMode = Atari800_tv_mode;
+    LIBATARI800_StateLoad(data);
+    
+    LIBATARI800_StateSav_buffer = nullptr;
+
+    // A state from the other TV system switches it, which rebuilds Colours_table;
+    // run-ahead and rewind restores of this machine's own states never do
+    if (Atari800_tv_mode != tvMode) {
+        m_paletteLutDirty.store(true);
+    }
+
+    // The restored CPU is no longer sitting on the halted instruction
+    libatari800_clear_breakpoint_halt(0);
+    m_watchHaltPending = false;
+}
+
+bool AtariEmulator::loadState(const QString& filename)
+{
+    // Check if state file exists
+    QFileInfo stateFile(filename);
+    if (!stateFile.exists()) {
+        qWarning() << "State file does not exist:" << filename;
+        return false;
+    }
+    
+    QByteArray rawState;
+    QString profileName;
+    if (!StateFileWorker::readStateFile(filename, rawState, profileName)) {
+        return false;
+    }
+    
+    // Pause emulation during load
+    bool wasPaused = m_emulationPaused;
+    if (!wasPaused) {
+        pauseEmulation();
+    }
+    
+    endMovieRecording();
+    loadStateFromBuffer(reinterpret_cast<const UBYTE*>(rawState.constData()));
+    
+    // Resume if we weren't paused before
+    if (!wasPaused) {
+        resumeEmulation();
+    }
+    
+    if (!profileName.isEmpty()) {
+        m_currentProfileName = profileName;
+    }
+    
+    return true;
+}
+
+QByteArray AtariEmulator::snapshotState()
+{
+    // One copy of the state; the size tag trims it to what StateSave actually wrote
+    QByteArray rawState(STATESAV_MAX_SIZE, Qt::Uninitialized);
+    const int stateSize = saveStateToBuffer(reinterpret_cast<UBYTE*>(rawState.data()));
+    rawState.resize(stateSize);
+    return rawState;
+}
+
+void AtariEmulator::saveStateAsync(const QString& filename)
+{
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, [this, filename]() { saveStateAsync(filename); }, Qt::QueuedConnection);
+        return;
+    }
+    if (!m_libatari800Initialized) {
+        emit stateSaved(filename, false);
+        return;
+    }
+    // Between frames on the emulator thread, so no pause is needed for a consistent snapshot
+    const QByteArray rawState = snapshotState();
+    QMetaObject::invokeMethod(m_stateIoWorker, "save", Qt::QueuedConnection,
+                              Q_ARG(QString, filename), Q_ARG(QByteArray, rawState),
+                              Q_ARG(QString, m_currentProfileName));
+}
+
+void AtariEmulator::loadStateAsync(const QString& filename)
+{
+    QMetaObject::invokeMethod(m_stateIoWorker, "load", Qt::QueuedConnection, Q_ARG(QString, filename));
+}
+
+void AtariEmulator::onStateFileLoaded(const QString& filename, const QByteArray& rawState,
+                                      const QString& profileName, bool success)
+{
+    if (!success || !m_libatari800Initialized || rawState.size() > STATESAV_MAX_SIZE) {
+        emit stateLoaded(filename, false);
+        return;
+    }
+    endMovieRecording();
+    loadStateFromBuffer(reinterpret_cast<const UBYTE*>(rawState.constData()));
+    if (!profileName.isEmpty()) {
+        m_currentProfileName = profileName;
+    }
+    emit stateLoaded(filename, true);
+}
+
+QJsonObject AtariEmulator::hibernateMedia() const
+{
+    QJsonObject media;
+    QJsonArray disks;
+    for (const QString& disk : m_diskImages) {
+        disks.append(disk);
+    }
+    media["disks"] = disks;
+    media["cartridge"] = QString::fromLocal8Bit(CARTRIDGE_main.filename);
+    media["cassette"] = m_cassettePath;
+    return media;
+}
+
+bool AtariEmulator::hibernate(const QString& path)
+{
+    if (!m_libatari800Initialized) {
+        return false;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    QJsonObject metadata;
+    metadata["boot_config"] = m_bootConfig;
+    metadata["media"] = hibernateMedia();
+    metadata["profile"] = m_currentProfileName;
+    metadata["frame"] = static_cast<qint64>(m_emulatedFrames);
+    metadata["version"] = QCoreApplication::applicationVersion();
+    metadata["saved_at"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    const bool written = HibernateImage::write(path, metadata, snapshotState());
+    qDebug() << "Hibernate to" << path << (written ? "written in" : "failed after") << timer.elapsed() << "ms";
+    return written;
+}
+
+QJsonObject AtariEmulator::resumeFromHibernation(const QString& path)
+{
+    QJsonObject result;
+    result["resumed"] = false;
+    HibernateImage image;
+    if (!image.open(path)) {
+        result["reason"] = image.errorString();
+        return result;
+    }
+    // Consumed either way; the mapping stays valid after the unlink on every platform
+    // but Windows, where the file is removed once it is closed below
+    const bool removed = QFile::remove(path);
+
+    const QJsonObject metadata = image.metadata();
+    QString reason;
+    if (!m_libatari800Initialized) {
+        reason = "emulator not initialized";
+    } else if (metadata["boot_config"].toObject() != m_bootConfig) {
+        reason = "boot settings changed";
+    } else if (metadata["media"].toObject() != hibernateMedia()) {
+        reason = "mounted media changed";
+    } else if (metadata["profile"].toString() != m_currentProfileName) {
+        reason = "profile changed";
+    } else if (metadata["version"].toString() != QCoreApplication::applicationVersion()) {
+        reason = "written by another version";
+    } else if (image.stateSize() > STATESAV_MAX_SIZE) {
+        reason = "state too large";
+    }
+    if (reason.isEmpty()) {
+        endMovieRecording();
+        loadStateFromBuffer(image.stateData());
+        m_emulatedFrames = static_cast<quint64>(metadata["frame"].toVariant().toLongLong());
+        // The restored machine is past its boot, FujiNet's included
+        m_pendingFujiNetBoot = false;
+        m_firstFrameTime = std::chrono::steady_clock::now();
+        m_frameCount = 0;
+        result["resumed"] = true;
+        result["frame"] = metadata["frame"];
+        result["saved_at"] = metadata["saved_at"];
+    } else {
+        result["reason"] = reason;
+    }
+    image.close();
+    if (!removed) {
+        QFile::remove(path);
+    }
+    return result;
+}
+
+bool AtariEmulator::quickSaveState()
+{
+    QString quickSavePath = getQuickSaveStatePath();
+    saveStateAsync(quickSavePath);
+    return true;
+}
+
+bool AtariEmulator::quickLoadState()
+{
+    QString quickSavePath = getQuickSaveStatePath();
+    if (!QFileInfo::exists(quickSavePath)) {
+        qWarning() << "Quick save state does not exist";
+        return false;
+    }
+    loadStateAsync(quickSavePath);
+    return true;
+}
+
+void AtariEmulator::configureRewind(bool enabled, int intervalFrames, int budgetMB)
+{
+    m_rewindInterval = qBound(1, intervalFrames, 600);
+    m_rewindFramesUntilSnapshot = 0;
+    if (!enabled) {
+        m_rewindBuffer.reset();
+        m_rewindScratch.reset();
+        return;
+    }
+    const qint64 budgetBytes = static_cast<qint64>(qBound(1, budgetMB, 1024)) * 1024 * 1024;
+    if (!m_rewindBuffer || m_rewindBuffer->budgetBytes() != budgetBytes) {
+        m_rewindScratch.reset(new UBYTE[STATESAV_MAX_SIZE]);
+        m_rewindBuffer.reset(new RewindBuffer(STATESAV_MAX_SIZE, budgetBytes));
+    }
+}
+
+void AtariEmulator::captureRewindSnapshotIfDue()
+{
+    if (!m_rewindBuffer || --m_rewindFramesUntilSnapshot > 0) {
+        return;
+    }
+    m_rewindFramesUntilSnapshot = m_rewindInterval;
+    const int size = saveStateToBuffer(m_rewindScratch.get());
+    m_rewindBuffer->push(m_rewindScratch.get(), size, m_emulatedFrames);
+}
+
+void AtariEmulator::setRunAheadFrames(int frames)
+{
+    const int maxFrames = kMaxRunAheadFrames;  // qBound takes references
+    m_runAheadFrames.store(qBound(0, frames, maxFrames), std::memory_order_relaxed);
+}
+
+QJsonObject AtariEmulator::getRunAheadStatus() const
+{
+    QJsonObject status;
+    status["frames"] = runAheadFrames();
+    status["active"] = m_runAheadActive.load(std::memory_order_relaxed);
+    return status;
+}
+
+void AtariEmulator::noteDiskActivity(int drive, bool writing)
+{
+    if (m_runningAhead || drive < 1 || drive > kDriveActivitySlots) {
+        return;
+    }
+    // One relaxed store per access; the GUI samples these at display rate
+    const qint64 nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    m_driveActivityMs[drive - 1].store(writing ? -nowMs : nowMs, std::memory_order_relaxed);
+}
+
+bool AtariEmulator::driveActivity(int drive, int holdMs, bool* writing) const
+{
+    if (drive < 1 || drive > kDriveActivitySlots) {
+        return false;
+    }
+    const qint64 stamp = m_driveActivityMs[drive - 1].load(std::memory_order_relaxed);
+    if (stamp == 0) {
+        return false;
+    }
+    const qint64 nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (writing) {
+        *writing = stamp < 0;
+    }
+    return nowMs - qAbs(stamp) <= holdMs;
+}
+
+void AtariEmulator::runAhead(const input_template_t& frameInput)
+{
+    const int frames = runAheadFrames();
+    // Frames with outside side effects (NetSIO, the printer) must run exactly
+    // once, breakpoints must stop on the real frame, traces and profiles must
+    // only see real frames, restoring the state would re-open attached media,
+    // and at other speeds than 1x there is no input lag worth the extra CPU time
+    const bool active = frames > 0 && !mediaAttached() && !m_emulationPaused &&
+                        m_userRequestedSpeedMultiplier == 1.0 && !m_netSIOEnabled && !m_printerEnabled &&
+                        !(m_breakpointsEnabled && m_breakpointCount > 0) && m_runToAddress < 0 &&
+                        m_watchpoints.isEmpty() && !m_traceRecorder.isRecording() && !m_profiling.load();
+    m_runAheadActive.store(active, std::memory_order_relaxed);
+    if (!active) {
+        return;
+    }
+
+    if (!m_runAheadState) {
+        m_runAheadState.reset(new UBYTE[STATESAV_MAX_SIZE]);
+    }
+    saveStateToBuffer(m_runAheadState.get());
+    m_runningAhead = true;
+    for (int i = 0; i < frames; ++i) {
+        input_template_t input = frameInput;
+        libatari800_next_frame(&input);
+    }
+    m_runningAhead = false;
+    // The screen buffer is not part of the saved state, so it keeps the last
+    // ahead frame for rendering; the sound they produced is simply not queued
+    loadStateFromBuffer(m_runAheadState.get());
+}
+
+bool AtariEmulator::rewindSteps(int steps)
+{
+    if (!m_rewindBuffer || !m_libatari800Initialized) {
+        return false;
+    }
+    int size = 0;
+    quint64 frame = 0;
+    const unsigned char* state = m_rewindBuffer->rewind(steps, &size, &frame);
+    if (!state) {
+        return false;
+    }
+    endMovieRecording();
+    loadStateFromBuffer(state);
+    m_emulatedFrames = frame;
+    m_rewindFramesUntilSnapshot = m_rewindInterval;
+    {
+        QMutexLocker inputLock(&m_inputMutex);
+        clearCurrentInputLocked();
+    }
+    // Show the restored screen even while paused
+    publishCurrentFrame();
+    return true;
+}
+
+void AtariEmulator::publishCurrentFrame()
+{
+    presentFrame(true);
+    publishScreenStreamFrame(true);
+}
+
+bool AtariEmulator::rewindFrames(int frames)
+{
+    if (!m_rewindBuffer || m_rewindBuffer->depth() == 0) {
+        return false;
+    }
+    // Newest snapshot at or before the target frame, or the oldest one kept
+    const quint64 target = m_emulatedFrames > static_cast<quint64>(qMax(0, frames))
+        ? m_emulatedFrames - static_cast<quint64>(qMax(0, frames)) : 0;
+    const int depth = m_rewindBuffer->depth();
+    int steps = 0;
+    while (steps + 1 < depth && m_rewindBuffer->frameAt(steps) > target) {
+        steps++;
+    }
+    return rewindSteps(steps);
+}
+
+QJsonObject AtariEmulator::getRewindStatus() const
+{
+    QJsonObject status;
+    status["enabled"] = m_rewindBuffer != nullptr;
+    status["interval_frames"] = m_rewindInterval;
+    status["current_frame"] = static_cast<qint64>(m_emulatedFrames);
+    if (m_rewindBuffer) {
+        const int depth = m_rewindBuffer->depth();
+        status["snapshots"] = depth;
+        status["oldest_frame"] = depth > 0 ? static_cast<qint64>(m_rewindBuffer->frameAt(depth - 1)) : 0;
+        status["used_bytes"] = m_rewindBuffer->usedBytes();
+        status["budget_bytes"] = m_rewindBuffer->budgetBytes();
+    }
+    return status;
+}
+
+QString AtariEmulator::getQuickSaveStatePath() const
+{
+    // Use the application's data directory for quick saves
+    QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir dir(dataPath);
+    if (!dir.exists()) {
+        dir.mkpath(".");
+    }
+    return dir.filePath("quicksave.a8s");
+}
+
+QString AtariEmulator::getHibernatePath() const
+{
+    // Next to the quick save; not a save state, so not offered in any file dialog
+    return QFileInfo(getQuickSaveStatePath()).dir().filePath("hibernate.fjh");
+}
+
+// Breakpoint management - core debugging support
+void AtariEmulator::addBreakpoint(unsigned short address)
+{
+    unsigned char& byte = m_breakpointMap[address >> 3];
+    const unsigned char bit = static_cast<unsigned char>(1u << (address & 7));
+    if (!(byte & bit)) {
+        byte |= bit;
+        m_breakpointCount++;
+        updateBreakpointArming();
+        emit breakpointAdded(address);
+    }
+}
+
+void AtariEmulator::removeBreakpoint(unsigned short address)
+{
+    unsigned char& byte = m_breakpointMap[address >> 3];
+    const unsigned char bit = static_cast<unsigned char>(1u << (address & 7));
+    if (byte & bit) {
+        byte &= static_cast<unsigned char>(~bit);
+        m_breakpointCount--;
+        updateBreakpointArming();
+        emit breakpointRemoved(address);
+    }
+}
+
+void AtariEmulator::clearAllBreakpoints()
+{
+    if (m_breakpointCount > 0) {
+        std::fill(std::begin(m_breakpointMap), std::end(m_breakpointMap), 0);
+        m_breakpointCount = 0;
+        updateBreakpointArming();
+        emit breakpointsCleared();
+    }
+}
+
+bool AtariEmulator::hasBreakpoint(unsigned short address) const
+{
+    return m_breakpointMap[address >> 3] & (1u << (address & 7));
+}
+
+QSet<unsigned short> AtariEmulator::getBreakpoints() const
+{
+    QSet<unsigned short> breakpoints;
+    breakpoints.reserve(m_breakpointCount);
+    for (int byte = 0; byte < static_cast<int>(sizeof(m_breakpointMap)); ++byte) {
+        for (int bit = 0; m_breakpointMap[byte] && bit < 8; ++bit) {
+            if (m_breakpointMap[byte] & (1u << bit)) {
+                breakpoints.insert(static_cast<unsigned short>((byte << 3) | bit));
+            }
+        }
+    }
+    return breakpoints;
+}
+
+void AtariEmulator::setBreakpointsEnabled(bool enabled)
+{
+    m_breakpointsEnabled = enabled;
+    updateBreakpointArming();
+}
+
+bool AtariEmulator::areBreakpointsEnabled() const
+{
+    return m_breakpointsEnabled;
+}
+
+void AtariEmulator::updateBreakpointArming()
+{
+    if (m_runToAddress >= 0) {
+        if (m_breakpointsEnabled) {
+            std::copy(std::begin(m_breakpointMap), std::end(m_breakpointMap), m_armedBreakpointMap);
+        } else {
+            std::fill(std::begin(m_armedBreakpointMap), std::end(m_armedBreakpointMap), 0);
+        }
+        m_armedBreakpointMap[m_runToAddress >> 3] |= static_cast<unsigned char>(1u << (m_runToAddress & 7));
+        libatari800_set_breakpoint_map(m_armedBreakpointMap);
+        return;
+    }
+    // Unarmed runs pay only a NULL test per instruction in the CPU core
+    const bool armed = m_breakpointsEnabled && m_breakpointCount > 0;
+    libatari800_set_breakpoint_map(armed ? m_breakpointMap : nullptr);
+}
+
+void AtariEmulator::checkBreakpoints()
+{
+    if (m_emulationPaused) {
+        return;
+    }
+
+    // The core halts in front of a flagged instruction and idles out the frame,
+    // so CPU_regPC and the other registers reflect the breakpoint exactly.
+    const int haltPC = libatari800_get_breakpoint_halt();
+    if (haltPC >= 0) {
+        pauseEmulation();
+        reportHalt(static_cast<unsigned short>(haltPC));
+    }
+}
+
+void AtariEmulator::reportHalt(unsigned short pc)
+{
+    if (m_watchHaltPending) {
+        m_watchHaltPending = false;
+        emit watchpointHit(pc, m_watchHitAddress, m_watchHitAccess);
+    } else {
+        emit breakpointHit(pc);
+    }
+}
+
+int AtariEmulator::addWatchpoint(int start, int end, int access, bool breakOnHit)
+{
+    access &= AccessTraceRing::AccessRead | AccessTraceRing::AccessWrite | AccessTraceRing::AccessExecute;
+    if (start < 0 || end > 0xFFFF || start > end || access == 0) {
+        return -1;
+    }
+    const int id = m_nextWatchpointId++;
+    m_watchpoints.append({id, static_cast<quint16>(start), static_cast<quint16>(end),
+                          static_cast<quint8>(access), breakOnHit});
+    rebuildWatchMap();
+    return id;
+}
+
+bool AtariEmulator::removeWatchpoint(int id)
+{
+    for (int i = 0; i < m_watchpoints.size(); ++i) {
+        if (m_watchpoints.at(i).id == id) {
+            m_watchpoints.removeAt(i);
+            rebuildWatchMap();
+            return true;
+        }
+    }
+    return false;
+}
+
+void AtariEmulator::clearWatchpoints()
 {
-    if (m_printerEnabled != enabled) {
-        m_printerEnabled = enabled;
-        
-        // Note: P: device setup is now handled during emulator initialization
-        // Printer enable/disable changes trigger a full emulator restart via SettingsDialog
-    }
+    m_watchpoints.clear();
+    rebuildWatchMap();
 }
 
-bool AtariEmulator::isPrinterEnabled() const
+QJsonArray AtariEmulator::getWatchpoints() const
 {
-    return m_printerEnabled;
+    QJsonArray list;
+    for (const Watchpoint& watchpoint : m_watchpoints) {
+        QJsonObject entry;
+        entry["id"] = watchpoint.id;
+        entry["start"] = watchpoint.start;
+        entry["end"] = watchpoint.end;
+        entry["access"] = watchpoint.access;
+        entry["break"] = watchpoint.breakOnHit;
+        list.append(entry);
+    }
+    return list;
 }
 
-void AtariEmulator::setPrinterOutputCallback(std::function<void(const QString&)> callback)
+int AtariEmulator::scheduleAction(quint64 frame, const QString& type, const QJsonObject& params)
 {
-    m_printerOutputCallback = callback;
+    const int id = m_nextScheduledActionId++;
+    // QMultiMap::insert() puts equal keys in front; keep same-frame actions in call order
+    auto position = m_scheduledActions.upperBound(frame);
+    m_scheduledActions.insert(position, frame, {id, type, params});
+    return id;
 }
 
-void AtariEmulator::setPrintCommand(const QString& command)
+bool AtariEmulator::cancelScheduledAction(int id)
 {
-    if (!command.isEmpty()) {
-        Devices_SetPrintCommand(command.toUtf8().constData());
+    for (auto it = m_scheduledActions.begin(); it != m_scheduledActions.end(); ++it) {
+        if (it.value().id == id) {
+            m_scheduledActions.erase(it);
+            return true;
+        }
     }
+    return false;
 }
 
-// Joystick control methods for TCP server
-void AtariEmulator::setJoystickState(int player, int direction, bool fire)
+void AtariEmulator::clearScheduledActions()
 {
-    if (player < 1 || player > 2) {
-        qWarning() << "Invalid joystick player:" << player << "- must be 1 or 2";
-        return;
-    }
-    
-    // Direction should be pre-inverted value (0-255) or we can accept 0-15 and invert here
-    // Let's accept both: if direction <= 15, assume it needs inversion
-    int invertedDirection = direction;
-    if (direction <= 15) {
-        invertedDirection = direction ^ 0xff;  // Invert for libatari800
-    }
-    
-    if (player == 1) {
-        m_currentInput.joy0 = invertedDirection;
-        m_currentInput.trig0 = fire ? 1 : 0;  // 1 = pressed (inverted for libatari800)
-    } else {
-        m_currentInput.joy1 = invertedDirection;
-        m_currentInput.trig1 = fire ? 1 : 0;  // 1 = pressed (inverted for libatari800)
-    }
+    m_scheduledActions.clear();
 }
 
-void AtariEmulator::releaseJoystick(int player)
+QJsonArray AtariEmulator::getScheduledActions() const
 {
-    if (player < 1 || player > 2) {
-        qWarning() << "Invalid joystick player:" << player << "- must be 1 or 2";
-        return;
-    }
-    
-    const int CENTER = 0x0f ^ 0xff;  // Center position inverted for libatari800
-    
-    if (player == 1) {
-        m_currentInput.joy0 = CENTER;
-        m_currentInput.trig0 = 0;  // 0 = released (inverted for libatari800)
-    } else {
-        m_currentInput.joy1 = CENTER;
-        m_currentInput.trig1 = 0;  // 0 = released (inverted for libatari800)
-    }
+    QJsonArray list;
+    for (auto it = m_scheduledActions.cbegin(); it != m_scheduledActions.cend(); ++it) {
+        QJsonObject entry;
+        entry["id"] = it.value().id;
+        entry["frame"] = static_cast<qint64>(it.key());
+        entry["type"] = it.value().type;
+        entry["params"] = it.value().params;
+        list.append(entry);
+    }
+    return list;
 }
 
-// Joystick monitoring methods for TCP server
-int AtariEmulator::getJoystickState(int player) const
+bool AtariEmulator::runDueScheduledActions()
 {
-    if (player == 1) {
-        return m_currentInput.joy0;
-    } else if (player == 2) {
-        return m_currentInput.joy1;
+    bool frameMayRun = true;
+    while (!m_scheduledActions.isEmpty() && m_scheduledActions.firstKey() <= m_emulatedFrames) {
+        const quint64 target = m_scheduledActions.firstKey();
+        const ScheduledAction action = m_scheduledActions.take(target);
+        QJsonObject result = executeScheduledAction(action);
+        if (target < m_emulatedFrames) {
+            result["late_frames"] = static_cast<qint64>(m_emulatedFrames - target);
+        }
+        emit scheduledActionExecuted(action.id, m_emulatedFrames, action.type, result);
+        if (action.type == "pause") {
+            frameMayRun = false;
+            break;  // later actions wait until emulation resumes
+        }
     }
-    return 0x0f ^ 0xff;  // Return center if invalid player
+    return frameMayRun;
 }
 
-bool AtariEmulator::getJoystickFire(int player) const
+void AtariEmulator::reportInputChanges(const input_template_t& input)
 {
-    if (player == 1) {
-        return m_currentInput.trig0 == 1;  // 1 = pressed in our inverted logic
-    } else if (player == 2) {
-        return m_currentInput.trig1 == 1;  // 1 = pressed in our inverted logic
+    if (!m_inputChangeReporting.load(std::memory_order_relaxed)) {
+        m_reportedInputValid = false;  // take a fresh baseline when switched back on
+        return;
     }
-    return false;
+    if (m_reportedInputValid) {
+        const int sticks[4] = {input.joy0, input.joy1, input.joy2, input.joy3};
+        const int triggers[4] = {input.trig0, input.trig1, input.trig2, input.trig3};
+        const int previousSticks[4] = {m_reportedInput.joy0, m_reportedInput.joy1,
+                                       m_reportedInput.joy2, m_reportedInput.joy3};
+        const int previousTriggers[4] = {m_reportedInput.trig0, m_reportedInput.trig1,
+                                         m_reportedInput.trig2, m_reportedInput.trig3};
+        for (int port = 0; port < 4; ++port) {
+            if (sticks[port] != previousSticks[port] || triggers[port] != previousTriggers[port]) {
+                emit joystickInputChanged(m_emulatedFrames, port + 1, sticks[port], triggers[port] == 1,
+                                          previousSticks[port], previousTriggers[port] == 1);
+            }
+        }
+
+        auto consoleKeys = [](const input_template_t& in) {
+            return (in.start ? ConsoleStart : 0) | (in.select ? ConsoleSelect : 0) |
+                   (in.option ? ConsoleOption : 0);
+        };
+        const int keys = consoleKeys(input);
+        const int previousKeys = consoleKeys(m_reportedInput);
+        if (keys != previousKeys) {
+            emit consoleInputChanged(m_emulatedFrames, keys, previousKeys);
+        }
+    }
+    m_reportedInput = input;
+    m_reportedInputValid = true;
 }
 
-QJsonObject AtariEmulator::getAllJoystickStates() const
+QJsonObject AtariEmulator::executeScheduledAction(const ScheduledAction& action)
 {
+    const QJsonObject& params = action.params;
     QJsonObject result;
-    
-    // Helper to convert inverted direction value back to human-readable direction
-    auto getDirectionName = [](int value) -> QString {
-        // These are the inverted values we use
-        const int CENTER = 0x0f ^ 0xff;  // 240
-        const int UP = 0x0e ^ 0xff;      // 241
-        const int DOWN = 0x0d ^ 0xff;    // 242
-        const int LEFT = 0x0b ^ 0xff;    // 244
-        const int RIGHT = 0x07 ^ 0xff;   // 248
-        const int UP_LEFT = 0x0a ^ 0xff; // 245
-        const int UP_RIGHT = 0x06 ^ 0xff; // 249
-        const int DOWN_LEFT = 0x09 ^ 0xff; // 246
-        const int DOWN_RIGHT = 0x05 ^ 0xff; // 250
-        
-        switch(value) {
-            case CENTER: return "CENTER";
-            case UP: return "UP";
-            case DOWN: return "DOWN";
-            case LEFT: return "LEFT";
-            case RIGHT: return "RIGHT";
-            case UP_LEFT: return "UP_LEFT";
-            case UP_RIGHT: return "UP_RIGHT";
-            case DOWN_LEFT: return "DOWN_LEFT";
-            case DOWN_RIGHT: return "DOWN_RIGHT";
-            default: return QString("UNKNOWN_%1").arg(value);
+    if (action.type == "joystick") {
+        QMutexLocker inputLock(&m_inputMutex);
+        setJoystickState(params["player"].toInt(1), params["value"].toInt(15), params["fire"].toBool(false));
+    } else if (action.type == "console") {
+        QMutexLocker inputLock(&m_inputMutex);
+        m_currentInput.start = params["start"].toBool(false) ? 1 : 0;
+        m_currentInput.select = params["select"].toBool(false) ? 1 : 0;
+        m_currentInput.option = params["option"].toBool(false) ? 1 : 0;
+    } else if (action.type == "char") {
+        const QString text = params["char"].toString();
+        if (!text.isEmpty()) {
+            injectCharacter(text.at(0).toLatin1());
         }
-    };
-    
-    // Joystick 1
-    QJsonObject joy1;
-    joy1["direction"] = getDirectionName(m_currentInput.joy0);
-    joy1["direction_value"] = m_currentInput.joy0;
-    joy1["fire"] = (m_currentInput.trig0 == 1);  // 1 = pressed in our inverted logic
-    joy1["keyboard_enabled"] = m_kbdJoy0Enabled;
-    joy1["keyboard_keys"] = m_swapJoysticks ? m_joystick1Preset : m_joystick0Preset;
-    
-    // Joystick 2
-    QJsonObject joy2;
-    joy2["direction"] = getDirectionName(m_currentInput.joy1);
-    joy2["direction_value"] = m_currentInput.joy1;
-    joy2["fire"] = (m_currentInput.trig1 == 1);  // 1 = pressed in our inverted logic
-    joy2["keyboard_enabled"] = m_kbdJoy1Enabled;
-    joy2["keyboard_keys"] = m_swapJoysticks ? m_joystick0Preset : m_joystick1Preset;
-    
-    result["joystick1"] = joy1;
-    result["joystick2"] = joy2;
-    result["swapped"] = m_swapJoysticks;
-    result["joystick_input_enabled"] = m_joystickInputEnabled.load();
-    
+    } else if (action.type == "write_memory") {
+        const int address = params["address"].toInt();
+        const QJsonArray data = params["data"].toArray();
+        for (int i = 0; i < data.size(); ++i) {
+            MEMORY_mem[(address + i) & 0xFFFF] = static_cast<unsigned char>(data.at(i).toInt());
+        }
+        result["bytes_written"] = data.size();
+    } else if (action.type == "save_state") {
+        const QString filename = params["filename"].toString();
+        saveStateAsync(filename);
+        result["filename"] = filename;
+    } else if (action.type == "capture") {
+        QImage frame(384, 240, QImage::Format_Indexed8);
+        renderIndexedFrame(frame);
+        QByteArray pixels;
+        pixels.reserve(frame.width() * frame.height());
+        for (int y = 0; y < frame.height(); ++y) {
+            pixels.append(reinterpret_cast<const char*>(frame.constScanLine(y)), frame.width());
+        }
+        result["width"] = frame.width();
+        result["height"] = frame.height();
+        result["format"] = "indexed8";
+        result["data"] = QString::fromLatin1(pixels.toBase64());
+        result["palette"] = QString::fromLatin1(ScreenStreamEncoder::paletteToRgb(frame.colorTable()).toBase64());
+    } else if (action.type == "pause") {
+        pauseEmulation();
+    }
     return result;
 }
 
-bool AtariEmulator::saveState(const QString& filename)
+int AtariEmulator::extendedBankCount() const
 {
-    // Pause emulation during save
-    bool wasPaused = m_emulationPaused;
-    if (!wasPaused) {
-        pauseEmulation();
+    if (!m_libatari800Initialized) {
+        return 0;
     }
-    
-    // When using libatari800, state saves work with memory buffers
-    // Allocate buffer for state data (STATESAV_MAX_SIZE is defined in libatari800.h)
-    UBYTE* stateBuffer = new UBYTE[STATESAV_MAX_SIZE];
-    
-    // Set up the global buffer pointer that libatari800 expects
-    extern UBYTE* LIBATARI800_StateSav_buffer;
-    extern statesav_tags_t* LIBATARI800_StateSav_tags;
-    LIBATARI800_StateSav_buffer = stateBuffer;
-    
-    // Create tags structure
-    statesav_tags_t tags;
-    memset(&tags, 0, sizeof(tags));
-    LIBATARI800_StateSav_tags = &tags;
-    
-    // Save state to buffer
-    extern void LIBATARI800_StateSave(UBYTE *buffer, statesav_tags_t *tags);
-    LIBATARI800_StateSave(stateBuffer, &tags);
-    
-    // Get actual size of saved data
-    int stateSize = tags.size;
-    if (stateSize == 0) {
-        // Fall back to max size if size tag wasn't set
-        stateSize = STATESAV_MAX_SIZE;
+    int bankCount = 0;
+    int currentBank = 0;
+    libatari800_get_xe_memory(&bankCount, &currentBank);
+    return bankCount;
+}
+
+unsigned char* AtariEmulator::memoryBlock(int bank, int address, int length) const
+{
+    if (!m_libatari800Initialized || address < 0 || length < 0) {
+        return nullptr;
     }
-    
-    // Write buffer to file
-    QFile file(filename);
-    bool success = false;
-    if (file.open(QIODevice::WriteOnly)) {
-        qint64 written = file.write(reinterpret_cast<const char*>(stateBuffer), stateSize);
-        success = (written == stateSize);
-        file.close();
+    if (bank == 0) {
+        return address + length <= 0x10000 ? MEMORY_mem + address : nullptr;
     }
-    
-    // Clean up
-    delete[] stateBuffer;
-    LIBATARI800_StateSav_buffer = nullptr;
-    LIBATARI800_StateSav_tags = nullptr;
-    
-    // Resume if we weren't paused before
-    if (!wasPaused) {
-        resumeEmulation();
+    int bankCount = 0;
+    int currentBank = 0;
+    unsigned char* xeMemory = libatari800_get_xe_memory(&bankCount, &currentBank);
+    if (!xeMemory || bank < 1 || bank > bankCount || address + length > 0x4000) {
+        return nullptr;
     }
-    
-    if (success) {
-        // Save metadata
-        QSettings stateSettings(filename + ".meta", QSettings::IniFormat);
-        stateSettings.setValue("profile", m_currentProfileName);
-        stateSettings.setValue("timestamp", QDateTime::currentDateTime());
-        
-        return true;
-    } else {
-        qWarning() << "Failed to save state to:" << filename;
-        return false;
+    // The mapped bank is live in the CPU window; its own slot is only written back on a switch
+    if (bank == currentBank) {
+        return MEMORY_mem + 0x4000 + address;
     }
+    return xeMemory + bank * 0x4000 + address;
 }
 
-bool AtariEmulator::loadState(const QString& filename)
+QByteArray AtariEmulator::readMemoryBlock(int bank, int address, int length) const
 {
-    // Check if state file exists
-    QFileInfo stateFile(filename);
-    if (!stateFile.exists()) {
-        qWarning() << "State file does not exist:" << filename;
-        return false;
+    const unsigned char* block = memoryBlock(bank, address, length);
+    if (!block) {
+        return QByteArray();
     }
-    
-    // Pause emulation during load
-    bool wasPaused = m_emulationPaused;
-    if (!wasPaused) {
-        pauseEmulation();
+    return QByteArray(reinterpret_cast<const char*>(block), length);
+}
+
+bool AtariEmulator::writeMemoryBlock(int bank, int address, const QByteArray& data)
+{
+    unsigned char* block = memoryBlock(bank, address, data.size());
+    if (!block) {
+        return false;
     }
-    
-    // Read state file into buffer
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Failed to open state file:" << filename;
-        if (!wasPaused) {
-            resumeEmulation();
+    endMovieRecording();
+    memcpy(block, data.constData(), data.size());
+    return true;
+}
+
+MachineSnapshot AtariEmulator::captureSnapshot(int sections) const
+{
+    MachineSnapshot snapshot;
+    if (!m_libatari800Initialized) {
+        return snapshot;
+    }
+    snapshot.frame = m_emulatedFrames;
+    snapshot.sections = sections & MachineSnapshot::AllSections;
+    snapshot.pc = CPU_regPC;
+    snapshot.a = CPU_regA;
+    snapshot.x = CPU_regX;
+    snapshot.y = CPU_regY;
+    snapshot.s = CPU_regS;
+    snapshot.p = CPU_regP;
+
+    if (sections & MachineSnapshot::CpuMemory) {
+        snapshot.memory = QByteArray(reinterpret_cast<const char*>(MEMORY_mem), MachineSnapshot::kMemorySize);
+    }
+    int bankCount = 0;
+    int currentBank = 0;
+    const unsigned char* xeMemory = libatari800_get_xe_memory(&bankCount, &currentBank);
+    snapshot.extendedBanks = xeMemory ? bankCount : 0;
+    snapshot.mappedBank = xeMemory ? currentBank : 0;
+    if ((sections & MachineSnapshot::ExtendedRam) && xeMemory) {
+        snapshot.extendedRam = QByteArray(reinterpret_cast<const char*>(xeMemory) + MachineSnapshot::kBankSize,
+                                          bankCount * MachineSnapshot::kBankSize);
+        // Same as memoryBlock(): the mapped bank's slot is stale, its contents are in the CPU window
+        if (currentBank >= 1 && currentBank <= bankCount) {
+            memcpy(snapshot.extendedRam.data() + (currentBank - 1) * MachineSnapshot::kBankSize,
+                   MEMORY_mem + 0x4000, MachineSnapshot::kBankSize);
         }
-        return false;
     }
-    
-    QByteArray fileData = file.readAll();
-    file.close();
-    
-    if (fileData.isEmpty()) {
-        qWarning() << "State file is empty:" << filename;
-        if (!wasPaused) {
-            resumeEmulation();
+
+    if (CARTRIDGE_main.type != 0 && CARTRIDGE_main.image) {
+        snapshot.cartridgeType = CARTRIDGE_main.type;
+        snapshot.cartridgeState = CARTRIDGE_main.state;
+        snapshot.cartridgeSize = CARTRIDGE_main.size * 1024;
+        if (sections & MachineSnapshot::CartridgeImage) {
+            snapshot.cartridge = QByteArray(reinterpret_cast<const char*>(CARTRIDGE_main.image),
+                                            snapshot.cartridgeSize);
         }
-        return false;
     }
-    
-    // Set up the global buffer pointer that libatari800 expects
-    extern UBYTE* LIBATARI800_StateSav_buffer;
-    LIBATARI800_StateSav_buffer = reinterpret_cast<UBYTE*>(fileData.data());
-    
-    // Load state from buffer
-    extern void LIBATARI800_StateLoad(UBYTE *buffer);
-    LIBATARI800_StateLoad(reinterpret_cast<UBYTE*>(fileData.data()));
-    
-    // Clean up
-    LIBATARI800_StateSav_buffer = nullptr;
-    
-    // Resume if we weren't paused before
-    if (!wasPaused) {
-        resumeEmulation();
+
+    // In MachineSnapshot::registerNames() order
+    const unsigned char antic[] = {
+        ANTIC_DMACTL, ANTIC_CHACTL, static_cast<unsigned char>(ANTIC_dlist & 0xFF),
+        static_cast<unsigned char>(ANTIC_dlist >> 8), ANTIC_HSCROL, ANTIC_VSCROL, ANTIC_PMBASE,
+        ANTIC_CHBASE, static_cast<unsigned char>(ANTIC_ypos >> 1), ANTIC_NMIEN, ANTIC_NMIST};
+    const unsigned char gtia[] = {
+        GTIA_HPOSP0, GTIA_HPOSP1, GTIA_HPOSP2, GTIA_HPOSP3, GTIA_HPOSM0, GTIA_HPOSM1, GTIA_HPOSM2,
+        GTIA_HPOSM3, GTIA_SIZEP0, GTIA_SIZEP1, GTIA_SIZEP2, GTIA_SIZEP3, GTIA_SIZEM, GTIA_GRAFP0,
+        GTIA_GRAFP1, GTIA_GRAFP2, GTIA_GRAFP3, GTIA_GRAFM, GTIA_COLPM0, GTIA_COLPM1, GTIA_COLPM2,
+        GTIA_COLPM3, GTIA_COLPF0, GTIA_COLPF1, GTIA_COLPF2, GTIA_COLPF3, GTIA_COLBK, GTIA_PRIOR,
+        GTIA_VDELAY, GTIA_GRACTL};
+    const unsigned char pokey[] = {
+        POKEY_AUDF[0], POKEY_AUDC[0], POKEY_AUDF[1], POKEY_AUDC[1], POKEY_AUDF[2], POKEY_AUDC[2],
+        POKEY_AUDF[3], POKEY_AUDC[3], POKEY_AUDCTL[0], POKEY_KBCODE, POKEY_IRQEN, POKEY_IRQST,
+        POKEY_SKCTL, POKEY_SKSTAT};
+    const unsigned char pia[] = {PIA_PORTA, PIA_PORTB, PIA_PACTL, PIA_PBCTL};
+    snapshot.registers[MachineSnapshot::Antic] = QByteArray(reinterpret_cast<const char*>(antic), sizeof(antic));
+    snapshot.registers[MachineSnapshot::Gtia] = QByteArray(reinterpret_cast<const char*>(gtia), sizeof(gtia));
+    snapshot.registers[MachineSnapshot::Pokey] = QByteArray(reinterpret_cast<const char*>(pokey), sizeof(pokey));
+    snapshot.registers[MachineSnapshot::Pia] = QByteArray(reinterpret_cast<const char*>(pia), sizeof(pia));
+    return snapshot;
+}
+
+void AtariEmulator::rebuildWatchMap()
+{
+    if (m_watchpoints.isEmpty()) {
+        // Disarmed: the core pays one NULL test per instruction again
+        libatari800_set_watch_map(nullptr, nullptr);
+        m_watchMap.reset();
+        return;
     }
-    
-    // Load the profile name from meta file if it exists
-    QString metaFile = filename + ".meta";
-    if (QFileInfo::exists(metaFile)) {
-        QSettings stateSettings(metaFile, QSettings::IniFormat);
-        QString profileName = stateSettings.value("profile").toString();
-        if (!profileName.isEmpty()) {
-            m_currentProfileName = profileName;
+    if (!m_watchMap) {
+        m_watchMap.reset(new unsigned char[65536]);
+    }
+    std::fill(m_watchMap.get(), m_watchMap.get() + 65536, 0);
+    for (const Watchpoint& watchpoint : m_watchpoints) {
+        const unsigned char bits = watchpoint.access | (watchpoint.breakOnHit ? watchpoint.access << 4 : 0);
+        for (int address = watchpoint.start; address <= watchpoint.end; ++address) {
+            m_watchMap[address] |= bits;
         }
     }
-    
-    return true;
+    libatari800_set_watch_map(m_watchMap.get(), &AtariEmulator::watchCallback);
 }
 
-bool AtariEmulator::quickSaveState()
+int AtariEmulator::watchCallback(unsigned short pc, unsigned short address, int access, unsigned char value)
 {
-    QString quickSavePath = getQuickSaveStatePath();
-    return saveState(quickSavePath);
+    // Called from inside CPU_GO() on the emulator thread
+    AtariEmulator* emulator = s_emulatorInstance;
+    if (!emulator || !emulator->m_watchMap) {
+        return 0;
+    }
+    emulator->m_accessTrace.push({emulator->m_emulatedFrames, pc, address,
+                                  static_cast<quint8>(access), value});
+
+    const int breakBits = (emulator->m_watchMap[address] >> 4) & access;
+    if (breakBits && libatari800_get_breakpoint_halt() < 0 && !emulator->m_watchHaltPending) {
+        emulator->m_watchHaltPending = true;
+        emulator->m_watchHitAddress = address;
+        emulator->m_watchHitAccess = breakBits;
+        return 1;
+    }
+    return 0;
 }
 
-bool AtariEmulator::quickLoadState()
+static_assert(sizeof(TraceRecorder::RawRecord) == sizeof(libatari800_trace_record),
+              "TraceRecorder::RawRecord must match the core's trace record");
+
+QJsonObject AtariEmulator::startInstructionTrace(const QString& path, int sizeMB, int start, int end)
 {
-    QString quickSavePath = getQuickSaveStatePath();
-    if (!QFileInfo::exists(quickSavePath)) {
-        qWarning() << "Quick save state does not exist";
-        return false;
-    }
-    return loadState(quickSavePath);
+    if (!m_libatari800Initialized) {
+        return QJsonObject{{"error", "Emulator not initialized"}};
+    }
+    if (start < 0 || end > 0xFFFF || start > end) {
+        return QJsonObject{{"error", "Invalid trace range. Must be within 0-65535"}};
+    }
+    collectInstructionTrace();
+    QString error;
+    if (!m_traceRecorder.start(path, qint64(qBound(1, sizeMB, 4096)) << 20, &error)) {
+        armInstructionTrace();
+        return QJsonObject{{"error", error}};
+    }
+    m_traceStart = static_cast<quint16>(start);
+    m_traceEnd = static_cast<quint16>(end);
+    armInstructionTrace();
+    qDebug() << "Tracing instructions to" << path;
+    return instructionTraceStatus();
 }
 
-QString AtariEmulator::getQuickSaveStatePath() const
+QJsonObject AtariEmulator::stopInstructionTrace()
 {
-    // Use the application's data directory for quick saves
-    QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    QDir dir(dataPath);
-    if (!dir.exists()) {
-        dir.mkpath(".");
-    }
-    return dir.filePath("quicksave.a8s");
+    collectInstructionTrace();
+    m_traceRecorder.stop();
+    armInstructionTrace();
+    return instructionTraceStatus();
 }
 
-// Breakpoint management - core debugging support
-void AtariEmulator::addBreakpoint(unsigned short address)
+QJsonObject AtariEmulator::instructionTraceStatus() const
 {
-    if (!m_breakpoints.contains(address)) {
-        m_breakpoints.insert(address);
-        emit breakpointAdded(address);
-    }
+    QJsonObject status = m_traceRecorder.status();
+    status["start"] = QString("$%1").arg(m_traceStart, 4, 16, QChar('0')).toUpper();
+    status["end"] = QString("$%1").arg(m_traceEnd, 4, 16, QChar('0')).toUpper();
+    return status;
 }
 
-void AtariEmulator::removeBreakpoint(unsigned short address)
+QJsonArray AtariEmulator::instructionTraceTail(int count) const
 {
-    if (m_breakpoints.remove(address)) {
-        emit breakpointRemoved(address);
-    }
+    QJsonArray records;
+    for (const TraceRecorder::Entry& entry : m_traceRecorder.tail(count)) {
+        const TraceRecorder::RawRecord& record = entry.record;
+        QJsonObject row;
+        row["frame"] = static_cast<qint64>(entry.frame);
+        row["pc"] = record.pc;
+        row["opcode"] = record.opcode;
+        row["a"] = record.a;
+        row["x"] = record.x;
+        row["y"] = record.y;
+        row["s"] = record.s;
+        row["p"] = record.p;
+        row["scanline"] = record.scanline;
+        row["cycle"] = record.cycle;
+        records.append(row);
+    }
+    return records;
 }
 
-void AtariEmulator::clearAllBreakpoints()
+void AtariEmulator::startProfiling(bool splitBanks)
 {
-    if (!m_breakpoints.isEmpty()) {
-        m_breakpoints.clear();
-        emit breakpointsCleared();
-    }
+    collectInstructionTrace();
+    m_profiler.setSplitBanks(splitBanks);
+    m_profiler.setLinesPerFrame(m_videoSystem == "-ntsc" ? 262 : 312);
+    m_profiler.reset();
+    m_profiling.store(true);
+    armInstructionTrace();
+    publishProfile();
 }
 
-bool AtariEmulator::hasBreakpoint(unsigned short address) const
+void AtariEmulator::stopProfiling()
 {
-    return m_breakpoints.contains(address);
+    collectInstructionTrace();
+    m_profiling.store(false);
+    armInstructionTrace();
+    publishProfile();
 }
 
-QSet<unsigned short> AtariEmulator::getBreakpoints() const
+void AtariEmulator::resetProfile()
 {
-    return m_breakpoints;
+    collectInstructionTrace();
+    m_profiler.reset();
+    publishProfile();
 }
 
-void AtariEmulator::setBreakpointsEnabled(bool enabled)
+QJsonObject AtariEmulator::getProfile(int count)
 {
-    m_breakpointsEnabled = enabled;
+    collectInstructionTrace();
+    const CycleProfiler::Report report = m_profiler.report(count, count);
+    const std::shared_ptr<const CodeAnalyzer::Labels> labels = m_codeAnalyzer.labels();
+    const double total = report.cycles > 0 ? double(report.cycles) : 1.0;
+    const auto hex = [](quint16 address) {
+        return QString("$%1").arg(address, 4, 16, QChar('0')).toUpper();
+    };
+
+    QJsonArray addresses;
+    for (const CycleProfiler::Hotspot& hotspot : report.hotspots) {
+        QJsonObject row;
+        row["address"] = hex(hotspot.address);
+        row["bank"] = hotspot.bank;
+        row["cycles"] = static_cast<qint64>(hotspot.cycles);
+        row["instructions"] = static_cast<qint64>(hotspot.instructions);
+        row["percent"] = 100.0 * double(hotspot.cycles) / total;
+        if (labels->contains(hotspot.address)) {
+            row["label"] = QString::fromLatin1(labels->value(hotspot.address));
+        }
+        addresses.append(row);
+    }
+    QJsonArray functions;
+    for (const CycleProfiler::Function& function : report.functions) {
+        QJsonObject row;
+        row["entry"] = hex(function.entry);
+        row["bank"] = function.bank;
+        row["interrupt"] = function.interrupt;
+        row["calls"] = static_cast<qint64>(function.calls);
+        row["self_cycles"] = static_cast<qint64>(function.selfCycles);
+        row["inclusive_cycles"] = static_cast<qint64>(function.inclusiveCycles);
+        row["percent"] = 100.0 * double(function.inclusiveCycles) / total;
+        if (labels->contains(function.entry)) {
+            row["label"] = QString::fromLatin1(labels->value(function.entry));
+        }
+        functions.append(row);
+    }
+
+    QJsonObject result;
+    result["profiling"] = m_profiling.load();
+    result["split_banks"] = report.splitBanks;
+    result["frames"] = static_cast<qint64>(report.frames);
+    result["cycles"] = static_cast<qint64>(report.cycles);
+    result["instructions"] = static_cast<qint64>(report.instructions);
+    result["cycles_per_frame"] = report.frames > 0 ? double(report.cycles) / double(report.frames) : 0.0;
+    result["addresses"] = addresses;
+    result["functions"] = functions;
+    return result;
 }
 
-bool AtariEmulator::areBreakpointsEnabled() const
+std::shared_ptr<const CycleProfiler::Report> AtariEmulator::profileReport() const
 {
-    return m_breakpointsEnabled;
+    QMutexLocker locker(&m_profileMutex);
+    return m_profileReport;
 }
 
-void AtariEmulator::checkBreakpoints()
+void AtariEmulator::publishProfile()
+{
+    auto report = std::make_shared<const CycleProfiler::Report>(
+        m_profiler.report(kProfileReportRows, kProfileReportRows));
+    QMutexLocker locker(&m_profileMutex);
+    m_profileReport = report;
+    m_profileFramesSincePublish = 0;
+}
+
+void AtariEmulator::armInstructionTrace()
 {
-    if (!m_breakpointsEnabled || m_breakpoints.isEmpty() || m_emulationPaused) {
+    const bool profiling = m_profiling.load();
+    if (!profiling && !m_traceRecorder.isRecording()) {
+        libatari800_set_trace_buffer(nullptr, 0, 0, 0);
         return;
     }
-    
-    unsigned short currentPC = CPU_regPC;
-    
-    // Only check if PC has changed (avoid repeated triggers at same address)
-    if (currentPC != m_lastPC) {
-        m_lastPC = currentPC;
-        
-        if (m_breakpoints.contains(currentPC)) {
-            pauseEmulation();
-            emit breakpointHit(currentPC);
+    if (m_traceBuffer.empty()) {
+        m_traceBuffer.resize(kTraceBufferRecords);
+    }
+    // The profiler needs every instruction; the recorder then filters its range
+    libatari800_set_trace_buffer(m_traceBuffer.data(), kTraceBufferRecords,
+                                 profiling ? 0x0000 : m_traceStart, profiling ? 0xFFFF : m_traceEnd);
+}
+
+void AtariEmulator::collectInstructionTrace()
+{
+    const bool profiling = m_profiling.load(std::memory_order_relaxed);
+    if (!profiling && !m_traceRecorder.isRecording()) {
+        return;
+    }
+    int overflow = 0;
+    const int count = libatari800_take_trace(&overflow);
+    const TraceRecorder::RawRecord* records = m_traceBuffer.data();
+    if (profiling) {
+        m_profiler.addFrame(records, count, overflow == 0);
+        if (++m_profileFramesSincePublish >= kProfilePublishFrames) {
+            publishProfile();
         }
     }
+    if (!m_traceRecorder.isRecording()) {
+        return;
+    }
+    if (profiling && (m_traceStart != 0x0000 || m_traceEnd != 0xFFFF)) {
+        m_traceFiltered.clear();
+        std::copy_if(records, records + count, std::back_inserter(m_traceFiltered),
+                     [this](const TraceRecorder::RawRecord& record) {
+                         return record.pc >= m_traceStart && record.pc <= m_traceEnd;
+                     });
+        m_traceRecorder.append(m_emulatedFrames, m_traceFiltered.data(),
+                               static_cast<int>(m_traceFiltered.size()), overflow);
+        return;
+    }
+    m_traceRecorder.append(m_emulatedFrames, records, count, overflow);
 }
 
 void AtariEmulator::applyJoystickInputBundle(bool master, const QString& device1, const QString& device2,
@@ -4211,6 +6740,7 @@ void AtariEmulator::applyJoystickInputBundle(bool master, const QString& device1
 #ifdef HAVE_SDL2_JOYSTICK
     m_joystick1AssignedDevice = device1;
     m_joystick2AssignedDevice = device2;
+    resolveJoystickPorts();
     const bool wantReal = master && (device1.startsWith(QStringLiteral("sdl_")) ||
                                      device2.startsWith(QStringLiteral("sdl_")));
     if (m_realJoysticksEnabled != wantReal) {
@@ -4242,12 +6772,30 @@ void AtariEmulator::setRealJoysticksEnabled(bool enabled)
 void AtariEmulator::setJoystick1Device(const QString& device)
 {
     m_joystick1AssignedDevice = device;
+    resolveJoystickPorts();
 }
 
 void AtariEmulator::setJoystick2Device(const QString& device)
 {
     m_joystick2AssignedDevice = device;
+    resolveJoystickPorts();
 }
 #endif
 
+void AtariEmulator::resolveJoystickPorts()
+{
+#ifdef HAVE_SDL2_JOYSTICK
+    // "sdl_1" -> 1; anything else is not an SDL device
+    auto sdlIndex = [](const QString& device) {
+        bool ok = false;
+        const int index = device.startsWith(QLatin1String("sdl_")) ? device.mid(4).toInt(&ok) : -1;
+        return ok ? index : -1;
+    };
+    const int first = sdlIndex(m_joystick1AssignedDevice);
+    const int second = sdlIndex(m_joystick2AssignedDevice);
+    m_port0SdlJoystick.store(m_swapJoysticks ? second : first);
+    m_port1SdlJoystick.store(m_swapJoysticks ? first : second);
+#endif
+}
+
 // Double buffering audio implementation (inspired by Atari800MacX)
@@ -0,0 +1,145 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "audiodecimator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+void AudioDecimator::configure(int channels, int sampleSize)
+{
+    m_channels = std::max(1, channels);
+    m_sampleSize = sampleSize == 1 ? 1 : 2;
+    m_sums.assign(m_channels, 0.0);
+    m_output.reserve(8192);
+    reset();
+}
+
+void AudioDecimator::setMode(Mode mode)
+{
+    if (mode != m_mode) {
+        m_mode = mode;
+        reset();
+    }
+}
+
+void AudioDecimator::reset()
+{
+    std::fill(m_sums.begin(), m_sums.end(), 0.0);
+    m_windowLeft = 0.0;
+    m_credit = 0.0;
+    m_previousDropped = false;
+    m_active = false;
+}
+
+int AudioDecimator::process(const unsigned char* input, int bytes, double speed, const unsigned char** output)
+{
+    *output = input;
+    const int frames = bytes / (m_channels * m_sampleSize);
+    if (speed <= 1.0 || !input || frames <= 0) {
+        if (m_active && speed <= 1.0) {
+            reset();  // back to real time: start the next turbo run clean
+        }
+        return speed <= 1.0 ? bytes : 0;
+    }
+    speed = speed < kMaxSpeed ? speed : kMaxSpeed;
+    if (static_cast<int>(m_output.size()) < bytes) {
+        m_output.resize(bytes);
+    }
+    m_active = true;
+
+    const int outputFrames = m_mode == PitchPreserve ? pitchPreserve(input, frames, speed)
+                                                     : timeCompress(input, frames, speed);
+    *output = m_output.data();
+    return outputFrames * m_channels * m_sampleSize;
+}
+
+int AudioDecimator::timeCompress(const unsigned char* input, int frames, double speed)
+{
+    if (m_windowLeft <= 0.0) {
+        m_windowLeft = speed;
+    }
+    int written = 0;
+    for (int frame = 0; frame < frames; ++frame) {
+        // Each input frame covers one unit of time; split it at window edges
+        double weight = 1.0;
+        while (weight > 0.0) {
+            const double take = std::min(weight, m_windowLeft);
+            for (int c = 0; c < m_channels; ++c) {
+                m_sums[c] += take * sampleAt(input, frame * m_channels + c);
+            }
+            weight -= take;
+            m_windowLeft -= take;
+            if (m_windowLeft <= 1e-9) {
+                for (int c = 0; c < m_channels; ++c) {
+                    storeSample(written * m_channels + c, static_cast<float>(m_sums[c] / speed));
+                    m_sums[c] = 0.0;
+                }
+                written++;
+                m_windowLeft = speed;
+            }
+        }
+    }
+    return written;
+}
+
+int AudioDecimator::pitchPreserve(const unsigned char* input, int frames, double speed)
+{
+    // Pass one emulated frame in every `speed` on average
+    m_credit += 1.0 / speed;
+    if (m_credit < 1.0) {
+        m_previousDropped = true;
+        return 0;
+    }
+    m_credit -= 1.0;
+    std::memcpy(m_output.data(), input, static_cast<size_t>(frames) * m_channels * m_sampleSize);
+
+    const int fadeFrames = frames / 2 < kFadeFrames ? frames / 2 : kFadeFrames;
+    if (m_previousDropped) {
+        fade(0, fadeFrames, true);
+    }
+    // The next frame is dropped unless it brings the credit up to a whole frame
+    if (m_credit + 1.0 / speed < 1.0) {
+        fade(frames - fadeFrames, fadeFrames, false);
+    }
+    m_previousDropped = false;
+    return frames;
+}
+
+float AudioDecimator::sampleAt(const unsigned char* data, int index) const
+{
+    if (m_sampleSize == 1) {
+        return static_cast<float>(data[index]) - 128.0f;
+    }
+    int16_t value;
+    std::memcpy(&value, data + index * 2, sizeof(value));
+    return static_cast<float>(value);
+}
+
+void AudioDecimator::storeSample(int index, float value)
+{
+    const long rounded = std::lround(value);
+    if (m_sampleSize == 1) {
+        m_output[index] = static_cast<unsigned char>(std::min(255L, std::max(0L, rounded + 128)));
+        return;
+    }
+    const int16_t sample = static_cast<int16_t>(std::min(32767L, std::max(-32768L, rounded)));
+    std::memcpy(m_output.data() + index * 2, &sample, sizeof(sample));
+}
+
+void AudioDecimator::fade(int firstFrame, int frames, bool fadeIn)
+{
+    for (int i = 0; i < frames; ++i) {
+        const float gain = static_cast<float>(fadeIn ? i + 1 : frames - i) / (frames + 1);
+        const int frame = firstFrame + i;
+        for (int c = 0; c < m_channels; ++c) {
+            const int index = frame * m_channels + c;
+            storeSample(index, sampleAt(m_output.data(), index) * gain);
+        }
+    }
+}
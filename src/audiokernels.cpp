@@ -0,0 +1,140 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "audiokernels.h"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FUJISAN_AUDIO_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define FUJISAN_AUDIO_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+inline float clampSample(float sample)
+{
+    return std::max(-1.0f, std::min(1.0f, sample));
+}
+
+}  // namespace
+
+void AudioKernels::accumulateS16(const qint16* input, float* output, int samples, float gain)
+{
+    const float scale = gain / 32768.0f;
+    int i = 0;
+#if defined(FUJISAN_AUDIO_SSE2)
+    const __m128 vscale = _mm_set1_ps(scale);
+    for (; i + 8 <= samples; i += 8) {
+        const __m128i pcm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        // Sign-extend by placing each sample in the top half and shifting back down
+        const __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(pcm, pcm), 16));
+        const __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(pcm, pcm), 16));
+        _mm_storeu_ps(output + i, _mm_add_ps(_mm_loadu_ps(output + i), _mm_mul_ps(lo, vscale)));
+        _mm_storeu_ps(output + i + 4, _mm_add_ps(_mm_loadu_ps(output + i + 4), _mm_mul_ps(hi, vscale)));
+    }
+#elif defined(FUJISAN_AUDIO_NEON)
+    for (; i + 8 <= samples; i += 8) {
+        const int16x8_t pcm = vld1q_s16(input + i);
+        const float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(pcm)));
+        const float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(pcm)));
+        vst1q_f32(output + i, vaddq_f32(vld1q_f32(output + i), vmulq_n_f32(lo, scale)));
+        vst1q_f32(output + i + 4, vaddq_f32(vld1q_f32(output + i + 4), vmulq_n_f32(hi, scale)));
+    }
+#endif
+    for (; i < samples; ++i) {
+        output[i] += static_cast<float>(input[i]) * scale;
+    }
+}
+
+void AudioKernels::accumulateU8(const quint8* input, float* output, int samples, float gain)
+{
+    // 8-bit output is a fallback format; not worth a vector path
+    const float scale = gain / 128.0f;
+    for (int i = 0; i < samples; ++i) {
+        output[i] += (static_cast<float>(input[i]) - 128.0f) * scale;
+    }
+}
+
+void AudioKernels::scaleToS16(const float* input, qint16* output, int samples, float volume)
+{
+    int i = 0;
+#if defined(FUJISAN_AUDIO_SSE2)
+    const __m128 vvolume = _mm_set1_ps(volume);
+    const __m128 vmin = _mm_set1_ps(-1.0f);
+    const __m128 vmax = _mm_set1_ps(1.0f);
+    const __m128 vfull = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= samples; i += 8) {
+        __m128 lo = _mm_mul_ps(_mm_loadu_ps(input + i), vvolume);
+        __m128 hi = _mm_mul_ps(_mm_loadu_ps(input + i + 4), vvolume);
+        lo = _mm_mul_ps(_mm_min_ps(_mm_max_ps(lo, vmin), vmax), vfull);
+        hi = _mm_mul_ps(_mm_min_ps(_mm_max_ps(hi, vmin), vmax), vfull);
+        const __m128i packed = _mm_packs_epi32(_mm_cvttps_epi32(lo), _mm_cvttps_epi32(hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), packed);
+    }
+#elif defined(FUJISAN_AUDIO_NEON)
+    const float32x4_t vmin = vdupq_n_f32(-1.0f);
+    const float32x4_t vmax = vdupq_n_f32(1.0f);
+    for (; i + 8 <= samples; i += 8) {
+        float32x4_t lo = vmulq_n_f32(vld1q_f32(input + i), volume);
+        float32x4_t hi = vmulq_n_f32(vld1q_f32(input + i + 4), volume);
+        lo = vmulq_n_f32(vminq_f32(vmaxq_f32(lo, vmin), vmax), 32767.0f);
+        hi = vmulq_n_f32(vminq_f32(vmaxq_f32(hi, vmin), vmax), 32767.0f);
+        vst1q_s16(output + i, vcombine_s16(vqmovn_s32(vcvtq_s32_f32(lo)), vqmovn_s32(vcvtq_s32_f32(hi))));
+    }
+#endif
+    for (; i < samples; ++i) {
+        output[i] = static_cast<qint16>(clampSample(input[i] * volume) * 32767.0f);
+    }
+}
+
+void AudioKernels::scaleToU8(const float* input, quint8* output, int samples, float volume)
+{
+    for (int i = 0; i < samples; ++i) {
+        output[i] = static_cast<quint8>((clampSample(input[i] * volume) + 1.0f) * 127.5f);
+    }
+}
+
+float AudioKernels::dotProduct(const float* a, const float* b, int samples)
+{
+    int i = 0;
+    float sum = 0.0f;
+#if defined(FUJISAN_AUDIO_SSE2)
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= samples; i += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(FUJISAN_AUDIO_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= samples; i += 4) {
+        acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < samples; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+const char* AudioKernels::instructionSet()
+{
+#if defined(FUJISAN_AUDIO_SSE2)
+    return "sse2";
+#elif defined(FUJISAN_AUDIO_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
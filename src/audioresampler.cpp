@@ -0,0 +1,167 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "audioresampler.h"
+#include "audiokernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Pass band as a fraction of the lower Nyquist frequency; the rest is the
+// transition band of the 32-tap window
+constexpr double kCutoff = 0.9;
+
+double blackman(double x)
+{
+    // x in [-1, 1]
+    return 0.42 + 0.5 * std::cos(kPi * x) + 0.08 * std::cos(2.0 * kPi * x);
+}
+
+}  // namespace
+
+void AudioResampler::configure(int channels, double ratio, int maxOutputFrames, Quality quality)
+{
+    m_channels = std::max(1, channels);
+    m_quality = quality;
+    m_halfTaps = quality == Sinc ? kSincHalfTaps : 1;
+    m_nominalRatio = ratio > 0.0 ? ratio : 1.0;
+    m_ratio = m_nominalRatio;
+    m_capacity = maxInputFrames(std::max(1, maxOutputFrames)) + 2 * m_halfTaps;
+    m_history.assign(static_cast<size_t>(m_capacity) * m_channels, 0.0f);
+    buildCoefficients();
+    reset();
+}
+
+void AudioResampler::reset()
+{
+    // Start with silence in front of the first sample so its filter window is full
+    std::fill(m_history.begin(), m_history.end(), 0.0f);
+    m_buffered = m_halfTaps - 1;
+    m_time = m_halfTaps - 1;
+}
+
+void AudioResampler::setRatio(double ratio)
+{
+    const double low = m_nominalRatio * (1.0 - kMaxRatioDeviation);
+    const double high = m_nominalRatio * (1.0 + kMaxRatioDeviation);
+    m_ratio = std::max(low, std::min(high, ratio));
+}
+
+int AudioResampler::inputFramesNeeded(int outputFrames) const
+{
+    if (outputFrames <= 0) {
+        return 0;
+    }
+    // The last output reads up to halfTaps frames past its position
+    const double last = m_time + (outputFrames - 1) * m_ratio;
+    const int needed = static_cast<int>(std::floor(last)) + m_halfTaps + 1 - m_buffered;
+    return std::max(0, needed);
+}
+
+int AudioResampler::maxInputFrames(int outputFrames) const
+{
+    const double ratio = m_nominalRatio * (1.0 + kMaxRatioDeviation);
+    return static_cast<int>(std::ceil(outputFrames * ratio)) + m_halfTaps + 2;
+}
+
+int AudioResampler::process(const float* input, int inputFrames, float* output, int outputFrames)
+{
+    if (m_channels == 0 || !output) {
+        return 0;
+    }
+
+    // Append the input to the planar history
+    const int accepted = input ? std::max(0, std::min(inputFrames, m_capacity - m_buffered)) : 0;
+    for (int ch = 0; ch < m_channels; ++ch) {
+        float* history = m_history.data() + static_cast<size_t>(ch) * m_capacity + m_buffered;
+        for (int frame = 0; frame < accepted; ++frame) {
+            history[frame] = input[frame * m_channels + ch];
+        }
+    }
+    m_buffered += accepted;
+
+    // Positions are derived from the start so rounding never drifts from inputFramesNeeded()
+    const double start = m_time;
+    int produced = 0;
+    for (; produced < outputFrames; ++produced) {
+        const double time = start + produced * m_ratio;
+        if (static_cast<int>(std::floor(time)) + m_halfTaps >= m_buffered) {
+            break;
+        }
+        for (int ch = 0; ch < m_channels; ++ch) {
+            output[produced * m_channels + ch] =
+                interpolate(m_history.data() + static_cast<size_t>(ch) * m_capacity, time);
+        }
+    }
+    m_time = start + produced * m_ratio;
+
+    // Keep the frames the next output's window still needs; the phase stays in m_time
+    const int drop = std::min(static_cast<int>(std::floor(m_time)) - (m_halfTaps - 1), m_buffered);
+    if (drop > 0) {
+        for (int ch = 0; ch < m_channels; ++ch) {
+            float* history = m_history.data() + static_cast<size_t>(ch) * m_capacity;
+            std::memmove(history, history + drop, static_cast<size_t>(m_buffered - drop) * sizeof(float));
+        }
+        m_buffered -= drop;
+        m_time -= drop;
+    }
+    return produced;
+}
+
+float AudioResampler::interpolate(const float* history, double time) const
+{
+    const int index = static_cast<int>(std::floor(time));
+    const double fraction = time - index;
+    if (m_quality == Linear) {
+        return static_cast<float>(history[index] + fraction * (history[index + 1] - history[index]));
+    }
+
+    // Blend the two nearest of the precomputed phases
+    const double phase = fraction * kPhases;
+    const int row = std::min(static_cast<int>(phase), kPhases - 1);
+    const float blend = static_cast<float>(phase - row);
+    const int taps = 2 * m_halfTaps;
+    const float* window = history + index - (m_halfTaps - 1);
+    const float* coefficients = m_coefficients.data() + static_cast<size_t>(row) * taps;
+    const float a = AudioKernels::dotProduct(window, coefficients, taps);
+    const float b = AudioKernels::dotProduct(window, coefficients + taps, taps);
+    return a + blend * (b - a);
+}
+
+void AudioResampler::buildCoefficients()
+{
+    m_coefficients.clear();
+    if (m_quality != Sinc) {
+        return;
+    }
+
+    // Band-limit to the lower of the two rates: downsampling narrows the filter
+    const double cutoff = kCutoff * std::min(1.0, 1.0 / m_nominalRatio);
+    const int taps = 2 * m_halfTaps;
+    m_coefficients.resize(static_cast<size_t>(kPhases + 1) * taps);
+    for (int row = 0; row <= kPhases; ++row) {
+        const double fraction = static_cast<double>(row) / kPhases;
+        float* coefficients = m_coefficients.data() + static_cast<size_t>(row) * taps;
+        double sum = 0.0;
+        for (int tap = 0; tap < taps; ++tap) {
+            // Distance from the output position to input frame index - (halfTaps - 1) + tap
+            const double x = (tap - (m_halfTaps - 1)) - fraction;
+            const double sinc = x == 0.0 ? 1.0 : std::sin(kPi * cutoff * x) / (kPi * cutoff * x);
+            const double value = cutoff * sinc * blackman(x / m_halfTaps);
+            coefficients[tap] = static_cast<float>(value);
+            sum += value;
+        }
+        // Unity gain at DC for every phase
+        for (int tap = 0; tap < taps; ++tap) {
+            coefficients[tap] = static_cast<float>(coefficients[tap] / sum);
+        }
+    }
+}
@@ -0,0 +1,136 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "audioring.h"
+#include <cstring>
+
+namespace {
+
+quint32 roundUpToPowerOfTwo(int value)
+{
+    quint32 size = 1;
+    while (size < static_cast<quint32>(qMax(1, value))) {
+        size <<= 1;
+    }
+    return size;
+}
+
+}  // namespace
+
+AudioRing::AudioRing(int capacity)
+{
+    setCapacity(capacity);
+}
+
+void AudioRing::setCapacity(int capacity)
+{
+    if (capacity <= 0) {
+        m_data.reset();
+        m_mask = 0;
+    } else {
+        const quint32 size = roundUpToPowerOfTwo(capacity);
+        m_data.reset(new unsigned char[size]());
+        m_mask = size - 1;
+    }
+    m_head.store(0, std::memory_order_relaxed);
+    m_tail.store(0, std::memory_order_release);
+}
+
+int AudioRing::available() const
+{
+    return static_cast<int>(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire));
+}
+
+bool AudioRing::write(const void* data, int bytes)
+{
+    if (!m_data || bytes <= 0) {
+        return bytes == 0;
+    }
+    const quint32 head = m_head.load(std::memory_order_relaxed);
+    const quint32 tail = m_tail.load(std::memory_order_acquire);
+    // Indices wrap at 2^32; the difference is the fill level
+    if (static_cast<quint32>(bytes) > capacity() - (head - tail)) {
+        return false;
+    }
+    const quint32 offset = head & m_mask;
+    const quint32 first = qMin(static_cast<quint32>(bytes), m_mask + 1 - offset);
+    std::memcpy(m_data.get() + offset, data, first);
+    std::memcpy(m_data.get(), static_cast<const unsigned char*>(data) + first, bytes - first);
+    m_head.store(head + bytes, std::memory_order_release);
+    return true;
+}
+
+int AudioRing::writeSilence(int bytes)
+{
+    if (!m_data || bytes <= 0) {
+        return 0;
+    }
+    const quint32 head = m_head.load(std::memory_order_relaxed);
+    const quint32 tail = m_tail.load(std::memory_order_acquire);
+    const quint32 count = qMin(static_cast<quint32>(bytes), capacity() - (head - tail));
+    const quint32 offset = head & m_mask;
+    const quint32 first = qMin(count, m_mask + 1 - offset);
+    std::memset(m_data.get() + offset, 0, first);
+    std::memset(m_data.get(), 0, count - first);
+    m_head.store(head + count, std::memory_order_release);
+    return static_cast<int>(count);
+}
+
+AudioRing::Spans AudioRing::readSpans(int maxBytes) const
+{
+    Spans spans;
+    if (!m_data || maxBytes <= 0) {
+        return spans;
+    }
+    const quint32 tail = m_tail.load(std::memory_order_relaxed);
+    const quint32 head = m_head.load(std::memory_order_acquire);
+    const quint32 count = qMin(head - tail, static_cast<quint32>(maxBytes));
+    const quint32 offset = tail & m_mask;
+    const quint32 first = qMin(count, m_mask + 1 - offset);
+    spans.first = m_data.get() + offset;
+    spans.firstBytes = static_cast<int>(first);
+    if (count > first) {
+        spans.second = m_data.get();
+        spans.secondBytes = static_cast<int>(count - first);
+    }
+    return spans;
+}
+
+int AudioRing::peek(void* data, int bytes) const
+{
+    const Spans spans = readSpans(bytes);
+    if (spans.firstBytes > 0) {
+        std::memcpy(data, spans.first, spans.firstBytes);
+    }
+    if (spans.secondBytes > 0) {
+        std::memcpy(static_cast<unsigned char*>(data) + spans.firstBytes, spans.second, spans.secondBytes);
+    }
+    return spans.bytes();
+}
+
+int AudioRing::read(void* data, int bytes)
+{
+    const int count = peek(data, bytes);
+    consume(count);
+    return count;
+}
+
+void AudioRing::consume(int bytes)
+{
+    if (bytes <= 0) {
+        return;
+    }
+    const quint32 tail = m_tail.load(std::memory_order_relaxed);
+    const quint32 head = m_head.load(std::memory_order_acquire);
+    const quint32 count = qMin(head - tail, static_cast<quint32>(bytes));
+    m_tail.store(tail + count, std::memory_order_release);
+}
+
+void AudioRing::clear()
+{
+    m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+}
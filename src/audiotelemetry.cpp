@@ -0,0 +1,119 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "audiotelemetry.h"
+#include <cstring>
+
+namespace {
+
+quint32 roundUpToPowerOfTwo(int value)
+{
+    quint32 size = 1;
+    while (size < static_cast<quint32>(qMax(1, value))) {
+        size <<= 1;
+    }
+    return size;
+}
+
+}  // namespace
+
+AudioTelemetryRing::AudioTelemetryRing(int capacity)
+    : m_slots(new Slot[roundUpToPowerOfTwo(capacity)])
+    , m_mask(roundUpToPowerOfTwo(capacity) - 1)
+{
+    for (quint32 i = 0; i <= m_mask; ++i) {
+        for (std::atomic<quint64>& word : m_slots[i].words) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void AudioTelemetryRing::record(const AudioTelemetrySample& sample)
+{
+    quint64 words[kWords] = {};
+    std::memcpy(words, &sample, sizeof(sample));
+
+    const quint64 index = m_recorded.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[index & m_mask];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int i = 0; i < kWords; ++i) {
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    m_recorded.store(index + 1, std::memory_order_release);
+}
+
+QVector<AudioTelemetrySample> AudioTelemetryRing::read(quint64& cursor, int maxSamples, quint64* lost) const
+{
+    QVector<AudioTelemetrySample> samples;
+    quint64 skipped = 0;
+    const quint64 head = m_recorded.load(std::memory_order_acquire);
+    const quint64 oldest = head > m_mask + 1 ? head - (m_mask + 1) : 0;
+    if (cursor < oldest) {
+        skipped = oldest - cursor;
+        cursor = oldest;
+    }
+    cursor = qMin(cursor, head);
+
+    const quint64 count = qMin<quint64>(head - cursor, static_cast<quint64>(qMax(0, maxSamples)));
+    samples.reserve(static_cast<int>(count));
+    for (quint64 index = cursor; index < cursor + count; ++index) {
+        const Slot& slot = m_slots[index & m_mask];
+        const quint64 before = slot.sequence.load(std::memory_order_acquire);
+        quint64 words[kWords];
+        for (int i = 0; i < kWords; ++i) {
+            words[i] = slot.words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const quint64 after = slot.sequence.load(std::memory_order_relaxed);
+        if (before != 2 * index + 2 || after != before) {
+            skipped++;  // the producer lapped us while we were copying it
+            continue;
+        }
+        AudioTelemetrySample sample;
+        std::memcpy(&sample, words, sizeof(sample));
+        samples.append(sample);
+    }
+    cursor += count;
+    if (lost) {
+        *lost = skipped;
+    }
+    return samples;
+}
+
+QString AudioTelemetryRing::csvHeader()
+{
+    return QStringLiteral("frame,time_us,frame_interval_us,produced_bytes,queued_bytes,device_free_bytes,"
+                          "underruns,overruns,speed_trim,device_clock_us,backend,device_state");
+}
+
+QString AudioTelemetryRing::toCsv(const AudioTelemetrySample& sample)
+{
+    return QString("%1,%2,%3,%4,%5,%6,%7,%8,%9,%10,%11,%12")
+        .arg(sample.frame)
+        .arg(sample.timeUs)
+        .arg(sample.frameIntervalUs)
+        .arg(sample.producedBytes)
+        .arg(sample.queuedBytes)
+        .arg(sample.deviceFreeBytes)
+        .arg(sample.underruns)
+        .arg(sample.overruns)
+        .arg(static_cast<double>(sample.speedTrim), 0, 'g', 6)
+        .arg(sample.deviceClockUs)
+        .arg(sample.backend)
+        .arg(sample.deviceState);
+}
+
+QJsonArray AudioTelemetryRing::toJson(const AudioTelemetrySample& sample)
+{
+    return QJsonArray{static_cast<qint64>(sample.frame), sample.timeUs, sample.frameIntervalUs,
+                      sample.producedBytes, sample.queuedBytes, sample.deviceFreeBytes,
+                      static_cast<qint64>(sample.underruns), static_cast<qint64>(sample.overruns),
+                      static_cast<double>(sample.speedTrim), sample.deviceClockUs,
+                      sample.backend, sample.deviceState};
+}
@@ -0,0 +1,445 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "aviwriter.h"
+#include <QtEndian>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr quint32 kAviIfKeyframe = 0x10;
+constexpr quint32 kAvifHasIndex = 0x10;
+constexpr quint32 kAvifIsInterleaved = 0x100;
+
+// Skip unchanged pixels with a delta code only when it beats encoding them
+constexpr int kMinDeltaSkip = 4;
+
+quint32 fourcc(const char* code)
+{
+    return qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(code));
+}
+
+void appendU16(QByteArray& out, quint16 value)
+{
+    uchar bytes[2];
+    qToLittleEndian(value, bytes);
+    out.append(reinterpret_cast<const char*>(bytes), 2);
+}
+
+void appendU32(QByteArray& out, quint32 value)
+{
+    uchar bytes[4];
+    qToLittleEndian(value, bytes);
+    out.append(reinterpret_cast<const char*>(bytes), 4);
+}
+
+void appendFourcc(QByteArray& out, const char* code)
+{
+    out.append(code, 4);
+}
+
+// 56-byte AVIStreamHeader; returns the offset of dwLength within out
+int appendStreamHeader(QByteArray& out, const char* type, const char* handler, quint32 scale,
+                       quint32 rate, quint32 suggestedBuffer, quint32 sampleSize, int width, int height)
+{
+    appendFourcc(out, "strh");
+    appendU32(out, 56);
+    appendFourcc(out, type);
+    appendFourcc(out, handler);
+    appendU32(out, 0);          // dwFlags
+    appendU16(out, 0);          // wPriority
+    appendU16(out, 0);          // wLanguage
+    appendU32(out, 0);          // dwInitialFrames
+    appendU32(out, scale);
+    appendU32(out, rate);
+    appendU32(out, 0);          // dwStart
+    const int lengthOffset = out.size();
+    appendU32(out, 0);          // dwLength, patched by close()
+    appendU32(out, suggestedBuffer);
+    appendU32(out, 0xFFFFFFFF); // dwQuality: default
+    appendU32(out, sampleSize);
+    appendU16(out, 0);          // rcFrame
+    appendU16(out, 0);
+    appendU16(out, static_cast<quint16>(width));
+    appendU16(out, static_cast<quint16>(height));
+    return lengthOffset;
+}
+
+// Runs of identical bytes starting at pixels[x], up to limit
+int runLength(const unsigned char* pixels, int x, int limit)
+{
+    int length = 1;
+    while (x + length < limit && length < 255 && pixels[x + length] == pixels[x]) {
+        ++length;
+    }
+    return length;
+}
+
+int unchangedLength(const unsigned char* pixels, const unsigned char* previous, int x, int width)
+{
+    int length = 0;
+    while (x + length < width && pixels[x + length] == previous[x + length]) {
+        ++length;
+    }
+    return length;
+}
+
+}  // namespace
+
+AviWriter::~AviWriter()
+{
+    close();
+}
+
+bool AviWriter::open(const QString& path, const Format& format, QString* error)
+{
+    close();
+    m_format = format;
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) {
+            *error = QString("Cannot create %1: %2").arg(path, m_file.errorString());
+        }
+        return false;
+    }
+    m_previous.clear();
+    m_index.clear();
+    m_videoFrames = 0;
+    m_audioBytes = 0;
+    m_failed = false;
+
+    const int width = format.width;
+    const int height = format.height;
+    const bool hasAudio = format.sampleRate > 0;
+    const int blockAlign = format.channels * (format.bitsPerSample / 8);
+    const quint32 rate = static_cast<quint32>(std::lround(format.fps * 1000.0));
+
+    QByteArray header;
+    appendFourcc(header, "RIFF");
+    appendU32(header, 0);  // patched by close()
+    appendFourcc(header, "AVI ");
+
+    QByteArray hdrl;
+    appendFourcc(hdrl, "hdrl");
+    appendFourcc(hdrl, "avih");
+    appendU32(hdrl, 56);
+    appendU32(hdrl, static_cast<quint32>(std::lround(1000000.0 / format.fps)));
+    appendU32(hdrl, static_cast<quint32>(width * height * format.fps) +
+                        (hasAudio ? format.sampleRate * blockAlign : 0));
+    appendU32(hdrl, 0);  // dwPaddingGranularity
+    appendU32(hdrl, kAvifHasIndex | kAvifIsInterleaved);
+    const int totalFramesOffset = hdrl.size();
+    appendU32(hdrl, 0);  // dwTotalFrames, patched by close()
+    appendU32(hdrl, 0);  // dwInitialFrames
+    appendU32(hdrl, hasAudio ? 2 : 1);
+    appendU32(hdrl, static_cast<quint32>(width * height));
+    appendU32(hdrl, static_cast<quint32>(width));
+    appendU32(hdrl, static_cast<quint32>(height));
+    for (int i = 0; i < 4; ++i) {
+        appendU32(hdrl, 0);
+    }
+
+    // Video stream: BITMAPINFOHEADER + 256-entry palette
+    QByteArray videoList;
+    appendFourcc(videoList, "strl");
+    const int videoLengthOffset = appendStreamHeader(videoList, "vids", "mrle", 1000, rate,
+                                                     static_cast<quint32>(width * height), 0, width, height);
+    appendFourcc(videoList, "strf");
+    appendU32(videoList, 40 + 256 * 4);
+    appendU32(videoList, 40);
+    appendU32(videoList, static_cast<quint32>(width));
+    appendU32(videoList, static_cast<quint32>(height));  // positive: bottom-up
+    appendU16(videoList, 1);    // biPlanes
+    appendU16(videoList, 8);    // biBitCount
+    appendU32(videoList, 1);    // BI_RLE8
+    appendU32(videoList, static_cast<quint32>(width * height));
+    appendU32(videoList, 0);
+    appendU32(videoList, 0);
+    appendU32(videoList, 256);  // biClrUsed
+    appendU32(videoList, 0);
+    for (quint32 argb : format.palette) {
+        appendU32(videoList, argb & 0x00FFFFFF);  // RGBQUAD: B, G, R, 0
+    }
+
+    QByteArray audioList;
+    int audioLengthOffset = -1;
+    if (hasAudio) {
+        appendFourcc(audioList, "strl");
+        audioLengthOffset = appendStreamHeader(audioList, "auds", "\0\0\0\0", blockAlign,
+                                               format.sampleRate * blockAlign,
+                                               format.sampleRate * blockAlign / 10, blockAlign, 0, 0);
+        appendFourcc(audioList, "strf");
+        appendU32(audioList, 18);
+        appendU16(audioList, 1);  // WAVE_FORMAT_PCM
+        appendU16(audioList, static_cast<quint16>(format.channels));
+        appendU32(audioList, static_cast<quint32>(format.sampleRate));
+        appendU32(audioList, static_cast<quint32>(format.sampleRate * blockAlign));
+        appendU16(audioList, static_cast<quint16>(blockAlign));
+        appendU16(audioList, static_cast<quint16>(format.bitsPerSample));
+        appendU16(audioList, 0);  // cbSize
+    }
+
+    QByteArray strl;
+    appendFourcc(strl, "LIST");
+    appendU32(strl, static_cast<quint32>(videoList.size()));
+    const int videoListStart = hdrl.size() + strl.size();
+    strl += videoList;
+    int audioListStart = 0;
+    if (hasAudio) {
+        appendFourcc(strl, "LIST");
+        appendU32(strl, static_cast<quint32>(audioList.size()));
+        audioListStart = hdrl.size() + strl.size();
+        strl += audioList;
+    }
+    hdrl += strl;
+
+    appendFourcc(header, "LIST");
+    appendU32(header, static_cast<quint32>(hdrl.size()));
+    const int hdrlStart = header.size();
+    header += hdrl;
+
+    appendFourcc(header, "LIST");
+    appendU32(header, 0);  // movi size, patched by close()
+    m_moviStart = header.size();
+    appendFourcc(header, "movi");
+
+    if (m_file.write(header) != header.size()) {
+        if (error) {
+            *error = QString("Cannot write %1: %2").arg(path, m_file.errorString());
+        }
+        m_file.close();
+        return false;
+    }
+
+    // Remember where close() patches the lengths
+    m_patchTotalFrames = hdrlStart + totalFramesOffset;
+    m_patchVideoLength = hdrlStart + videoListStart + videoLengthOffset;
+    m_patchAudioLength = hasAudio ? hdrlStart + audioListStart + audioLengthOffset : -1;
+    return true;
+}
+
+bool AviWriter::writeChunk(const char* fourccCode, const char* data, int bytes, bool keyframe)
+{
+    if (!m_file.isOpen() || m_failed) {
+        return false;
+    }
+    const qint64 offset = m_file.pos();
+    QByteArray header;
+    appendFourcc(header, fourccCode);
+    appendU32(header, static_cast<quint32>(bytes));
+    bool ok = m_file.write(header) == header.size();
+    if (ok && bytes > 0) {
+        ok = m_file.write(data, bytes) == bytes;
+    }
+    if (ok && (bytes & 1)) {
+        ok = m_file.putChar('\0');  // chunks are word aligned
+    }
+    if (!ok) {
+        m_failed = true;
+        return false;
+    }
+    m_index.append({fourcc(fourccCode), keyframe ? kAviIfKeyframe : 0,
+                    static_cast<quint32>(offset - m_moviStart), static_cast<quint32>(bytes)});
+    return true;
+}
+
+bool AviWriter::writeVideoFrame(const unsigned char* pixels)
+{
+    const int frameBytes = m_format.width * m_format.height;
+    bool ok;
+    if (!pixels) {
+        ok = writeChunk("00dc", nullptr, 0, false);
+    } else {
+        const bool keyframe = m_previous.size() != frameBytes || m_videoFrames % kKeyframeInterval == 0;
+        encodeRle8(pixels,
+                   keyframe ? nullptr : reinterpret_cast<const unsigned char*>(m_previous.constData()),
+                   m_format.width, m_format.height, m_encoded);
+        ok = writeChunk("00dc", m_encoded.constData(), m_encoded.size(), keyframe);
+        m_previous = QByteArray(reinterpret_cast<const char*>(pixels), frameBytes);
+    }
+    if (ok) {
+        m_videoFrames++;
+    }
+    return ok;
+}
+
+bool AviWriter::writeAudio(const unsigned char* data, int bytes)
+{
+    if (m_patchAudioLength < 0 || bytes <= 0) {
+        return true;
+    }
+    if (!writeChunk("01wb", reinterpret_cast<const char*>(data), bytes, true)) {
+        return false;
+    }
+    m_audioBytes += static_cast<quint64>(bytes);
+    return true;
+}
+
+bool AviWriter::patch(qint64 offset, quint32 value)
+{
+    uchar bytes[4];
+    qToLittleEndian(value, bytes);
+    return m_file.seek(offset) && m_file.write(reinterpret_cast<const char*>(bytes), 4) == 4;
+}
+
+bool AviWriter::close()
+{
+    if (!m_file.isOpen()) {
+        return !m_failed;
+    }
+    const qint64 moviEnd = m_file.pos();
+    QByteArray index;
+    appendFourcc(index, "idx1");
+    appendU32(index, static_cast<quint32>(m_index.size() * 16));
+    for (const IndexEntry& entry : m_index) {
+        appendU32(index, entry.fourcc);
+        appendU32(index, entry.flags);
+        appendU32(index, entry.offset);
+        appendU32(index, entry.size);
+    }
+    bool ok = !m_failed && m_file.write(index) == index.size();
+    const qint64 fileEnd = m_file.pos();
+
+    const int blockAlign = m_format.channels * (m_format.bitsPerSample / 8);
+    ok = ok && patch(4, static_cast<quint32>(fileEnd - 8));
+    ok = ok && patch(m_moviStart - 4, static_cast<quint32>(moviEnd - m_moviStart));
+    ok = ok && patch(m_patchTotalFrames, m_videoFrames);
+    ok = ok && patch(m_patchVideoLength, m_videoFrames);
+    if (m_patchAudioLength >= 0 && blockAlign > 0) {
+        ok = ok && patch(m_patchAudioLength, static_cast<quint32>(m_audioBytes / blockAlign));
+    }
+    m_finalSize = fileEnd;
+    m_file.close();
+    m_index.clear();
+    m_previous.clear();
+    m_failed = !ok;
+    return ok;
+}
+
+void AviWriter::encodeRle8(const unsigned char* pixels, const unsigned char* previous, int width,
+                           int height, QByteArray& out)
+{
+    out.clear();
+    out.reserve(width * height / 4);
+    int skippedRows = 0;
+
+    // Bottom-up: the first encoded line is the last row of the image
+    for (int row = height - 1; row >= 0; --row) {
+        const unsigned char* line = pixels + row * width;
+        const unsigned char* before = previous ? previous + row * width : nullptr;
+        if (before && std::memcmp(line, before, static_cast<size_t>(width)) == 0) {
+            ++skippedRows;
+            continue;
+        }
+        while (skippedRows > 0) {
+            const int rows = qMin(skippedRows, 255);
+            out.append('\0').append('\2').append('\0').append(static_cast<char>(rows));
+            skippedRows -= rows;
+        }
+
+        int x = 0;
+        while (x < width) {
+            if (before) {
+                const int unchanged = unchangedLength(line, before, x, width);
+                if (x + unchanged == width) {
+                    break;  // the rest of the line stays
+                }
+                if (unchanged >= kMinDeltaSkip) {
+                    const int skip = qMin(unchanged, 255);
+                    out.append('\0').append('\2').append(static_cast<char>(skip)).append('\0');
+                    x += skip;
+                    continue;
+                }
+            }
+            const int run = runLength(line, x, width);
+            if (run >= 3 || width - x < 3) {
+                out.append(static_cast<char>(run)).append(static_cast<char>(line[x]));
+                x += run;
+                continue;
+            }
+            // Absolute mode: literal bytes up to the next run of 3 or anything skippable
+            int end = x + run;
+            while (end < width && end - x < 255) {
+                if (runLength(line, end, width) >= 3) {
+                    break;
+                }
+                if (before && unchangedLength(line, before, end, width) >= kMinDeltaSkip) {
+                    break;
+                }
+                ++end;
+            }
+            const int literal = end - x;
+            if (literal < 3) {
+                for (int i = 0; i < literal; ++i) {
+                    out.append('\1').append(static_cast<char>(line[x + i]));
+                }
+            } else {
+                out.append('\0').append(static_cast<char>(literal));
+                out.append(reinterpret_cast<const char*>(line + x), literal);
+                if (literal & 1) {
+                    out.append('\0');
+                }
+            }
+            x = end;
+        }
+        if (row > 0) {
+            out.append('\0').append('\0');  // end of line
+        }
+    }
+    out.append('\0').append('\1');  // end of bitmap
+}
+
+bool AviWriter::decodeRle8(const QByteArray& data, int width, int height, unsigned char* pixels)
+{
+    const uchar* in = reinterpret_cast<const uchar*>(data.constData());
+    const int size = data.size();
+    int pos = 0;
+    int x = 0;
+    int y = 0;  // encoded line, 0 = bottom row
+    auto put = [&](uchar value) {
+        if (x >= width || y >= height) {
+            return false;
+        }
+        pixels[(height - 1 - y) * width + x] = value;
+        ++x;
+        return true;
+    };
+    while (pos + 1 < size) {
+        const uchar count = in[pos++];
+        const uchar code = in[pos++];
+        if (count > 0) {
+            for (int i = 0; i < count; ++i) {
+                if (!put(code)) {
+                    return false;
+                }
+            }
+        } else if (code == 0) {
+            x = 0;
+            ++y;
+        } else if (code == 1) {
+            return true;
+        } else if (code == 2) {
+            if (pos + 1 >= size) {
+                return false;
+            }
+            x += in[pos++];
+            y += in[pos++];
+        } else {
+            if (pos + code > size) {
+                return false;
+            }
+            for (int i = 0; i < code; ++i) {
+                if (!put(in[pos + i])) {
+                    return false;
+                }
+            }
+            pos += code + (code & 1);
+        }
+    }
+    return false;  // no end of bitmap
+}
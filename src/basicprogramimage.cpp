@@ -0,0 +1,66 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "basicprogramimage.h"
+
+#include <algorithm>
+#include <iterator>
+
+bool BasicProgramImage::parse(const QByteArray& file, QString* error)
+{
+    const auto fail = [this, error](const QString& message) {
+        m_body.clear();
+        std::fill(std::begin(m_pointers), std::end(m_pointers), 0);
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    if (file.size() < kHeaderBytes) {
+        return fail(QStringLiteral("Too short for a BASIC program"));
+    }
+    for (int i = 0; i < PointerCount; ++i) {
+        m_pointers[i] = static_cast<quint8>(file[2 * i]) | (static_cast<quint8>(file[2 * i + 1]) << 8);
+    }
+    if (m_pointers[LOMEM] != 0) {
+        return fail(QStringLiteral("Not a tokenized BASIC program (LOMEM is not 0)"));
+    }
+    for (int i = VNTP; i < PointerCount; ++i) {
+        if (m_pointers[i] < m_pointers[i - 1]) {
+            return fail(QStringLiteral("BASIC table pointers are out of order"));
+        }
+    }
+    // Each variable value table entry is 8 bytes; STMCUR points at the last
+    // (immediate mode) line, so it must fall inside the statement table
+    if ((m_pointers[STMTAB] - m_pointers[VVTP]) % 8 != 0 || m_pointers[STMCUR] >= m_pointers[STARP]) {
+        return fail(QStringLiteral("BASIC table pointers are inconsistent"));
+    }
+    const int bodySize = m_pointers[STARP] - m_pointers[VNTP];
+    if (file.size() < kHeaderBytes + bodySize) {
+        return fail(QStringLiteral("BASIC program is truncated (%1 of %2 bytes)")
+                        .arg(file.size() - kHeaderBytes).arg(bodySize));
+    }
+    m_body = file.mid(kHeaderBytes, bodySize);
+    return true;
+}
+
+QByteArray BasicProgramImage::zeroPage(quint16 lomem) const
+{
+    QByteArray page;
+    page.reserve(2 * (PointerCount + 2));
+    const auto appendWord = [&page](int value) {
+        page.append(static_cast<char>(value & 0xFF));
+        page.append(static_cast<char>((value >> 8) & 0xFF));
+    };
+    for (int i = 0; i < PointerCount; ++i) {
+        appendWord(lomem + m_pointers[i]);
+    }
+    appendWord(lomem + m_pointers[STARP]);  // RUNSTK
+    appendWord(lomem + m_pointers[STARP]);  // MEMTOP
+    return page;
+}
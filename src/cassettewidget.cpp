@@ -134,7 +134,10 @@ void CassetteWidget::setState(CassetteState state)
 
 void CassetteWidget::loadCassette(const QString& cassettePath)
 {
-    // TODO: Integrate with libatari800 cassette loading when available
+    if (!m_emulator || !m_emulator->insertCassette(cassettePath)) {
+        qWarning() << "Failed to load cassette:" << cassettePath;
+        return;
+    }
     m_cassettePath = cassettePath;
     setState(m_cassetteEnabled ? On : Off);
     updateTooltip();
@@ -145,7 +148,9 @@ void CassetteWidget::loadCassette(const QString& cassettePath)
 void CassetteWidget::ejectCassette()
 {
     if (hasCassette()) {
-        // TODO: Add libatari800 cassette eject functionality when available
+        if (m_emulator) {
+            m_emulator->ejectCassette();
+        }
         m_cassettePath.clear();
         setState(Off);
         updateTooltip();
@@ -165,7 +170,10 @@ void CassetteWidget::setCassetteEnabled(bool enabled)
 
 void CassetteWidget::updateFromEmulator()
 {
-    // TODO: Get current cassette state from emulator when available
+    if (m_emulator) {
+        m_cassettePath = m_emulator->getCassettePath();
+        setState(m_cassetteEnabled && hasCassette() ? On : Off);
+    }
     updateTooltip();
 }
 
@@ -0,0 +1,420 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "codeanalyzer.h"
+#include "disasm6502.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+unsigned short readWord(const unsigned char* memory, unsigned short address)
+{
+    return static_cast<unsigned short>(memory[address] | (memory[static_cast<unsigned short>(address + 1)] << 8));
+}
+
+bool isDocumented(const OpcodeInfo6502& info)
+{
+    return info.mnemonic[0] != '?';
+}
+
+// Where flow continues after the instruction at pc, other than the next
+// instruction: branch, jump and call targets and JMP ($xxxx) vectors.
+bool flowTarget(const unsigned char* memory, unsigned short pc, unsigned short* target)
+{
+    const OpcodeInfo6502& info = opcodeInfo6502(memory[pc]);
+    switch (info.flow) {
+        case FlowKind6502::Branch:
+        case FlowKind6502::Jump:
+        case FlowKind6502::Call:
+            return operandAddress6502(memory, pc, target);
+        case FlowKind6502::JumpIndirect: {
+            const unsigned short vector = readWord(memory, static_cast<unsigned short>(pc + 1));
+            // The 6502 does not carry into the high byte: JMP ($10FF) reads $10FF and $1000
+            *target = static_cast<unsigned short>(
+                memory[vector] | (memory[(vector & 0xFF00) | ((vector + 1) & 0xFF)] << 8));
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool fallsThrough(FlowKind6502 flow)
+{
+    return flow == FlowKind6502::None || flow == FlowKind6502::Branch || flow == FlowKind6502::Call;
+}
+
+bool parseHexAddress(QByteArray text, unsigned short* address)
+{
+    // VICE writes "C:0600"
+    const int colon = text.indexOf(':');
+    if (colon >= 0) {
+        text = text.mid(colon + 1);
+    }
+    bool ok = false;
+    const uint value = text.toUInt(&ok, 16);
+    if (!ok || value > 0xFFFF) {
+        return false;
+    }
+    *address = static_cast<unsigned short>(value);
+    return true;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// CodeFlowTracer
+// ---------------------------------------------------------------------------
+
+CodeFlowTracer::CodeFlowTracer()
+    : m_kinds(0x10000, Unknown)
+    , m_snapshot(0x10000, 0)
+{
+}
+
+void CodeFlowTracer::reset()
+{
+    std::fill(m_kinds.begin(), m_kinds.end(), Unknown);
+    m_primed = false;
+}
+
+int CodeFlowTracer::codeBytes() const
+{
+    return static_cast<int>(m_kinds.size() - std::count(m_kinds.begin(), m_kinds.end(), Unknown));
+}
+
+QVector<unsigned short> CodeFlowTracer::vectorEntryPoints(const unsigned char* memory)
+{
+    static const unsigned short kVectors[] = {
+        0xFFFA, 0xFFFC, 0xFFFE,  // NMI, RESET, IRQ
+        0x000A, 0x000C,          // DOSVEC, DOSINI
+        0x02E0, 0x02E2,          // RUNAD, INITAD
+        0x0200, 0x0222, 0x0224   // VDSLST, VVBLKI, VVBLKD
+    };
+    QVector<unsigned short> entries;
+    for (unsigned short vector : kVectors) {
+        const unsigned short address = readWord(memory, vector);
+        if (address != 0) {
+            entries.append(address);
+        }
+    }
+    return entries;
+}
+
+int CodeFlowTracer::update(const unsigned char* memory, const QVector<unsigned short>& entryPoints)
+{
+    int pages = 0;
+    QVector<unsigned short> pending;
+
+    if (!m_primed) {
+        std::fill(m_kinds.begin(), m_kinds.end(), Unknown);
+        m_primed = true;
+        pages = kPages;
+    } else {
+        // Clear what the old bytes said about each changed page, then re-enter
+        // it from any known code whose flow now lands on unclassified bytes
+        const auto unknownBefore = std::count(m_kinds.begin(), m_kinds.end(), Unknown);
+        for (int page = 0; page < kPages; ++page) {
+            const int base = page * kPageSize;
+            if (std::memcmp(memory + base, &m_snapshot[base], kPageSize) != 0) {
+                invalidatePage(page, m_snapshot.data());
+                ++pages;
+            }
+        }
+        if (std::count(m_kinds.begin(), m_kinds.end(), Unknown) != unknownBefore) {
+            for (int address = 0; address < 0x10000; ++address) {
+                if (m_kinds[address] != CodeStart) {
+                    continue;
+                }
+                const unsigned short pc = static_cast<unsigned short>(address);
+                const OpcodeInfo6502& info = opcodeInfo6502(memory[pc]);
+                unsigned short target = 0;
+                if (flowTarget(memory, pc, &target) && m_kinds[target] == Unknown) {
+                    pending.append(target);
+                }
+                const unsigned short next = static_cast<unsigned short>(pc + info.bytes);
+                if (fallsThrough(info.flow) && m_kinds[next] == Unknown) {
+                    pending.append(next);
+                }
+            }
+        }
+    }
+    std::memcpy(m_snapshot.data(), memory, m_snapshot.size());
+
+    pending += entryPoints;
+    pending += vectorEntryPoints(memory);
+    trace(memory, pending);
+    return pages;
+}
+
+void CodeFlowTracer::clearInstruction(unsigned short start, const unsigned char* memory)
+{
+    const int bytes = opcodeInfo6502(memory[start]).bytes;
+    for (int i = 0; i < bytes; ++i) {
+        m_kinds[static_cast<unsigned short>(start + i)] = Unknown;
+    }
+}
+
+void CodeFlowTracer::invalidatePage(int page, const unsigned char* memory)
+{
+    const int base = page * kPageSize;
+
+    // An instruction from the previous page whose operand reaches into this one
+    for (int back = 2; back >= 1; --back) {
+        const unsigned short start = static_cast<unsigned short>(base - back);
+        if (m_kinds[start] == CodeStart && opcodeInfo6502(memory[start]).bytes > back) {
+            clearInstruction(start, memory);
+        }
+    }
+    // Instructions starting here, including operands that reach the next page
+    for (int address = base; address < base + kPageSize; ++address) {
+        if (m_kinds[address] == CodeStart) {
+            clearInstruction(static_cast<unsigned short>(address), memory);
+        }
+    }
+    std::fill(m_kinds.begin() + base, m_kinds.begin() + base + kPageSize, Unknown);
+}
+
+void CodeFlowTracer::trace(const unsigned char* memory, QVector<unsigned short>& pending)
+{
+    while (!pending.isEmpty()) {
+        unsigned short pc = pending.takeLast();
+        for (;;) {
+            if (m_kinds[pc] != Unknown) {
+                break;  // already traced, or the middle of another instruction
+            }
+            const OpcodeInfo6502& info = opcodeInfo6502(memory[pc]);
+            if (!isDocumented(info)) {
+                break;
+            }
+            bool overlaps = false;
+            for (int i = 1; i < info.bytes; ++i) {
+                overlaps = overlaps || m_kinds[static_cast<unsigned short>(pc + i)] != Unknown;
+            }
+            if (overlaps) {
+                break;
+            }
+
+            m_kinds[pc] = CodeStart;
+            for (int i = 1; i < info.bytes; ++i) {
+                m_kinds[static_cast<unsigned short>(pc + i)] = CodeOperand;
+            }
+            unsigned short target = 0;
+            if (flowTarget(memory, pc, &target)) {
+                pending.append(target);
+            }
+            if (!fallsThrough(info.flow)) {
+                break;
+            }
+            pc = static_cast<unsigned short>(pc + info.bytes);
+        }
+    }
+}
+
+unsigned short CodeFlowTracer::instructionStartBefore(const unsigned char* kinds, const unsigned char* memory,
+                                                      unsigned short address, int instructions, int fallbackBytes)
+{
+    if (!kinds || kinds[address] != CodeStart) {
+        return address >= fallbackBytes ? static_cast<unsigned short>(address - fallbackBytes) : 0;
+    }
+    unsigned short start = address;
+    for (int n = 0; n < instructions; ++n) {
+        bool found = false;
+        for (int back = 1; back <= 3 && back <= start; ++back) {
+            const unsigned short candidate = static_cast<unsigned short>(start - back);
+            if (kinds[candidate] == CodeStart && opcodeInfo6502(memory[candidate]).bytes == back) {
+                start = candidate;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            break;  // data, or code not reached yet
+        }
+    }
+    return start;
+}
+
+// ---------------------------------------------------------------------------
+// CodeAnalyzer
+// ---------------------------------------------------------------------------
+
+CodeAnalyzer::CodeAnalyzer()
+    : m_labels(std::make_shared<const Labels>())
+{
+}
+
+CodeAnalyzer::~CodeAnalyzer()
+{
+    stop();
+}
+
+void CodeAnalyzer::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_thread) {
+            return;
+        }
+        m_stopping = true;
+        m_wake.wakeAll();
+    }
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+void CodeAnalyzer::submit(const unsigned char* memory, int pc)
+{
+    QMutexLocker locker(&m_mutex);
+    m_pending.resize(0x10000);
+    std::memcpy(m_pending.data(), memory, m_pending.size());
+    m_hasPending = true;
+
+    if (pc >= 0 && !m_observedPCs.contains(static_cast<unsigned short>(pc))) {
+        if (m_observedPCs.size() >= kMaxObservedPCs) {
+            m_observedPCs.removeFirst();
+        }
+        m_observedPCs.append(static_cast<unsigned short>(pc));
+    }
+
+    if (!m_thread) {
+        m_stopping = false;
+        m_thread = QThread::create([this]() { analyzeLoop(); });
+        m_thread->setObjectName("CodeAnalyzer");
+        m_thread->start(QThread::LowPriority);
+    }
+    m_wake.wakeOne();
+}
+
+void CodeAnalyzer::addEntryPoint(unsigned short address)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_entryPoints.contains(address)) {
+        m_entryPoints.append(address);
+    }
+}
+
+void CodeAnalyzer::clearEntryPoints()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entryPoints.clear();
+    m_observedPCs.clear();
+}
+
+void CodeAnalyzer::analyzeLoop()
+{
+    for (;;) {
+        QVector<unsigned short> roots;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (!m_hasPending && !m_stopping) {
+                m_wake.wait(&m_mutex);
+            }
+            if (m_stopping) {
+                return;
+            }
+            m_working.swap(m_pending);
+            m_hasPending = false;
+            roots = m_entryPoints + m_observedPCs;
+        }
+
+        m_tracer.update(m_working.data(), roots);
+
+        auto analysis = std::make_shared<Analysis>();
+        analysis->kinds.assign(m_tracer.kinds(), m_tracer.kinds() + 0x10000);
+        QMutexLocker locker(&m_mutex);
+        analysis->generation = ++m_generation;
+        m_analysis = analysis;
+    }
+}
+
+std::shared_ptr<const CodeAnalyzer::Analysis> CodeAnalyzer::analysis() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_analysis;
+}
+
+CodeAnalyzer::Labels CodeAnalyzer::parseLabels(const QByteArray& text)
+{
+    Labels labels;
+    const QList<QByteArray> lines = text.split('\n');
+    for (const QByteArray& rawLine : lines) {
+        const QList<QByteArray> fields = rawLine.simplified().split(' ');
+        if (fields.size() < 3) {
+            continue;  // blank lines and the MADS "Label table:" header
+        }
+
+        unsigned short address = 0;
+        QByteArray name;
+        if (fields[0] == "al") {
+            // ca65 -Ln / VICE: "al 000600 .start"
+            if (!parseHexAddress(fields[1], &address)) {
+                continue;
+            }
+            name = fields[2].startsWith('.') ? fields[2].mid(1) : fields[2];
+        } else {
+            // MADS: "00\t0600\tSTART", bank first; only the main bank is mapped
+            bool ok = false;
+            const uint bank = fields[0].toUInt(&ok, 16);
+            if (!ok || bank != 0 || fields[0].size() != 2 || !parseHexAddress(fields[1], &address)) {
+                continue;
+            }
+            name = fields[2];
+        }
+        if (!name.isEmpty() && !labels.contains(address)) {
+            labels.insert(address, name);
+        }
+    }
+    return labels;
+}
+
+bool CodeAnalyzer::loadLabels(const QString& path, QString* error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = QString("Cannot open label file: %1").arg(file.errorString());
+        }
+        return false;
+    }
+    auto labels = std::make_shared<const Labels>(parseLabels(file.readAll()));
+    if (labels->isEmpty()) {
+        if (error) {
+            *error = QString("No MADS or ca65 labels found in %1").arg(QFileInfo(path).fileName());
+        }
+        return false;
+    }
+    QMutexLocker locker(&m_mutex);
+    m_labels = labels;
+    return true;
+}
+
+void CodeAnalyzer::clearLabels()
+{
+    QMutexLocker locker(&m_mutex);
+    m_labels = std::make_shared<const Labels>();
+}
+
+std::shared_ptr<const CodeAnalyzer::Labels> CodeAnalyzer::labels() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_labels;
+}
+
+const char* CodeAnalyzer::lookupLabel(unsigned short address, const void* context)
+{
+    const Labels* labels = static_cast<const Labels*>(context);
+    const auto it = labels->constFind(address);
+    return it == labels->constEnd() ? nullptr : it->constData();
+}
@@ -12,6 +12,7 @@
 #include <QJsonArray>
 #include <QDebug>
 #include <QRegularExpression>
+#include <QSaveFile>
 
 const QString ProfileStorage::PROFILE_EXTENSION = ".profile";
 const QString ProfileStorage::PROFILE_SUBDIR = "profiles";
@@ -53,6 +54,7 @@ QJsonObject ConfigurationProfile::toJson() const {
     QJsonObject performanceConfig;
     performanceConfig["turboMode"] = turboMode;
     performanceConfig["emulationSpeedIndex"] = emulationSpeedIndex;
+    performanceConfig["runAheadFrames"] = runAheadFrames;
     json["performanceConfig"] = performanceConfig;
     
     // Audio Configuration
@@ -239,6 +241,7 @@ void ConfigurationProfile::fromJson(const QJsonObject& json) {
         QJsonObject performanceConfig = json["performanceConfig"].toObject();
         turboMode = performanceConfig["turboMode"].toBool(false);
         emulationSpeedIndex = performanceConfig["emulationSpeedIndex"].toInt(1);
+        runAheadFrames = performanceConfig["runAheadFrames"].toInt(0);
     }
     
     // Audio Configuration
@@ -447,8 +450,10 @@ bool ProfileStorage::saveProfileToFile(const QString& name, const ConfigurationP
         return false;
     }
     
+    // Written to a temporary file and renamed into place, so the profile
+    // index watching this directory never parses a half-written file
     QString filePath = getProfileFilePath(name);
-    QFile file(filePath);
+    QSaveFile file(filePath);
     
     if (!file.open(QIODevice::WriteOnly)) {
         qWarning() << "Failed to open profile file for writing:" << filePath;
@@ -457,7 +462,10 @@ bool ProfileStorage::saveProfileToFile(const QString& name, const ConfigurationP
     
     QJsonDocument doc(profile.toJson());
     file.write(doc.toJson());
-    file.close();
+    if (!file.commit()) {
+        qWarning() << "Failed to write profile file:" << filePath;
+        return false;
+    }
     
     qDebug() << "Profile saved successfully:" << filePath;
     return true;
@@ -540,7 +548,7 @@ bool ProfileStorage::isValidProfileName(const QString& name) {
     }
     
     // Check for invalid characters
-    QRegularExpression invalidChars("[<>:\"/\\|?*]");
+    static const QRegularExpression invalidChars("[<>:\"/\\|?*]");
     if (invalidChars.match(name).hasMatch()) {
         return false;
     }
@@ -561,7 +569,7 @@ QString ProfileStorage::sanitizeProfileName(const QString& name) {
     QString sanitized = name;
     
     // Replace invalid characters with underscores
-    QRegularExpression invalidChars("[<>:\"/\\|?*]");
+    static const QRegularExpression invalidChars("[<>:\"/\\|?*]");
     sanitized.replace(invalidChars, "_");
     
     // Trim whitespace and limit length
@@ -8,7 +8,30 @@
 #include "configurationprofilemanager.h"
 #include <QDebug>
 #include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QRunnable>
 #include <QSettings>
+#include <functional>
+
+namespace {
+
+// Watcher notifications arrive in bursts (a save replaces the file and touches
+// the directory); one rescan covers them all.
+constexpr int kRescanDebounceMs = 100;
+constexpr int kPreloadChunkBytes = 64 * 1024;
+
+class ProfileIoTask : public QRunnable
+{
+public:
+    explicit ProfileIoTask(std::function<void()> work) : m_work(std::move(work)) {}
+    void run() override { m_work(); }
+
+private:
+    std::function<void()> m_work;
+};
+
+} // namespace
 
 ConfigurationProfileManager::ConfigurationProfileManager(QObject *parent)
     : QObject(parent)
@@ -18,10 +41,24 @@ ConfigurationProfileManager::ConfigurationProfileManager(QObject *parent)
     QSettings settings("8bitrelics", "Fujisan");
     m_currentProfileName = settings.value("profile/current", "Default").toString();
     
+    m_ioPool.setMaxThreadCount(1);
+    m_rescanTimer.setSingleShot(true);
+    m_rescanTimer.setInterval(kRescanDebounceMs);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, &m_rescanTimer, QOverload<>::of(&QTimer::start));
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, &m_rescanTimer, QOverload<>::of(&QTimer::start));
+    connect(&m_rescanTimer, &QTimer::timeout, this, &ConfigurationProfileManager::onProfileDirectoryChanged);
+    
+    ProfileStorage::ensureProfileDirectoryExists();
     updateProfileCache();
     createDefaultProfilesIfNeeded();
 }
 
+ConfigurationProfileManager::~ConfigurationProfileManager()
+{
+    // Background tasks reference this object; let pending lastUsed writes land
+    waitForPendingWrites();
+}
+
 QStringList ConfigurationProfileManager::getProfileNames() const
 {
     return m_cachedProfileList;
@@ -29,17 +66,40 @@ QStringList ConfigurationProfileManager::getProfileNames() const
 
 ConfigurationProfile ConfigurationProfileManager::loadProfile(const QString& name)
 {
-    if (!isValidProfileName(name) || !profileExists(name)) {
+    auto it = m_profileIndex.find(name);
+    if (it == m_profileIndex.end() && isValidProfileName(name)) {
+        // Created since the last scan and the watcher has not caught up yet
+        updateProfileCache();
+        it = m_profileIndex.find(name);
+    }
+    if (!isValidProfileName(name) || it == m_profileIndex.end()) {
         qWarning() << "Cannot load invalid or non-existent profile:" << name;
         return ConfigurationProfile();
     }
     
-    ConfigurationProfile profile = ProfileStorage::loadProfileFromFile(name);
+    ConfigurationProfile profile = it->profile;
     
     if (profile.isValid()) {
-        // Update last used time
+        // Update last used time in the index now and on disk in the background,
+        // so switching profiles does not wait for the write
         profile.updateLastUsed();
-        ProfileStorage::saveProfileToFile(name, profile);
+        it->profile.lastUsed = profile.lastUsed;
+        m_ioPool.start(new ProfileIoTask([this, name, profile]() {
+            if (!ProfileStorage::saveProfileToFile(name, profile)) {
+                return;
+            }
+            // Record what was written so the watcher's rescan does not parse it again
+            const QFileInfo info(ProfileStorage::getProfileFilePath(name));
+            const QDateTime modified = info.lastModified();
+            const qint64 size = info.size();
+            QMetaObject::invokeMethod(this, [this, name, modified, size]() {
+                auto entry = m_profileIndex.find(name);
+                if (entry != m_profileIndex.end()) {
+                    entry->modified = modified;
+                    entry->size = size;
+                }
+            }, Qt::QueuedConnection);
+        }));
         
         qDebug() << "Profile loaded successfully:" << name;
     } else {
@@ -62,16 +122,15 @@ bool ConfigurationProfileManager::saveProfile(const QString& name, const Configu
     profileToSave.updateLastUsed();
     
     // If this is a new profile, set creation time
-    if (!profileExists(name)) {
+    const auto existing = m_profileIndex.constFind(name);
+    if (existing == m_profileIndex.constEnd()) {
         profileToSave.created = QDateTime::currentDateTime();
-    } else {
+    } else if (existing->profile.isValid()) {
         // Preserve original creation time
-        ConfigurationProfile existingProfile = ProfileStorage::loadProfileFromFile(name);
-        if (existingProfile.isValid()) {
-            profileToSave.created = existingProfile.created;
-        }
+        profileToSave.created = existing->profile.created;
     }
     
+    waitForPendingWrites();
     bool success = ProfileStorage::saveProfileToFile(name, profileToSave);
     
     if (success) {
@@ -99,6 +158,7 @@ bool ConfigurationProfileManager::deleteProfile(const QString& name)
         return false;
     }
     
+    waitForPendingWrites();
     bool success = ProfileStorage::deleteProfileFile(name);
     
     if (success) {
@@ -142,13 +202,14 @@ bool ConfigurationProfileManager::renameProfile(const QString& oldName, const QS
     }
     
     // Load the profile
-    ConfigurationProfile profile = ProfileStorage::loadProfileFromFile(oldName);
+    ConfigurationProfile profile = m_profileIndex.value(oldName).profile;
     if (!profile.isValid()) {
         qWarning() << "Failed to load profile for rename:" << oldName;
         return false;
     }
     
     // Save with new name
+    waitForPendingWrites();
     profile.name = newName;
     bool saveSuccess = ProfileStorage::saveProfileToFile(newName, profile);
     
@@ -203,7 +264,7 @@ void ConfigurationProfileManager::setCurrentProfileName(const QString& name)
 
 bool ConfigurationProfileManager::profileExists(const QString& name) const
 {
-    return ProfileStorage::profileFileExists(name);
+    return m_profileIndex.contains(name);
 }
 
 int ConfigurationProfileManager::getProfileCount() const
@@ -213,22 +274,14 @@ int ConfigurationProfileManager::getProfileCount() const
 
 QDateTime ConfigurationProfileManager::getProfileLastUsed(const QString& name) const
 {
-    if (!profileExists(name)) {
-        return QDateTime();
-    }
-    
-    ConfigurationProfile profile = ProfileStorage::loadProfileFromFile(name);
-    return profile.lastUsed;
+    const auto it = m_profileIndex.constFind(name);
+    return it != m_profileIndex.constEnd() ? it->profile.lastUsed : QDateTime();
 }
 
 QString ConfigurationProfileManager::getProfileDescription(const QString& name) const
 {
-    if (!profileExists(name)) {
-        return QString();
-    }
-    
-    ConfigurationProfile profile = ProfileStorage::loadProfileFromFile(name);
-    return profile.description;
+    const auto it = m_profileIndex.constFind(name);
+    return it != m_profileIndex.constEnd() ? it->profile.description : QString();
 }
 
 QString ConfigurationProfileManager::generateUniqueProfileName(const QString& baseName) const
@@ -276,6 +329,55 @@ void ConfigurationProfileManager::createDefaultProfilesIfNeeded()
     }
 }
 
+void ConfigurationProfileManager::preloadProfileMedia(const QString& name)
+{
+    const auto it = m_profileIndex.constFind(name);
+    if (it == m_profileIndex.constEnd()) {
+        return;
+    }
+    
+    const ConfigurationProfile& profile = it->profile;
+    QStringList paths;
+    paths << profile.osRomPath << profile.basicRomPath;
+    if (profile.primaryCartridge.enabled) {
+        paths << profile.primaryCartridge.path;
+    }
+    if (profile.piggybackCartridge.enabled) {
+        paths << profile.piggybackCartridge.path;
+    }
+    for (const ConfigurationProfile::DiskConfig& disk : profile.disks) {
+        if (disk.enabled) {
+            paths << disk.path;
+        }
+    }
+    if (profile.cassette.enabled) {
+        paths << profile.cassette.path;
+    }
+    paths.removeAll(QString());
+    paths.removeDuplicates();
+    if (paths.isEmpty()) {
+        return;
+    }
+    
+    // libatari800 opens media itself, so warm the OS file cache rather than
+    // holding copies: the reads it does on a switch then come from memory
+    const int generation = ++m_preloadGeneration;
+    m_ioPool.start(new ProfileIoTask([this, paths, generation]() {
+        QByteArray chunk(kPreloadChunkBytes, Qt::Uninitialized);
+        for (const QString& path : paths) {
+            if (m_preloadGeneration.load() != generation) {
+                return;
+            }
+            QFile file(path);
+            if (file.size() > kMaxPreloadFileBytes || !file.open(QIODevice::ReadOnly)) {
+                continue;
+            }
+            while (m_preloadGeneration.load() == generation
+                   && file.read(chunk.data(), chunk.size()) > 0) {
+            }
+        }
+    }));
+}
 
 void ConfigurationProfileManager::refreshProfileList()
 {
@@ -285,7 +387,34 @@ void ConfigurationProfileManager::refreshProfileList()
 
 void ConfigurationProfileManager::updateProfileCache()
 {
-    m_cachedProfileList = ProfileStorage::getAvailableProfiles();
+    // Only files whose size or modification time changed are parsed again
+    const QStringList names = ProfileStorage::getAvailableProfiles();
+    QHash<QString, IndexEntry> index;
+    index.reserve(names.size());
+    for (const QString& name : names) {
+        const QFileInfo info(ProfileStorage::getProfileFilePath(name));
+        const auto existing = m_profileIndex.constFind(name);
+        if (existing != m_profileIndex.constEnd()
+            && existing->modified == info.lastModified() && existing->size == info.size()) {
+            index.insert(name, *existing);
+            continue;
+        }
+        
+        IndexEntry entry;
+        entry.profile = ProfileStorage::loadProfileFromFile(name);
+        entry.modified = info.lastModified();
+        entry.size = info.size();
+        if (!entry.profile.isValid() && existing != m_profileIndex.constEnd()) {
+            // Unreadable right now (e.g. an editor mid-save): keep the last good
+            // copy and clear its stamp so the next scan tries again
+            entry.profile = existing->profile;
+            entry.modified = QDateTime();
+        }
+        index.insert(name, entry);
+    }
+    m_profileIndex.swap(index);
+    
+    m_cachedProfileList = names;
     
     // Ensure Default is always first in the list
     if (m_cachedProfileList.contains("Default")) {
@@ -293,9 +422,61 @@ void ConfigurationProfileManager::updateProfileCache()
         m_cachedProfileList.prepend("Default");
     }
     
+    watchProfileFiles();
     qDebug() << "Profile cache updated:" << m_cachedProfileList.size() << "profiles found";
 }
 
+void ConfigurationProfileManager::onProfileDirectoryChanged()
+{
+    const QStringList previous = m_cachedProfileList;
+    updateProfileCache();
+    if (m_cachedProfileList != previous) {
+        emit profileListChanged();
+    }
+}
+
+void ConfigurationProfileManager::watchProfileFiles()
+{
+    // The directory reports added, removed and renamed profiles; each file
+    // reports edits made in place. Replaced files drop out of the watcher, so
+    // the set is brought up to date after every scan.
+    QStringList wanted;
+    const QString directory = ProfileStorage::getProfileDirectory();
+    if (QFileInfo::exists(directory)) {
+        wanted << directory;
+    }
+    for (const QString& name : m_cachedProfileList) {
+        wanted << ProfileStorage::getProfileFilePath(name);
+    }
+    
+    const QStringList watched = m_watcher.files() + m_watcher.directories();
+    QStringList stale;
+    for (const QString& path : watched) {
+        if (!wanted.contains(path)) {
+            stale << path;
+        }
+    }
+    QStringList missing;
+    for (const QString& path : wanted) {
+        if (!watched.contains(path)) {
+            missing << path;
+        }
+    }
+    if (!stale.isEmpty()) {
+        m_watcher.removePaths(stale);
+    }
+    if (!missing.isEmpty()) {
+        m_watcher.addPaths(missing);
+    }
+}
+
+void ConfigurationProfileManager::waitForPendingWrites()
+{
+    // Cancel running preloads; queued lastUsed writes still complete
+    ++m_preloadGeneration;
+    m_ioPool.waitForDone();
+}
+
 bool ConfigurationProfileManager::validateProfile(const ConfigurationProfile& profile) const
 {
     // Basic validation
@@ -0,0 +1,245 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "cycleprofiler.h"
+#include "disasm6502.h"
+
+#include <algorithm>
+
+namespace {
+
+const int kBankWindowStart = 0x4000;
+const int kBankWindowSize = 0x4000;
+// Longer than any instruction plus a WSYNC stall: the records are not adjacent
+const int kMaxInstructionCycles = 2 * CycleProfiler::kCyclesPerLine;
+
+bool inBankWindow(quint16 address)
+{
+    return address >= kBankWindowStart && address < kBankWindowStart + kBankWindowSize;
+}
+
+// S after the instruction, if no interrupt follows it
+int stackAfter(const TraceRecorder::RawRecord& record)
+{
+    switch (record.opcode) {
+    case 0x48:  // PHA
+    case 0x08:  // PHP
+        return (record.s - 1) & 0xFF;
+    case 0x68:  // PLA
+    case 0x28:  // PLP
+        return (record.s + 1) & 0xFF;
+    case 0x20:  // JSR
+        return (record.s - 2) & 0xFF;
+    case 0x60:  // RTS
+        return (record.s + 2) & 0xFF;
+    case 0x40:  // RTI
+        return (record.s + 3) & 0xFF;
+    case 0x00:  // BRK
+        return (record.s - 3) & 0xFF;
+    case 0x9A:  // TXS
+        return record.x;
+    default:
+        return record.s;
+    }
+}
+
+}  // namespace
+
+CycleProfiler::CycleProfiler()
+{
+    reset();
+}
+
+void CycleProfiler::reset()
+{
+    m_splitBanks = m_splitBanksRequested;
+    m_counters.assign(0x10000, Counter());
+    m_bankCounters.clear();
+    m_functions.clear();
+    m_root = FunctionStats();
+    m_stack.clear();
+    m_hasPending = false;
+    m_cycles = 0;
+    m_instructions = 0;
+    m_frames = 0;
+    m_generation++;
+}
+
+void CycleProfiler::addFrame(const TraceRecorder::RawRecord* records, int count, bool continuous)
+{
+    if (!continuous) {
+        m_hasPending = false;
+    }
+    for (int i = 0; i < count; ++i) {
+        if (m_hasPending) {
+            account(m_pending, records[i]);
+        }
+        m_pending = records[i];
+        m_hasPending = true;
+    }
+    m_frames++;
+    m_generation++;
+}
+
+CycleProfiler::Counter& CycleProfiler::counter(quint16 address, quint8 bank)
+{
+    if (m_splitBanks && bank != 0 && inBankWindow(address)) {
+        std::vector<Counter>& window = m_bankCounters[bank];
+        if (window.empty()) {
+            window.resize(kBankWindowSize);
+        }
+        return window[address - kBankWindowStart];
+    }
+    return m_counters[address];
+}
+
+quint64 CycleProfiler::cyclesAt(quint16 address, int bank) const
+{
+    if (m_splitBanks && bank != 0 && inBankWindow(address)) {
+        const auto it = m_bankCounters.find(bank);
+        return it == m_bankCounters.end() ? 0 : it->second[address - kBankWindowStart].cycles;
+    }
+    return m_counters[address].cycles;
+}
+
+quint32 CycleProfiler::functionKey(quint16 entry, quint8 bank, bool interrupt) const
+{
+    const quint32 keyBank = (m_splitBanks && inBankWindow(entry)) ? bank : 0;
+    return (interrupt ? 0x1000000u : 0u) | (keyBank << 16) | entry;
+}
+
+void CycleProfiler::account(const TraceRecorder::RawRecord& record, const TraceRecorder::RawRecord& next)
+{
+    const int framePosition = m_linesPerFrame * kCyclesPerLine;
+    int elapsed = (next.scanline * kCyclesPerLine + next.cycle) -
+                  (record.scanline * kCyclesPerLine + record.cycle);
+    if (elapsed <= 0) {
+        elapsed += framePosition;  // the frame ended in between
+    }
+    if (elapsed > kMaxInstructionCycles) {
+        elapsed = qMax(2, int(opcodeInfo6502(record.opcode).cycles));
+    }
+
+    Counter& slot = counter(record.pc, record.bank);
+    slot.cycles += static_cast<quint64>(elapsed);
+    slot.instructions++;
+    m_cycles += static_cast<quint64>(elapsed);
+    m_instructions++;
+    (m_stack.empty() ? m_root : *m_stack.back().stats).selfCycles += static_cast<quint64>(elapsed);
+
+    // Call graph: the instruction's own effect on S, then an interrupt taken after it
+    const int expected = stackAfter(record);
+    switch (record.opcode) {
+    case 0x20:  // JSR
+        push(next.pc, next.bank, false, record.s);
+        break;
+    case 0x00:  // BRK
+        push(next.pc, next.bank, true, record.s);
+        break;
+    case 0x60:  // RTS
+    case 0x40:  // RTI
+    case 0x9A:  // TXS
+        unwind(expected);
+        break;
+    default:
+        break;
+    }
+    if (record.opcode != 0x00 && record.opcode != 0x20 && next.s == ((expected - 3) & 0xFF)) {
+        push(next.pc, next.bank, true, expected);
+    }
+}
+
+void CycleProfiler::push(quint16 entry, quint8 bank, bool interrupt, int callerStack)
+{
+    if (static_cast<int>(m_stack.size()) >= kMaxCallDepth) {
+        m_stack.erase(m_stack.begin());  // runaway recursion or an unmatched stack
+    }
+    const quint32 key = functionKey(entry, bank, interrupt);
+    FunctionStats* stats = &m_functions[key];
+    stats->calls++;
+    m_stack.push_back(Frame{key, stats, callerStack, m_cycles});
+}
+
+void CycleProfiler::unwind(int stack)
+{
+    while (!m_stack.empty() && m_stack.back().callerStack <= stack) {
+        const Frame frame = m_stack.back();
+        m_stack.pop_back();
+        const bool recursive = std::any_of(m_stack.begin(), m_stack.end(),
+                                           [&frame](const Frame& outer) { return outer.key == frame.key; });
+        if (!recursive) {
+            frame.stats->inclusiveCycles += m_cycles - frame.startCycles;
+        }
+    }
+}
+
+CycleProfiler::Report CycleProfiler::report(int topAddresses, int topFunctions) const
+{
+    Report report;
+    report.generation = m_generation;
+    report.frames = m_frames;
+    report.cycles = m_cycles;
+    report.instructions = m_instructions;
+    report.splitBanks = m_splitBanks;
+
+    std::vector<Hotspot> hotspots;
+    for (int address = 0; address < 0x10000; ++address) {
+        const Counter& counter = m_counters[address];
+        if (counter.instructions) {
+            hotspots.push_back(Hotspot{static_cast<quint16>(address), 0, counter.cycles, counter.instructions});
+        }
+    }
+    for (const auto& bank : m_bankCounters) {
+        for (int offset = 0; offset < kBankWindowSize; ++offset) {
+            const Counter& counter = bank.second[offset];
+            if (counter.instructions) {
+                hotspots.push_back(Hotspot{static_cast<quint16>(kBankWindowStart + offset),
+                                           static_cast<quint8>(bank.first), counter.cycles,
+                                           counter.instructions});
+            }
+        }
+    }
+    const auto byCycles = [](const Hotspot& a, const Hotspot& b) {
+        return a.cycles != b.cycles ? a.cycles > b.cycles : a.address < b.address;
+    };
+    const size_t hotspotCount = std::min(hotspots.size(), static_cast<size_t>(qMax(0, topAddresses)));
+    std::partial_sort(hotspots.begin(), hotspots.begin() + hotspotCount, hotspots.end(), byCycles);
+    for (size_t i = 0; i < hotspotCount; ++i) {
+        report.hotspots.append(hotspots[i]);
+    }
+
+    // Frames still open (a main loop that never returns) count up to now
+    std::unordered_map<quint32, quint64> open;
+    for (size_t i = 0; i < m_stack.size(); ++i) {
+        const Frame& frame = m_stack[i];
+        const bool outer = std::none_of(m_stack.begin(), m_stack.begin() + i,
+                                        [&frame](const Frame& f) { return f.key == frame.key; });
+        if (outer) {
+            open[frame.key] += m_cycles - frame.startCycles;
+        }
+    }
+    std::vector<Function> functions;
+    functions.reserve(m_functions.size());
+    for (const auto& entry : m_functions) {
+        const auto openIt = open.find(entry.first);
+        functions.push_back(Function{static_cast<quint16>(entry.first & 0xFFFF),
+                                     static_cast<quint8>((entry.first >> 16) & 0xFF),
+                                     (entry.first & 0x1000000u) != 0, entry.second.calls,
+                                     entry.second.selfCycles,
+                                     entry.second.inclusiveCycles + (openIt == open.end() ? 0 : openIt->second)});
+    }
+    const auto byInclusive = [](const Function& a, const Function& b) {
+        return a.inclusiveCycles != b.inclusiveCycles ? a.inclusiveCycles > b.inclusiveCycles
+                                                      : a.entry < b.entry;
+    };
+    const size_t functionCount = std::min(functions.size(), static_cast<size_t>(qMax(0, topFunctions)));
+    std::partial_sort(functions.begin(), functions.begin() + functionCount, functions.end(), byInclusive);
+    for (size_t i = 0; i < functionCount; ++i) {
+        report.functions.append(functions[i]);
+    }
+    return report;
+}
@@ -0,0 +1,305 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "debuggermodels.h"
+#include "codeanalyzer.h"
+#include "disasm6502.h"
+#include <QColor>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+const char kHexDigits[] = "0123456789ABCDEF";
+
+const QColor kChangedColor(0xD0, 0x00, 0x00);
+const QColor kCurrentLineColor(0xFF, 0xFF, 0x99);  // same as the current instruction label
+
+// Emit one dataChanged() per run of consecutive rows; rows must be sorted
+template <typename Rows>
+void emitRowRuns(QAbstractItemModel* model, const Rows& rows, int lastColumn)
+{
+    auto it = rows.begin();
+    while (it != rows.end()) {
+        const int first = *it;
+        int last = first;
+        while (++it != rows.end() && *it == last + 1) {
+            last = *it;
+        }
+        emit model->dataChanged(model->index(first, 0), model->index(last, lastColumn));
+    }
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// MemoryViewModel
+// ---------------------------------------------------------------------------
+
+MemoryViewModel::MemoryViewModel(QObject* parent)
+    : QAbstractTableModel(parent)
+    , m_snapshot(0x10000, 0)
+    , m_changed(0x10000, 0)
+{
+}
+
+void MemoryViewModel::setRegion(int size, int baseAddress)
+{
+    beginResetModel();
+    m_snapshot.assign(size, 0);
+    m_changed.assign(size, 0);
+    m_highlightedRows.clear();
+    m_baseAddress = baseAddress;
+    m_addressDigits = baseAddress + size > 0x10000 ? 6 : 4;
+    m_primed = false;
+    endResetModel();
+}
+
+int MemoryViewModel::refresh(const unsigned char* memory)
+{
+    if (!m_primed) {
+        beginResetModel();
+        std::memcpy(m_snapshot.data(), memory, m_snapshot.size());
+        m_primed = true;
+        endResetModel();
+        return 0;
+    }
+
+    // Highlights of the previous refresh go away unless the byte changed again
+    const QVector<int> previousRows = m_highlightedRows;
+    for (int row : previousRows) {
+        std::memset(&m_changed[row * kBytesPerRow], 0, kBytesPerRow);
+    }
+    m_highlightedRows.clear();
+
+    const int rows = rowCount();
+    for (int row = 0; row < rows; ++row) {
+        const int base = row * kBytesPerRow;
+        if (std::memcmp(memory + base, &m_snapshot[base], kBytesPerRow) == 0) {
+            continue;
+        }
+        for (int col = 0; col < kBytesPerRow; ++col) {
+            m_changed[base + col] = memory[base + col] != m_snapshot[base + col];
+        }
+        std::memcpy(&m_snapshot[base], memory + base, kBytesPerRow);
+        m_highlightedRows.append(row);
+    }
+
+    std::vector<int> dirtyRows;
+    dirtyRows.reserve(previousRows.size() + m_highlightedRows.size());
+    std::set_union(previousRows.begin(), previousRows.end(),
+                   m_highlightedRows.begin(), m_highlightedRows.end(), std::back_inserter(dirtyRows));
+    emitRowRuns(this, dirtyRows, kAsciiColumn);
+    return m_highlightedRows.size();
+}
+
+int MemoryViewModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_snapshot.size()) / kBytesPerRow;
+}
+
+int MemoryViewModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : kBytesPerRow + 1;
+}
+
+QVariant MemoryViewModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+    const int base = index.row() * kBytesPerRow;
+
+    if (index.column() == kAsciiColumn) {
+        if (role == Qt::DisplayRole) {
+            char text[kBytesPerRow];
+            for (int col = 0; col < kBytesPerRow; ++col) {
+                const unsigned char byte = m_snapshot[base + col];
+                text[col] = (byte >= 32 && byte <= 126) ? static_cast<char>(byte) : '.';
+            }
+            return QString::fromLatin1(text, kBytesPerRow);
+        }
+        if (role == Qt::ForegroundRole) {
+            const auto first = m_changed.begin() + base;
+            if (std::find(first, first + kBytesPerRow, 1) != first + kBytesPerRow) {
+                return kChangedColor;
+            }
+        }
+        return QVariant();
+    }
+
+    const int address = base + index.column();
+    switch (role) {
+        case Qt::DisplayRole: {
+            const unsigned char byte = m_snapshot[address];
+            const char text[2] = {kHexDigits[byte >> 4], kHexDigits[byte & 0xF]};
+            return QString::fromLatin1(text, 2);
+        }
+        case Qt::ForegroundRole:
+            return m_changed[address] ? QVariant(kChangedColor) : QVariant();
+        case Qt::TextAlignmentRole:
+            return int(Qt::AlignCenter);
+        default:
+            return QVariant();
+    }
+}
+
+QVariant MemoryViewModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    if (orientation == Qt::Vertical) {
+        return QString("%1").arg(m_baseAddress + section * kBytesPerRow, m_addressDigits, 16, QChar('0')).toUpper();
+    }
+    if (section == kAsciiColumn) {
+        return QString("ASCII");
+    }
+    return QString(QChar(kHexDigits[section]));
+}
+
+// ---------------------------------------------------------------------------
+// DisassemblyModel
+// ---------------------------------------------------------------------------
+
+DisassemblyModel::DisassemblyModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int DisassemblyModel::formatLine(const unsigned char* memory, unsigned short pc, bool isCurrent,
+                                 bool isBreakpoint, const QHash<unsigned short, QByteArray>* labels, char* out)
+{
+    // "-> E477: A9 00    LDA #$00": current PC arrow or breakpoint marker,
+    // address, hex bytes left-aligned in 8 characters, then the instruction
+    char* p = out;
+    std::memcpy(p, isCurrent ? "-> " : (isBreakpoint ? "B  " : "   "), 3);
+    p += 3;
+    for (int shift = 12; shift >= 0; shift -= 4) {
+        *p++ = kHexDigits[(pc >> shift) & 0xF];
+    }
+    *p++ = ':';
+    *p++ = ' ';
+    const int hexLength = formatInstructionBytes6502(memory, pc, p);
+    p += hexLength;
+    for (int pad = hexLength; pad < 9; ++pad) {
+        *p++ = ' ';
+    }
+    if (labels && !labels->isEmpty()) {
+        return formatInstructionSymbolic6502(memory, pc, &CodeAnalyzer::lookupLabel, labels, p);
+    }
+    return formatInstruction6502(memory, pc, p);
+}
+
+int DisassemblyModel::refresh(const unsigned char* memory, unsigned short start, unsigned short currentPC,
+                              int maxLines, int maxForward, const QSet<unsigned short>& breakpoints,
+                              const QHash<unsigned short, QByteArray>* labels)
+{
+    QVector<Line> lines;
+    lines.reserve(maxLines);
+    int currentRow = -1;
+    int instructions = 0;
+    unsigned short pc = start;
+    while (instructions < maxLines && pc < 0xFFFF) {
+        Line line;
+        line.address = pc;
+        line.changed = false;
+        line.label = false;
+
+        // "         START:" lined up with the mnemonics' address column
+        if (labels) {
+            const auto label = labels->constFind(pc);
+            if (label != labels->constEnd()) {
+                const int length = qMin(label->size(), kMaxLabelText6502);
+                std::memset(line.text, ' ', 9);
+                std::memcpy(line.text + 9, label->constData(), length);
+                std::memcpy(line.text + 9 + length, ":", 2);
+                line.label = true;
+                lines.append(line);
+                line.label = false;
+            }
+        }
+
+        const bool isCurrent = pc == currentPC;
+        if (isCurrent) {
+            currentRow = lines.size();
+        }
+        pc += formatLine(memory, pc, isCurrent, breakpoints.contains(pc), labels, line.text);
+        lines.append(line);
+        ++instructions;
+
+        // Stop if we've gone too far past the current PC
+        if (pc > currentPC + maxForward) {
+            break;
+        }
+    }
+    m_currentRow = currentRow;
+
+    if (lines.size() != m_lines.size()) {
+        beginResetModel();
+        m_lines = lines;
+        endResetModel();
+        return m_lines.size();
+    }
+
+    QVector<int> dirtyRows;
+    for (int row = 0; row < lines.size(); ++row) {
+        Line& line = lines[row];
+        const Line& previous = m_lines[row];
+        if (std::strcmp(line.text, previous.text) != 0) {
+            // Same address, different bytes (past the 3-character marker)
+            line.changed = line.address == previous.address && line.label == previous.label
+                && std::strcmp(line.text + 3, previous.text + 3) != 0;
+            dirtyRows.append(row);
+        } else if (previous.changed) {
+            dirtyRows.append(row);  // drop the highlight
+        }
+    }
+    m_lines = lines;
+    emitRowRuns(this, dirtyRows, 0);
+    return dirtyRows.size();
+}
+
+void DisassemblyModel::clear()
+{
+    if (m_lines.isEmpty()) {
+        return;
+    }
+    beginResetModel();
+    m_lines.clear();
+    m_currentRow = -1;
+    endResetModel();
+}
+
+QString DisassemblyModel::lineText(int row) const
+{
+    return row >= 0 && row < m_lines.size() ? QString::fromLatin1(m_lines[row].text) : QString();
+}
+
+int DisassemblyModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_lines.size();
+}
+
+QVariant DisassemblyModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_lines.size()) {
+        return QVariant();
+    }
+    const Line& line = m_lines[index.row()];
+    switch (role) {
+        case Qt::DisplayRole:
+            return QString::fromLatin1(line.text);
+        case Qt::BackgroundRole:
+            return index.row() == m_currentRow ? QVariant(kCurrentLineColor) : QVariant();
+        case Qt::ForegroundRole:
+            return line.changed ? QVariant(kChangedColor) : QVariant();
+        default:
+            return QVariant();
+    }
+}
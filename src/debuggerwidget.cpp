@@ -6,13 +6,18 @@
  */
 
 #include "debuggerwidget.h"
+#include "debuggermodels.h"
+#include "disasm6502.h"
 #include <QDebug>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
 #include <QGridLayout>
 #include <QFormLayout>
-#include <QScrollBar>
-#include <QCoreApplication>
+#include <QHeaderView>
 #include <QFontMetrics>
 #include <QSettings>
+#include <QThread>
 #include <algorithm>
 
 extern "C" {
@@ -201,16 +206,28 @@ void DebuggerWidget::setupUI()
     m_currentInstructionLabel->setAlignment(Qt::AlignLeft);
     
     disassemblyLayout->addWidget(m_currentInstructionLabel);
-    
-    // Disassembly text display
-    m_disassemblyTextEdit = new QTextEdit();
-    m_disassemblyTextEdit->setFont(QFont("Courier", 9));
-    m_disassemblyTextEdit->setReadOnly(true);
-    m_disassemblyTextEdit->setMaximumHeight(400);  // Increased height for scrollable content
-    m_disassemblyTextEdit->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);  // Always show scrollbar
-    m_disassemblyTextEdit->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-    
-    disassemblyLayout->addWidget(m_disassemblyTextEdit);
+
+    m_loadLabelsButton = new QPushButton("Load Labels...");
+    m_loadLabelsButton->setToolTip("Show MADS (.lab) or ca65 (.lbl) symbols in the disassembly");
+    QHBoxLayout* labelsLayout = new QHBoxLayout();
+    labelsLayout->addStretch();
+    labelsLayout->addWidget(m_loadLabelsButton);
+    disassemblyLayout->addLayout(labelsLayout);
+    
+    // Disassembly listing: a model updated row by row, so a refresh only
+    // repaints the lines that changed
+    m_disassemblyModel = new DisassemblyModel(this);
+    m_disassemblyView = new QListView();
+    m_disassemblyView->setModel(m_disassemblyModel);
+    m_disassemblyView->setFont(QFont("Courier", 9));
+    m_disassemblyView->setUniformItemSizes(true);
+    m_disassemblyView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_disassemblyView->setSelectionMode(QAbstractItemView::NoSelection);
+    m_disassemblyView->setMaximumHeight(400);  // Increased height for scrollable content
+    m_disassemblyView->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);  // Always show scrollbar
+    m_disassemblyView->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    
+    disassemblyLayout->addWidget(m_disassemblyView);
     mainLayout->addWidget(m_disassemblyGroup);
     
     // Memory Viewer Group
@@ -230,20 +247,93 @@ void DebuggerWidget::setupUI()
     m_memoryAddressSpinBox->setFont(QFont("Courier", 10));  // Use monospace font
     addressLayout->addWidget(m_memoryAddressSpinBox);
     addressLayout->addStretch();
+    m_memoryBankCombo = new QComboBox();
+    m_memoryBankCombo->setToolTip("Show the CPU's address space, an XE extended RAM bank or the cartridge image");
+    m_memoryBankCombo->addItem("CPU", 0);
+    addressLayout->addWidget(m_memoryBankCombo);
     
     memoryLayout->addLayout(addressLayout);
     
-    // Memory display - remove height restriction and let it expand
-    m_memoryTextEdit = new QTextEdit();
-    m_memoryTextEdit->setFont(QFont("Courier", 9));
-    m_memoryTextEdit->setReadOnly(true);
-    m_memoryTextEdit->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-    m_memoryTextEdit->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-    m_memoryTextEdit->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
-    
-    memoryLayout->addWidget(m_memoryTextEdit);
+    // Memory display: all 64 KB, only the visible rows are painted and
+    // bytes changed since the previous refresh are highlighted
+    m_memoryModel = new MemoryViewModel(this);
+    m_memoryView = new QTableView();
+    m_memoryView->setModel(m_memoryModel);
+    m_memoryView->setFont(QFont("Courier", 9));
+    m_memoryView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_memoryView->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_memoryView->setShowGrid(false);
+    m_memoryView->setWordWrap(false);
+    m_memoryView->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    m_memoryView->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    m_memoryView->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    // Fixed sections: resize-to-contents would measure every row of the model
+    const QFontMetrics memoryMetrics(m_memoryView->font());
+    m_memoryView->verticalHeader()->setFont(m_memoryView->font());
+    m_memoryView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_memoryView->verticalHeader()->setDefaultSectionSize(memoryMetrics.height() + 2);
+    m_memoryView->horizontalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_memoryView->horizontalHeader()->setDefaultSectionSize(memoryMetrics.averageCharWidth() * 3);
+    m_memoryView->horizontalHeader()->resizeSection(MemoryViewModel::kAsciiColumn,
+                                                    memoryMetrics.averageCharWidth() * 18);
+    
+    memoryLayout->addWidget(m_memoryView);
     
     mainLayout->addWidget(m_memoryGroup);
+
+    // Hardware registers group (unchecked: hidden, and no snapshot is taken for it)
+    m_hardwareGroup = new QGroupBox("Hardware Registers");
+    m_hardwareGroup->setCheckable(true);
+    m_hardwareGroup->setChecked(false);
+    QVBoxLayout* hardwareLayout = new QVBoxLayout(m_hardwareGroup);
+    m_hardwareView = new QPlainTextEdit();
+    m_hardwareView->setReadOnly(true);
+    m_hardwareView->setFont(QFont("Courier", 9));
+    m_hardwareView->setMaximumHeight(140);
+    m_hardwareView->setVisible(false);
+    hardwareLayout->addWidget(m_hardwareView);
+    mainLayout->addWidget(m_hardwareGroup);
+
+    // Profiler Group
+    m_profilerGroup = new QGroupBox("Profiler");
+    QVBoxLayout* profilerLayout = new QVBoxLayout(m_profilerGroup);
+
+    QHBoxLayout* profilerControlLayout = new QHBoxLayout();
+    m_profileToggleButton = new QPushButton("Start");
+    m_profileToggleButton->setToolTip("Count the cycles spent at each address and in each subroutine");
+    m_profileToggleButton->setMaximumWidth(60);
+    profilerControlLayout->addWidget(m_profileToggleButton);
+
+    m_profileResetButton = new QPushButton("Reset");
+    m_profileResetButton->setToolTip("Clear the profile");
+    m_profileResetButton->setMaximumWidth(60);
+    profilerControlLayout->addWidget(m_profileResetButton);
+
+    m_profileSplitBanksCheck = new QCheckBox("Split XE banks");
+    m_profileSplitBanksCheck->setToolTip("Count $4000-$7FFF separately for each extended RAM bank (applies on Start)");
+    profilerControlLayout->addWidget(m_profileSplitBanksCheck);
+    profilerControlLayout->addStretch();
+
+    m_profileViewCombo = new QComboBox();
+    m_profileViewCombo->addItem("Hot spots");
+    m_profileViewCombo->addItem("Functions");
+    profilerControlLayout->addWidget(m_profileViewCombo);
+    profilerLayout->addLayout(profilerControlLayout);
+
+    m_profileSummaryLabel = new QLabel("Not profiling");
+    profilerLayout->addWidget(m_profileSummaryLabel);
+
+    m_profileTable = new QTableWidget(0, 5);
+    m_profileTable->setFont(QFont("Courier", 9));
+    m_profileTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_profileTable->setSelectionMode(QAbstractItemView::NoSelection);
+    m_profileTable->verticalHeader()->setVisible(false);
+    m_profileTable->horizontalHeader()->setStretchLastSection(true);
+    m_profileTable->setMaximumHeight(200);
+    profilerLayout->addWidget(m_profileTable);
+
+    mainLayout->addWidget(m_profilerGroup);
+    updateProfilerDisplay(true);
 }
 
 void DebuggerWidget::connectSignals()
@@ -255,12 +345,25 @@ void DebuggerWidget::connectSignals()
     
     connect(m_memoryAddressSpinBox, QOverload<int>::of(&QSpinBox::valueChanged),
             this, &DebuggerWidget::onMemoryAddressChanged);
+    connect(m_memoryBankCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, [this](int) { updateMemoryDisplay(); });
+    connect(m_hardwareGroup, &QGroupBox::toggled, this, [this](bool checked) {
+        m_hardwareView->setVisible(checked);
+        updateMemoryDisplay();
+    });
     
     // Breakpoint controls
     connect(m_addBreakpointButton, &QPushButton::clicked, this, &DebuggerWidget::onAddBreakpointClicked);
     connect(m_removeBreakpointButton, &QPushButton::clicked, this, &DebuggerWidget::onRemoveBreakpointClicked);
     connect(m_clearBreakpointsButton, &QPushButton::clicked, this, &DebuggerWidget::clearAllBreakpoints);
     connect(m_breakpointListWidget, &QListWidget::itemSelectionChanged, this, &DebuggerWidget::onBreakpointSelectionChanged);
+    connect(m_loadLabelsButton, &QPushButton::clicked, this, &DebuggerWidget::onLoadLabelsClicked);
+
+    // Profiler controls
+    connect(m_profileToggleButton, &QPushButton::clicked, this, &DebuggerWidget::onProfileToggleClicked);
+    connect(m_profileResetButton, &QPushButton::clicked, this, &DebuggerWidget::onProfileResetClicked);
+    connect(m_profileViewCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, [this](int) { updateProfilerDisplay(true); });
     
     // Connect to emulator debugging signals
     if (m_emulator) {
@@ -310,45 +413,103 @@ void DebuggerWidget::updateMemoryDisplay()
     if (!m_emulator) {
         return;
     }
-    
-    m_currentMemoryAddress = m_memoryAddressSpinBox->value();
-    
-    QString memoryText;
-    memoryText.reserve(2048); // Pre-allocate for efficiency
-    
-    // Display 16 rows of 16 bytes each
-    for (int row = 0; row < MEMORY_DISPLAY_ROWS; row++) {
-        int baseAddr = m_currentMemoryAddress + (row * MEMORY_DISPLAY_COLS);
-        
-        // Address column
-        memoryText += QString("%1: ").arg(baseAddr, 4, 16, QChar('0')).toUpper();
-        
-        // Hex bytes
-        QString hexPart;
-        QString asciiPart;
-        
-        for (int col = 0; col < MEMORY_DISPLAY_COLS; col++) {
-            int addr = baseAddr + col;
-            if (addr <= 0xFFFF) {
-                unsigned char byte = MEMORY_mem[addr];
-                hexPart += QString("%1 ").arg(byte, 2, 16, QChar('0')).toUpper();
-                
-                // ASCII representation (printable chars only)
-                if (byte >= 32 && byte <= 126) {
-                    asciiPart += QChar(byte);
-                } else {
-                    asciiPart += '.';
-                }
-            } else {
-                hexPart += "   ";
-                asciiPart += ' ';
-            }
+
+    const int bank = m_memoryBankCombo->currentData().toInt();
+    const bool showRegisters = m_hardwareGroup->isChecked();
+    if (bank == 0 && !showRegisters) {
+        // The common case reads the live CPU view directly, as before snapshots
+        updateMemoryBanks(m_emulator->extendedBankCount(), CARTRIDGE_main.type != 0 ? CARTRIDGE_main.size * 1024 : 0);
+        if (m_memoryModel->regionSize() != MachineSnapshot::kMemorySize || m_memoryModel->baseAddress() != 0) {
+            m_memoryModel->setRegion(MachineSnapshot::kMemorySize);
+            QSignalBlocker blocker(m_memoryAddressSpinBox);
+            m_memoryAddressSpinBox->setRange(0x0000, 0xFFFF);
         }
-        
-        memoryText += hexPart + " | " + asciiPart + "\n";
+        m_memoryModel->refresh(MEMORY_mem);
+        return;
     }
-    
-    m_memoryTextEdit->setText(memoryText);
+
+    const int sections = bank > 0 ? MachineSnapshot::ExtendedRam
+                         : bank < 0 ? MachineSnapshot::CartridgeImage : MachineSnapshot::CpuMemory;
+    const MachineSnapshot snapshot = captureSnapshot(sections);
+    if (!snapshot.isValid()) {
+        return;
+    }
+    updateMemoryBanks(snapshot.extendedBanks, snapshot.cartridgeSize);
+    if (showRegisters) {
+        updateHardwareRegisters(snapshot);
+    }
+    if (m_memoryBankCombo->currentData().toInt() != bank) {
+        return;  // the bank went away; the next refresh shows the CPU view
+    }
+
+    const QByteArray bytes = bank > 0 ? snapshot.bank(bank) : bank < 0 ? snapshot.cartridge : snapshot.memory;
+    const int base = bank > 0 ? 0x4000 : 0;
+    if (m_memoryModel->regionSize() != bytes.size() || m_memoryModel->baseAddress() != base) {
+        m_memoryModel->setRegion(bytes.size(), base);
+        QSignalBlocker blocker(m_memoryAddressSpinBox);
+        m_memoryAddressSpinBox->setRange(base, base + bytes.size() - 1);
+    }
+    m_memoryModel->refresh(reinterpret_cast<const unsigned char*>(bytes.constData()));
+}
+
+void DebuggerWidget::updateMemoryBanks(int extendedBanks, int cartridgeSize)
+{
+    // Items: CPU, XE 1..n, Cartridge; rebuilt only when the machine changes
+    const int wanted = 1 + extendedBanks + (cartridgeSize > 0 ? 1 : 0);
+    const bool hasCartridge = m_memoryBankCombo->findData(-1) >= 0;
+    if (m_memoryBankCombo->count() == wanted && hasCartridge == (cartridgeSize > 0)) {
+        return;
+    }
+    const int current = m_memoryBankCombo->currentData().toInt();
+    QSignalBlocker blocker(m_memoryBankCombo);
+    m_memoryBankCombo->clear();
+    m_memoryBankCombo->addItem("CPU", 0);
+    for (int bank = 1; bank <= extendedBanks; ++bank) {
+        m_memoryBankCombo->addItem(QString("XE %1").arg(bank), bank);
+    }
+    if (cartridgeSize > 0) {
+        m_memoryBankCombo->addItem("Cartridge", -1);
+    }
+    const int index = m_memoryBankCombo->findData(current);
+    m_memoryBankCombo->setCurrentIndex(index >= 0 ? index : 0);
+}
+
+void DebuggerWidget::updateHardwareRegisters(const MachineSnapshot& snapshot)
+{
+    QStringList lines;
+    for (int chip = 0; chip < MachineSnapshot::ChipCount; ++chip) {
+        const QStringList names = MachineSnapshot::registerNames(static_cast<MachineSnapshot::Chip>(chip));
+        QStringList values;
+        for (int i = 0; i < names.size(); ++i) {
+            values << QString("%1=%2").arg(names[i])
+                          .arg(static_cast<quint8>(snapshot.registers[chip].at(i)), 2, 16, QChar('0')).toUpper();
+        }
+        lines << MachineSnapshot::chipName(static_cast<MachineSnapshot::Chip>(chip)).toUpper().leftJustified(6)
+                 + values.join(' ');
+    }
+    QString banking = QString("XE banks %1, mapped %2").arg(snapshot.extendedBanks).arg(snapshot.mappedBank);
+    if (snapshot.cartridgeType != 0) {
+        banking += QString(" - cartridge type %1, state $%2").arg(snapshot.cartridgeType)
+                       .arg(snapshot.cartridgeState, 2, 16, QChar('0'));
+    }
+    lines << banking;
+    const QString text = lines.join('\n');
+    if (m_hardwareView->toPlainText() != text) {
+        m_hardwareView->setPlainText(text);
+    }
+}
+
+MachineSnapshot DebuggerWidget::captureSnapshot(int sections) const
+{
+    // One blocking hop to the emulator worker, so the capture falls between frames
+    MachineSnapshot snapshot;
+    AtariEmulator* emulator = m_emulator;
+    const Qt::ConnectionType type = emulator->thread() == QThread::currentThread() ? Qt::DirectConnection
+                                                                                   : Qt::BlockingQueuedConnection;
+    QMetaObject::invokeMethod(emulator, [emulator, sections, &snapshot]() {
+        snapshot = emulator->captureSnapshot(sections);
+    }, type);
+    return snapshot;
 }
 
 QString DebuggerWidget::formatHexByte(unsigned char value)
@@ -374,392 +535,170 @@ void DebuggerWidget::updateCurrentInstruction()
 
 QString DebuggerWidget::formatCurrentInstruction(unsigned short pc)
 {
-    // Simple 6502 instruction formatting
-    unsigned char opcode = MEMORY_mem[pc];
-    
-    // Basic opcode to mnemonic mapping (simplified)
-    QString mnemonic = "???";
-    QString operand = "";
-    
-    // Simple instruction decode - just a few common opcodes for demonstration
-    switch (opcode) {
-        case 0x00: mnemonic = "BRK"; break;
-        case 0x10: mnemonic = "BPL"; operand = QString(" $%1").arg(MEMORY_mem[(pc + 1) & 0xFFFF], 2, 16, QChar('0')).toUpper(); break;
-        case 0x20: {
-            unsigned short addr = MEMORY_mem[(pc + 1) & 0xFFFF] | (MEMORY_mem[(pc + 2) & 0xFFFF] << 8);
-            mnemonic = "JSR"; 
-            operand = QString(" $%1").arg(addr, 4, 16, QChar('0')).toUpper();
-            break;
-        }
-        case 0x30: mnemonic = "BMI"; operand = QString(" $%1").arg(MEMORY_mem[(pc + 1) & 0xFFFF], 2, 16, QChar('0')).toUpper(); break;
-        case 0x40: mnemonic = "RTI"; break;
-        case 0x50: mnemonic = "BVC"; operand = QString(" $%1").arg(MEMORY_mem[(pc + 1) & 0xFFFF], 2, 16, QChar('0')).toUpper(); break;
-        case 0x60: mnemonic = "RTS"; break;
-        case 0x70: mnemonic = "BVS"; operand = QString(" $%1").arg(MEMORY_mem[(pc + 1) & 0xFFFF], 2, 16, QChar('0')).toUpper(); break;
-        case 0x90: mnemonic = "BCC"; operand = QString(" $%1").arg(MEMORY_mem[(pc + 1) & 0xFFFF], 2, 16, QChar('0')).toUpper(); break;
-        case 0xa0: mnemonic = "LDY"; operand = QString(" #$%1").arg(MEMORY_mem[(pc + 1) & 0xFFFF], 2, 16, QChar('0')).toUpper(); break;
-        case 0xa2: mnemonic = "LDX"; operand = QString(" #$%1").arg(MEMORY_mem[(pc + 1) & 0xFFFF], 2, 16, QChar('0')).toUpper(); break;
-        case 0xa9: mnemonic = "LDA"; operand = QString(" #$%1").arg(MEMORY_mem[(pc + 1) & 0xFFFF], 2, 16, QChar('0')).toUpper(); break;
-        case 0xb0: mnemonic = "BCS"; operand = QString(" $%1").arg(MEMORY_mem[(pc + 1) & 0xFFFF], 2, 16, QChar('0')).toUpper(); break;
-        case 0xd0: mnemonic = "BNE"; operand = QString(" $%1").arg(MEMORY_mem[(pc + 1) & 0xFFFF], 2, 16, QChar('0')).toUpper(); break;
-        case 0xea: mnemonic = "NOP"; break;
-        case 0xf0: mnemonic = "BEQ"; operand = QString(" $%1").arg(MEMORY_mem[(pc + 1) & 0xFFFF], 2, 16, QChar('0')).toUpper(); break;
-        default:
-            mnemonic = "???";
-            operand = QString(" $%1").arg(opcode, 2, 16, QChar('0')).toUpper();
-            break;
-    }
-    
-    return QString("$%1: %2 %3%4")
+    char instruction[kInstructionText6502];
+    formatInstruction6502(MEMORY_mem, pc, instruction);
+    return QString("$%1: %2 %3")
         .arg(pc, 4, 16, QChar('0')).toUpper()
-        .arg(opcode, 2, 16, QChar('0')).toUpper()
-        .arg(mnemonic)
-        .arg(operand);
+        .arg(MEMORY_mem[pc], 2, 16, QChar('0')).toUpper()
+        .arg(QLatin1String(instruction));
 }
 
 void DebuggerWidget::updateDisassemblyDisplay()
 {
     if (!m_emulator) {
-        m_disassemblyTextEdit->clear();
+        m_disassemblyModel->clear();
         return;
     }
     
-    QString disassemblyText;
-    disassemblyText.reserve(2048);
-    
     unsigned short currentPC = CPU_regPC;
-    unsigned short startPC = currentPC;
-    
-    // When paused, calculate start PC to center the current PC in the view
-    int backtrack;
-    if (m_isRunning) {
-        backtrack = 16;  // Show less context when running for performance
-    } else {
-        // When paused, go back enough to center the current PC
-        const int maxInstructions = 100;
-        backtrack = maxInstructions / 2;  // Center the PC in the middle of our instruction window
+
+    // The analysis runs on its own thread; this refresh uses the last finished
+    // pass and queues the current memory for the next one
+    CodeAnalyzer& analyzer = m_emulator->codeAnalyzer();
+    analyzer.submit(MEMORY_mem, currentPC);
+    const std::shared_ptr<const CodeAnalyzer::Analysis> analysis = analyzer.analysis();
+    const std::shared_ptr<const CodeAnalyzer::Labels> labels = analyzer.labels();
+
+    // Start a few instructions back so the PC has context: along known
+    // instruction boundaries when the analysis has reached this code, otherwise
+    // a fixed number of bytes (less context when running, for performance)
+    const int backtrackInstructions = m_isRunning ? 6 : 20;
+    const int backtrackBytes = m_isRunning ? 16 : 50;
+    const unsigned short startPC = CodeFlowTracer::instructionStartBefore(
+        analysis ? analysis->kinds.data() : nullptr, MEMORY_mem, currentPC, backtrackInstructions, backtrackBytes);
+    
+    // Show more instructions when paused for scrolling, fewer when running for performance;
+    // allow more leeway past the current PC when paused
+    const int maxInstructions = m_isRunning ? 20 : 100;  // 100 instructions when paused, 20 when running
+    const int maxForward = m_isRunning ? 20 : 80;
+    const int changedRows = m_disassemblyModel->refresh(MEMORY_mem, startPC, currentPC,
+                                                        maxInstructions, maxForward, m_breakpoints, labels.get());
+    
+    // When paused, scroll to center the PC line
+    if (!m_isRunning && changedRows > 0 && m_disassemblyModel->currentRow() >= 0) {
+        m_disassemblyView->scrollTo(m_disassemblyModel->index(m_disassemblyModel->currentRow()),
+                                    QAbstractItemView::PositionAtCenter);
     }
-    
-    if (startPC >= backtrack) {
-        startPC -= backtrack;
-    } else {
-        startPC = 0;
+}
+
+void DebuggerWidget::onLoadLabelsClicked()
+{
+    if (!m_emulator) {
+        return;
     }
-    
-    // Show more instructions when paused for scrolling, fewer when running for performance
-    unsigned short pc = startPC;
-    int instructionCount = 0;
-    const int maxInstructions = m_isRunning ? 20 : 100;  // 100 instructions when paused, 20 when running
-    
-    while (instructionCount < maxInstructions && pc < 0xFFFF) {
-        if (!m_emulator) {
-            break;
-        }
-        QString line = formatInstructionLine(pc, pc == currentPC);
-        disassemblyText += line + "\n";
-        
-        // Advance PC by instruction size
-        unsigned char opcode = MEMORY_mem[pc];
-        pc += getInstructionSize(opcode);
-        instructionCount++;
-        
-        // Stop if we've gone too far past current PC (more leeway when paused)
-        int maxForward = m_isRunning ? 20 : 80;
-        if (pc > currentPC + maxForward) {
-            break;
-        }
+    QSettings settings;
+    const QString lastDir = settings.value("debugger/lastLabelDir").toString();
+    const QString path = QFileDialog::getOpenFileName(this, "Load Labels", lastDir,
+                                                      "Label files (*.lab *.lbl);;All files (*)");
+    if (path.isEmpty()) {
+        return;
     }
-    
-    // Use plain text formatting
-    m_disassemblyTextEdit->setText(disassemblyText);
-    
-    // When paused, scroll to center the PC line (marked with "->")
-    if (!m_isRunning) {
-        // Find the PC line (marked with "->") in the text
-        QStringList lines = disassemblyText.split('\n');
-        int currentPCLine = -1;
-        for (int i = 0; i < lines.size(); ++i) {
-            if (lines[i].startsWith("->")) {
-                currentPCLine = i;
-                break;
-            }
-        }
-        
-        if (currentPCLine >= 0) {
-            // Use direct scrollbar manipulation to center the PC line
-            QScrollBar* scrollBar = m_disassemblyTextEdit->verticalScrollBar();
-            int lineHeight = QFontMetrics(m_disassemblyTextEdit->font()).lineSpacing();
-            int visibleLines = m_disassemblyTextEdit->viewport()->height() / lineHeight;
-            
-            // Calculate scroll position to center the PC line
-            int targetLine = qMax(0, currentPCLine - visibleLines / 2);
-            int scrollValue = targetLine * lineHeight;
-            
-            qDebug() << QString("Centering PC: currentPCLine=%1, visibleLines=%2, targetLine=%3, scrollValue=%4")
-                        .arg(currentPCLine).arg(visibleLines).arg(targetLine).arg(scrollValue);
-            
-            scrollBar->setValue(scrollValue);
-        }
+    settings.setValue("debugger/lastLabelDir", QFileInfo(path).path());
+
+    QString error;
+    if (!m_emulator->codeAnalyzer().loadLabels(path, &error)) {
+        QMessageBox::warning(this, "Load Labels", error);
+        return;
     }
+    updateDisassemblyDisplay();
+    updateProfilerDisplay(true);
 }
 
-QString DebuggerWidget::formatInstructionLine(unsigned short pc, bool isCurrent)
+void DebuggerWidget::onProfileToggleClicked()
 {
-    unsigned char opcode = MEMORY_mem[pc];
-    
-    // Basic opcode to mnemonic mapping (expanded from current instruction formatter)
-    QString mnemonic = "???";
-    QString operand = "";
-    QString hexBytes = QString("%1").arg(opcode, 2, 16, QChar('0')).toUpper();
-    
-    // Instruction decode with proper operand handling
-    switch (opcode) {
-        // Implied instructions (1 byte)
-        case 0x00: mnemonic = "BRK"; break;
-        case 0x08: mnemonic = "PHP"; break;
-        case 0x18: mnemonic = "CLC"; break;
-        case 0x28: mnemonic = "PLP"; break;
-        case 0x38: mnemonic = "SEC"; break;
-        case 0x40: mnemonic = "RTI"; break;
-        case 0x48: mnemonic = "PHA"; break;
-        case 0x58: mnemonic = "CLI"; break;
-        case 0x60: mnemonic = "RTS"; break;
-        case 0x68: mnemonic = "PLA"; break;
-        case 0x78: mnemonic = "SEI"; break;
-        case 0x88: mnemonic = "DEY"; break;
-        case 0x8a: mnemonic = "TXA"; break;
-        case 0x98: mnemonic = "TYA"; break;
-        case 0x9a: mnemonic = "TXS"; break;
-        case 0xa8: mnemonic = "TAY"; break;
-        case 0xaa: mnemonic = "TAX"; break;
-        case 0xb8: mnemonic = "CLV"; break;
-        case 0xba: mnemonic = "TSX"; break;
-        case 0xc8: mnemonic = "INY"; break;
-        case 0xca: mnemonic = "DEX"; break;
-        case 0xd8: mnemonic = "CLD"; break;
-        case 0xe8: mnemonic = "INX"; break;
-        case 0xea: mnemonic = "NOP"; break;
-        case 0xf8: mnemonic = "SED"; break;
-        
-        // Relative branches (2 bytes)
-        case 0x10: case 0x30: case 0x50: case 0x70: case 0x90: case 0xb0: case 0xd0: case 0xf0: {
-            unsigned char operandByte = MEMORY_mem[(pc + 1) & 0xFFFF];
-            hexBytes += QString(" %1").arg(operandByte, 2, 16, QChar('0')).toUpper();
-            unsigned short target = (pc + 2 + (signed char)operandByte) & 0xFFFF;
-            operand = QString(" $%1").arg(target, 4, 16, QChar('0')).toUpper();
-            
-            switch (opcode) {
-                case 0x10: mnemonic = "BPL"; break;
-                case 0x30: mnemonic = "BMI"; break;
-                case 0x50: mnemonic = "BVC"; break;
-                case 0x70: mnemonic = "BVS"; break;
-                case 0x90: mnemonic = "BCC"; break;
-                case 0xb0: mnemonic = "BCS"; break;
-                case 0xd0: mnemonic = "BNE"; break;
-                case 0xf0: mnemonic = "BEQ"; break;
-            }
-            break;
-        }
-        
-        // Immediate instructions (2 bytes)
-        case 0x09: case 0x29: case 0x49: case 0x69: case 0x89: case 0xa0: case 0xa2: case 0xa9:
-        case 0xc0: case 0xc9: case 0xe0: case 0xe9: {
-            unsigned char operandByte = MEMORY_mem[(pc + 1) & 0xFFFF];
-            hexBytes += QString(" %1").arg(operandByte, 2, 16, QChar('0')).toUpper();
-            operand = QString(" #$%1").arg(operandByte, 2, 16, QChar('0')).toUpper();
-            
-            switch (opcode) {
-                case 0x09: mnemonic = "ORA"; break;
-                case 0x29: mnemonic = "AND"; break;
-                case 0x49: mnemonic = "EOR"; break;
-                case 0x69: mnemonic = "ADC"; break;
-                case 0x89: mnemonic = "STA"; break; // Illegal but common
-                case 0xa0: mnemonic = "LDY"; break;
-                case 0xa2: mnemonic = "LDX"; break;
-                case 0xa9: mnemonic = "LDA"; break;
-                case 0xc0: mnemonic = "CPY"; break;
-                case 0xc9: mnemonic = "CMP"; break;
-                case 0xe0: mnemonic = "CPX"; break;
-                case 0xe9: mnemonic = "SBC"; break;
-            }
-            break;
-        }
-        
-        // Zero page instructions (2 bytes)
-        case 0x05: case 0x06: case 0x24: case 0x25: case 0x26: case 0x45: case 0x46: case 0x65: case 0x66:
-        case 0x84: case 0x85: case 0x86: case 0xa4: case 0xa5: case 0xa6: case 0xc4: case 0xc5: case 0xc6:
-        case 0xe4: case 0xe5: case 0xe6: {
-            unsigned char operandByte = MEMORY_mem[(pc + 1) & 0xFFFF];
-            hexBytes += QString(" %1").arg(operandByte, 2, 16, QChar('0')).toUpper();
-            operand = QString(" $%1").arg(operandByte, 2, 16, QChar('0')).toUpper();
-            
-            switch (opcode) {
-                case 0x05: mnemonic = "ORA"; break;
-                case 0x06: mnemonic = "ASL"; break;
-                case 0x24: mnemonic = "BIT"; break;
-                case 0x25: mnemonic = "AND"; break;
-                case 0x26: mnemonic = "ROL"; break;
-                case 0x45: mnemonic = "EOR"; break;
-                case 0x46: mnemonic = "LSR"; break;
-                case 0x65: mnemonic = "ADC"; break;
-                case 0x66: mnemonic = "ROR"; break;
-                case 0x84: mnemonic = "STY"; break;
-                case 0x85: mnemonic = "STA"; break;
-                case 0x86: mnemonic = "STX"; break;
-                case 0xa4: mnemonic = "LDY"; break;
-                case 0xa5: mnemonic = "LDA"; break;
-                case 0xa6: mnemonic = "LDX"; break;
-                case 0xc4: mnemonic = "CPY"; break;
-                case 0xc5: mnemonic = "CMP"; break;
-                case 0xc6: mnemonic = "DEC"; break;
-                case 0xe4: mnemonic = "CPX"; break;
-                case 0xe5: mnemonic = "SBC"; break;
-                case 0xe6: mnemonic = "INC"; break;
-            }
-            break;
-        }
-        
-        // Absolute instructions (3 bytes)
-        case 0x0d: case 0x0e: case 0x1d: case 0x1e: case 0x20: case 0x2c: case 0x2d: case 0x2e:
-        case 0x3d: case 0x3e: case 0x4c: case 0x4d: case 0x4e: case 0x5d: case 0x5e: case 0x6c:
-        case 0x6d: case 0x6e: case 0x7d: case 0x7e: case 0x8c: case 0x8d: case 0x8e: case 0x9d:
-        case 0x9e: case 0xac: case 0xad: case 0xae: case 0xbc: case 0xbd: case 0xbe: case 0xcc:
-        case 0xcd: case 0xce: case 0xdd: case 0xde: case 0xec: case 0xed: case 0xee: case 0xfd:
-        case 0xfe: {
-            unsigned char lo = MEMORY_mem[(pc + 1) & 0xFFFF];
-            unsigned char hi = MEMORY_mem[(pc + 2) & 0xFFFF];
-            unsigned short addr = lo | (hi << 8);
-            hexBytes += QString(" %1 %2").arg(lo, 2, 16, QChar('0')).arg(hi, 2, 16, QChar('0')).toUpper();
-            
-            // Handle indexed addressing modes
-            if ((opcode & 0x1F) == 0x1D) { // Absolute,X
-                operand = QString(" $%1,X").arg(addr, 4, 16, QChar('0')).toUpper();
-            } else if ((opcode & 0x1F) == 0x1E) { // Absolute,X
-                operand = QString(" $%1,X").arg(addr, 4, 16, QChar('0')).toUpper();
-            } else if (opcode == 0x9e) { // SHX abs,Y (undocumented)
-                operand = QString(" $%1,Y").arg(addr, 4, 16, QChar('0')).toUpper();
-            } else if ((opcode & 0x0F) == 0x09 && (opcode & 0xF0) >= 0xB0) { // Absolute,Y
-                operand = QString(" $%1,Y").arg(addr, 4, 16, QChar('0')).toUpper();
-            } else if (opcode == 0x6c) { // JMP (indirect)
-                operand = QString(" ($%1)").arg(addr, 4, 16, QChar('0')).toUpper();
-            } else {
-                operand = QString(" $%1").arg(addr, 4, 16, QChar('0')).toUpper();
-            }
-            
-            switch (opcode) {
-                case 0x0d: mnemonic = "ORA"; break;
-                case 0x0e: mnemonic = "ASL"; break;
-                case 0x1d: mnemonic = "ORA"; break;
-                case 0x1e: mnemonic = "ASL"; break;
-                case 0x20: mnemonic = "JSR"; break;
-                case 0x2c: mnemonic = "BIT"; break;
-                case 0x2d: mnemonic = "AND"; break;
-                case 0x2e: mnemonic = "ROL"; break;
-                case 0x3d: mnemonic = "AND"; break;
-                case 0x3e: mnemonic = "ROL"; break;
-                case 0x4c: mnemonic = "JMP"; break;
-                case 0x4d: mnemonic = "EOR"; break;
-                case 0x4e: mnemonic = "LSR"; break;
-                case 0x5d: mnemonic = "EOR"; break;
-                case 0x5e: mnemonic = "LSR"; break;
-                case 0x6c: mnemonic = "JMP"; break;
-                case 0x6d: mnemonic = "ADC"; break;
-                case 0x6e: mnemonic = "ROR"; break;
-                case 0x7d: mnemonic = "ADC"; break;
-                case 0x7e: mnemonic = "ROR"; break;
-                case 0x8c: mnemonic = "STY"; break;
-                case 0x8d: mnemonic = "STA"; break;
-                case 0x8e: mnemonic = "STX"; break;
-                case 0x9d: mnemonic = "STA"; break;
-                case 0x9e: mnemonic = "SHX"; break; // Undocumented
-                case 0xac: mnemonic = "LDY"; break;
-                case 0xad: mnemonic = "LDA"; break;
-                case 0xae: mnemonic = "LDX"; break;
-                case 0xbc: mnemonic = "LDY"; break;
-                case 0xbd: mnemonic = "LDA"; break;
-                case 0xbe: mnemonic = "LDX"; break;
-                case 0xcc: mnemonic = "CPY"; break;
-                case 0xcd: mnemonic = "CMP"; break;
-                case 0xce: mnemonic = "DEC"; break;
-                case 0xdd: mnemonic = "CMP"; break;
-                case 0xde: mnemonic = "DEC"; break;
-                case 0xec: mnemonic = "CPX"; break;
-                case 0xed: mnemonic = "SBC"; break;
-                case 0xee: mnemonic = "INC"; break;
-                case 0xfd: mnemonic = "SBC"; break;
-                case 0xfe: mnemonic = "INC"; break;
-            }
-            break;
-        }
-        
-        // Handle some common undocumented/illegal opcodes
-        case 0xd2: mnemonic = "JAM"; operand = " *ILLEGAL*"; break; // KIL/JAM - processor halt
-        case 0x02: case 0x12: case 0x22: case 0x32: case 0x42: case 0x52: case 0x62: case 0x72:
-        case 0x92: case 0xb2: case 0xf2:
-            mnemonic = "JAM"; operand = " *ILLEGAL*"; break; // More JAM opcodes
-        
-        default: {
-            // Unknown instruction - show as illegal opcode
-            mnemonic = "ILL";
-            operand = QString(" *$%1*").arg(opcode, 2, 16, QChar('0')).toUpper();
-            break;
-        }
+    if (!m_emulator) {
+        return;
     }
-    
-    // Format the line with prominent arrow for current PC and breakpoint indicator
-    QString prefix;
-    if (isCurrent) {
-        prefix = "-> ";  // Current PC
-    } else if (hasBreakpoint(pc)) {
-        prefix = "B  ";  // Breakpoint marker
+    // Queued: the profiler belongs to the emulator thread
+    if (m_emulator->isProfiling()) {
+        QMetaObject::invokeMethod(m_emulator, "stopProfiling", Qt::QueuedConnection);
+        m_profileToggleButton->setText("Start");
     } else {
-        prefix = "   ";  // Normal line
+        QMetaObject::invokeMethod(m_emulator, "startProfiling", Qt::QueuedConnection,
+                                  Q_ARG(bool, m_profileSplitBanksCheck->isChecked()));
+        m_profileToggleButton->setText("Stop");
     }
-    QString line = QString("%1%2: %3 %4%5")
-        .arg(prefix)
-        .arg(pc, 4, 16, QChar('0')).toUpper()
-        .arg(hexBytes, -8)  // Left-align hex bytes in 8-char field
-        .arg(mnemonic)
-        .arg(operand);
-    
-    return line;
+    // The refresh timer does not run while paused
+    QTimer::singleShot(200, this, [this]() { updateProfilerDisplay(true); });
 }
 
-int DebuggerWidget::getInstructionSize(unsigned char opcode)
+void DebuggerWidget::onProfileResetClicked()
 {
-    // Return instruction size in bytes based on opcode
-    // This is a simplified version - a complete implementation would use a lookup table
-    
-    switch (opcode) {
-        // Implied instructions (1 byte)
-        case 0x00: case 0x08: case 0x18: case 0x28: case 0x38: case 0x40:
-        case 0x48: case 0x58: case 0x60: case 0x68: case 0x78: case 0x88:
-        case 0x8a: case 0x98: case 0x9a: case 0xa8: case 0xaa: case 0xb8:
-        case 0xba: case 0xc8: case 0xca: case 0xd8: case 0xe8: case 0xea:
-        case 0xf8:
-            return 1;
-            
-        // Immediate and relative instructions (2 bytes)
-        case 0x05: case 0x06: case 0x09: case 0x10: case 0x24: case 0x25: case 0x26: case 0x29:
-        case 0x30: case 0x45: case 0x46: case 0x49: case 0x50: case 0x65: case 0x66: case 0x69:
-        case 0x70: case 0x84: case 0x85: case 0x86: case 0x89: case 0x90: case 0xa0: case 0xa2:
-        case 0xa4: case 0xa5: case 0xa6: case 0xa9: case 0xb0: case 0xc0: case 0xc4: case 0xc5:
-        case 0xc6: case 0xc9: case 0xd0: case 0xe0: case 0xe4: case 0xe5: case 0xe6: case 0xe9:
-        case 0xf0:
-            return 2;
-            
-        // Absolute instructions (3 bytes)  
-        case 0x0d: case 0x0e: case 0x1d: case 0x1e: case 0x20: case 0x2c: case 0x2d: case 0x2e:
-        case 0x3d: case 0x3e: case 0x4c: case 0x4d: case 0x4e: case 0x5d: case 0x5e: case 0x6c:
-        case 0x6d: case 0x6e: case 0x7d: case 0x7e: case 0x8c: case 0x8d: case 0x8e: case 0x9d:
-        case 0x9e: case 0xac: case 0xad: case 0xae: case 0xbc: case 0xbd: case 0xbe: case 0xcc:
-        case 0xcd: case 0xce: case 0xdd: case 0xde: case 0xec: case 0xed: case 0xee: case 0xfd:
-        case 0xfe:
-            return 3;
-            
-        default:
-            // Unknown instruction, assume 1 byte
-            return 1;
+    if (m_emulator) {
+        QMetaObject::invokeMethod(m_emulator, "resetProfile", Qt::QueuedConnection);
+        QTimer::singleShot(200, this, [this]() { updateProfilerDisplay(true); });
+    }
+}
+
+void DebuggerWidget::updateProfilerDisplay(bool force)
+{
+    if (!m_emulator) {
+        return;
+    }
+    const bool profiling = m_emulator->isProfiling();
+    m_profileToggleButton->setText(profiling ? "Stop" : "Start");
+    m_profileSplitBanksCheck->setEnabled(!profiling);
+
+    const std::shared_ptr<const CycleProfiler::Report> report = m_emulator->profileReport();
+    if (!report) {
+        return;
+    }
+    if (!force && report->generation == m_profileGeneration) {
+        return;
+    }
+    m_profileGeneration = report->generation;
+
+    m_profileSummaryLabel->setText(QString("%1 frames, %2 instructions, %3 cycles/frame%4")
+        .arg(report->frames)
+        .arg(report->instructions)
+        .arg(report->frames ? report->cycles / report->frames : 0)
+        .arg(profiling ? "" : " (stopped)"));
+
+    const std::shared_ptr<const CodeAnalyzer::Labels> labels = m_emulator->codeAnalyzer().labels();
+    const double total = report->cycles ? double(report->cycles) : 1.0;
+    const auto addressText = [&report](quint16 address, quint8 bank) {
+        QString text = QString("$%1").arg(address, 4, 16, QChar('0')).toUpper();
+        if (report->splitBanks && bank) {
+            text += QString(":%1").arg(bank);
+        }
+        return text;
+    };
+    const auto setRow = [this](int row, const QStringList& cells) {
+        for (int column = 0; column < cells.size(); ++column) {
+            QTableWidgetItem* item = m_profileTable->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                m_profileTable->setItem(row, column, item);
+            }
+            item->setText(cells[column]);
+        }
+    };
+
+    if (m_profileViewCombo->currentIndex() == 0) {
+        m_profileTable->setHorizontalHeaderLabels({"Address", "Symbol", "Cycles", "%", "Instructions"});
+        m_profileTable->setRowCount(report->hotspots.size());
+        for (int row = 0; row < report->hotspots.size(); ++row) {
+            const CycleProfiler::Hotspot& hotspot = report->hotspots[row];
+            setRow(row, {addressText(hotspot.address, hotspot.bank),
+                         QString::fromLatin1(labels->value(hotspot.address)),
+                         QString::number(hotspot.cycles),
+                         QString::number(100.0 * double(hotspot.cycles) / total, 'f', 2),
+                         QString::number(hotspot.instructions)});
+        }
+    } else {
+        m_profileTable->setHorizontalHeaderLabels({"Entry", "Symbol", "Inclusive", "%", "Calls"});
+        m_profileTable->setRowCount(report->functions.size());
+        for (int row = 0; row < report->functions.size(); ++row) {
+            const CycleProfiler::Function& function = report->functions[row];
+            QString symbol = QString::fromLatin1(labels->value(function.entry));
+            if (function.interrupt) {
+                symbol = symbol.isEmpty() ? QString("(interrupt)") : symbol + " (interrupt)";
+            }
+            setRow(row, {addressText(function.entry, function.bank), symbol,
+                         QString::number(function.inclusiveCycles),
+                         QString::number(100.0 * double(function.inclusiveCycles) / total, 'f', 2),
+                         QString::number(function.calls)});
+        }
     }
 }
 
@@ -870,6 +809,13 @@ void DebuggerWidget::onPauseClicked()
 
 void DebuggerWidget::onMemoryAddressChanged()
 {
+    // The view holds all of memory; jump to the row of the entered address
+    m_currentMemoryAddress = m_memoryAddressSpinBox->value();
+    const int offset = m_currentMemoryAddress - m_memoryModel->baseAddress();
+    const QModelIndex index = m_memoryModel->index(offset / MemoryViewModel::kBytesPerRow,
+                                                   offset % MemoryViewModel::kBytesPerRow);
+    m_memoryView->scrollTo(index, QAbstractItemView::PositionAtTop);
+    m_memoryView->setCurrentIndex(index);
     updateMemoryDisplay();
 }
 
@@ -885,12 +831,12 @@ void DebuggerWidget::refreshDebugInfo()
     updateCPUState();
     updateMemoryView();
     updateDisassemblyView();
+    updateProfilerDisplay();
 }
 
 bool DebuggerWidget::isSubroutineCall(unsigned char opcode)
 {
-    // JSR (Jump to Subroutine) instruction
-    return opcode == 0x20;
+    return opcodeInfo6502(opcode).flow == FlowKind6502::Call;
 }
 
 void DebuggerWidget::stepSingleInstruction()
@@ -901,7 +847,7 @@ void DebuggerWidget::stepSingleInstruction()
     
     unsigned short startPC = CPU_regPC;
     unsigned char opcode = MEMORY_mem[startPC];
-    int instructionSize = getInstructionSize(opcode);
+    int instructionSize = opcodeInfo6502(opcode).bytes;
     
     // Execute exactly one CPU instruction using the new libatari800 function
     m_emulator->stepOneInstruction();
@@ -922,43 +868,16 @@ void DebuggerWidget::stepOverSubroutine()
     unsigned char opcode = MEMORY_mem[currentPC];
     
     if (isSubroutineCall(opcode)) {
-        // This is a JSR instruction - execute it and then run until return address
+        // This is a JSR instruction - run until it returns to the caller
         unsigned short returnAddress = currentPC + 3;  // JSR is 3 bytes
         
         qDebug() << QString("Step Over: JSR at $%1, target return at $%2")
                     .arg(currentPC, 4, 16, QChar('0')).toUpper()
                     .arg(returnAddress, 4, 16, QChar('0')).toUpper();
         
-        // Execute the JSR instruction first
-        m_emulator->stepOneInstruction();
-        
-        // Now we're inside the subroutine, step until we reach the return address
-        // Use a safety limit to prevent infinite loops
-        int maxSteps = 10000;  // Maximum instructions to execute
-        int stepCount = 0;
-        
-        while (CPU_regPC != returnAddress && stepCount < maxSteps) {
-            m_emulator->stepOneInstruction();
-            stepCount++;
-            
-            // Update display periodically for long subroutines
-            if (stepCount % 100 == 0) {
-                refreshDebugInfo();
-                QCoreApplication::processEvents();
-            }
-        }
-        
-        if (stepCount >= maxSteps) {
-            qDebug() << QString("Step Over: Timeout after %1 steps, subroutine may not return")
-                        .arg(stepCount);
-        } else {
-            qDebug() << QString("Step Over: Completed after %1 steps, PC at $%2")
-                        .arg(stepCount)
-                        .arg(CPU_regPC, 4, 16, QChar('0')).toUpper();
-        }
-        
-        // Refresh the display
-        refreshDebugInfo();
+        // Runs at full speed on the emulator thread; debugStepped (or breakpointHit,
+        // if a breakpoint inside the subroutine stops it first) refreshes the view.
+        m_emulator->stepOver();
     } else {
         // Not a subroutine call, just step one instruction
         stepSingleInstruction();
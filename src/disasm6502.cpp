@@ -6,239 +6,251 @@
  */
 
 #include "disasm6502.h"
-#include <QString>
-
-// 6502 addressing modes
-enum AddressMode {
-    MODE_IMPLIED,      // No operand
-    MODE_ACCUMULATOR,  // Operates on accumulator
-    MODE_IMMEDIATE,    // #$nn
-    MODE_ZERO_PAGE,    // $nn
-    MODE_ZERO_PAGE_X,  // $nn,X
-    MODE_ZERO_PAGE_Y,  // $nn,Y
-    MODE_ABSOLUTE,     // $nnnn
-    MODE_ABSOLUTE_X,   // $nnnn,X
-    MODE_ABSOLUTE_Y,   // $nnnn,Y
-    MODE_INDIRECT,     // ($nnnn)
-    MODE_INDIRECT_X,   // ($nn,X)
-    MODE_INDIRECT_Y,   // ($nn),Y
-    MODE_RELATIVE      // Branch instructions
-};
 
-// Instruction info
-struct InstructionInfo {
-    const char* mnemonic;
-    AddressMode mode;
-    int bytes;  // Total instruction length including opcode
-};
+namespace {
+
+using M = AddressMode6502;
+using F = FlowKind6502;
+
+const char kHexDigits[] = "0123456789ABCDEF";
+
+char* putHex(char* out, unsigned value, int digits)
+{
+    for (int shift = (digits - 1) * 4; shift >= 0; shift -= 4) {
+        *out++ = kHexDigits[(value >> shift) & 0xF];
+    }
+    return out;
+}
+
+char* putText(char* out, const char* text)
+{
+    while (*text) {
+        *out++ = *text++;
+    }
+    return out;
+}
+
+}  // namespace
 
 // 6502 instruction table indexed by opcode
-static const InstructionInfo instructionTable[256] = {
+constexpr OpcodeInfo6502 kOpcodeTable6502[256] = {
     // 0x00-0x0F
-    {"BRK", MODE_IMPLIED, 1},      {"ORA", MODE_INDIRECT_X, 2},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"???", MODE_IMPLIED, 1},      {"ORA", MODE_ZERO_PAGE, 2},    {"ASL", MODE_ZERO_PAGE, 2},    {"???", MODE_IMPLIED, 1},
-    {"PHP", MODE_IMPLIED, 1},      {"ORA", MODE_IMMEDIATE, 2},    {"ASL", MODE_ACCUMULATOR, 1},  {"???", MODE_IMPLIED, 1},
-    {"???", MODE_IMPLIED, 1},      {"ORA", MODE_ABSOLUTE, 3},     {"ASL", MODE_ABSOLUTE, 3},     {"???", MODE_IMPLIED, 1},
-    
+    {"BRK", M::Implied, 1, 7, F::Break},     {"ORA", M::IndirectX, 2, 6, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"???", M::Implied, 1, 0, F::None},      {"ORA", M::ZeroPage, 2, 3, F::None},     {"ASL", M::ZeroPage, 2, 5, F::None},     {"???", M::Implied, 1, 0, F::None},
+    {"PHP", M::Implied, 1, 3, F::None},      {"ORA", M::Immediate, 2, 2, F::None},    {"ASL", M::Accumulator, 1, 2, F::None},  {"???", M::Implied, 1, 0, F::None},
+    {"???", M::Implied, 1, 0, F::None},      {"ORA", M::Absolute, 3, 4, F::None},     {"ASL", M::Absolute, 3, 6, F::None},     {"???", M::Implied, 1, 0, F::None},
+
     // 0x10-0x1F
-    {"BPL", MODE_RELATIVE, 2},     {"ORA", MODE_INDIRECT_Y, 2},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"???", MODE_IMPLIED, 1},      {"ORA", MODE_ZERO_PAGE_X, 2},  {"ASL", MODE_ZERO_PAGE_X, 2},  {"???", MODE_IMPLIED, 1},
-    {"CLC", MODE_IMPLIED, 1},      {"ORA", MODE_ABSOLUTE_Y, 3},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"???", MODE_IMPLIED, 1},      {"ORA", MODE_ABSOLUTE_X, 3},   {"ASL", MODE_ABSOLUTE_X, 3},   {"???", MODE_IMPLIED, 1},
-    
+    {"BPL", M::Relative, 2, 2, F::Branch},   {"ORA", M::IndirectY, 2, 5, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"???", M::Implied, 1, 0, F::None},      {"ORA", M::ZeroPageX, 2, 4, F::None},    {"ASL", M::ZeroPageX, 2, 6, F::None},    {"???", M::Implied, 1, 0, F::None},
+    {"CLC", M::Implied, 1, 2, F::None},      {"ORA", M::AbsoluteY, 3, 4, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"???", M::Implied, 1, 0, F::None},      {"ORA", M::AbsoluteX, 3, 4, F::None},    {"ASL", M::AbsoluteX, 3, 7, F::None},    {"???", M::Implied, 1, 0, F::None},
+
     // 0x20-0x2F
-    {"JSR", MODE_ABSOLUTE, 3},     {"AND", MODE_INDIRECT_X, 2},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"BIT", MODE_ZERO_PAGE, 2},    {"AND", MODE_ZERO_PAGE, 2},    {"ROL", MODE_ZERO_PAGE, 2},    {"???", MODE_IMPLIED, 1},
-    {"PLP", MODE_IMPLIED, 1},      {"AND", MODE_IMMEDIATE, 2},    {"ROL", MODE_ACCUMULATOR, 1},  {"???", MODE_IMPLIED, 1},
-    {"BIT", MODE_ABSOLUTE, 3},     {"AND", MODE_ABSOLUTE, 3},     {"ROL", MODE_ABSOLUTE, 3},     {"???", MODE_IMPLIED, 1},
-    
+    {"JSR", M::Absolute, 3, 6, F::Call},     {"AND", M::IndirectX, 2, 6, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"BIT", M::ZeroPage, 2, 3, F::None},     {"AND", M::ZeroPage, 2, 3, F::None},     {"ROL", M::ZeroPage, 2, 5, F::None},     {"???", M::Implied, 1, 0, F::None},
+    {"PLP", M::Implied, 1, 4, F::None},      {"AND", M::Immediate, 2, 2, F::None},    {"ROL", M::Accumulator, 1, 2, F::None},  {"???", M::Implied, 1, 0, F::None},
+    {"BIT", M::Absolute, 3, 4, F::None},     {"AND", M::Absolute, 3, 4, F::None},     {"ROL", M::Absolute, 3, 6, F::None},     {"???", M::Implied, 1, 0, F::None},
+
     // 0x30-0x3F
-    {"BMI", MODE_RELATIVE, 2},     {"AND", MODE_INDIRECT_Y, 2},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"???", MODE_IMPLIED, 1},      {"AND", MODE_ZERO_PAGE_X, 2},  {"ROL", MODE_ZERO_PAGE_X, 2},  {"???", MODE_IMPLIED, 1},
-    {"SEC", MODE_IMPLIED, 1},      {"AND", MODE_ABSOLUTE_Y, 3},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"???", MODE_IMPLIED, 1},      {"AND", MODE_ABSOLUTE_X, 3},   {"ROL", MODE_ABSOLUTE_X, 3},   {"???", MODE_IMPLIED, 1},
-    
+    {"BMI", M::Relative, 2, 2, F::Branch},   {"AND", M::IndirectY, 2, 5, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"???", M::Implied, 1, 0, F::None},      {"AND", M::ZeroPageX, 2, 4, F::None},    {"ROL", M::ZeroPageX, 2, 6, F::None},    {"???", M::Implied, 1, 0, F::None},
+    {"SEC", M::Implied, 1, 2, F::None},      {"AND", M::AbsoluteY, 3, 4, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"???", M::Implied, 1, 0, F::None},      {"AND", M::AbsoluteX, 3, 4, F::None},    {"ROL", M::AbsoluteX, 3, 7, F::None},    {"???", M::Implied, 1, 0, F::None},
+
     // 0x40-0x4F
-    {"RTI", MODE_IMPLIED, 1},      {"EOR", MODE_INDIRECT_X, 2},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"???", MODE_IMPLIED, 1},      {"EOR", MODE_ZERO_PAGE, 2},    {"LSR", MODE_ZERO_PAGE, 2},    {"???", MODE_IMPLIED, 1},
-    {"PHA", MODE_IMPLIED, 1},      {"EOR", MODE_IMMEDIATE, 2},    {"LSR", MODE_ACCUMULATOR, 1},  {"???", MODE_IMPLIED, 1},
-    {"JMP", MODE_ABSOLUTE, 3},     {"EOR", MODE_ABSOLUTE, 3},     {"LSR", MODE_ABSOLUTE, 3},     {"???", MODE_IMPLIED, 1},
-    
+    {"RTI", M::Implied, 1, 6, F::ReturnFromInterrupt}, {"EOR", M::IndirectX, 2, 6, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"???", M::Implied, 1, 0, F::None},      {"EOR", M::ZeroPage, 2, 3, F::None},     {"LSR", M::ZeroPage, 2, 5, F::None},     {"???", M::Implied, 1, 0, F::None},
+    {"PHA", M::Implied, 1, 3, F::None},      {"EOR", M::Immediate, 2, 2, F::None},    {"LSR", M::Accumulator, 1, 2, F::None},  {"???", M::Implied, 1, 0, F::None},
+    {"JMP", M::Absolute, 3, 3, F::Jump},     {"EOR", M::Absolute, 3, 4, F::None},     {"LSR", M::Absolute, 3, 6, F::None},     {"???", M::Implied, 1, 0, F::None},
+
     // 0x50-0x5F
-    {"BVC", MODE_RELATIVE, 2},     {"EOR", MODE_INDIRECT_Y, 2},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"???", MODE_IMPLIED, 1},      {"EOR", MODE_ZERO_PAGE_X, 2},  {"LSR", MODE_ZERO_PAGE_X, 2},  {"???", MODE_IMPLIED, 1},
-    {"CLI", MODE_IMPLIED, 1},      {"EOR", MODE_ABSOLUTE_Y, 3},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"???", MODE_IMPLIED, 1},      {"EOR", MODE_ABSOLUTE_X, 3},   {"LSR", MODE_ABSOLUTE_X, 3},   {"???", MODE_IMPLIED, 1},
-    
+    {"BVC", M::Relative, 2, 2, F::Branch},   {"EOR", M::IndirectY, 2, 5, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"???", M::Implied, 1, 0, F::None},      {"EOR", M::ZeroPageX, 2, 4, F::None},    {"LSR", M::ZeroPageX, 2, 6, F::None},    {"???", M::Implied, 1, 0, F::None},
+    {"CLI", M::Implied, 1, 2, F::None},      {"EOR", M::AbsoluteY, 3, 4, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"???", M::Implied, 1, 0, F::None},      {"EOR", M::AbsoluteX, 3, 4, F::None},    {"LSR", M::AbsoluteX, 3, 7, F::None},    {"???", M::Implied, 1, 0, F::None},
+
     // 0x60-0x6F
-    {"RTS", MODE_IMPLIED, 1},      {"ADC", MODE_INDIRECT_X, 2},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"???", MODE_IMPLIED, 1},      {"ADC", MODE_ZERO_PAGE, 2},    {"ROR", MODE_ZERO_PAGE, 2},    {"???", MODE_IMPLIED, 1},
-    {"PLA", MODE_IMPLIED, 1},      {"ADC", MODE_IMMEDIATE, 2},    {"ROR", MODE_ACCUMULATOR, 1},  {"???", MODE_IMPLIED, 1},
-    {"JMP", MODE_INDIRECT, 3},     {"ADC", MODE_ABSOLUTE, 3},     {"ROR", MODE_ABSOLUTE, 3},     {"???", MODE_IMPLIED, 1},
-    
+    {"RTS", M::Implied, 1, 6, F::Return},    {"ADC", M::IndirectX, 2, 6, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"???", M::Implied, 1, 0, F::None},      {"ADC", M::ZeroPage, 2, 3, F::None},     {"ROR", M::ZeroPage, 2, 5, F::None},     {"???", M::Implied, 1, 0, F::None},
+    {"PLA", M::Implied, 1, 4, F::None},      {"ADC", M::Immediate, 2, 2, F::None},    {"ROR", M::Accumulator, 1, 2, F::None},  {"???", M::Implied, 1, 0, F::None},
+    {"JMP", M::Indirect, 3, 5, F::JumpIndirect}, {"ADC", M::Absolute, 3, 4, F::None},     {"ROR", M::Absolute, 3, 6, F::None},     {"???", M::Implied, 1, 0, F::None},
+
     // 0x70-0x7F
-    {"BVS", MODE_RELATIVE, 2},     {"ADC", MODE_INDIRECT_Y, 2},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"???", MODE_IMPLIED, 1},      {"ADC", MODE_ZERO_PAGE_X, 2},  {"ROR", MODE_ZERO_PAGE_X, 2},  {"???", MODE_IMPLIED, 1},
-    {"SEI", MODE_IMPLIED, 1},      {"ADC", MODE_ABSOLUTE_Y, 3},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"???", MODE_IMPLIED, 1},      {"ADC", MODE_ABSOLUTE_X, 3},   {"ROR", MODE_ABSOLUTE_X, 3},   {"???", MODE_IMPLIED, 1},
-    
+    {"BVS", M::Relative, 2, 2, F::Branch},   {"ADC", M::IndirectY, 2, 5, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"???", M::Implied, 1, 0, F::None},      {"ADC", M::ZeroPageX, 2, 4, F::None},    {"ROR", M::ZeroPageX, 2, 6, F::None},    {"???", M::Implied, 1, 0, F::None},
+    {"SEI", M::Implied, 1, 2, F::None},      {"ADC", M::AbsoluteY, 3, 4, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"???", M::Implied, 1, 0, F::None},      {"ADC", M::AbsoluteX, 3, 4, F::None},    {"ROR", M::AbsoluteX, 3, 7, F::None},    {"???", M::Implied, 1, 0, F::None},
+
     // 0x80-0x8F
-    {"???", MODE_IMPLIED, 1},      {"STA", MODE_INDIRECT_X, 2},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"STY", MODE_ZERO_PAGE, 2},    {"STA", MODE_ZERO_PAGE, 2},    {"STX", MODE_ZERO_PAGE, 2},    {"???", MODE_IMPLIED, 1},
-    {"DEY", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},      {"TXA", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"STY", MODE_ABSOLUTE, 3},     {"STA", MODE_ABSOLUTE, 3},     {"STX", MODE_ABSOLUTE, 3},     {"???", MODE_IMPLIED, 1},
-    
+    {"???", M::Implied, 1, 0, F::None},      {"STA", M::IndirectX, 2, 6, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"STY", M::ZeroPage, 2, 3, F::None},     {"STA", M::ZeroPage, 2, 3, F::None},     {"STX", M::ZeroPage, 2, 3, F::None},     {"???", M::Implied, 1, 0, F::None},
+    {"DEY", M::Implied, 1, 2, F::None},      {"???", M::Implied, 1, 0, F::None},      {"TXA", M::Implied, 1, 2, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"STY", M::Absolute, 3, 4, F::None},     {"STA", M::Absolute, 3, 4, F::None},     {"STX", M::Absolute, 3, 4, F::None},     {"???", M::Implied, 1, 0, F::None},
+
     // 0x90-0x9F
-    {"BCC", MODE_RELATIVE, 2},     {"STA", MODE_INDIRECT_Y, 2},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"STY", MODE_ZERO_PAGE_X, 2},  {"STA", MODE_ZERO_PAGE_X, 2},  {"STX", MODE_ZERO_PAGE_Y, 2},  {"???", MODE_IMPLIED, 1},
-    {"TYA", MODE_IMPLIED, 1},      {"STA", MODE_ABSOLUTE_Y, 3},   {"TXS", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"???", MODE_IMPLIED, 1},      {"STA", MODE_ABSOLUTE_X, 3},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    
+    {"BCC", M::Relative, 2, 2, F::Branch},   {"STA", M::IndirectY, 2, 6, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"STY", M::ZeroPageX, 2, 4, F::None},    {"STA", M::ZeroPageX, 2, 4, F::None},    {"STX", M::ZeroPageY, 2, 4, F::None},    {"???", M::Implied, 1, 0, F::None},
+    {"TYA", M::Implied, 1, 2, F::None},      {"STA", M::AbsoluteY, 3, 5, F::None},    {"TXS", M::Implied, 1, 2, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"???", M::Implied, 1, 0, F::None},      {"STA", M::AbsoluteX, 3, 5, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+
     // 0xA0-0xAF
-    {"LDY", MODE_IMMEDIATE, 2},    {"LDA", MODE_INDIRECT_X, 2},   {"LDX", MODE_IMMEDIATE, 2},    {"???", MODE_IMPLIED, 1},
-    {"LDY", MODE_ZERO_PAGE, 2},    {"LDA", MODE_ZERO_PAGE, 2},    {"LDX", MODE_ZERO_PAGE, 2},    {"???", MODE_IMPLIED, 1},
-    {"TAY", MODE_IMPLIED, 1},      {"LDA", MODE_IMMEDIATE, 2},    {"TAX", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"LDY", MODE_ABSOLUTE, 3},     {"LDA", MODE_ABSOLUTE, 3},     {"LDX", MODE_ABSOLUTE, 3},     {"???", MODE_IMPLIED, 1},
-    
+    {"LDY", M::Immediate, 2, 2, F::None},    {"LDA", M::IndirectX, 2, 6, F::None},    {"LDX", M::Immediate, 2, 2, F::None},    {"???", M::Implied, 1, 0, F::None},
+    {"LDY", M::ZeroPage, 2, 3, F::None},     {"LDA", M::ZeroPage, 2, 3, F::None},     {"LDX", M::ZeroPage, 2, 3, F::None},     {"???", M::Implied, 1, 0, F::None},
+    {"TAY", M::Implied, 1, 2, F::None},      {"LDA", M::Immediate, 2, 2, F::None},    {"TAX", M::Implied, 1, 2, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"LDY", M::Absolute, 3, 4, F::None},     {"LDA", M::Absolute, 3, 4, F::None},     {"LDX", M::Absolute, 3, 4, F::None},     {"???", M::Implied, 1, 0, F::None},
+
     // 0xB0-0xBF
-    {"BCS", MODE_RELATIVE, 2},     {"LDA", MODE_INDIRECT_Y, 2},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"LDY", MODE_ZERO_PAGE_X, 2},  {"LDA", MODE_ZERO_PAGE_X, 2},  {"LDX", MODE_ZERO_PAGE_Y, 2},  {"???", MODE_IMPLIED, 1},
-    {"CLV", MODE_IMPLIED, 1},      {"LDA", MODE_ABSOLUTE_Y, 3},   {"TSX", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"LDY", MODE_ABSOLUTE_X, 3},   {"LDA", MODE_ABSOLUTE_X, 3},   {"LDX", MODE_ABSOLUTE_Y, 3},   {"???", MODE_IMPLIED, 1},
-    
+    {"BCS", M::Relative, 2, 2, F::Branch},   {"LDA", M::IndirectY, 2, 5, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"LDY", M::ZeroPageX, 2, 4, F::None},    {"LDA", M::ZeroPageX, 2, 4, F::None},    {"LDX", M::ZeroPageY, 2, 4, F::None},    {"???", M::Implied, 1, 0, F::None},
+    {"CLV", M::Implied, 1, 2, F::None},      {"LDA", M::AbsoluteY, 3, 4, F::None},    {"TSX", M::Implied, 1, 2, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"LDY", M::AbsoluteX, 3, 4, F::None},    {"LDA", M::AbsoluteX, 3, 4, F::None},    {"LDX", M::AbsoluteY, 3, 4, F::None},    {"???", M::Implied, 1, 0, F::None},
+
     // 0xC0-0xCF
-    {"CPY", MODE_IMMEDIATE, 2},    {"CMP", MODE_INDIRECT_X, 2},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"CPY", MODE_ZERO_PAGE, 2},    {"CMP", MODE_ZERO_PAGE, 2},    {"DEC", MODE_ZERO_PAGE, 2},    {"???", MODE_IMPLIED, 1},
-    {"INY", MODE_IMPLIED, 1},      {"CMP", MODE_IMMEDIATE, 2},    {"DEX", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"CPY", MODE_ABSOLUTE, 3},     {"CMP", MODE_ABSOLUTE, 3},     {"DEC", MODE_ABSOLUTE, 3},     {"???", MODE_IMPLIED, 1},
-    
+    {"CPY", M::Immediate, 2, 2, F::None},    {"CMP", M::IndirectX, 2, 6, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"CPY", M::ZeroPage, 2, 3, F::None},     {"CMP", M::ZeroPage, 2, 3, F::None},     {"DEC", M::ZeroPage, 2, 5, F::None},     {"???", M::Implied, 1, 0, F::None},
+    {"INY", M::Implied, 1, 2, F::None},      {"CMP", M::Immediate, 2, 2, F::None},    {"DEX", M::Implied, 1, 2, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"CPY", M::Absolute, 3, 4, F::None},     {"CMP", M::Absolute, 3, 4, F::None},     {"DEC", M::Absolute, 3, 6, F::None},     {"???", M::Implied, 1, 0, F::None},
+
     // 0xD0-0xDF
-    {"BNE", MODE_RELATIVE, 2},     {"CMP", MODE_INDIRECT_Y, 2},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"???", MODE_IMPLIED, 1},      {"CMP", MODE_ZERO_PAGE_X, 2},  {"DEC", MODE_ZERO_PAGE_X, 2},  {"???", MODE_IMPLIED, 1},
-    {"CLD", MODE_IMPLIED, 1},      {"CMP", MODE_ABSOLUTE_Y, 3},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"???", MODE_IMPLIED, 1},      {"CMP", MODE_ABSOLUTE_X, 3},   {"DEC", MODE_ABSOLUTE_X, 3},   {"???", MODE_IMPLIED, 1},
-    
+    {"BNE", M::Relative, 2, 2, F::Branch},   {"CMP", M::IndirectY, 2, 5, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"???", M::Implied, 1, 0, F::None},      {"CMP", M::ZeroPageX, 2, 4, F::None},    {"DEC", M::ZeroPageX, 2, 6, F::None},    {"???", M::Implied, 1, 0, F::None},
+    {"CLD", M::Implied, 1, 2, F::None},      {"CMP", M::AbsoluteY, 3, 4, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"???", M::Implied, 1, 0, F::None},      {"CMP", M::AbsoluteX, 3, 4, F::None},    {"DEC", M::AbsoluteX, 3, 7, F::None},    {"???", M::Implied, 1, 0, F::None},
+
     // 0xE0-0xEF
-    {"CPX", MODE_IMMEDIATE, 2},    {"SBC", MODE_INDIRECT_X, 2},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"CPX", MODE_ZERO_PAGE, 2},    {"SBC", MODE_ZERO_PAGE, 2},    {"INC", MODE_ZERO_PAGE, 2},    {"???", MODE_IMPLIED, 1},
-    {"INX", MODE_IMPLIED, 1},      {"SBC", MODE_IMMEDIATE, 2},    {"NOP", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"CPX", MODE_ABSOLUTE, 3},     {"SBC", MODE_ABSOLUTE, 3},     {"INC", MODE_ABSOLUTE, 3},     {"???", MODE_IMPLIED, 1},
-    
+    {"CPX", M::Immediate, 2, 2, F::None},    {"SBC", M::IndirectX, 2, 6, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"CPX", M::ZeroPage, 2, 3, F::None},     {"SBC", M::ZeroPage, 2, 3, F::None},     {"INC", M::ZeroPage, 2, 5, F::None},     {"???", M::Implied, 1, 0, F::None},
+    {"INX", M::Implied, 1, 2, F::None},      {"SBC", M::Immediate, 2, 2, F::None},    {"NOP", M::Implied, 1, 2, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"CPX", M::Absolute, 3, 4, F::None},     {"SBC", M::Absolute, 3, 4, F::None},     {"INC", M::Absolute, 3, 6, F::None},     {"???", M::Implied, 1, 0, F::None},
+
     // 0xF0-0xFF
-    {"BEQ", MODE_RELATIVE, 2},     {"SBC", MODE_INDIRECT_Y, 2},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"???", MODE_IMPLIED, 1},      {"SBC", MODE_ZERO_PAGE_X, 2},  {"INC", MODE_ZERO_PAGE_X, 2},  {"???", MODE_IMPLIED, 1},
-    {"SED", MODE_IMPLIED, 1},      {"SBC", MODE_ABSOLUTE_Y, 3},   {"???", MODE_IMPLIED, 1},      {"???", MODE_IMPLIED, 1},
-    {"???", MODE_IMPLIED, 1},      {"SBC", MODE_ABSOLUTE_X, 3},   {"INC", MODE_ABSOLUTE_X, 3},   {"???", MODE_IMPLIED, 1}
+    {"BEQ", M::Relative, 2, 2, F::Branch},   {"SBC", M::IndirectY, 2, 5, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"???", M::Implied, 1, 0, F::None},      {"SBC", M::ZeroPageX, 2, 4, F::None},    {"INC", M::ZeroPageX, 2, 6, F::None},    {"???", M::Implied, 1, 0, F::None},
+    {"SED", M::Implied, 1, 2, F::None},      {"SBC", M::AbsoluteY, 3, 4, F::None},    {"???", M::Implied, 1, 0, F::None},      {"???", M::Implied, 1, 0, F::None},
+    {"???", M::Implied, 1, 0, F::None},      {"SBC", M::AbsoluteX, 3, 4, F::None},    {"INC", M::AbsoluteX, 3, 7, F::None},    {"???", M::Implied, 1, 0, F::None}
 };
 
-DisassembledInstruction disassemble6502(const unsigned char* memory, unsigned short address, unsigned short maxAddress)
+int formatInstruction6502(const unsigned char* memory, unsigned short address, char* out)
 {
-    DisassembledInstruction result;
-    
-    if (address > maxAddress) {
-        result.mnemonic = "???";
-        result.operand = "";
-        result.bytes = 1;
-        result.opcode = 0;
-        return result;
+    const OpcodeInfo6502& info = kOpcodeTable6502[memory[address]];
+    const unsigned lo = memory[static_cast<unsigned short>(address + 1)];
+    const unsigned word = lo | (memory[static_cast<unsigned short>(address + 2)] << 8);
+
+    char* p = putText(out, info.mnemonic);
+    if (info.mode != M::Implied && info.mode != M::Accumulator) {
+        *p++ = ' ';
     }
-    
-    unsigned char opcode = memory[address];
-    const InstructionInfo& info = instructionTable[opcode];
-    
-    result.opcode = opcode;
-    result.mnemonic = info.mnemonic;
-    result.bytes = info.bytes;
-    
-    // Format operand based on addressing mode
     switch (info.mode) {
-        case MODE_IMPLIED:
-        case MODE_ACCUMULATOR:
-            result.operand = "";
+        case M::Implied:
+        case M::Accumulator:
+            break;
+        case M::Immediate:
+            p = putHex(putText(p, "#$"), lo, 2);
             break;
-            
-        case MODE_IMMEDIATE:
-            if (address + 1 <= maxAddress) {
-                unsigned char value = memory[address + 1];
-                result.operand = QString("#$%1").arg(value, 2, 16, QChar('0')).toUpper();
-            }
+        case M::ZeroPage:
+            p = putHex(putText(p, "$"), lo, 2);
             break;
-            
-        case MODE_ZERO_PAGE:
-            if (address + 1 <= maxAddress) {
-                unsigned char addr = memory[address + 1];
-                result.operand = QString("$%1").arg(addr, 2, 16, QChar('0')).toUpper();
-            }
+        case M::ZeroPageX:
+            p = putText(putHex(putText(p, "$"), lo, 2), ",X");
             break;
-            
-        case MODE_ZERO_PAGE_X:
-            if (address + 1 <= maxAddress) {
-                unsigned char addr = memory[address + 1];
-                result.operand = QString("$%1,X").arg(addr, 2, 16, QChar('0')).toUpper();
-            }
+        case M::ZeroPageY:
+            p = putText(putHex(putText(p, "$"), lo, 2), ",Y");
             break;
-            
-        case MODE_ZERO_PAGE_Y:
-            if (address + 1 <= maxAddress) {
-                unsigned char addr = memory[address + 1];
-                result.operand = QString("$%1,Y").arg(addr, 2, 16, QChar('0')).toUpper();
-            }
+        case M::Absolute:
+            p = putHex(putText(p, "$"), word, 4);
             break;
-            
-        case MODE_ABSOLUTE:
-        case MODE_INDIRECT:
-            if (address + 2 <= maxAddress) {
-                unsigned short addr = memory[address + 1] | (memory[address + 2] << 8);
-                if (info.mode == MODE_INDIRECT) {
-                    result.operand = QString("($%1)").arg(addr, 4, 16, QChar('0')).toUpper();
-                } else {
-                    result.operand = QString("$%1").arg(addr, 4, 16, QChar('0')).toUpper();
-                }
-            }
+        case M::AbsoluteX:
+            p = putText(putHex(putText(p, "$"), word, 4), ",X");
             break;
-            
-        case MODE_ABSOLUTE_X:
-            if (address + 2 <= maxAddress) {
-                unsigned short addr = memory[address + 1] | (memory[address + 2] << 8);
-                result.operand = QString("$%1,X").arg(addr, 4, 16, QChar('0')).toUpper();
-            }
+        case M::AbsoluteY:
+            p = putText(putHex(putText(p, "$"), word, 4), ",Y");
             break;
-            
-        case MODE_ABSOLUTE_Y:
-            if (address + 2 <= maxAddress) {
-                unsigned short addr = memory[address + 1] | (memory[address + 2] << 8);
-                result.operand = QString("$%1,Y").arg(addr, 4, 16, QChar('0')).toUpper();
-            }
+        case M::Indirect:
+            p = putText(putHex(putText(p, "($"), word, 4), ")");
             break;
-            
-        case MODE_INDIRECT_X:
-            if (address + 1 <= maxAddress) {
-                unsigned char addr = memory[address + 1];
-                result.operand = QString("($%1,X)").arg(addr, 2, 16, QChar('0')).toUpper();
-            }
+        case M::IndirectX:
+            p = putText(putHex(putText(p, "($"), lo, 2), ",X)");
             break;
-            
-        case MODE_INDIRECT_Y:
-            if (address + 1 <= maxAddress) {
-                unsigned char addr = memory[address + 1];
-                result.operand = QString("($%1),Y").arg(addr, 2, 16, QChar('0')).toUpper();
-            }
+        case M::IndirectY:
+            p = putText(putHex(putText(p, "($"), lo, 2), "),Y");
             break;
-            
-        case MODE_RELATIVE:
-            if (address + 1 <= maxAddress) {
-                signed char offset = (signed char)memory[address + 1];
-                unsigned short targetAddr = address + 2 + offset;
-                result.operand = QString("$%1").arg(targetAddr, 4, 16, QChar('0')).toUpper();
-            }
+        case M::Relative: {
+            const unsigned short target = static_cast<unsigned short>(address + 2 + static_cast<signed char>(lo));
+            p = putHex(putText(p, "$"), target, 4);
             break;
+        }
+    }
+    *p = '\0';
+    return info.bytes;
+}
+
+bool operandAddress6502(const unsigned char* memory, unsigned short address, unsigned short* target)
+{
+    const OpcodeInfo6502& info = kOpcodeTable6502[memory[address]];
+    const unsigned lo = memory[static_cast<unsigned short>(address + 1)];
+    switch (info.mode) {
+        case M::Implied:
+        case M::Accumulator:
+        case M::Immediate:
+            return false;
+        case M::ZeroPage:
+        case M::ZeroPageX:
+        case M::ZeroPageY:
+        case M::IndirectX:
+        case M::IndirectY:
+            *target = static_cast<unsigned short>(lo);
+            return true;
+        case M::Relative:
+            *target = static_cast<unsigned short>(address + 2 + static_cast<signed char>(lo));
+            return true;
+        default:
+            *target = static_cast<unsigned short>(lo | (memory[static_cast<unsigned short>(address + 2)] << 8));
+            return true;
+    }
+}
+
+int formatInstructionSymbolic6502(const unsigned char* memory, unsigned short address,
+                                  LabelLookup6502 lookup, const void* context, char* out)
+{
+    unsigned short target = 0;
+    const char* label = nullptr;
+    if (!lookup || !operandAddress6502(memory, address, &target) || !(label = lookup(target, context))) {
+        return formatInstruction6502(memory, address, out);
+    }
+
+    const OpcodeInfo6502& info = kOpcodeTable6502[memory[address]];
+    const char* prefix = "";
+    const char* suffix = "";
+    switch (info.mode) {
+        case M::ZeroPageX: case M::AbsoluteX: suffix = ",X"; break;
+        case M::ZeroPageY: case M::AbsoluteY: suffix = ",Y"; break;
+        case M::Indirect:  prefix = "("; suffix = ")"; break;
+        case M::IndirectX: prefix = "("; suffix = ",X)"; break;
+        case M::IndirectY: prefix = "("; suffix = "),Y"; break;
+        default: break;
+    }
+    char* p = putText(out, info.mnemonic);
+    *p++ = ' ';
+    p = putText(p, prefix);
+    for (int i = 0; i < kMaxLabelText6502 && label[i]; ++i) {
+        *p++ = label[i];
     }
-    
-    // If we couldn't read enough bytes, mark as incomplete
-    if (result.operand.isEmpty() && info.bytes > 1) {
-        result.mnemonic = "???";
-        result.bytes = 1;
+    p = putText(p, suffix);
+    *p = '\0';
+    return info.bytes;
+}
+
+int formatInstructionBytes6502(const unsigned char* memory, unsigned short address, char* out)
+{
+    const int bytes = kOpcodeTable6502[memory[address]].bytes;
+    char* p = out;
+    for (int i = 0; i < bytes; ++i) {
+        if (i > 0) {
+            *p++ = ' ';
+        }
+        p = putHex(p, memory[static_cast<unsigned short>(address + i)], 2);
     }
-    
-    return result;
-}
\ No newline at end of file
+    *p = '\0';
+    return static_cast<int>(p - out);
+}
@@ -0,0 +1,274 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "diskimagecache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <cstring>
+
+namespace {
+QString workTemplate(const QString& workBase)
+{
+    QString base = workBase;
+    if (base.isEmpty()) {
+        base = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    }
+    if (base.isEmpty() || !QFileInfo(base).isWritable()) {
+        base = QDir::tempPath();
+    }
+    return base + QStringLiteral("/fujisan-disks-XXXXXX");
+}
+
+bool isAtr(const QByteArray& image)
+{
+    return image.size() >= 16 && static_cast<quint8>(image[0]) == 0x96 && static_cast<quint8>(image[1]) == 0x02;
+}
+}
+
+DiskImageCache::DiskImageCache(const QString& workBase)
+    : m_workDirectory(workTemplate(workBase))
+{
+}
+
+QByteArray DiskImageCache::image(const QString& path, QString* error)
+{
+    const QFileInfo info(path);
+    const QString key = info.canonicalFilePath();
+    if (key.isEmpty()) {
+        if (error) {
+            *error = QStringLiteral("Disk image not found: %1").arg(path);
+        }
+        return QByteArray();
+    }
+
+    auto it = m_images.find(key);
+    if (it != m_images.end()) {
+        if (it->size == info.size() && it->modified == info.lastModified()) {
+            it->lastUse = ++m_useCounter;
+            return it->bytes;
+        }
+        m_cachedBytes -= it->bytes.size();
+        m_images.erase(it);
+    }
+
+    QFile file(key);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = QStringLiteral("Cannot read disk image %1: %2").arg(path, file.errorString());
+        }
+        return QByteArray();
+    }
+    Entry entry;
+    entry.bytes = file.readAll();
+    entry.size = info.size();
+    entry.modified = info.lastModified();
+    entry.lastUse = ++m_useCounter;
+    m_cachedBytes += entry.bytes.size();
+    m_images.insert(key, entry);
+    const QByteArray bytes = entry.bytes;
+    evict();
+    return bytes;
+}
+
+void DiskImageCache::setMaxCachedBytes(qint64 bytes)
+{
+    m_maxCachedBytes = bytes;
+    evict();
+}
+
+void DiskImageCache::evict()
+{
+    while (m_cachedBytes > m_maxCachedBytes && !m_images.isEmpty()) {
+        auto oldest = m_images.begin();
+        for (auto it = m_images.begin(); it != m_images.end(); ++it) {
+            if (it->lastUse < oldest->lastUse) {
+                oldest = it;
+            }
+        }
+        m_cachedBytes -= oldest->bytes.size();
+        m_images.erase(oldest);
+    }
+}
+
+QString DiskImageCache::beginOverlay(int drive, const QString& imagePath, QString* error)
+{
+    discardOverlay(drive);
+    if (!m_workDirectory.isValid()) {
+        if (error) {
+            *error = QStringLiteral("No scratch directory for disk overlays");
+        }
+        return QString();
+    }
+    Overlay overlay;
+    QString readError;
+    overlay.pristine = image(imagePath, &readError);
+    if (overlay.pristine.isEmpty()) {
+        if (error) {
+            *error = readError.isEmpty() ? QStringLiteral("Disk image is empty: %1").arg(imagePath) : readError;
+        }
+        return QString();
+    }
+    overlay.source = QFileInfo(imagePath).canonicalFilePath();
+    // Keep the file name (and so the extension the core goes by) recognisable
+    overlay.workingPath = m_workDirectory.filePath(
+        QStringLiteral("D%1-%2").arg(drive).arg(QFileInfo(imagePath).fileName()));
+    QFile working(overlay.workingPath);
+    if (!working.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        working.write(overlay.pristine) != overlay.pristine.size()) {
+        if (error) {
+            *error = QStringLiteral("Cannot write disk overlay %1: %2").arg(overlay.workingPath, working.errorString());
+        }
+        working.close();
+        QFile::remove(overlay.workingPath);
+        return QString();
+    }
+    m_overlays.insert(drive, overlay);
+    return overlay.workingPath;
+}
+
+QByteArray DiskImageCache::readWorkingCopy(int drive) const
+{
+    QFile working(m_overlays.value(drive).workingPath);
+    if (!working.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return working.readAll();
+}
+
+bool DiskImageCache::overlayChanged(int drive) const
+{
+    return hasOverlay(drive) && readWorkingCopy(drive) != m_overlays.value(drive).pristine;
+}
+
+QVector<int> DiskImageCache::changedSectors(int drive) const
+{
+    if (!hasOverlay(drive)) {
+        return QVector<int>();
+    }
+    return diffSectors(m_overlays.value(drive).pristine, readWorkingCopy(drive));
+}
+
+QByteArray DiskImageCache::overlaySector(int drive, int sector) const
+{
+    const QByteArray current = readWorkingCopy(drive);
+    Layout layout;
+    if (!layoutOf(current, &layout) || sector < 1 || sector > layout.sectorCount) {
+        return QByteArray();
+    }
+    return current.mid(layout.offset(sector), layout.size(sector));
+}
+
+bool DiskImageCache::commitOverlay(int drive, QString* error)
+{
+    if (!hasOverlay(drive)) {
+        if (error) {
+            *error = QStringLiteral("D%1: has no disk overlay").arg(drive);
+        }
+        return false;
+    }
+    const Overlay overlay = m_overlays.value(drive);
+    const QByteArray current = readWorkingCopy(drive);
+    if (current.isEmpty()) {
+        if (error) {
+            *error = QStringLiteral("Cannot read disk overlay %1").arg(overlay.workingPath);
+        }
+        return false;
+    }
+    if (current != overlay.pristine) {
+        QSaveFile file(overlay.source);
+        if (!file.open(QIODevice::WriteOnly) || file.write(current) != current.size() || !file.commit()) {
+            if (error) {
+                *error = QStringLiteral("Cannot write %1: %2").arg(overlay.source, file.errorString());
+            }
+            return false;
+        }
+        // The next mount reads the committed bytes from here, not the file
+        m_cachedBytes -= m_images.value(overlay.source).bytes.size();
+        m_images.remove(overlay.source);
+        const QFileInfo info(overlay.source);
+        Entry entry;
+        entry.bytes = current;
+        entry.size = info.size();
+        entry.modified = info.lastModified();
+        entry.lastUse = ++m_useCounter;
+        m_cachedBytes += entry.bytes.size();
+        m_images.insert(overlay.source, entry);
+        evict();
+    }
+    discardOverlay(drive);
+    return true;
+}
+
+void DiskImageCache::discardOverlay(int drive)
+{
+    auto it = m_overlays.find(drive);
+    if (it == m_overlays.end()) {
+        return;
+    }
+    QFile::remove(it->workingPath);
+    m_overlays.erase(it);
+}
+
+int DiskImageCache::Layout::offset(int sector) const
+{
+    if (sector <= 3) {
+        return headerBytes + (sector - 1) * bootSectorSize;
+    }
+    return headerBytes + 3 * bootSectorSize + (sector - 4) * sectorSize;
+}
+
+bool DiskImageCache::layoutOf(const QByteArray& image, Layout* layout)
+{
+    Layout result;
+    int dataBytes = image.size();
+    if (isAtr(image)) {
+        result.headerBytes = 16;
+        result.sectorSize = static_cast<quint8>(image[4]) | (static_cast<quint8>(image[5]) << 8);
+        dataBytes -= 16;
+        if (result.sectorSize != 128 && result.sectorSize != 256 && result.sectorSize != 512) {
+            return false;
+        }
+        // Double density images store the three boot sectors at 128 bytes,
+        // unless the data is a whole number of full sectors
+        result.bootSectorSize = (result.sectorSize == 256 && dataBytes % 256 != 0) ? 128 : result.sectorSize;
+    } else if (dataBytes == 0 || dataBytes % 128 != 0) {
+        return false;  // XFD is headerless single density; anything else is not plain sectors
+    }
+    const int bootBytes = 3 * result.bootSectorSize;
+    if (dataBytes < bootBytes) {
+        result.sectorCount = dataBytes / result.bootSectorSize;
+    } else {
+        result.sectorCount = 3 + (dataBytes - bootBytes) / result.sectorSize;
+    }
+    if (layout) {
+        *layout = result;
+    }
+    return true;
+}
+
+QVector<int> DiskImageCache::diffSectors(const QByteArray& before, const QByteArray& after)
+{
+    QVector<int> changed;
+    Layout layout;
+    if (!layoutOf(after, &layout)) {
+        return changed;
+    }
+    for (int sector = 1; sector <= layout.sectorCount; ++sector) {
+        const int offset = layout.offset(sector);
+        const int size = layout.size(sector);
+        if (offset + size > before.size() ||
+            memcmp(before.constData() + offset, after.constData() + offset, size) != 0) {
+            changed.append(sector);
+        }
+    }
+    return changed;
+}
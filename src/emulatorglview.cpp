@@ -0,0 +1,475 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "emulatorglview.h"
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
+#include <QVector2D>
+#include <QDebug>
+
+namespace {
+
+const char* kVertexShader = R"(
+attribute vec2 a_position;
+attribute vec2 a_texCoord;
+varying vec2 v_texCoord;
+void main()
+{
+    v_texCoord = a_texCoord;
+    gl_Position = vec4(a_position, 0.0, 1.0);
+}
+)";
+
+// Palette lookup happens per sampled texel, so smooth scaling has to blend the
+// four resolved colours manually — linear filtering of the index texture itself
+// would interpolate palette indices, not colours.
+const char* kFragmentShader = R"(
+#ifdef GL_ES
+precision mediump float;
+#endif
+uniform sampler2D u_index;
+uniform sampler2D u_palette;
+uniform vec2 u_sourceSize;
+uniform float u_smooth;
+varying vec2 v_texCoord;
+
+vec4 lookup(vec2 texel)
+{
+    float index = texture2D(u_index, (texel + 0.5) / u_sourceSize).r;
+    return texture2D(u_palette, vec2((index * 255.0 + 0.5) / 256.0, 0.5));
+}
+
+void main()
+{
+    vec2 pos = v_texCoord * u_sourceSize;
+    if (u_smooth > 0.5) {
+        vec2 base = floor(pos - 0.5);
+        vec2 f = pos - 0.5 - base;
+        vec4 top = mix(lookup(base), lookup(base + vec2(1.0, 0.0)), f.x);
+        vec4 bottom = mix(lookup(base + vec2(0.0, 1.0)), lookup(base + vec2(1.0, 1.0)), f.x);
+        gl_FragColor = mix(top, bottom, f.y);
+    } else {
+        gl_FragColor = lookup(floor(pos));
+    }
+}
+)";
+
+// CRT pass 1, drawn into a target of u_targetSize. In composite mode the
+// target has two samples per source pixel, i.e. four per colour clock, and each
+// sample decodes a simulated composite signal: every pixel's YIQ colour
+// modulated onto the subcarrier, averaged over two subcarrier cycles. Solid
+// colours come back unchanged, while luma that alternates every pixel lands on
+// the subcarrier frequency and decodes as colour, like hi-res artifacting on a
+// real set. Persistence keeps whichever is brighter: the new colour or the
+// previous frame faded by u_persistence.
+const char* kDecodeFragmentShader = R"(
+#ifdef GL_ES
+precision mediump float;
+#endif
+uniform sampler2D u_index;
+uniform sampler2D u_palette;
+uniform sampler2D u_previous;
+uniform vec2 u_sourceSize;
+uniform vec2 u_targetSize;
+uniform float u_composite;
+uniform float u_persistence;
+uniform float u_artifactPhase;
+varying vec2 v_texCoord;
+
+vec3 lookup(vec2 texel)
+{
+    float index = texture2D(u_index, (texel + 0.5) / u_sourceSize).r;
+    return texture2D(u_palette, vec2((index * 255.0 + 0.5) / 256.0, 0.5)).rgb;
+}
+
+float carrierPhase(float sampleIndex)
+{
+    return sampleIndex * 1.5707963 + u_artifactPhase;
+}
+
+void main()
+{
+    float row = floor(v_texCoord.y * u_sourceSize.y);
+    vec3 color;
+    if (u_composite > 0.5) {
+        float center = floor(v_texCoord.x * u_sourceSize.x * 2.0);
+        vec3 yiq = vec3(0.0);
+        for (int k = -4; k < 4; ++k) {
+            float sampleIndex = center + float(k);
+            vec3 rgb = lookup(vec2(floor(sampleIndex * 0.5), row));
+            float phase = carrierPhase(sampleIndex);
+            float c = cos(phase);
+            float s = sin(phase);
+            float signal = dot(rgb, vec3(0.299, 0.587, 0.114))
+                         + dot(rgb, vec3(0.596, -0.274, -0.322)) * c
+                         + dot(rgb, vec3(0.211, -0.523, 0.312)) * s;
+            yiq += vec3(signal, signal * c, signal * s);
+        }
+        yiq *= vec3(0.125, 0.25, 0.25);
+        color = clamp(vec3(yiq.x + 0.956 * yiq.y + 0.621 * yiq.z,
+                           yiq.x - 0.272 * yiq.y - 0.647 * yiq.z,
+                           yiq.x - 1.106 * yiq.y + 1.703 * yiq.z), 0.0, 1.0);
+    } else {
+        color = lookup(vec2(floor(v_texCoord.x * u_sourceSize.x), row));
+    }
+    if (u_persistence > 0.0) {
+        vec3 previous = texture2D(u_previous, gl_FragCoord.xy / u_targetSize).rgb;
+        color = max(color, previous * u_persistence);
+    }
+    gl_FragColor = vec4(color, 1.0);
+}
+)";
+
+// CRT pass 2: the decoded frame onto the display rect. Curvature bends the
+// picture outwards from the centre (corners fall off to black); scanlines
+// darken each source row towards its edges.
+const char* kPresentFragmentShader = R"(
+#ifdef GL_ES
+precision mediump float;
+#endif
+uniform sampler2D u_image;
+uniform float u_sourceRows;
+uniform float u_scanlines;
+uniform float u_curvature;
+varying vec2 v_texCoord;
+
+void main()
+{
+    vec2 uv = v_texCoord;
+    if (u_curvature > 0.0) {
+        vec2 centered = uv * 2.0 - 1.0;
+        centered *= 1.0 + u_curvature * 0.12 * dot(centered, centered);
+        uv = centered * 0.5 + 0.5;
+        if (uv.x < 0.0 || uv.x > 1.0 || uv.y < 0.0 || uv.y > 1.0) {
+            gl_FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+            return;
+        }
+    }
+    // Render targets store row 0 at the bottom
+    vec3 color = texture2D(u_image, vec2(uv.x, 1.0 - uv.y)).rgb;
+    float beam = sin(3.1415927 * fract(uv.y * u_sourceRows));
+    color *= 1.0 - u_scanlines * (1.0 - beam);
+    gl_FragColor = vec4(color, 1.0);
+}
+)";
+
+// Subcarrier phase of the first sample of a line, relative to the pixel grid;
+// picks which colours hi-res patterns decode to.
+constexpr float kArtifactPhase = 0.0f;
+
+// Full-viewport quad; texture row 0 (top scanline) maps to the top edge.
+const GLfloat kQuadPositions[] = { -1.0f, -1.0f,  1.0f, -1.0f,  -1.0f, 1.0f,  1.0f, 1.0f };
+const GLfloat kQuadTexCoords[] = {  0.0f,  1.0f,  1.0f,  1.0f,   0.0f, 0.0f,  1.0f, 0.0f };
+
+}  // namespace
+
+EmulatorGLView::EmulatorGLView(QWidget* parent)
+    : QOpenGLWidget(parent)
+{
+    // Input and drops are handled by EmulatorWidget underneath.
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setFocusPolicy(Qt::NoFocus);
+}
+
+EmulatorGLView::~EmulatorGLView()
+{
+    releaseGL();
+}
+
+void EmulatorGLView::setFrame(const QImage* indexedFrame)
+{
+    m_frame = indexedFrame;
+    m_frameDecoded = false;
+    update();
+}
+
+void EmulatorGLView::setVSync(bool enabled)
+{
+    QSurfaceFormat surfaceFormat = format();
+    surfaceFormat.setSwapInterval(enabled ? 1 : 0);
+    setFormat(surfaceFormat);
+}
+
+void EmulatorGLView::setDisplayRect(const QRect& rect)
+{
+    if (m_displayRect != rect) {
+        m_displayRect = rect;
+        update();
+    }
+}
+
+void EmulatorGLView::setSmoothScaling(bool smooth)
+{
+    if (m_smoothScaling != smooth) {
+        m_smoothScaling = smooth;
+        update();
+    }
+}
+
+void EmulatorGLView::setCrtEffects(const CrtEffects& effects)
+{
+    if (m_crtEffects != effects) {
+        m_crtEffects = effects;
+        m_frameDecoded = false;
+        update();
+    }
+}
+
+void EmulatorGLView::initializeGL()
+{
+    initializeOpenGLFunctions();
+
+    m_program = new QOpenGLShaderProgram(this);
+    if (!m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, kVertexShader) ||
+        !m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, kFragmentShader) ||
+        !m_program->link()) {
+        qWarning() << "GPU presentation: shader setup failed:" << m_program->log();
+        emit initializationFailed();
+        return;
+    }
+
+    // CRT effects are optional: without them the plain path keeps working
+    m_decodeProgram = new QOpenGLShaderProgram(this);
+    m_presentProgram = new QOpenGLShaderProgram(this);
+    if (!m_decodeProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, kVertexShader) ||
+        !m_decodeProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, kDecodeFragmentShader) ||
+        !m_decodeProgram->link() ||
+        !m_presentProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, kVertexShader) ||
+        !m_presentProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, kPresentFragmentShader) ||
+        !m_presentProgram->link()) {
+        qWarning() << "GPU presentation: CRT shaders unavailable:" << m_decodeProgram->log()
+                   << m_presentProgram->log();
+        delete m_decodeProgram;
+        delete m_presentProgram;
+        m_decodeProgram = nullptr;
+        m_presentProgram = nullptr;
+    }
+
+    glGenTextures(1, &m_indexTexture);
+    glBindTexture(GL_TEXTURE_2D, m_indexTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenTextures(1, &m_paletteTexture);
+    glBindTexture(GL_TEXTURE_2D, m_paletteTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    m_uploadedPalette.clear();
+    m_glReady = true;
+
+    // The context can be destroyed when the widget is re-parented (fullscreen toggle).
+    connect(context(), &QOpenGLContext::aboutToBeDestroyed, this, &EmulatorGLView::releaseGL,
+            Qt::UniqueConnection);
+}
+
+void EmulatorGLView::uploadPalette(const QVector<QRgb>& colors)
+{
+    // QRgb is 0xAARRGGBB as a native integer; GL_RGBA wants bytes in R,G,B,A order.
+    unsigned char rgba[256 * 4] = {};
+    const int count = qMin(colors.size(), 256);
+    for (int i = 0; i < count; ++i) {
+        rgba[i * 4 + 0] = static_cast<unsigned char>(qRed(colors[i]));
+        rgba[i * 4 + 1] = static_cast<unsigned char>(qGreen(colors[i]));
+        rgba[i * 4 + 2] = static_cast<unsigned char>(qBlue(colors[i]));
+        rgba[i * 4 + 3] = 0xFF;
+    }
+    glBindTexture(GL_TEXTURE_2D, m_paletteTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 256, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    m_uploadedPalette = colors;
+}
+
+void EmulatorGLView::paintGL()
+{
+    const qreal dpr = devicePixelRatioF();
+    glViewport(0, 0, static_cast<GLsizei>(width() * dpr), static_cast<GLsizei>(height() * dpr));
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    if (!m_glReady || !m_frame || m_frame->isNull() ||
+        m_frame->format() != QImage::Format_Indexed8 || m_displayRect.isEmpty()) {
+        return;
+    }
+
+    if (m_crtEffects.isEnabled() && m_decodeProgram) {
+        paintCrt();
+        return;
+    }
+
+    uploadFrame();
+    setViewportToDisplayRect();
+
+    m_program->bind();
+    m_program->setUniformValue("u_index", 0);
+    m_program->setUniformValue("u_palette", 1);
+    m_program->setUniformValue("u_sourceSize", QVector2D(m_frame->width(), m_frame->height()));
+    m_program->setUniformValue("u_smooth", m_smoothScaling ? 1.0f : 0.0f);
+    drawQuad(m_program);
+    m_program->release();
+
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void EmulatorGLView::uploadFrame()
+{
+    // Upload the palette only when the emulator rebuilt it (shared QVector data
+    // makes the common "unchanged" comparison a pointer check).
+    if (m_frame->colorTable() != m_uploadedPalette) {
+        uploadPalette(m_frame->colorTable());
+    }
+
+    const int w = m_frame->width();
+    const int h = m_frame->height();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_indexTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (m_frame->bytesPerLine() == w) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, w, h, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE,
+                     m_frame->constBits());
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, w, h, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, nullptr);
+        for (int y = 0; y < h; ++y) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, w, 1, GL_LUMINANCE, GL_UNSIGNED_BYTE,
+                            m_frame->constScanLine(y));
+        }
+    }
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, m_paletteTexture);
+}
+
+void EmulatorGLView::setViewportToDisplayRect()
+{
+    // GL's origin is bottom-left; the display rect is in top-left widget coordinates.
+    const qreal dpr = devicePixelRatioF();
+    const int vx = qRound(m_displayRect.x() * dpr);
+    const int vy = qRound((height() - m_displayRect.y() - m_displayRect.height()) * dpr);
+    glViewport(vx, vy, qRound(m_displayRect.width() * dpr), qRound(m_displayRect.height() * dpr));
+}
+
+void EmulatorGLView::drawQuad(QOpenGLShaderProgram* program)
+{
+    program->enableAttributeArray("a_position");
+    program->enableAttributeArray("a_texCoord");
+    program->setAttributeArray("a_position", kQuadPositions, 2);
+    program->setAttributeArray("a_texCoord", kQuadTexCoords, 2);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    program->disableAttributeArray("a_position");
+    program->disableAttributeArray("a_texCoord");
+}
+
+bool EmulatorGLView::ensureDecodeTargets(int width, int height)
+{
+    const QSize size(width, height);
+    if (m_decodeTargets[0] && m_decodeTargets[0]->size() == size) {
+        return true;
+    }
+    for (QOpenGLFramebufferObject*& target : m_decodeTargets) {
+        delete target;
+        target = new QOpenGLFramebufferObject(size);
+        if (!target->isValid()) {
+            qWarning() << "GPU presentation: cannot create CRT render target";
+            return false;
+        }
+        // Start black, so persistence has nothing to fade in from
+        target->bind();
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+    m_frameDecoded = false;
+    return true;
+}
+
+void EmulatorGLView::paintCrt()
+{
+    const int w = m_frame->width();
+    const int h = m_frame->height();
+    const int targetWidth = m_crtEffects.ntscComposite ? w * 2 : w;
+    if (!ensureDecodeTargets(targetWidth, h)) {
+        for (QOpenGLFramebufferObject*& target : m_decodeTargets) {
+            delete target;
+            target = nullptr;
+        }
+        delete m_decodeProgram;
+        m_decodeProgram = nullptr;  // plain path from the next paint on
+        update();
+        return;
+    }
+
+    // Decode only new frames: a repaint for a resize must not fade persistence again
+    if (!m_frameDecoded) {
+        uploadFrame();
+        const int previous = m_currentTarget;
+        m_currentTarget = 1 - m_currentTarget;
+        QOpenGLFramebufferObject* target = m_decodeTargets[m_currentTarget];
+        target->bind();
+        glViewport(0, 0, targetWidth, h);
+
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, m_decodeTargets[previous]->texture());
+        m_decodeProgram->bind();
+        m_decodeProgram->setUniformValue("u_index", 0);
+        m_decodeProgram->setUniformValue("u_palette", 1);
+        m_decodeProgram->setUniformValue("u_previous", 2);
+        m_decodeProgram->setUniformValue("u_sourceSize", QVector2D(w, h));
+        m_decodeProgram->setUniformValue("u_targetSize", QVector2D(targetWidth, h));
+        m_decodeProgram->setUniformValue("u_composite", m_crtEffects.ntscComposite ? 1.0f : 0.0f);
+        m_decodeProgram->setUniformValue("u_persistence", qBound(0.0f, m_crtEffects.persistence, 0.9f));
+        m_decodeProgram->setUniformValue("u_artifactPhase", kArtifactPhase);
+        drawQuad(m_decodeProgram);
+        m_decodeProgram->release();
+
+        glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+        m_frameDecoded = true;
+    }
+
+    setViewportToDisplayRect();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_decodeTargets[m_currentTarget]->texture());
+    const GLint filter = m_smoothScaling ? GL_LINEAR : GL_NEAREST;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+
+    m_presentProgram->bind();
+    m_presentProgram->setUniformValue("u_image", 0);
+    m_presentProgram->setUniformValue("u_sourceRows", static_cast<GLfloat>(h));
+    m_presentProgram->setUniformValue("u_scanlines", qBound(0.0f, m_crtEffects.scanlines, 1.0f));
+    m_presentProgram->setUniformValue("u_curvature", qBound(0.0f, m_crtEffects.curvature, 1.0f));
+    drawQuad(m_presentProgram);
+    m_presentProgram->release();
+}
+
+void EmulatorGLView::releaseGL()
+{
+    if (!m_glReady || !context()) {
+        return;
+    }
+    makeCurrent();
+    glDeleteTextures(1, &m_indexTexture);
+    glDeleteTextures(1, &m_paletteTexture);
+    m_indexTexture = 0;
+    m_paletteTexture = 0;
+    delete m_program;
+    m_program = nullptr;
+    for (QOpenGLFramebufferObject*& target : m_decodeTargets) {
+        delete target;
+        target = nullptr;
+    }
+    delete m_decodeProgram;
+    m_decodeProgram = nullptr;
+    delete m_presentProgram;
+    m_presentProgram = nullptr;
+    m_frameDecoded = false;
+    m_uploadedPalette.clear();
+    m_glReady = false;
+    doneCurrent();
+}
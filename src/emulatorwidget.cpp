@@ -6,6 +6,8 @@
  */
 
 #include "emulatorwidget.h"
+#include "emulatorglview.h"
+#include "performanceoverlay.h"
 #include <QPainter>
 #include <QPalette>
 #include <QDebug>
@@ -17,6 +19,12 @@
 #include <QDragMoveEvent>
 #include <QDragLeaveEvent>
 #include <QDropEvent>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QShowEvent>
+#include <QWindow>
+#include <climits>
+#include <cmath>
 
 extern "C" {
     extern int Colours_table[256];
@@ -25,12 +33,14 @@ extern "C" {
 EmulatorWidget::EmulatorWidget(QWidget *parent)
     : QWidget(parent)
     , m_emulator(nullptr)
+    , m_glView(nullptr)
     , m_screenImage(DISPLAY_WIDTH, DISPLAY_HEIGHT, QImage::Format_RGB32)
     , m_integerScaling(false)
     , m_scalingFilter(true)
     , m_fitScreen("both")
     , m_keepAspectRatio(true)
     , m_overscanFactor(DEFAULT_OVERSCAN_FACTOR)
+    , m_glSwapWatchdog(new QTimer(this))
 {
     setFocusPolicy(Qt::StrongFocus);
 
@@ -49,6 +59,13 @@ EmulatorWidget::EmulatorWidget(QWidget *parent)
 
     // Fill with black initially
     m_screenImage.fill(Qt::black);
+
+    m_glSwapWatchdog->setSingleShot(true);
+    m_glSwapWatchdog->setInterval(kGlSwapTimeoutMs);
+    connect(m_glSwapWatchdog, &QTimer::timeout, this, [this]() {
+        m_glSwapPending = false;
+        presentNextGlFrame();
+    });
 }
 
 void EmulatorWidget::setEmulator(AtariEmulator* emulator)
@@ -56,7 +73,124 @@ void EmulatorWidget::setEmulator(AtariEmulator* emulator)
     m_emulator = emulator;
     if (m_emulator) {
         connect(m_emulator, &AtariEmulator::frameReady, this, &EmulatorWidget::updateDisplay);
+        m_emulator->setIndexedFrameOutput(m_glView != nullptr);
+        updateRefreshLock();
+    }
+}
+
+void EmulatorWidget::setGpuPresentation(bool enabled)
+{
+    if (enabled == (m_glView != nullptr)) {
+        return;
+    }
+
+    if (enabled) {
+        m_glView = new EmulatorGLView(this);
+        m_glView->setVSync(m_vSync);
+        connect(m_glView, &EmulatorGLView::initializationFailed, this, [this]() {
+            qWarning() << "GPU presentation unavailable, falling back to QPainter";
+            // Deferred: the view is still inside its initializeGL() call.
+            QMetaObject::invokeMethod(this, [this]() { setGpuPresentation(false); }, Qt::QueuedConnection);
+        });
+        connect(m_glView, &QOpenGLWidget::frameSwapped, this, [this]() {
+            if (m_emulator) {
+                m_emulator->inputLatency().framePresented(m_emulator->indexedFrameExchange()->frontSequence());
+                recordPresentLatency(m_emulator->indexedFrameExchange());
+            }
+            m_glSwapPending = false;
+            m_glSwapWatchdog->stop();
+            if (m_vSync) {
+                presentNextGlFrame();
+            }
+        });
+        updateGlViewGeometry();
+        applyCrtEffects();
+        m_glView->show();
+        if (m_performanceOverlay) {
+            m_performanceOverlay->raise();
+        }
+    } else {
+        delete m_glView;
+        m_glView = nullptr;
+        m_glSwapPending = false;
+        m_glSwapWatchdog->stop();
+    }
+
+    if (m_emulator) {
+        m_emulator->setIndexedFrameOutput(enabled);
+    }
+    update();
+}
+
+void EmulatorWidget::setVSync(bool enabled)
+{
+    if (enabled != m_vSync) {
+        m_vSync = enabled;
+        if (m_glView) {
+            // The swap interval is fixed when the GL context is created
+            setGpuPresentation(false);
+            setGpuPresentation(true);
+        }
+    }
+    updateRefreshLock();
+}
+
+void EmulatorWidget::updateRefreshLock()
+{
+    if (!m_emulator) {
+        return;
+    }
+    QWindow* topLevel = window()->windowHandle();
+    if (topLevel && !m_screenChangeConnected) {
+        // Moving the window to another monitor changes the rate to lock to
+        connect(topLevel, &QWindow::screenChanged, this, [this]() { updateRefreshLock(); });
+        m_screenChangeConnected = true;
+    }
+    QScreen* display = topLevel && topLevel->screen() ? topLevel->screen() : QGuiApplication::primaryScreen();
+    const double refreshHz = m_vSync && display ? display->refreshRate() : 0.0;
+    QMetaObject::invokeMethod(m_emulator, "setDisplayRefreshLock", Qt::QueuedConnection,
+                              Q_ARG(double, refreshHz));
+}
+
+void EmulatorWidget::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    if (!m_screenChangeConnected) {
+        updateRefreshLock();
+    }
+}
+
+void EmulatorWidget::updateGlViewGeometry()
+{
+    if (!m_glView) {
+        return;
     }
+    m_glView->setGeometry(rect());
+    m_glView->setDisplayRect(calculateDisplayRect());
+    m_glView->setSmoothScaling(m_scalingFilter && !m_integerScaling);
+}
+
+void EmulatorWidget::setCrtEffects(bool ntscComposite, int scanlinesPercent, int persistencePercent,
+                                   int curvaturePercent)
+{
+    m_ntscComposite = ntscComposite;
+    m_scanlinesPercent = qBound(0, scanlinesPercent, 100);
+    m_persistencePercent = qBound(0, persistencePercent, 90);
+    m_curvaturePercent = qBound(0, curvaturePercent, 100);
+    applyCrtEffects();
+}
+
+void EmulatorWidget::applyCrtEffects()
+{
+    if (!m_glView) {
+        return;
+    }
+    EmulatorGLView::CrtEffects effects;
+    effects.ntscComposite = m_ntscComposite;
+    effects.scanlines = m_scanlinesPercent / 100.0f;
+    effects.persistence = m_persistencePercent / 100.0f;
+    effects.curvature = m_curvaturePercent / 100.0f;
+    m_glView->setCrtEffects(effects);
 }
 
 void EmulatorWidget::setScalingSettings(bool integerScaling, bool scalingFilter, const QString& fitScreen, bool keepAspectRatio, double overscanFactor)
@@ -71,6 +205,7 @@ void EmulatorWidget::setScalingSettings(bool integerScaling, bool scalingFilter,
     } else if (m_overscanFactor > MAX_OVERSCAN_FACTOR) {
         m_overscanFactor = MAX_OVERSCAN_FACTOR;
     }
+    updateGlViewGeometry();
     update(); // Trigger repaint with new settings
 }
 
@@ -82,6 +217,9 @@ void EmulatorWidget::paintEvent(QPaintEvent *event)
     
     // Fill widget background with black (overscan area)
     painter.fillRect(rect(), Qt::black);
+    if (m_glView) {
+        return;  // EmulatorGLView covers the widget and draws the frame itself
+    }
 
     // Calculate authentic Atari display area with proper aspect ratio
     QRect targetRect = calculateDisplayRect();
@@ -90,13 +228,82 @@ void EmulatorWidget::paintEvent(QPaintEvent *event)
     // Integer scaling always uses nearest-neighbor for pixel-perfect display
     bool useSmoothScaling = m_scalingFilter && !m_integerScaling;
     painter.setRenderHint(QPainter::SmoothPixmapTransform, useSmoothScaling);
-    painter.drawImage(targetRect, m_screenImage);
+    const QImage& frame = m_emulator ? m_emulator->frameExchange()->frontBuffer() : m_screenImage;
+    painter.drawImage(targetRect, frame);
+    if (m_emulator) {
+        m_emulator->inputLatency().framePresented(m_emulator->frameExchange()->frontSequence());
+        recordPresentLatency(m_emulator->frameExchange());
+    }
 }
 
-void EmulatorWidget::updateDisplay(const QImage& image)
+void EmulatorWidget::recordPresentLatency(const FrameExchange* exchange)
 {
-    m_screenImage = image;
-    update();
+    PerformanceMonitor& monitor = m_emulator->performance();
+    // Repaints of a frame already shown (expose, resize) are not a new present
+    if (!monitor.isEnabled() || exchange->frontSequence() == m_lastMeasuredSequence) {
+        return;
+    }
+    m_lastMeasuredSequence = exchange->frontSequence();
+    const qint64 latencyUs = LatencyHistogram::nowMicroseconds() - exchange->frontPublishTimeUs();
+    monitor.record(PerformanceMonitor::PresentLatency, static_cast<qint32>(qBound<qint64>(0, latencyUs, INT_MAX)));
+}
+
+void EmulatorWidget::setPerformanceOverlay(bool enabled)
+{
+    if (enabled == (m_performanceOverlay != nullptr)) {
+        return;
+    }
+    if (enabled && m_emulator) {
+        m_performanceOverlay = new PerformanceOverlay(&m_emulator->performance(), this);
+        m_performanceOverlay->move(8, 8);
+        m_performanceOverlay->show();
+        m_performanceOverlay->raise();  // above the GL view when there is one
+    } else {
+        delete m_performanceOverlay;
+        m_performanceOverlay = nullptr;
+    }
+}
+
+void EmulatorWidget::updateDisplay()
+{
+    // Take the newest completed frame; frames published while we were busy were
+    // already superseded inside the exchange and are never painted.
+    if (!m_emulator) {
+        return;
+    }
+    if (m_glView) {
+        // With v-sync, a frame still waiting for its swap means the swap presents
+        // whatever is newest by then
+        if (!(m_vSync && m_glSwapPending)) {
+            presentNextGlFrame();
+        }
+    } else if (m_emulator->frameExchange()->acquire()) {
+        update(frameToWidgetRect(m_emulator->frameExchange()->frontDirtyRect()));
+    }
+}
+
+void EmulatorWidget::presentNextGlFrame()
+{
+    FrameExchange* exchange = m_emulator ? m_emulator->indexedFrameExchange() : nullptr;
+    if (!m_glView || !exchange || !exchange->acquire()) {
+        return;
+    }
+    m_glView->setFrame(&exchange->frontBuffer());
+    if (m_vSync) {
+        m_glSwapPending = true;
+        m_glSwapWatchdog->start();
+    }
+}
+
+QRect EmulatorWidget::frameToWidgetRect(const QRect& frameRect) const
+{
+    // Only rows ever change alone, so the band spans the full display width. One
+    // extra widget pixel on each side covers the neighbours smooth scaling blends in.
+    const QRect target = calculateDisplayRect();
+    const double scale = double(target.height()) / DISPLAY_HEIGHT;
+    const int top = target.top() + int(std::floor(frameRect.top() * scale)) - 1;
+    const int bottom = target.top() + int(std::ceil((frameRect.bottom() + 1) * scale)) + 1;
+    return QRect(target.left(), top, target.width(), bottom - top).intersected(rect());
 }
 
 bool EmulatorWidget::event(QEvent *event)
@@ -136,6 +343,7 @@ void EmulatorWidget::keyReleaseEvent(QKeyEvent *event)
 void EmulatorWidget::resizeEvent(QResizeEvent *event)
 {
     QWidget::resizeEvent(event);
+    updateGlViewGeometry();
     repaint();
 }
 
@@ -22,11 +22,18 @@
 #include <QMainWindow>
 #include <QLabel>
 #include <QTimer>
+#include <QThread>
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QDebug>
 #include <functional>
 
 static const char* KEY_FOLDER = "fastbasic/buildPanelFolder";
 static const char* KEY_FILE = "fastbasic/buildPanelFile";
+static const char* KEY_WATCH = "fastbasic/buildPanelWatch";
+static const int kRebuildDebounceMs = 300;
 
 namespace {
 
@@ -70,6 +77,8 @@ FastbasicBuildPanel::FastbasicBuildPanel(MainWindow* mainWindow, QWidget* parent
     m_pathLabel->setTextInteractionFlags(Qt::NoTextInteraction);
     m_runButton = new QPushButton(tr("RUN"), this);
     m_showOutputButton = new QPushButton(tr("Show Output"), this);
+    m_watchCheck = new QCheckBox(tr("Rebuild on save"), this);
+    m_watchCheck->setToolTip(tr("Rebuild and reload whenever the selected .bas file is saved"));
 
     QHBoxLayout* layout = new QHBoxLayout(this);
     layout->setContentsMargins(6, 4, 14, 4);  // extra right margin so last button isn't flush to border
@@ -79,6 +88,7 @@ FastbasicBuildPanel::FastbasicBuildPanel(MainWindow* mainWindow, QWidget* parent
     layout->addWidget(m_browseButton);
     layout->addWidget(m_pathLabel);
     layout->addStretch(1);
+    layout->addWidget(m_watchCheck);
     layout->addWidget(m_runButton);
     layout->addSpacing(16);  // space between Run and Show Output
     layout->addWidget(m_showOutputButton);
@@ -87,9 +97,20 @@ FastbasicBuildPanel::FastbasicBuildPanel(MainWindow* mainWindow, QWidget* parent
             this, &FastbasicBuildPanel::onProcessFinished);
     connect(m_process, &QProcess::errorOccurred, this, &FastbasicBuildPanel::onProcessError);
 
+    m_watcher = new QFileSystemWatcher(this);
+    m_rebuildTimer = new QTimer(this);
+    m_rebuildTimer->setSingleShot(true);
+    m_rebuildTimer->setInterval(kRebuildDebounceMs);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, m_rebuildTimer, QOverload<>::of(&QTimer::start));
+    connect(m_rebuildTimer, &QTimer::timeout, this, &FastbasicBuildPanel::onSourceChanged);
+    connect(m_watchCheck, &QCheckBox::toggled, this, &FastbasicBuildPanel::onWatchToggled);
+
     connect(m_browseButton, &QPushButton::clicked, this, &FastbasicBuildPanel::onBrowseFolder);
     connect(m_fileCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &FastbasicBuildPanel::onFileSelected);
-    connect(m_runButton, &QPushButton::clicked, this, &FastbasicBuildPanel::onRun);
+    connect(m_runButton, &QPushButton::clicked, this, [this]() {
+        m_autoBuild = false;
+        onRun();
+    });
     connect(m_showOutputButton, &QPushButton::clicked, this, &FastbasicBuildPanel::onShowOutput);
 
     setMaximumHeight(40);
@@ -152,6 +173,7 @@ void FastbasicBuildPanel::loadPersistedState()
             m_fileCombo->setCurrentIndex(idx);
     }
     updatePathLabel();
+    m_watchCheck->setChecked(settings.value(KEY_WATCH, false).toBool());
 }
 
 void FastbasicBuildPanel::saveFolderAndFile()
@@ -204,45 +226,110 @@ void FastbasicBuildPanel::onFileSelected(int index)
 {
     if (index >= 0 && index < m_fileCombo->count())
         persistFile(m_fileCombo->itemText(index));
+    updateWatchedFile();
+}
+
+void FastbasicBuildPanel::onWatchToggled(bool enabled)
+{
+    QSettings settings("8bitrelics", "Fujisan");
+    settings.setValue(KEY_WATCH, enabled);
+    updateWatchedFile();
+}
+
+void FastbasicBuildPanel::updateWatchedFile()
+{
+    if (!m_watcher->files().isEmpty())
+        m_watcher->removePaths(m_watcher->files());
+    if (!m_watchCheck->isChecked() || m_currentFolder.isEmpty() || m_fileCombo->currentIndex() < 0)
+        return;
+    const QString basPath = m_currentFolder + "/" + m_fileCombo->currentText();
+    if (QFile::exists(basPath))
+        m_watcher->addPath(basPath);
+}
+
+void FastbasicBuildPanel::onSourceChanged()
+{
+    // Editors that save by replacing the file drop it from the watcher
+    updateWatchedFile();
+    if (!m_watchCheck->isChecked())
+        return;
+    if (m_process->state() != QProcess::NotRunning) {
+        m_rebuildTimer->start();  // try again once this build is done
+        return;
+    }
+    m_autoBuild = true;
+    onRun();
 }
 
 void FastbasicBuildPanel::onRun()
 {
     QString compiler = resolveCompilerPath();
     if (compiler.isEmpty() || !QFile::exists(compiler)) {
+        if (m_autoBuild) {
+            reportBuildFailure(tr("Compiler not found"));
+            return;
+        }
         QMessageBox::warning(this, tr("Fastbasic"),
             tr("Compiler not found. Set path in Settings → Emulator → Fastbasic, or use bundled Fastbasic."));
         return;
     }
     if (m_currentFolder.isEmpty() || m_fileCombo->currentIndex() < 0) {
-        QMessageBox::warning(this, tr("Fastbasic"), tr("Select a folder and a .bas file first."));
+        if (!m_autoBuild)
+            QMessageBox::warning(this, tr("Fastbasic"), tr("Select a folder and a .bas file first."));
         return;
     }
 
     QString fileName = m_fileCombo->currentText();
     QString basPath = m_currentFolder + "/" + fileName;
     if (!QFile::exists(basPath)) {
-        QMessageBox::warning(this, tr("Fastbasic"), tr("File not found: %1").arg(basPath));
+        if (!m_autoBuild)
+            QMessageBox::warning(this, tr("Fastbasic"), tr("File not found: %1").arg(basPath));
         return;
     }
 
-    m_runButton->setEnabled(false);
-    m_lastOutput.clear();
-    m_process->setWorkingDirectory(m_currentFolder);
-    m_process->start(compiler, QStringList() << basPath);
-    if (!m_process->waitForStarted(5000)) {
-        m_lastOutput = tr("Failed to start compiler: %1").arg(m_process->errorString());
-        if (m_mainWindow && m_mainWindow->statusBar())
-            m_mainWindow->statusBar()->showMessage(tr("Compile failed"), 5000);
-        showOutputDialog();
-        m_runButton->setEnabled(true);
+    // Same source, same compiler: the last build is still good
+    const QByteArray key = buildKey(basPath, compiler);
+    const auto cached = m_artifacts.constFind(basPath);
+    if (!key.isEmpty() && cached != m_artifacts.constEnd() && cached->key == key) {
+        m_lastOutput = tr("%1 is unchanged since the last build.\n").arg(fileName);
+        deployXex(cached->xex, QFileInfo(fileName).completeBaseName());
         return;
     }
+    m_buildSource = basPath;
+    m_buildKey = key;
+
+    m_runButton->setEnabled(false);
     m_lastOutput = tr("Compiling %1...\n").arg(fileName);
+    m_process->setWorkingDirectory(m_currentFolder);
+    // A compiler that fails to start reports it through errorOccurred()
+    m_process->start(compiler, QStringList() << basPath);
     if (m_mainWindow && m_mainWindow->statusBar())
         m_mainWindow->statusBar()->showMessage(tr("Compiling %1...").arg(fileName), 0);
 }
 
+QByteArray FastbasicBuildPanel::buildKey(const QString& basPath, const QString& compiler) const
+{
+    QFile source(basPath);
+    if (!source.open(QIODevice::ReadOnly))
+        return QByteArray();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&source);
+    // A different or updated compiler may build the same source differently
+    const QFileInfo compilerInfo(compiler);
+    hash.addData(compilerInfo.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(compilerInfo.lastModified().toMSecsSinceEpoch()));
+    return hash.result();
+}
+
+void FastbasicBuildPanel::reportBuildFailure(const QString& status)
+{
+    if (m_mainWindow && m_mainWindow->statusBar())
+        m_mainWindow->statusBar()->showMessage(status, 5000);
+    // A rebuild on save should not pop a dialog over the editor
+    if (!m_autoBuild)
+        showOutputDialog();
+}
+
 void FastbasicBuildPanel::onProcessFinished(int exitCode, QProcess::ExitStatus status)
 {
     m_runButton->setEnabled(true);
@@ -252,31 +339,36 @@ void FastbasicBuildPanel::onProcessFinished(int exitCode, QProcess::ExitStatus s
     if (!err.isEmpty())
         m_lastOutput += QString::fromUtf8(err);
 
-    QString fileName = m_fileCombo->currentText();
-    QFileInfo fi(fileName);
+    QFileInfo fi(m_buildSource);
     QString stem = fi.completeBaseName();
-    QString xexInSource = m_currentFolder + "/" + stem + ".xex";
-    QString binDir = m_currentFolder + "/bin";
-    QString xexInBin = binDir + "/" + stem + ".xex";
+    QString xexInSource = fi.path() + "/" + stem + ".xex";
 
     if (status != QProcess::NormalExit || exitCode != 0) {
-        if (m_mainWindow && m_mainWindow->statusBar())
-            m_mainWindow->statusBar()->showMessage(tr("Compile failed"), 5000);
-        showOutputDialog();
+        reportBuildFailure(tr("Compile failed"));
         return;
     }
-    if (!QFile::exists(xexInSource)) {
-        if (m_mainWindow && m_mainWindow->statusBar())
-            m_mainWindow->statusBar()->showMessage(tr("No .xex produced"), 5000);
+    QFile xexFile(xexInSource);
+    if (!xexFile.open(QIODevice::ReadOnly)) {
         m_lastOutput += tr("\nCompiler did not produce %1.xex\n").arg(stem);
-        showOutputDialog();
+        reportBuildFailure(tr("No .xex produced"));
         return;
     }
+    const QByteArray xex = xexFile.readAll();
+    if (!m_buildKey.isEmpty())
+        m_artifacts.insert(m_buildSource, Artifact{m_buildKey, xex});
+    deployXex(xex, stem);
+}
 
+void FastbasicBuildPanel::deployXex(const QByteArray& xex, const QString& stem)
+{
+    // bin/ is what H4: points at, and what BINLOAD reads if it has to
+    QString binDir = m_currentFolder + "/bin";
+    QString xexInBin = binDir + "/" + stem + ".xex";
     QDir().mkpath(binDir);
-    if (QFile::exists(xexInBin))
-        QFile::remove(xexInBin);
-    QFile::copy(xexInSource, xexInBin);
+    QFile binFile(xexInBin);
+    if (binFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        binFile.write(xex);
+    binFile.close();
 
     if (!m_mainWindow || !m_mainWindow->getEmulator()) {
         if (m_mainWindow && m_mainWindow->statusBar())
@@ -284,12 +376,29 @@ void FastbasicBuildPanel::onProcessFinished(int exitCode, QProcess::ExitStatus s
         return;
     }
 
-    // Deploy: set H4 (triggers restartEmulator), settle, then load XEX.
-    // When NetSIO is enabled, do FujiNet stop→start so network is ready.
+    // Deploy: set H4 (hot-swapped, no restart), then load XEX.
     if (m_mainWindow->statusBar())
         m_mainWindow->statusBar()->showMessage(tr("Setting H4:..."), 0);
     m_mainWindow->setHardDrivePathViaTCP(4, binDir);
 
+    // Write the program straight into RAM while the machine keeps running, so
+    // FujiNet stays connected and there is nothing to wait for
+    AtariEmulator* emulator = m_mainWindow->getEmulator();
+    bool fastLoaded = false;
+    QString fastLoadError;
+    QMetaObject::invokeMethod(emulator, [emulator, &xex, &fastLoaded, &fastLoadError]() {
+        fastLoaded = emulator->fastLoadXex(xex, &fastLoadError);
+    }, emulator->thread() == QThread::currentThread() ? Qt::DirectConnection
+                                                      : Qt::BlockingQueuedConnection);
+    if (fastLoaded) {
+        if (m_mainWindow->statusBar())
+            m_mainWindow->statusBar()->showMessage(tr("XEX loaded."), 3000);
+        return;
+    }
+    qDebug() << "Fastbasic: direct load not possible, using BINLOAD:" << fastLoadError;
+
+    // BINLOAD coldstarts: settle first, and with NetSIO do FujiNet stop→start
+    // so the network is ready.
     QSettings settings("8bitrelics", "Fujisan");
     bool netSIOEnabled = settings.value("media/netSIOEnabled", false).toBool();
 
@@ -329,9 +438,7 @@ void FastbasicBuildPanel::onProcessError(QProcess::ProcessError error)
 {
     m_runButton->setEnabled(true);
     m_lastOutput += tr("Process error: %1").arg(m_process->errorString());
-    if (m_mainWindow && m_mainWindow->statusBar())
-        m_mainWindow->statusBar()->showMessage(tr("Compile error"), 5000);
-    showOutputDialog();
+    reportBuildFailure(tr("Compile error"));
     (void)error;
 }
 
@@ -0,0 +1,204 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "framechecksumstream.h"
+
+#include <QtEndian>
+#include <cstdio>
+
+namespace {
+
+constexpr quint64 kPrime1 = 11400714785074694791ull;
+constexpr quint64 kPrime2 = 14029467366897019727ull;
+constexpr quint64 kPrime3 = 1609587929392839161ull;
+constexpr quint64 kPrime4 = 9650029242287828579ull;
+constexpr quint64 kPrime5 = 2870177450012600261ull;
+
+// Lines are written in batches of about this many bytes
+constexpr int kFileFlushBytes = 64 * 1024;
+
+inline quint64 rotl(quint64 value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline quint64 read64(const uchar* p)
+{
+    return qFromLittleEndian<quint64>(p);
+}
+
+inline quint64 read32(const uchar* p)
+{
+    return qFromLittleEndian<quint32>(p);
+}
+
+inline quint64 round64(quint64 acc, quint64 input)
+{
+    acc += input * kPrime2;
+    acc = rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+inline quint64 mergeRound(quint64 acc, quint64 lane)
+{
+    acc ^= round64(0, lane);
+    return acc * kPrime1 + kPrime4;
+}
+
+}  // namespace
+
+FrameChecksumStream::~FrameChecksumStream()
+{
+    stop();
+}
+
+bool FrameChecksumStream::start(int capacity, const QString& path, QString* error)
+{
+    stop();
+    m_ring.fill(Entry(), qBound(1, capacity, kMaxCapacity));
+    m_head = 0;
+    m_size = 0;
+    m_added = 0;
+    m_path = path;
+    if (!path.isEmpty()) {
+        m_file.setFileName(path);
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            if (error) {
+                *error = QString("Cannot create checksum file: %1").arg(m_file.errorString());
+            }
+            m_path.clear();
+            return false;
+        }
+    }
+    m_active = true;
+    return true;
+}
+
+void FrameChecksumStream::stop()
+{
+    if (m_file.isOpen()) {
+        flushFile();
+        m_file.close();
+    }
+    m_active = false;
+}
+
+void FrameChecksumStream::add(quint64 frame, const void* ram, int ramSize, const void* screen, int screenSize)
+{
+    if (!m_active) {
+        return;
+    }
+    Entry& entry = m_ring[m_head];
+    entry.sequence = m_added++;
+    entry.frame = frame;
+    entry.ram = hash(ram, ramSize);
+    entry.screen = screen ? hash(screen, screenSize) : 0;
+    m_head = (m_head + 1) % m_ring.size();
+    m_size = qMin(m_size + 1, m_ring.size());
+
+    if (m_file.isOpen()) {
+        m_pending.append(formatLine(entry));
+        if (m_pending.size() >= kFileFlushBytes) {
+            flushFile();
+        }
+    }
+}
+
+QVector<FrameChecksumStream::Entry> FrameChecksumStream::read(quint64 cursor, int max, quint64* dropped) const
+{
+    const quint64 oldest = m_added - quint64(m_size);
+    if (dropped) {
+        *dropped = cursor < oldest ? oldest - cursor : 0;
+    }
+    QVector<Entry> entries;
+    if (cursor >= m_added || max <= 0) {
+        return entries;
+    }
+    const quint64 first = qMax(cursor, oldest);
+    const int count = int(qMin<quint64>(m_added - first, quint64(max)));
+    entries.reserve(count);
+    const int capacity = m_ring.size();
+    int slot = int((m_head + capacity - int(m_added - first)) % capacity);
+    for (int i = 0; i < count; ++i) {
+        entries.append(m_ring[slot]);
+        slot = (slot + 1) % capacity;
+    }
+    return entries;
+}
+
+quint64 FrameChecksumStream::hash(const void* data, int size, quint64 seed)
+{
+    const uchar* p = static_cast<const uchar*>(data);
+    const uchar* const end = p + size;
+    quint64 h;
+
+    if (size >= 32) {
+        // Four independent accumulators, so the compiler can keep them in flight together
+        quint64 v1 = seed + kPrime1 + kPrime2;
+        quint64 v2 = seed + kPrime2;
+        quint64 v3 = seed;
+        quint64 v4 = seed - kPrime1;
+        const uchar* const limit = end - 32;
+        do {
+            v1 = round64(v1, read64(p));
+            v2 = round64(v2, read64(p + 8));
+            v3 = round64(v3, read64(p + 16));
+            v4 = round64(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    } else {
+        h = seed + kPrime5;
+    }
+    h += quint64(size);
+
+    while (p + 8 <= end) {
+        h ^= round64(0, read64(p));
+        h = rotl(h, 27) * kPrime1 + kPrime4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= read32(p) * kPrime1;
+        h = rotl(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= *p * kPrime5;
+        h = rotl(h, 11) * kPrime1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+QByteArray FrameChecksumStream::formatLine(const Entry& entry)
+{
+    char line[64];
+    const int length = std::snprintf(line, sizeof(line), "%llu %016llx %016llx\n",
+                                     static_cast<unsigned long long>(entry.frame),
+                                     static_cast<unsigned long long>(entry.ram),
+                                     static_cast<unsigned long long>(entry.screen));
+    return QByteArray(line, length);
+}
+
+void FrameChecksumStream::flushFile()
+{
+    if (!m_pending.isEmpty()) {
+        m_file.write(m_pending);
+        m_pending.clear();
+    }
+    m_file.flush();
+}
@@ -0,0 +1,65 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "frameexchange.h"
+
+#include <chrono>
+
+FrameExchange::FrameExchange(int width, int height, QImage::Format format)
+    : m_back(0)
+    , m_front(1)
+    , m_middle(2)
+{
+    for (QImage& buffer : m_buffers) {
+        buffer = QImage(width, height, format);
+        if (format == QImage::Format_Indexed8) {
+            buffer.fill(0u);  // palette index 0 (black) until the first frame lands
+        } else {
+            buffer.fill(Qt::black);
+        }
+    }
+    for (QRect& rect : m_dirtyRects) {
+        rect = m_buffers[0].rect();
+    }
+}
+
+bool FrameExchange::publish(quint64 sequence, const QRect& dirty)
+{
+    const QRect bounds = m_buffers[m_back].rect();
+    QRect area = dirty.isNull() ? bounds : dirty & bounds;
+    // The consumer will skip the unseen frame, so its changes must be repainted
+    // with this one. If it is acquired right after this check the union only
+    // repaints a little more than needed.
+    if (m_middle.load(std::memory_order_acquire) & kFreshBit) {
+        area |= m_lastPublishedDirty;
+    }
+    m_lastPublishedDirty = area;
+    m_sequences[m_back] = sequence;
+    m_dirtyRects[m_back] = area;
+    m_publishTimesUs[m_back] = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    // Release: the consumer must see the finished pixels once it sees the index.
+    const int previous = m_middle.exchange(m_back | kFreshBit, std::memory_order_acq_rel);
+    m_back = previous & kIndexMask;
+    m_publishedFrames.fetch_add(1, std::memory_order_relaxed);
+
+    if (previous & kFreshBit) {
+        m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool FrameExchange::acquire()
+{
+    if (!(m_middle.load(std::memory_order_acquire) & kFreshBit)) {
+        return false;
+    }
+    const int previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+    m_front = previous & kIndexMask;
+    return true;
+}
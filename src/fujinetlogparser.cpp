@@ -0,0 +1,201 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "fujinetlogparser.h"
+
+#include <cstring>
+
+FujiNetLogParser::FujiNetLogParser()
+    : m_commandFrame(QByteArrayLiteral("CF:"))
+    , m_atrRead(QByteArrayLiteral("ATR READ"))
+    , m_atrWrite(QByteArrayLiteral("ATR WRITE"))
+    , m_atxRead(QByteArrayLiteral("ATX READ"))
+    , m_xexRead(QByteArrayLiteral("XEX READ"))
+    , m_complete(QByteArrayLiteral("COMPLETE"))
+{
+}
+
+void FujiNetLogParser::setFilter(const QString& filter, bool useRegex)
+{
+    m_filter = filter.toUtf8();
+    m_useRegex = useRegex && !filter.isEmpty();
+    m_regex = m_useRegex ? QRegularExpression(filter) : QRegularExpression();
+    if (m_useRegex) {
+        m_regex.optimize();
+    }
+}
+
+bool FujiNetLogParser::acceptsLine(const QByteArray& line) const
+{
+    if (m_filter.isEmpty()) {
+        return true;
+    }
+    if (m_useRegex) {
+        // Invalid pattern: show lines (same as an empty filter)
+        return !m_regex.isValid() || m_regex.match(QString::fromUtf8(line)).hasMatch();
+    }
+    return line.contains(m_filter);
+}
+
+void FujiNetLogParser::feed(const QByteArray& chunk, qint64 nowMs, QVector<DriveEvent>& events,
+                            QVector<QByteArray>* logLines)
+{
+    const char* data = chunk.constData();
+    const int size = chunk.size();
+    int lineStart = 0;
+    int i = 0;
+    while (i < size) {
+        const char* next = static_cast<const char*>(std::memchr(data + i, '\n', size - i));
+        const char* escape = static_cast<const char*>(std::memchr(data + i, '\\', size - i));
+        const char* stop = next && (!escape || next < escape) ? next : escape;
+        if (!stop) {
+            break;
+        }
+        const int at = int(stop - data);
+        int skip = 0;
+        if (*stop == '\n') {
+            skip = 1;
+        } else if (at + 1 < size && data[at + 1] == 'n') {
+            skip = 2;  // literal "\n"
+        } else if (at + 3 < size && data[at + 1] == 'r' && data[at + 2] == '\\' && data[at + 3] == 'n') {
+            skip = 4;  // literal "\r\n"
+        }
+        if (skip == 0) {
+            i = at + 1;  // a backslash that is not a line break
+            continue;
+        }
+        if (m_partial.isEmpty()) {
+            processLine(QByteArray(data + lineStart, at - lineStart), nowMs, events, logLines);
+        } else {
+            m_partial.append(data + lineStart, at - lineStart);
+            processLine(m_partial, nowMs, events, logLines);
+            m_partial.clear();
+        }
+        i = lineStart = at + skip;
+    }
+
+    if (lineStart < size) {
+        m_partial.append(data + lineStart, size - lineStart);
+        if (m_partial.size() > kMaxLineBytes) {
+            flush(nowMs, events, logLines);
+        }
+    }
+}
+
+void FujiNetLogParser::flush(qint64 nowMs, QVector<DriveEvent>& events, QVector<QByteArray>* logLines)
+{
+    if (!m_partial.isEmpty()) {
+        processLine(m_partial, nowMs, events, logLines);
+        m_partial.clear();
+    }
+}
+
+void FujiNetLogParser::reset()
+{
+    m_partial.clear();
+    m_deviceId = -1;
+}
+
+void FujiNetLogParser::processLine(const QByteArray& rawLine, qint64 nowMs, QVector<DriveEvent>& events,
+                                   QVector<QByteArray>* logLines)
+{
+    const QByteArray line = rawLine.trimmed();
+    if (line.isEmpty()) {
+        return;
+    }
+    if (logLines && acceptsLine(line)) {
+        logLines->append(line);
+    }
+
+    // Step 1: device ID from the command frame
+    const int cfIndex = m_commandFrame.indexIn(line);
+    if (cfIndex >= 0) {
+        parseDeviceId(line, cfIndex, nowMs);
+        return;
+    }
+
+    // Step 2: operation on the drive named by the last command frame. FujiNet-PC
+    // logs disk I/O per image type (ATR / ATX / XEX), so all of them count.
+    if (m_deviceId != -1 && nowMs - m_deviceIdMs > kDeviceIdTimeoutMs) {
+        m_deviceId = -1;
+    }
+    if (m_deviceId != -1) {
+        const bool read = m_atrRead.indexIn(line) >= 0 || m_atxRead.indexIn(line) >= 0
+                          || m_xexRead.indexIn(line) >= 0;
+        const bool write = !read && m_atrWrite.indexIn(line) >= 0;
+        if (read || write) {
+            DriveEvent event;
+            event.type = DriveEvent::Start;
+            event.drive = m_deviceId - 0x30;
+            event.writing = write;
+            events.append(event);
+            m_deviceId = -1;
+            return;
+        }
+    }
+
+    // Step 3: completion
+    if (m_complete.indexIn(line) >= 0) {
+        DriveEvent event;
+        event.type = DriveEvent::Complete;
+        events.append(event);
+    }
+}
+
+void FujiNetLogParser::parseDeviceId(const QByteArray& line, int cfIndex, qint64 nowMs)
+{
+    // "CF: 31 52 6c 01 f0": the first byte is the SIO device, $31-$38 for D1-D8
+    const QByteArray afterCF = line.mid(cfIndex + 3).trimmed();
+    const int end = afterCF.indexOf(' ');
+    bool ok = false;
+    const int deviceId = afterCF.left(end).toInt(&ok, 16);
+    if (ok && deviceId >= 0x31 && deviceId <= 0x38) {
+        m_deviceId = deviceId;
+        m_deviceIdMs = nowMs;
+    }
+}
+
+LogTailBuffer::LogTailBuffer(int capacity)
+    : m_ring(qMax(1, capacity), '\0')
+{
+}
+
+void LogTailBuffer::append(const QByteArray& data)
+{
+    const int capacity = m_ring.size();
+    const char* src = data.constData();
+    int length = data.size();
+    if (length >= capacity) {
+        // Only the newest capacity bytes survive
+        src += length - capacity;
+        length = capacity;
+    }
+    char* ring = m_ring.data();
+    const int first = qMin(length, capacity - m_head);
+    std::memcpy(ring + m_head, src, first);
+    std::memcpy(ring, src + first, length - first);
+    m_head = (m_head + length) % capacity;
+    m_size = qMin(capacity, m_size + length);
+}
+
+QByteArray LogTailBuffer::toByteArray() const
+{
+    const int capacity = m_ring.size();
+    const int start = (m_head - m_size + capacity) % capacity;
+    const int first = qMin(m_size, capacity - start);
+    QByteArray out;
+    out.reserve(m_size);
+    out.append(m_ring.constData() + start, first);
+    out.append(m_ring.constData(), m_size - first);
+    return out;
+}
+
+void LogTailBuffer::clear()
+{
+    m_head = 0;
+    m_size = 0;
+}
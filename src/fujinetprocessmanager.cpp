@@ -12,8 +12,8 @@
 #include <QDir>
 #include <QThread>
 #include <QSettings>
+#include <QMetaMethod>
 #include <QProcessEnvironment>
-#include <QRegularExpression>
 #include <QtGlobal>
 
 namespace {
@@ -43,8 +43,13 @@ FujiNetProcessManager::FujiNetProcessManager(QObject *parent)
     , m_skipExternalCheck(false)
     , m_lastExitCode(0)
     , m_lastExitStatus(QProcess::NormalExit)
+    , m_stdoutTail(MAX_BUFFER_SIZE)
+    , m_stderrTail(MAX_BUFFER_SIZE)
     , m_startTimer(new QTimer(this))
 {
+    m_logClock.start();
+    reloadLogSettings();
+
     // Connect process signals
     connect(m_process, &QProcess::started, this, &FujiNetProcessManager::onProcessStarted);
     connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
@@ -71,6 +76,7 @@ bool FujiNetProcessManager::start(const QString& binaryPath, const QStringList&
         qWarning() << "FujiNet-PC is already running or starting";
         return false;
     }
+    reloadLogSettings();
 
     // Skip isProcessRunningExternally() after forceKill() — we just killed the process and are
     // restarting it, so there is no external instance; that check runs a nested event loop
@@ -284,8 +290,18 @@ void FujiNetProcessManager::forceKill()
 
 void FujiNetProcessManager::clearOutputBuffers()
 {
-    m_stdoutBuffer.clear();
-    m_stderrBuffer.clear();
+    m_stdoutTail.clear();
+    m_stderrTail.clear();
+}
+
+void FujiNetProcessManager::reloadLogSettings()
+{
+    QSettings settings("8bitrelics", "Fujisan");
+    m_hideFujiNetLogs = settings.value("log/hideFujiNetLogs", false).toBool();
+    const QString filterString = settings.value("log/filterString", "").toString();
+    const bool useRegex = settings.value("log/useRegex", false).toBool();
+    m_stdoutParser.setFilter(filterString, useRegex);
+    m_stderrParser.setFilter(filterString, useRegex);
 }
 
 bool FujiNetProcessManager::isProcessRunningExternally(const QString& processName)
@@ -340,6 +356,7 @@ void FujiNetProcessManager::onProcessStarted()
 void FujiNetProcessManager::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
     qDebug() << "FujiNet-PC exited with code:" << exitCode << "status:" << exitStatus;
+    flushOutputParsers();
 
     // Store exit code for auto-restart logic
     m_lastExitCode = exitCode;
@@ -372,75 +389,67 @@ void FujiNetProcessManager::onProcessError(QProcess::ProcessError error)
 
 void FujiNetProcessManager::onReadyReadStdout()
 {
-    QString output = m_process->readAllStandardOutput();
+    const QByteArray output = m_process->readAllStandardOutput();
     if (!output.isEmpty()) {
-        m_stdoutBuffer.append(output);
-
-        // Trim buffer if it gets too large
-        if (m_stdoutBuffer.size() > MAX_BUFFER_SIZE) {
-            m_stdoutBuffer = m_stdoutBuffer.right(MAX_BUFFER_SIZE / 2);
+        ingestOutput(output, false);
+        if (isSignalConnected(QMetaMethod::fromSignal(&FujiNetProcessManager::stdoutReceived))) {
+            emit stdoutReceived(QString::fromLocal8Bit(output));
         }
-
-        // Parse for LED activity (works regardless of log/hideFujiNetLogs setting)
-        parseFujiNetLogsForLEDActivity(output);
-
-        // Check if FujiNet-PC logs should be hidden
-        QSettings settings("8bitrelics", "Fujisan");
-        bool hideFujiNetLogs = settings.value("log/hideFujiNetLogs", false).toBool();
-
-        if (!hideFujiNetLogs) {
-            // Convert literal \r\n and \n to actual newlines for better formatting
-            QString formatted = output;
-            formatted.replace("\\r\\n", "\n").replace("\\n", "\n");
-
-            // Log each line separately for cleaner output
-            QStringList lines = formatted.split('\n', Qt::SkipEmptyParts);
-            for (const QString& line : lines) {
-                QString trimmed = line.trimmed();
-                if (!trimmed.isEmpty() && !shouldFilterLogMessage(trimmed)) {
-                    qDebug() << "[FUJINET]" << trimmed;
-                }
-            }
-        }
-
-        emit stdoutReceived(output);
     }
 }
 
 void FujiNetProcessManager::onReadyReadStderr()
 {
-    QString output = m_process->readAllStandardError();
+    const QByteArray output = m_process->readAllStandardError();
     if (!output.isEmpty()) {
-        m_stderrBuffer.append(output);
-
-        // Trim buffer if it gets too large
-        if (m_stderrBuffer.size() > MAX_BUFFER_SIZE) {
-            m_stderrBuffer = m_stderrBuffer.right(MAX_BUFFER_SIZE / 2);
-        }
-
         // Drive LED parsing (same patterns as stdout; some builds or hosts may log here)
-        parseFujiNetLogsForLEDActivity(output);
-
-        // Check if FujiNet-PC logs should be hidden
-        QSettings settings("8bitrelics", "Fujisan");
-        bool hideFujiNetLogs = settings.value("log/hideFujiNetLogs", false).toBool();
-
-        if (!hideFujiNetLogs) {
-            // Convert literal \r\n and \n to actual newlines for better formatting
-            QString formatted = output;
-            formatted.replace("\\r\\n", "\n").replace("\\n", "\n");
-
-            // Log each line separately for cleaner output
-            QStringList lines = formatted.split('\n', Qt::SkipEmptyParts);
-            for (const QString& line : lines) {
-                QString trimmed = line.trimmed();
-                if (!trimmed.isEmpty() && !shouldFilterLogMessage(trimmed)) {
-                    qWarning() << "[FUJINET ERROR]" << trimmed;
-                }
-            }
+        ingestOutput(output, true);
+        if (isSignalConnected(QMetaMethod::fromSignal(&FujiNetProcessManager::stderrReceived))) {
+            emit stderrReceived(QString::fromLocal8Bit(output));
         }
+    }
+}
+
+void FujiNetProcessManager::ingestOutput(const QByteArray& output, bool isStderr)
+{
+    (isStderr ? m_stderrTail : m_stdoutTail).append(output);
+
+    // LED activity is parsed regardless of log/hideFujiNetLogs; lines are only
+    // collected when they will be logged
+    m_driveEvents.clear();
+    m_logLines.clear();
+    FujiNetLogParser& parser = isStderr ? m_stderrParser : m_stdoutParser;
+    parser.feed(output, m_logClock.elapsed(), m_driveEvents, m_hideFujiNetLogs ? nullptr : &m_logLines);
+    dispatchLogResults(isStderr);
+}
 
-        emit stderrReceived(output);
+void FujiNetProcessManager::flushOutputParsers()
+{
+    for (bool isStderr : {false, true}) {
+        m_driveEvents.clear();
+        m_logLines.clear();
+        FujiNetLogParser& parser = isStderr ? m_stderrParser : m_stdoutParser;
+        parser.flush(m_logClock.elapsed(), m_driveEvents, m_hideFujiNetLogs ? nullptr : &m_logLines);
+        dispatchLogResults(isStderr);
+        parser.reset();
+    }
+}
+
+void FujiNetProcessManager::dispatchLogResults(bool isStderr)
+{
+    for (const FujiNetLogParser::DriveEvent& event : m_driveEvents) {
+        if (event.type == FujiNetLogParser::DriveEvent::Start) {
+            startDriveOperation(event.drive, event.writing);
+        } else {
+            completePendingOperation();
+        }
+    }
+    for (const QByteArray& line : m_logLines) {
+        if (isStderr) {
+            qWarning() << "[FUJINET ERROR]" << QString::fromUtf8(line);
+        } else {
+            qDebug() << "[FUJINET]" << QString::fromUtf8(line);
+        }
     }
 }
 
@@ -485,102 +494,6 @@ QString FujiNetProcessManager::processErrorToString(QProcess::ProcessError error
     }
 }
 
-bool FujiNetProcessManager::shouldFilterLogMessage(const QString& message)
-{
-    QSettings settings("8bitrelics", "Fujisan");
-
-    QString filterString = settings.value("log/filterString", "").toString();
-    if (filterString.isEmpty()) {
-        return false;  // No filter: show all lines
-    }
-
-    bool useRegex = settings.value("log/useRegex", false).toBool();
-
-    if (useRegex) {
-        QRegularExpression regex(filterString);
-        if (!regex.isValid()) {
-            return false;  // Invalid pattern: show lines (same as before)
-        }
-        // Include only lines that match the regex
-        return !regex.match(message).hasMatch();
-    }
-
-    // Include only lines that contain the substring (case-sensitive)
-    return !message.contains(filterString, Qt::CaseSensitive);
-}
-
-// FujiNet log parsing for LED activity
-void FujiNetProcessManager::parseFujiNetLogsForLEDActivity(const QString& output)
-{
-    // Split into lines and parse each one
-    QStringList lines = output.split('\n', Qt::SkipEmptyParts);
-    for (const QString& line : lines) {
-        QString trimmed = line.trimmed();
-        if (trimmed.isEmpty()) continue;
-
-        // Step 1: Device ID detection
-        if (trimmed.contains("CF:")) {
-            parseDeviceId(trimmed);
-            continue;
-        }
-
-        // Step 2: Operation detection (requires cached device ID)
-        if (m_lastDeviceId != -1) {
-            // FujiNet-PC logs disk I/O per image type (ATR / ATX / XEX). Fujisan must
-            // recognize all of them; only matching "ATR READ" misses common .atx/.xex use.
-            const bool atrRead = trimmed.contains(QLatin1String("ATR READ"));
-            const bool atrWrite = trimmed.contains(QLatin1String("ATR WRITE"));
-            const bool atxRead = trimmed.contains(QLatin1String("ATX READ"));
-            const bool xexRead = trimmed.contains(QLatin1String("XEX READ"));
-            if (atrRead || atxRead || xexRead) {
-                int drive = m_lastDeviceId - 0x30;
-                if (drive >= 1 && drive <= 8) {
-                    startDriveOperation(drive, false); // READ
-                    m_lastDeviceId = -1;
-                }
-                continue;
-            }
-            if (atrWrite) {
-                int drive = m_lastDeviceId - 0x30;
-                if (drive >= 1 && drive <= 8) {
-                    startDriveOperation(drive, true); // WRITE
-                    m_lastDeviceId = -1;
-                }
-                continue;
-            }
-        }
-
-        // Step 3: Completion detection
-        if (trimmed.contains("COMPLETE")) {
-            parseCompletion(trimmed);
-        }
-    }
-}
-
-void FujiNetProcessManager::parseDeviceId(const QString& line)
-{
-    // Extract from "CF: 31 52 6c 01 f0"
-    int cfIndex = line.indexOf("CF:");
-    if (cfIndex == -1) return;
-
-    QString afterCF = line.mid(cfIndex + 3).trimmed();
-    QStringList bytes = afterCF.split(' ', Qt::SkipEmptyParts);
-    if (bytes.isEmpty()) return;
-
-    bool ok;
-    int deviceId = bytes[0].toInt(&ok, 16);  // Parse hex
-    if (ok && deviceId >= 0x31 && deviceId <= 0x38) {
-        m_lastDeviceId = deviceId;
-
-        // 500ms timeout to clear stale device ID
-        QTimer::singleShot(500, this, [this, deviceId]() {
-            if (m_lastDeviceId == deviceId) {
-                m_lastDeviceId = -1;
-            }
-        });
-    }
-}
-
 void FujiNetProcessManager::startDriveOperation(int driveNumber, bool isWriting)
 {
     // Force-complete any pending operation on this drive
@@ -609,10 +522,8 @@ void FujiNetProcessManager::startDriveOperation(int driveNumber, bool isWriting)
     emit diskIOStart(driveNumber, isWriting);
 }
 
-void FujiNetProcessManager::parseCompletion(const QString& line)
+void FujiNetProcessManager::completePendingOperation()
 {
-    Q_UNUSED(line);
-
     // Find first pending operation (FujiNet is typically sequential)
     for (auto it = m_driveStates.begin(); it != m_driveStates.end(); ++it) {
         if (it.value().isPending) {
@@ -0,0 +1,130 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "fujinetrequestscheduler.h"
+
+FujiNetRequestScheduler::FujiNetRequestScheduler(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void FujiNetRequestScheduler::setMaxInFlight(int requests)
+{
+    m_maxInFlight = qMax(1, requests);
+    pump();
+}
+
+bool FujiNetRequestScheduler::enqueue(Priority priority, const QString& key, Starter start)
+{
+    if (!key.isEmpty()) {
+        const int user = findQueued(UserPriority, key);
+        const int background = findQueued(BackgroundPriority, key);
+        if (user >= 0 || background >= 0) {
+            if (priority == UserPriority && background >= 0) {
+                m_queues[UserPriority].append(m_queues[BackgroundPriority].takeAt(background));
+            }
+            m_coalesced++;
+            return false;
+        }
+    }
+    m_queues[priority].append(Job{key, std::move(start)});
+    pump();
+    return true;
+}
+
+bool FujiNetRequestScheduler::isPending(const QString& key) const
+{
+    return m_inFlightKeys.value(key) > 0 || findQueued(UserPriority, key) >= 0 ||
+           findQueued(BackgroundPriority, key) >= 0;
+}
+
+void FujiNetRequestScheduler::cancelQueued(Priority from)
+{
+    for (int priority = from; priority <= BackgroundPriority; ++priority) {
+        m_queues[priority].clear();
+    }
+}
+
+void FujiNetRequestScheduler::cancelAll()
+{
+    cancelQueued(UserPriority);
+    // Aborting emits finished(), which removes the entry
+    const QList<Running> running = m_inFlight;
+    for (const Running& entry : running) {
+        if (entry.reply) {
+            entry.reply->abort();
+        }
+    }
+    m_inFlight.clear();
+    m_inFlightKeys.clear();
+}
+
+int FujiNetRequestScheduler::findQueued(Priority priority, const QString& key) const
+{
+    const QList<Job>& queue = m_queues[priority];
+    for (int i = 0; i < queue.size(); ++i) {
+        if (queue[i].key == key) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void FujiNetRequestScheduler::pump()
+{
+    if (m_pumping) {
+        return;  // a Starter queued more work; the loop below picks it up
+    }
+    m_pumping = true;
+    // A reply deleted without finishing must not hold its slot forever
+    for (int i = m_inFlight.size() - 1; i >= 0; --i) {
+        if (!m_inFlight[i].reply) {
+            const QString key = m_inFlight.takeAt(i).key;
+            if (!key.isEmpty() && --m_inFlightKeys[key] <= 0) {
+                m_inFlightKeys.remove(key);
+            }
+        }
+    }
+    while (m_inFlight.size() < m_maxInFlight) {
+        QList<Job>& queue = m_queues[UserPriority].isEmpty() ? m_queues[BackgroundPriority]
+                                                             : m_queues[UserPriority];
+        if (queue.isEmpty()) {
+            break;
+        }
+        const Job job = queue.takeFirst();
+        QNetworkReply* reply = job.start ? job.start() : nullptr;
+        if (!reply) {
+            continue;
+        }
+        m_started++;
+        if (reply->isFinished()) {
+            continue;  // failed synchronously; its own handler has run
+        }
+        m_inFlight.append(Running{reply, job.key});
+        if (!job.key.isEmpty()) {
+            m_inFlightKeys[job.key]++;
+        }
+        connect(reply, &QNetworkReply::finished, this, [this, reply]() { onReplyFinished(reply); });
+    }
+    m_pumping = false;
+}
+
+void FujiNetRequestScheduler::onReplyFinished(QNetworkReply* reply)
+{
+    for (int i = 0; i < m_inFlight.size(); ++i) {
+        if (m_inFlight[i].reply.data() != reply) {
+            continue;
+        }
+        const QString key = m_inFlight[i].key;
+        m_inFlight.removeAt(i);
+        if (!key.isEmpty() && --m_inFlightKeys[key] <= 0) {
+            m_inFlightKeys.remove(key);
+        }
+        break;
+    }
+    pump();
+}
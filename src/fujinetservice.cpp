@@ -15,10 +15,12 @@
 #include <QDir>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QJsonArray>
 
 FujiNetService::FujiNetService(QObject *parent)
     : QObject(parent)
     , m_networkManager(new QNetworkAccessManager(this))
+    , m_scheduler(new FujiNetRequestScheduler(this))
     , m_serverUrl("http://localhost:8000")
     , m_isConnected(false)
     , m_healthCheckTimer(new QTimer(this))
@@ -27,9 +29,23 @@ FujiNetService::FujiNetService(QObject *parent)
     , m_printerEnabled(false)
     , m_currentPrinterType("Atari 825")
     , m_sseConnection(nullptr)
+    , m_eventIdleTimer(new QTimer(this))
+    , m_eventRetryTimer(new QTimer(this))
+    , m_eventRetryMs(EVENT_RETRY_MIN_MS)
 {
     connect(m_healthCheckTimer, &QTimer::timeout, this, &FujiNetService::checkConnection);
     connect(m_drivePollingTimer, &QTimer::timeout, this, &FujiNetService::queryDriveStatus);
+
+    m_eventIdleTimer->setSingleShot(true);
+    m_eventIdleTimer->setInterval(EVENT_IDLE_TIMEOUT_MS);
+    connect(m_eventIdleTimer, &QTimer::timeout, this, [this]() {
+        if (m_eventReply) {
+            qDebug() << "FujiNet event channel idle, reconnecting";
+            m_eventReply->abort();
+        }
+    });
+    m_eventRetryTimer->setSingleShot(true);
+    connect(m_eventRetryTimer, &QTimer::timeout, this, &FujiNetService::openEventChannel);
 }
 
 FujiNetService::~FujiNetService()
@@ -52,17 +68,24 @@ void FujiNetService::setServerUrl(const QString& url)
 
 void FujiNetService::checkConnection()
 {
-    QUrl url(m_serverUrl + "/test");
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
-
-    QNetworkReply* reply = m_networkManager->get(request);
-    m_healthCheckReply = reply;
-    connect(reply, &QNetworkReply::finished, this, &FujiNetService::onHealthCheckReply);
+    m_scheduler->enqueue(FujiNetRequestScheduler::BackgroundPriority, "/test", [this]() {
+        QUrl url(m_serverUrl + "/test");
+        QNetworkRequest request(url);
+        request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
+
+        QNetworkReply* reply = m_networkManager->get(request);
+        m_healthCheckReply = reply;
+        connect(reply, &QNetworkReply::finished, this, &FujiNetService::onHealthCheckReply);
+        return reply;
+    });
 }
 
 void FujiNetService::startHealthCheck(int intervalMs)
 {
+    m_healthCheckIntervalMs = intervalMs;
+    if (m_eventChannelLive) {
+        return;  // the open stream already proves the server is up
+    }
     m_healthCheckTimer->start(intervalMs);
     // Fire an early probe after 500 ms so the widget shows "Connected" quickly once
     // FujiNet is up, without risking "connection refused" on an immediate call.
@@ -71,23 +94,205 @@ void FujiNetService::startHealthCheck(int intervalMs)
 
 void FujiNetService::stopHealthCheck()
 {
+    m_healthCheckIntervalMs = 0;
     m_healthCheckTimer->stop();
     if (!m_healthCheckReply.isNull()) {
         m_healthCheckReply->abort();
         m_healthCheckReply.clear();
     }
+    closeEventChannel();
     abortAllRequests();
 }
 
 void FujiNetService::startDrivePolling(int intervalMs)
 {
-    m_drivePollingTimer->start(intervalMs);
+    m_drivePollingWanted = true;
+    m_drivePollingTimer->setInterval(intervalMs);
+    if (!m_eventChannelLive) {
+        m_drivePollingTimer->start();
+    }
     queryDriveStatus();  // Query immediately
+    openEventChannel();
 }
 
 void FujiNetService::stopDrivePolling()
 {
+    m_drivePollingWanted = false;
     m_drivePollingTimer->stop();
+    closeEventChannel();
+}
+
+void FujiNetService::openEventChannel()
+{
+    m_eventChannelWanted = true;
+    m_eventRetryTimer->stop();
+    if (m_eventReply) {
+        return;
+    }
+
+    QNetworkRequest request(QUrl(m_serverUrl + "/events"));
+    request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
+    request.setRawHeader("Accept", "text/event-stream");
+    request.setRawHeader("Cache-Control", "no-cache");
+    request.setRawHeader("Connection", "keep-alive");
+
+    m_eventParser.reset();
+    m_eventReply = m_networkManager->get(request);
+    // Headers alone are enough to go live; the first event may be a while off
+    connect(m_eventReply, &QNetworkReply::metaDataChanged, this, &FujiNetService::onEventChannelData);
+    connect(m_eventReply, &QIODevice::readyRead, this, &FujiNetService::onEventChannelData);
+    connect(m_eventReply, &QNetworkReply::finished, this, &FujiNetService::onEventChannelFinished);
+    m_eventIdleTimer->start();
+}
+
+void FujiNetService::closeEventChannel()
+{
+    m_eventChannelWanted = false;
+    m_eventRetryTimer->stop();
+    m_eventIdleTimer->stop();
+    if (m_eventReply) {
+        QNetworkReply* reply = m_eventReply.data();
+        m_eventReply.clear();
+        disconnect(reply, nullptr, this, nullptr);
+        reply->abort();
+        reply->deleteLater();
+    }
+    if (m_eventChannelLive) {
+        // Closed on purpose: restart whatever timers are still wanted, but do
+        // not fire requests at a server that may be going away
+        m_eventChannelLive = false;
+        resumePolling(false);
+    }
+}
+
+void FujiNetService::onEventChannelData()
+{
+    QNetworkReply* reply = m_eventReply.data();
+    if (!reply || sender() != reply) {
+        return;
+    }
+
+    if (!m_eventChannelLive) {
+        // Stock FujiNet-PC answers /events with a 404 page: keep polling
+        const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        const QString contentType = reply->header(QNetworkRequest::ContentTypeHeader).toString();
+        if (status != 200 || !contentType.contains("text/event-stream", Qt::CaseInsensitive)) {
+            reply->abort();
+            return;
+        }
+        setEventChannelLive(true);
+    }
+
+    m_eventIdleTimer->start();
+    const QVector<SseStreamParser::Event> events = m_eventParser.feed(reply->readAll());
+    for (const SseStreamParser::Event& event : events) {
+        handleChannelEvent(event);
+    }
+}
+
+void FujiNetService::onEventChannelFinished()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if (!reply) return;
+    if (m_eventReply.data() == reply) {
+        m_eventReply.clear();
+    }
+    reply->deleteLater();
+    m_eventIdleTimer->stop();
+
+    const bool wasLive = m_eventChannelLive;
+    setEventChannelLive(false);
+    if (!m_eventChannelWanted) {
+        return;
+    }
+
+    // A stream that worked comes back quickly; a server without one is retried rarely
+    if (wasLive) {
+        m_eventRetryMs = qMax(int(EVENT_RETRY_MIN_MS), m_eventParser.retryMs());
+    } else {
+        m_eventRetryMs = qMin(m_eventRetryMs * 2, int(EVENT_RETRY_MAX_MS));
+    }
+    m_eventRetryTimer->start(m_eventRetryMs);
+}
+
+void FujiNetService::setEventChannelLive(bool live)
+{
+    if (m_eventChannelLive == live) {
+        return;
+    }
+    m_eventChannelLive = live;
+
+    if (live) {
+        qDebug() << "FujiNet event channel open, polling stopped";
+        m_eventRetryMs = EVENT_RETRY_MIN_MS;
+        m_drivePollingTimer->stop();
+        m_healthCheckTimer->stop();
+        stopPrinterPolling();
+        disconnectFromPrinterEvents();  // printer events come through the channel too
+
+        if (!m_isConnected) {
+            m_isConnected = true;
+            emit connected();
+        }
+        queryDriveStatus();  // catch up on anything that changed before the stream opened
+    } else {
+        qDebug() << "FujiNet event channel closed, falling back to polling";
+        resumePolling(true);
+    }
+}
+
+void FujiNetService::resumePolling(bool fetchNow)
+{
+    if (m_drivePollingWanted) {
+        m_drivePollingTimer->start();
+        if (fetchNow) {
+            queryDriveStatus();
+        }
+    }
+    if (m_healthCheckIntervalMs > 0) {
+        m_healthCheckTimer->start(m_healthCheckIntervalMs);
+        if (fetchNow) {
+            checkConnection();
+        }
+    }
+    if (m_printerEnabled && fetchNow) {
+        connectToPrinterEvents();
+    }
+}
+
+void FujiNetService::handleChannelEvent(const SseStreamParser::Event& event)
+{
+    const QJsonObject data = QJsonDocument::fromJson(event.data).object();
+    // Unnamed events carry their type in the payload, like /printer/events
+    const QString name = event.name == "message" ? data["event"].toString()
+                                                 : QString::fromUtf8(event.name);
+
+    if (name == "drives" && data["drives"].isArray()) {
+        QVector<FujiNetDrive> drives(8);
+        for (int i = 0; i < drives.size(); i++) {
+            drives[i].slotNumber = i;
+        }
+        for (const QJsonValue& value : data["drives"].toArray()) {
+            const QJsonObject entry = value.toObject();
+            const int slot = entry["slot"].toInt(-1);
+            if (slot < 0 || slot >= drives.size()) {
+                continue;
+            }
+            FujiNetDrive& drive = drives[slot];
+            drive.filename = entry["filename"].toString();
+            drive.isEmpty = drive.filename.isEmpty();
+            drive.isReadOnly = entry["mode"].toString() != "w";
+        }
+        emit driveStatusUpdated(drives);
+    } else if (name == "drives" || name == "mount" || name == "unmount") {
+        queryDriveStatus();  // change notice without the table: fetch it once
+    } else if (name == "hosts") {
+        getHosts();
+    } else if (name.startsWith("printer_")) {
+        QJsonObject printerEvent = data;
+        printerEvent["event"] = name;
+        handlePrinterEvent(printerEvent);
+    }
 }
 
 void FujiNetService::resetConnectionState()
@@ -97,6 +302,11 @@ void FujiNetService::resetConnectionState()
 
 void FujiNetService::abortAllRequests()
 {
+    // Nothing queued should start against a server that is going away
+    m_scheduler->cancelQueued();
+    m_batchRefreshPending = 0;
+    m_batchedReplies.clear();
+
     // Abort all pending mount requests
     for (auto reply : m_pendingMounts.keys()) {
         if (reply) {
@@ -128,6 +338,12 @@ void FujiNetService::abortAllRequests()
 }
 
 void FujiNetService::mount(int deviceSlot, int hostSlot, const QString& filename, bool readOnly)
+{
+    scheduleMount(deviceSlot, hostSlot, filename, readOnly, false);
+}
+
+void FujiNetService::scheduleMount(int deviceSlot, int hostSlot, const QString& filename, bool readOnly,
+                                   bool batched)
 {
     // Use stock FujiNet-PC browse API: GET /browse/host/{H}/path?action=newmount&slot={D}&mode=r|w
     // Note: Browse API uses 1-indexed host and slot numbers
@@ -147,17 +363,28 @@ void FujiNetService::mount(int deviceSlot, int hostSlot, const QString& filename
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
 
-    qDebug() << "FujiNet mount request (browse API):" << url.toString();
+    m_scheduler->enqueue(FujiNetRequestScheduler::UserPriority, QString(), [this, request, deviceSlot, batched]() {
+        qDebug() << "FujiNet mount request (browse API):" << request.url().toString();
 
-    QNetworkReply* reply = m_networkManager->get(request);
-    m_pendingMounts[reply] = deviceSlot;
+        QNetworkReply* reply = m_networkManager->get(request);
+        m_pendingMounts[reply] = deviceSlot;
+        if (batched) {
+            m_batchedReplies.insert(reply);
+        }
 
-    connect(reply, &QNetworkReply::finished, this, &FujiNetService::onMountReply);
-    connect(reply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
-            this, &FujiNetService::onNetworkError);
+        connect(reply, &QNetworkReply::finished, this, &FujiNetService::onMountReply);
+        connect(reply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
+                this, &FujiNetService::onNetworkError);
+        return reply;
+    });
 }
 
 void FujiNetService::unmount(int deviceSlot)
+{
+    scheduleUnmount(deviceSlot, false);
+}
+
+void FujiNetService::scheduleUnmount(int deviceSlot, bool batched)
 {
     // Use stock FujiNet-PC browse API: GET /browse/host/1/?action=eject&slot={D}
     // Note: Browse API uses 1-indexed slot numbers
@@ -174,14 +401,47 @@ void FujiNetService::unmount(int deviceSlot)
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
 
-    qDebug() << "FujiNet unmount request (browse API):" << url.toString();
+    m_scheduler->enqueue(FujiNetRequestScheduler::UserPriority, QString(), [this, request, deviceSlot, batched]() {
+        qDebug() << "FujiNet unmount request (browse API):" << request.url().toString();
 
-    QNetworkReply* reply = m_networkManager->get(request);
-    m_pendingUnmounts[reply] = deviceSlot;
+        QNetworkReply* reply = m_networkManager->get(request);
+        m_pendingUnmounts[reply] = deviceSlot;
+        if (batched) {
+            m_batchedReplies.insert(reply);
+        }
 
-    connect(reply, &QNetworkReply::finished, this, &FujiNetService::onUnmountReply);
-    connect(reply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
-            this, &FujiNetService::onNetworkError);
+        connect(reply, &QNetworkReply::finished, this, &FujiNetService::onUnmountReply);
+        connect(reply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
+                this, &FujiNetService::onNetworkError);
+        return reply;
+    });
+}
+
+void FujiNetService::applyDiskSlots(const QVector<FujiNetDiskSlot>& diskSlots)
+{
+    // One refresh once the last operation is answered, not one per slot
+    for (const FujiNetDiskSlot& slot : diskSlots) {
+        if (slot.slotNumber < 0 || slot.slotNumber > 7) {
+            continue;
+        }
+        m_batchRefreshPending++;
+        if (slot.isEmpty || slot.filename.isEmpty()) {
+            scheduleUnmount(slot.slotNumber, true);
+        } else {
+            scheduleMount(slot.slotNumber, slot.hostSlot == 0xFF ? 0 : slot.hostSlot, slot.filename,
+                          slot.accessMode != 2, true);
+        }
+    }
+}
+
+void FujiNetService::refreshAfterMountChange(QNetworkReply* reply)
+{
+    if (m_batchedReplies.remove(reply)) {
+        if (m_batchRefreshPending > 0 && --m_batchRefreshPending > 0) {
+            return;
+        }
+    }
+    queryMountStatus();
 }
 
 void FujiNetService::mountAll()
@@ -193,10 +453,13 @@ void FujiNetService::mountAll()
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
 
-    QNetworkReply* reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, &FujiNetService::onMountReply);
-    connect(reply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
-            this, &FujiNetService::onNetworkError);
+    m_scheduler->enqueue(FujiNetRequestScheduler::UserPriority, "/mount?mountall", [this, request]() {
+        QNetworkReply* reply = m_networkManager->get(request);
+        connect(reply, &QNetworkReply::finished, this, &FujiNetService::onMountReply);
+        connect(reply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
+                this, &FujiNetService::onNetworkError);
+        return reply;
+    });
 }
 
 QString FujiNetService::copyToSD(const QString& localPath, const QString& sdFolderPath)
@@ -278,14 +541,17 @@ QString FujiNetService::copyToSD(const QString& localPath, const QString& sdFold
 
 void FujiNetService::getHosts()
 {
-    QUrl url(m_serverUrl + "/hosts");
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
-
-    QNetworkReply* reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, &FujiNetService::onHostsReply);
-    connect(reply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
-            this, &FujiNetService::onNetworkError);
+    m_scheduler->enqueue(FujiNetRequestScheduler::BackgroundPriority, "/hosts", [this]() {
+        QUrl url(m_serverUrl + "/hosts");
+        QNetworkRequest request(url);
+        request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
+
+        QNetworkReply* reply = m_networkManager->get(request);
+        connect(reply, &QNetworkReply::finished, this, &FujiNetService::onHostsReply);
+        connect(reply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
+                this, &FujiNetService::onNetworkError);
+        return reply;
+    });
 }
 
 void FujiNetService::setHost(int hostSlot, const QString& hostname)
@@ -298,36 +564,46 @@ void FujiNetService::setHost(int hostSlot, const QString& hostname)
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
 
-    QNetworkReply* reply = m_networkManager->post(request, QByteArray());
-    connect(reply, &QNetworkReply::finished, this, &FujiNetService::onSetHostReply);
-    connect(reply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
-            this, &FujiNetService::onNetworkError);
+    m_scheduler->enqueue(FujiNetRequestScheduler::UserPriority, QString(), [this, request]() {
+        QNetworkReply* reply = m_networkManager->post(request, QByteArray());
+        connect(reply, &QNetworkReply::finished, this, &FujiNetService::onSetHostReply);
+        connect(reply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
+                this, &FujiNetService::onNetworkError);
+        return reply;
+    });
 }
 
 void FujiNetService::queryMountStatus()
 {
     // Use the /slot endpoint to query all mount status (legacy endpoint)
-    QUrl url(m_serverUrl + "/slot");
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
-
-    QNetworkReply* reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, &FujiNetService::onMountStatusReply);
-    connect(reply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
-            this, &FujiNetService::onNetworkError);
+    m_scheduler->enqueue(FujiNetRequestScheduler::BackgroundPriority, "/slot", [this]() {
+        QUrl url(m_serverUrl + "/slot");
+        QNetworkRequest request(url);
+        request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
+
+        QNetworkReply* reply = m_networkManager->get(request);
+        connect(reply, &QNetworkReply::finished, this, &FujiNetService::onMountStatusReply);
+        connect(reply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
+                this, &FujiNetService::onNetworkError);
+        return reply;
+    });
 }
 
 void FujiNetService::queryDriveStatus()
 {
-    // Use the root / endpoint to query drive status (new format)
-    QUrl url(m_serverUrl + "/");
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
-
-    QNetworkReply* reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, &FujiNetService::onDriveStatusReply);
-    connect(reply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
-            this, &FujiNetService::onNetworkError);
+    // Use the root / endpoint to query drive status (new format). At most one
+    // in flight and one waiting, however often the poll timer fires.
+    m_scheduler->enqueue(FujiNetRequestScheduler::BackgroundPriority, "/", [this]() {
+        QUrl url(m_serverUrl + "/");
+        QNetworkRequest request(url);
+        request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
+
+        QNetworkReply* reply = m_networkManager->get(request);
+        connect(reply, &QNetworkReply::finished, this, &FujiNetService::onDriveStatusReply);
+        connect(reply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
+                this, &FujiNetService::onNetworkError);
+        return reply;
+    });
 }
 
 void FujiNetService::swapDisks()
@@ -337,27 +613,33 @@ void FujiNetService::swapDisks()
         return;
     }
 
-    QUrl url(m_serverUrl + "/swap");
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
+    m_scheduler->enqueue(FujiNetRequestScheduler::UserPriority, QString(), [this]() {
+        QUrl url(m_serverUrl + "/swap");
+        QNetworkRequest request(url);
+        request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
 
-    QNetworkReply* reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
+        QNetworkReply* reply = m_networkManager->get(request);
+        connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
+        return reply;
+    });
 }
 
 void FujiNetService::browseHost(int hostSlot)
 {
     QString endpoint = QString("/browse/%1").arg(hostSlot);
-    QUrl url(m_serverUrl + endpoint);
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
-
-    QNetworkReply* reply = m_networkManager->get(request);
-    m_pendingBrowse[reply] = hostSlot;
-
-    connect(reply, &QNetworkReply::finished, this, &FujiNetService::onBrowseReply);
-    connect(reply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
-            this, &FujiNetService::onNetworkError);
+    m_scheduler->enqueue(FujiNetRequestScheduler::UserPriority, endpoint, [this, endpoint, hostSlot]() {
+        QUrl url(m_serverUrl + endpoint);
+        QNetworkRequest request(url);
+        request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
+
+        QNetworkReply* reply = m_networkManager->get(request);
+        m_pendingBrowse[reply] = hostSlot;
+
+        connect(reply, &QNetworkReply::finished, this, &FujiNetService::onBrowseReply);
+        connect(reply, QOverload<QNetworkReply::NetworkError>::of(&QNetworkReply::errorOccurred),
+                this, &FujiNetService::onNetworkError);
+        return reply;
+    });
 }
 
 // Private slots
@@ -416,8 +698,11 @@ void FujiNetService::onMountReply()
             emit mountSuccess(deviceSlot);
         }
         // After successful mount, query status to update UI
-        queryMountStatus();
+        refreshAfterMountChange(reply);
     } else {
+        if (m_batchedReplies.remove(reply) && m_batchRefreshPending > 0 && --m_batchRefreshPending == 0) {
+            queryMountStatus();  // the rest of the batch may have changed slots
+        }
         if (deviceSlot != -1) {
             emit mountFailed(deviceSlot, reply->errorString());
         }
@@ -439,8 +724,11 @@ void FujiNetService::onUnmountReply()
             emit unmountSuccess(deviceSlot);
         }
         // After successful unmount, query status to update UI
-        queryMountStatus();
+        refreshAfterMountChange(reply);
     } else {
+        if (m_batchedReplies.remove(reply) && m_batchRefreshPending > 0 && --m_batchRefreshPending == 0) {
+            queryMountStatus();  // the rest of the batch may have changed slots
+        }
         if (deviceSlot != -1) {
             emit unmountFailed(deviceSlot, reply->errorString());
         }
@@ -711,24 +999,27 @@ void FujiNetService::configurePrinter(const QString& printerType, bool enabled)
 
     qDebug() << "Configuring printer:" << apiPrinterType << "enabled:" << enabled;
 
-    QNetworkReply* reply = m_networkManager->post(request, postData.toUtf8());
+    m_scheduler->enqueue(FujiNetRequestScheduler::UserPriority, QString(), [this, request, postData, enabled]() {
+        QNetworkReply* reply = m_networkManager->post(request, postData.toUtf8());
 
-    connect(reply, &QNetworkReply::finished, this, [this, reply, enabled]() {
-        if (reply->error() == QNetworkReply::NoError) {
-            qDebug() << "Printer configured successfully";
+        connect(reply, &QNetworkReply::finished, this, [this, reply, enabled]() {
+            if (reply->error() == QNetworkReply::NoError) {
+                qDebug() << "Printer configured successfully";
 
-            if (enabled) {
-                stopPrinterPolling();
-                connectToPrinterEvents();
+                if (enabled) {
+                    stopPrinterPolling();
+                    connectToPrinterEvents();
+                } else {
+                    disconnectFromPrinterEvents();
+                    stopPrinterPolling();
+                }
             } else {
-                disconnectFromPrinterEvents();
-                stopPrinterPolling();
+                qDebug() << "Printer config failed:" << reply->errorString();
+                emit printerError("Failed to configure printer: " + reply->errorString());
             }
-        } else {
-            qDebug() << "Printer config failed:" << reply->errorString();
-            emit printerError("Failed to configure printer: " + reply->errorString());
-        }
-        reply->deleteLater();
+            reply->deleteLater();
+        });
+        return reply;
     });
 
     m_printerEnabled = enabled;
@@ -743,22 +1034,25 @@ void FujiNetService::checkPrinterStatus()
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
 
-    QNetworkReply* reply = m_networkManager->get(request);
+    m_scheduler->enqueue(FujiNetRequestScheduler::BackgroundPriority, "/printer/status", [this, request]() {
+        QNetworkReply* reply = m_networkManager->get(request);
 
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        if (reply->error() == QNetworkReply::NoError) {
-            QByteArray data = reply->readAll();
-            QJsonDocument doc = QJsonDocument::fromJson(data);
-            QJsonObject obj = doc.object();
+        connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+            if (reply->error() == QNetworkReply::NoError) {
+                QByteArray data = reply->readAll();
+                QJsonDocument doc = QJsonDocument::fromJson(data);
+                QJsonObject obj = doc.object();
 
-            bool hasOutput = obj["has_output"].toBool();
-            bool ready = obj["ready"].toBool();
+                bool hasOutput = obj["has_output"].toBool();
+                bool ready = obj["ready"].toBool();
 
-            if (hasOutput && ready) {
-                getPrinterOutput();
+                if (hasOutput && ready) {
+                    getPrinterOutput();
+                }
             }
-        }
-        reply->deleteLater();
+            reply->deleteLater();
+        });
+        return reply;
     });
 }
 
@@ -770,32 +1064,38 @@ void FujiNetService::getPrinterOutput()
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::UserAgentHeader, "Fujisan");
 
-    QNetworkReply* reply = m_networkManager->get(request);
+    m_scheduler->enqueue(FujiNetRequestScheduler::BackgroundPriority, "/print", [this, request]() {
+        QNetworkReply* reply = m_networkManager->get(request);
 
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        if (reply->error() == QNetworkReply::NoError) {
-            QByteArray data = reply->readAll();
+        connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+            if (reply->error() == QNetworkReply::NoError) {
+                QByteArray data = reply->readAll();
 
-            if (data.isEmpty()) {
-                reply->deleteLater();
-                return;
-            }
+                if (data.isEmpty()) {
+                    reply->deleteLater();
+                    return;
+                }
 
-            QString contentType = reply->header(QNetworkRequest::ContentTypeHeader).toString();
-            emit printerOutputReceived(data, contentType);
-        }
-        else if (reply->errorString().contains("busy", Qt::CaseInsensitive)) {
-            emit printerBusy();
-        }
-        else {
-            qDebug() << "Printer output error:" << reply->errorString();
-        }
-        reply->deleteLater();
+                QString contentType = reply->header(QNetworkRequest::ContentTypeHeader).toString();
+                emit printerOutputReceived(data, contentType);
+            }
+            else if (reply->errorString().contains("busy", Qt::CaseInsensitive)) {
+                emit printerBusy();
+            }
+            else {
+                qDebug() << "Printer output error:" << reply->errorString();
+            }
+            reply->deleteLater();
+        });
+        return reply;
     });
 }
 
 void FujiNetService::startPrinterPolling()
 {
+    if (m_eventChannelLive) {
+        return;  // printer_ready arrives as an event
+    }
     if (!m_printerPollTimer) {
         m_printerPollTimer = new QTimer(this);
         connect(m_printerPollTimer, &QTimer::timeout, this, &FujiNetService::checkPrinterStatus);
@@ -823,15 +1123,18 @@ void FujiNetService::clearPrinterBuffer()
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::ContentLengthHeader, "0");
 
-    QNetworkReply* reply = m_networkManager->post(request, QByteArray());
+    m_scheduler->enqueue(FujiNetRequestScheduler::UserPriority, "/printer/clear", [this, request]() {
+        QNetworkReply* reply = m_networkManager->post(request, QByteArray());
 
-    connect(reply, &QNetworkReply::finished, this, [reply]() {
-        if (reply->error() == QNetworkReply::NoError) {
-            qDebug() << "Printer buffer cleared successfully";
-        } else {
-            qDebug() << "Failed to clear printer buffer:" << reply->errorString();
-        }
-        reply->deleteLater();
+        connect(reply, &QNetworkReply::finished, this, [reply]() {
+            if (reply->error() == QNetworkReply::NoError) {
+                qDebug() << "Printer buffer cleared successfully";
+            } else {
+                qDebug() << "Failed to clear printer buffer:" << reply->errorString();
+            }
+            reply->deleteLater();
+        });
+        return reply;
     });
 }
 
@@ -847,6 +1150,10 @@ void FujiNetService::connectToPrinterEvents()
         return;
     }
 
+    if (m_eventChannelLive) {
+        return;  // printer events already come through the event channel
+    }
+
     QUrl url(m_serverUrl + "/printer/events");
     QNetworkRequest request(url);
     request.setRawHeader("Accept", "text/event-stream");
@@ -856,21 +1163,27 @@ void FujiNetService::connectToPrinterEvents()
     qDebug() << "Connecting to printer SSE:" << url.toString();
 
     m_sseConnection = m_networkManager->get(request);
-    m_sseBuffer.clear();
+    m_sseParser.reset();
 
     connect(m_sseConnection, &QIODevice::readyRead, this, [this]() {
         if (!m_sseConnection) return;
 
-        QByteArray data = m_sseConnection->readAll();
-        m_sseBuffer.append(data);
-        parseSSEData(m_sseBuffer);
+        const QVector<SseStreamParser::Event> events = m_sseParser.feed(m_sseConnection->readAll());
+        for (const SseStreamParser::Event& event : events) {
+            QJsonDocument doc = QJsonDocument::fromJson(event.data);
+            if (doc.isNull()) {
+                qDebug() << "Failed to parse SSE JSON:" << event.data;
+                continue;
+            }
+            handlePrinterEvent(doc.object());
+        }
     });
 
     connect(m_sseConnection, &QNetworkReply::finished, this, [this]() {
         qDebug() << "SSE connection closed, reconnecting in 2s";
         m_sseConnection = nullptr;
 
-        if (m_printerEnabled) {
+        if (m_printerEnabled && !m_eventChannelLive) {
             QTimer::singleShot(2000, this, &FujiNetService::connectToPrinterEvents);
         }
     });
@@ -893,41 +1206,17 @@ void FujiNetService::disconnectFromPrinterEvents()
         m_sseConnection->abort();
         m_sseConnection->deleteLater();
         m_sseConnection = nullptr;
-        m_sseBuffer.clear();
+        m_sseParser.reset();
     }
 }
 
-void FujiNetService::parseSSEData(QByteArray& buffer)
+void FujiNetService::handlePrinterEvent(const QJsonObject& event)
 {
-    // SSE messages end with double newline: either \n\n or \r\n\r\n
-    QString delimiter = "\n\n";
-    if (!buffer.contains(delimiter.toLatin1())) {
-        delimiter = "\r\n\r\n";
-    }
-
-    while (buffer.contains(delimiter.toLatin1())) {
-        int endPos = buffer.indexOf(delimiter.toLatin1());
-        QByteArray message = buffer.left(endPos);
-        buffer.remove(0, endPos + delimiter.length());
-
-        if (message.startsWith("data: ")) {
-            QByteArray jsonData = message.mid(6).trimmed();
-
-            QJsonDocument doc = QJsonDocument::fromJson(jsonData);
-            if (doc.isNull()) {
-                qDebug() << "Failed to parse SSE JSON:" << jsonData;
-                continue;
-            }
-
-            QJsonObject obj = doc.object();
-            QString event = obj["event"].toString();
-
-            if (event == "printer_ready") {
-                getPrinterOutput();
-            } else if (event == "printer_cleared") {
-                emit printerBufferCleared();
-            }
-        }
+    const QString name = event["event"].toString();
+    if (name == "printer_ready") {
+        getPrinterOutput();
+    } else if (name == "printer_cleared") {
+        emit printerBufferCleared();
     }
 }
 
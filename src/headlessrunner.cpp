@@ -0,0 +1,505 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#ifdef _WIN32
+#include "windows_compat.h"
+#include <windows.h>
+#endif
+
+#include "headlessrunner.h"
+#include "atariemulator.h"
+#include "scenariocase.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QProcess>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QJsonDocument>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QTimer>
+#include <QCryptographicHash>
+#include <QQueue>
+#include <QTextStream>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QVector>
+#include <QDebug>
+#include <algorithm>
+#include <functional>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+extern "C" {
+    extern unsigned short CPU_regPC;
+    extern unsigned char MEMORY_mem[65536];
+}
+
+namespace {
+
+const char* kFarmOption = "--headless-farm";
+const char* kWorkerOption = "--headless-worker";
+
+void printJsonLine(const QJsonObject& object)
+{
+    QTextStream out(stdout);
+    out << QJsonDocument(object).toJson(QJsonDocument::Compact) << "\n";
+    out.flush();
+}
+
+}  // namespace
+
+bool HeadlessRunner::isHeadlessInvocation(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], kFarmOption) == 0 || qstrcmp(argv[i], kWorkerOption) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int HeadlessRunner::run(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("Fujisan");
+    app.setOrganizationName("8bitrelics");
+
+#ifdef Q_OS_WIN
+    // Same INI settings location as the GUI (see main.cpp)
+    QSettings::setDefaultFormat(QSettings::IniFormat);
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope,
+                       QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation));
+#endif
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Fujisan headless fast-forward farm");
+    parser.addHelpOption();
+    QCommandLineOption farmOption("headless-farm", "Run all jobs in <file>.", "file");
+    QCommandLineOption workersOption("workers", "Maximum parallel workers (default: core count).", "count");
+    QCommandLineOption workerOption("headless-worker", "Internal: run one job from <file>.", "file");
+    QCommandLineOption jobOption("job", "Internal: job index for --headless-worker.", "index");
+    QCommandLineOption cpuOption("cpu", "Internal: core to pin the worker to.", "index");
+    parser.addOptions({farmOption, workersOption, workerOption, jobOption, cpuOption});
+    parser.process(app);
+
+    if (parser.isSet(workerOption)) {
+        return runWorker(parser.value(workerOption), parser.value(jobOption).toInt(),
+                         parser.isSet(cpuOption) ? parser.value(cpuOption).toInt() : -1);
+    }
+    return runFarm(parser.value(farmOption),
+                   parser.isSet(workersOption) ? parser.value(workersOption).toInt() : 0);
+}
+
+bool HeadlessRunner::loadJobFile(const QString& jobFile, QJsonObject& root, QString& error)
+{
+    QFile file(jobFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QString("Cannot open job file: %1").arg(jobFile);
+        return false;
+    }
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        error = QString("Invalid job file: %1").arg(parseError.errorString());
+        return false;
+    }
+    root = doc.object();
+    if (!root.value("jobs").isArray()) {
+        error = "Job file has no \"jobs\" array";
+        return false;
+    }
+    return true;
+}
+
+QJsonObject HeadlessRunner::resolveJob(const QJsonObject& root, int jobIndex)
+{
+    // Per-job keys override "defaults"
+    QJsonObject job = root.value("defaults").toObject();
+    const QJsonObject overrides = root.value("jobs").toArray().at(jobIndex).toObject();
+    for (auto it = overrides.begin(); it != overrides.end(); ++it) {
+        job.insert(it.key(), it.value());
+    }
+    if (!job.contains("name")) {
+        job.insert("name", QString("job%1").arg(jobIndex));
+    }
+    return job;
+}
+
+QString HeadlessRunner::resolvePath(const QString& jobFile, const QString& path)
+{
+    if (path.isEmpty() || QDir::isAbsolutePath(path)) {
+        return path;
+    }
+    return QFileInfo(jobFile).absoluteDir().absoluteFilePath(path);
+}
+
+void HeadlessRunner::pinToCpu(int cpu)
+{
+    if (cpu < 0) {
+        return;
+    }
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        qWarning() << "Headless worker: could not pin to CPU" << cpu;
+    }
+#elif defined(_WIN32)
+    if (cpu < 64 && !SetProcessAffinityMask(GetCurrentProcess(), DWORD_PTR(1) << cpu)) {
+        qWarning() << "Headless worker: could not pin to CPU" << cpu;
+    }
+#else
+    // macOS has no hard affinity API; the scheduler spreads the worker processes.
+    Q_UNUSED(cpu);
+#endif
+}
+
+int HeadlessRunner::runFarm(const QString& jobFile, int workers)
+{
+    QJsonObject root;
+    QString error;
+    if (!loadJobFile(jobFile, root, error)) {
+        qCritical().noquote() << error;
+        return 2;
+    }
+
+    const int cores = qMax(1, QThread::idealThreadCount());
+    if (workers <= 0) {
+        workers = root.value("workers").toInt(cores);
+    }
+    const int jobCount = root.value("jobs").toArray().size();
+    workers = qBound(1, workers, qMax(1, jobCount));
+
+    QElapsedTimer wallClock;
+    wallClock.start();
+
+    QQueue<int> pending;
+    for (int i = 0; i < jobCount; ++i) {
+        pending.enqueue(i);
+    }
+    QVector<QJsonObject> results(jobCount);
+    QVector<QElapsedTimer> jobClocks(jobCount);
+    QVector<int> freeCpus;
+    for (int i = 0; i < workers; ++i) {
+        freeCpus.append(i % cores);
+    }
+    int running = 0;
+    int failed = 0;
+
+    // Plain event-loop driven scheduler: start a worker per free slot, refill on exit.
+    std::function<void()> startNext;
+    auto finishJob = [&](QProcess* process, int jobIndex, int cpu, QJsonObject result) {
+        if (!result.value("ok").toBool()) {
+            failed++;
+        }
+        result.insert("job", jobIndex);
+        // Includes process start and emulator initialization, unlike elapsed_ms
+        result.insert("wall_ms", jobClocks[jobIndex].elapsed());
+        results[jobIndex] = result;
+        process->deleteLater();
+        freeCpus.append(cpu);
+        if (--running == 0 && pending.isEmpty()) {
+            QCoreApplication::quit();
+        } else {
+            startNext();
+        }
+    };
+
+    startNext = [&]() {
+        while (!pending.isEmpty() && !freeCpus.isEmpty()) {
+            const int jobIndex = pending.dequeue();
+            const int cpu = freeCpus.takeFirst();
+            QProcess* process = new QProcess(QCoreApplication::instance());
+            process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+            QObject::connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                             [&, process, jobIndex, cpu](int exitCode, QProcess::ExitStatus status) {
+                // The worker's result is the last JSON line it printed
+                QJsonObject result;
+                const QList<QByteArray> lines = process->readAllStandardOutput().split('\n');
+                for (auto it = lines.crbegin(); it != lines.crend(); ++it) {
+                    QJsonDocument doc = QJsonDocument::fromJson(*it);
+                    if (doc.isObject()) {
+                        result = doc.object();
+                        break;
+                    }
+                }
+                if (status != QProcess::NormalExit || exitCode != 0 || result.isEmpty()) {
+                    result.insert("ok", false);
+                    if (!result.contains("error")) {
+                        result.insert("error", status == QProcess::NormalExit
+                                                   ? QString("worker exited with code %1").arg(exitCode)
+                                                   : QString("worker crashed"));
+                    }
+                }
+                finishJob(process, jobIndex, cpu, result);
+            });
+            QObject::connect(process, &QProcess::errorOccurred,
+                             [&, process, jobIndex, cpu](QProcess::ProcessError processError) {
+                // finished() is never emitted for a worker that did not start
+                if (processError == QProcess::FailedToStart) {
+                    QJsonObject result;
+                    result.insert("ok", false);
+                    result.insert("error", QString("worker failed to start: %1").arg(process->errorString()));
+                    finishJob(process, jobIndex, cpu, result);
+                }
+            });
+            running++;
+            jobClocks[jobIndex].start();
+            process->start(QCoreApplication::applicationFilePath(),
+                           {kWorkerOption, jobFile, "--job", QString::number(jobIndex),
+                            "--cpu", QString::number(cpu)});
+        }
+    };
+
+    if (jobCount > 0) {
+        // Start from inside the event loop so quit() from a synchronous failure is honoured.
+        QTimer::singleShot(0, startNext);
+        QCoreApplication::exec();
+    }
+
+    QJsonArray resultArray;
+    for (const QJsonObject& result : results) {
+        resultArray.append(result);
+    }
+    QVector<QJsonObject> byWallTime = results;
+    std::sort(byWallTime.begin(), byWallTime.end(), [](const QJsonObject& a, const QJsonObject& b) {
+        return a.value("wall_ms").toDouble() > b.value("wall_ms").toDouble();
+    });
+    QJsonArray slowest;
+    for (int i = 0; i < byWallTime.size() && i < 5; ++i) {
+        QJsonObject entry;
+        entry["name"] = byWallTime[i].value("name");
+        entry["wall_ms"] = byWallTime[i].value("wall_ms");
+        slowest.append(entry);
+    }
+    QJsonObject summary;
+    summary["jobs"] = jobCount;
+    summary["passed"] = jobCount - failed;
+    summary["failed"] = failed;
+    summary["workers"] = workers;
+    summary["wall_ms"] = wallClock.elapsed();
+    summary["slowest"] = slowest;
+    summary["results"] = resultArray;
+    printJsonLine(summary);
+    return failed == 0 ? 0 : 1;
+}
+
+int HeadlessRunner::runWorker(const QString& jobFile, int jobIndex, int cpu)
+{
+    QJsonObject result;
+    QJsonObject root;
+    QString error;
+    if (!loadJobFile(jobFile, root, error)) {
+        result["ok"] = false;
+        result["error"] = error;
+        printJsonLine(result);
+        return 2;
+    }
+
+    pinToCpu(cpu);
+    QElapsedTimer caseClock;
+    caseClock.start();
+    const QJsonObject job = resolveJob(root, jobIndex);
+    result["name"] = job.value("name");
+
+    auto fail = [&](const QString& message) {
+        result["ok"] = false;
+        result["error"] = message;
+        result["total_ms"] = caseClock.elapsed();
+        printJsonLine(result);
+        return 1;
+    };
+
+    ScenarioCase scenario;
+    if (!scenario.parse(job, &error)) {
+        return fail(error);
+    }
+    const QString movie = resolvePath(jobFile, job.value("movie").toString());
+    if (!movie.isEmpty() && !scenario.actions.isEmpty()) {
+        return fail("a movie job cannot have a script; the movie brings its own input");
+    }
+
+    AtariEmulator emulator;
+    emulator.setDeferTimerStart(true);  // frames are driven by runFramesUnpaced() only
+    emulator.enableAudio(false);
+
+    const QString osRom = resolvePath(jobFile, job.value("os_rom").toString());
+    const QString basicRom = resolvePath(jobFile, job.value("basic_rom").toString());
+    // Built-in Altirra ROMs unless real ROM images are given, so jobs run anywhere.
+    emulator.setAltirraOSEnabled(osRom.isEmpty());
+    emulator.setAltirraBASICEnabled(basicRom.isEmpty());
+    emulator.setOSRomPath(osRom);
+    emulator.setBasicRomPath(basicRom);
+    // Workers sharing one store read each ROM and cartridge image once per farm
+    const QString romCache = resolvePath(jobFile, job.value("rom_cache").toString());
+    if (!romCache.isEmpty()) {
+        emulator.setRomImageCacheDirectory(romCache);
+    }
+
+    if (!emulator.initializeWithConfig(job.value("basic").toBool(false),
+                                       job.value("machine").toString("-xl"),
+                                       job.value("video").toString("-pal"),
+                                       job.value("artifact").toString("none"))) {
+        return fail("emulator initialization failed");
+    }
+
+    const QJsonArray disks = job.value("disks").toArray();
+    for (int i = 0; i < disks.size() && i < 8; ++i) {
+        const QString disk = resolvePath(jobFile, disks.at(i).toString());
+        if (!disk.isEmpty() && !emulator.mountDiskImage(i + 1, disk, true)) {
+            return fail(QString("cannot mount D%1: %2").arg(i + 1).arg(disk));
+        }
+    }
+    const QString file = resolvePath(jobFile, job.value("file").toString());
+    if (!file.isEmpty() && !emulator.loadFile(file)) {
+        return fail(QString("cannot load %1").arg(file));
+    }
+
+    for (const QJsonValue& value : job.value("breakpoints").toArray()) {
+        QString text = value.toString();
+        bool ok = false;
+        const int address = text.startsWith('$') ? text.mid(1).toInt(&ok, 16) : text.toInt(&ok, 0);
+        if (ok && address >= 0 && address <= 0xFFFF) {
+            emulator.addBreakpoint(static_cast<unsigned short>(address));
+        }
+    }
+    if (!emulator.getBreakpoints().isEmpty()) {
+        emulator.setBreakpointsEnabled(true);
+    }
+
+    const QString checksums = resolvePath(jobFile, job.value("checksums").toString());
+    if (!checksums.isEmpty()) {
+        // One line per frame; diff two runs' files to find where they diverge
+        QDir().mkpath(QFileInfo(checksums).absolutePath());
+        const QJsonObject status = emulator.startFrameChecksums(checksums, 1);
+        if (status.contains("error")) {
+            return fail(status.value("error").toString());
+        }
+    }
+
+    // The whole script is queued up front; each action runs right before its frame
+    const quint64 startFrame = emulator.getCurrentFrame();
+    for (ScenarioCase::Action action : scenario.actions) {
+        if (action.type == "save_state") {
+            action.params["filename"] = resolvePath(jobFile, action.params.value("filename").toString());
+        }
+        emulator.scheduleAction(action.relative ? startFrame + action.frame : action.frame,
+                                action.type, action.params);
+    }
+    int actionsRun = 0;
+    QObject::connect(&emulator, &AtariEmulator::scheduledActionExecuted, [&actionsRun]() { actionsRun++; });
+
+    auto verifyScenario = [&]() {
+        const QStringList rows = emulator.getScreenText(-1, false).value("rows").toVariant().toStringList();
+        return scenario.verify(rows, QByteArray::fromRawData(reinterpret_cast<const char*>(MEMORY_mem), 65536),
+                               CPU_regPC);
+    };
+
+    result["setup_ms"] = caseClock.elapsed();
+    if (!movie.isEmpty()) {
+        // Replay a recorded session instead of free-running; the movie brings its own state
+        const QJsonObject playback = emulator.playMovie(movie, true);
+        result["movie"] = playback;
+        if (playback.contains("error")) {
+            return fail(playback.value("error").toString());
+        }
+        result["frames"] = playback.value("frames");
+        result["elapsed_ms"] = playback.value("elapsed_ms");
+        result["speed_x"] = playback.value("speed_x");
+        result["breakpoint_hit"] = false;
+        if (playback.value("mismatches").toInt() > 0) {
+            return fail(QString("movie diverged at frame %1")
+                            .arg(playback.value("first_mismatch_frame").toVariant().toLongLong()));
+        }
+    } else {
+        const int frames = job.value("frames").toInt(600);
+        QElapsedTimer timer;
+        timer.start();
+        int framesRun = 0;
+        bool expectationsMet = false;
+        // With check_every the case ends as soon as its expectations hold, so a
+        // title that reaches its title screen early does not run out its frames
+        const int chunk = scenario.hasExpectations() && scenario.checkEvery > 0 ? scenario.checkEvery : frames;
+        while (framesRun < frames) {
+            const int wanted = qMin(chunk, frames - framesRun);
+            const int ran = emulator.runFramesUnpaced(wanted);
+            framesRun += ran;
+            if (ran < wanted) {
+                break;  // breakpoint or a scheduled "pause"
+            }
+            if (chunk < frames && verifyScenario().value("ok").toBool()) {
+                expectationsMet = true;
+                break;
+            }
+        }
+        const qint64 elapsedMs = timer.elapsed();
+
+        result["frames"] = framesRun;
+        result["elapsed_ms"] = elapsedMs;
+        result["speed_x"] = elapsedMs > 0 ? (framesRun * emulator.getFrameTimeMs()) / elapsedMs : 0.0;
+        result["breakpoint_hit"] = framesRun < frames && !expectationsMet;
+        if (scenario.checkEvery > 0 && scenario.hasExpectations()) {
+            result["expectations_met_early"] = expectationsMet;
+        }
+    }
+    if (!scenario.actions.isEmpty()) {
+        result["actions_run"] = actionsRun;
+    }
+    QJsonObject verification;
+    if (scenario.hasExpectations()) {
+        verification = verifyScenario();
+        result["expect"] = verification;
+    }
+    result["pc"] = CPU_regPC;
+    result["memory_sha1"] = QString::fromLatin1(
+        QCryptographicHash::hash(QByteArray::fromRawData(reinterpret_cast<const char*>(MEMORY_mem), 65536),
+                                 QCryptographicHash::Sha1).toHex());
+
+    const QString screenshot = resolvePath(jobFile, job.value("screenshot").toString());
+    if (!screenshot.isEmpty()) {
+        QDir().mkpath(QFileInfo(screenshot).absolutePath());
+        if (!emulator.renderCurrentFrame().save(screenshot)) {
+            return fail(QString("cannot write screenshot %1").arg(screenshot));
+        }
+    }
+    const QString memory = resolvePath(jobFile, job.value("memory").toString());
+    if (!memory.isEmpty()) {
+        QDir().mkpath(QFileInfo(memory).absolutePath());
+        QFile dump(memory);
+        if (!dump.open(QIODevice::WriteOnly) ||
+            dump.write(reinterpret_cast<const char*>(MEMORY_mem), 65536) != 65536) {
+            return fail(QString("cannot write memory dump %1").arg(memory));
+        }
+    }
+    const QString state = resolvePath(jobFile, job.value("state").toString());
+    if (!state.isEmpty()) {
+        QDir().mkpath(QFileInfo(state).absolutePath());
+        if (!emulator.saveState(state)) {
+            return fail(QString("cannot write state %1").arg(state));
+        }
+    }
+
+    if (!checksums.isEmpty()) {
+        emulator.stopFrameChecksums();
+        result["checksums"] = checksums;
+    }
+
+    emulator.shutdown();
+    // Outputs are written for failed expectations too, to look at what the case saw
+    if (!verification.isEmpty() && !verification.value("ok").toBool()) {
+        return fail(verification.value("failures").toArray().at(0).toString());
+    }
+    result["ok"] = true;
+    result["total_ms"] = caseClock.elapsed();
+    printJsonLine(result);
+    return 0;
+}
@@ -0,0 +1,120 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "hibernateimage.h"
+
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QtEndian>
+#include <QDebug>
+
+namespace {
+
+const QByteArray kMagic("FUJIHBR1");
+constexpr int kLengthBytes = 4;
+
+qint64 stateOffset(quint32 metadataLength)
+{
+    const qint64 end = kMagic.size() + kLengthBytes + static_cast<qint64>(metadataLength);
+    const qint64 alignment = HibernateImage::kStateAlignment;
+    return (end + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+HibernateImage::~HibernateImage()
+{
+    close();
+}
+
+bool HibernateImage::write(const QString& path, const QJsonObject& metadata, const QByteArray& state)
+{
+    if (state.isEmpty()) {
+        return false;
+    }
+    QJsonObject header = metadata;
+    header["state_size"] = state.size();
+    const QByteArray json = QJsonDocument(header).toJson(QJsonDocument::Compact);
+
+    QByteArray prefix = kMagic;
+    prefix.resize(kMagic.size() + kLengthBytes);
+    qToLittleEndian<quint32>(static_cast<quint32>(json.size()), prefix.data() + kMagic.size());
+    prefix += json;
+    prefix.append(static_cast<int>(stateOffset(static_cast<quint32>(json.size())) - prefix.size()), '\0');
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to open hibernate image for writing:" << path << file.errorString();
+        return false;
+    }
+    if (file.write(prefix) != prefix.size() || file.write(state) != state.size() || !file.commit()) {
+        qWarning() << "Failed to write hibernate image:" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool HibernateImage::open(const QString& path)
+{
+    close();
+    m_error.clear();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return fail(m_file.errorString());
+    }
+    const qint64 size = m_file.size();
+    if (size < kMagic.size() + kLengthBytes) {
+        return fail("truncated header");
+    }
+    m_mapping = m_file.map(0, size);
+    if (!m_mapping) {
+        return fail("cannot map: " + m_file.errorString());
+    }
+    if (QByteArray::fromRawData(reinterpret_cast<const char*>(m_mapping), kMagic.size()) != kMagic) {
+        return fail("not a hibernate image");
+    }
+    const quint32 metadataLength = qFromLittleEndian<quint32>(m_mapping + kMagic.size());
+    const qint64 offset = stateOffset(metadataLength);
+    if (metadataLength > kMaxMetadataBytes || offset > size) {
+        return fail("truncated metadata");
+    }
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(
+        QByteArray::fromRawData(reinterpret_cast<const char*>(m_mapping) + kMagic.size() + kLengthBytes,
+                                static_cast<int>(metadataLength)),
+        &parseError);
+    if (!document.isObject()) {
+        return fail("bad metadata: " + parseError.errorString());
+    }
+    const qint64 stateSize = document.object()["state_size"].toVariant().toLongLong();
+    if (stateSize <= 0 || offset + stateSize > size) {
+        return fail("truncated state");
+    }
+    m_metadata = document.object();
+    m_stateSize = stateSize;
+    m_state = m_mapping + offset;
+    return true;
+}
+
+void HibernateImage::close()
+{
+    if (m_mapping) {
+        m_file.unmap(m_mapping);
+        m_mapping = nullptr;
+    }
+    m_file.close();
+    m_state = nullptr;
+    m_stateSize = 0;
+    m_metadata = QJsonObject();
+}
+
+bool HibernateImage::fail(const QString& error)
+{
+    close();
+    m_error = error;
+    return false;
+}
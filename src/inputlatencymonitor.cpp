@@ -0,0 +1,136 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "inputlatencymonitor.h"
+#include <QMutexLocker>
+
+InputLatencyMonitor::InputLatencyMonitor()
+{
+    for (std::atomic<qint64>& pending : m_pending) {
+        pending.store(0, std::memory_order_relaxed);
+    }
+}
+
+void InputLatencyMonitor::setEnabled(bool enabled)
+{
+    if (!enabled) {
+        for (std::atomic<qint64>& pending : m_pending) {
+            pending.store(0, std::memory_order_relaxed);
+        }
+    }
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void InputLatencyMonitor::markInput(Source source)
+{
+    if (!isEnabled() || source < 0 || source >= kSourceCount) {
+        return;
+    }
+    // Keep the oldest input: later ones reach the same frame no sooner
+    qint64 expected = 0;
+    m_pending[source].compare_exchange_strong(expected, LatencyHistogram::nowMicroseconds(),
+                                              std::memory_order_relaxed);
+}
+
+void InputLatencyMonitor::beginFrame()
+{
+    for (int source = 0; source < kSourceCount; ++source) {
+        m_claimed[source] = isEnabled() ? m_pending[source].exchange(0, std::memory_order_relaxed) : 0;
+    }
+}
+
+void InputLatencyMonitor::endFrame(quint64 frame)
+{
+    bool any = false;
+    for (qint64 claimed : m_claimed) {
+        any = any || claimed != 0;
+    }
+    if (!any) {
+        return;
+    }
+    const qint64 now = LatencyHistogram::nowMicroseconds();
+    QMutexLocker locker(&m_mutex);
+    for (int source = 0; source < kSourceCount; ++source) {
+        if (m_claimed[source] == 0) {
+            continue;
+        }
+        m_toFrame[source].record(now - m_claimed[source]);
+        if (m_inFlight.size() >= kMaxInFlight) {
+            m_inFlight.removeFirst();  // nothing painted for a long time (minimised, headless)
+            m_unpresented++;
+        }
+        m_inFlight.append({frame, m_claimed[source], now, source});
+        m_claimed[source] = 0;
+    }
+    m_inFlightCount.store(m_inFlight.size(), std::memory_order_release);
+}
+
+void InputLatencyMonitor::framePresented(quint64 frame)
+{
+    if (m_inFlightCount.load(std::memory_order_acquire) == 0) {
+        return;
+    }
+    const qint64 now = LatencyHistogram::nowMicroseconds();
+    QMutexLocker locker(&m_mutex);
+    // A later frame carries the effect of every earlier input with it
+    int kept = 0;
+    for (const InFlight& entry : m_inFlight) {
+        if (entry.frame <= frame) {
+            m_toPresent[entry.source].record(now - entry.inputUs);
+            m_frameToPresent.record(now - entry.consumedUs);
+        } else {
+            m_inFlight[kept++] = entry;
+        }
+    }
+    m_inFlight.resize(kept);
+    m_inFlightCount.store(kept, std::memory_order_release);
+}
+
+QJsonObject InputLatencyMonitor::toJson() const
+{
+    QMutexLocker locker(&m_mutex);
+    QJsonObject sources;
+    for (int source = 0; source < kSourceCount; ++source) {
+        QJsonObject stages;
+        stages["to_frame"] = m_toFrame[source].toJson();
+        stages["to_present"] = m_toPresent[source].toJson();
+        sources[sourceName(static_cast<Source>(source))] = stages;
+    }
+    QJsonObject json;
+    json["enabled"] = isEnabled();
+    json["sources"] = sources;
+    json["frame_to_present"] = m_frameToPresent.toJson();
+    json["unpresented"] = static_cast<qint64>(m_unpresented);
+    return json;
+}
+
+void InputLatencyMonitor::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    for (int source = 0; source < kSourceCount; ++source) {
+        m_toFrame[source].reset();
+        m_toPresent[source].reset();
+    }
+    m_frameToPresent.reset();
+    m_inFlight.clear();
+    m_inFlightCount.store(0, std::memory_order_release);
+    m_unpresented = 0;
+}
+
+QString InputLatencyMonitor::sourceName(Source source)
+{
+    switch (source) {
+    case Keyboard:
+        return "keyboard";
+    case Joystick:
+        return "joystick";
+    case SdlJoystick:
+        return "sdl_joystick";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,236 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "inputmovie.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+const char kFileMagic[8] = {'F', 'J', 'M', 'O', 'V', 'I', 'E', '1'};
+constexpr int kChecksumBytes = 24;
+
+void append32(QByteArray& out, quint32 value)
+{
+    uchar bytes[4];
+    qToLittleEndian(value, bytes);
+    out.append(reinterpret_cast<const char*>(bytes), 4);
+}
+
+void append64(QByteArray& out, quint64 value)
+{
+    uchar bytes[8];
+    qToLittleEndian(value, bytes);
+    out.append(reinterpret_cast<const char*>(bytes), 8);
+}
+
+quint32 get32(const char* p)
+{
+    return qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(p));
+}
+
+quint64 get64(const char* p)
+{
+    return qFromLittleEndian<quint64>(reinterpret_cast<const uchar*>(p));
+}
+
+bool fail(QString* error, const QString& message)
+{
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+
+}  // namespace
+
+void InputMovie::begin(const QByteArray& state, int inputSize, int verifyInterval)
+{
+    clear();
+    m_state = state;
+    m_inputSize = qMax(1, inputSize);
+    m_verifyInterval = qMax(0, verifyInterval);
+}
+
+void InputMovie::clear()
+{
+    m_state.clear();
+    m_inputSize = 0;
+    m_verifyInterval = 0;
+    m_frames = 0;
+    m_runs.clear();
+    m_checksums.clear();
+}
+
+void InputMovie::appendFrame(const void* input)
+{
+    if (!m_runs.isEmpty()) {
+        Run& last = m_runs.last();
+        if (last.frames < 0xFFFFFFFFu && std::memcmp(last.input.constData(), input, m_inputSize) == 0) {
+            last.frames++;
+            m_frames++;
+            return;
+        }
+    }
+    Run run;
+    run.frames = 1;
+    run.input = QByteArray(static_cast<const char*>(input), m_inputSize);
+    m_runs.append(run);
+    m_frames++;
+}
+
+bool InputMovie::checksumDue() const
+{
+    return m_verifyInterval > 0 && m_frames > 0 && m_frames % quint64(m_verifyInterval) == 0;
+}
+
+void InputMovie::addChecksum(quint64 ram, quint64 screen)
+{
+    Checksum checksum;
+    checksum.frame = m_frames;
+    checksum.ram = ram;
+    checksum.screen = screen;
+    m_checksums.append(checksum);
+}
+
+bool InputMovie::save(const QString& path, QString* error) const
+{
+    QByteArray out;
+    out.reserve(kHeaderBytes + m_state.size() + m_runs.size() * (4 + m_inputSize)
+                + m_checksums.size() * kChecksumBytes);
+    out.append(kFileMagic, sizeof(kFileMagic));
+    append32(out, kVersion);
+    append32(out, kHeaderBytes);
+    append32(out, static_cast<quint32>(m_inputSize));
+    append32(out, static_cast<quint32>(m_verifyInterval));
+    append64(out, m_frames);
+    append32(out, static_cast<quint32>(m_state.size()));
+    append32(out, static_cast<quint32>(m_runs.size()));
+    append32(out, static_cast<quint32>(m_checksums.size()));
+    append32(out, 0);
+    out.append(m_state);
+    for (const Run& run : m_runs) {
+        append32(out, run.frames);
+        out.append(run.input);
+    }
+    for (const Checksum& checksum : m_checksums) {
+        append64(out, checksum.frame);
+        append64(out, checksum.ram);
+        append64(out, checksum.screen);
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return fail(error, QString("Cannot create movie file: %1").arg(file.errorString()));
+    }
+    if (file.write(out) != out.size() || !file.commit()) {
+        return fail(error, QString("Cannot write movie file: %1").arg(file.errorString()));
+    }
+    return true;
+}
+
+bool InputMovie::load(const QString& path, QString* error)
+{
+    clear();
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(error, QString("Cannot open movie file: %1").arg(file.errorString()));
+    }
+    const QByteArray data = file.readAll();
+    const char* p = data.constData();
+    if (data.size() < kHeaderBytes || std::memcmp(p, kFileMagic, sizeof(kFileMagic)) != 0) {
+        return fail(error, "Not a Fujisan movie file");
+    }
+    if (get32(p + 8) != kVersion) {
+        return fail(error, QString("Unsupported movie version %1").arg(get32(p + 8)));
+    }
+    const quint32 headerBytes = get32(p + 12);
+    const quint32 inputSize = get32(p + 16);
+    const quint32 verifyInterval = get32(p + 20);
+    const quint64 frames = get64(p + 24);
+    const quint32 stateSize = get32(p + 32);
+    const quint32 runs = get32(p + 36);
+    const quint32 checksums = get32(p + 40);
+    const quint64 expected = quint64(headerBytes) + stateSize + quint64(runs) * (4 + quint64(inputSize))
+                             + quint64(checksums) * kChecksumBytes;
+    if (headerBytes < kHeaderBytes || inputSize == 0 || expected != quint64(data.size())) {
+        return fail(error, "Movie file is truncated or corrupt");
+    }
+
+    const char* cursor = p + headerBytes;
+    m_state = QByteArray(cursor, int(stateSize));
+    cursor += stateSize;
+    m_inputSize = int(inputSize);
+    m_verifyInterval = int(verifyInterval);
+    m_runs.reserve(int(runs));
+    quint64 framesInRuns = 0;
+    for (quint32 i = 0; i < runs; ++i) {
+        Run run;
+        run.frames = get32(cursor);
+        run.input = QByteArray(cursor + 4, m_inputSize);
+        cursor += 4 + m_inputSize;
+        framesInRuns += run.frames;
+        m_runs.append(run);
+    }
+    m_checksums.reserve(int(checksums));
+    for (quint32 i = 0; i < checksums; ++i) {
+        Checksum checksum;
+        checksum.frame = get64(cursor);
+        checksum.ram = get64(cursor + 8);
+        checksum.screen = get64(cursor + 16);
+        cursor += kChecksumBytes;
+        m_checksums.append(checksum);
+    }
+    if (framesInRuns != frames) {
+        clear();
+        return fail(error, "Movie file is truncated or corrupt");
+    }
+    m_frames = frames;
+    return true;
+}
+
+bool InputMovie::Player::nextFrame(void* input)
+{
+    const QVector<Run>& runs = m_movie.m_runs;
+    while (m_run < runs.size() && m_usedInRun >= runs[m_run].frames) {
+        m_run++;
+        m_usedInRun = 0;
+    }
+    if (m_run >= runs.size()) {
+        return false;
+    }
+    std::memcpy(input, runs[m_run].input.constData(), static_cast<size_t>(m_movie.m_inputSize));
+    m_usedInRun++;
+    m_frame++;
+    return true;
+}
+
+const InputMovie::Checksum* InputMovie::Player::checksumAfterFrame()
+{
+    const QVector<Checksum>& checksums = m_movie.m_checksums;
+    while (m_checksum < checksums.size() && checksums[m_checksum].frame < m_frame) {
+        m_checksum++;
+    }
+    if (m_checksum < checksums.size() && checksums[m_checksum].frame == m_frame) {
+        return &checksums[m_checksum++];
+    }
+    return nullptr;
+}
+
+quint64 InputMovie::checksum(const void* data, int size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    quint64 hash = 14695981039346656037ull;
+    for (int i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
@@ -0,0 +1,229 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "jsonmessageframer.h"
+#include <QtEndian>
+
+namespace {
+
+// Consumed bytes are only dropped once they outweigh what is left, so a burst of
+// small messages costs one memmove per read instead of one per message.
+constexpr int kCompactThreshold = 4096;
+
+bool isFramingWhitespace(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+}
+
+}  // namespace
+
+void JsonMessageFramer::setFraming(Framing framing)
+{
+    m_framing = framing;
+    resetScan();
+    m_scanPos = m_readPos;
+}
+
+bool JsonMessageFramer::parseFraming(const QString& name, Framing* framing)
+{
+    if (name == "json") {
+        *framing = FramingBraces;
+    } else if (name == "newline") {
+        *framing = FramingNewline;
+    } else if (name == "length") {
+        *framing = FramingLengthPrefixed;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QString JsonMessageFramer::framingName(Framing framing)
+{
+    switch (framing) {
+    case FramingNewline:
+        return "newline";
+    case FramingLengthPrefixed:
+        return "length";
+    case FramingBraces:
+    default:
+        return "json";
+    }
+}
+
+void JsonMessageFramer::append(const QByteArray& data)
+{
+    m_buffer.append(data);
+}
+
+void JsonMessageFramer::clear()
+{
+    m_buffer.clear();
+    m_readPos = 0;
+    m_scanPos = 0;
+    resetScan();
+}
+
+JsonMessageFramer::Result JsonMessageFramer::next(QByteArray& message, QString& error)
+{
+    switch (m_framing) {
+    case FramingNewline:
+        return nextLine(message, error);
+    case FramingLengthPrefixed:
+        return nextLengthPrefixed(message, error);
+    case FramingBraces:
+    default:
+        return nextBraces(message, error);
+    }
+}
+
+JsonMessageFramer::Result JsonMessageFramer::nextBraces(QByteArray& message, QString& error)
+{
+    const int size = m_buffer.size();
+    const char* data = m_buffer.constData();
+
+    if (m_messageStart < 0) {
+        while (m_scanPos < size && isFramingWhitespace(data[m_scanPos])) {
+            m_scanPos++;
+        }
+        m_readPos = m_scanPos;
+        if (m_scanPos >= size) {
+            compact();
+            return NeedMoreData;
+        }
+        if (data[m_scanPos] != '{') {
+            // Skip the rest of the line, or everything if there is no line end yet
+            const int newlinePos = m_buffer.indexOf('\n', m_scanPos);
+            if (newlinePos == -1) {
+                clear();
+                error = "Invalid JSON format (expected '{' at start)";
+                return FramingError;
+            }
+            error = "Invalid JSON format (expected '{' at start): " +
+                    QString::fromUtf8(m_buffer.mid(m_scanPos, newlinePos - m_scanPos).trimmed());
+            consume(newlinePos + 1);
+            return FramingError;
+        }
+        m_messageStart = m_scanPos;
+    }
+
+    for (; m_scanPos < size; ++m_scanPos) {
+        const char ch = data[m_scanPos];
+        if (m_escapeNext) {
+            m_escapeNext = false;
+            continue;
+        }
+        if (m_inString) {
+            if (ch == '\\') {
+                m_escapeNext = true;
+            } else if (ch == '"') {
+                m_inString = false;
+            }
+            continue;
+        }
+        if (ch == '"') {
+            m_inString = true;
+        } else if (ch == '{') {
+            m_depth++;
+        } else if (ch == '}' && --m_depth == 0) {
+            message = m_buffer.mid(m_messageStart, m_scanPos - m_messageStart + 1);
+            consume(m_scanPos + 1);
+            return MessageReady;
+        }
+    }
+
+    if (size - m_messageStart > kMaxMessageSize) {
+        clear();
+        error = "JSON message too large or incomplete (>1MB)";
+        return FramingError;
+    }
+    compact();
+    return NeedMoreData;
+}
+
+JsonMessageFramer::Result JsonMessageFramer::nextLine(QByteArray& message, QString& error)
+{
+    while (true) {
+        const int newlinePos = m_buffer.indexOf('\n', m_scanPos);
+        if (newlinePos == -1) {
+            m_scanPos = m_buffer.size();
+            if (pendingBytes() > kMaxMessageSize) {
+                clear();
+                error = "JSON message too large or incomplete (>1MB)";
+                return FramingError;
+            }
+            compact();
+            return NeedMoreData;
+        }
+        const QByteArray line = m_buffer.mid(m_readPos, newlinePos - m_readPos).trimmed();
+        consume(newlinePos + 1);
+        if (!line.isEmpty()) {
+            message = line;
+            return MessageReady;
+        }
+    }
+}
+
+JsonMessageFramer::Result JsonMessageFramer::nextLengthPrefixed(QByteArray& message, QString& error)
+{
+    while (pendingBytes() >= 4) {
+        const quint32 length =
+            qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(m_buffer.constData()) + m_readPos);
+        if (length > static_cast<quint32>(kMaxMessageSize)) {
+            // No way to find the next frame boundary; start over with the next read
+            clear();
+            error = QString("Message length %1 exceeds the 1MB limit").arg(length);
+            return FramingError;
+        }
+        if (pendingBytes() - 4 < static_cast<int>(length)) {
+            break;
+        }
+        const int start = m_readPos + 4;
+        consume(start + static_cast<int>(length));
+        if (length > 0) {
+            message = m_buffer.mid(start, static_cast<int>(length));
+            return MessageReady;
+        }
+    }
+    m_scanPos = m_readPos;
+    compact();
+    return NeedMoreData;
+}
+
+void JsonMessageFramer::consume(int endPos)
+{
+    m_readPos = endPos;
+    m_scanPos = endPos;
+    resetScan();
+}
+
+void JsonMessageFramer::resetScan()
+{
+    m_messageStart = -1;
+    m_depth = 0;
+    m_inString = false;
+    m_escapeNext = false;
+}
+
+void JsonMessageFramer::compact()
+{
+    if (m_readPos >= m_buffer.size()) {
+        m_buffer.clear();
+        m_readPos = 0;
+        m_scanPos = 0;
+        return;
+    }
+    if (m_readPos < kCompactThreshold || m_readPos * 2 < m_buffer.size()) {
+        return;
+    }
+    m_buffer.remove(0, m_readPos);
+    m_scanPos -= m_readPos;
+    if (m_messageStart >= 0) {
+        m_messageStart -= m_readPos;
+    }
+    m_readPos = 0;
+}
@@ -0,0 +1,77 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "latencyhistogram.h"
+#include <chrono>
+
+namespace {
+
+int bucketFor(qint64 microseconds)
+{
+    int bucket = 0;
+    quint64 value = static_cast<quint64>(microseconds);
+    while (value > 1 && bucket < LatencyHistogram::kBuckets - 1) {
+        value >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+}  // namespace
+
+qint64 LatencyHistogram::nowMicroseconds()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LatencyHistogram::record(qint64 microseconds)
+{
+    microseconds = qMax<qint64>(0, microseconds);
+    m_buckets[bucketFor(microseconds)]++;
+    m_count++;
+    m_total += microseconds;
+    m_max = qMax(m_max, microseconds);
+}
+
+void LatencyHistogram::reset()
+{
+    *this = LatencyHistogram();
+}
+
+qint64 LatencyHistogram::percentile(double fraction) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+    const quint64 rank = qMax<quint64>(1, static_cast<quint64>(fraction * m_count + 0.5));
+    quint64 seen = 0;
+    for (int bucket = 0; bucket < kBuckets; ++bucket) {
+        seen += m_buckets[bucket];
+        if (seen >= rank) {
+            if (bucket == kBuckets - 1) {
+                return m_max;  // the last bucket is open-ended
+            }
+            const qint64 upper = bucket == 0 ? 1 : (qint64(1) << (bucket + 1)) - 1;
+            return qMin(upper, m_max);
+        }
+    }
+    return m_max;
+}
+
+QJsonObject LatencyHistogram::toJson() const
+{
+    QJsonObject json;
+    json["count"] = static_cast<qint64>(m_count);
+    json["total_us"] = m_total;
+    json["mean_us"] = m_count ? static_cast<double>(m_total) / m_count : 0.0;
+    json["max_us"] = m_max;
+    json["p50_us"] = percentile(0.50);
+    json["p90_us"] = percentile(0.90);
+    json["p99_us"] = percentile(0.99);
+    return json;
+}
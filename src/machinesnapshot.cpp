@@ -0,0 +1,162 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "machinesnapshot.h"
+
+namespace {
+
+struct SectionName {
+    MachineSnapshot::Section section;
+    const char* name;
+};
+
+const SectionName kSectionNames[] = {
+    {MachineSnapshot::CpuMemory, "memory"},
+    {MachineSnapshot::ExtendedRam, "extended"},
+    {MachineSnapshot::CartridgeImage, "cartridge"},
+};
+
+}  // namespace
+
+QByteArray MachineSnapshot::bank(int index) const
+{
+    if (index == 0) {
+        return memory;
+    }
+    if (index < 1 || index > extendedBanks || extendedRam.size() < index * kBankSize) {
+        return QByteArray();
+    }
+    return extendedRam.mid((index - 1) * kBankSize, kBankSize);
+}
+
+QByteArray MachineSnapshot::cartridgeBank(int index, int bankSize) const
+{
+    if (index < 0 || bankSize <= 0 || qint64(index + 1) * bankSize > cartridge.size()) {
+        return QByteArray();
+    }
+    return cartridge.mid(index * bankSize, bankSize);
+}
+
+QString MachineSnapshot::chipName(Chip chip)
+{
+    switch (chip) {
+    case Antic:
+        return "antic";
+    case Gtia:
+        return "gtia";
+    case Pokey:
+        return "pokey";
+    default:
+        return "pia";
+    }
+}
+
+QStringList MachineSnapshot::registerNames(Chip chip)
+{
+    switch (chip) {
+    case Antic:
+        return {"DMACTL", "CHACTL", "DLISTL", "DLISTH", "HSCROL", "VSCROL", "PMBASE", "CHBASE",
+                "VCOUNT", "NMIEN", "NMIST"};
+    case Gtia:
+        return {"HPOSP0", "HPOSP1", "HPOSP2", "HPOSP3", "HPOSM0", "HPOSM1", "HPOSM2", "HPOSM3",
+                "SIZEP0", "SIZEP1", "SIZEP2", "SIZEP3", "SIZEM", "GRAFP0", "GRAFP1", "GRAFP2",
+                "GRAFP3", "GRAFM", "COLPM0", "COLPM1", "COLPM2", "COLPM3", "COLPF0", "COLPF1",
+                "COLPF2", "COLPF3", "COLBK", "PRIOR", "VDELAY", "GRACTL"};
+    case Pokey:
+        return {"AUDF1", "AUDC1", "AUDF2", "AUDC2", "AUDF3", "AUDC3", "AUDF4", "AUDC4", "AUDCTL",
+                "KBCODE", "IRQEN", "IRQST", "SKCTL", "SKSTAT"};
+    default:
+        return {"PORTA", "PORTB", "PACTL", "PBCTL"};
+    }
+}
+
+int MachineSnapshot::registerValue(Chip chip, const QString& name) const
+{
+    const int index = registerNames(chip).indexOf(name);
+    if (index < 0 || index >= registers[chip].size()) {
+        return -1;
+    }
+    return static_cast<quint8>(registers[chip].at(index));
+}
+
+QJsonObject MachineSnapshot::toJson() const
+{
+    QJsonObject result;
+    result["frame"] = static_cast<double>(frame);
+
+    QJsonObject cpu;
+    cpu["pc"] = pc;
+    cpu["a"] = a;
+    cpu["x"] = x;
+    cpu["y"] = y;
+    cpu["s"] = s;
+    cpu["p"] = p;
+    result["cpu"] = cpu;
+
+    result["extended_banks"] = extendedBanks;
+    result["mapped_bank"] = mappedBank;
+
+    QJsonObject cart;
+    cart["type"] = cartridgeType;
+    if (cartridgeType != 0) {
+        cart["state"] = cartridgeState;
+        cart["size"] = cartridgeSize;
+    }
+    result["cartridge"] = cart;
+
+    QJsonObject chips;
+    for (int chip = 0; chip < ChipCount; ++chip) {
+        const QStringList names = registerNames(static_cast<Chip>(chip));
+        QJsonObject values;
+        for (int i = 0; i < names.size() && i < registers[chip].size(); ++i) {
+            values[names[i]] = static_cast<quint8>(registers[chip].at(i));
+        }
+        chips[chipName(static_cast<Chip>(chip))] = values;
+    }
+    result["registers"] = chips;
+    return result;
+}
+
+QByteArray MachineSnapshot::payload(int wanted, QJsonArray* layout) const
+{
+    QByteArray data;
+    for (const SectionName& section : kSectionNames) {
+        if (!(wanted & sections & section.section)) {
+            continue;
+        }
+        const QByteArray& bytes = section.section == CpuMemory ? memory
+                                  : section.section == ExtendedRam ? extendedRam : cartridge;
+        if (layout) {
+            QJsonObject entry;
+            entry["section"] = QString::fromLatin1(section.name);
+            entry["offset"] = data.size();
+            entry["length"] = bytes.size();
+            layout->append(entry);
+        }
+        data.append(bytes);
+    }
+    return data;
+}
+
+bool MachineSnapshot::parseSections(const QStringList& names, int* sections)
+{
+    int result = 0;
+    for (const QString& name : names) {
+        bool found = false;
+        for (const SectionName& section : kSectionNames) {
+            if (name == QLatin1String(section.name)) {
+                result |= section.section;
+                found = true;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    *sections = result;
+    return true;
+}
@@ -21,6 +21,10 @@
 #include <QResizeEvent>
 #include <QKeyEvent>
 #include <QPlainTextEdit>
+#include <QPushButton>
+#include <QFontDatabase>
+#include <QJsonArray>
+#include <QJsonObject>
 #include <QTextEdit>
 #include <QStatusBar>
 #include <QVBoxLayout>
@@ -30,16 +34,22 @@
 #include <QTimer>
 #include <QThread>
 #include <QFileDialog>
+#include <QFile>
 #include <QFileInfo>
 #include <QDateTime>
 #include <QMetaObject>
 #include <QElapsedTimer>
 #include <QCoreApplication>
 #include <QProcess>
+#include <QScreen>
+#include <climits>
+#include <memory>
 
 #include "fujinetprocessmanager.h"
 #include "fujinetbinarymanager.h"
 #include "fujinetwidget.h"
+#include "startuptrace.h"
+#include "medialibrarywidget.h"
 
 // Debug control - uncomment to enable verbose disk I/O logging
 // #define DEBUG_DISK_IO
@@ -73,6 +83,42 @@ JoystickSettingsSnapshot readJoystickSettingsSnapshot(QSettings& settings)
     return sn;
 }
 
+// speedToggleOn: toolbar MAX toggle state (independent from host-speed setting)
+// turboMode: "Run as fast as possible (Host Speed)" from settings dialog
+int readSpeedPercentage(QSettings& settings)
+{
+    bool speedToggleOn = settings.value("machine/speedToggleOn", false).toBool();
+    bool turboMode = settings.value("machine/turboMode", false).toBool();
+    int speedIndex = settings.value("machine/emulationSpeedIndex", 1).toInt();
+    if (speedToggleOn) {
+        return turboMode ? 0 : 1000; // host speed vs 10x
+    }
+    return speedIndex == 0 ? 50 : speedIndex * 100;
+}
+
+// What restartEmulator() would pass to libatari800_init, keyed like
+// AtariEmulator::bootConfig(), so the two can be compared
+QJsonObject readBootConfig(QSettings& settings)
+{
+    QJsonObject config;
+    const QString machineType = settings.value("machine/type", "-xl").toString();
+    config["machine_type"] = machineType;
+    config["video_system"] = settings.value("machine/videoSystem", "-pal").toString();
+    config["basic_enabled"] = settings.value("machine/basicEnabled", true).toBool();
+    config["os_rom_path"] = settings.value(QString("machine/osRom_%1").arg(machineType.mid(1)), "").toString();
+    config["basic_rom_path"] = settings.value("machine/basicRom", "").toString();
+    config["horizontal_area"] = settings.value("video/horizontalArea", "full").toString();
+    config["vertical_area"] = settings.value("video/verticalArea", "full").toString();
+    config["horizontal_shift"] = settings.value("video/horizontalShift", 0).toInt();
+    config["vertical_shift"] = settings.value("video/verticalShift", 0).toInt();
+    config["fit_screen"] = settings.value("video/fitScreen", "both").toString();
+    config["show_80_column"] = settings.value("video/show80Column", false).toBool();
+    config["vsync"] = settings.value("video/vSyncEnabled", false).toBool();
+    config["netsio"] = settings.value("media/netSIOEnabled", false).toBool();
+    config["rtime"] = settings.value("media/rtimeEnabled", false).toBool();
+    return config;
+}
+
 /* Quit: netsio_shutdown() unblock + finalizeShutdown usually completes in well under 1s.
  * Cap GUI wait before QThread::terminate() so closing the window does not sit at 8s. */
 constexpr int kEmulatorThreadQuitWaitMs = 2500;
@@ -80,6 +126,9 @@ constexpr int kPostTerminatePollIterations = 25; /* 25 * kPostTerminatePollInter
 constexpr int kPostTerminatePollIntervalMs = 100;
 constexpr int kFujiNetOrphanKillWaitMs = 800;
 
+/* Pastes at least this long are typed at host speed (see AtariEmulator::queueText). */
+constexpr int kPasteTurboThreshold = 256;
+
 } // namespace
 
 MainWindow::MainWindow(QWidget *parent)
@@ -100,9 +149,6 @@ MainWindow::MainWindow(QWidget *parent)
     , m_fullscreenWidget(nullptr)
     , m_fullscreenEmulatorWidget(nullptr)
     , m_netSIOEnabled(false)
-    , m_pasteTimer(new QTimer(this))
-    , m_pasteIndex(0)
-    , m_originalEmulationSpeed(100)
     , m_profileManager(new ConfigurationProfileManager(this))
     , m_diskDrive1(nullptr)
     , m_mediaPeripheralsDock(nullptr)
@@ -110,6 +156,11 @@ MainWindow::MainWindow(QWidget *parent)
     , m_mediaToggleButton(nullptr)
     , m_logoLabel(nullptr)
     , m_fastbasicBuildPanel(nullptr)
+    , m_debuggerWidget(nullptr)
+    , m_debuggerDock(nullptr)
+    , m_mediaLibrary(nullptr)
+    , m_mediaLibraryWidget(nullptr)
+    , m_mediaLibraryDock(nullptr)
 {
     setWindowTitle(QString("Fujisan %1").arg(FUJISAN_VERSION));
     setMinimumSize(800, 600);
@@ -123,32 +174,53 @@ MainWindow::MainWindow(QWidget *parent)
     // Style dock areas to be black so they blend with emulator widget background
     setStyleSheet("QMainWindow::separator { background: black; width: 0px; height: 0px; }");
 
-    createMenus();
-    createToolBar();
-    createEmulatorWidget();
-    createDebugger();
-    createMediaPeripheralsDock();
-    createStatusBarWidgets();
+    {
+        StartupTrace::Scope trace("create_widgets");
+        createMenus();
+        createToolBar();
+        createEmulatorWidget();
+        createMediaPeripheralsDock();
+        createStatusBarWidgets();
+    }
 
     // Enable hybrid disk activity system
     m_emulator->setDiskActivityCallback([](int driveNumber, bool isWriting) {
         // Activity callback handled via Qt signals
     });
 
-    // Setup paste timer
-    m_pasteTimer->setSingleShot(false);
-    m_pasteTimer->setInterval(75); // 75ms for character/clear cycle
-    connect(m_pasteTimer, &QTimer::timeout, this, &MainWindow::sendNextCharacter);
-
     // Move the emulator to its worker thread BEFORE loadInitialSettings.
     // loadInitialSettings runs emulator init via BlockingQueuedConnection so
     // all timer starts (frame timer, joystick poll timer) happen on the worker.
     m_emulator->moveToThread(m_emulatorThread);
     connect(m_emulatorThread, &QThread::finished, m_emulator, &QObject::deleteLater);
+    m_emulatorThread->setObjectName("emulator");
     m_emulatorThread->start();
+    // Priority, CPU affinity and precise timing apply to the thread itself
+    QMetaObject::invokeMethod(m_emulator, "applyThreadSchedulingSetting", Qt::QueuedConnection);
+
+    if (StartupTrace::isEnabled()) {
+        // Connected before init so the very first frame is seen
+        auto firstFrame = std::make_shared<QMetaObject::Connection>();
+        *firstFrame = connect(m_emulator, &AtariEmulator::frameReady, this, [firstFrame]() {
+            QObject::disconnect(*firstFrame);
+            StartupTrace::markFirstFrame();
+        });
+    }
 
-    loadInitialSettings();
-    loadVideoSettings();
+    {
+        StartupTrace::Scope trace("loadInitialSettings");
+        loadInitialSettings();
+    }
+    {
+        StartupTrace::Scope trace("loadVideoSettings");
+        loadVideoSettings();
+    }
+    applyPerformanceSettings();
+
+    {
+        StartupTrace::Scope trace("mediaLibrary");
+        createMediaLibrary();
+    }
 
     // Show initial status message
     statusBar()->showMessage("Fujisan ready", 3000);
@@ -159,6 +231,7 @@ MainWindow::MainWindow(QWidget *parent)
     int tcpPort = settings.value("emulator/tcpServerPort", 6502).toInt();
 
     if (tcpEnabled && m_tcpServer && !m_tcpServer->isRunning()) {
+        m_tcpServer->setLocalServerName(settings.value("emulator/localServerName").toString());
         bool success = m_tcpServer->startServer(tcpPort);
         if (success) {
             m_tcpServerAction->setChecked(true);
@@ -318,6 +391,11 @@ void MainWindow::kickEmulatorWorkerShutdown()
     // Stop the frame loop from re-arming; the worker will then run full teardown and
     // re-home the QObject tree to the GUI thread before quitting.
     emu->requestShutdown();
+    const bool hibernate = QSettings("8bitrelics", "Fujisan").value("emulator/hibernateOnQuit", false).toBool();
+    if (!hibernate) {
+        QFile::remove(emu->getHibernatePath());  // never resume into a stale image later
+    }
+    emu->setHibernateOnQuit(hibernate);
 #ifdef NETSIO
     /* Idempotent when !netsio_initialized (atari800 0018); unblocks recv/select if NetSIO was ever on. */
     emu->netsioShutdownFromOtherThreadForQuit();
@@ -746,6 +824,18 @@ void MainWindow::createMenus()
     connect(m_debuggerAction, &QAction::triggered, this, &MainWindow::toggleDebugger);
     viewMenu->addAction(m_debuggerAction);
 
+    m_mediaLibraryAction = new QAction("Media &Library", this);
+    m_mediaLibraryAction->setToolTip("Search the indexed disk, tape, cartridge and executable images");
+    m_mediaLibraryAction->setCheckable(true);
+    connect(m_mediaLibraryAction, &QAction::triggered, this, &MainWindow::toggleMediaLibrary);
+    viewMenu->addAction(m_mediaLibraryAction);
+
+    m_performanceOverlayAction = new QAction("&Performance Overlay", this);
+    m_performanceOverlayAction->setToolTip("Show frame time, emulation speed, audio buffer, SIO wait and GUI stall graphs over the display");
+    m_performanceOverlayAction->setCheckable(true);
+    connect(m_performanceOverlayAction, &QAction::triggered, this, &MainWindow::togglePerformanceOverlay);
+    viewMenu->addAction(m_performanceOverlayAction);
+
     // Tools menu
     QMenu* toolsMenu = menuBar()->addMenu("&Tools");
 
@@ -755,6 +845,11 @@ void MainWindow::createMenus()
     connect(m_tcpServerAction, &QAction::triggered, this, &MainWindow::toggleTCPServer);
     toolsMenu->addAction(m_tcpServerAction);
 
+    m_inputLatencyAction = new QAction("Input &Latency...", this);
+    m_inputLatencyAction->setToolTip("Measure the time from key and joystick input to the frame that shows it");
+    connect(m_inputLatencyAction, &QAction::triggered, this, &MainWindow::showInputLatency);
+    toolsMenu->addAction(m_inputLatencyAction);
+
     // Help menu
     QMenu* helpMenu = menuBar()->addMenu("&Help");
 
@@ -1143,6 +1238,13 @@ void MainWindow::createProfileToolbarSection()
             this, &MainWindow::refreshProfileList);
     connect(m_profileManager, &ConfigurationProfileManager::profileChanged,
             this, &MainWindow::onProfileChanged);
+    // Preload media for the profile being hovered or picked, ahead of LOAD
+    connect(m_profileCombo, QOverload<int>::of(&QComboBox::highlighted), this, [this](int index) {
+        m_profileManager->preloadProfileMedia(m_profileCombo->itemText(index));
+    });
+    connect(m_profileCombo, QOverload<int>::of(&QComboBox::activated), this, [this](int index) {
+        m_profileManager->preloadProfileMedia(m_profileCombo->itemText(index));
+    });
 
     m_toolBar->addWidget(profileContainer);
 }
@@ -1222,22 +1324,41 @@ void MainWindow::createEmulatorWidget()
 
     m_emulatorWidget = new EmulatorWidget(centralWidget);
     m_emulatorWidget->setEmulator(m_emulator);
+    // Turbo presents at most one frame per display refresh
+    if (QScreen* screen = QGuiApplication::primaryScreen()) {
+        m_emulator->setPresentationRate(screen->refreshRate());
+    }
 
     // Make the emulator widget expand to fill all available space
     layout->addWidget(m_emulatorWidget);
 
-    // Fastbasic build panel (one row above status bar; visibility from Settings → Emulator → Fastbasic)
-    m_fastbasicBuildPanel = new FastbasicBuildPanel(this, centralWidget);
-    layout->addWidget(m_fastbasicBuildPanel);
-    QSettings settings("8bitrelics", "Fujisan");
-    m_fastbasicBuildPanel->setVisible(settings.value("fastbasic/buildPanelEnabled", false).toBool());
-
+    // The Fastbasic build panel joins this layout when it is first shown
+    // (see setFastbasicBuildPanelVisible); loadInitialSettings applies the setting
     setCentralWidget(centralWidget);
 
     // Give the emulator widget focus by default
     m_emulatorWidget->setFocus();
 }
 
+void MainWindow::setFastbasicBuildPanelVisible(bool visible)
+{
+    // One row above the status bar (Settings → Emulator → Fastbasic). Most
+    // sessions never enable it, so it is only built when first shown.
+    if (!m_fastbasicBuildPanel) {
+        if (!visible) {
+            return;
+        }
+        QWidget* container = centralWidget();
+        QVBoxLayout* layout = container ? qobject_cast<QVBoxLayout*>(container->layout()) : nullptr;
+        if (!layout) {
+            return;
+        }
+        m_fastbasicBuildPanel = new FastbasicBuildPanel(this, container);
+        layout->addWidget(m_fastbasicBuildPanel);
+    }
+    m_fastbasicBuildPanel->setVisible(visible);
+}
+
 void MainWindow::updateSpeedStatus()
 {
     if (!m_speedStatusLabel || !m_emulator) {
@@ -1284,8 +1405,15 @@ void MainWindow::updateFujiNetStatus()
     m_fujinetStatusLabel->setText(statusText);
 }
 
-void MainWindow::createDebugger()
+DebuggerWidget* MainWindow::ensureDebugger()
 {
+    // Built on first use rather than at startup: the widget disassembles and
+    // refreshes every 100 ms from construction, which is wasted work (and
+    // startup time) while the dock stays hidden, as it does by default.
+    if (m_debuggerWidget) {
+        return m_debuggerWidget;
+    }
+
     // Create debugger widget
     m_debuggerWidget = new DebuggerWidget(m_emulator, this);
 
@@ -1301,13 +1429,138 @@ void MainWindow::createDebugger()
     // Add dock widget to right side by default
     addDockWidget(Qt::RightDockWidgetArea, m_debuggerDock);
 
-    // Hide by default
+    // Hidden until toggled
     m_debuggerDock->hide();
 
     // Connect dock visibility to menu action
     connect(m_debuggerDock, &QDockWidget::visibilityChanged, [this](bool visible) {
         m_debuggerAction->setChecked(visible);
     });
+    return m_debuggerWidget;
+}
+
+void MainWindow::createMediaLibrary()
+{
+    // The index loads synchronously (one JSON file); walking the folders for
+    // new and changed files happens on the library's own thread.
+    m_mediaLibrary = new MediaLibrary(MediaLibrary::defaultIndexPath(), this);
+    m_mediaLibrary->load();
+    QSettings settings("8bitrelics", "Fujisan");
+    m_mediaLibrary->setFolders(settings.value("library/folders").toStringList());
+    seedRomCacheFromLibrary();
+    connect(m_mediaLibrary, &MediaLibrary::scanFinished, this, &MainWindow::seedRomCacheFromLibrary);
+    if (!m_mediaLibrary->folders().isEmpty()) {
+        m_mediaLibrary->rescan();
+    }
+}
+
+void MainWindow::seedRomCacheFromLibrary()
+{
+    // Cartridges the library has already hashed skip the hashing read when
+    // the ROM image cache is enabled; the emulator ignores unknown hashes.
+    QJsonArray images;
+    for (const MediaLibrary::Entry& entry : m_mediaLibrary->entriesOfKind(MediaLibrary::Cartridge)) {
+        images.append(MediaLibrary::toJson(entry));
+    }
+    if (images.isEmpty()) {
+        return;
+    }
+    AtariEmulator* emulator = m_emulator;
+    QMetaObject::invokeMethod(m_emulator, [emulator, images]() {
+        emulator->addKnownRomImages(images);
+    }, Qt::QueuedConnection);
+}
+
+void MainWindow::toggleMediaLibrary()
+{
+    if (!m_mediaLibraryDock) {
+        m_mediaLibraryWidget = new MediaLibraryWidget(m_mediaLibrary, this);
+        connect(m_mediaLibraryWidget, &MediaLibraryWidget::openRequested, this, &MainWindow::openLibraryMedia);
+
+        m_mediaLibraryDock = new QDockWidget("Media Library", this);
+        m_mediaLibraryDock->setWidget(m_mediaLibraryWidget);
+        m_mediaLibraryDock->setAllowedAreas(Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea);
+        m_mediaLibraryDock->setFeatures(QDockWidget::DockWidgetMovable | QDockWidget::DockWidgetClosable | QDockWidget::DockWidgetFloatable);
+        addDockWidget(Qt::RightDockWidgetArea, m_mediaLibraryDock);
+        m_mediaLibraryDock->hide();
+        connect(m_mediaLibraryDock, &QDockWidget::visibilityChanged, [this](bool visible) {
+            m_mediaLibraryAction->setChecked(visible);
+        });
+    }
+    m_mediaLibraryDock->setVisible(!m_mediaLibraryDock->isVisible());
+    restoreEmulatorFocus();
+}
+
+void MainWindow::applyPerformanceSettings()
+{
+    // "performance/monitor" keeps the counters running without the overlay, for
+    // status.get_performance on unattended machines
+    QSettings settings("8bitrelics", "Fujisan");
+    const bool overlay = settings.value("performance/overlay", false).toBool();
+    m_emulator->performance().setEnabled(overlay || settings.value("performance/monitor", false).toBool());
+    m_performanceOverlayAction->setChecked(overlay);
+    m_emulatorWidget->setPerformanceOverlay(overlay);
+
+    m_guiStallProbe = new QTimer(this);
+    m_guiStallProbe->setTimerType(Qt::PreciseTimer);
+    m_guiStallProbe->setInterval(kGuiStallProbeMs);
+    connect(m_guiStallProbe, &QTimer::timeout, this, &MainWindow::probeGuiStall);
+    m_guiStallProbe->start();
+}
+
+void MainWindow::probeGuiStall()
+{
+    // How late the tick came is how long the event loop was blocked
+    PerformanceMonitor& monitor = m_emulator->performance();
+    if (!monitor.isEnabled()) {
+        m_guiStallClock.invalidate();
+        return;
+    }
+    if (m_guiStallClock.isValid()) {
+        const qint64 lateUs = m_guiStallClock.nsecsElapsed() / 1000 - kGuiStallProbeMs * 1000;
+        monitor.record(PerformanceMonitor::GuiStall, static_cast<qint32>(qBound<qint64>(0, lateUs, INT_MAX)));
+    }
+    m_guiStallClock.start();
+}
+
+void MainWindow::togglePerformanceOverlay(bool enabled)
+{
+    QSettings settings("8bitrelics", "Fujisan");
+    settings.setValue("performance/overlay", enabled);
+    m_emulator->performance().setEnabled(enabled || settings.value("performance/monitor", false).toBool());
+    m_emulatorWidget->setPerformanceOverlay(enabled);
+    if (m_fullscreenEmulatorWidget) {
+        m_fullscreenEmulatorWidget->setPerformanceOverlay(enabled);
+    }
+    restoreEmulatorFocus();
+}
+
+void MainWindow::openLibraryMedia(const QString& path, MediaLibrary::Kind kind)
+{
+    bool ok = false;
+    switch (kind) {
+    case MediaLibrary::Disk:
+        ok = insertDiskViaTCP(1, path);
+        if (ok) {
+            coldBoot();
+        }
+        break;
+    case MediaLibrary::Executable:
+        ok = m_emulator->loadFile(path);
+        break;
+    case MediaLibrary::Cassette:
+        ok = insertCassetteViaTCP(path, false, true);
+        break;
+    case MediaLibrary::Cartridge:
+        ok = insertCartridgeViaTCP(path);
+        break;
+    }
+    if (ok) {
+        statusBar()->showMessage("Loaded: " + QFileInfo(path).fileName(), 3000);
+    } else {
+        statusBar()->showMessage("Failed to load: " + QFileInfo(path).fileName(), 5000);
+    }
+    restoreEmulatorFocus();
 }
 
 void MainWindow::loadRom()
@@ -1531,19 +1784,7 @@ void MainWindow::restartEmulator()
     qDebug() << "ROM paths for restart - OS:" << osRomPath << "BASIC:" << basicRomPath;
 
     // Load post-init settings here on the main thread before dispatching.
-    // speedToggleOn: toolbar MAX toggle state (independent from host-speed setting)
-    // turboMode: "Run as fast as possible (Host Speed)" from settings dialog
-    bool speedToggleOn = settings.value("machine/speedToggleOn", false).toBool();
-    bool turboMode = settings.value("machine/turboMode", false).toBool();
-    int speedIndex = settings.value("machine/emulationSpeedIndex", 1).toInt();
-    int speedPercentage;
-    if (speedToggleOn) {
-        speedPercentage = turboMode ? 0 : 1000; // host speed vs 10x
-    } else if (speedIndex == 0) {
-        speedPercentage = 50;
-    } else {
-        speedPercentage = speedIndex * 100;
-    }
+    int speedPercentage = readSpeedPercentage(settings);
 
     // Run initialization on the emulator thread.  initializeWithNetSIOConfig() calls
     // requestNextFrame() → m_frameTimer->start(), and QTimer::start() must be called
@@ -1745,9 +1986,14 @@ void MainWindow::onSettingsChanged()
     }
 
     // Update Fastbasic build panel visibility
-    if (m_fastbasicBuildPanel) {
+    {
         QSettings settings("8bitrelics", "Fujisan");
-        m_fastbasicBuildPanel->setVisible(settings.value("fastbasic/buildPanelEnabled", false).toBool());
+        setFastbasicBuildPanelVisible(settings.value("fastbasic/buildPanelEnabled", false).toBool());
+    }
+
+    // FujiNet-PC log visibility and filter are cached by the process manager
+    if (m_fujinetProcessManager) {
+        m_fujinetProcessManager->reloadLogSettings();
     }
 
     statusBar()->showMessage("Settings applied and emulator restarted", 3000);
@@ -2122,6 +2368,7 @@ void MainWindow::enterCustomFullscreen()
     // Create a new EmulatorWidget for fullscreen (don't move the original)
     EmulatorWidget* fullscreenEmulator = new EmulatorWidget(m_fullscreenWidget);
     fullscreenEmulator->setEmulator(m_emulator);
+    fullscreenEmulator->setPerformanceOverlay(m_performanceOverlayAction->isChecked());
     layout->addWidget(fullscreenEmulator);
 
     // Show fullscreen
@@ -2167,6 +2414,77 @@ void MainWindow::exitCustomFullscreen()
     statusBar()->showMessage("Fullscreen mode disabled", 2000);
 }
 
+void MainWindow::showInputLatency()
+{
+    if (m_inputLatencyDialog) {
+        m_inputLatencyDialog->show();
+        m_inputLatencyDialog->raise();
+        return;
+    }
+    InputLatencyMonitor& monitor = m_emulator->inputLatency();
+
+    m_inputLatencyDialog = new QDialog(this);
+    m_inputLatencyDialog->setWindowTitle("Input Latency");
+    m_inputLatencyDialog->resize(620, 300);
+    QVBoxLayout* layout = new QVBoxLayout(m_inputLatencyDialog);
+
+    QCheckBox* measureCheck = new QCheckBox("Measure input latency");
+    measureCheck->setChecked(monitor.isEnabled());
+    measureCheck->setToolTip("Timestamps every key and joystick event; adds a little work per input");
+    layout->addWidget(measureCheck);
+
+    QPlainTextEdit* report = new QPlainTextEdit();
+    report->setReadOnly(true);
+    report->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    layout->addWidget(report);
+
+    QHBoxLayout* buttons = new QHBoxLayout();
+    QPushButton* resetButton = new QPushButton("Reset");
+    QPushButton* closeButton = new QPushButton("Close");
+    buttons->addStretch();
+    buttons->addWidget(resetButton);
+    buttons->addWidget(closeButton);
+    layout->addLayout(buttons);
+
+    // Milliseconds per source and stage; percentiles are bucket upper bounds
+    auto refresh = [report, &monitor]() {
+        const QJsonObject json = monitor.toJson();
+        auto row = [](const QString& name, const QJsonObject& histogram) {
+            auto ms = [&histogram](const char* key) {
+                return QString::number(histogram[key].toDouble() / 1000.0, 'f', 1).rightJustified(8);
+            };
+            return name.leftJustified(28) + QString::number(histogram["count"].toInt()).rightJustified(7) +
+                   ms("mean_us") + ms("p50_us") + ms("p90_us") + ms("p99_us") + ms("max_us");
+        };
+        QStringList lines;
+        lines << QString("Stage").leftJustified(28) + "  Count    Mean     p50     p90     p99     Max (ms)";
+        const QJsonObject sources = json["sources"].toObject();
+        for (auto it = sources.constBegin(); it != sources.constEnd(); ++it) {
+            const QJsonObject stages = it.value().toObject();
+            lines << row(it.key() + " to frame", stages["to_frame"].toObject());
+            lines << row(it.key() + " to screen", stages["to_present"].toObject());
+        }
+        lines << row("frame to screen", json["frame_to_present"].toObject());
+        report->setPlainText(lines.join('\n'));
+    };
+    refresh();
+
+    QTimer* refreshTimer = new QTimer(m_inputLatencyDialog);
+    refreshTimer->setInterval(500);
+    connect(refreshTimer, &QTimer::timeout, m_inputLatencyDialog, refresh);
+    refreshTimer->start();
+
+    connect(measureCheck, &QCheckBox::toggled, m_inputLatencyDialog, [&monitor](bool checked) {
+        monitor.setEnabled(checked);
+    });
+    connect(resetButton, &QPushButton::clicked, m_inputLatencyDialog, [&monitor, refresh]() {
+        monitor.reset();
+        refresh();
+    });
+    connect(closeButton, &QPushButton::clicked, m_inputLatencyDialog, &QDialog::close);
+    m_inputLatencyDialog->show();
+}
+
 void MainWindow::showAbout()
 {
 #ifdef Q_OS_MACOS
@@ -2357,106 +2675,35 @@ void MainWindow::createMediaPeripheralsDock()
     connect(m_tcpServer, &TCPServer::diskInserted, this, &MainWindow::onDiskInserted);
     connect(m_tcpServer, &TCPServer::diskEjected, this, &MainWindow::onDiskEjected);
 
-    // Connect solid LED disk I/O monitoring
-    connect(m_emulator, &AtariEmulator::diskIOStart, this, [this](int driveNumber, bool isWriting) {
-#ifdef DEBUG_DISK_IO
-        qDebug() << "*** MainWindow received diskIOStart signal for D" << driveNumber << ":" << (isWriting ? "WRITE" : "READ") << "***";
-#endif
-        // Turn LED ON on D1 (toolbar drive)
-        if (driveNumber == 1 && m_diskDrive1) {
-#ifdef DEBUG_DISK_IO
-            qDebug() << "*** Calling turnOn" << (isWriting ? "Write" : "Read") << "LED() for D1 ***";
-#endif
-            if (isWriting) {
-                m_diskDrive1->turnOnWriteLED();
-            } else {
-                m_diskDrive1->turnOnReadLED();
-            }
-        }
-        // Turn LED ON on D2-D8 (dock drives)
-        else if (driveNumber >= 2 && driveNumber <= 8) {
-#ifdef DEBUG_DISK_IO
-            qDebug() << "*** Looking for dock drive widget D" << driveNumber << "***";
-#endif
-            DiskDriveWidget* driveWidget = m_mediaPeripheralsDock->getDriveWidget(driveNumber);
-            if (driveWidget) {
-#ifdef DEBUG_DISK_IO
-                qDebug() << "*** Calling turnOn" << (isWriting ? "Write" : "Read") << "LED() for dock drive D" << driveNumber << "***";
-#endif
-                if (isWriting) {
-                    driveWidget->turnOnWriteLED();
-                } else {
-                    driveWidget->turnOnReadLED();
-                }
-            } else {
-                qDebug() << "*** ERROR: Could not find dock drive widget for D" << driveNumber << "***";
-            }
-        }
-    });
+    // Asynchronous save-state completion
+    connect(m_emulator, &AtariEmulator::stateSaved, this, &MainWindow::onStateSaved);
+    connect(m_emulator, &AtariEmulator::stateLoaded, this, &MainWindow::onStateLoaded);
 
-    connect(m_emulator, &AtariEmulator::diskIOEnd, this, [this](int driveNumber) {
-#ifdef DEBUG_DISK_IO
-        qDebug() << "*** MainWindow received diskIOEnd signal for D" << driveNumber << ":" << "***";
-#endif
-        // Turn LED OFF on D1 (toolbar drive)
-        if (driveNumber == 1 && m_diskDrive1) {
-#ifdef DEBUG_DISK_IO
-            qDebug() << "*** Calling turnOffActivityLED() for D1 ***";
-#endif
-            m_diskDrive1->turnOffActivityLED();
-        }
-        // Turn LED OFF on D2-D8 (dock drives)
-        else if (driveNumber >= 2 && driveNumber <= 8) {
-#ifdef DEBUG_DISK_IO
-            qDebug() << "*** Looking for dock drive widget D" << driveNumber << "for LED OFF ***";
-#endif
-            DiskDriveWidget* driveWidget = m_mediaPeripheralsDock->getDriveWidget(driveNumber);
-            if (driveWidget) {
-#ifdef DEBUG_DISK_IO
-                qDebug() << "*** Calling turnOffActivityLED() for dock drive D" << driveNumber << "***";
-#endif
-                driveWidget->turnOffActivityLED();
-            } else {
-#ifdef DEBUG_DISK_IO
-                qDebug() << "*** ERROR: Could not find dock drive widget for D" << driveNumber << "for LED OFF ***";
-#endif
-            }
+    // The screen stands still while a tape loads at full speed; say why
+    connect(m_emulator, &AtariEmulator::tapeAccelerationChanged, this, [this](bool active) {
+        if (active) {
+            statusBar()->showMessage("Loading tape at full speed...");
+        } else {
+            statusBar()->showMessage("Tape loaded", 2000);
         }
     });
 
+    // Solid disk LEDs: the emulator only timestamps SIO accesses; sample them at
+    // display rate and touch a widget only when its drive starts or stops
+    m_diskActivityTimer = new QTimer(this);
+    m_diskActivityTimer->setInterval(kDiskActivityPollMs);
+    connect(m_diskActivityTimer, &QTimer::timeout, this, &MainWindow::pollDiskActivity);
+    m_diskActivityTimer->start();
+
     // Connect FujiNet disk I/O signals (reuse same handlers as local drives)
     connect(m_fujinetProcessManager, &FujiNetProcessManager::diskIOStart,
             this, [this](int driveNumber, bool isWriting) {
-        if (driveNumber == 1 && m_diskDrive1) {
-            if (isWriting) {
-                m_diskDrive1->turnOnWriteLED();
-            } else {
-                m_diskDrive1->turnOnReadLED();
-            }
-        }
-        else if (driveNumber >= 2 && driveNumber <= 8) {
-            DiskDriveWidget* driveWidget = m_mediaPeripheralsDock->getDriveWidget(driveNumber);
-            if (driveWidget) {
-                if (isWriting) {
-                    driveWidget->turnOnWriteLED();
-                } else {
-                    driveWidget->turnOnReadLED();
-                }
-            }
-        }
+        setDriveActivityLED(driveNumber, true, isWriting);
     });
 
     connect(m_fujinetProcessManager, &FujiNetProcessManager::diskIOEnd,
             this, [this](int driveNumber) {
-        if (driveNumber == 1 && m_diskDrive1) {
-            m_diskDrive1->turnOffActivityLED();
-        }
-        else if (driveNumber >= 2 && driveNumber <= 8) {
-            DiskDriveWidget* driveWidget = m_mediaPeripheralsDock->getDriveWidget(driveNumber);
-            if (driveWidget) {
-                driveWidget->turnOffActivityLED();
-            }
-        }
+        setDriveActivityLED(driveNumber, false, false);
     });
 
     // Connect FujiNet printer output handling
@@ -2997,6 +3244,42 @@ void MainWindow::createMediaPeripheralsDock()
     createLogoSection();
 }
 
+void MainWindow::setDriveActivityLED(int driveNumber, bool active, bool isWriting)
+{
+    DiskDriveWidget* driveWidget = nullptr;
+    if (driveNumber == 1) {
+        driveWidget = m_diskDrive1;  // toolbar drive
+    } else if (driveNumber >= 2 && driveNumber <= 8 && m_mediaPeripheralsDock) {
+        driveWidget = m_mediaPeripheralsDock->getDriveWidget(driveNumber);
+    }
+    if (!driveWidget) {
+        return;
+    }
+    if (!active) {
+        driveWidget->turnOffActivityLED();
+    } else if (isWriting) {
+        driveWidget->turnOnWriteLED();
+    } else {
+        driveWidget->turnOnReadLED();
+    }
+}
+
+void MainWindow::pollDiskActivity()
+{
+    for (int drive = 1; drive <= 8; ++drive) {
+        bool isWriting = false;
+        const bool active = m_emulator->driveActivity(drive, kDiskActivityHoldMs, &isWriting);
+        const DriveLedState state = !active ? DriveLedOff : isWriting ? DriveLedWrite : DriveLedRead;
+        if (state != m_driveLedStates[drive - 1]) {
+            m_driveLedStates[drive - 1] = state;
+#ifdef DEBUG_DISK_IO
+            qDebug() << "Disk activity D" << drive << ":" << state;
+#endif
+            setDriveActivityLED(drive, active, isWriting);
+        }
+    }
+}
+
 void MainWindow::toggleMediaDock()
 {
     if (m_mediaPeripheralsDockWidget->isVisible()) {
@@ -3219,10 +3502,8 @@ void MainWindow::loadInitialSettings()
 {
     QSettings settings("8bitrelics", "Fujisan");
 
-    // Fastbasic build panel visibility (panel is created in createEmulatorWidget)
-    if (m_fastbasicBuildPanel) {
-        m_fastbasicBuildPanel->setVisible(settings.value("fastbasic/buildPanelEnabled", false).toBool());
-    }
+    // Fastbasic build panel visibility (the panel is built the first time it is shown)
+    setFastbasicBuildPanelVisible(settings.value("fastbasic/buildPanelEnabled", false).toBool());
 
     // Debug checkbox state vs settings
     if (m_joystickEnabledCheck) {
@@ -3312,6 +3593,7 @@ void MainWindow::loadInitialSettings()
 
     bool initSuccess = false;
     QMetaObject::invokeMethod(m_emulator, [&, this]() {
+        StartupTrace::Scope trace("emulator_init");
         initSuccess = m_emulator->initializeWithNetSIOConfig(
             basicEnabled, machineType, videoSystem, artifactMode,
             horizontalArea, verticalArea, horizontalShift, verticalShift,
@@ -3362,6 +3644,16 @@ void MainWindow::loadInitialSettings()
             }
         }
     }
+
+    // Instant resume: with boot settings, media and profile in place, swap the boot
+    // that has just started for the machine as it was at the last quit
+    if (settings.value("emulator/hibernateOnQuit", false).toBool()) {
+        StartupTrace::Scope trace("hibernate_resume");
+        QJsonObject resume;
+        QMetaObject::invokeMethod(m_emulator, "resumeFromHibernation", Qt::BlockingQueuedConnection,
+                                  Q_RETURN_ARG(QJsonObject, resume), Q_ARG(QString, m_emulator->getHibernatePath()));
+        qDebug() << "Hibernate resume:" << resume;
+    }
 }
 
 void MainWindow::loadAndApplyMediaSettings()
@@ -3442,11 +3734,21 @@ void MainWindow::loadAndApplyMediaSettings()
         m_cartridgeWidget->updateFromEmulator();
     }
 
-    // TODO: Load cassette settings
+    // Cassette, optionally booted from (START held through a cold boot)
     bool cassetteEnabled = settings.value("media/cassetteEnabled", false).toBool();
     QString cassettePath = settings.value("media/cassettePath", "").toString();
     if (cassetteEnabled && !cassettePath.isEmpty()) {
-        qDebug() << "Cassette auto-load not yet implemented";
+        bool cassetteReadOnly = settings.value("media/cassetteReadOnly", false).toBool();
+        bool cassetteBootTape = settings.value("media/cassetteBootTape", false).toBool();
+        if (m_emulator->insertCassette(cassettePath, cassetteReadOnly, cassetteBootTape)) {
+            qDebug() << "Auto-inserted cassette:" << cassettePath << "(boot:" << cassetteBootTape << ")";
+            if (m_mediaPeripheralsDock && m_mediaPeripheralsDock->getCassetteWidget()) {
+                m_mediaPeripheralsDock->getCassetteWidget()->setCassetteEnabled(true);
+                m_mediaPeripheralsDock->getCassetteWidget()->updateFromEmulator();
+            }
+        } else {
+            qDebug() << "Failed to auto-insert cassette:" << cassettePath;
+        }
     }
 
     // Hard drive settings (H1-H4)
@@ -3516,9 +3818,19 @@ void MainWindow::loadVideoSettings()
     QString fitScreen = settings.value("video/fitScreen", "both").toString();
     double overscanFactor = settings.value("video/overscanFactor", 1.0).toDouble();
 
+    bool gpuPresentation = settings.value("video/gpuPresentation", false).toBool();
+    // "gpu-ntsc" artifacting turns the core's CPU artifacting off and decodes on the GPU instead
+    const bool ntscComposite = settings.value("video/artifacting", "none").toString() == "gpu-ntsc";
+
     // Apply scaling settings to emulator widget
     if (m_emulatorWidget) {
         m_emulatorWidget->setScalingSettings(integerScaling, scalingFilter, fitScreen, m_keepAspectRatio, overscanFactor);
+        m_emulatorWidget->setCrtEffects(ntscComposite,
+                                        settings.value("video/crtScanlines", 0).toInt(),
+                                        settings.value("video/crtPersistence", 0).toInt(),
+                                        settings.value("video/crtCurvature", 0).toInt());
+        m_emulatorWidget->setVSync(settings.value("video/vSyncEnabled", false).toBool());
+        m_emulatorWidget->setGpuPresentation(gpuPresentation);
     }
 
     // Apply fullscreen setting based on preference
@@ -3533,7 +3845,8 @@ void MainWindow::loadVideoSettings()
              << "Integer scaling:" << integerScaling
              << "Scaling filter:" << scalingFilter
              << "Fit screen:" << fitScreen
-             << "Overscan factor:" << overscanFactor;
+             << "Overscan factor:" << overscanFactor
+             << "GPU presentation:" << gpuPresentation;
 }
 
 void MainWindow::resizeEvent(QResizeEvent *event)
@@ -3614,6 +3927,7 @@ bool MainWindow::eventFilter(QObject *object, QEvent *event)
 
 void MainWindow::toggleDebugger()
 {
+    ensureDebugger();
     if (m_debuggerDock->isVisible()) {
         m_debuggerDock->hide();
     } else {
@@ -3630,11 +3944,10 @@ void MainWindow::quickSaveState()
     QString profileName = m_profileCombo->currentText();
     m_emulator->setCurrentProfileName(profileName);
 
-    if (m_emulator->quickSaveState()) {
-        statusBar()->showMessage("Quick state saved", 2000);
-    } else {
-        QMessageBox::warning(this, "Quick Save Failed", "Failed to save state");
-    }
+    // Completion arrives via AtariEmulator::stateSaved -> onStateSaved()
+    m_guiStateRequests.insert(m_emulator->getQuickSaveStatePath());
+    m_emulator->quickSaveState();
+    statusBar()->showMessage("Saving quick state...", 2000);
 
     // Restore focus to emulator widget (fixes Windows/Linux focus loss)
     if (m_emulatorWidget) {
@@ -3644,25 +3957,10 @@ void MainWindow::quickSaveState()
 
 void MainWindow::quickLoadState()
 {
-    if (m_emulator->quickLoadState()) {
-        // Get the profile name from the loaded state
-        QString profileName = m_emulator->getCurrentProfileName();
-
-        // Sync ProfileManager so the persisted current profile matches the loaded state
-        if (!profileName.isEmpty() && m_profileManager->profileExists(profileName)) {
-            m_profileManager->setCurrentProfileName(profileName);
-        }
-
-        // Try to select the profile in the combo box
-        int index = m_profileCombo->findText(profileName);
-        if (index >= 0) {
-            m_profileCombo->setCurrentIndex(index);
-        } else if (!profileName.isEmpty() && profileName != "Default") {
-            statusBar()->showMessage(QString("Profile '%1' not found, using current").arg(profileName), 3000);
-        }
-
-        statusBar()->showMessage("Quick state loaded", 2000);
-    } else {
+    const QString quickSavePath = m_emulator->getQuickSaveStatePath();
+    m_guiStateRequests.insert(quickSavePath);
+    if (!m_emulator->quickLoadState()) {
+        m_guiStateRequests.remove(quickSavePath);
         QMessageBox::warning(this, "Quick Load Failed", "No quick save state found");
     }
 
@@ -3689,11 +3987,9 @@ void MainWindow::saveState()
         QString profileName = m_profileCombo->currentText();
         m_emulator->setCurrentProfileName(profileName);
 
-        if (m_emulator->saveState(filename)) {
-            statusBar()->showMessage(QString("State saved to %1").arg(QFileInfo(filename).fileName()), 3000);
-        } else {
-            QMessageBox::warning(this, "Save Failed", "Failed to save state");
-        }
+        m_guiStateRequests.insert(filename);
+        m_emulator->saveStateAsync(filename);
+        statusBar()->showMessage(QString("Saving state to %1...").arg(QFileInfo(filename).fileName()), 2000);
     }
 
     // Restore focus to emulator widget after file dialog closes (fixes Linux focus loss)
@@ -3710,33 +4006,63 @@ void MainWindow::loadState()
         "Atari State Files (*.a8s);;All Files (*)");
 
     if (!filename.isEmpty()) {
-        if (m_emulator->loadState(filename)) {
-            // Get the profile name from the loaded state
-            QString profileName = m_emulator->getCurrentProfileName();
+        m_guiStateRequests.insert(filename);
+        m_emulator->loadStateAsync(filename);
+    }
 
-            // Sync ProfileManager so the persisted current profile matches the loaded state
-            if (!profileName.isEmpty() && m_profileManager->profileExists(profileName)) {
-                m_profileManager->setCurrentProfileName(profileName);
-            }
+    // Restore focus to emulator widget after file dialog closes (fixes Linux focus loss)
+    if (m_emulatorWidget) {
+        m_emulatorWidget->setFocus();
+    }
+}
 
-            // Try to select the profile in the combo box
-            int index = m_profileCombo->findText(profileName);
-            if (index >= 0) {
-                m_profileCombo->setCurrentIndex(index);
-            } else if (!profileName.isEmpty() && profileName != "Default") {
-                statusBar()->showMessage(QString("Profile '%1' not found, using current").arg(profileName), 3000);
-            }
+void MainWindow::onStateSaved(const QString& filename, bool success)
+{
+    // Saves requested over TCP are reported to their client; only ours get a dialog
+    const bool requestedHere = m_guiStateRequests.remove(filename);
+    const bool isQuick = (filename == m_emulator->getQuickSaveStatePath());
 
-            statusBar()->showMessage(QString("State loaded from %1").arg(QFileInfo(filename).fileName()), 3000);
-        } else {
-            QMessageBox::warning(this, "Load Failed", "Failed to load state");
+    if (success) {
+        statusBar()->showMessage(isQuick ? QString("Quick state saved")
+                                         : QString("State saved to %1").arg(QFileInfo(filename).fileName()),
+                                 isQuick ? 2000 : 3000);
+    } else if (requestedHere) {
+        QMessageBox::warning(this, isQuick ? "Quick Save Failed" : "Save Failed", "Failed to save state");
+    }
+}
+
+void MainWindow::onStateLoaded(const QString& filename, bool success)
+{
+    const bool requestedHere = m_guiStateRequests.remove(filename);
+    const bool isQuick = (filename == m_emulator->getQuickSaveStatePath());
+
+    if (!success) {
+        if (requestedHere) {
+            QMessageBox::warning(this, isQuick ? "Quick Load Failed" : "Load Failed", "Failed to load state");
         }
+        return;
     }
 
-    // Restore focus to emulator widget after file dialog closes (fixes Linux focus loss)
-    if (m_emulatorWidget) {
-        m_emulatorWidget->setFocus();
+    // Get the profile name from the loaded state
+    QString profileName = m_emulator->getCurrentProfileName();
+
+    // Sync ProfileManager so the persisted current profile matches the loaded state
+    if (!profileName.isEmpty() && m_profileManager->profileExists(profileName)) {
+        m_profileManager->setCurrentProfileName(profileName);
     }
+
+    // Try to select the profile in the combo box
+    int index = m_profileCombo->findText(profileName);
+    if (index >= 0) {
+        m_profileCombo->setCurrentIndex(index);
+    } else if (!profileName.isEmpty() && profileName != "Default") {
+        statusBar()->showMessage(QString("Profile '%1' not found, using current").arg(profileName), 3000);
+        return;
+    }
+
+    statusBar()->showMessage(isQuick ? QString("Quick state loaded")
+                                     : QString("State loaded from %1").arg(QFileInfo(filename).fileName()),
+                             isQuick ? 2000 : 3000);
 }
 
 void MainWindow::pasteText()
@@ -3771,59 +4097,14 @@ void MainWindow::sendTextToEmulator(const QString& text)
     }
 
     // Stop any existing paste operation
-    if (m_pasteTimer->isActive()) {
-        m_pasteTimer->stop();
-        // Restore original speed if previous paste was interrupted
-        m_emulator->setEmulationSpeed(m_originalEmulationSpeed);
-    }
-
-    // Save current emulation speed and boost to 200% for fast, reliable pasting
-    m_originalEmulationSpeed = m_emulator->getCurrentEmulationSpeed();
-    m_emulator->setEmulationSpeed(200);
-
-    // Use fixed timer interval optimized for 200% speed
-    m_pasteTimer->setInterval(37);  // ~37ms per character at 2x speed
-
-    // Turn off CAPS LOCK before pasting to ensure correct case handling
-    // CAPS LOCK state affects whether lowercase/uppercase works correctly
-    m_emulator->injectAKey(AKEY_CAPSTOGGLE);
-    QThread::msleep(100);  // Give CAPS LOCK toggle time to process
-
-    // Setup the paste buffer
-    m_pasteBuffer = text;
-    m_pasteIndex = 0;
-
-    // Start the timer to send characters
-    m_pasteTimer->start();
-
-}
-
-void MainWindow::sendNextCharacter()
-{
-    if (!m_emulator) {
-        return;
-    }
-
-    // Check if we've finished all characters
-    if (m_pasteIndex >= m_pasteBuffer.length()) {
-        // Finished pasting - restore CAPS LOCK state and original emulation speed
-        m_pasteTimer->stop();
-        m_emulator->injectAKey(AKEY_CAPSTOGGLE);
-        m_emulator->setEmulationSpeed(m_originalEmulationSpeed);
-        m_pasteBuffer.clear();
-        m_pasteIndex = 0;
-        return;
-    }
-
-    // Wait until inject hold/post-release finished and OS CH ($02FC) clear — otherwise
-    // repeated characters or fast OS buffer can drop keys.
-    if (!m_emulator->isCharacterInjectionIdle()) {
-        return;
-    }
-
-    QChar ch = m_pasteBuffer.at(m_pasteIndex);
-    m_emulator->injectCharacter(ch.toLatin1());
-    m_pasteIndex++;
+    m_emulator->cancelQueuedText();
+
+    // The emulator types the text itself, frame by frame, moving on as soon as the
+    // OS has taken each key. Turn off CAPS LOCK around it so case comes through as
+    // pasted; long pastes run at host speed until the last key is in.
+    m_emulator->queueAKey(AKEY_CAPSTOGGLE);
+    m_emulator->queueText(text.toLatin1(), text.size() >= kPasteTurboThreshold);
+    m_emulator->queueAKey(AKEY_CAPSTOGGLE);
 }
 
 void MainWindow::showEvent(QShowEvent *event)
@@ -3853,12 +4134,9 @@ void MainWindow::closeEvent(QCloseEvent *event)
         exitCustomFullscreen();
     }
 
-    // Stop paste timer if running and restore speed
-    if (m_pasteTimer && m_pasteTimer->isActive()) {
-        m_pasteTimer->stop();
-        if (m_emulator) {
-            m_emulator->setEmulationSpeed(m_originalEmulationSpeed);
-        }
+    // Stop any paste still being typed (and its turbo burst)
+    if (m_emulator) {
+        m_emulator->cancelQueuedText();
     }
 
     // Step 1 (non-blocking): kick the worker so it starts tearing down on its own thread.
@@ -3994,6 +4272,7 @@ void MainWindow::applyProfileToEmulator(const ConfigurationProfile& profile, boo
         speedPercentage = profile.emulationSpeedIndex * 100;
     }
     m_emulator->setEmulationSpeed(speedPercentage);
+    m_emulator->setRunAheadFrames(profile.runAheadFrames);
 
     // Update toolbar speed toggle to reflect profile speed
     if (m_speedToggle) {
@@ -4019,6 +4298,7 @@ void MainWindow::applyProfileToEmulator(const ConfigurationProfile& profile, boo
     settings.setValue("machine/turboMode", profile.turboMode);
     settings.setValue("machine/speedToggleOn", profile.turboMode); // toggle ON when host speed profile
     settings.setValue("machine/emulationSpeedIndex", profile.emulationSpeedIndex);
+    settings.setValue("machine/runAheadFrames", profile.runAheadFrames);
 
     {
         QString pj1 = profile.joystick1Device;
@@ -4046,9 +4326,7 @@ void MainWindow::applyProfileToEmulator(const ConfigurationProfile& profile, boo
     settings.setValue("media/netSIOEnabled", profile.netSIOEnabled);
     settings.setValue("fastbasic/buildPanelEnabled", profile.fastbasicBuildPanelEnabled);
 
-    if (m_fastbasicBuildPanel) {
-        m_fastbasicBuildPanel->setVisible(profile.fastbasicBuildPanelEnabled);
-    }
+    setFastbasicBuildPanelVisible(profile.fastbasicBuildPanelEnabled);
 
     // CRITICAL: Start/stop FujiNet-PC BEFORE emulator restart if NetSIO state changed
     // FujiNet must be running before emulator initializes with NetSIO enabled
@@ -4228,6 +4506,7 @@ void MainWindow::toggleTCPServer()
         // Start the TCP server
         QSettings settings;
         int tcpPort = settings.value("emulator/tcpServerPort", 6502).toInt();
+        m_tcpServer->setLocalServerName(settings.value("emulator/localServerName").toString());
 
         bool success = m_tcpServer->startServer(tcpPort);
         if (success) {
@@ -4259,6 +4538,49 @@ void MainWindow::requestEmulatorRestart()
     restartEmulator();
 }
 
+QStringList MainWindow::reconfigureEmulator(bool forceRestart)
+{
+    QSettings settings("8bitrelics", "Fujisan");
+
+    // Anything libatari800 takes on its command line needs a reinit; compare
+    // both the saved settings and the emulator's own setters against the boot
+    QStringList reasons = m_emulator->pendingRestartChanges();
+    const QJsonObject booted = m_emulator->bootConfig();
+    const QJsonObject requested = readBootConfig(settings);
+    for (auto it = requested.constBegin(); it != requested.constEnd(); ++it) {
+        if (booted.value(it.key()) != it.value() && !reasons.contains(it.key())) {
+            reasons << it.key();
+        }
+    }
+    if (forceRestart) {
+        reasons.prepend("forced");
+    }
+    if (!reasons.isEmpty()) {
+        qDebug() << "Reconfiguration needs a restart:" << reasons;
+        restartEmulator();
+        return reasons;
+    }
+
+    // Everything else can change under the running core
+    const QString artifactMode = settings.value("video/artifacting", "none").toString();
+    const JoystickSettingsSnapshot sn = readJoystickSettingsSnapshot(settings);
+    const int speedPercentage = readSpeedPercentage(settings);
+    auto applyFn = [&]() {
+        m_emulator->updateArtifactSettings(artifactMode);
+        m_emulator->applyJoystickInputBundle(sn.master, sn.device1, sn.device2,
+                                             sn.effKbd0, sn.effKbd1, sn.swap,
+                                             sn.preset0, sn.preset1);
+        m_emulator->setEmulationSpeed(speedPercentage);
+    };
+    if (m_emulatorThread && m_emulatorThread->isRunning()) {
+        QMetaObject::invokeMethod(m_emulator, applyFn, Qt::BlockingQueuedConnection);
+    } else {
+        applyFn();
+    }
+    qDebug() << "Reconfigured emulator live - Artifact:" << artifactMode << "Speed:" << speedPercentage;
+    return reasons;
+}
+
 bool MainWindow::setHardDrivePathViaTCP(int driveNumber, const QString& path)
 {
     qDebug() << "MainWindow::setHardDrivePathViaTCP called for drive" << driveNumber << "path:" << path;
@@ -4389,6 +4711,32 @@ bool MainWindow::ejectCartridgeViaTCP()
     return false;
 }
 
+bool MainWindow::insertCassetteViaTCP(const QString& cassettePath, bool readOnly, bool bootTape)
+{
+    qDebug() << "MainWindow::insertCassetteViaTCP called with path:" << cassettePath << "boot:" << bootTape;
+
+    if (!m_emulator->insertCassette(cassettePath, readOnly, bootTape)) {
+        return false;
+    }
+    if (m_mediaPeripheralsDock && m_mediaPeripheralsDock->getCassetteWidget()) {
+        CassetteWidget* widget = m_mediaPeripheralsDock->getCassetteWidget();
+        widget->setCassetteEnabled(true);
+        widget->updateFromEmulator();
+    }
+    return true;
+}
+
+bool MainWindow::ejectCassetteViaTCP()
+{
+    qDebug() << "MainWindow::ejectCassetteViaTCP called";
+
+    m_emulator->ejectCassette();
+    if (m_mediaPeripheralsDock && m_mediaPeripheralsDock->getCassetteWidget()) {
+        m_mediaPeripheralsDock->getCassetteWidget()->updateFromEmulator();
+    }
+    return true;
+}
+
 void MainWindow::applyProfileViaTCP(const ConfigurationProfile& profile)
 {
     qDebug() << "MainWindow::applyProfileViaTCP called for profile:" << profile.name;
@@ -0,0 +1,580 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "medialibrary.h"
+#include "diskimagecache.h"
+#include "xeximage.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <algorithm>
+
+namespace {
+
+constexpr int kIndexVersion = 1;
+constexpr int kFirstDirectorySector = 361;
+constexpr int kDirectorySectors = 8;
+constexpr int kDirectoryEntryBytes = 16;
+
+int readWord(const QByteArray& bytes, int offset)
+{
+    return static_cast<quint8>(bytes[offset]) | (static_cast<quint8>(bytes[offset + 1]) << 8);
+}
+
+quint32 readBigEndian32(const QByteArray& bytes, int offset)
+{
+    quint32 value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value = (value << 8) | static_cast<quint8>(bytes[offset + i]);
+    }
+    return value;
+}
+
+void inspectDisk(const QString& suffix, const QByteArray& bytes, MediaLibrary::Entry* entry)
+{
+    QJsonObject details;
+    details["format"] = suffix;
+    DiskImageCache::Layout layout;
+    if ((suffix == "atr" || suffix == "xfd") && DiskImageCache::layoutOf(bytes, &layout)) {
+        details["sector_size"] = layout.sectorSize;
+        details["sectors"] = layout.sectorCount;
+        const int bootOffset = layout.offset(1);
+        const QByteArray bootSector = bytes.mid(bootOffset, layout.size(1));
+        details["bootable"] = bootSector.count('\0') != bootSector.size();
+        entry->files = MediaLibrary::dosDirectory(bytes);
+        details["dos"] = !entry->files.isEmpty();
+    }
+    entry->details = details;
+}
+
+void inspectExecutable(const QByteArray& bytes, MediaLibrary::Entry* entry)
+{
+    QJsonObject details;
+    XexImage image;
+    QString error;
+    if (image.parse(bytes, &error)) {
+        int first = 0xFFFF;
+        int last = 0;
+        for (const XexImage::Segment& segment : image.segments()) {
+            first = qMin(first, int(segment.start));
+            last = qMax(last, segment.end());
+        }
+        details["segments"] = image.segments().size();
+        details["run_address"] = image.runAddress();
+        if (!image.segments().isEmpty()) {
+            details["first_address"] = first;
+            details["last_address"] = last;
+        }
+    } else {
+        details["error"] = error;
+    }
+    entry->details = details;
+}
+
+void inspectCassette(const QByteArray& bytes, MediaLibrary::Entry* entry)
+{
+    // Chunks: 4-byte id, u16 LE length, u16 LE aux, then the data
+    QJsonObject details;
+    QString description;
+    int blocks = 0;
+    int baud = 600;
+    for (int offset = 0; offset + 8 <= bytes.size();) {
+        const QByteArray id = bytes.mid(offset, 4);
+        const int length = readWord(bytes, offset + 4);
+        const int aux = readWord(bytes, offset + 6);
+        if (offset + 8 + length > bytes.size()) {
+            break;
+        }
+        if (id == "FUJI") {
+            description += QString::fromLatin1(bytes.mid(offset + 8, length)).trimmed();
+        } else if (id == "baud") {
+            baud = aux;
+        } else if (id == "data") {
+            ++blocks;
+        }
+        offset += 8 + length;
+    }
+    details["blocks"] = blocks;
+    details["baud"] = baud;
+    if (!description.isEmpty()) {
+        entry->title = description;
+    }
+    entry->details = details;
+}
+
+void inspectCartridge(const QByteArray& bytes, MediaLibrary::Entry* entry)
+{
+    QJsonObject details;
+    if (bytes.size() >= 16 && bytes.startsWith("CART")) {
+        quint32 sum = 0;
+        for (int i = 16; i < bytes.size(); ++i) {
+            sum += static_cast<quint8>(bytes[i]);
+        }
+        details["format"] = QStringLiteral("car");
+        details["cart_type"] = static_cast<int>(readBigEndian32(bytes, 4));
+        details["checksum_ok"] = sum == readBigEndian32(bytes, 8);
+    } else {
+        details["format"] = QStringLiteral("raw");
+    }
+    entry->details = details;
+}
+
+}  // namespace
+
+MediaLibrary::MediaLibrary(const QString& indexPath, QObject* parent)
+    : QObject(parent)
+    , m_indexPath(indexPath)
+{
+    qRegisterMetaType<MediaLibrary::Entry>();
+    qRegisterMetaType<QVector<MediaLibrary::Entry>>();
+
+    m_thread = new QThread(this);
+    m_thread->setObjectName("media-library");
+    m_scanner = new MediaLibraryScanner(&m_generation);
+    m_scanner->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_scanner, &QObject::deleteLater);
+    connect(m_scanner, &MediaLibraryScanner::batch, this, &MediaLibrary::onBatch);
+    connect(m_scanner, &MediaLibraryScanner::done, this, &MediaLibrary::onScanDone);
+    m_thread->start(QThread::LowPriority);
+}
+
+MediaLibrary::~MediaLibrary()
+{
+    ++m_generation;  // stops a scan in progress
+    m_thread->quit();
+    m_thread->wait();
+}
+
+QString MediaLibrary::defaultIndexPath()
+{
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dir);
+    return QDir(dir).filePath("media_library.json");
+}
+
+bool MediaLibrary::load()
+{
+    if (m_indexPath.isEmpty()) {
+        return false;
+    }
+    QFile file(m_indexPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+    const QJsonObject root = document.object();
+    if (root["version"].toInt() != kIndexVersion) {
+        qWarning() << "Media library: ignoring index with another version:" << m_indexPath;
+        return false;
+    }
+    m_entries.clear();
+    m_byHash.clear();
+    for (const QJsonValue& value : root["entries"].toArray()) {
+        Entry entry;
+        if (fromJson(value.toObject(), &entry)) {
+            insert(entry);
+        }
+    }
+    emit indexChanged();
+    return true;
+}
+
+bool MediaLibrary::save() const
+{
+    if (m_indexPath.isEmpty()) {
+        return false;
+    }
+    QJsonArray entries;
+    for (const Entry& entry : m_entries) {
+        entries.append(toJson(entry));
+    }
+    QJsonObject root;
+    root["version"] = kIndexVersion;
+    root["entries"] = entries;
+
+    QSaveFile file(m_indexPath);
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Compact);
+    if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit()) {
+        qWarning() << "Media library: cannot write" << m_indexPath << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void MediaLibrary::rescan()
+{
+    m_seen.clear();
+    m_scanning = true;
+    const quint64 generation = ++m_generation;  // also cancels the previous scan
+    const QStringList folders = m_folders;
+    const QHash<QString, Entry> known = m_entries;
+    MediaLibraryScanner* scanner = m_scanner;
+    QMetaObject::invokeMethod(scanner, [scanner, generation, folders, known]() {
+        scanner->scan(generation, folders, known);
+    }, Qt::QueuedConnection);
+}
+
+void MediaLibrary::cancelScan()
+{
+    if (m_scanning) {
+        m_scanning = false;
+        ++m_generation;  // the scanner stops, and batches it already queued are dropped
+    }
+}
+
+void MediaLibrary::clear()
+{
+    cancelScan();
+    m_entries.clear();
+    m_byHash.clear();
+    m_seen.clear();
+    save();
+    emit indexChanged();
+}
+
+QVector<MediaLibrary::Entry> MediaLibrary::search(const QString& query, int limit) const
+{
+    const QStringList words = query.split(' ', Qt::SkipEmptyParts);
+    QVector<Entry> results;
+    for (const Entry& entry : m_entries) {
+        const QString name = QFileInfo(entry.path).fileName();
+        bool matches = true;
+        for (const QString& word : words) {
+            if (!name.contains(word, Qt::CaseInsensitive) && !entry.title.contains(word, Qt::CaseInsensitive)
+                && entry.files.filter(word, Qt::CaseInsensitive).isEmpty()) {
+                matches = false;
+                break;
+            }
+        }
+        if (matches) {
+            results.append(entry);
+        }
+    }
+    std::sort(results.begin(), results.end(), [](const Entry& a, const Entry& b) {
+        const int order = QFileInfo(a.path).fileName().compare(QFileInfo(b.path).fileName(), Qt::CaseInsensitive);
+        return order != 0 ? order < 0 : a.path < b.path;
+    });
+    if (limit > 0 && results.size() > limit) {
+        results.resize(limit);
+    }
+    return results;
+}
+
+QVector<MediaLibrary::Entry> MediaLibrary::entriesOfKind(Kind kind) const
+{
+    QVector<Entry> results;
+    for (const Entry& entry : m_entries) {
+        if (entry.kind == kind) {
+            results.append(entry);
+        }
+    }
+    return results;
+}
+
+QString MediaLibrary::kindName(Kind kind)
+{
+    switch (kind) {
+    case Executable:
+        return "executable";
+    case Cassette:
+        return "cassette";
+    case Cartridge:
+        return "cartridge";
+    default:
+        return "disk";
+    }
+}
+
+bool MediaLibrary::parseKind(const QString& name, Kind* kind)
+{
+    for (Kind candidate : {Disk, Executable, Cassette, Cartridge}) {
+        if (name == kindName(candidate)) {
+            *kind = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MediaLibrary::kindForPath(const QString& path, Kind* kind)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == "atr" || suffix == "xfd" || suffix == "atx" || suffix == "pro" || suffix == "dcm") {
+        *kind = Disk;
+    } else if (suffix == "xex" || suffix == "com" || suffix == "exe") {
+        *kind = Executable;
+    } else if (suffix == "cas") {
+        *kind = Cassette;
+    } else if (suffix == "car" || suffix == "rom" || suffix == "bin") {
+        *kind = Cartridge;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QStringList MediaLibrary::nameFilters()
+{
+    QStringList filters;
+    // QDir matches these case-insensitively
+    for (const char* suffix : {"atr", "xfd", "atx", "pro", "dcm", "xex", "com", "exe", "cas", "car", "rom", "bin"}) {
+        filters << QStringLiteral("*.") + QLatin1String(suffix);
+    }
+    return filters;
+}
+
+bool MediaLibrary::inspect(const QString& path, Entry* entry, QString* error)
+{
+    const QFileInfo info(path);
+    Kind kind;
+    if (!kindForPath(path, &kind)) {
+        if (error) *error = "not a media file";
+        return false;
+    }
+    if (!info.isFile() || info.size() > kMaxImageBytes) {
+        if (error) *error = "missing or too large";
+        return false;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    const QByteArray bytes = file.readAll();
+    if (bytes.size() != info.size()) {
+        if (error) *error = "changed while reading";
+        return false;
+    }
+
+    Entry result;
+    result.path = info.absoluteFilePath();
+    result.kind = kind;
+    result.size = info.size();
+    result.modifiedMs = info.lastModified().toMSecsSinceEpoch();
+    result.sha1 = QCryptographicHash::hash(bytes, QCryptographicHash::Sha1).toHex();
+    result.title = info.completeBaseName();
+    switch (kind) {
+    case Disk:
+        inspectDisk(info.suffix().toLower(), bytes, &result);
+        break;
+    case Executable:
+        inspectExecutable(bytes, &result);
+        break;
+    case Cassette:
+        inspectCassette(bytes, &result);
+        break;
+    case Cartridge:
+        inspectCartridge(bytes, &result);
+        break;
+    }
+    *entry = result;
+    return true;
+}
+
+QStringList MediaLibrary::dosDirectory(const QByteArray& image)
+{
+    QStringList files;
+    DiskImageCache::Layout layout;
+    if (!DiskImageCache::layoutOf(image, &layout)
+        || layout.sectorCount < kFirstDirectorySector + kDirectorySectors - 1) {
+        return files;
+    }
+    for (int sector = kFirstDirectorySector; sector < kFirstDirectorySector + kDirectorySectors; ++sector) {
+        // Only the first 128 bytes of a larger directory sector are used
+        const int base = layout.offset(sector);
+        for (int slot = 0; slot < 8; ++slot) {
+            const int offset = base + slot * kDirectoryEntryBytes;
+            const quint8 flags = static_cast<quint8>(image[offset]);
+            if (flags == 0) {
+                return files;  // never used: the end of the directory
+            }
+            if ((flags & 0x80) || !(flags & 0x43)) {
+                continue;  // deleted, or not a file
+            }
+            QString name;
+            QString extension;
+            for (int i = 0; i < 11; ++i) {
+                const quint8 ch = static_cast<quint8>(image[offset + 5 + i]);
+                if (ch < 0x20 || ch > 0x7E) {
+                    return QStringList();  // not a DOS 2 directory after all
+                }
+                (i < 8 ? name : extension) += QChar(ch);
+            }
+            name = name.trimmed();
+            extension = extension.trimmed();
+            if (name.isEmpty()) {
+                return QStringList();
+            }
+            files << (extension.isEmpty() ? name : name + '.' + extension);
+        }
+    }
+    return files;
+}
+
+QJsonObject MediaLibrary::toJson(const Entry& entry)
+{
+    QJsonObject object;
+    object["path"] = entry.path;
+    object["kind"] = kindName(entry.kind);
+    object["size"] = entry.size;
+    object["modified"] = entry.modifiedMs;
+    object["sha1"] = QString::fromLatin1(entry.sha1);
+    object["title"] = entry.title;
+    object["details"] = entry.details;
+    if (!entry.files.isEmpty()) {
+        object["files"] = QJsonArray::fromStringList(entry.files);
+    }
+    return object;
+}
+
+bool MediaLibrary::fromJson(const QJsonObject& object, Entry* entry)
+{
+    Entry result;
+    result.path = object["path"].toString();
+    if (result.path.isEmpty() || !parseKind(object["kind"].toString(), &result.kind)) {
+        return false;
+    }
+    result.size = object["size"].toVariant().toLongLong();
+    result.modifiedMs = object["modified"].toVariant().toLongLong();
+    result.sha1 = object["sha1"].toString().toLatin1();
+    result.title = object["title"].toString();
+    result.details = object["details"].toObject();
+    for (const QJsonValue& file : object["files"].toArray()) {
+        result.files << file.toString();
+    }
+    *entry = result;
+    return true;
+}
+
+void MediaLibrary::onBatch(quint64 generation, const QVector<MediaLibrary::Entry>& entries,
+                           int filesSeen, int filesRead)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    for (const Entry& entry : entries) {
+        insert(entry);
+        m_seen.insert(entry.path);
+    }
+    emit indexChanged();
+    emit scanProgress(filesSeen, filesRead);
+}
+
+void MediaLibrary::onScanDone(quint64 generation, int filesSeen, int filesRead, qint64 elapsedMs, bool cancelled)
+{
+    if (generation != m_generation || cancelled) {
+        return;
+    }
+    m_scanning = false;
+
+    // Forget files under the scanned folders that are gone; other folders keep theirs
+    QStringList roots;
+    for (const QString& folder : m_folders) {
+        roots << QDir::cleanPath(QDir(folder).absolutePath()) + '/';
+    }
+    QStringList gone;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        if (m_seen.contains(it.key())) {
+            continue;
+        }
+        for (const QString& root : roots) {
+            if (it.key().startsWith(root)) {
+                gone << it.key();
+                break;
+            }
+        }
+    }
+    for (const QString& path : gone) {
+        remove(path);
+    }
+    m_seen.clear();
+    if (!gone.isEmpty()) {
+        emit indexChanged();
+    }
+    save();
+    qDebug() << "Media library: scanned" << filesSeen << "files," << filesRead << "read," << gone.size()
+             << "removed in" << elapsedMs << "ms";
+    emit scanFinished(filesSeen, filesRead, elapsedMs);
+}
+
+void MediaLibrary::insert(const Entry& entry)
+{
+    auto it = m_entries.find(entry.path);
+    if (it != m_entries.end()) {
+        m_byHash.remove(it->sha1, entry.path);
+        *it = entry;
+    } else {
+        m_entries.insert(entry.path, entry);
+    }
+    m_byHash.insert(entry.sha1, entry.path);
+}
+
+void MediaLibrary::remove(const QString& path)
+{
+    auto it = m_entries.find(path);
+    if (it != m_entries.end()) {
+        m_byHash.remove(it->sha1, path);
+        m_entries.erase(it);
+    }
+}
+
+void MediaLibraryScanner::scan(quint64 generation, const QStringList& folders,
+                               const QHash<QString, MediaLibrary::Entry>& known)
+{
+    QElapsedTimer timer;
+    timer.start();
+    int filesSeen = 0;
+    int filesRead = 0;
+    QVector<MediaLibrary::Entry> pending;
+    const QStringList filters = MediaLibrary::nameFilters();
+
+    for (const QString& folder : folders) {
+        QDirIterator it(folder, filters, QDir::Files | QDir::Readable, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            if (m_generation->load() != generation) {
+                emit done(generation, filesSeen, filesRead, timer.elapsed(), true);
+                return;
+            }
+            it.next();
+            const QFileInfo info = it.fileInfo();
+            if (info.size() > MediaLibrary::kMaxImageBytes) {
+                continue;
+            }
+            ++filesSeen;
+            const QString path = info.absoluteFilePath();
+            auto existing = known.constFind(path);
+            if (existing != known.constEnd() && existing->size == info.size()
+                && existing->modifiedMs == info.lastModified().toMSecsSinceEpoch()) {
+                pending.append(*existing);
+            } else {
+                MediaLibrary::Entry entry;
+                if (MediaLibrary::inspect(path, &entry)) {
+                    pending.append(entry);
+                    ++filesRead;
+                }
+            }
+            if (pending.size() >= MediaLibrary::kBatchSize) {
+                emit batch(generation, pending, filesSeen, filesRead);
+                pending.clear();
+            }
+        }
+    }
+    if (!pending.isEmpty()) {
+        emit batch(generation, pending, filesSeen, filesRead);
+    }
+    emit done(generation, filesSeen, filesRead, timer.elapsed(), false);
+}
@@ -0,0 +1,249 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "medialibrarywidget.h"
+
+#include <QDrag>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QMessageBox>
+#include <QMimeData>
+#include <QPushButton>
+#include <QSettings>
+#include <QTimer>
+#include <QUrl>
+#include <QVBoxLayout>
+
+namespace {
+
+constexpr int kPathRole = Qt::UserRole;
+constexpr int kKindRole = Qt::UserRole + 1;
+
+// Drags carry file URLs, so every widget that takes dropped files takes these
+class MediaResultList : public QListWidget
+{
+public:
+    using QListWidget::QListWidget;
+
+protected:
+    void startDrag(Qt::DropActions supportedActions) override
+    {
+        QList<QUrl> urls;
+        for (QListWidgetItem* item : selectedItems()) {
+            urls << QUrl::fromLocalFile(item->data(kPathRole).toString());
+        }
+        if (urls.isEmpty()) {
+            return;
+        }
+        QMimeData* mimeData = new QMimeData;
+        mimeData->setUrls(urls);
+        QDrag* drag = new QDrag(this);
+        drag->setMimeData(mimeData);
+        drag->exec(supportedActions & Qt::CopyAction ? Qt::CopyAction : supportedActions);
+    }
+};
+
+}  // namespace
+
+MediaLibraryWidget::MediaLibraryWidget(MediaLibrary* library, QWidget* parent)
+    : QWidget(parent)
+    , m_library(library)
+{
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 4, 4, 4);
+    layout->setSpacing(4);
+
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setPlaceholderText("Search file names, titles and disk directories");
+    m_searchEdit->setClearButtonEnabled(true);
+    layout->addWidget(m_searchEdit);
+
+    m_results = new MediaResultList(this);
+    m_results->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_results->setDragEnabled(true);
+    m_results->setDragDropMode(QAbstractItemView::DragOnly);
+    m_results->setUniformItemSizes(true);
+    layout->addWidget(m_results, 1);
+
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setWordWrap(true);
+    layout->addWidget(m_statusLabel);
+
+    QHBoxLayout* buttons = new QHBoxLayout();
+    m_addFolderButton = new QPushButton("Add Folder...", this);
+    m_addFolderButton->setToolTip("Index the images in a folder and its subfolders");
+    m_removeFoldersButton = new QPushButton("Clear Folders", this);
+    m_removeFoldersButton->setToolTip("Stop indexing all folders and empty the library");
+    m_rescanButton = new QPushButton("Rescan", this);
+    m_rescanButton->setToolTip("Pick up added, changed and deleted files");
+    buttons->addWidget(m_addFolderButton);
+    buttons->addWidget(m_removeFoldersButton);
+    buttons->addStretch();
+    buttons->addWidget(m_rescanButton);
+    layout->addLayout(buttons);
+
+    // Typing and scan batches both refresh the list, at most every 150 ms
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(150);
+    connect(m_refreshTimer, &QTimer::timeout, this, &MediaLibraryWidget::refresh);
+    connect(m_searchEdit, &QLineEdit::textChanged, m_refreshTimer, QOverload<>::of(&QTimer::start));
+    connect(m_library, &MediaLibrary::indexChanged, m_refreshTimer, QOverload<>::of(&QTimer::start));
+    connect(m_library, &MediaLibrary::scanProgress, this, &MediaLibraryWidget::onScanProgress);
+    connect(m_library, &MediaLibrary::scanFinished, this, &MediaLibraryWidget::onScanFinished);
+    connect(m_results, &QListWidget::itemActivated, this, &MediaLibraryWidget::onItemActivated);
+    connect(m_addFolderButton, &QPushButton::clicked, this, &MediaLibraryWidget::onAddFolder);
+    connect(m_removeFoldersButton, &QPushButton::clicked, this, &MediaLibraryWidget::onRemoveFolders);
+    connect(m_rescanButton, &QPushButton::clicked, m_library, &MediaLibrary::rescan);
+
+    if (m_library->isScanning()) {
+        m_scanStatus = "Scanning...";
+    }
+    refresh();
+}
+
+void MediaLibraryWidget::refresh()
+{
+    const QVector<MediaLibrary::Entry> entries = m_library->search(m_searchEdit->text(), kMaxResults + 1);
+    m_results->setUpdatesEnabled(false);
+    m_results->clear();
+    for (int i = 0; i < entries.size() && i < kMaxResults; ++i) {
+        const MediaLibrary::Entry& entry = entries[i];
+        QListWidgetItem* item = new QListWidgetItem(QFileInfo(entry.path).fileName(), m_results);
+        item->setData(kPathRole, entry.path);
+        item->setData(kKindRole, static_cast<int>(entry.kind));
+        item->setToolTip(describe(entry));
+    }
+    m_results->setUpdatesEnabled(true);
+    updateStatus();
+    if (entries.size() > kMaxResults) {
+        m_statusLabel->setText(m_statusLabel->text() + QString(" - first %1 shown").arg(kMaxResults));
+    }
+}
+
+void MediaLibraryWidget::updateStatus()
+{
+    QString status;
+    if (m_library->folders().isEmpty()) {
+        status = "No folders indexed yet";
+    } else {
+        status = QString("%1 images in %2 folder(s)").arg(m_library->count()).arg(m_library->folders().size());
+    }
+    if (!m_scanStatus.isEmpty()) {
+        status += " - " + m_scanStatus;
+    }
+    m_statusLabel->setText(status);
+    m_removeFoldersButton->setEnabled(!m_library->folders().isEmpty());
+    m_rescanButton->setEnabled(!m_library->folders().isEmpty());
+}
+
+void MediaLibraryWidget::onAddFolder()
+{
+    const QString folder = QFileDialog::getExistingDirectory(this, "Add Folder to Media Library");
+    if (folder.isEmpty()) {
+        return;
+    }
+    QStringList folders = m_library->folders();
+    if (!folders.contains(folder)) {
+        folders << folder;
+    }
+    m_library->setFolders(folders);
+    QSettings settings("8bitrelics", "Fujisan");
+    settings.setValue("library/folders", folders);
+    m_scanStatus = "Scanning...";
+    m_library->rescan();
+    updateStatus();
+}
+
+void MediaLibraryWidget::onRemoveFolders()
+{
+    if (QMessageBox::question(this, "Clear Media Library",
+                              "Stop indexing every folder and remove all images from the library?\n"
+                              "The files themselves are not touched.") != QMessageBox::Yes) {
+        return;
+    }
+    m_library->setFolders(QStringList());
+    QSettings settings("8bitrelics", "Fujisan");
+    settings.remove("library/folders");
+    m_scanStatus.clear();
+    m_library->clear();
+    refresh();
+}
+
+void MediaLibraryWidget::onItemActivated(QListWidgetItem* item)
+{
+    emit openRequested(item->data(kPathRole).toString(),
+                       static_cast<MediaLibrary::Kind>(item->data(kKindRole).toInt()));
+}
+
+void MediaLibraryWidget::onScanProgress(int filesSeen, int filesRead)
+{
+    m_scanStatus = QString("scanning: %1 files, %2 new or changed").arg(filesSeen).arg(filesRead);
+    updateStatus();
+}
+
+void MediaLibraryWidget::onScanFinished(int filesSeen, int filesRead, qint64 elapsedMs)
+{
+    Q_UNUSED(filesSeen)
+    m_scanStatus = filesRead > 0 ? QString("%1 indexed in %2 s").arg(filesRead).arg(elapsedMs / 1000.0, 0, 'f', 1)
+                                 : QString();
+    updateStatus();
+}
+
+QString MediaLibraryWidget::describe(const MediaLibrary::Entry& entry)
+{
+    QStringList lines;
+    lines << entry.path;
+    if (entry.title != QFileInfo(entry.path).completeBaseName()) {
+        lines << entry.title;
+    }
+    const QJsonObject& details = entry.details;
+    switch (entry.kind) {
+    case MediaLibrary::Disk:
+        if (details.contains("sectors")) {
+            lines << QString("Disk: %1 sectors of %2 bytes").arg(details["sectors"].toInt())
+                     .arg(details["sector_size"].toInt());
+        } else {
+            lines << QString("Disk (%1)").arg(details["format"].toString().toUpper());
+        }
+        if (!entry.files.isEmpty()) {
+            const int shown = qMin(12, entry.files.size());
+            lines << entry.files.mid(0, shown).join("  ")
+                     + (entry.files.size() > shown ? QString("  (+%1)").arg(entry.files.size() - shown) : QString());
+        }
+        break;
+    case MediaLibrary::Executable:
+        if (details.contains("error")) {
+            lines << "Executable: " + details["error"].toString();
+        } else {
+            auto hex = [&details](const char* key) {
+                return QString("%1").arg(details[key].toInt(), 4, 16, QChar('0')).toUpper();
+            };
+            lines << QString("Executable: %1 segments, $%2-$%3, runs at $%4")
+                     .arg(details["segments"].toInt())
+                     .arg(hex("first_address"), hex("last_address"), hex("run_address"));
+        }
+        break;
+    case MediaLibrary::Cassette:
+        lines << QString("Cassette: %1 blocks at %2 baud").arg(details["blocks"].toInt()).arg(details["baud"].toInt());
+        break;
+    case MediaLibrary::Cartridge:
+        if (details["format"].toString() == "car") {
+            lines << QString("Cartridge type %1%2").arg(details["cart_type"].toInt())
+                     .arg(details["checksum_ok"].toBool() ? QString() : QString(" (bad checksum)"));
+        } else {
+            lines << QString("Raw cartridge image, %1 KB").arg(entry.size / 1024);
+        }
+        break;
+    }
+    lines << "SHA-1 " + QString::fromLatin1(entry.sha1);
+    return lines.join('\n');
+}
@@ -0,0 +1,206 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "mediarecorder.h"
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QMutexLocker>
+#include <QThread>
+#include <QDebug>
+#include <cstring>
+
+namespace {
+
+// Repeat chunks written for one gap in the frame numbers; larger jumps
+// (a state load, a rewind) are not stretched out in the recording
+constexpr quint64 kMaxRepeatedFrames = 600;
+
+}  // namespace
+
+MediaRecorder::MediaRecorder()
+    : m_slots(new Slot[kSlots])
+{
+}
+
+MediaRecorder::~MediaRecorder()
+{
+    stop();
+}
+
+bool MediaRecorder::start(const QString& path, const AviWriter::Format& format, QString* error)
+{
+    if (m_thread) {
+        if (error) {
+            *error = "Already recording to " + m_basePath;
+        }
+        return false;
+    }
+    if (!m_writer.open(path, format, error)) {
+        return false;
+    }
+    m_format = format;
+    m_basePath = path;
+    {
+        QMutexLocker locker(&m_filesMutex);
+        m_files = QStringList{path};
+    }
+    const int frameBytes = format.width * format.height;
+    for (int i = 0; i < kSlots; ++i) {
+        m_slots[i].pixels.reset(new unsigned char[frameBytes]);
+        m_slots[i].state.store(Free, std::memory_order_relaxed);
+    }
+    m_writeSlot = 0;
+    m_readSlot = 0;
+    m_pendingAudioBytes = 0;
+    m_haveFrame = false;
+    m_closedBytes = 0;
+    m_framesWritten.store(0);
+    m_framesDropped.store(0);
+    m_audioDropped.store(0);
+    m_bytesWritten.store(m_writer.bytesWritten());
+    m_filled.acquire(m_filled.available());
+
+    m_stopping.store(false);
+    m_thread = QThread::create([this]() { encodeLoop(); });
+    m_thread->setObjectName("MediaRecorder");
+    m_thread->start(QThread::LowPriority);
+    m_recording.store(true);
+    return true;
+}
+
+void MediaRecorder::stop()
+{
+    if (!m_thread) {
+        return;
+    }
+    m_recording.store(false);
+    m_stopping.store(true);
+    m_filled.release();  // wake the encoder to drain and exit
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+    m_writer.close();
+    m_bytesWritten.store(m_closedBytes + m_writer.bytesWritten());
+}
+
+void MediaRecorder::submitFrame(quint64 frame, const unsigned char* pixels, const unsigned char* audio,
+                                int audioBytes)
+{
+    if (!isRecording() || !pixels) {
+        return;
+    }
+    if (audio && audioBytes > 0) {
+        const int room = kMaxSlotAudioBytes - m_pendingAudioBytes;
+        const int bytes = qMin(audioBytes, room);
+        std::memcpy(m_pendingAudio + m_pendingAudioBytes, audio, static_cast<size_t>(bytes));
+        m_pendingAudioBytes += bytes;
+        if (bytes < audioBytes) {
+            m_audioDropped.fetch_add(static_cast<quint64>(audioBytes - bytes), std::memory_order_relaxed);
+        }
+    }
+
+    Slot& slot = m_slots[m_writeSlot];
+    if (slot.state.load(std::memory_order_acquire) != Free) {
+        // The encoder is behind: keep the audio for the next frame that fits
+        m_framesDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    slot.frame = frame;
+    std::memcpy(slot.pixels.get(), pixels, static_cast<size_t>(m_format.width * m_format.height));
+    std::memcpy(slot.audio, m_pendingAudio, static_cast<size_t>(m_pendingAudioBytes));
+    slot.audioBytes = m_pendingAudioBytes;
+    m_pendingAudioBytes = 0;
+    slot.state.store(Filled, std::memory_order_release);
+    m_writeSlot = (m_writeSlot + 1) % kSlots;
+    m_filled.release();
+}
+
+void MediaRecorder::encodeLoop()
+{
+    bool ok = true;
+    while (ok) {
+        m_filled.tryAcquire(1, 100);
+        Slot& slot = m_slots[m_readSlot];
+        if (slot.state.load(std::memory_order_acquire) != Filled) {
+            if (m_stopping.load()) {
+                break;  // drained: stop() submitted nothing after clearing m_recording
+            }
+            continue;
+        }
+        ok = encodeSlot(slot);
+        slot.state.store(Free, std::memory_order_release);
+        m_readSlot = (m_readSlot + 1) % kSlots;
+        m_bytesWritten.store(m_closedBytes + m_writer.bytesWritten(), std::memory_order_relaxed);
+    }
+    if (!ok) {
+        qWarning() << "Recording stopped: cannot write" << m_files.last();
+        m_recording.store(false);
+    }
+}
+
+bool MediaRecorder::encodeSlot(Slot& slot)
+{
+    if (m_writer.bytesWritten() >= AviWriter::kMaxFileBytes && !rollOver()) {
+        return false;
+    }
+    if (m_haveFrame && slot.frame > m_lastFrame + 1) {
+        const quint64 gap = qMin(slot.frame - m_lastFrame - 1, kMaxRepeatedFrames);
+        for (quint64 i = 0; i < gap; ++i) {
+            if (!m_writer.writeVideoFrame(nullptr)) {
+                return false;
+            }
+        }
+        m_framesWritten.fetch_add(gap, std::memory_order_relaxed);
+    }
+    if (!m_writer.writeVideoFrame(slot.pixels.get()) || !m_writer.writeAudio(slot.audio, slot.audioBytes)) {
+        return false;
+    }
+    m_lastFrame = slot.frame;
+    m_haveFrame = true;
+    m_framesWritten.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool MediaRecorder::rollOver()
+{
+    m_writer.close();
+    m_closedBytes += m_writer.bytesWritten();
+
+    const QFileInfo info(m_basePath);
+    QString path;
+    {
+        QMutexLocker locker(&m_filesMutex);
+        path = QString("%1/%2_%3.%4")
+                   .arg(info.path(), info.completeBaseName())
+                   .arg(m_files.size(), 3, 10, QChar('0'))
+                   .arg(info.suffix().isEmpty() ? QString("avi") : info.suffix());
+        m_files.append(path);
+    }
+    QString error;
+    if (!m_writer.open(path, m_format, &error)) {
+        qWarning() << "Recording rollover failed:" << error;
+        return false;
+    }
+    return true;
+}
+
+QJsonObject MediaRecorder::status() const
+{
+    QJsonObject status;
+    status["recording"] = isRecording();
+    {
+        QMutexLocker locker(&m_filesMutex);
+        status["files"] = QJsonArray::fromStringList(m_files);
+    }
+    const quint64 frames = m_framesWritten.load(std::memory_order_relaxed);
+    status["frames"] = static_cast<qint64>(frames);
+    status["dropped_frames"] = static_cast<qint64>(m_framesDropped.load(std::memory_order_relaxed));
+    status["dropped_audio_bytes"] = static_cast<qint64>(m_audioDropped.load(std::memory_order_relaxed));
+    status["bytes"] = m_bytesWritten.load(std::memory_order_relaxed);
+    status["seconds"] = m_format.fps > 0 ? frames / m_format.fps : 0.0;
+    return status;
+}
@@ -0,0 +1,324 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "messageencoder.h"
+
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QStringList>
+#include <QtEndian>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Fields the API fills with "$XXXX" hex for registers, addresses and memory
+// bytes (arrays included); a "$..." string anywhere else, the echoed request
+// id, screen text or a label, is the client's or the Atari's and stays a string
+bool isHexField(const QString& key)
+{
+    static const QStringList kHexFields = {
+        "pc", "a", "x", "y", "s", "p",
+        "address", "start", "end", "entry", "entry_point",
+        "value", "data", "breakpoints"
+    };
+    return kHexFields.contains(key);
+}
+
+// "$1F", "$D01A", ... as the API writes them: hex digits only, no sign
+bool parseHexString(const QString& text, qint64* value)
+{
+    if (text.size() < 2 || text.size() > 9 || text.at(0) != QLatin1Char('$')) {
+        return false;
+    }
+    for (int i = 1; i < text.size(); ++i) {
+        const ushort c = text.at(i).unicode();
+        if (c > 0x7F || !std::isxdigit(c)) {
+            return false;
+        }
+    }
+    bool ok = false;
+    *value = text.midRef(1).toLongLong(&ok, 16);
+    return ok;
+}
+
+// Doubles with no fractional part that JSON had to carry as numbers
+bool integralValue(double number, qint64* value)
+{
+    if (std::floor(number) != number || std::fabs(number) > 9007199254740992.0) {
+        return false;
+    }
+    *value = static_cast<qint64>(number);
+    return true;
+}
+
+QCborValue cborValue(const QJsonValue& value, bool hexField);
+
+QCborMap cborMap(const QJsonObject& object)
+{
+    QCborMap map;
+    for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+        map.insert(it.key(), cborValue(it.value(), isHexField(it.key())));
+    }
+    return map;
+}
+
+// hexField: the value (or, for an array, each element) belongs to an isHexField() key
+QCborValue cborValue(const QJsonValue& value, bool hexField)
+{
+    qint64 integer = 0;
+    switch (value.type()) {
+    case QJsonValue::Bool:
+        return QCborValue(value.toBool());
+    case QJsonValue::Double:
+        if (integralValue(value.toDouble(), &integer)) {
+            return QCborValue(integer);
+        }
+        return QCborValue(value.toDouble());
+    case QJsonValue::String:
+        if (hexField && parseHexString(value.toString(), &integer)) {
+            return QCborValue(integer);
+        }
+        return QCborValue(value.toString());
+    case QJsonValue::Array: {
+        QCborArray array;
+        for (const QJsonValue& element : value.toArray()) {
+            array.append(cborValue(element, hexField));
+        }
+        return array;
+    }
+    case QJsonValue::Object:
+        return cborMap(value.toObject());
+    default:
+        return QCborValue(QCborValue::Null);
+    }
+}
+
+class MsgPackWriter
+{
+public:
+    explicit MsgPackWriter(QByteArray& out) : m_out(out) {}
+
+    void write(const QJsonValue& value, bool hexField)
+    {
+        qint64 integer = 0;
+        switch (value.type()) {
+        case QJsonValue::Bool:
+            m_out.append(char(value.toBool() ? 0xC3 : 0xC2));
+            break;
+        case QJsonValue::Double:
+            if (integralValue(value.toDouble(), &integer)) {
+                writeInteger(integer);
+            } else {
+                writeDouble(value.toDouble());
+            }
+            break;
+        case QJsonValue::String:
+            if (hexField && parseHexString(value.toString(), &integer)) {
+                writeInteger(integer);
+            } else {
+                writeString(value.toString());
+            }
+            break;
+        case QJsonValue::Array: {
+            const QJsonArray array = value.toArray();
+            writeHeader(array.size(), 0x90, 15, 0xDC);
+            for (const QJsonValue& element : array) {
+                write(element, hexField);
+            }
+            break;
+        }
+        case QJsonValue::Object:
+            writeObject(value.toObject());
+            break;
+        default:
+            m_out.append(char(0xC0));
+            break;
+        }
+    }
+
+    void writeObject(const QJsonObject& object)
+    {
+        writeHeader(object.size(), 0x80, 15, 0xDE);
+        for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+            writeString(it.key());
+            write(it.value(), isHexField(it.key()));
+        }
+    }
+
+private:
+    template <typename T>
+    void append(T value)
+    {
+        uchar bytes[sizeof(T)];
+        qToBigEndian(value, bytes);
+        m_out.append(reinterpret_cast<const char*>(bytes), int(sizeof(T)));
+    }
+
+    void writeDouble(double number)
+    {
+        quint64 bits = 0;
+        static_assert(sizeof(bits) == sizeof(number), "double is not 64-bit");
+        std::memcpy(&bits, &number, sizeof(bits));
+        m_out.append(char(0xCB));
+        append<quint64>(bits);
+    }
+
+    void writeInteger(qint64 value)
+    {
+        if (value >= 0) {
+            if (value <= 0x7F) {
+                m_out.append(char(value));
+            } else if (value <= 0xFF) {
+                m_out.append(char(0xCC));
+                m_out.append(char(value));
+            } else if (value <= 0xFFFF) {
+                m_out.append(char(0xCD));
+                append<quint16>(quint16(value));
+            } else if (value <= 0xFFFFFFFFll) {
+                m_out.append(char(0xCE));
+                append<quint32>(quint32(value));
+            } else {
+                m_out.append(char(0xCF));
+                append<quint64>(quint64(value));
+            }
+        } else if (value >= -32) {
+            m_out.append(char(value));
+        } else if (value >= -128) {
+            m_out.append(char(0xD0));
+            m_out.append(char(value));
+        } else if (value >= -32768) {
+            m_out.append(char(0xD1));
+            append<qint16>(qint16(value));
+        } else if (value >= -2147483648ll) {
+            m_out.append(char(0xD2));
+            append<qint32>(qint32(value));
+        } else {
+            m_out.append(char(0xD3));
+            append<qint64>(value);
+        }
+    }
+
+    void writeString(const QString& text)
+    {
+        const QByteArray utf8 = text.toUtf8();
+        const int size = utf8.size();
+        if (size <= 31) {
+            m_out.append(char(0xA0 | size));
+        } else if (size <= 0xFF) {
+            m_out.append(char(0xD9));
+            m_out.append(char(size));
+        } else if (size <= 0xFFFF) {
+            m_out.append(char(0xDA));
+            append<quint16>(quint16(size));
+        } else {
+            m_out.append(char(0xDB));
+            append<quint32>(quint32(size));
+        }
+        m_out.append(utf8);
+    }
+
+    // fixarray/fixmap up to fixMax entries, then the 16- or 32-bit form
+    void writeHeader(int count, int fixMarker, int fixMax, int marker16)
+    {
+        if (count <= fixMax) {
+            m_out.append(char(fixMarker | count));
+        } else if (count <= 0xFFFF) {
+            m_out.append(char(marker16));
+            append<quint16>(quint16(count));
+        } else {
+            m_out.append(char(marker16 + 1));
+            append<quint32>(quint32(count));
+        }
+    }
+
+    QByteArray& m_out;
+};
+
+}  // namespace
+
+QByteArray MessageEncoder::encode(const QJsonObject& message, bool* compressed) const
+{
+    if (compressed) {
+        *compressed = false;
+    }
+    QByteArray payload;
+    switch (m_encoding) {
+    case EncodingCbor:
+        payload = toCbor(message);
+        break;
+    case EncodingMsgPack:
+        payload = toMsgPack(message);
+        break;
+    default:
+        payload = QJsonDocument(message).toJson(QJsonDocument::Compact);
+        if (!isFramed()) {
+            return payload + "\n";
+        }
+        break;
+    }
+
+    quint32 header = quint32(payload.size());
+    if (m_compressThreshold > 0 && payload.size() >= m_compressThreshold) {
+        // qCompress prefixes the zlib stream with the uncompressed size; clients get the bare stream
+        const QByteArray deflated = qCompress(payload).mid(4);
+        if (deflated.size() < payload.size()) {
+            payload = deflated;
+            header = quint32(payload.size()) | kCompressedFlag;
+            if (compressed) {
+                *compressed = true;
+            }
+        }
+    }
+    QByteArray frame(4, Qt::Uninitialized);
+    qToBigEndian(header, reinterpret_cast<uchar*>(frame.data()));
+    frame.append(payload);
+    return frame;
+}
+
+QByteArray MessageEncoder::toCbor(const QJsonObject& message)
+{
+    return QCborValue(cborMap(message)).toCbor();
+}
+
+QByteArray MessageEncoder::toMsgPack(const QJsonObject& message)
+{
+    QByteArray out;
+    out.reserve(256);
+    MsgPackWriter(out).writeObject(message);
+    return out;
+}
+
+bool MessageEncoder::parseEncoding(const QString& name, Encoding* encoding)
+{
+    if (name == "json") {
+        *encoding = EncodingJson;
+    } else if (name == "cbor") {
+        *encoding = EncodingCbor;
+    } else if (name == "msgpack") {
+        *encoding = EncodingMsgPack;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QString MessageEncoder::encodingName(Encoding encoding)
+{
+    switch (encoding) {
+    case EncodingCbor:
+        return "cbor";
+    case EncodingMsgPack:
+        return "msgpack";
+    default:
+        return "json";
+    }
+}
@@ -0,0 +1,212 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "performancemonitor.h"
+
+#include <QJsonArray>
+#include <algorithm>
+
+namespace {
+
+constexpr quint64 kMask = PerformanceMonitor::kWindow - 1;
+
+qint32 percentileOf(const QVector<qint32>& sorted, double fraction)
+{
+    if (sorted.isEmpty()) {
+        return 0;
+    }
+    const int index = qBound(0, static_cast<int>(fraction * sorted.size() + 0.5) - 1, sorted.size() - 1);
+    return sorted[index];
+}
+
+}  // namespace
+
+void PerformanceMonitor::record(Metric metric, qint32 value)
+{
+    if (!m_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    Series& series = m_series[metric];
+    const quint64 index = series.recorded.load(std::memory_order_relaxed);
+    series.samples[index & kMask].store(value, std::memory_order_relaxed);
+    series.recorded.store(index + 1, std::memory_order_release);
+    series.total.fetch_add(value, std::memory_order_relaxed);
+    // Single producer: nobody else raises it between the load and the store
+    if (value > series.max.load(std::memory_order_relaxed)) {
+        series.max.store(value, std::memory_order_relaxed);
+    }
+}
+
+QVector<qint32> PerformanceMonitor::window(Metric metric) const
+{
+    const Series& series = m_series[metric];
+    const quint64 end = series.recorded.load(std::memory_order_acquire);
+    const quint64 resetAt = series.resetAt.load(std::memory_order_relaxed);
+    quint64 begin = end > static_cast<quint64>(kWindow) ? end - kWindow : 0;
+    begin = qMin(end, qMax(begin, resetAt));
+
+    QVector<qint32> samples;
+    samples.reserve(static_cast<int>(end - begin));
+    for (quint64 i = begin; i < end; ++i) {
+        samples.append(series.samples[i & kMask].load(std::memory_order_relaxed));
+    }
+    // Slots the producer reused while they were copied now hold newer samples
+    const quint64 after = series.recorded.load(std::memory_order_acquire);
+    const quint64 overwritten = after > static_cast<quint64>(kWindow) ? after - kWindow : 0;
+    if (overwritten > begin) {
+        samples.remove(0, static_cast<int>(qMin(overwritten - begin, end - begin)));
+    }
+    return samples;
+}
+
+double PerformanceMonitor::emulationPercent() const
+{
+    const QVector<qint32> intervals = window(FrameInterval);
+    if (intervals.isEmpty()) {
+        return 0.0;
+    }
+    qint64 total = 0;
+    for (qint32 interval : intervals) {
+        total += interval;
+    }
+    if (total <= 0) {
+        return 0.0;
+    }
+    return 100.0 * nominalFrameUs() * intervals.size() / total;
+}
+
+QJsonObject PerformanceMonitor::toJson(int history) const
+{
+    QJsonObject result;
+    result["enabled"] = isEnabled();
+    result["window"] = kWindow;
+    result["nominal_frame_us"] = nominalFrameUs();
+    result["emulation_percent"] = emulationPercent();
+
+    QJsonObject metrics;
+    for (int i = 0; i < kMetricCount; ++i) {
+        const Metric metric = static_cast<Metric>(i);
+        const Series& series = m_series[metric];
+        const QVector<qint32> samples = window(metric);
+        QJsonObject entry = summary(metric, samples);
+        entry["recorded"] = static_cast<qint64>(series.recorded.load(std::memory_order_relaxed)
+                                                - series.resetAt.load(std::memory_order_relaxed));
+        entry["total"] = static_cast<double>(series.total.load(std::memory_order_relaxed));
+        entry["max_all_time"] = series.max.load(std::memory_order_relaxed);
+        if (history > 0) {
+            QJsonArray recent;
+            for (int s = qMax(0, samples.size() - history); s < samples.size(); ++s) {
+                recent.append(samples[s]);
+            }
+            entry["history"] = recent;
+        }
+        metrics[metricName(metric)] = entry;
+    }
+    result["metrics"] = metrics;
+    return result;
+}
+
+void PerformanceMonitor::reset()
+{
+    for (Series& series : m_series) {
+        series.resetAt.store(series.recorded.load(std::memory_order_acquire), std::memory_order_relaxed);
+        series.total.store(0, std::memory_order_relaxed);
+        series.max.store(0, std::memory_order_relaxed);
+    }
+}
+
+QJsonObject PerformanceMonitor::summary(Metric metric, const QVector<qint32>& samples)
+{
+    QJsonObject result;
+    result["unit"] = unit(metric);
+    result["count"] = samples.size();
+    if (samples.isEmpty()) {
+        return result;
+    }
+
+    QVector<qint32> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    qint64 sum = 0;
+    for (qint32 value : samples) {
+        sum += value;
+    }
+    result["last"] = samples.last();
+    result["min"] = sorted.first();
+    result["mean"] = static_cast<double>(sum) / samples.size();
+    result["p50"] = percentileOf(sorted, 0.50);
+    result["p90"] = percentileOf(sorted, 0.90);
+    result["p99"] = percentileOf(sorted, 0.99);
+    result["max"] = sorted.last();
+
+    if (metric == AudioUnderruns) {
+        result["sum"] = static_cast<double>(sum);
+    } else if (metric == AudioFill) {
+        // [0-10), [10-20), ... [90-100]
+        QJsonArray buckets;
+        int counts[10] = {};
+        for (qint32 value : samples) {
+            counts[qBound(0, value / 10, 9)]++;
+        }
+        for (int count : counts) {
+            buckets.append(count);
+        }
+        result["histogram"] = buckets;
+    } else {
+        // Bucket 0: under 2 us, bucket i: [2^i, 2^(i+1)) us, up to the largest sample
+        QJsonArray buckets;
+        QVector<int> counts;
+        for (qint32 value : samples) {
+            int bucket = 0;
+            for (quint32 v = static_cast<quint32>(qMax(0, value)) >> 1; v; v >>= 1) {
+                bucket++;
+            }
+            if (bucket >= counts.size()) {
+                counts.resize(bucket + 1);
+            }
+            counts[bucket]++;
+        }
+        for (int count : counts) {
+            buckets.append(count);
+        }
+        result["histogram"] = buckets;
+    }
+    return result;
+}
+
+QString PerformanceMonitor::metricName(Metric metric)
+{
+    switch (metric) {
+    case FrameInterval:
+        return "frame_interval";
+    case EmulatedFrame:
+        return "emulated_frame";
+    case Render:
+        return "render";
+    case PresentLatency:
+        return "present_latency";
+    case AudioFill:
+        return "audio_fill";
+    case AudioUnderruns:
+        return "audio_underruns";
+    case SioWait:
+        return "sio_wait";
+    default:
+        return "gui_stall";
+    }
+}
+
+QString PerformanceMonitor::unit(Metric metric)
+{
+    switch (metric) {
+    case AudioFill:
+        return "percent";
+    case AudioUnderruns:
+        return "count";
+    default:
+        return "us";
+    }
+}
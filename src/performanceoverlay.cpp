@@ -0,0 +1,160 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "performanceoverlay.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <QTimer>
+
+namespace {
+
+const char* rowLabel(PerformanceMonitor::Metric metric)
+{
+    switch (metric) {
+    case PerformanceMonitor::FrameInterval:
+        return "Frame interval";
+    case PerformanceMonitor::EmulatedFrame:
+        return "Emulated frame";
+    case PerformanceMonitor::Render:
+        return "Render";
+    case PerformanceMonitor::PresentLatency:
+        return "Present latency";
+    case PerformanceMonitor::AudioFill:
+        return "Audio fill";
+    case PerformanceMonitor::AudioUnderruns:
+        return "Audio underruns";
+    case PerformanceMonitor::SioWait:
+        return "SIO wait";
+    default:
+        return "GUI stalls";
+    }
+}
+
+}  // namespace
+
+PerformanceOverlay::PerformanceOverlay(PerformanceMonitor* monitor, QWidget* parent)
+    : QWidget(parent)
+    , m_monitor(monitor)
+    , m_refreshTimer(new QTimer(this))
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setAttribute(Qt::WA_NoSystemBackground);
+    setFocusPolicy(Qt::NoFocus);
+    resize(sizeHint());
+
+    m_refreshTimer->setInterval(kRefreshMs);
+    connect(m_refreshTimer, &QTimer::timeout, this, QOverload<>::of(&QWidget::update));
+}
+
+QSize PerformanceOverlay::sizeHint() const
+{
+    return QSize(kWidth, 26 + PerformanceMonitor::kMetricCount * kRowHeight);
+}
+
+void PerformanceOverlay::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    m_refreshTimer->start();
+}
+
+void PerformanceOverlay::hideEvent(QHideEvent* event)
+{
+    QWidget::hideEvent(event);
+    m_refreshTimer->stop();
+}
+
+QString PerformanceOverlay::formatValue(PerformanceMonitor::Metric metric, qint32 value)
+{
+    const QString unit = PerformanceMonitor::unit(metric);
+    if (unit == "percent") {
+        return QString("%1%").arg(value);
+    }
+    if (unit == "count") {
+        return QString::number(value);
+    }
+    return value >= 1000 ? QString("%1 ms").arg(value / 1000.0, 0, 'f', 1) : QString("%1 us").arg(value);
+}
+
+void PerformanceOverlay::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event)
+
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.fillRect(rect(), QColor(0, 0, 0, 170));
+    QFont font = painter.font();
+    font.setPointSizeF(8.5);
+    painter.setFont(font);
+
+    const int margin = 6;
+    const int width = this->width() - 2 * margin;
+    painter.setPen(Qt::white);
+    if (!m_monitor || !m_monitor->isEnabled()) {
+        painter.drawText(QRect(margin, 4, width, 18), Qt::AlignLeft | Qt::AlignVCenter,
+                         "Performance monitor off");
+        return;
+    }
+    painter.drawText(QRect(margin, 4, width, 18), Qt::AlignLeft | Qt::AlignVCenter,
+                     QString("Emulation %1%").arg(m_monitor->emulationPercent(), 0, 'f', 1));
+
+    const qint32 nominalUs = m_monitor->nominalFrameUs();
+    for (int i = 0; i < PerformanceMonitor::kMetricCount; ++i) {
+        const auto metric = static_cast<PerformanceMonitor::Metric>(i);
+        const QVector<qint32> samples = m_monitor->window(metric);
+        const QJsonObject summary = PerformanceMonitor::summary(metric, samples);
+        const int top = 26 + i * kRowHeight;
+
+        QString values = "-";
+        if (!samples.isEmpty()) {
+            if (metric == PerformanceMonitor::AudioUnderruns) {
+                values = QString("%1 in %2 frames").arg(summary["sum"].toInt()).arg(samples.size());
+            } else {
+                values = QString("p50 %1  p99 %2  max %3")
+                             .arg(formatValue(metric, summary["p50"].toInt()))
+                             .arg(formatValue(metric, summary["p99"].toInt()))
+                             .arg(formatValue(metric, summary["max"].toInt()));
+            }
+        }
+        painter.setPen(QColor(200, 200, 200));
+        painter.drawText(QRect(margin, top, width, 14), Qt::AlignLeft | Qt::AlignVCenter, rowLabel(metric));
+        painter.setPen(Qt::white);
+        painter.drawText(QRect(margin, top, width, 14), Qt::AlignRight | Qt::AlignVCenter, values);
+
+        // Graph of the newest samples, scaled to the frame time for the timings
+        // so a value that matters always stands out
+        const QRect graph(margin, top + 15, width, kRowHeight - 18);
+        painter.fillRect(graph, QColor(255, 255, 255, 25));
+        const int count = qMin(samples.size(), int(kGraphSamples));
+        if (count == 0) {
+            continue;
+        }
+        qint32 scale = 1;
+        if (metric == PerformanceMonitor::AudioFill) {
+            scale = 100;
+        } else if (metric == PerformanceMonitor::AudioUnderruns) {
+            scale = qMax(1, summary["max"].toInt());
+        } else {
+            scale = qMax(metric == PerformanceMonitor::FrameInterval ? 2 * nominalUs : nominalUs,
+                         summary["max"].toInt());
+        }
+        const double step = double(graph.width()) / kGraphSamples;
+        QPainterPath path;
+        for (int s = 0; s < count; ++s) {
+            const qint32 value = samples[samples.size() - count + s];
+            const double x = graph.left() + (kGraphSamples - count + s) * step;
+            const double y = graph.bottom() - qMin(1.0, double(value) / scale) * graph.height();
+            if (s == 0) {
+                path.moveTo(x, y);
+            } else {
+                path.lineTo(x, y);
+            }
+        }
+        painter.setPen(QPen(metric == PerformanceMonitor::AudioUnderruns || metric == PerformanceMonitor::GuiStall
+                                ? QColor(255, 120, 90) : QColor(120, 220, 140), 1.2));
+        painter.drawPath(path);
+    }
+}
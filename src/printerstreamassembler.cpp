@@ -0,0 +1,62 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "printerstreamassembler.h"
+
+#include <cstring>
+
+PrinterStreamAssembler::Update PrinterStreamAssembler::feed(const QByteArray& payload)
+{
+    Update update;
+    if (m_received > 0 && continuesCurrentJob(payload)) {
+        if (payload.size() == m_received) {
+            return update;
+        }
+        update.kind = Appended;
+        update.delta = payload.mid(int(m_received));
+    } else {
+        if (payload.isEmpty()) {
+            return update;
+        }
+        update.kind = NewJob;
+        update.delta = payload;
+        m_head.clear();
+    }
+    remember(payload);
+    return update;
+}
+
+void PrinterStreamAssembler::reset()
+{
+    m_head.clear();
+    m_tail.clear();
+    m_received = 0;
+}
+
+bool PrinterStreamAssembler::continuesCurrentJob(const QByteArray& payload) const
+{
+    if (payload.size() < m_received) {
+        return false;
+    }
+    const char* data = payload.constData();
+    if (std::memcmp(data, m_head.constData(), size_t(m_head.size())) != 0) {
+        return false;
+    }
+    const qint64 tailStart = m_received - m_tail.size();
+    return std::memcmp(data + tailStart, m_tail.constData(), size_t(m_tail.size())) == 0;
+}
+
+void PrinterStreamAssembler::remember(const QByteArray& payload)
+{
+    // The head only needs topping up while the job is shorter than the window
+    if (m_head.size() < kWindowBytes) {
+        m_head = payload.left(kWindowBytes);
+    }
+    const int tailBytes = qMin(payload.size(), int(kWindowBytes));
+    m_tail = payload.right(tailBytes);
+    m_received = payload.size();
+}
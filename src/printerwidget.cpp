@@ -15,7 +15,6 @@
 #include <QDesktopServices>
 #include <QTimer>
 #include <QFile>
-#include <QCryptographicHash>
 #include <QMessageBox>
 #include <QPropertyAnimation>
 #include <QParallelAnimationGroup>
@@ -23,6 +22,7 @@
 #include <QPainter>
 #include <QMouseEvent>
 #include <QGraphicsOpacityEffect>
+#include <QTextCursor>
 
 const QStringList PrinterWidget::OUTPUT_FORMATS = {"Text", "Raw"};
 const QString PrinterWidget::DEFAULT_FORMAT = "Text";
@@ -74,6 +74,7 @@ PrinterWidget::PrinterWidget(QWidget *parent)
     , m_outputFormat(DEFAULT_FORMAT)
     , m_printerType(DEFAULT_PRINTER_TYPE)
     , m_lastSaveDir(QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation))
+    , m_viewerEndsWithNewline(false)
     , m_duplicateCount(0)
     , m_scrollAnimation(nullptr)
     , m_tearAnimation(nullptr)
@@ -248,7 +249,7 @@ void PrinterWidget::setPrinterEnabled(bool enabled)
 
         // Clear deduplication state when toggling printer
         if (enabled) {
-            m_lastReceivedHash.clear();
+            m_printerStream.reset();
             m_duplicateCount = 0;
             qDebug() << "Cleared deduplication state (printer re-enabled)";
             // Note: Printer connection (SSE/polling) is handled by configurePrinter()
@@ -306,11 +307,7 @@ void PrinterWidget::appendText(const QString& text)
 
     // Update output viewer if open
     if (m_outputViewer && m_outputViewer->isVisible() && m_outputDisplay) {
-        m_outputDisplay->appendPlainText(text);
-
-        // Auto-scroll to bottom
-        QScrollBar* scrollBar = m_outputDisplay->verticalScrollBar();
-        scrollBar->setValue(scrollBar->maximum());
+        appendToViewer(text);
     }
 
     // Trigger scroll animation
@@ -319,6 +316,31 @@ void PrinterWidget::appendText(const QString& text)
     updateControls();
 }
 
+void PrinterWidget::appendToViewer(const QString& text)
+{
+    // Insert only the new text at the end: the document keeps its existing
+    // blocks, so the cost follows the chunk rather than the whole job
+    QString chunk = text;
+    if (m_outputFormat == "Text") {
+        chunk.replace('\r', '\n');
+        chunk.replace("\n\n", "\n");
+        // Same collapse for a line end split across two chunks
+        if (m_viewerEndsWithNewline && chunk.startsWith('\n')) {
+            chunk.remove(0, 1);
+        }
+    }
+    if (chunk.isEmpty()) return;
+
+    QTextCursor cursor(m_outputDisplay->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(chunk);
+    m_viewerEndsWithNewline = chunk.endsWith('\n');
+
+    // Auto-scroll to bottom
+    QScrollBar* scrollBar = m_outputDisplay->verticalScrollBar();
+    scrollBar->setValue(scrollBar->maximum());
+}
+
 void PrinterWidget::clearOutput()
 {
     qDebug() << "PrinterWidget::clearOutput() called - playing tear animation";
@@ -363,14 +385,14 @@ void PrinterWidget::clearOutput()
             static_cast<QGraphicsOpacityEffect*>(m_formDisplay->graphicsEffect())->setOpacity(1.0);
         }
 
-        // Clear display buffers but PRESERVE hash to prevent re-showing torn data
+        // Clear display buffers but PRESERVE the stream position to prevent re-showing torn data
         m_outputBuffer.clear();
         m_lastPrinterData.clear();    // Clear this - prevents pause on duplicates
         m_lastContentType.clear();
-        // DON'T clear m_lastReceivedHash - keeps old data from re-appearing
+        // DON'T reset m_printerStream - keeps old data from re-appearing
         m_duplicateCount = 0;         // Reset counter so duplicates don't pause
 
-        qDebug() << "Tear complete - display cleared, hash preserved to prevent re-showing torn data";
+        qDebug() << "Tear complete - display cleared, stream position preserved to prevent re-showing torn data";
 
         // Request clear of FujiNet-PC printer buffer
         emit requestClearPrinterBuffer();
@@ -382,6 +404,7 @@ void PrinterWidget::clearOutput()
             qDebug() << "Clearing output display";
             m_outputDisplay->clear();
             m_outputDisplay->setPlainText(formatTextForOutput(m_outputBuffer));
+            m_viewerEndsWithNewline = m_outputDisplay->toPlainText().endsWith('\n');
         }
 
         updateControls();
@@ -397,7 +420,7 @@ void PrinterWidget::clearOutput()
 void PrinterWidget::resetDeduplicationHash()
 {
     qDebug() << "Resetting deduplication hash - server buffer cleared";
-    m_lastReceivedHash.clear();
+    m_printerStream.reset();
     m_duplicateCount = 0;
 }
 
@@ -519,7 +542,7 @@ void PrinterWidget::loadSettings()
     // If printer is enabled on startup, clear deduplication state for fresh start
     // This ensures stale state from previous session doesn't block initial polling
     if (m_printerEnabled) {
-        m_lastReceivedHash.clear();
+        m_printerStream.reset();
         m_duplicateCount = 0;
         qDebug() << "Printer enabled on startup - cleared deduplication state";
     }
@@ -563,7 +586,7 @@ void PrinterWidget::onPrinterTypeChanged(const QString& type)
 
         // Clear deduplication state when printer type changes
         // Different printer type may produce different output format
-        m_lastReceivedHash.clear();
+        m_printerStream.reset();
         m_duplicateCount = 0;
         qDebug() << "Cleared deduplication state for new printer type";
 
@@ -924,6 +947,7 @@ void PrinterWidget::updateViewerForCurrentState()
     qDebug() << "updateViewerForCurrentState: formatted text empty?" << formattedText.isEmpty();
 
     m_outputDisplay->setPlainText(formattedText);
+    m_viewerEndsWithNewline = formattedText.endsWith('\n');
     qDebug() << "updateViewerForCurrentState: text set successfully";
 
     // Force a repaint
@@ -944,9 +968,10 @@ void PrinterWidget::displayPrinterOutput(const QByteArray& data, const QString&
         return;
     }
 
-    // Deduplication: Check if this is the same data we already processed
-    QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Md5);
-    if (hash == m_lastReceivedHash) {
+    // Deduplication: FujiNet-PC returns the whole job on every poll, so only
+    // the part past what has already been shown is new
+    const PrinterStreamAssembler::Update update = m_printerStream.feed(data);
+    if (update.kind == PrinterStreamAssembler::Duplicate) {
         m_duplicateCount++;
         // qDebug() << "Ignoring duplicate printer output (count:" << m_duplicateCount << ")";
 
@@ -959,17 +984,34 @@ void PrinterWidget::displayPrinterOutput(const QByteArray& data, const QString&
         return;
     }
 
-    // NEW DATA - Validate BEFORE storing hash or processing
-    if (!validatePrinterOutput(data, contentType)) {
-        // Invalid data - DON'T store hash, DON'T pause polling
+    const bool isText = contentType.contains("text", Qt::CaseInsensitive);
+
+    // Text that grew in place: only the new lines need showing. After a tear
+    // the job carries on from there instead of bringing the torn part back.
+    const bool grewInPlace = update.kind == PrinterStreamAssembler::Appended && isText &&
+                             (m_lastContentType.isEmpty() || contentType == m_lastContentType);
+    if (grewInPlace && !m_lastPrinterData.isEmpty() && m_formDisplay->isVisible()) {
+        m_duplicateCount = 0;
+        m_lastProcessedTime = QDateTime::currentMSecsSinceEpoch();
+        m_lastPrinterData.append(update.delta);
+        appendText(QString::fromUtf8(update.delta));
+        if (!m_outputViewer || !m_outputViewer->isVisible()) {
+            showOutputViewer();  // Reopen the viewer with the whole job
+        }
+        return;
+    }
+
+    // NEW DATA - Validate BEFORE processing
+    if (!grewInPlace && !validatePrinterOutput(data, contentType)) {
+        // Invalid data - forget it, DON'T pause polling
         // Just silently ignore and continue polling for valid data
         // qDebug() << "Ignoring invalid printer output";
+        m_printerStream.reset();
         return;
     }
 
     // VALID NEW DATA - process normally
     m_duplicateCount = 0;
-    m_lastReceivedHash = hash;
     m_lastProcessedTime = QDateTime::currentMSecsSinceEpoch();
 
     // Auto-clear previous output before processing new data
@@ -979,10 +1021,14 @@ void PrinterWidget::displayPrinterOutput(const QByteArray& data, const QString&
         m_outputBuffer.clear();
         m_lastPrinterData.clear();
         m_lastContentType.clear();
+        if (m_outputDisplay) {
+            m_outputDisplay->clear();
+            m_viewerEndsWithNewline = false;
+        }
     }
 
     // Store the data for manual save
-    m_lastPrinterData = data;
+    m_lastPrinterData = grewInPlace ? update.delta : data;
     m_lastContentType = contentType;
 
     // Enable controls now that we have output
@@ -994,7 +1040,7 @@ void PrinterWidget::displayPrinterOutput(const QByteArray& data, const QString&
     else if (contentType.contains("png", Qt::CaseInsensitive)) formatName = "PNG";
     else if (contentType.contains("svg", Qt::CaseInsensitive)) formatName = "SVG";
     else if (contentType.contains("html", Qt::CaseInsensitive)) formatName = "HTML";
-    else if (contentType.contains("text", Qt::CaseInsensitive)) formatName = "text";
+    else if (isText) formatName = "text";
 
     // Trigger animation to indicate printing
     // If form is hidden, make it visible and slide up from bottom
@@ -1019,11 +1065,11 @@ void PrinterWidget::displayPrinterOutput(const QByteArray& data, const QString&
 
     scrollFormUp(40);  // Scroll 40px up
 
-    qDebug() << "Print ready:" << formatName << data.size() << "bytes - form scrolled";
+    qDebug() << "Print ready:" << formatName << m_lastPrinterData.size() << "bytes - form scrolled";
 
     // For text output, auto-show the viewer window
-    if (contentType.contains("text", Qt::CaseInsensitive)) {
-        QString text = QString::fromUtf8(data);
+    if (isText) {
+        QString text = QString::fromUtf8(m_lastPrinterData);
         appendText(text);
         showOutputViewer();  // Auto-show viewer window for text
     }
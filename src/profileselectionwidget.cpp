@@ -386,6 +386,12 @@ void ProfileSelectionWidget::connectSignals()
 {
     connect(m_profileCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &ProfileSelectionWidget::onProfileComboChanged);
+    // Warm the hovered profile's media while the list is open
+    connect(m_profileCombo, QOverload<int>::of(&QComboBox::highlighted), this, [this](int index) {
+        if (m_profileManager && index >= 0) {
+            m_profileManager->preloadProfileMedia(m_profileCombo->itemText(index));
+        }
+    });
     
     connect(m_saveButton, &QPushButton::clicked, this, &ProfileSelectionWidget::onSaveClicked);
     connect(m_saveAsButton, &QPushButton::clicked, this, &ProfileSelectionWidget::onSaveAsClicked);
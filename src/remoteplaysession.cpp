@@ -0,0 +1,125 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "remoteplaysession.h"
+
+#include <QList>
+#include <algorithm>
+
+RemotePlaySession::RemotePlaySession(int jitterFrames, bool adaptive, int targetRttMs)
+    : m_jitterFrames(qBound(0, jitterFrames, kMaxJitterFrames))
+    , m_adaptive(adaptive)
+    , m_targetRttMs(qMax(1, targetRttMs))
+{
+}
+
+bool RemotePlaySession::queueInput(const InputPacket& packet, quint64 frame)
+{
+    // Serial number arithmetic, so the client's counter may wrap
+    if (m_hasSequence && static_cast<qint32>(packet.sequence - m_lastSequence) <= 0) {
+        m_lateInput++;
+        return false;
+    }
+    m_hasSequence = true;
+    m_lastSequence = packet.sequence;
+
+    QueuedInput queued;
+    queued.packet = packet;
+    queued.releaseFrame = frame + static_cast<quint64>(m_jitterFrames);
+    if (!m_queue.isEmpty()) {
+        // Spread bursts one packet per frame, but never hold one past twice the delay
+        const quint64 latest = frame + 2 * static_cast<quint64>(m_jitterFrames) + 1;
+        queued.releaseFrame = qMax(queued.releaseFrame, qMin(m_lastRelease + 1, latest));
+    }
+    m_lastRelease = queued.releaseFrame;
+    m_queue.append(queued);
+    return true;
+}
+
+QVector<RemotePlaySession::InputPacket> RemotePlaySession::takeDueInput(quint64 frame)
+{
+    const bool rewound = frame < m_lastFrame;
+    m_lastFrame = frame;
+
+    QVector<InputPacket> due;
+    int count = 0;
+    while (count < m_queue.size() && (rewound || m_queue[count].releaseFrame <= frame)) {
+        due.append(m_queue[count].packet);
+        count++;
+    }
+    m_queue.remove(0, count);
+    if (rewound) {
+        m_lastRelease = frame;
+    }
+    m_appliedInput += static_cast<quint64>(count);
+    return due;
+}
+
+void RemotePlaySession::frameSent(quint64 frame, qint64 nowUs)
+{
+    m_sentAtUs.insert(frame, nowUs);
+    if (m_sentAtUs.size() > kMaxFramesInFlight) {
+        QList<quint64> frames = m_sentAtUs.keys();
+        std::sort(frames.begin(), frames.end());
+        for (int i = 0; i < frames.size() - kMaxFramesInFlight; ++i) {
+            m_sentAtUs.remove(frames[i]);
+        }
+    }
+}
+
+bool RemotePlaySession::acknowledge(quint64 frame, qint64 nowUs)
+{
+    const auto it = m_sentAtUs.constFind(frame);
+    if (it == m_sentAtUs.constEnd()) {
+        return false;
+    }
+    const qint64 sample = qMax<qint64>(0, nowUs - it.value());
+    // Anything sent before this frame and still unacknowledged was lost or skipped
+    for (auto sent = m_sentAtUs.begin(); sent != m_sentAtUs.end();) {
+        if (sent.key() <= frame) {
+            sent = m_sentAtUs.erase(sent);
+        } else {
+            ++sent;
+        }
+    }
+
+    if (m_acknowledged == 0) {
+        m_srttUs = sample;
+        m_rttVarUs = sample / 2;
+    } else {
+        m_rttVarUs += (qAbs(m_srttUs - sample) - m_rttVarUs) / 4;
+        m_srttUs += (sample - m_srttUs) / 8;
+    }
+    m_acknowledged++;
+    return true;
+}
+
+int RemotePlaySession::frameSkip() const
+{
+    const qint64 targetUs = static_cast<qint64>(m_targetRttMs) * 1000;
+    if (!m_adaptive || m_srttUs <= targetUs) {
+        return 1;
+    }
+    return static_cast<int>(qMin<qint64>(kMaxFrameSkip, (m_srttUs + targetUs - 1) / targetUs));
+}
+
+QJsonObject RemotePlaySession::stats() const
+{
+    QJsonObject stats;
+    stats["jitter_frames"] = m_jitterFrames;
+    stats["queued_input"] = m_queue.size();
+    stats["late_input"] = static_cast<qint64>(m_lateInput);
+    stats["applied_input"] = static_cast<qint64>(m_appliedInput);
+    stats["adaptive"] = m_adaptive;
+    stats["target_rtt_ms"] = m_targetRttMs;
+    stats["rtt_ms"] = m_srttUs / 1000.0;
+    stats["rtt_var_ms"] = m_rttVarUs / 1000.0;
+    stats["frame_skip"] = frameSkip();
+    stats["frames_in_flight"] = m_sentAtUs.size();
+    stats["acknowledged"] = static_cast<qint64>(m_acknowledged);
+    return stats;
+}
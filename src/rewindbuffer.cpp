@@ -0,0 +1,225 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "rewindbuffer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Zero runs shorter than this stay inside a literal; a token costs at least two bytes.
+constexpr int kMinZeroRun = 4;
+// Worst case encoding is the whole delta as one literal plus two varints.
+constexpr int kEncodingSlack = 16;
+
+}  // namespace
+
+RewindBuffer::RewindBuffer(int maxStateSize, qint64 budgetBytes)
+    : m_head(static_cast<size_t>(qMax(0, maxStateSize)), 0)
+    , m_scratch(static_cast<size_t>(qMax(0, maxStateSize)) + kEncodingSlack)
+    , m_arena(static_cast<size_t>(qMax<qint64>(0, budgetBytes)))
+{
+}
+
+void RewindBuffer::clear()
+{
+    m_entries.clear();
+    std::fill(m_head.begin(), m_head.begin() + m_headSize, 0);
+    m_headSize = 0;
+    m_headFrame = 0;
+    m_hasHead = false;
+    m_writeOffset = 0;
+    m_usedBytes = 0;
+}
+
+quint64 RewindBuffer::frameAt(int steps) const
+{
+    if (steps <= 0 || steps > m_entries.size()) {
+        return m_headFrame;
+    }
+    return m_entries.at(m_entries.size() - steps).frame;
+}
+
+void RewindBuffer::push(const unsigned char* state, int size, quint64 frame)
+{
+    if (!state || size <= 0 || size > maxStateSize()) {
+        return;
+    }
+
+    if (m_hasHead) {
+        const int encoded = encodeDelta(m_head.data(), m_headSize, state, size);
+        const qint64 offset = encoded >= 0 ? reserve(encoded) : -1;
+        if (offset >= 0) {
+            std::memcpy(m_arena.data() + offset, m_scratch.data(), static_cast<size_t>(encoded));
+            m_entries.append({offset, encoded, m_headSize, m_headFrame});
+            m_usedBytes += encoded;
+            m_writeOffset = offset + encoded;
+        } else {
+            // A delta that cannot fit breaks the chain; older history is unreachable.
+            m_entries.clear();
+            m_writeOffset = 0;
+            m_usedBytes = 0;
+        }
+    }
+
+    // Keep the bytes past the head's size zeroed so deltas between states of
+    // different sizes can treat the shorter one as zero-padded.
+    std::memcpy(m_head.data(), state, static_cast<size_t>(size));
+    if (m_headSize > size) {
+        std::fill(m_head.begin() + size, m_head.begin() + m_headSize, 0);
+    }
+    m_headSize = size;
+    m_headFrame = frame;
+    m_hasHead = true;
+}
+
+const unsigned char* RewindBuffer::rewind(int steps, int* size, quint64* frame)
+{
+    if (steps < 0 || steps >= depth()) {
+        return nullptr;
+    }
+    for (int i = 0; i < steps; ++i) {
+        const Entry entry = m_entries.takeLast();
+        decodeDeltaInto(entry, m_head.data(), maxStateSize());
+        m_headSize = entry.stateSize;
+        m_headFrame = entry.frame;
+        m_usedBytes -= entry.encodedSize;
+        // The newest delta was the last one written, so its space is reusable.
+        m_writeOffset = entry.offset;
+    }
+    if (size) {
+        *size = m_headSize;
+    }
+    if (frame) {
+        *frame = m_headFrame;
+    }
+    return m_head.data();
+}
+
+int RewindBuffer::encodeDelta(const unsigned char* older, int olderSize, const unsigned char* newer, int newerSize)
+{
+    const int n = qMax(olderSize, newerSize);
+    auto xorAt = [&](int i) -> unsigned char {
+        const unsigned char a = i < olderSize ? older[i] : 0;
+        const unsigned char b = i < newerSize ? newer[i] : 0;
+        return a ^ b;
+    };
+
+    unsigned char* out = m_scratch.data();
+    const int capacity = static_cast<int>(m_scratch.size());
+    int pos = 0;
+    auto putVarint = [&](quint32 value) {
+        while (pos < capacity) {
+            const unsigned char byte = value & 0x7F;
+            value >>= 7;
+            out[pos++] = value ? (byte | 0x80) : byte;
+            if (!value) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Tokens: <zero run varint> <literal length varint> <literal bytes>
+    int i = 0;
+    while (i < n) {
+        const int zeroStart = i;
+        while (i < n && xorAt(i) == 0) {
+            i++;
+        }
+        const int zeroRun = i - zeroStart;
+
+        const int literalStart = i;
+        int j = i;
+        while (j < n) {
+            if (xorAt(j) != 0) {
+                j++;
+                continue;
+            }
+            int k = j;
+            while (k < n && k - j < kMinZeroRun && xorAt(k) == 0) {
+                k++;
+            }
+            if (k - j >= kMinZeroRun || k == n) {
+                break;
+            }
+            j = k;
+        }
+        const int literalLength = j - literalStart;
+
+        if (!putVarint(static_cast<quint32>(zeroRun)) || !putVarint(static_cast<quint32>(literalLength)) ||
+            pos + literalLength > capacity) {
+            return -1;
+        }
+        for (int k = literalStart; k < j; ++k) {
+            out[pos++] = xorAt(k);
+        }
+        i = j;
+    }
+    return pos;
+}
+
+void RewindBuffer::decodeDeltaInto(const Entry& entry, unsigned char* state, int stateSize)
+{
+    const unsigned char* in = m_arena.data() + entry.offset;
+    const int end = entry.encodedSize;
+    int pos = 0;
+    auto getVarint = [&]() {
+        quint32 value = 0;
+        int shift = 0;
+        while (pos < end && shift < 32) {
+            const unsigned char byte = in[pos++];
+            value |= static_cast<quint32>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                break;
+            }
+            shift += 7;
+        }
+        return static_cast<int>(value);
+    };
+
+    int target = 0;
+    while (pos < end) {
+        target += getVarint();
+        const int literalLength = getVarint();
+        for (int k = 0; k < literalLength && pos < end && target < stateSize; ++k) {
+            state[target++] ^= in[pos++];
+        }
+    }
+}
+
+qint64 RewindBuffer::reserve(int bytes)
+{
+    const qint64 arenaSize = budgetBytes();
+    if (bytes > arenaSize) {
+        return -1;
+    }
+    if (m_writeOffset + bytes > arenaSize) {
+        // Wrap. The entries in the skipped tail are the oldest ones; drop them first
+        // so eviction stays in age order.
+        while (!m_entries.isEmpty() && m_entries.first().offset >= m_writeOffset) {
+            dropOldest();
+        }
+        m_writeOffset = 0;
+    }
+    while (!m_entries.isEmpty()) {
+        const Entry& oldest = m_entries.first();
+        const bool overlaps = oldest.offset < m_writeOffset + bytes &&
+                              m_writeOffset < oldest.offset + oldest.encodedSize;
+        if (!overlaps) {
+            break;
+        }
+        dropOldest();
+    }
+    return m_writeOffset;
+}
+
+void RewindBuffer::dropOldest()
+{
+    m_usedBytes -= m_entries.first().encodedSize;
+    m_entries.removeFirst();
+}
@@ -0,0 +1,121 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "romimagecache.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+
+void RomImageCache::setDirectory(const QString& directory)
+{
+    const QString cleaned = directory.isEmpty() ? QString() : QDir::cleanPath(QDir(directory).absolutePath());
+    if (cleaned == m_directory) {
+        return;
+    }
+    m_directory = cleaned;
+    m_entries.clear();
+    m_mapped.clear();
+    if (!m_directory.isEmpty() && !QDir().mkpath(m_directory)) {
+        qWarning() << "ROM image cache: cannot create" << m_directory << "- caching disabled";
+        m_directory.clear();
+    }
+}
+
+QString RomImageCache::resolve(const QString& sourcePath)
+{
+    if (m_directory.isEmpty() || sourcePath.isEmpty()) {
+        return sourcePath;
+    }
+
+    const QFileInfo info(sourcePath);
+    if (!info.isFile() || info.size() > kMaxImageBytes) {
+        return sourcePath;
+    }
+    const QString key = info.absoluteFilePath();
+
+    auto it = m_entries.constFind(key);
+    if (it != m_entries.constEnd() && it->size == info.size() && it->modified == info.lastModified()
+        && m_mapped.contains(it->hash) && QFileInfo::exists(it->cachedPath)) {
+        ++m_hits;
+        return it->cachedPath;
+    }
+
+    QFile source(key);
+    if (!source.open(QIODevice::ReadOnly)) {
+        return sourcePath;
+    }
+    const QByteArray bytes = source.readAll();
+    source.close();
+    ++m_reads;
+    if (bytes.size() != info.size()) {
+        return sourcePath;  // changed while reading; try again next time
+    }
+
+    Entry entry;
+    entry.size = info.size();
+    entry.modified = info.lastModified();
+    entry.hash = QCryptographicHash::hash(bytes, QCryptographicHash::Sha1).toHex();
+    entry.cachedPath = QDir(m_directory).filePath(QString::fromLatin1(entry.hash) + QStringLiteral(".rom"));
+
+    // Another process (or an earlier run) may have stored these contents already
+    if (QFileInfo(entry.cachedPath).size() != bytes.size()) {
+        QSaveFile copy(entry.cachedPath);
+        if (!copy.open(QIODevice::WriteOnly) || copy.write(bytes) != bytes.size() || !copy.commit()) {
+            qWarning() << "ROM image cache: cannot write" << entry.cachedPath;
+            return sourcePath;
+        }
+        ++m_imports;
+        m_mapped.remove(entry.hash);  // a mapping of a deleted copy keeps nothing useful
+    }
+
+    if (!m_mapped.contains(entry.hash) && !mapCopy(entry.hash, entry.cachedPath)) {
+        return sourcePath;
+    }
+    m_entries.insert(key, entry);
+    return entry.cachedPath;
+}
+
+bool RomImageCache::addKnownImage(const QString& sourcePath, qint64 size, const QDateTime& modified,
+                                  const QByteArray& hash)
+{
+    if (m_directory.isEmpty() || hash.isEmpty() || size > kMaxImageBytes) {
+        return false;
+    }
+    const QString key = QFileInfo(sourcePath).absoluteFilePath();
+    if (m_entries.contains(key)) {
+        return true;
+    }
+    Entry entry;
+    entry.size = size;
+    entry.modified = modified;
+    entry.hash = hash;
+    entry.cachedPath = QDir(m_directory).filePath(QString::fromLatin1(hash) + QStringLiteral(".rom"));
+    // Only a copy of the right size is trusted; anything else is left to resolve()
+    if (QFileInfo(entry.cachedPath).size() != size
+        || (!m_mapped.contains(hash) && !mapCopy(hash, entry.cachedPath))) {
+        return false;
+    }
+    m_entries.insert(key, entry);
+    return true;
+}
+
+bool RomImageCache::mapCopy(const QByteArray& hash, const QString& cachedPath)
+{
+    QSharedPointer<QFile> file(new QFile(cachedPath));
+    if (!file->open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    // An empty image cannot be mapped, but there is nothing to keep resident either
+    if (file->size() > 0 && !file->map(0, file->size())) {
+        return false;
+    }
+    m_mapped.insert(hash, file);
+    return true;
+}
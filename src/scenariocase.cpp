@@ -0,0 +1,251 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "scenariocase.h"
+
+#include <QCryptographicHash>
+
+namespace {
+
+const QStringList& actionTypes()
+{
+    static const QStringList kActionTypes = {"joystick", "console", "char", "write_memory",
+                                             "save_state", "capture", "pause"};
+    return kActionTypes;
+}
+
+}  // namespace
+
+bool ScenarioCase::hasExpectations() const
+{
+    return !screenText.isEmpty() || !memoryChecks.isEmpty() || !memorySha1.isEmpty() || pc >= 0;
+}
+
+bool ScenarioCase::parse(const QJsonObject& job, QString* error)
+{
+    *this = ScenarioCase();
+
+    const QJsonArray script = job.value("script").toArray();
+    for (int i = 0; i < script.size(); ++i) {
+        QString message;
+        if (!parseRequest(script.at(i).toObject(), false, &message)) {
+            *error = QString("script[%1]: %2").arg(i).arg(message);
+            return false;
+        }
+    }
+
+    const QJsonObject expect = job.value("expect").toObject();
+    const QJsonValue text = expect.value("screen_text");
+    if (text.isString()) {
+        screenText.append(text.toString());
+    } else {
+        for (const QJsonValue& value : text.toArray()) {
+            screenText.append(value.toString());
+        }
+    }
+
+    const QJsonArray memory = expect.value("memory").toArray();
+    for (int i = 0; i < memory.size(); ++i) {
+        const QJsonObject entry = memory.at(i).toObject();
+        MemoryCheck check;
+        if (!parseAddress(entry.value("address"), &check.address)) {
+            *error = QString("expect.memory[%1]: address must be 0-65535").arg(i);
+            return false;
+        }
+        if (entry.contains("bytes")) {
+            for (const QJsonValue& byte : entry.value("bytes").toArray()) {
+                const int value = byte.toInt(-1);
+                if (value < 0 || value > 255) {
+                    *error = QString("expect.memory[%1]: bytes must be 0-255").arg(i);
+                    return false;
+                }
+                check.bytes.append(char(value));
+            }
+            check.length = check.bytes.size();
+        } else {
+            check.sha1 = entry.value("sha1").toString().toLower();
+            check.length = entry.value("length").toInt(0);
+            if (check.sha1.size() != 40) {
+                *error = QString("expect.memory[%1]: needs bytes or a 40 digit sha1").arg(i);
+                return false;
+            }
+        }
+        if (check.length <= 0 || check.address + check.length > 0x10000) {
+            *error = QString("expect.memory[%1]: range must be non-empty and inside memory").arg(i);
+            return false;
+        }
+        memoryChecks.append(check);
+    }
+
+    memorySha1 = expect.value("memory_sha1").toString().toLower();
+    if (expect.contains("pc") && !parseAddress(expect.value("pc"), &pc)) {
+        *error = "expect.pc must be 0-65535";
+        return false;
+    }
+    checkEvery = qMax(0, expect.value("check_every").toInt(0));
+    return true;
+}
+
+bool ScenarioCase::parseRequest(const QJsonObject& request, bool inBatch, QString* error)
+{
+    const QString command = request.value("command").toString();
+    const QJsonObject params = request.value("params").toObject();
+
+    if (command == "batch") {
+        if (inBatch) {
+            *error = "Batches cannot be nested";
+            return false;
+        }
+        const QJsonArray commands = params.value("commands").toArray();
+        for (int i = 0; i < commands.size(); ++i) {
+            QString message;
+            if (!parseRequest(commands.at(i).toObject(), true, &message)) {
+                *error = QString("commands[%1]: %2").arg(i).arg(message);
+                return false;
+            }
+        }
+        return true;
+    }
+    if (command != "system.schedule") {
+        *error = QString("%1 is not supported in a script, only system.schedule and batch")
+                     .arg(command.isEmpty() ? QString("a request without a command") : command);
+        return false;
+    }
+
+    Action action;
+    action.type = params.value("action").toString();
+    action.params = params.value("params").toObject();
+    if (!validateAction(action.type, action.params, error)) {
+        return false;
+    }
+    if (params.contains("frame")) {
+        const qint64 frame = static_cast<qint64>(params.value("frame").toDouble(-1));
+        if (frame < 0) {
+            *error = "frame must be a non-negative integer";
+            return false;
+        }
+        action.frame = static_cast<quint64>(frame);
+    } else if (params.contains("in_frames")) {
+        const int inFrames = params.value("in_frames").toInt(-1);
+        if (inFrames < 0) {
+            *error = "in_frames must be a non-negative integer";
+            return false;
+        }
+        action.relative = true;
+        action.frame = static_cast<quint64>(inFrames);
+    } else {
+        *error = "frame or in_frames parameter is required";
+        return false;
+    }
+    if (action.type == "save_state") {
+        QString filename = action.params.value("filename").toString();
+        if (!filename.endsWith(".a8s", Qt::CaseInsensitive)) {
+            action.params["filename"] = filename + ".a8s";
+        }
+    }
+    actions.append(action);
+    return true;
+}
+
+QJsonObject ScenarioCase::verify(const QStringList& screenRows, const QByteArray& memory, int currentPc) const
+{
+    QJsonArray failures;
+    const QString screen = screenRows.join('\n');
+    for (const QString& text : screenText) {
+        if (!screen.contains(text)) {
+            failures.append(QString("screen text \"%1\" not found").arg(text));
+        }
+    }
+    for (const MemoryCheck& check : memoryChecks) {
+        const QByteArray range = memory.mid(check.address, check.length);
+        const QString address = QString("$%1").arg(check.address, 4, 16, QChar('0')).toUpper();
+        if (!check.sha1.isEmpty()) {
+            const QString sha1 = QString::fromLatin1(
+                QCryptographicHash::hash(range, QCryptographicHash::Sha1).toHex());
+            if (sha1 != check.sha1) {
+                failures.append(QString("memory %1+%2 sha1 is %3").arg(address).arg(check.length).arg(sha1));
+            }
+        } else if (range != check.bytes) {
+            failures.append(QString("memory %1 holds %2").arg(address)
+                                .arg(QString::fromLatin1(range.toHex(' '))));
+        }
+    }
+    if (!memorySha1.isEmpty()) {
+        const QString sha1 = QString::fromLatin1(
+            QCryptographicHash::hash(memory, QCryptographicHash::Sha1).toHex());
+        if (sha1 != memorySha1) {
+            failures.append(QString("memory sha1 is %1").arg(sha1));
+        }
+    }
+    if (pc >= 0 && currentPc != pc) {
+        failures.append(QString("pc is $%1").arg(currentPc, 4, 16, QChar('0')).toUpper());
+    }
+
+    QJsonObject result;
+    result["ok"] = failures.isEmpty();
+    result["failures"] = failures;
+    return result;
+}
+
+bool ScenarioCase::validateAction(const QString& type, const QJsonObject& params, QString* error)
+{
+    if (!actionTypes().contains(type)) {
+        *error = "action must be one of: " + actionTypes().join(", ");
+        return false;
+    }
+    if (type == "joystick") {
+        const int player = params["player"].toInt(1);
+        const int value = params["value"].toInt(15);
+        if (player < 1 || player > 2 || value < 0 || value > 15) {
+            *error = "joystick needs player 1-2 and value 0-15";
+            return false;
+        }
+    } else if (type == "char") {
+        if (params["char"].toString().size() != 1) {
+            *error = "char needs a single character";
+            return false;
+        }
+    } else if (type == "write_memory") {
+        const int address = params["address"].toInt(-1);
+        const QJsonArray data = params["data"].toArray();
+        if (address < 0 || address > 0xFFFF || data.isEmpty() || address + data.size() > 0x10000) {
+            *error = "write_memory needs an address (0-65535) and a non-empty data array inside memory";
+            return false;
+        }
+        for (const QJsonValue& byte : data) {
+            const int value = byte.toInt(-1);
+            if (value < 0 || value > 255) {
+                *error = "write_memory data must be bytes (0-255)";
+                return false;
+            }
+        }
+    } else if (type == "save_state") {
+        if (params["filename"].toString().isEmpty()) {
+            *error = "save_state needs a filename";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ScenarioCase::parseAddress(const QJsonValue& value, int* address)
+{
+    bool ok = false;
+    int result = -1;
+    if (value.isDouble()) {
+        result = value.toInt(-1);
+        ok = true;
+    } else if (value.isString()) {
+        const QString text = value.toString();
+        result = text.startsWith('$') ? text.mid(1).toInt(&ok, 16) : text.toInt(&ok, 0);
+    }
+    if (!ok || result < 0 || result > 0xFFFF) {
+        return false;
+    }
+    *address = result;
+    return true;
+}
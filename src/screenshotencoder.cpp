@@ -0,0 +1,209 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "screenshotencoder.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageWriter>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QThread>
+#include <functional>
+
+namespace {
+
+class EncodeTask : public QRunnable
+{
+public:
+    explicit EncodeTask(std::function<void()> work) : m_work(std::move(work)) {}
+    void run() override { m_work(); }
+
+private:
+    std::function<void()> m_work;
+};
+
+struct QoiPixel {
+    uchar r = 0;
+    uchar g = 0;
+    uchar b = 0;
+    uchar a = 255;
+
+    bool operator==(const QoiPixel& other) const
+    {
+        return r == other.r && g == other.g && b == other.b && a == other.a;
+    }
+    bool operator!=(const QoiPixel& other) const { return !(*this == other); }
+};
+
+void appendBigEndian32(QByteArray& out, quint32 value)
+{
+    out.append(char(value >> 24));
+    out.append(char(value >> 16));
+    out.append(char(value >> 8));
+    out.append(char(value));
+}
+
+}  // namespace
+
+ScreenshotEncoder::ScreenshotEncoder(QObject* parent)
+    : QObject(parent)
+{
+    // A couple of threads keep bursts of captures from queueing behind each other
+    m_pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 4));
+}
+
+ScreenshotEncoder::~ScreenshotEncoder()
+{
+    waitForDone();
+}
+
+quint64 ScreenshotEncoder::submit(const QImage& frame, Format format, const QString& path)
+{
+    const quint64 ticket = m_nextTicket++;
+    m_pool.start(new EncodeTask([this, ticket, frame, format, path]() {
+        QString error;
+        QByteArray data = encode(frame, format, &error);
+        if (!data.isEmpty() && !path.isEmpty()) {
+            QDir().mkpath(QFileInfo(path).absolutePath());
+            QSaveFile file(path);
+            if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+                error = QString("Cannot write %1: %2").arg(path, file.errorString());
+                data.clear();
+            }
+        }
+        emit finished(ticket, data, path, error);
+    }));
+    return ticket;
+}
+
+void ScreenshotEncoder::waitForDone()
+{
+    m_pool.waitForDone();
+}
+
+QByteArray ScreenshotEncoder::encode(const QImage& frame, Format format, QString* error)
+{
+    if (frame.isNull() || frame.format() != QImage::Format_Indexed8) {
+        if (error) {
+            *error = "No indexed frame to encode";
+        }
+        return QByteArray();
+    }
+    if (format == FormatQoi) {
+        return encodeQoi(frame);
+    }
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    QImageWriter writer(&buffer, "png");
+    // zlib level 1: an Atari frame compresses nearly as well, much faster
+    writer.setCompression(1);
+    if (!writer.write(frame)) {
+        if (error) {
+            *error = "PNG encoding failed: " + writer.errorString();
+        }
+        return QByteArray();
+    }
+    return data;
+}
+
+QByteArray ScreenshotEncoder::encodeQoi(const QImage& frame)
+{
+    const int width = frame.width();
+    const int height = frame.height();
+    const QVector<QRgb> colors = frame.colorTable();
+    QoiPixel palette[256];
+    for (int i = 0; i < colors.size() && i < 256; ++i) {
+        palette[i].r = uchar(qRed(colors[i]));
+        palette[i].g = uchar(qGreen(colors[i]));
+        palette[i].b = uchar(qBlue(colors[i]));
+    }
+
+    QByteArray out;
+    out.reserve(14 + width * height + 8);
+    out.append("qoif", 4);
+    appendBigEndian32(out, quint32(width));
+    appendBigEndian32(out, quint32(height));
+    out.append(char(3));  // RGB
+    out.append(char(0));  // sRGB with linear alpha
+
+    // The spec starts the index zeroed (transparent black) and the previous pixel opaque black
+    QoiPixel seen[64];
+    for (QoiPixel& entry : seen) {
+        entry.a = 0;
+    }
+    QoiPixel previous;
+    int run = 0;
+    const int pixels = width * height;
+    for (int i = 0; i < pixels; ++i) {
+        const QoiPixel px = palette[frame.constScanLine(i / width)[i % width]];
+        if (px == previous) {
+            if (++run == 62 || i == pixels - 1) {
+                out.append(char(0xC0 | (run - 1)));
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            out.append(char(0xC0 | (run - 1)));
+            run = 0;
+        }
+
+        const int slot = (px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64;
+        if (seen[slot] == px) {
+            out.append(char(slot));
+        } else {
+            seen[slot] = px;
+            const int dr = qint8(px.r - previous.r);
+            const int dg = qint8(px.g - previous.g);
+            const int db = qint8(px.b - previous.b);
+            const int drg = dr - dg;
+            const int dbg = db - dg;
+            if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                out.append(char(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2)));
+            } else if (drg >= -8 && drg <= 7 && dg >= -32 && dg <= 31 && dbg >= -8 && dbg <= 7) {
+                out.append(char(0x80 | (dg + 32)));
+                out.append(char(((drg + 8) << 4) | (dbg + 8)));
+            } else {
+                out.append(char(0xFE));
+                out.append(char(px.r));
+                out.append(char(px.g));
+                out.append(char(px.b));
+            }
+        }
+        previous = px;
+    }
+    out.append(QByteArray(7, '\0'));
+    out.append(char(1));
+    return out;
+}
+
+bool ScreenshotEncoder::parseFormat(const QString& name, Format* format)
+{
+    const QString lower = name.toLower();
+    if (lower == "png") {
+        *format = FormatPng;
+    } else if (lower == "qoi") {
+        *format = FormatQoi;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QString ScreenshotEncoder::formatName(Format format)
+{
+    return format == FormatQoi ? "qoi" : "png";
+}
+
+QString ScreenshotEncoder::mimeType(Format format)
+{
+    return format == FormatQoi ? "image/qoi" : "image/png";
+}
@@ -0,0 +1,235 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "screenstreamencoder.h"
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+// Runs of unchanged pixels shorter than this stay inside a literal; a token costs at least two bytes.
+constexpr int kMinSkipRun = 4;
+
+void putVarint(QByteArray& out, quint32 value)
+{
+    do {
+        const char byte = static_cast<char>(value & 0x7F);
+        value >>= 7;
+        out.append(value ? static_cast<char>(byte | 0x80) : byte);
+    } while (value);
+}
+
+}  // namespace
+
+ScreenStreamEncoder::ScreenStreamEncoder(Encoding encoding)
+    : m_encoding(encoding)
+{
+}
+
+bool ScreenStreamEncoder::parseEncoding(const QString& name, Encoding* encoding)
+{
+    if (name == "full") {
+        *encoding = EncodingFull;
+    } else if (name == "rows") {
+        *encoding = EncodingRows;
+    } else if (name == "delta") {
+        *encoding = EncodingDelta;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QString ScreenStreamEncoder::encodingName(Encoding encoding)
+{
+    switch (encoding) {
+    case EncodingRows:
+        return "rows";
+    case EncodingDelta:
+        return "delta";
+    case EncodingFull:
+    default:
+        return "full";
+    }
+}
+
+QByteArray ScreenStreamEncoder::paletteToRgb(const QVector<QRgb>& palette)
+{
+    QByteArray rgb(256 * 3, 0);
+    const int count = qMin(palette.size(), 256);
+    for (int i = 0; i < count; ++i) {
+        const QRgb color = palette.at(i);
+        rgb[3 * i] = static_cast<char>(qRed(color));
+        rgb[3 * i + 1] = static_cast<char>(qGreen(color));
+        rgb[3 * i + 2] = static_cast<char>(qBlue(color));
+    }
+    return rgb;
+}
+
+void ScreenStreamEncoder::reset()
+{
+    m_previous.clear();
+    m_width = 0;
+    m_height = 0;
+    m_palette.clear();
+}
+
+void ScreenStreamEncoder::encode(const unsigned char* pixels, int width, int height, int stride,
+                                 const QVector<QRgb>& palette, quint64 frame, QByteArray& out)
+{
+    if (!pixels || width <= 0 || height <= 0 || stride < width) {
+        return;
+    }
+
+    // QImage scanlines are 4-byte aligned; pack anything else once up front
+    if (stride != width) {
+        m_packed.resize(width * height);
+        for (int y = 0; y < height; ++y) {
+            std::memcpy(m_packed.data() + y * width, pixels + y * stride, static_cast<size_t>(width));
+        }
+        pixels = reinterpret_cast<const unsigned char*>(m_packed.constData());
+    }
+    const int size = width * height;
+
+    if (palette != m_palette) {
+        appendPalette(out, palette, width, height, frame);
+        m_palette = palette;
+    }
+
+    const bool haveReference = m_width == width && m_height == height && !m_previous.isEmpty();
+    bool encoded = false;
+    if (haveReference && m_encoding == EncodingRows) {
+        encoded = appendRows(out, pixels, width, height, frame);
+    } else if (haveReference && m_encoding == EncodingDelta) {
+        encoded = appendDelta(out, pixels, size, width, height, frame);
+    }
+    if (!encoded) {
+        appendHeader(out, PacketFull, width, height, frame, size);
+        out.append(reinterpret_cast<const char*>(pixels), size);
+    }
+
+    // Full mode never looks back, so it need not keep a copy.
+    if (m_encoding != EncodingFull) {
+        m_previous.resize(size);
+        std::memcpy(m_previous.data(), pixels, static_cast<size_t>(size));
+        m_width = width;
+        m_height = height;
+    }
+}
+
+void ScreenStreamEncoder::appendHeader(QByteArray& out, PacketType type, int width, int height,
+                                       quint64 frame, int payloadSize, int reserved)
+{
+    uchar header[kHeaderSize];
+    header[0] = kMagic;
+    header[1] = type;
+    qToLittleEndian<quint16>(static_cast<quint16>(width), header + 2);
+    qToLittleEndian<quint16>(static_cast<quint16>(height), header + 4);
+    qToLittleEndian<quint16>(static_cast<quint16>(reserved), header + 6);
+    qToLittleEndian<quint64>(frame, header + 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(payloadSize), header + 16);
+    out.append(reinterpret_cast<const char*>(header), kHeaderSize);
+}
+
+void ScreenStreamEncoder::appendAudio(QByteArray& out, int sampleRate, int channels, int bitsPerSample,
+                                      quint64 frame, quint64 firstSample, const QByteArray& pcm)
+{
+    appendHeader(out, PacketAudio, sampleRate, channels, frame, 8 + pcm.size(), bitsPerSample);
+    uchar start[8];
+    qToLittleEndian<quint64>(firstSample, start);
+    out.append(reinterpret_cast<const char*>(start), 8);
+    out.append(pcm);
+}
+
+void ScreenStreamEncoder::appendPalette(QByteArray& out, const QVector<QRgb>& palette, int width, int height,
+                                        quint64 frame)
+{
+    appendHeader(out, PacketPalette, width, height, frame, 256 * 3);
+    out.append(paletteToRgb(palette));
+}
+
+bool ScreenStreamEncoder::appendRows(QByteArray& out, const unsigned char* pixels, int width, int height,
+                                     quint64 frame)
+{
+    const char* previous = m_previous.constData();
+    QVector<int> changed;
+    changed.reserve(height);
+    for (int y = 0; y < height; ++y) {
+        if (std::memcmp(previous + y * width, pixels + y * width, static_cast<size_t>(width)) != 0) {
+            changed.append(y);
+        }
+    }
+
+    const int payloadSize = 2 + changed.size() * (2 + width);
+    if (payloadSize > width * height) {
+        return false;
+    }
+    appendHeader(out, PacketRows, width, height, frame, payloadSize);
+    uchar word[2];
+    qToLittleEndian<quint16>(static_cast<quint16>(changed.size()), word);
+    out.append(reinterpret_cast<const char*>(word), 2);
+    for (int y : changed) {
+        qToLittleEndian<quint16>(static_cast<quint16>(y), word);
+        out.append(reinterpret_cast<const char*>(word), 2);
+        out.append(reinterpret_cast<const char*>(pixels + y * width), width);
+    }
+    return true;
+}
+
+bool ScreenStreamEncoder::appendDelta(QByteArray& out, const unsigned char* pixels, int n, int width,
+                                      int height, quint64 frame)
+{
+    const unsigned char* previous = reinterpret_cast<const unsigned char*>(m_previous.constData());
+    auto same = [&](int i) { return pixels[i] == previous[i]; };
+
+    const int headerPos = out.size();
+    appendHeader(out, PacketDelta, width, height, frame, 0);
+    const int payloadStart = out.size();
+
+    int i = 0;
+    while (i < n) {
+        const int skipStart = i;
+        while (i < n && same(i)) {
+            i++;
+        }
+        if (i == n) {
+            break;  // trailing unchanged pixels need no token
+        }
+        const int skip = i - skipStart;
+
+        // Extend the literal over short unchanged runs that would cost more as a token
+        int j = i;
+        while (j < n) {
+            if (!same(j)) {
+                j++;
+                continue;
+            }
+            int k = j;
+            while (k < n && k - j < kMinSkipRun && same(k)) {
+                k++;
+            }
+            if (k - j >= kMinSkipRun || k == n) {
+                break;
+            }
+            j = k;
+        }
+
+        putVarint(out, static_cast<quint32>(skip));
+        putVarint(out, static_cast<quint32>(j - i));
+        out.append(reinterpret_cast<const char*>(pixels + i), j - i);
+        i = j;
+
+        if (out.size() - payloadStart > n) {
+            out.truncate(headerPos);
+            return false;
+        }
+    }
+
+    qToLittleEndian<quint32>(static_cast<quint32>(out.size() - payloadStart),
+                             reinterpret_cast<uchar*>(out.data()) + headerPos + 16);
+    return true;
+}
@@ -31,6 +31,10 @@ SDL2JoystickManager::SDL2JoystickManager(QObject *parent)
     , m_enabled(false)
     , m_initialized(false)
 {
+    for (std::atomic<quint32>& packed : m_packedStates) {
+        packed.store(0, std::memory_order_relaxed);
+    }
+
     // Set up polling timer
     m_pollTimer->setInterval(POLL_INTERVAL_MS);
     connect(m_pollTimer, &QTimer::timeout, this, &SDL2JoystickManager::onPollTimer);
@@ -156,6 +160,11 @@ void SDL2JoystickManager::onPollTimer()
         return;
     }
 
+    // Skip when the frame loop has polled within the interval
+    if (m_sinceLastPoll.isValid() && m_sinceLastPoll.elapsed() < POLL_INTERVAL_MS) {
+        return;
+    }
+
     pollJoysticks();
 }
 
@@ -164,74 +173,107 @@ void SDL2JoystickManager::pollJoysticks()
     if (!m_initialized || !SDL_WasInit(SDL_INIT_JOYSTICK)) {
         return;
     }
+    m_sinceLastPoll.start();
 
-    // First pump events to update the SDL event queue
+    // Pumping runs SDL's joystick update and queues an event for every axis,
+    // hat and button change, so only joysticks that moved are read below
     SDL_PumpEvents();
 
-    // Process only joystick device events without consuming other events
+    // Process only joystick events without consuming other events
+    unsigned changed = 0;  // bit per joystick index
     SDL_Event events[32];  // Buffer for multiple events
-    int numEvents = SDL_PeepEvents(events, 32, SDL_GETEVENT, SDL_JOYDEVICEADDED, SDL_JOYDEVICEREMOVED);
-
-    for (int i = 0; i < numEvents; ++i) {
-        const SDL_Event& event = events[i];
-        if (event.type == SDL_JOYDEVICEADDED) {
-            qDebug() << "SDL2JoystickManager: Joystick device added (hot-plug)";
-            handleJoystickAdded(event.jdevice.which);
-        } else if (event.type == SDL_JOYDEVICEREMOVED) {
-            qDebug() << "SDL2JoystickManager: Joystick device removed (hot-unplug)";
-            handleJoystickRemoved(event.jdevice.which);
+    int numEvents;
+    do {
+        numEvents = SDL_PeepEvents(events, 32, SDL_GETEVENT, SDL_JOYAXISMOTION, SDL_JOYDEVICEREMOVED);
+        for (int i = 0; i < numEvents; ++i) {
+            const SDL_Event& event = events[i];
+            if (event.type == SDL_JOYDEVICEADDED) {
+                qDebug() << "SDL2JoystickManager: Joystick device added (hot-plug)";
+                handleJoystickAdded(event.jdevice.which);
+                continue;
+            }
+            if (event.type == SDL_JOYDEVICEREMOVED) {
+                qDebug() << "SDL2JoystickManager: Joystick device removed (hot-unplug)";
+                handleJoystickRemoved(event.jdevice.which);
+                continue;
+            }
+            // Axis, ball, hat and button events all start with the instance ID
+            const SDL_JoystickID instanceId = event.jaxis.which;
+            for (auto it = m_joystickIds.begin(); it != m_joystickIds.end(); ++it) {
+                if (it.value() == instanceId) {
+                    changed |= 1u << it.key();
+                    break;
+                }
+            }
         }
-    }
-
-    // Update SDL joystick state (this doesn't consume events)
-    SDL_JoystickUpdate();
-
-    // Poll each connected joystick
-    for (auto it = m_joysticks.begin(); it != m_joysticks.end(); ++it) {
-        int index = it.key();
-        SDL_Joystick* joystick = it.value();
+    } while (numEvents == 32);
 
-        if (!joystick || !SDL_JoystickGetAttached(joystick)) {
-            continue;
+    for (int index = 0; index < MAX_JOYSTICKS; ++index) {
+        if (changed & (1u << index)) {
+            updateJoystickState(index);
         }
+    }
+}
 
-        JoystickState newState;
-        newState.connected = true;
-        newState.name = m_joystickStates[index].name;  // Preserve name
+void SDL2JoystickManager::updateJoystickState(int index)
+{
+    SDL_Joystick* joystick = m_joysticks.value(index, nullptr);
+    if (!joystick || !SDL_JoystickGetAttached(joystick)) {
+        return;
+    }
 
-        // Read analog axes (assuming axes 0,1 are left stick X,Y)
-        if (SDL_JoystickNumAxes(joystick) >= 2) {
-            int xAxis = SDL_JoystickGetAxis(joystick, 0);
-            int yAxis = SDL_JoystickGetAxis(joystick, 1);
-            newState.stick = convertSDLAxisToAtariStick(xAxis, yAxis);
-        } else {
-            newState.stick = INPUT_STICK_CENTRE;
-        }
+    JoystickState newState;
+    newState.connected = true;
+    newState.name = m_joystickStates[index].name;  // Preserve name
 
-        // Read trigger button - check buttons 0-3 for better compatibility
-        // Different controllers map fire to different buttons:
-        // - Xbox: A=0, B=1, X=2, Y=3
-        // - PlayStation: varies
-        // - Generic USB: varies
-        // Solution: treat any of the first 4 buttons as fire (like Atari800MacX)
-        newState.trigger = false;
-        int numButtons = SDL_JoystickNumButtons(joystick);
-        for (int btn = 0; btn < numButtons && btn < 4; ++btn) {
-            if (SDL_JoystickGetButton(joystick, btn) != 0) {
-                newState.trigger = true;
-                break;
-            }
+    // Read analog axes (assuming axes 0,1 are left stick X,Y)
+    if (SDL_JoystickNumAxes(joystick) >= 2) {
+        int xAxis = SDL_JoystickGetAxis(joystick, 0);
+        int yAxis = SDL_JoystickGetAxis(joystick, 1);
+        newState.stick = convertSDLAxisToAtariStick(xAxis, yAxis);
+    } else {
+        newState.stick = INPUT_STICK_CENTRE;
+    }
+
+    // Read trigger button - check buttons 0-3 for better compatibility
+    // Different controllers map fire to different buttons:
+    // - Xbox: A=0, B=1, X=2, Y=3
+    // - PlayStation: varies
+    // - Generic USB: varies
+    // Solution: treat any of the first 4 buttons as fire (like Atari800MacX)
+    newState.trigger = false;
+    int numButtons = SDL_JoystickNumButtons(joystick);
+    for (int btn = 0; btn < numButtons && btn < 4; ++btn) {
+        if (SDL_JoystickGetButton(joystick, btn) != 0) {
+            newState.trigger = true;
+            break;
         }
+    }
+
+    // Check if state changed
+    if (m_joystickStates[index].stick != newState.stick ||
+        m_joystickStates[index].trigger != newState.trigger) {
 
-        // Check if state changed
-        if (!m_joystickStates.contains(index) ||
-            m_joystickStates[index].stick != newState.stick ||
-            m_joystickStates[index].trigger != newState.trigger) {
+        m_joystickStates[index] = newState;
+        publishPackedState(index);
+        emit joystickStateChanged(index, newState);
+    }
+}
 
-            m_joystickStates[index] = newState;
-            emit joystickStateChanged(index, newState);
+void SDL2JoystickManager::publishPackedState(int index)
+{
+    if (index < 0 || index >= MAX_JOYSTICKS) {
+        return;
+    }
+    quint32 packed = 0;
+    auto it = m_joystickStates.constFind(index);
+    if (it != m_joystickStates.constEnd() && it.value().connected) {
+        packed = (static_cast<quint32>(it.value().stick) & 0xFF) | kPackedConnected;
+        if (it.value().trigger) {
+            packed |= kPackedTrigger;
         }
     }
+    m_packedStates[index].store(packed, std::memory_order_release);
 }
 
 void SDL2JoystickManager::refreshJoysticks()
@@ -273,6 +315,8 @@ void SDL2JoystickManager::refreshJoysticks()
             state.trigger = false;
 
             m_joystickStates[ourIndex] = state;
+            publishPackedState(ourIndex);
+            updateJoystickState(ourIndex);  // a stick already held
 
             qDebug() << "SDL2JoystickManager: Opened joystick" << ourIndex
                      << "(" << state.name << ") with"
@@ -304,6 +348,9 @@ void SDL2JoystickManager::closeAllJoysticks()
     m_joysticks.clear();
     m_joystickIds.clear();
     m_joystickStates.clear();
+    for (std::atomic<quint32>& packed : m_packedStates) {
+        packed.store(0, std::memory_order_release);
+    }
 }
 
 JoystickState SDL2JoystickManager::getJoystickState(int joystickIndex) const
@@ -438,6 +485,8 @@ void SDL2JoystickManager::handleJoystickAdded(int sdlDeviceIndex)
         state.trigger = false;
 
         m_joystickStates[ourIndex] = state;
+        publishPackedState(ourIndex);
+        updateJoystickState(ourIndex);  // a stick already held
 
         qDebug() << "SDL2JoystickManager: Hot-plugged joystick" << ourIndex
                  << "(" << state.name << ") with"
@@ -480,6 +529,7 @@ void SDL2JoystickManager::handleJoystickRemoved(SDL_JoystickID instanceId)
     m_joysticks.remove(ourIndex);
     m_joystickIds.remove(ourIndex);
     m_joystickStates.remove(ourIndex);
+    publishPackedState(ourIndex);
 
     qDebug() << "SDL2JoystickManager: Hot-unplugged joystick" << ourIndex;
 
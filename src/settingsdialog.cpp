@@ -17,6 +17,7 @@
 #include <QProcess>
 #include <QDir>
 #include <QTextStream>
+#include <QRegularExpressionValidator>
 
 #ifdef HAVE_SDL2_JOYSTICK
 #include "sdl2joystickmanager.h"
@@ -25,6 +26,7 @@
 #include "fujinetservice.h"
 #include "fujinetprocessmanager.h"
 #include "fujinetbinarymanager.h"
+#include "threadscheduling.h"
 
 SettingsDialog::SettingsDialog(AtariEmulator* emulator, ConfigurationProfileManager* profileManager,
                                FujiNetService* fujinetService,
@@ -516,6 +518,57 @@ void SettingsDialog::createHardwareTab()
     });
 
     performanceLayout->addWidget(speedWidget);
+
+    QWidget* runAheadWidget = new QWidget();
+    QHBoxLayout* runAheadLayout = new QHBoxLayout(runAheadWidget);
+    runAheadLayout->setContentsMargins(0, 0, 0, 0);
+    runAheadLayout->addWidget(new QLabel("Run-ahead:"));
+    m_runAheadSpinBox = new QSpinBox();
+    m_runAheadSpinBox->setRange(0, AtariEmulator::kMaxRunAheadFrames);
+    m_runAheadSpinBox->setSpecialValueText("Off");
+    m_runAheadSpinBox->setSuffix(" frames");
+    m_runAheadSpinBox->setToolTip("Show the screen this many frames ahead to hide the game's own input lag.\n"
+                                  "Costs one extra frame of CPU time per step; suspended at other speeds than 1x,\n"
+                                  "while a disk, cartridge or cassette is attached, and with NetSIO, the printer\n"
+                                  "or breakpoints enabled.");
+    runAheadLayout->addWidget(m_runAheadSpinBox);
+    runAheadLayout->addStretch();
+    performanceLayout->addWidget(runAheadWidget);
+
+    QWidget* schedulingWidget = new QWidget();
+    QHBoxLayout* schedulingLayout = new QHBoxLayout(schedulingWidget);
+    schedulingLayout->setContentsMargins(0, 0, 0, 0);
+    schedulingLayout->addWidget(new QLabel("Thread priority:"));
+    m_threadPriorityCombo = new QComboBox();
+    m_threadPriorityCombo->addItem("Normal", "normal");
+    m_threadPriorityCombo->addItem("High", "high");
+    m_threadPriorityCombo->addItem("Real-time", "realtime");
+    m_threadPriorityCombo->setToolTip("Scheduling priority of the emulator thread.\n"
+                                      "High: MMCSS \"Games\" on Windows, user-interactive QoS on macOS, nice -10 on Linux.\n"
+                                      "Real-time: SCHED_FIFO on Linux (needs an rtprio limit or CAP_SYS_NICE),\n"
+                                      "a time-constraint policy on macOS; falls back to High when refused.");
+    schedulingLayout->addWidget(m_threadPriorityCombo);
+    schedulingLayout->addWidget(new QLabel("CPU:"));
+    m_cpuAffinityCombo = new QComboBox();
+    m_cpuAffinityCombo->addItem("Any", -1);
+    for (int cpu = 0; cpu < ThreadScheduling::cpuCount(); ++cpu) {
+        m_cpuAffinityCombo->addItem(QString::number(cpu), cpu);
+    }
+    m_cpuAffinityCombo->setToolTip("Pin the emulator thread to one CPU (not supported on macOS)");
+    schedulingLayout->addWidget(m_cpuAffinityCombo);
+    schedulingLayout->addStretch();
+    performanceLayout->addWidget(schedulingWidget);
+
+    m_preciseTimingCheck = new QCheckBox("Precise frame timing");
+    m_preciseTimingCheck->setToolTip("Wake up shortly before each frame is due and wait out the rest exactly,\n"
+                                     "instead of relying on millisecond timers. Uses a little more CPU.");
+    performanceLayout->addWidget(m_preciseTimingCheck);
+
+    m_hibernateOnQuitCheck = new QCheckBox("Resume where you left off");
+    m_hibernateOnQuitCheck->setToolTip("Save the running machine on quit and restore it on the next launch\n"
+                                       "instead of booting. Skipped when the machine settings, mounted media\n"
+                                       "or profile changed in between. FujiNet's own state is not included.");
+    performanceLayout->addWidget(m_hibernateOnQuitCheck);
     
     rightColumn->addWidget(performanceGroup);
     
@@ -541,6 +594,10 @@ void SettingsDialog::createHardwareTab()
     m_sioAcceleration = new QCheckBox("SIO acceleration");
     m_sioAcceleration->setToolTip("Speed up disk and cassette operations");
     sioLayout->addWidget(m_sioAcceleration);
+
+    m_tapeAcceleration = new QCheckBox("Fast tape loading");
+    m_tapeAcceleration->setToolTip("Run at full speed, without sound or video, while a tape loads through the cassette port");
+    sioLayout->addWidget(m_tapeAcceleration);
     
     rightColumn->addWidget(sioGroup);
     
@@ -639,6 +696,19 @@ void SettingsDialog::createAudioConfigTab()
     m_audioBits->addItem("16-bit", 16);
     m_audioBits->setToolTip("Audio bit depth - 16-bit recommended");
     audioLayout->addRow("Bit Depth:", m_audioBits);
+
+    m_audioResampler = new QComboBox();
+    m_audioResampler->addItem("Band-limited (sinc)", "sinc");
+    m_audioResampler->addItem("Linear", "linear");
+    m_audioResampler->setToolTip("Sample rate conversion when the audio device runs at a different rate than the emulator (unified audio backend). Band-limited avoids aliasing on POKEY's square waves; linear uses less CPU.");
+    audioLayout->addRow("Resampler:", m_audioResampler);
+
+    m_audioTurboMode = new QComboBox();
+    m_audioTurboMode->addItem("Time-compressed", "compress");
+    m_audioTurboMode->addItem("Pitch-preserving", "pitch");
+    m_audioTurboMode->addItem("Unprocessed", "off");
+    m_audioTurboMode->setToolTip("Audio above 100% speed. Time-compressed plays everything sped up (higher pitch); pitch-preserving plays a real-time share of the frames at normal pitch; unprocessed queues every frame, which overruns the audio buffer.");
+    audioLayout->addRow("Turbo Audio:", m_audioTurboMode);
     
     // Volume control
     QHBoxLayout* volumeLayout = new QHBoxLayout();
@@ -681,9 +751,23 @@ void SettingsDialog::createAudioConfigTab()
     m_audioLatencySpinBox->setToolTip("Additional audio latency for synchronization - adjust if experiencing audio/video sync issues");
     audioLayout->addRow("Audio Delay:", m_audioLatencySpinBox);
 
+    // Audio-master pacing
+    m_audioSyncCheck = new QCheckBox("Pace emulation from the audio device");
+    m_audioSyncCheck->setToolTip("Run each frame when the audio device has played the previous one, instead of on a timer. Avoids timer jitter, drift and underruns (e.g. in VMs). Uses the SDL audio output; applies at normal speed only.");
+#ifndef HAVE_SDL2_AUDIO
+    m_audioSyncCheck->setEnabled(false);
+#endif
+    audioLayout->addRow("", m_audioSyncCheck);
+
+    connect(m_audioSyncCheck, &QCheckBox::toggled, [this](bool enabled) {
+        if (m_emulator) {
+            m_emulator->setAudioMasterSync(enabled);
+        }
+    });
+
     // Audio Diagnostics (for troubleshooting)
     m_audioDiagnosticsCheck = new QCheckBox("Enable audio diagnostics logging (for troubleshooting)");
-    m_audioDiagnosticsCheck->setToolTip("Write detailed audio timing and buffer statistics to a CSV file. Enable this only when asked for diagnostics, as it may impact performance slightly.");
+    m_audioDiagnosticsCheck->setToolTip("Write per-frame audio timing and buffer statistics to audio_diagnostics.csv in the application data folder, starting with the last minute of history. The file is written by a background thread.");
     audioLayout->addRow("", m_audioDiagnosticsCheck);
 
     // Apply diagnostics toggle to emulator in real time
@@ -738,7 +822,9 @@ void SettingsDialog::createVideoDisplayTab()
     m_artifactingMode->addItem("None", "none");
     m_artifactingMode->addItem("NTSC Old", "ntsc-old");
     m_artifactingMode->addItem("NTSC New", "ntsc-new");
-    m_artifactingMode->setToolTip("Color artifacting simulation mode (NTSC modes work in NTSC video, PAL Simple available for PAL)");
+    m_artifactingMode->addItem("NTSC Composite (GPU)", "gpu-ntsc");
+    m_artifactingMode->setToolTip("Color artifacting simulation mode (NTSC modes work in NTSC video, PAL Simple available for PAL). "
+                                  "NTSC Composite decodes a simulated composite signal on the graphics card and needs GPU Rendering");
     generalLayout->addWidget(m_artifactingMode);
     generalLayout->addSpacing(15);
 
@@ -761,6 +847,10 @@ void SettingsDialog::createVideoDisplayTab()
     m_integerScaling->setToolTip("Scale only in whole multiples (2x, 3x, 4x) for crisp, evenly-sized pixels");
     generalLayout->addWidget(m_integerScaling);
 
+    m_gpuPresentation = new QCheckBox("GPU Rendering");
+    m_gpuPresentation->setToolTip("Do palette conversion and scaling on the graphics card (OpenGL) to reduce CPU usage");
+    generalLayout->addWidget(m_gpuPresentation);
+
     m_keepAspectRatio = new QCheckBox("Keep 4:3 Aspect");
     m_keepAspectRatio->setToolTip("Maintain authentic 4:3 display proportions when resizing window");
     generalLayout->addWidget(m_keepAspectRatio);
@@ -839,11 +929,44 @@ void SettingsDialog::createVideoDisplayTab()
     displayLayout->addWidget(m_show80Column);
 
     m_vSyncEnabled = new QCheckBox("V-Sync");
-    m_vSyncEnabled->setToolTip("Synchronize display to monitor refresh rate (reduces tearing)");
+    m_vSyncEnabled->setToolTip("Synchronize display to monitor refresh rate (reduces tearing).\n"
+                               "GPU presentation swaps on the vertical blank, and a machine rate close\n"
+                               "to the refresh rate (NTSC 59.92 Hz on a 60 Hz monitor) is paced to match it.");
     displayLayout->addWidget(m_vSyncEnabled);
     displayLayout->addStretch();
     
     tabLayout->addWidget(displayGroup);
+
+    // CRT effects, drawn by the GPU presentation path
+    m_crtGroup = new QGroupBox("CRT Effects (GPU Rendering)");
+    QHBoxLayout* crtLayout = new QHBoxLayout(m_crtGroup);
+
+    crtLayout->addWidget(new QLabel("Scanlines:"));
+    m_crtScanlines = new QSpinBox();
+    m_crtScanlines->setRange(0, 100);
+    m_crtScanlines->setSuffix(" %");
+    m_crtScanlines->setToolTip("Darken the gaps between scanlines (0 = off)");
+    crtLayout->addWidget(m_crtScanlines);
+    crtLayout->addSpacing(12);
+
+    crtLayout->addWidget(new QLabel("Phosphor Persistence:"));
+    m_crtPersistence = new QSpinBox();
+    m_crtPersistence->setRange(0, 90);
+    m_crtPersistence->setSuffix(" %");
+    m_crtPersistence->setToolTip("Share of the previous frame that lingers, like a slow phosphor (0 = off)");
+    crtLayout->addWidget(m_crtPersistence);
+    crtLayout->addSpacing(12);
+
+    crtLayout->addWidget(new QLabel("Curvature:"));
+    m_crtCurvature = new QSpinBox();
+    m_crtCurvature->setRange(0, 100);
+    m_crtCurvature->setSuffix(" %");
+    m_crtCurvature->setToolTip("Bend the picture like a curved CRT tube (0 = flat)");
+    crtLayout->addWidget(m_crtCurvature);
+    crtLayout->addStretch();
+
+    tabLayout->addWidget(m_crtGroup);
+    connect(m_gpuPresentation, &QCheckBox::toggled, m_crtGroup, &QWidget::setEnabled);
     
     // PAL-specific settings
     m_palGroup = new QGroupBox("PAL Video Options");
@@ -1784,6 +1907,13 @@ void SettingsDialog::createEmulatorTab()
     m_tcpServerPort->setValue(6502); // Default to 6502 (6502 processor reference)
     m_tcpServerPort->setToolTip("Port number for TCP server (default: 6502)");
     tcpServerLayout->addRow("Port:", m_tcpServerPort);
+
+    // Local socket for clients on the same host (same protocol as the TCP port)
+    m_localServerName = new QLineEdit();
+    m_localServerName->setPlaceholderText("Off");
+    m_localServerName->setValidator(new QRegularExpressionValidator(QRegularExpression("[A-Za-z0-9_.-]{0,64}"), m_localServerName));
+    m_localServerName->setToolTip("Also serve the TCP API on a local socket with this name (Unix domain socket or named pipe); leave empty to disable");
+    tcpServerLayout->addRow("Local socket:", m_localServerName);
     
     // Add description
     QLabel* tcpDescription = new QLabel(
@@ -2469,6 +2599,13 @@ void SettingsDialog::loadSettings()
     m_turboModeCheck->setChecked(settings.value("machine/turboMode", false).toBool());
     int speedIndex = settings.value("machine/emulationSpeedIndex", 1).toInt(); // Default to 1x (index 1)
     m_speedSlider->setValue(speedIndex);
+    m_runAheadSpinBox->setValue(settings.value("machine/runAheadFrames", 0).toInt());
+    m_threadPriorityCombo->setCurrentIndex(
+        qMax(0, m_threadPriorityCombo->findData(settings.value("emulator/threadPriority", "normal").toString())));
+    m_cpuAffinityCombo->setCurrentIndex(
+        qMax(0, m_cpuAffinityCombo->findData(settings.value("emulator/cpuAffinity", -1).toInt())));
+    m_preciseTimingCheck->setChecked(settings.value("emulator/preciseTiming", false).toBool());
+    m_hibernateOnQuitCheck->setChecked(settings.value("emulator/hibernateOnQuit", false).toBool());
     // Update label based on loaded index
     if (speedIndex == 0) {
         m_speedLabel->setText("0.5x");
@@ -2519,6 +2656,7 @@ void SettingsDialog::loadSettings()
     // Load Hardware Extensions
     m_stereoPokey->setChecked(settings.value("hardware/stereoPokey", false).toBool());
     m_sioAcceleration->setChecked(settings.value("hardware/sioAcceleration", true).toBool());
+    m_tapeAcceleration->setChecked(settings.value("machine/tapeAcceleration", true).toBool());
     
     // 80-Column Cards - Disabled until properly implemented
     // m_xep80Enabled->setChecked(settings.value("hardware/xep80", false).toBool());
@@ -2543,6 +2681,11 @@ void SettingsDialog::loadSettings()
     // Load Audio Configuration
     m_soundEnabled->setChecked(settings.value("audio/enabled", true).toBool());
     m_audioDiagnosticsCheck->setChecked(settings.value("audio/diagnosticsEnabled", false).toBool());
+    {
+        // Loading must not switch the emulator's audio backend
+        const QSignalBlocker blocker(m_audioSyncCheck);
+        m_audioSyncCheck->setChecked(settings.value("audio/syncToAudio", false).toBool());
+    }
     
     int audioFreq = settings.value("audio/frequency", 44100).toInt();
     for (int i = 0; i < m_audioFrequency->count(); ++i) {
@@ -2560,6 +2703,11 @@ void SettingsDialog::loadSettings()
         }
     }
     
+    const int resamplerIndex = m_audioResampler->findData(settings.value("audio/resampler", "sinc").toString());
+    m_audioResampler->setCurrentIndex(resamplerIndex >= 0 ? resamplerIndex : 0);
+    const int turboIndex = m_audioTurboMode->findData(settings.value("audio/turboMode", "compress").toString());
+    m_audioTurboMode->setCurrentIndex(turboIndex >= 0 ? turboIndex : 0);
+    
     // Load volume control
     int volume = settings.value("audio/volume", 80).toInt();
     m_volumeSlider->setValue(volume);
@@ -2587,6 +2735,11 @@ void SettingsDialog::loadSettings()
     m_showFPS->setChecked(settings.value("video/showFPS", false).toBool());
     m_scalingFilter->setChecked(settings.value("video/scalingFilter", true).toBool());
     m_integerScaling->setChecked(settings.value("video/integerScaling", true).toBool());
+    m_gpuPresentation->setChecked(settings.value("video/gpuPresentation", false).toBool());
+    m_crtGroup->setEnabled(m_gpuPresentation->isChecked());
+    m_crtScanlines->setValue(settings.value("video/crtScanlines", 0).toInt());
+    m_crtPersistence->setValue(settings.value("video/crtPersistence", 0).toInt());
+    m_crtCurvature->setValue(settings.value("video/crtCurvature", 0).toInt());
     m_keepAspectRatio->setChecked(settings.value("video/keepAspectRatio", true).toBool());
     m_fullscreenMode->setChecked(settings.value("video/fullscreenMode", false).toBool());
     
@@ -2802,6 +2955,7 @@ void SettingsDialog::loadSettings()
     // TCP Server Configuration
     m_tcpServerEnabled->setChecked(settings.value("emulator/tcpServerEnabled", true).toBool());
     m_tcpServerPort->setValue(settings.value("emulator/tcpServerPort", 6502).toInt());
+    m_localServerName->setText(settings.value("emulator/localServerName").toString());
 
     // Fastbasic Configuration
     m_fastbasicUseBundled->setChecked(settings.value("fastbasic/useBundled", true).toBool());
@@ -2875,6 +3029,11 @@ void SettingsDialog::saveSettings()
     // Save Performance settings
     settings.setValue("machine/turboMode", m_turboModeCheck->isChecked());
     settings.setValue("machine/emulationSpeedIndex", m_speedSlider->value());
+    settings.setValue("machine/runAheadFrames", m_runAheadSpinBox->value());
+    settings.setValue("emulator/threadPriority", m_threadPriorityCombo->currentData().toString());
+    settings.setValue("emulator/cpuAffinity", m_cpuAffinityCombo->currentData().toInt());
+    settings.setValue("emulator/preciseTiming", m_preciseTimingCheck->isChecked());
+    settings.setValue("emulator/hibernateOnQuit", m_hibernateOnQuitCheck->isChecked());
     
     // Save Cartridge Configuration
     settings.setValue("machine/cartridgeEnabled", m_cartridgeEnabledCheck->isChecked());
@@ -2888,6 +3047,7 @@ void SettingsDialog::saveSettings()
     // Save Hardware Extensions
     settings.setValue("hardware/stereoPokey", m_stereoPokey->isChecked());
     settings.setValue("hardware/sioAcceleration", m_sioAcceleration->isChecked());
+    settings.setValue("machine/tapeAcceleration", m_tapeAcceleration->isChecked());
     
     // 80-Column Cards - Disabled until properly implemented
     // settings.setValue("hardware/xep80", m_xep80Enabled->isChecked());
@@ -2908,8 +3068,11 @@ void SettingsDialog::saveSettings()
     // Save Audio Configuration
     settings.setValue("audio/enabled", m_soundEnabled->isChecked());
     settings.setValue("audio/diagnosticsEnabled", m_audioDiagnosticsCheck->isChecked());
+    settings.setValue("audio/syncToAudio", m_audioSyncCheck->isChecked());
     settings.setValue("audio/frequency", m_audioFrequency->currentData().toInt());
     settings.setValue("audio/bits", m_audioBits->currentData().toInt());
+    settings.setValue("audio/resampler", m_audioResampler->currentData().toString());
+    settings.setValue("audio/turboMode", m_audioTurboMode->currentData().toString());
     settings.setValue("audio/volume", m_volumeSlider->value());
     settings.setValue("audio/bufferLength", m_bufferLengthSpinBox->value());
     settings.setValue("audio/latency", m_audioLatencySpinBox->value());
@@ -2924,6 +3087,10 @@ void SettingsDialog::saveSettings()
     settings.setValue("video/showFPS", m_showFPS->isChecked());
     settings.setValue("video/scalingFilter", m_scalingFilter->isChecked());
     settings.setValue("video/integerScaling", m_integerScaling->isChecked());
+    settings.setValue("video/gpuPresentation", m_gpuPresentation->isChecked());
+    settings.setValue("video/crtScanlines", m_crtScanlines->value());
+    settings.setValue("video/crtPersistence", m_crtPersistence->value());
+    settings.setValue("video/crtCurvature", m_crtCurvature->value());
     settings.setValue("video/keepAspectRatio", m_keepAspectRatio->isChecked());
     settings.setValue("video/fullscreenMode", m_fullscreenMode->isChecked());
     
@@ -3025,6 +3192,7 @@ void SettingsDialog::saveSettings()
     // TCP Server Configuration
     settings.setValue("emulator/tcpServerEnabled", m_tcpServerEnabled->isChecked());
     settings.setValue("emulator/tcpServerPort", m_tcpServerPort->value());
+    settings.setValue("emulator/localServerName", m_localServerName->text());
 
     // Fastbasic Configuration
     settings.setValue("fastbasic/useBundled", m_fastbasicUseBundled->isChecked());
@@ -3178,9 +3346,19 @@ void SettingsDialog::applyMediaSettings()
         }
     }
     
-    // TODO: Apply cassette settings
+    // Apply cassette settings; a tape already in the recorder keeps its position.
+    // "Boot from Tape" only takes effect on startup.
     if (m_cassetteEnabled->isChecked() && !m_cassettePath->text().isEmpty()) {
-        qDebug() << "Cassette support not yet implemented in emulator backend";
+        QString cassettePath = m_cassettePath->text();
+        if (cassettePath != m_emulator->getCassettePath()) {
+            if (m_emulator->insertCassette(cassettePath, m_cassetteReadOnly->isChecked())) {
+                qDebug() << "Successfully inserted cassette:" << cassettePath;
+            } else {
+                qDebug() << "Failed to insert cassette:" << cassettePath;
+            }
+        }
+    } else if (!m_emulator->getCassettePath().isEmpty()) {
+        m_emulator->ejectCassette();
     }
     
     // Apply hard drive settings
@@ -3423,6 +3601,9 @@ void SettingsDialog::applySettings()
             int percentage = (speedIndex == 0) ? 50 : speedIndex * 100;
             m_emulator->setEmulationSpeed(percentage);
         }
+        m_emulator->setRunAheadFrames(m_runAheadSpinBox->value());
+        m_emulator->setTapeAccelerationEnabled(m_tapeAcceleration->isChecked());
+        QMetaObject::invokeMethod(m_emulator, "applyThreadSchedulingSetting", Qt::QueuedConnection);
     }
 
     emit settingsChanged();
@@ -3629,6 +3810,11 @@ void SettingsDialog::restoreDefaults()
     m_turboModeCheck->setChecked(false);
     m_speedSlider->setValue(1);  // Default to 1x speed (index 1)
     m_speedLabel->setText("1x");
+    m_runAheadSpinBox->setValue(0);
+    m_threadPriorityCombo->setCurrentIndex(0);
+    m_cpuAffinityCombo->setCurrentIndex(0);
+    m_preciseTimingCheck->setChecked(false);
+    m_hibernateOnQuitCheck->setChecked(false);
     
     // Cartridge Configuration defaults
     m_cartridgeEnabledCheck->setChecked(false);
@@ -3642,6 +3828,7 @@ void SettingsDialog::restoreDefaults()
     // Hardware Extensions defaults
     m_stereoPokey->setChecked(false);
     m_sioAcceleration->setChecked(true);
+    m_tapeAcceleration->setChecked(true);
     
     // 80-Column Cards defaults - Disabled until properly implemented
     m_xep80Enabled->setChecked(false);
@@ -3660,8 +3847,11 @@ void SettingsDialog::restoreDefaults()
     // Audio Configuration defaults
     m_soundEnabled->setChecked(true);
     m_audioDiagnosticsCheck->setChecked(false);
+    m_audioSyncCheck->setChecked(false);
     m_audioFrequency->setCurrentIndex(1); // 44100 Hz
     m_audioBits->setCurrentIndex(1);       // 16-bit
+    m_audioResampler->setCurrentIndex(0);  // sinc
+    m_audioTurboMode->setCurrentIndex(0);  // time-compressed
     m_volumeSlider->setValue(80);          // 80% volume
     m_volumeLabel->setText("80%");
     m_bufferLengthSpinBox->setValue(100);  // 100ms buffer
@@ -3677,6 +3867,10 @@ void SettingsDialog::restoreDefaults()
     m_showFPS->setChecked(false);
     m_scalingFilter->setChecked(true);
     m_integerScaling->setChecked(true);
+    m_gpuPresentation->setChecked(false);
+    m_crtScanlines->setValue(0);
+    m_crtPersistence->setValue(0);
+    m_crtCurvature->setValue(0);
     m_keepAspectRatio->setChecked(true);
     m_fullscreenMode->setChecked(false);
     
@@ -3867,6 +4061,7 @@ ConfigurationProfile SettingsDialog::getCurrentUIState() const
     // Performance
     profile.turboMode = m_turboModeCheck->isChecked();
     profile.emulationSpeedIndex = m_speedSlider->value();
+    profile.runAheadFrames = m_runAheadSpinBox->value();
     
     // Audio Configuration
     profile.audioEnabled = m_soundEnabled->isChecked();
@@ -4064,6 +4259,7 @@ void SettingsDialog::loadProfileToUI(const ConfigurationProfile& profile)
     // Performance
     m_turboModeCheck->setChecked(profile.turboMode);
     m_speedSlider->setValue(profile.emulationSpeedIndex);
+    m_runAheadSpinBox->setValue(profile.runAheadFrames);
     
     // Audio Configuration
     m_soundEnabled->setChecked(profile.audioEnabled);
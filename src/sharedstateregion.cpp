@@ -0,0 +1,193 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "sharedstateregion.h"
+#include <QDir>
+#include <QJsonArray>
+#include <QtEndian>
+#include <cstring>
+#include <new>
+
+namespace {
+
+constexpr int kRangeEntrySize = 16;
+constexpr int kPaletteSize = 256 * 3;
+
+int alignTo64(int offset)
+{
+    return (offset + 63) & ~63;
+}
+
+}  // namespace
+
+SharedStateRegion::~SharedStateRegion()
+{
+    close();
+}
+
+QString SharedStateRegion::pathForName(const QString& name)
+{
+    const QDir shm("/dev/shm");
+    const QString dir = shm.exists() ? shm.path() : QDir::tempPath();
+    return QDir(dir).filePath(name);
+}
+
+bool SharedStateRegion::open(const QString& path, const QVector<Range>& ranges, QString* error)
+{
+    close();
+    if (ranges.size() > kMaxRanges) {
+        *error = QString("At most %1 RAM ranges").arg(kMaxRanges);
+        return false;
+    }
+    for (const Range& range : ranges) {
+        if (range.address < 0 || range.length <= 0 || range.address + range.length > 0x10000) {
+            *error = QString("RAM range $%1+%2 is outside memory").arg(range.address, 4, 16, QChar('0')).arg(range.length);
+            return false;
+        }
+    }
+
+    // Header, range table, then the screen, palette and RAM, each on a cache line
+    int offset = kHeaderSize + ranges.size() * kRangeEntrySize;
+    m_screenOffset = alignTo64(offset);
+    m_paletteOffset = alignTo64(m_screenOffset + kScreenWidth * kScreenHeight);
+    m_ramOffset = alignTo64(m_paletteOffset + kPaletteSize);
+    offset = m_ramOffset;
+    m_rangeOffsets.clear();
+    for (const Range& range : ranges) {
+        m_rangeOffsets.append(offset);
+        offset += range.length;
+    }
+    m_size = alignTo64(offset);
+    m_ranges = ranges;
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate) || !m_file.resize(m_size)) {
+        *error = "Cannot create " + path + ": " + m_file.errorString();
+        m_file.close();
+        return false;
+    }
+    m_data = m_file.map(0, m_size);
+    if (!m_data) {
+        *error = "Cannot map " + path + ": " + m_file.errorString();
+        m_file.close();
+        m_file.remove();
+        return false;
+    }
+
+    std::memset(m_data, 0, m_size);
+    m_sequence = new (m_data + 8) std::atomic<quint32>(0);
+    writeU32(0, kMagic);
+    writeU16(4, kVersion);
+    writeU16(6, kHeaderSize);
+    writeU32(12, static_cast<quint32>(m_size));
+    writeU16(32, kScreenWidth);
+    writeU16(34, kScreenHeight);
+    writeU32(36, static_cast<quint32>(m_screenOffset));
+    writeU32(40, static_cast<quint32>(m_paletteOffset));
+    writeU32(44, static_cast<quint32>(m_ramOffset));
+    writeU32(48, static_cast<quint32>(ranges.size()));
+    writeU32(52, kHeaderSize);
+    for (int i = 0; i < ranges.size(); ++i) {
+        const int entry = kHeaderSize + i * kRangeEntrySize;
+        writeU32(entry, static_cast<quint32>(ranges[i].address));
+        writeU32(entry + 4, static_cast<quint32>(ranges[i].length));
+        writeU32(entry + 8, static_cast<quint32>(m_rangeOffsets[i]));
+    }
+    m_publishCount = 0;
+    return true;
+}
+
+void SharedStateRegion::close()
+{
+    if (!m_data) {
+        return;
+    }
+    m_file.unmap(m_data);
+    m_data = nullptr;
+    m_sequence = nullptr;
+    m_file.close();
+    m_file.remove();
+}
+
+QJsonObject SharedStateRegion::layout() const
+{
+    QJsonObject layout;
+    if (!m_data) {
+        return layout;
+    }
+    layout["path"] = m_file.fileName();
+    layout["size"] = m_size;
+    layout["version"] = kVersion;
+    layout["screen_offset"] = m_screenOffset;
+    layout["screen_width"] = kScreenWidth;
+    layout["screen_height"] = kScreenHeight;
+    layout["palette_offset"] = m_paletteOffset;
+    QJsonArray ranges;
+    for (int i = 0; i < m_ranges.size(); ++i) {
+        QJsonObject range;
+        range["address"] = m_ranges[i].address;
+        range["length"] = m_ranges[i].length;
+        range["offset"] = m_rangeOffsets[i];
+        ranges.append(range);
+    }
+    layout["ranges"] = ranges;
+    return layout;
+}
+
+void SharedStateRegion::publish(quint64 frame, const Registers& registers, const unsigned char* screen,
+                                const QVector<QRgb>& palette, const unsigned char* memory)
+{
+    if (!m_data) {
+        return;
+    }
+    // Odd while writing; the release fence keeps the body from moving above it
+    const quint32 sequence = m_sequence->load(std::memory_order_relaxed);
+    m_sequence->store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    writeU64(16, frame);
+    writeU16(24, registers.pc);
+    m_data[26] = registers.a;
+    m_data[27] = registers.x;
+    m_data[28] = registers.y;
+    m_data[29] = registers.s;
+    m_data[30] = registers.p;
+    writeU64(56, ++m_publishCount);
+
+    if (screen) {
+        std::memcpy(m_data + m_screenOffset, screen, kScreenWidth * kScreenHeight);
+    }
+    uchar* rgb = m_data + m_paletteOffset;
+    for (int i = 0; i < 256; ++i) {
+        const QRgb color = i < palette.size() ? palette[i] : 0;
+        rgb[i * 3] = static_cast<uchar>(qRed(color));
+        rgb[i * 3 + 1] = static_cast<uchar>(qGreen(color));
+        rgb[i * 3 + 2] = static_cast<uchar>(qBlue(color));
+    }
+    if (memory) {
+        for (int i = 0; i < m_ranges.size(); ++i) {
+            std::memcpy(m_data + m_rangeOffsets[i], memory + m_ranges[i].address, m_ranges[i].length);
+        }
+    }
+
+    m_sequence->store(sequence + 2, std::memory_order_release);
+}
+
+void SharedStateRegion::writeU16(int offset, quint16 value)
+{
+    qToLittleEndian(value, m_data + offset);
+}
+
+void SharedStateRegion::writeU32(int offset, quint32 value)
+{
+    qToLittleEndian(value, m_data + offset);
+}
+
+void SharedStateRegion::writeU64(int offset, quint64 value)
+{
+    qToLittleEndian(value, m_data + offset);
+}
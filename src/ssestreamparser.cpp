@@ -0,0 +1,111 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "ssestreamparser.h"
+
+QVector<SseStreamParser::Event> SseStreamParser::feed(const QByteArray& chunk)
+{
+    QVector<Event> events;
+    const char* p = chunk.constData();
+    const int size = chunk.size();
+    int start = 0;
+    for (int i = 0; i < size; ++i) {
+        const char c = p[i];
+        if (c != '\n' && c != '\r') {
+            continue;
+        }
+        if (c == '\n' && m_lastWasCR && i == start) {
+            // Second half of a CRLF split across chunks
+            m_lastWasCR = false;
+            start = i + 1;
+            continue;
+        }
+        if (!m_discardingLine) {
+            m_line.append(p + start, i - start);
+            processLine(events);
+        }
+        m_line.clear();
+        m_discardingLine = false;
+        m_lastWasCR = (c == '\r');
+        if (m_lastWasCR && i + 1 < size && p[i + 1] == '\n') {
+            ++i;
+            m_lastWasCR = false;
+        }
+        start = i + 1;
+    }
+    if (start < size) {
+        m_lastWasCR = false;
+        if (!m_discardingLine) {
+            m_line.append(p + start, size - start);
+            if (m_line.size() > kMaxLineBytes) {
+                m_line.clear();
+                m_discardingLine = true;
+            }
+        }
+    }
+    return events;
+}
+
+void SseStreamParser::reset()
+{
+    m_line.clear();
+    m_event = Event();
+    m_hasData = false;
+    m_lastWasCR = false;
+    m_discardingLine = false;
+    m_retryMs = -1;
+}
+
+void SseStreamParser::processLine(QVector<Event>& events)
+{
+    if (m_line.isEmpty()) {
+        if (m_hasData) {
+            if (m_event.data.endsWith('\n')) {
+                m_event.data.chop(1);
+            }
+            events.append(m_event);
+        }
+        // The id persists across events; the rest starts over
+        const QByteArray id = m_event.id;
+        m_event = Event();
+        m_event.id = id;
+        m_hasData = false;
+        return;
+    }
+    if (m_line.startsWith(':')) {
+        return;  // comment / keepalive
+    }
+
+    const int colon = m_line.indexOf(':');
+    const QByteArray field = colon < 0 ? m_line : m_line.left(colon);
+    QByteArray value;
+    if (colon >= 0) {
+        int valueStart = colon + 1;
+        if (valueStart < m_line.size() && m_line.at(valueStart) == ' ') {
+            ++valueStart;
+        }
+        value = m_line.mid(valueStart);
+    }
+
+    if (field == "data") {
+        m_event.data.append(value);
+        m_event.data.append('\n');
+        m_hasData = true;
+    } else if (field == "event") {
+        m_event.name = value.isEmpty() ? QByteArray("message") : value;
+    } else if (field == "id") {
+        if (!value.contains('\0')) {
+            m_event.id = value;
+        }
+    } else if (field == "retry") {
+        bool ok = false;
+        const int ms = value.toInt(&ok);
+        if (ok && ms >= 0) {
+            m_retryMs = ms;
+        }
+    }
+}
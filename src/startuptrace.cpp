@@ -0,0 +1,309 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "startuptrace.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QThread>
+#include <atomic>
+
+namespace {
+
+const char* kTraceOption = "--startup-trace";
+const char* kBenchmarkOption = "--startup-benchmark";
+
+struct TraceState {
+    QMutex mutex;
+    QElapsedTimer clock;
+    std::atomic<bool> enabled{false};
+    bool benchmark = false;
+    QString outputPath;
+    QVector<StartupTrace::Event> events;
+    QVector<Qt::HANDLE> threads;
+    QStringList threadNames;
+    qint64 firstFrameUs = -1;
+};
+
+TraceState& state()
+{
+    static TraceState s;
+    return s;
+}
+
+}  // namespace
+
+StartupTrace::Scope::Scope(const char* name)
+    : m_name(name)
+    , m_startUs(isEnabled() ? nowUs() : -1)
+{
+}
+
+StartupTrace::Scope::~Scope()
+{
+    if (m_startUs >= 0) {
+        addComplete(m_name, m_startUs, nowUs() - m_startUs);
+    }
+}
+
+void StartupTrace::enableFromArguments(int argc, char* argv[])
+{
+    QString path = QString::fromLocal8Bit(qgetenv("FUJISAN_STARTUP_TRACE"));
+    bool benchmark = false;
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], kBenchmarkOption) == 0) {
+            benchmark = true;
+        } else if (qstrcmp(argv[i], kTraceOption) == 0 && i + 1 < argc) {
+            path = QString::fromLocal8Bit(argv[++i]);
+        }
+    }
+    if (benchmark || !path.isEmpty()) {
+        enable(path, benchmark);
+    }
+}
+
+void StartupTrace::enable(const QString& outputPath, bool benchmark)
+{
+    TraceState& s = state();
+    QMutexLocker locker(&s.mutex);
+    s.clock.start();
+    s.outputPath = outputPath;
+    s.benchmark = benchmark;
+    s.events.clear();
+    s.threads.clear();
+    s.threadNames.clear();
+    s.firstFrameUs = -1;
+    s.enabled = true;
+}
+
+bool StartupTrace::isEnabled()
+{
+    return state().enabled.load(std::memory_order_relaxed);
+}
+
+bool StartupTrace::isBenchmark()
+{
+    return isEnabled() && state().benchmark;
+}
+
+qint64 StartupTrace::nowUs()
+{
+    TraceState& s = state();
+    return s.clock.isValid() ? s.clock.nsecsElapsed() / 1000 : 0;
+}
+
+int StartupTrace::threadIndex()
+{
+    // Caller holds the mutex
+    TraceState& s = state();
+    const Qt::HANDLE id = QThread::currentThreadId();
+    int index = s.threads.indexOf(id);
+    if (index < 0) {
+        index = s.threads.size();
+        s.threads.append(id);
+        const QString name = QThread::currentThread()->objectName();
+        s.threadNames.append(!name.isEmpty() ? name
+                                             : index == 0 ? QStringLiteral("main")
+                                                          : QStringLiteral("thread %1").arg(index));
+    }
+    return index;
+}
+
+void StartupTrace::addComplete(const char* name, qint64 startUs, qint64 durationUs)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    TraceState& s = state();
+    QMutexLocker locker(&s.mutex);
+    if (s.firstFrameUs >= 0) {
+        return;  // the trace is closed; a phase ending later is not startup any more
+    }
+    Event event;
+    event.name = name;
+    event.startUs = startUs;
+    event.durationUs = qMax<qint64>(0, durationUs);
+    event.thread = threadIndex();
+    s.events.append(event);
+}
+
+void StartupTrace::addInstant(const char* name)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    TraceState& s = state();
+    QMutexLocker locker(&s.mutex);
+    if (s.firstFrameUs >= 0) {
+        return;
+    }
+    Event event;
+    event.name = name;
+    event.startUs = nowUs();
+    event.thread = threadIndex();
+    s.events.append(event);
+}
+
+void StartupTrace::markFirstFrame()
+{
+    if (!isEnabled()) {
+        return;
+    }
+    TraceState& s = state();
+    QString path;
+    bool benchmark;
+    {
+        QMutexLocker locker(&s.mutex);
+        if (s.firstFrameUs >= 0) {
+            return;
+        }
+        Event event;
+        event.name = "first_frame";
+        event.startUs = nowUs();
+        event.thread = threadIndex();
+        s.events.append(event);
+        s.firstFrameUs = event.startUs;
+        path = s.outputPath;
+        benchmark = s.benchmark;
+    }
+
+    if (!path.isEmpty()) {
+        QString error;
+        if (!writeTo(path, &error)) {
+            qWarning() << "Startup trace:" << error;
+        }
+    }
+    if (benchmark) {
+        QTextStream out(stdout);
+        out << QJsonDocument(summary()).toJson(QJsonDocument::Compact) << "\n";
+        out.flush();
+        QCoreApplication::exit(0);
+    }
+}
+
+bool StartupTrace::firstFrameSeen()
+{
+    TraceState& s = state();
+    QMutexLocker locker(&s.mutex);
+    return s.firstFrameUs >= 0;
+}
+
+QVector<StartupTrace::Event> StartupTrace::events()
+{
+    TraceState& s = state();
+    QMutexLocker locker(&s.mutex);
+    return s.events;
+}
+
+QStringList StartupTrace::threadNames()
+{
+    TraceState& s = state();
+    QMutexLocker locker(&s.mutex);
+    return s.threadNames;
+}
+
+QByteArray StartupTrace::toChromeJson()
+{
+    const QVector<Event> recorded = events();
+    const QStringList names = threadNames();
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray traceEvents;
+    for (int i = 0; i < names.size(); ++i) {
+        QJsonObject meta;
+        meta["name"] = "thread_name";
+        meta["ph"] = "M";
+        meta["pid"] = pid;
+        meta["tid"] = i;
+        meta["args"] = QJsonObject{{"name", names[i]}};
+        traceEvents.append(meta);
+    }
+    for (const Event& event : recorded) {
+        QJsonObject entry;
+        entry["name"] = QString::fromUtf8(event.name);
+        entry["cat"] = "startup";
+        entry["pid"] = pid;
+        entry["tid"] = event.thread;
+        entry["ts"] = event.startUs;
+        if (event.durationUs >= 0) {
+            entry["ph"] = "X";
+            entry["dur"] = event.durationUs;
+        } else {
+            entry["ph"] = "i";
+            entry["s"] = "p";  // instant drawn across the whole process
+        }
+        traceEvents.append(entry);
+    }
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+QJsonObject StartupTrace::summary()
+{
+    const QVector<Event> recorded = events();
+    QJsonObject phases;
+    qint64 firstFrameUs = -1;
+    for (const Event& event : recorded) {
+        if (event.durationUs < 0) {
+            if (event.name == "first_frame") {
+                firstFrameUs = event.startUs;
+            }
+            continue;
+        }
+        const QString name = QString::fromUtf8(event.name);
+        const double ms = event.durationUs / 1000.0;
+        if (ms > phases.value(name).toDouble(-1.0)) {
+            phases[name] = ms;
+        }
+    }
+    QJsonObject result;
+    result["time_to_first_frame_ms"] = firstFrameUs >= 0 ? QJsonValue(firstFrameUs / 1000.0) : QJsonValue();
+    result["phases"] = phases;
+    return result;
+}
+
+bool StartupTrace::writeTo(const QString& path, QString* error)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) {
+            *error = QString("Cannot write %1: %2").arg(path, file.errorString());
+        }
+        return false;
+    }
+    file.write(toChromeJson());
+    if (!file.commit()) {
+        if (error) {
+            *error = QString("Cannot write %1: %2").arg(path, file.errorString());
+        }
+        return false;
+    }
+    return true;
+}
+
+void StartupTrace::reset()
+{
+    TraceState& s = state();
+    QMutexLocker locker(&s.mutex);
+    s.enabled = false;
+    s.benchmark = false;
+    s.outputPath.clear();
+    s.events.clear();
+    s.threads.clear();
+    s.threadNames.clear();
+    s.firstFrameUs = -1;
+    s.clock.invalidate();
+}
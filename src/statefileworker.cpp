@@ -0,0 +1,103 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "statefileworker.h"
+#include <QSaveFile>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QDateTime>
+#include <QDebug>
+
+namespace {
+
+const QByteArray kCompressedMagic("FUJISANZ");
+// Level 6: zlib's default; good ratio on RAM-heavy state without costing much time
+constexpr int kCompressionLevel = 6;
+
+}  // namespace
+
+StateFileWorker::StateFileWorker(QObject* parent)
+    : QObject(parent)
+{
+}
+
+QByteArray StateFileWorker::encode(const QByteArray& rawState)
+{
+    return kCompressedMagic + qCompress(rawState, kCompressionLevel);
+}
+
+bool StateFileWorker::decode(const QByteArray& fileData, QByteArray& rawState)
+{
+    if (!fileData.startsWith(kCompressedMagic)) {
+        // Legacy uncompressed state file
+        rawState = fileData;
+        return !rawState.isEmpty();
+    }
+    rawState = qUncompress(fileData.mid(kCompressedMagic.size()));
+    return !rawState.isEmpty();
+}
+
+bool StateFileWorker::writeStateFile(const QString& filename, const QByteArray& rawState,
+                                     const QString& profileName)
+{
+    if (rawState.isEmpty()) {
+        return false;
+    }
+
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to open state file for writing:" << filename << file.errorString();
+        return false;
+    }
+    const QByteArray encoded = encode(rawState);
+    if (file.write(encoded) != encoded.size() || !file.commit()) {
+        qWarning() << "Failed to write state file:" << filename << file.errorString();
+        return false;
+    }
+
+    // Save metadata
+    QSettings stateSettings(filename + ".meta", QSettings::IniFormat);
+    stateSettings.setValue("profile", profileName);
+    stateSettings.setValue("timestamp", QDateTime::currentDateTime());
+    stateSettings.sync();
+    return true;
+}
+
+bool StateFileWorker::readStateFile(const QString& filename, QByteArray& rawState, QString& profileName)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open state file:" << filename;
+        return false;
+    }
+    if (!decode(file.readAll(), rawState)) {
+        qWarning() << "State file is empty or corrupt:" << filename;
+        return false;
+    }
+
+    // Load the profile name from meta file if it exists
+    const QString metaFile = filename + ".meta";
+    if (QFileInfo::exists(metaFile)) {
+        QSettings stateSettings(metaFile, QSettings::IniFormat);
+        profileName = stateSettings.value("profile").toString();
+    }
+    return true;
+}
+
+void StateFileWorker::save(const QString& filename, const QByteArray& rawState, const QString& profileName)
+{
+    emit saved(filename, writeStateFile(filename, rawState, profileName));
+}
+
+void StateFileWorker::load(const QString& filename)
+{
+    QByteArray rawState;
+    QString profileName;
+    const bool success = readStateFile(filename, rawState, profileName);
+    emit loaded(filename, rawState, profileName, success);
+}
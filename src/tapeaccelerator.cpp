@@ -0,0 +1,62 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "tapeaccelerator.h"
+
+TapeAccelerator::Transition TapeAccelerator::update(bool tapeMounted, bool motorOn, bool recording,
+                                                    int position, int size)
+{
+    const bool readable = tapeMounted && !recording && size > 0 && position < size;
+    if (!readable) {
+        m_motorOnFrames = 0;
+        m_motorOffFrames = 0;
+        if (m_active) {
+            m_active = false;
+            return Stop;
+        }
+        return NoChange;
+    }
+
+    if (motorOn) {
+        m_motorOffFrames = 0;
+        ++m_motorOnFrames;
+    } else {
+        m_motorOnFrames = 0;
+        ++m_motorOffFrames;
+    }
+
+    if (m_active) {
+        ++m_acceleratedFrames;
+        if (m_motorOffFrames >= kStopFrames) {
+            m_active = false;
+            return Stop;
+        }
+        return NoChange;
+    }
+    if (m_motorOnFrames >= kStartFrames) {
+        m_active = true;
+        ++m_loads;
+        return Start;
+    }
+    return NoChange;
+}
+
+void TapeAccelerator::reset()
+{
+    m_active = false;
+    m_motorOnFrames = 0;
+    m_motorOffFrames = 0;
+}
+
+QJsonObject TapeAccelerator::status() const
+{
+    QJsonObject status;
+    status["active"] = m_active;
+    status["loads"] = static_cast<qint64>(m_loads);
+    status["accelerated_frames"] = static_cast<qint64>(m_acceleratedFrames);
+    return status;
+}
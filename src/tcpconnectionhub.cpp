@@ -0,0 +1,457 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "tcpconnectionhub.h"
+#include <QDebug>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+namespace {
+
+bool isSocketConnected(QIODevice* socket)
+{
+    if (QTcpSocket* tcp = qobject_cast<QTcpSocket*>(socket)) {
+        return tcp->state() == QAbstractSocket::ConnectedState;
+    }
+    if (QLocalSocket* local = qobject_cast<QLocalSocket*>(socket)) {
+        return local->state() == QLocalSocket::ConnectedState;
+    }
+    return false;
+}
+
+void disconnectSocket(QIODevice* socket)
+{
+    if (QTcpSocket* tcp = qobject_cast<QTcpSocket*>(socket)) {
+        tcp->disconnectFromHost();
+        if (tcp->state() != QAbstractSocket::UnconnectedState) {
+            tcp->waitForDisconnected(1000);
+        }
+    } else if (QLocalSocket* local = qobject_cast<QLocalSocket*>(socket)) {
+        local->disconnectFromServer();
+        if (local->state() != QLocalSocket::UnconnectedState) {
+            local->waitForDisconnected(1000);
+        }
+    }
+}
+
+}  // namespace
+
+TCPConnectionHub::TCPConnectionHub(QObject* parent)
+    : QObject(parent)
+    , m_server(new QTcpServer(this))
+    , m_localServer(new QLocalServer(this))
+{
+    connect(m_server, &QTcpServer::newConnection, this, &TCPConnectionHub::onNewConnection);
+    connect(m_localServer, &QLocalServer::newConnection, this, &TCPConnectionHub::onNewLocalConnection);
+    // Same trust model as listening on localhost only: the owner's processes
+    m_localServer->setSocketOptions(QLocalServer::UserAccessOption);
+}
+
+TCPConnectionHub::~TCPConnectionHub()
+{
+    close();
+}
+
+void TCPConnectionHub::sendMessage(quint32 client, const QJsonObject& message, const QString& metricKey)
+{
+    QMetaObject::invokeMethod(this, [this, client, message, metricKey]() {
+        const auto it = m_connections.find(client);
+        if (it == m_connections.end()) {
+            return;
+        }
+        bool compressed = false;
+        const QByteArray data = serialise(message, metricKey, it.value().encoder, &compressed);
+        if (compressed) {
+            it.value().messagesCompressed++;
+        }
+        queueBytes(client, it.value(), data);
+    }, Qt::QueuedConnection);
+}
+
+void TCPConnectionHub::sendData(quint32 client, const QByteArray& data)
+{
+    QMetaObject::invokeMethod(this, "writeData", Qt::QueuedConnection,
+                              Q_ARG(quint32, client), Q_ARG(QByteArray, data));
+}
+
+void TCPConnectionHub::sendEvent(quint32 client, const QString& eventType, const QJsonObject& event)
+{
+    QMetaObject::invokeMethod(this, [this, client, eventType, event]() {
+        const auto it = m_connections.constFind(client);
+        if (it != m_connections.constEnd()) {
+            writeEvent(client, eventType, serialise(event, "event:" + eventType, it.value().encoder));
+        }
+    }, Qt::QueuedConnection);
+}
+
+void TCPConnectionHub::broadcastEvent(const QVector<quint32>& clients, const QString& eventType,
+                                      const QJsonObject& event)
+{
+    QMetaObject::invokeMethod(this, [this, clients, eventType, event]() {
+        // One serialisation per encoding in use; sockets share shallow copies of the bytes
+        QVector<QPair<MessageEncoder, QByteArray>> encoded;
+        for (quint32 client : clients) {
+            const auto it = m_connections.constFind(client);
+            if (it == m_connections.constEnd()) {
+                continue;
+            }
+            const MessageEncoder& encoder = it.value().encoder;
+            int index = 0;
+            while (index < encoded.size() && encoded[index].first != encoder) {
+                index++;
+            }
+            if (index == encoded.size()) {
+                encoded.append(qMakePair(encoder, serialise(event, "event:" + eventType, encoder)));
+            }
+            writeEvent(client, eventType, encoded[index].second);
+        }
+    }, Qt::QueuedConnection);
+}
+
+qint64 TCPConnectionHub::queuedBytes(quint32 client) const
+{
+    QMutexLocker locker(&m_queuedMutex);
+    return m_queuedBytes.value(client, 0);
+}
+
+QJsonObject TCPConnectionHub::parseJsonMessage(const QByteArray& data, bool& success)
+{
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(data, &error);
+
+    if (error.error != QJsonParseError::NoError) {
+        qDebug() << "TCP Server: JSON parse error:" << error.errorString();
+        success = false;
+        return QJsonObject();
+    }
+
+    if (!doc.isObject()) {
+        qDebug() << "TCP Server: JSON is not an object";
+        success = false;
+        return QJsonObject();
+    }
+
+    success = true;
+    return doc.object();
+}
+
+bool TCPConnectionHub::parsePolicy(const QString& name, BackpressurePolicy* policy)
+{
+    if (name == "drop") {
+        *policy = DropEvents;
+    } else if (name == "coalesce") {
+        *policy = CoalesceEvents;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QString TCPConnectionHub::policyName(BackpressurePolicy policy)
+{
+    return policy == CoalesceEvents ? "coalesce" : "drop";
+}
+
+QByteArray TCPConnectionHub::serialise(const QJsonObject& message, const QString& metricKey,
+                                       const MessageEncoder& encoder, bool* compressed)
+{
+    const qint64 start = LatencyHistogram::nowMicroseconds();
+    const QByteArray line = encoder.encode(message, compressed);
+    m_serialisationTimes[metricKey.isEmpty() ? QStringLiteral("other") : metricKey]
+        .record(LatencyHistogram::nowMicroseconds() - start);
+    return line;
+}
+
+bool TCPConnectionHub::listen(quint16 port)
+{
+    // Listen only on localhost for security
+    if (!m_server->listen(QHostAddress::LocalHost, port)) {
+        qDebug() << "[TCP] Failed to start server on port" << port
+                 << "Error:" << m_server->errorString();
+        return false;
+    }
+    return true;
+}
+
+quint16 TCPConnectionHub::serverPort() const
+{
+    return m_server->serverPort();
+}
+
+bool TCPConnectionHub::listenLocal(const QString& name)
+{
+    closeLocal();
+    // A previous instance that crashed leaves its socket file behind on Unix
+    QLocalServer::removeServer(name);
+    if (!m_localServer->listen(name)) {
+        qDebug() << "[TCP] Failed to listen on local socket" << name
+                 << "Error:" << m_localServer->errorString();
+        return false;
+    }
+    return true;
+}
+
+QString TCPConnectionHub::localServerPath() const
+{
+    return m_localServer->isListening() ? m_localServer->fullServerName() : QString();
+}
+
+void TCPConnectionHub::closeLocal()
+{
+    m_localServer->close();
+}
+
+void TCPConnectionHub::close()
+{
+    // Disconnect all clients
+    for (auto it = m_connections.begin(); it != m_connections.end(); ++it) {
+        QIODevice* socket = it.value().socket;
+        socket->disconnect(this);
+        disconnectSocket(socket);
+        socket->deleteLater();
+    }
+    m_connections.clear();
+    m_socketClients.clear();
+    {
+        QMutexLocker locker(&m_queuedMutex);
+        m_queuedBytes.clear();
+    }
+    m_server->close();
+    m_localServer->close();
+}
+
+void TCPConnectionHub::setBackpressure(quint32 client, int policy, qint64 eventBacklogLimit)
+{
+    const auto it = m_connections.find(client);
+    if (it == m_connections.end()) {
+        return;
+    }
+    it.value().policy = policy == CoalesceEvents ? CoalesceEvents : DropEvents;
+    it.value().eventBacklogLimit = eventBacklogLimit;
+}
+
+void TCPConnectionHub::setEncoding(quint32 client, int encoding, int compressThreshold)
+{
+    const auto it = m_connections.find(client);
+    if (it == m_connections.end()) {
+        return;
+    }
+    it.value().encoder = MessageEncoder(static_cast<MessageEncoder::Encoding>(encoding), compressThreshold);
+}
+
+QJsonObject TCPConnectionHub::connectionStats(quint32 client) const
+{
+    const auto it = m_connections.constFind(client);
+    if (it == m_connections.constEnd()) {
+        return QJsonObject();
+    }
+    const Connection& connection = it.value();
+    QJsonObject stats;
+    stats["policy"] = policyName(connection.policy);
+    stats["event_backlog_limit"] = connection.eventBacklogLimit;
+    stats["queued_bytes"] = queuedBytes(client);
+    stats["peak_queued_bytes"] = connection.peakQueuedBytes;
+    stats["events_sent"] = static_cast<qint64>(connection.eventsSent);
+    stats["events_dropped"] = static_cast<qint64>(connection.eventsDropped);
+    stats["events_coalesced"] = static_cast<qint64>(connection.eventsCoalesced);
+    stats["events_waiting"] = connection.coalesced.size();
+    stats["encoding"] = MessageEncoder::encodingName(connection.encoder.encoding());
+    stats["compress_threshold"] = connection.encoder.compressThreshold();
+    stats["messages_compressed"] = static_cast<qint64>(connection.messagesCompressed);
+    stats["bytes_in"] = static_cast<qint64>(connection.bytesIn);
+    stats["bytes_out"] = static_cast<qint64>(connection.bytesOut);
+    return stats;
+}
+
+QJsonObject TCPConnectionHub::serialisationMetrics(bool reset)
+{
+    QJsonObject metrics;
+    for (auto it = m_serialisationTimes.cbegin(); it != m_serialisationTimes.cend(); ++it) {
+        metrics[it.key()] = it.value().toJson();
+    }
+    if (reset) {
+        m_serialisationTimes.clear();
+    }
+    return metrics;
+}
+
+void TCPConnectionHub::onNewConnection()
+{
+    while (m_server->hasPendingConnections()) {
+        QTcpSocket* socket = m_server->nextPendingConnection();
+        connect(socket, &QTcpSocket::disconnected, this, &TCPConnectionHub::onDisconnected);
+        addConnection(socket, socket->peerAddress().toString());
+    }
+}
+
+void TCPConnectionHub::onNewLocalConnection()
+{
+    while (m_localServer->hasPendingConnections()) {
+        QLocalSocket* socket = m_localServer->nextPendingConnection();
+        connect(socket, &QLocalSocket::disconnected, this, &TCPConnectionHub::onDisconnected);
+        addConnection(socket, "local:" + m_localServer->serverName());
+    }
+}
+
+void TCPConnectionHub::addConnection(QIODevice* socket, const QString& address)
+{
+    const quint32 client = m_nextClientId++;
+    connect(socket, &QIODevice::readyRead, this, &TCPConnectionHub::onReadyRead);
+    connect(socket, &QIODevice::bytesWritten, this, &TCPConnectionHub::onBytesWritten);
+
+    m_connections[client].socket = socket;
+    m_socketClients.insert(socket, client);
+    emit clientConnected(client, address);
+}
+
+void TCPConnectionHub::onDisconnected()
+{
+    QIODevice* socket = qobject_cast<QIODevice*>(sender());
+    if (!socket || !m_socketClients.contains(socket)) {
+        return;
+    }
+    const quint32 client = m_socketClients.take(socket);
+    m_connections.remove(client);
+    {
+        QMutexLocker locker(&m_queuedMutex);
+        m_queuedBytes.remove(client);
+    }
+    socket->deleteLater();
+    emit clientDisconnected(client);
+}
+
+void TCPConnectionHub::onReadyRead()
+{
+    QIODevice* socket = qobject_cast<QIODevice*>(sender());
+    if (!socket || !m_socketClients.contains(socket)) {
+        return;
+    }
+    const quint32 client = m_socketClients.value(socket);
+    Connection& connection = m_connections[client];
+    const QByteArray data = socket->readAll();
+    connection.bytesIn += static_cast<quint64>(data.size());
+    connection.framer.append(data);
+
+    QByteArray jsonData;
+    QString framingError;
+    while (true) {
+        const JsonMessageFramer::Result result = connection.framer.next(jsonData, framingError);
+        if (result == JsonMessageFramer::NeedMoreData) {
+            break;
+        }
+        if (result == JsonMessageFramer::FramingError) {
+            emit requestRejected(client, framingError);
+            continue;
+        }
+
+        bool parseSuccess;
+        const QJsonObject request = parseJsonMessage(jsonData, parseSuccess);
+        if (parseSuccess) {
+            applyFramingRequest(connection, request);
+            emit requestReceived(client, request, LatencyHistogram::nowMicroseconds());
+        } else {
+            emit requestRejected(client, "Invalid JSON format: " + QString::fromUtf8(jsonData.left(50)));
+        }
+    }
+}
+
+void TCPConnectionHub::applyFramingRequest(Connection& connection, const QJsonObject& request)
+{
+    // The framing has to switch before the next message in this buffer is cut, which
+    // is before TCPServer even sees the request; its handler only validates and answers
+    if (request["command"].toString() != "config.set_framing") {
+        return;
+    }
+    JsonMessageFramer::Framing framing = JsonMessageFramer::FramingBraces;
+    if (JsonMessageFramer::parseFraming(request["params"].toObject()["mode"].toString(), &framing)) {
+        connection.framer.setFraming(framing);
+    }
+}
+
+void TCPConnectionHub::onBytesWritten(qint64 bytes)
+{
+    QIODevice* socket = qobject_cast<QIODevice*>(sender());
+    if (!socket || !m_socketClients.contains(socket)) {
+        return;
+    }
+    const quint32 client = m_socketClients.value(socket);
+    qint64 remaining = 0;
+    {
+        QMutexLocker locker(&m_queuedMutex);
+        qint64& queued = m_queuedBytes[client];
+        queued = qMax<qint64>(0, queued - bytes);
+        remaining = queued;
+    }
+
+    // Drained far enough: release the coalesced events, oldest type first
+    Connection& connection = m_connections[client];
+    if (connection.coalesced.isEmpty() || remaining > connection.eventBacklogLimit / 2) {
+        return;
+    }
+    const QStringList order = connection.coalescedOrder;
+    connection.coalescedOrder.clear();
+    for (const QString& eventType : order) {
+        queueBytes(client, connection, connection.coalesced.take(eventType));
+        connection.eventsSent++;
+    }
+}
+
+void TCPConnectionHub::writeData(quint32 client, const QByteArray& data)
+{
+    const auto it = m_connections.find(client);
+    if (it == m_connections.end()) {
+        return;  // Disconnected since the message was queued
+    }
+    queueBytes(client, it.value(), data);
+}
+
+void TCPConnectionHub::writeEvent(quint32 client, const QString& eventType, const QByteArray& line)
+{
+    const auto it = m_connections.find(client);
+    if (it == m_connections.end()) {
+        return;
+    }
+    Connection& connection = it.value();
+    // While coalesced events wait, newer ones of any type queue up behind them so
+    // the client still sees events in order
+    if (connection.coalesced.isEmpty() && queuedBytes(client) <= connection.eventBacklogLimit) {
+        queueBytes(client, connection, line);
+        connection.eventsSent++;
+        return;
+    }
+    if (connection.policy == DropEvents) {
+        connection.eventsDropped++;
+        return;
+    }
+    if (connection.coalesced.contains(eventType)) {
+        connection.eventsCoalesced++;
+    } else {
+        connection.coalescedOrder.append(eventType);
+    }
+    connection.coalesced.insert(eventType, line);
+}
+
+void TCPConnectionHub::queueBytes(quint32 client, Connection& connection, const QByteArray& data)
+{
+    if (!isSocketConnected(connection.socket)) {
+        return;
+    }
+    qint64 queued = 0;
+    {
+        QMutexLocker locker(&m_queuedMutex);
+        queued = (m_queuedBytes[client] += data.size());
+    }
+    connection.peakQueuedBytes = qMax(connection.peakQueuedBytes, queued);
+    connection.bytesOut += static_cast<quint64>(data.size());
+    connection.socket->write(data);
+}
@@ -6,46 +6,62 @@
  */
 
 #include "tcpserver.h"
+#include "tcpconnectionhub.h"
 #include "atariemulator.h"
 #include "debuggerwidget.h"
 #include "mainwindow.h"
 #include "configurationprofile.h"
 #include "configurationprofilemanager.h"
 #include "disasm6502.h"
+#include "threadscheduling.h"
+#include "scenariocase.h"
 #include <QCoreApplication>
 #include <QDebug>
 #include <QEventLoop>
 #include <QJsonArray>
 #include <QJsonParseError>
 #include <QFileInfo>
+#include <QFile>
 #include <QDir>
 #include <QByteArray>
 #include <QBuffer>
 #include <QImageReader>
 #include <QDateTime>
+#include <QRegularExpression>
 #include <QThread>
+#include <QLoggingCategory>
+
+// Per-request tracing; enable with QT_LOGGING_RULES="fujisan.tcp.debug=true"
+Q_LOGGING_CATEGORY(lcTcpServer, "fujisan.tcp", QtInfoMsg)
 
 namespace {
 
-void waitForCharacterInjectionIdle(AtariEmulator* emu)
+void waitForCharacterInjectionIdle(AtariEmulator* emu, int maxMs = 30000)
 {
     if (!emu) {
         return;
     }
-    constexpr int kMaxMs = 30000;
-    for (int ms = 0; ms < kMaxMs && !emu->isCharacterInjectionIdle(); ++ms) {
+    for (int ms = 0; ms < maxMs && !emu->isCharacterInjectionIdle(); ++ms) {
         QThread::msleep(1);
         QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
     }
 }
 
+// Upper bound on commands in one batch request
+constexpr int kMaxBatchCommands = 4096;
+
+// Stop queueing stream packets for a client that has this much unsent data; it
+// resumes with a delta against the last packet it did get.
+constexpr qint64 kScreenStreamMaxBacklog = 2 * 1024 * 1024;
+
+// Ranges one client may keep diff bases for (at most 1 MB of full-space copies)
+constexpr int kMaxMemoryDiffRanges = 16;
+
 }  // namespace
 
 extern "C" {
     // Access to CPU registers for debug commands
     extern unsigned short CPU_regPC;
-    // Access to screen functions for screen capture
-    #include "../../src/screen.h"
     extern unsigned char CPU_regA;
     extern unsigned char CPU_regX;
     extern unsigned char CPU_regY;
@@ -61,20 +77,36 @@ extern "C" {
 
 TCPServer::TCPServer(AtariEmulator* emulator, MainWindow* mainWindow, QObject* parent)
     : QObject(parent)
-    , m_server(new QTcpServer(this))
+    , m_ioThread(new QThread())
+    , m_hub(new TCPConnectionHub())
     , m_emulator(emulator)
     , m_debugger(nullptr)
     , m_mainWindow(mainWindow)
     , m_port(8080)
     , m_isRunning(false)
-    , m_joystickStreamTimer(nullptr)
-    , m_lastJoy0State(0x0f ^ 0xff)  // Center position
-    , m_lastJoy1State(0x0f ^ 0xff)  // Center position
-    , m_lastTrig0(false)
-    , m_lastTrig1(false)
+    , m_screenshotEncoder(new ScreenshotEncoder(this))
 {
-    // Connect server signals
-    connect(m_server, &QTcpServer::newConnection, this, &TCPServer::onNewConnection);
+    // Socket I/O runs on its own thread; requests and connection changes come back queued
+    m_ioThread->setObjectName("TCPServerIO");
+    m_hub->moveToThread(m_ioThread);
+    connect(m_hub, &TCPConnectionHub::clientConnected, this, &TCPServer::onClientConnected);
+    connect(m_hub, &TCPConnectionHub::clientDisconnected, this, &TCPServer::onClientDisconnected);
+    connect(m_hub, &TCPConnectionHub::requestReceived, this, &TCPServer::onRequestReceived);
+    connect(m_hub, &TCPConnectionHub::requestRejected, this, &TCPServer::onRequestRejected);
+    m_ioThread->start();
+    connect(m_screenshotEncoder, &ScreenshotEncoder::finished, this, &TCPServer::onScreenshotEncoded);
+    
+    if (m_emulator) {
+        connect(m_emulator, &AtariEmulator::stateSaved, this, &TCPServer::onStateSaved);
+        connect(m_emulator, &AtariEmulator::stateLoaded, this, &TCPServer::onStateLoaded);
+        connect(m_emulator, &AtariEmulator::runToFinished, this, &TCPServer::onRunToFinished);
+        connect(m_emulator, &AtariEmulator::watchpointHit, this, &TCPServer::onWatchpointHit);
+        connect(m_emulator, &AtariEmulator::screenStreamFrameReady, this, &TCPServer::onScreenStreamFrameReady);
+        connect(m_emulator, &AtariEmulator::scheduledActionExecuted, this, &TCPServer::onScheduledActionExecuted);
+        connect(m_emulator, &AtariEmulator::joystickInputChanged, this, &TCPServer::onJoystickInputChanged);
+        connect(m_emulator, &AtariEmulator::consoleInputChanged, this, &TCPServer::onConsoleInputChanged);
+        connect(m_emulator, &AtariEmulator::screenTextChanged, this, &TCPServer::onScreenTextChanged);
+    }
     
     qDebug() << "[TCP] Server initialized - ready to start on port" << m_port;
 }
@@ -82,6 +114,10 @@ TCPServer::TCPServer(AtariEmulator* emulator, MainWindow* mainWindow, QObject* p
 TCPServer::~TCPServer()
 {
     stopServer();
+    m_ioThread->quit();
+    m_ioThread->wait();
+    delete m_hub;
+    delete m_ioThread;
 }
 
 bool TCPServer::startServer(quint16 port)
@@ -91,43 +127,74 @@ bool TCPServer::startServer(quint16 port)
         return true;
     }
 
-    m_port = port;
-
-    // Listen only on localhost for security
-    if (!m_server->listen(QHostAddress::LocalHost, m_port)) {
-        qDebug() << "[TCP] Failed to start server on port" << m_port
-                 << "Error:" << m_server->errorString();
+    bool listening = false;
+    QMetaObject::invokeMethod(m_hub, "listen", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(bool, listening), Q_ARG(quint16, port));
+    if (!listening) {
         return false;
     }
 
     // listen(port==0) chooses an ephemeral port; keep m_port in sync for status.get_state etc.
-    m_port = m_server->serverPort();
+    QMetaObject::invokeMethod(m_hub, "serverPort", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(quint16, m_port));
 
     m_isRunning = true;
     qDebug() << "[TCP] Server started successfully on localhost:" << m_port;
     qDebug() << "[TCP] Clients can connect to: http://localhost:" << m_port;
+    startLocalListener();
     
     return true;
 }
 
+void TCPServer::setLocalServerName(const QString& name)
+{
+    m_localServerName = name;
+    if (m_isRunning) {
+        startLocalListener();
+    }
+}
+
+QString TCPServer::localServerPath() const
+{
+    return m_localServerPath;
+}
+
+void TCPServer::startLocalListener()
+{
+    m_localServerPath.clear();
+    if (m_localServerName.isEmpty()) {
+        QMetaObject::invokeMethod(m_hub, "closeLocal", Qt::BlockingQueuedConnection);
+        return;
+    }
+    // The TCP port keeps working if the local socket cannot be created
+    bool listening = false;
+    QMetaObject::invokeMethod(m_hub, "listenLocal", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(bool, listening), Q_ARG(QString, m_localServerName));
+    if (listening) {
+        QMetaObject::invokeMethod(m_hub, "localServerPath", Qt::BlockingQueuedConnection,
+                                  Q_RETURN_ARG(QString, m_localServerPath));
+        qDebug() << "[TCP] Local socket listening at" << m_localServerPath;
+    }
+}
+
 void TCPServer::stopServer()
 {
     if (!m_isRunning) {
         return;
     }
     
-    // Disconnect all clients
-    for (QTcpSocket* client : m_clients) {
-        client->disconnectFromHost();
-        if (client->state() != QAbstractSocket::UnconnectedState) {
-            client->waitForDisconnected(1000);
-        }
-    }
+    // Disconnect all clients and stop listening
+    QMetaObject::invokeMethod(m_hub, "close", Qt::BlockingQueuedConnection);
     m_clients.clear();
-    m_clientBuffers.clear();
-    
-    // Stop server
-    m_server->close();
+    m_memoryDiffBases.clear();
+    m_eventSubscriptions.clear();
+    m_screenStreamClients.clear();
+    updateScreenStreamInterval();
+    m_joystickStreamClients.clear();
+    updateInputChangeReporting();
+    m_screenTextClients.clear();
+    updateScreenTextEvents();
+    m_localServerPath.clear();
     m_isRunning = false;
 
     qDebug() << "[TCP] Server stopped";
@@ -154,206 +221,96 @@ void TCPServer::setDebuggerWidget(DebuggerWidget* debugger)
     qDebug() << "[TCP] Debugger widget" << (debugger ? "connected" : "disconnected");
 }
 
-void TCPServer::onNewConnection()
+void TCPServer::onClientConnected(quint32 client, const QString& address)
 {
-    while (m_server->hasPendingConnections()) {
-        QTcpSocket* client = m_server->nextPendingConnection();
-        
-        // Set up client connection
-        connect(client, &QTcpSocket::disconnected, this, &TCPServer::onClientDisconnected);
-        connect(client, &QTcpSocket::readyRead, this, &TCPServer::onClientDataReady);
-        
-        m_clients.append(client);
-        m_clientBuffers[client] = QByteArray();
-        
-        QString clientAddress = client->peerAddress().toString();
-        qDebug() << "[TCP] New client connected from" << clientAddress
-                 << "Total clients:" << m_clients.count();
-        
-        // Send welcome message
-        QJsonObject welcomeData;
-        welcomeData["version"] = "1.0";
-        welcomeData["emulator"] = "Fujisan";
-        welcomeData["capabilities"] = QJsonArray{"media", "system", "input", "debug", "config", "status", "screen"};
-        sendEvent(client, "connected", welcomeData);
-    }
+    m_clients.append(client);
+    qDebug() << "[TCP] New client connected from" << address
+             << "Total clients:" << m_clients.count();
+    
+    // Send welcome message
+    QJsonObject welcomeData;
+    welcomeData["version"] = "1.0";
+    welcomeData["emulator"] = "Fujisan";
+    welcomeData["capabilities"] = QJsonArray{"media", "system", "input", "debug", "config", "status", "screen"};
+    sendEvent(client, "connected", welcomeData);
 }
 
-void TCPServer::onClientDisconnected()
+void TCPServer::onClientDisconnected(quint32 client)
 {
-    QTcpSocket* client = qobject_cast<QTcpSocket*>(sender());
-    if (!client) {
-        return;
+    if (!m_clients.removeOne(client)) {
+        return;  // Already dropped by stopServer()
     }
+    m_memoryDiffBases.remove(client);
+    m_eventSubscriptions.remove(client);
     
-    QString clientAddress = client->peerAddress().toString();
-    m_clients.removeAll(client);
-    m_clientBuffers.remove(client);
-    
+    if (m_screenStreamClients.remove(client)) {
+        updateScreenStreamInterval();
+    }
+
     // Remove from joystick streaming if subscribed
-    m_joystickStreamClients.remove(client);
-    if (m_joystickStreamClients.isEmpty() && m_joystickStreamTimer) {
-        m_joystickStreamTimer->stop();
+    if (m_joystickStreamClients.remove(client)) {
+        updateInputChangeReporting();
+    }
+    if (m_screenTextClients.remove(client)) {
+        updateScreenTextEvents();
+    }
+    if (m_performanceClients.remove(client)) {
+        updatePerformanceTimer();
     }
     
-    qDebug() << "[TCP] Client disconnected from" << clientAddress
-             << "Remaining clients:" << m_clients.count();
-    
-    client->deleteLater();
+    qDebug() << "[TCP] Client" << client << "disconnected. Remaining clients:" << m_clients.count();
 }
 
-void TCPServer::onClientDataReady()
+void TCPServer::onRequestReceived(quint32 client, const QJsonObject& request, qint64 receivedAt)
 {
-    QTcpSocket* client = qobject_cast<QTcpSocket*>(sender());
-    if (!client) {
-        return;
-    }
-
-    // Read all available data and append to client buffer
-    QByteArray newData = client->readAll();
-    m_clientBuffers[client].append(newData);
-
-    // Process complete JSON objects by tracking braces
-    QByteArray& buffer = m_clientBuffers[client];
-
-    while (!buffer.isEmpty()) {
-        // Skip whitespace at the beginning
-        int startPos = 0;
-        while (startPos < buffer.size() && (buffer[startPos] == ' ' || buffer[startPos] == '\t' ||
-               buffer[startPos] == '\r' || buffer[startPos] == '\n')) {
-            startPos++;
-        }
-
-        if (startPos >= buffer.size()) {
-            buffer.clear();
-            break;
-        }
-
-        // Check if we have a JSON object starting
-        if (buffer[startPos] != '{') {
-            // Invalid data - skip to next newline or clear buffer
-            int newlinePos = buffer.indexOf('\n', startPos);
-            if (newlinePos != -1) {
-                QByteArray invalidData = buffer.mid(startPos, newlinePos - startPos);
-                buffer.remove(0, newlinePos + 1);
-                sendResponse(client, QJsonValue(), false, QJsonValue(),
-                            "Invalid JSON format (expected '{' at start): " + QString::fromUtf8(invalidData.trimmed()));
-            } else {
-                buffer.clear();
-                sendResponse(client, QJsonValue(), false, QJsonValue(),
-                            "Invalid JSON format (expected '{' at start)");
-            }
-            continue;
-        }
-
-        // Find the complete JSON object by tracking brace depth
-        int braceCount = 0;
-        bool inString = false;
-        bool escapeNext = false;
-        int endPos = -1;
-
-        for (int i = startPos; i < buffer.size(); i++) {
-            char ch = buffer[i];
-
-            if (escapeNext) {
-                escapeNext = false;
-                continue;
-            }
-
-            if (ch == '\\' && inString) {
-                escapeNext = true;
-                continue;
-            }
-
-            if (ch == '"') {
-                inString = !inString;
-                continue;
-            }
-
-            if (!inString) {
-                if (ch == '{') {
-                    braceCount++;
-                } else if (ch == '}') {
-                    braceCount--;
-                    if (braceCount == 0) {
-                        endPos = i;
-                        break;
-                    }
-                }
-            }
-        }
-
-        // If we found a complete JSON object, process it
-        if (endPos != -1) {
-            QByteArray jsonData = buffer.mid(startPos, endPos - startPos + 1);
-            buffer.remove(0, endPos + 1);
-
-            // Parse and process JSON command
-            bool parseSuccess;
-            QJsonObject request = parseJsonMessage(jsonData, parseSuccess);
-
-            if (parseSuccess) {
-                processCommand(client, request);
-            } else {
-                // Send error response for invalid JSON
-                sendResponse(client, QJsonValue(), false, QJsonValue(),
-                            "Invalid JSON format: " + QString::fromUtf8(jsonData.left(50)));
-            }
-        } else {
-            // Incomplete JSON object - wait for more data
-            // But if buffer is getting too large, there might be an issue
-            if (buffer.size() > 1048576) {  // 1MB limit
-                buffer.clear();
-                sendResponse(client, QJsonValue(), false, QJsonValue(),
-                            "JSON message too large or incomplete (>1MB)");
-            }
-            break;
+    if (isClientConnected(client)) {
+        const QString command = request["command"].toString();
+        if (!command.isEmpty()) {
+            m_commandMetrics[command].queueWait.record(LatencyHistogram::nowMicroseconds() - receivedAt);
         }
+        processCommand(client, request);
     }
 }
 
-QJsonObject TCPServer::parseJsonMessage(const QByteArray& data, bool& success)
+void TCPServer::onRequestRejected(quint32 client, const QString& error)
 {
-    QJsonParseError error;
-    QJsonDocument doc = QJsonDocument::fromJson(data, &error);
-    
-    if (error.error != QJsonParseError::NoError) {
-        qDebug() << "TCP Server: JSON parse error:" << error.errorString();
-        success = false;
-        return QJsonObject();
-    }
-    
-    if (!doc.isObject()) {
-        qDebug() << "TCP Server: JSON is not an object";
-        success = false;
-        return QJsonObject();
+    sendResponse(client, QJsonValue(), false, QJsonValue(), error);
+}
+
+void TCPServer::processCommand(ClientId client, const QJsonObject& request)
+{
+    // Commands can nest (batches, or a request arriving while a handler waits in
+    // processEvents), so the current command is restored afterwards
+    const QString command = request["command"].toString();
+    const QString previousCommand = m_currentCommand;
+    m_currentCommand = command;
+    const qint64 start = LatencyHistogram::nowMicroseconds();
+    routeCommand(client, request);
+    if (!command.isEmpty()) {
+        m_commandMetrics[command].execution.record(LatencyHistogram::nowMicroseconds() - start);
     }
-    
-    success = true;
-    return doc.object();
+    m_currentCommand = previousCommand;
 }
 
-void TCPServer::processCommand(QTcpSocket* client, const QJsonObject& request)
+void TCPServer::routeCommand(ClientId client, const QJsonObject& request)
 {
-    qDebug() << "TCP Server: processCommand called with request:" << request;
+    qCDebug(lcTcpServer) << "processCommand called with request:" << request;
     
     // Extract command and validate request format
     QString command = request["command"].toString();
     QJsonValue requestId = request.contains("id") ? request["id"] : QJsonValue();
     
-    qDebug() << "TCP Server: Extracted command:" << command;
-    
     if (command.isEmpty()) {
-        qDebug() << "TCP Server: Command is empty!";
+        qCDebug(lcTcpServer) << "Command is empty!";
         sendResponse(client, requestId, false, QJsonValue(), 
                     "Missing or invalid 'command' field");
         return;
     }
     
-    // Update command statistics
-    m_commandStats[command]++;
-    
-    qDebug() << "TCP Server: Processing command:" << command;
+    if (command == "batch") {
+        handleBatch(client, request);
+        return;
+    }
     
     // Route command to appropriate handler
     QStringList parts = command.split('.');
@@ -366,10 +323,9 @@ void TCPServer::processCommand(QTcpSocket* client, const QJsonObject& request)
     QString category = parts[0];
     QString subCommand = parts[1];
     
-    qDebug() << "TCP Server: Routing command - category:" << category << "subCommand:" << subCommand;
+    qCDebug(lcTcpServer) << "Routing command - category:" << category << "subCommand:" << subCommand;
     
     if (category == "media") {
-        qDebug() << "TCP Server: Calling handleMediaCommand";
         handleMediaCommand(client, request, subCommand);
     } else if (category == "system") {
         handleSystemCommand(client, request, subCommand);
@@ -389,14 +345,352 @@ void TCPServer::processCommand(QTcpSocket* client, const QJsonObject& request)
     }
 }
 
-void TCPServer::sendResponse(QTcpSocket* client, const QJsonValue& requestId, bool success,
-                           const QJsonValue& result, const QString& error)
+void TCPServer::handleBatch(ClientId client, const QJsonObject& request)
 {
-    // Check if client is still connected before sending
-    if (!client || client->state() != QAbstractSocket::ConnectedState) {
+    QJsonValue requestId = request.contains("id") ? request["id"] : QJsonValue();
+    const QJsonObject params = request["params"].toObject();
+    const QJsonArray commands = params["commands"].toArray();
+    const bool stopOnError = params["stop_on_error"].toBool(false);
+
+    if (m_batchResponses) {
+        sendResponse(client, requestId, false, QJsonValue(), "Batches cannot be nested");
+        return;
+    }
+    if (commands.isEmpty() || commands.size() > kMaxBatchCommands) {
+        sendResponse(client, requestId, false, QJsonValue(),
+                    QString("'commands' must be an array of 1 to %1 requests").arg(kMaxBatchCommands));
+        return;
+    }
+
+    // Run every command between the same two emulated frames. Blocking calls into the
+    // emulator still go through, only the next frame waits for releaseFrames().
+    QMetaObject::invokeMethod(m_emulator, "holdFrames", emulatorCallType());
+    QJsonArray responses;
+    m_batchClient = client;
+    m_batchResponses = &responses;
+    int errors = 0;
+    for (const QJsonValue& value : commands) {
+        const QJsonObject command = value.toObject();
+        const QJsonValue commandId = command.contains("id") ? command["id"] : QJsonValue();
+        const int before = responses.size();
+        const QString name = command["command"].toString();
+        if (name == "batch") {
+            responses.append(buildResponse(commandId, false, QJsonValue(), "Batches cannot be nested"));
+        } else if (name == "config.set_framing" || name == "config.set_encoding") {
+            // Framing is switched by the I/O thread as it cuts top-level requests, and
+            // the encoding must not change under the batch's own response
+            responses.append(buildResponse(commandId, false, QJsonValue(),
+                                           name + " cannot run inside a batch"));
+        } else if (name == "input.send_text" && command["params"].toObject()["text"].toString().length() > 1) {
+            // Typing more than one character needs frames to pass between keys
+            responses.append(buildResponse(commandId, false, QJsonValue(),
+                                           "input.send_text with more than one character cannot run inside a batch"));
+        } else {
+            processCommand(client, command);
+        }
+        if (responses.size() == before) {
+            // Answered later on its own (state save/load, step_over, ...)
+            QJsonObject pending;
+            pending["type"] = "response";
+            pending["status"] = "pending";
+            if (!commandId.isNull()) {
+                pending["id"] = commandId;
+            }
+            responses.append(pending);
+        }
+        if (responses.last().toObject()["status"].toString() == "error") {
+            errors++;
+            if (stopOnError) {
+                break;
+            }
+        }
+    }
+    m_batchResponses = nullptr;
+    m_batchClient = 0;
+    QMetaObject::invokeMethod(m_emulator, "releaseFrames", emulatorCallType());
+
+    QJsonObject result;
+    result["responses"] = responses;
+    result["executed"] = responses.size();
+    result["errors"] = errors;
+    // The envelope succeeds even if commands failed; their own responses say which
+    sendResponse(client, requestId, true, result);
+}
+
+void TCPServer::onStateSaved(const QString& filename, bool success)
+{
+    const QList<PendingRequest> requests = m_pendingStateSaves.values(filename);
+    if (requests.isEmpty()) {
+        return;  // Saved from the GUI
+    }
+    m_pendingStateSaves.remove(filename);
+
+    const bool isQuick = requests.first().type == "quick";
+    for (const PendingRequest& request : requests) {
+        if (!isClientConnected(request.client)) {
+            continue;  // Client disconnected while the file was being written
+        }
+        if (success) {
+            QJsonObject result;
+            result["saved"] = true;
+            result[isQuick ? "quick_save_path" : "filename"] = filename;
+            sendResponse(request.client, request.requestId, true, result);
+        } else {
+            sendResponse(request.client, request.requestId, false, QJsonValue(),
+                        isQuick ? "Failed to save quick state" : "Failed to save state to file");
+        }
+    }
+
+    if (success) {
+        // Send event to all clients
+        QJsonObject eventData;
+        eventData["type"] = isQuick ? "quick" : "file";
+        eventData[isQuick ? "path" : "filename"] = filename;
+        sendEventToAllClients("state_saved", eventData);
+    }
+}
+
+void TCPServer::onStateLoaded(const QString& filename, bool success)
+{
+    const QList<PendingRequest> requests = m_pendingStateLoads.values(filename);
+    if (requests.isEmpty()) {
+        return;  // Loaded from the GUI
+    }
+    m_pendingStateLoads.remove(filename);
+
+    const bool isQuick = requests.first().type == "quick";
+    const QString profile = m_emulator->getCurrentProfileName();
+    for (const PendingRequest& request : requests) {
+        if (!isClientConnected(request.client)) {
+            continue;
+        }
+        if (success) {
+            QJsonObject result;
+            result["loaded"] = true;
+            result[isQuick ? "quick_save_path" : "filename"] = filename;
+            result["profile"] = profile;
+            sendResponse(request.client, request.requestId, true, result);
+        } else {
+            sendResponse(request.client, request.requestId, false, QJsonValue(),
+                        isQuick ? "Failed to load quick state or no quick save found"
+                                : "Failed to load state from file");
+        }
+    }
+
+    if (success) {
+        // Send event to all clients
+        QJsonObject eventData;
+        eventData["type"] = isQuick ? "quick" : "file";
+        eventData[isQuick ? "path" : "filename"] = filename;
+        eventData["profile"] = profile;
+        sendEventToAllClients("state_loaded", eventData);
+    }
+}
+
+void TCPServer::onRunToFinished(unsigned short pc, bool reachedTarget)
+{
+    const QList<PendingRequest> requests = m_pendingStepOvers;
+    m_pendingStepOvers.clear();
+    if (requests.isEmpty()) {
+        return;  // Stepped over from the debugger window
+    }
+
+    const QString pcText = QString("$%1").arg(pc, 4, 16, QChar('0')).toUpper();
+    for (const PendingRequest& request : requests) {
+        if (!isClientConnected(request.client)) {
+            continue;
+        }
+        QJsonObject result;
+        result["stepped"] = true;
+        result["pc"] = pcText;
+        result["step_over"] = true;
+        // False when a breakpoint inside the subroutine (or a pause) stopped it first
+        result["returned"] = reachedTarget;
+        sendResponse(request.client, request.requestId, true, result);
+    }
+
+    // Send event to all clients
+    QJsonObject eventData;
+    eventData["stepped"] = true;
+    eventData["pc"] = pcText;
+    eventData["step_over"] = true;
+    eventData["returned"] = reachedTarget;
+    sendEventToAllClients("debug_stepped", eventData);
+}
+
+void TCPServer::onWatchpointHit(unsigned short pc, unsigned short address, int access)
+{
+    QString accessText;
+    if (access & AccessTraceRing::AccessRead) {
+        accessText += 'r';
+    }
+    if (access & AccessTraceRing::AccessWrite) {
+        accessText += 'w';
+    }
+    if (access & AccessTraceRing::AccessExecute) {
+        accessText += 'x';
+    }
+
+    QJsonObject eventData;
+    eventData["pc"] = QString("$%1").arg(pc, 4, 16, QChar('0')).toUpper();
+    eventData["address"] = QString("$%1").arg(address, 4, 16, QChar('0')).toUpper();
+    eventData["access"] = accessText;
+    sendEventToAllClients("watchpoint_hit", eventData);
+}
+
+void TCPServer::onScheduledActionExecuted(int id, quint64 frame, const QString& type,
+                                          const QJsonObject& result)
+{
+    const ClientId owner = m_scheduledActionOwners.take(id);
+    if (!isClientConnected(owner)) {
+        return;  // Scheduled by a client that has since disconnected
+    }
+    QJsonObject eventData;
+    eventData["id"] = id;
+    eventData["frame"] = static_cast<qint64>(frame);
+    eventData["type"] = type;
+    eventData["result"] = result;
+    sendEvent(owner, "scheduled_action", eventData);
+}
+
+Qt::ConnectionType TCPServer::emulatorCallType() const
+{
+    // Blocking calls into the emulator worker; direct when it shares our thread (tests)
+    return m_emulator->thread() == QThread::currentThread() ? Qt::DirectConnection
+                                                            : Qt::BlockingQueuedConnection;
+}
+
+void TCPServer::onScreenStreamFrameReady()
+{
+    FrameExchange* exchange = m_emulator->screenStreamExchange();
+    if (!exchange->acquire() || m_screenStreamClients.isEmpty()) {
         return;
     }
+    const QImage& frame = exchange->frontBuffer();
+    const quint64 frameNumber = exchange->frontSequence();
+    m_lastStreamFrame = frameNumber;
+
+    // Audio of every frame since the last published one, read once for all subscribers
+    QByteArray pcm;
+    if (m_streamAudioBytesPerSample > 0) {
+        m_emulator->readStreamAudio(pcm);
+    }
+    const quint64 samples = static_cast<quint64>(pcm.size() / qMax(1, m_streamAudioBytesPerSample));
+    const qint64 now = LatencyHistogram::nowMicroseconds();
+
+    for (auto it = m_screenStreamClients.begin(); it != m_screenStreamClients.end(); ++it) {
+        ClientId client = it.key();
+        ScreenStreamSubscriber& subscriber = it.value();
+        applyStreamInput(subscriber, frameNumber);
+
+        const bool backlogged = m_hub->queuedBytes(client) > kScreenStreamMaxBacklog;
+        QByteArray packets;
+        if (subscriber.audio && samples > 0) {
+            // Sample indices keep counting across audio dropped for a full socket
+            if (!backlogged) {
+                ScreenStreamEncoder::appendAudio(packets, m_streamAudioFormat["sample_rate"].toInt(),
+                                                 m_streamAudioFormat["channels"].toInt(),
+                                                 m_streamAudioFormat["bits_per_sample"].toInt(),
+                                                 frameNumber, subscriber.audioSamples, pcm);
+            }
+            subscriber.audioSamples += samples;
+        }
+
+        // Rewinds move the frame number back; treat that as due
+        const quint64 interval = static_cast<quint64>(subscriber.interval * subscriber.session.frameSkip());
+        const bool due = !subscriber.started || frameNumber <= subscriber.lastFrame ||
+                         frameNumber - subscriber.lastFrame >= interval;
+        if (due && !backlogged) {
+            subscriber.encoder.encode(frame.constBits(), frame.width(), frame.height(), frame.bytesPerLine(),
+                                      frame.colorTable(), frameNumber, packets);
+            subscriber.lastFrame = frameNumber;
+            subscriber.started = true;
+            subscriber.session.frameSent(frameNumber, now);
+        }
+        if (!packets.isEmpty()) {
+            m_hub->sendData(client, packets);
+        }
+    }
+}
 
+void TCPServer::applyStreamInput(ScreenStreamSubscriber& subscriber, quint64 frame)
+{
+    for (const RemotePlaySession::InputPacket& packet : subscriber.session.takeDueInput(frame)) {
+        for (const RemotePlaySession::JoystickInput& joystick : packet.joysticks) {
+            m_emulator->setJoystickState(joystick.player, joystick.direction, joystick.fire);
+        }
+        for (int akeyCode : packet.keys) {
+            m_emulator->queueAKey(akeyCode);
+        }
+    }
+}
+
+void TCPServer::onScreenshotEncoded(quint64 ticket, const QByteArray& data, const QString& path,
+                                    const QString& error)
+{
+    const auto it = m_pendingCaptures.find(ticket);
+    if (it == m_pendingCaptures.end()) {
+        return;
+    }
+    const PendingCapture pending = it.value();
+    m_pendingCaptures.erase(it);
+    if (!error.isEmpty()) {
+        sendResponse(pending.client, pending.requestId, false, QJsonValue(), error);
+        return;
+    }
+
+    QJsonObject result;
+    if (!path.isEmpty()) {
+        result["filename"] = path;
+    }
+    result["format"] = ScreenshotEncoder::formatName(pending.format);
+    result["mime_type"] = ScreenshotEncoder::mimeType(pending.format);
+    result["frame"] = pending.frame;
+    result["timestamp"] = pending.timestamp;
+    result["size_bytes"] = data.size();
+    if (pending.inlineMode == "base64") {
+        result["data"] = QString::fromLatin1(data.toBase64());
+    } else if (pending.inlineMode == "binary") {
+        result["binary"] = true;  // size_bytes of image data follow this response
+    }
+    sendResponse(pending.client, pending.requestId, true, result);
+    if (pending.inlineMode == "binary" && isClientConnected(pending.client)) {
+        m_hub->sendData(pending.client, data);
+    }
+}
+
+void TCPServer::updateScreenStreamInterval()
+{
+    if (!m_emulator) {
+        return;
+    }
+    int interval = 0;
+    bool audio = false;
+    for (const ScreenStreamSubscriber& subscriber : m_screenStreamClients) {
+        interval = interval == 0 ? subscriber.interval : qMin(interval, subscriber.interval);
+        audio = audio || subscriber.audio;
+    }
+    m_emulator->setScreenStreamInterval(interval);
+
+    // Stream audio is tapped only while someone takes it; what is left in the
+    // ring from an earlier stream is thrown away before it starts again
+    if (audio && m_streamAudioFormat.isEmpty()) {
+        QByteArray stale;
+        m_emulator->readStreamAudio(stale);
+        m_streamAudioFormat = m_emulator->streamAudioFormat();
+        m_streamAudioBytesPerSample = m_streamAudioFormat["channels"].toInt() *
+                                      m_streamAudioFormat["bits_per_sample"].toInt() / 8;
+        m_emulator->setStreamAudio(true);
+    } else if (!audio && !m_streamAudioFormat.isEmpty()) {
+        m_emulator->setStreamAudio(false);
+        m_streamAudioFormat = QJsonObject();
+        m_streamAudioBytesPerSample = 0;
+    }
+}
+
+QJsonObject TCPServer::buildResponse(const QJsonValue& requestId, bool success, const QJsonValue& result,
+                                     const QString& error)
+{
     QJsonObject response;
     response["type"] = "response";
     response["status"] = success ? "success" : "error";
@@ -412,18 +706,31 @@ void TCPServer::sendResponse(QTcpSocket* client, const QJsonValue& requestId, bo
     if (!success && !error.isEmpty()) {
         response["error"] = error;
     }
+    return response;
+}
+
+void TCPServer::sendResponse(ClientId client, const QJsonValue& requestId, bool success,
+                           const QJsonValue& result, const QString& error)
+{
+    // Check if client is still connected before sending
+    if (!isClientConnected(client)) {
+        return;
+    }
 
-    // Send response as JSON + newline
-    QJsonDocument doc(response);
-    QByteArray data = doc.toJson(QJsonDocument::Compact) + "\n";
-    client->write(data);
-    client->flush();
+    const QJsonObject response = buildResponse(requestId, success, result, error);
+    if (m_batchResponses && client == m_batchClient) {
+        m_batchResponses->append(response);
+        return;
+    }
+
+    // Serialised and written as JSON + newline on the I/O thread
+    m_hub->sendMessage(client, response, m_currentCommand);
 }
 
-void TCPServer::sendEvent(QTcpSocket* client, const QString& eventType, const QJsonObject& data)
+void TCPServer::sendEvent(ClientId client, const QString& eventType, const QJsonObject& data)
 {
     // Check if client is still connected before sending
-    if (!client || client->state() != QAbstractSocket::ConnectedState) {
+    if (!isClientConnected(client)) {
         return;
     }
 
@@ -431,36 +738,45 @@ void TCPServer::sendEvent(QTcpSocket* client, const QString& eventType, const QJ
     event["type"] = "event";
     event["event"] = eventType;
     event["data"] = data;
-
-    QJsonDocument doc(event);
-    QByteArray eventData = doc.toJson(QJsonDocument::Compact) + "\n";
-    client->write(eventData);
-    client->flush();
+    m_hub->sendEvent(client, eventType, event);
 }
 
 void TCPServer::sendEventToAllClients(const QString& eventType, const QJsonObject& data)
 {
-    for (QTcpSocket* client : m_clients) {
-        if (client->state() == QAbstractSocket::ConnectedState) {
-            sendEvent(client, eventType, data);
+    // Clients without a subscription list get every event
+    QVector<ClientId> subscribers;
+    subscribers.reserve(m_clients.size());
+    for (ClientId client : m_clients) {
+        const auto subscription = m_eventSubscriptions.constFind(client);
+        if (subscription == m_eventSubscriptions.constEnd() || subscription.value().contains(eventType)) {
+            subscribers.append(client);
         }
     }
+    if (subscribers.isEmpty()) {
+        return;
+    }
+
+    QJsonObject event;
+    event["type"] = "event";
+    event["event"] = eventType;
+    event["data"] = data;
+    m_hub->broadcastEvent(subscribers, eventType, event);
 }
 
 QString TCPServer::validateAndNormalizePath(const QString& path)
 {
     if (path.isEmpty()) {
-        qDebug() << "TCP Server: validateAndNormalizePath - empty path";
+        qCDebug(lcTcpServer) << "validateAndNormalizePath - empty path";
         return QString();
     }
 
-    qDebug() << "TCP Server: validateAndNormalizePath - input path:" << path;
+    qCDebug(lcTcpServer) << "validateAndNormalizePath - input path:" << path;
 
     // First, try the path as-is
     QFileInfo fileInfo(path);
     if (fileInfo.exists()) {
         QString canonicalPath = fileInfo.canonicalFilePath();
-        qDebug() << "TCP Server: validateAndNormalizePath - path exists, canonical:" << canonicalPath;
+        qCDebug(lcTcpServer) << "validateAndNormalizePath - path exists, canonical:" << canonicalPath;
         return canonicalPath;
     }
 
@@ -471,42 +787,42 @@ QString TCPServer::validateAndNormalizePath(const QString& path)
         QFileInfo absoluteFileInfo(absolutePath);
         if (absoluteFileInfo.exists()) {
             QString canonicalPath = absoluteFileInfo.canonicalFilePath();
-            qDebug() << "TCP Server: validateAndNormalizePath - found with leading slash:" << canonicalPath;
+            qCDebug(lcTcpServer) << "validateAndNormalizePath - found with leading slash:" << canonicalPath;
             return canonicalPath;
         }
     }
 
-    qDebug() << "TCP Server: validateAndNormalizePath - file not found:" << path;
+    qCDebug(lcTcpServer) << "validateAndNormalizePath - file not found:" << path;
     return QString();
 }
 
 // Command handler stubs - to be implemented in the next steps
-void TCPServer::handleMediaCommand(QTcpSocket* client, const QJsonObject& request, const QString& subCommand)
+void TCPServer::handleMediaCommand(ClientId client, const QJsonObject& request, const QString& subCommand)
 {
     QJsonValue requestId = request.contains("id") ? request["id"] : QJsonValue();
     QJsonObject params = request["params"].toObject();
     
-    qDebug() << "TCP Server: handleMediaCommand called with subCommand:" << subCommand;
+    qCDebug(lcTcpServer) << "handleMediaCommand called with subCommand:" << subCommand;
     
     if (subCommand == "insert_disk") {
         // Insert disk into specified drive
         int drive = params["drive"].toInt();
         QString path = params["path"].toString();
         
-        qDebug() << "TCP Server: insert_disk - drive:" << drive << "path:" << path;
+        qCDebug(lcTcpServer) << "insert_disk - drive:" << drive << "path:" << path;
         
         if (drive < 1 || drive > 8) {
-            qDebug() << "TCP Server: Invalid drive number:" << drive;
+            qCWarning(lcTcpServer) << "Invalid drive number:" << drive;
             sendResponse(client, requestId, false, QJsonValue(), 
                         "Invalid drive number. Must be 1-8");
             return;
         }
         
-        qDebug() << "TCP Server: Skipping path validation for debugging";
+        qCDebug(lcTcpServer) << "Skipping path validation for debugging";
         QString validatedPath = path; // Temporarily skip validation
-        qDebug() << "TCP Server: Using path directly:" << validatedPath;
+        qCDebug(lcTcpServer) << "Using path directly:" << validatedPath;
         
-        qDebug() << "TCP Server: Attempting to insert disk via MainWindow:" << validatedPath;
+        qCDebug(lcTcpServer) << "Attempting to insert disk via MainWindow:" << validatedPath;
 
         if (!m_mainWindow) {
             sendResponse(client, requestId, false, QJsonValue(),
@@ -514,13 +830,18 @@ void TCPServer::handleMediaCommand(QTcpSocket* client, const QJsonObject& reques
             return;
         }
 
+        // "overlay" switches the drive's copy-on-write mode for this and later mounts
+        if (params.contains("overlay")) {
+            m_emulator->setDiskOverlayEnabled(drive, params["overlay"].toBool());
+        }
+
         // Use MainWindow's insertDiskViaTCP method to properly enable drive and update GUI
         bool success = false;
         try {
             success = m_mainWindow->insertDiskViaTCP(drive, validatedPath);
-            qDebug() << "TCP Server: insertDiskViaTCP returned:" << success;
+            qCDebug(lcTcpServer) << "insertDiskViaTCP returned:" << success;
         } catch (...) {
-            qDebug() << "TCP Server: Exception in insertDiskViaTCP";
+            qCWarning(lcTcpServer) << "Exception in insertDiskViaTCP";
             sendResponse(client, requestId, false, QJsonValue(), 
                         "Exception occurred while inserting disk");
             return;
@@ -531,6 +852,7 @@ void TCPServer::handleMediaCommand(QTcpSocket* client, const QJsonObject& reques
             result["drive"] = drive;
             result["path"] = validatedPath;
             result["mounted"] = true;
+            result["overlay"] = m_emulator->hasDiskOverlay(drive);
             sendResponse(client, requestId, true, result);
             
             // Send event to all clients
@@ -541,7 +863,7 @@ void TCPServer::handleMediaCommand(QTcpSocket* client, const QJsonObject& reques
             
             // Note: GUI signal emission handled automatically by DiskDriveWidget::insertDisk()
         } else {
-            qDebug() << "TCP Server: mountDiskImage failed for:" << validatedPath;
+            qCWarning(lcTcpServer) << "mountDiskImage failed for:" << validatedPath;
             sendResponse(client, requestId, false, QJsonValue(), 
                         "Failed to mount disk image: " + validatedPath);
         }
@@ -562,11 +884,23 @@ void TCPServer::handleMediaCommand(QTcpSocket* client, const QJsonObject& reques
             return;
         }
 
+        // An overlay is discarded on eject unless "commit" writes it back first
+        const bool commit = params["commit"].toBool(false);
+        if (commit) {
+            QString commitError;
+            if (!m_emulator->commitDiskOverlay(drive, &commitError)) {
+                sendResponse(client, requestId, false, QJsonValue(),
+                            "Failed to commit disk overlay: " + commitError);
+                return;
+            }
+        }
+
         bool success = m_mainWindow->ejectDiskViaTCP(drive);
         
         QJsonObject result;
         result["drive"] = drive;
         result["mounted"] = false;
+        result["committed"] = commit;
         sendResponse(client, requestId, true, result);
         
         // Send event to all clients
@@ -576,6 +910,43 @@ void TCPServer::handleMediaCommand(QTcpSocket* client, const QJsonObject& reques
         
         // Note: GUI signal emission handled automatically by DiskDriveWidget::ejectDisk()
         
+    } else if (subCommand == "get_disk_overlay") {
+        // Sectors the machine changed on a copy-on-write drive
+        int drive = params["drive"].toInt();
+        
+        if (drive < 1 || drive > 8) {
+            sendResponse(client, requestId, false, QJsonValue(), 
+                        "Invalid drive number. Must be 1-8");
+            return;
+        }
+        
+        QJsonObject result;
+        result["drive"] = drive;
+        result["enabled"] = m_emulator->isDiskOverlayEnabled(drive);
+        result["overlay"] = m_emulator->hasDiskOverlay(drive);
+        if (m_emulator->hasDiskOverlay(drive)) {
+            const QVector<int> sectors = m_emulator->diskOverlayChangedSectors(drive);
+            const bool includeData = params["include_data"].toBool(false);
+            QJsonArray sectorList;
+            QJsonArray sectorData;
+            for (int sector : sectors) {
+                sectorList.append(sector);
+                if (includeData) {
+                    QJsonObject entry;
+                    entry["sector"] = sector;
+                    entry["data"] = QString::fromLatin1(m_emulator->diskOverlaySector(drive, sector).toBase64());
+                    sectorData.append(entry);
+                }
+            }
+            result["path"] = m_emulator->getDiskImagePath(drive);
+            result["changed"] = m_emulator->diskOverlayChanged(drive);
+            result["changed_sectors"] = sectorList;
+            if (includeData) {
+                result["sector_data"] = sectorData;
+            }
+        }
+        sendResponse(client, requestId, true, result);
+        
     } else if (subCommand == "insert_cartridge") {
         // Insert cartridge
         QString path = params["path"].toString();
@@ -638,6 +1009,64 @@ void TCPServer::handleMediaCommand(QTcpSocket* client, const QJsonObject& reques
                         "Failed to eject cartridge");
         }
         
+    } else if (subCommand == "insert_cassette") {
+        // Insert a CAS tape; "boot" cold boots from it with START held
+        QString path = params["path"].toString();
+
+        if (!m_mainWindow) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "Main window not available");
+            return;
+        }
+
+        QString validatedPath = validateAndNormalizePath(path);
+        if (validatedPath.isEmpty()) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "File not found or invalid path: " + path);
+            return;
+        }
+
+        const bool readOnly = params["read_only"].toBool(false);
+        const bool bootTape = params["boot"].toBool(false);
+        if (m_mainWindow->insertCassetteViaTCP(validatedPath, readOnly, bootTape)) {
+            QJsonObject result;
+            result["path"] = validatedPath;
+            result["read_only"] = readOnly;
+            result["booted"] = bootTape;
+            sendResponse(client, requestId, true, result);
+
+            QJsonObject eventData;
+            eventData["path"] = validatedPath;
+            sendEventToAllClients("cassette_inserted", eventData);
+        } else {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "Failed to insert cassette: " + validatedPath);
+        }
+
+    } else if (subCommand == "eject_cassette") {
+        if (!m_mainWindow) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "Main window not available");
+            return;
+        }
+
+        m_mainWindow->ejectCassetteViaTCP();
+        QJsonObject result;
+        result["ejected"] = true;
+        sendResponse(client, requestId, true, result);
+        sendEventToAllClients("cassette_ejected", QJsonObject());
+
+    } else if (subCommand == "get_cassette") {
+        // Tape position and motor; "tape_acceleration" (optional bool) switches fast tape loading
+        if (params.contains("tape_acceleration")) {
+            m_emulator->setTapeAccelerationEnabled(params["tape_acceleration"].toBool());
+        }
+        QJsonObject result;
+        QMetaObject::invokeMethod(m_emulator, [this, &result]() {
+            result = m_emulator->getCassetteStatus();
+        }, emulatorCallType());
+        sendResponse(client, requestId, true, result);
+
     } else if (subCommand == "load_xex") {
         // Load XEX executable file
         QString path = params["path"].toString();
@@ -649,24 +1078,99 @@ void TCPServer::handleMediaCommand(QTcpSocket* client, const QJsonObject& reques
             return;
         }
         
-        // Use the generic loadFile method for XEX files
-        bool success = m_emulator->loadFile(validatedPath);
+        // "fast" writes the segments straight into RAM; anything it cannot take
+        // goes through BINLOAD and a coldstart unless "fallback" is false
+        QString method = "binload";
+        QString fastLoadError;
+        bool success = false;
+        if (params["fast"].toBool(false)) {
+            QFile file(validatedPath);
+            if (!file.open(QIODevice::ReadOnly)) {
+                sendResponse(client, requestId, false, QJsonValue(),
+                            "Cannot read XEX file: " + validatedPath);
+                return;
+            }
+            const QByteArray image = file.readAll();
+            QMetaObject::invokeMethod(m_emulator, [this, &image, &success, &fastLoadError]() {
+                success = m_emulator->fastLoadXex(image, &fastLoadError);
+            }, emulatorCallType());
+            if (success) {
+                method = "direct";
+            } else if (!params["fallback"].toBool(true)) {
+                sendResponse(client, requestId, false, QJsonValue(),
+                            "Fast load failed: " + fastLoadError);
+                return;
+            }
+        }
+        if (!success) {
+            // Use the generic loadFile method for XEX files
+            success = m_emulator->loadFile(validatedPath);
+        }
         
         if (success) {
             QJsonObject result;
             result["path"] = validatedPath;
             result["loaded"] = true;
+            result["method"] = method;
+            if (!fastLoadError.isEmpty()) {
+                result["fast_load_error"] = fastLoadError;
+            }
             sendResponse(client, requestId, true, result);
             
             // Send event to all clients
             QJsonObject eventData;
             eventData["path"] = validatedPath;
+            eventData["method"] = method;
             sendEventToAllClients("xex_loaded", eventData);
         } else {
             sendResponse(client, requestId, false, QJsonValue(), 
                         "Failed to load XEX file: " + validatedPath);
         }
         
+    } else if (subCommand == "load_basic") {
+        // Tokenized BASIC program (SAVE format) straight into BASIC's tables
+        QString path = params["path"].toString();
+        
+        QString validatedPath = validateAndNormalizePath(path);
+        if (validatedPath.isEmpty()) {
+            sendResponse(client, requestId, false, QJsonValue(), 
+                        "File not found or invalid path: " + path);
+            return;
+        }
+        QFile file(validatedPath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "Cannot read BASIC program: " + validatedPath);
+            return;
+        }
+        const QByteArray program = file.readAll();
+        
+        bool success = false;
+        QString loadError;
+        QMetaObject::invokeMethod(m_emulator, [this, &program, &success, &loadError]() {
+            success = m_emulator->fastLoadBasic(program, &loadError);
+        }, emulatorCallType());
+        if (!success) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "Failed to load BASIC program: " + loadError);
+            return;
+        }
+        const bool run = params["run"].toBool(false);
+        if (run) {
+            m_emulator->queueText("RUN\n");
+        }
+        
+        QJsonObject result;
+        result["path"] = validatedPath;
+        result["loaded"] = true;
+        result["length"] = program.size();
+        result["run"] = run;
+        sendResponse(client, requestId, true, result);
+        
+        QJsonObject eventData;
+        eventData["path"] = validatedPath;
+        sendEventToAllClients("basic_loaded", eventData);
+        
     } else if (subCommand == "enable_drive") {
         // Enable specified drive
         int drive = params["drive"].toInt();
@@ -731,7 +1235,7 @@ void TCPServer::handleMediaCommand(QTcpSocket* client, const QJsonObject& reques
     }
 }
 
-void TCPServer::handleSystemCommand(QTcpSocket* client, const QJsonObject& request, const QString& subCommand)
+void TCPServer::handleSystemCommand(ClientId client, const QJsonObject& request, const QString& subCommand)
 {
     QJsonValue requestId = request.contains("id") ? request["id"] : QJsonValue();
     QJsonObject params = request["params"].toObject();
@@ -928,6 +1432,11 @@ void TCPServer::handleSystemCommand(QTcpSocket* client, const QJsonObject& reque
         QJsonObject result;
         result["speed"] = currentSpeed;
         result["percentage"] = currentPercentage;
+        result["presentation_rate_hz"] = m_emulator->presentationRate();
+        result["paced_fps"] = m_emulator->pacedFps();
+        result["refresh_locked"] = m_emulator->isRefreshLocked();
+        result["skipped_presentations"] = static_cast<qint64>(m_emulator->skippedPresentations());
+        result["unchanged_frames"] = static_cast<qint64>(m_emulator->unchangedFrames());
         sendResponse(client, requestId, true, result);
 
     } else if (subCommand == "quick_save_state") {
@@ -938,48 +1447,311 @@ void TCPServer::handleSystemCommand(QTcpSocket* client, const QJsonObject& reque
             m_emulator->setCurrentProfileName(profileName);
         }
         
-        bool success = m_emulator->quickSaveState();
+        // Answered from onStateSaved() once the file is durable
+        const QString path = m_emulator->getQuickSaveStatePath();
+        m_pendingStateSaves.insert(path, {client, requestId, "quick"});
+        m_emulator->quickSaveState();
         
-        QJsonObject result;
-        result["saved"] = success;
-        result["quick_save_path"] = m_emulator->getQuickSaveStatePath();
-        
-        if (success) {
-            sendResponse(client, requestId, true, result);
-            
-            // Send event to all clients
-            QJsonObject eventData;
-            eventData["type"] = "quick";
-            eventData["path"] = m_emulator->getQuickSaveStatePath();
-            sendEventToAllClients("state_saved", eventData);
-        } else {
+    } else if (subCommand == "quick_load_state") {
+        // Quick load state; answered from onStateLoaded() once it has been applied
+        const QString path = m_emulator->getQuickSaveStatePath();
+        m_pendingStateLoads.insert(path, {client, requestId, "quick"});
+        if (!m_emulator->quickLoadState()) {
+            m_pendingStateLoads.remove(path);
             sendResponse(client, requestId, false, QJsonValue(), 
-                        "Failed to save quick state");
+                        "Failed to load quick state or no quick save found");
         }
         
-    } else if (subCommand == "quick_load_state") {
-        // Quick load state
-        bool success = m_emulator->quickLoadState();
+    } else if (subCommand == "rewind") {
+        // Restore an in-memory rewind snapshot: {"frames": N} goes back at least N
+        // emulated frames, {"steps": N} goes back N snapshots (default: 1 step)
+        if (!m_emulator->isRewindEnabled()) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "Rewind is not enabled (use system.configure_rewind)");
+            return;
+        }
         
-        QJsonObject result;
-        result["loaded"] = success;
-        result["quick_save_path"] = m_emulator->getQuickSaveStatePath();
+        bool success = false;
+        if (params.contains("frames")) {
+            int frames = params["frames"].toInt(-1);
+            if (frames < 0) {
+                sendResponse(client, requestId, false, QJsonValue(),
+                            "frames must be a non-negative integer");
+                return;
+            }
+            QMetaObject::invokeMethod(m_emulator, "rewindFrames", emulatorCallType(),
+                                      Q_RETURN_ARG(bool, success), Q_ARG(int, frames));
+        } else {
+            int steps = params["steps"].toInt(1);
+            if (steps < 0) {
+                sendResponse(client, requestId, false, QJsonValue(),
+                            "steps must be a non-negative integer");
+                return;
+            }
+            QMetaObject::invokeMethod(m_emulator, "rewindSteps", emulatorCallType(),
+                                      Q_RETURN_ARG(bool, success), Q_ARG(int, steps));
+        }
         
+        QJsonObject status;
+        QMetaObject::invokeMethod(m_emulator, "getRewindStatus", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, status));
         if (success) {
-            result["profile"] = m_emulator->getCurrentProfileName();
-            sendResponse(client, requestId, true, result);
+            status["rewound"] = true;
+            sendResponse(client, requestId, true, status);
             
-            // Send event to all clients
             QJsonObject eventData;
-            eventData["type"] = "quick";
-            eventData["path"] = m_emulator->getQuickSaveStatePath();
-            eventData["profile"] = m_emulator->getCurrentProfileName();
+            eventData["type"] = "rewind";
+            eventData["frame"] = status["current_frame"];
             sendEventToAllClients("state_loaded", eventData);
         } else {
-            sendResponse(client, requestId, false, QJsonValue(), 
-                        "Failed to load quick state or no quick save found");
+            sendResponse(client, requestId, false, status,
+                        "Not enough rewind history");
+        }
+        
+    } else if (subCommand == "configure_rewind") {
+        // Enable/disable rewind snapshots; with no params just reports the status
+        if (params.contains("enabled")) {
+            bool enabled = params["enabled"].toBool();
+            int interval = params["interval"].toInt(10);
+            int budgetMB = params["budget_mb"].toInt(32);
+            QMetaObject::invokeMethod(m_emulator, "configureRewind", emulatorCallType(),
+                                      Q_ARG(bool, enabled), Q_ARG(int, interval), Q_ARG(int, budgetMB));
+        }
+        
+        QJsonObject status;
+        QMetaObject::invokeMethod(m_emulator, "getRewindStatus", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, status));
+        sendResponse(client, requestId, true, status);
+        
+    } else if (subCommand == "configure_run_ahead") {
+        // Number of frames shown ahead of the real one (0 = off); without params
+        // just reports the status
+        if (params.contains("frames")) {
+            const int frames = params["frames"].toInt(-1);
+            if (frames < 0 || frames > AtariEmulator::kMaxRunAheadFrames) {
+                sendResponse(client, requestId, false, QJsonValue(),
+                            QString("frames must be between 0 and %1").arg(AtariEmulator::kMaxRunAheadFrames));
+                return;
+            }
+            m_emulator->setRunAheadFrames(frames);
+        }
+        sendResponse(client, requestId, true, m_emulator->getRunAheadStatus());
+
+    } else if (subCommand == "configure_scheduling") {
+        // Emulator thread priority, CPU pinning and precise frame timing; without
+        // params just reports what is in effect. Not persisted to the settings.
+        QJsonObject status;
+        if (params.contains("priority") || params.contains("cpu") || params.contains("precise_timing")) {
+            QMetaObject::invokeMethod(m_emulator, "threadSchedulingStatus", emulatorCallType(),
+                                      Q_RETURN_ARG(QJsonObject, status));
+            ThreadScheduling::Priority priority = ThreadScheduling::PriorityNormal;
+            const QString priorityName = params["priority"].toString(status["priority"].toString());
+            if (!ThreadScheduling::parsePriority(priorityName, &priority)) {
+                sendResponse(client, requestId, false, QJsonValue(),
+                            "priority must be one of: normal, high, realtime");
+                return;
+            }
+            const int cpu = params["cpu"].toInt(status["cpu"].toInt(-1));
+            if (cpu < -1 || cpu >= ThreadScheduling::cpuCount()) {
+                sendResponse(client, requestId, false, QJsonValue(),
+                            QString("cpu must be -1 (any) or between 0 and %1").arg(ThreadScheduling::cpuCount() - 1));
+                return;
+            }
+            const bool precise = params["precise_timing"].toBool(status["precise_timing"].toBool());
+            QMetaObject::invokeMethod(m_emulator, "setThreadScheduling", emulatorCallType(),
+                                      Q_RETURN_ARG(QJsonObject, status), Q_ARG(int, static_cast<int>(priority)),
+                                      Q_ARG(int, cpu), Q_ARG(bool, precise));
+        } else {
+            QMetaObject::invokeMethod(m_emulator, "threadSchedulingStatus", emulatorCallType(),
+                                      Q_RETURN_ARG(QJsonObject, status));
+        }
+        sendResponse(client, requestId, true, status);
+
+    } else if (subCommand == "schedule") {
+        // Queue an action to run right before the emulated frame counter passes
+        // "frame" (or "in_frames" from now); answered at once with its id, the
+        // "scheduled_action" event follows when it has run
+        const QString action = params["action"].toString();
+        const QJsonObject actionParams = params["params"].toObject();
+        QString actionError;
+        if (!ScenarioCase::validateAction(action, actionParams, &actionError)) {
+            sendResponse(client, requestId, false, QJsonValue(), actionError);
+            return;
+        }
+        
+        quint64 currentFrame = 0;
+        QMetaObject::invokeMethod(m_emulator, "getCurrentFrame", emulatorCallType(),
+                                  Q_RETURN_ARG(quint64, currentFrame));
+        quint64 frame = 0;
+        if (params.contains("frame")) {
+            const qint64 requested = static_cast<qint64>(params["frame"].toDouble(-1));
+            if (requested < 0) {
+                sendResponse(client, requestId, false, QJsonValue(),
+                            "frame must be a non-negative integer");
+                return;
+            }
+            frame = static_cast<quint64>(requested);
+        } else if (params.contains("in_frames")) {
+            const int inFrames = params["in_frames"].toInt(-1);
+            if (inFrames < 0) {
+                sendResponse(client, requestId, false, QJsonValue(),
+                            "in_frames must be a non-negative integer");
+                return;
+            }
+            frame = currentFrame + static_cast<quint64>(inFrames);
+        } else {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "frame or in_frames parameter is required");
+            return;
+        }
+        
+        QJsonObject storedParams = actionParams;
+        if (action == "save_state") {
+            QString filename = storedParams["filename"].toString();
+            if (!filename.endsWith(".a8s", Qt::CaseInsensitive)) {
+                filename += ".a8s";
+            }
+            storedParams["filename"] = filename;
         }
         
+        int id = 0;
+        QMetaObject::invokeMethod(m_emulator, "scheduleAction", emulatorCallType(),
+                                  Q_RETURN_ARG(int, id), Q_ARG(quint64, frame),
+                                  Q_ARG(QString, action), Q_ARG(QJsonObject, storedParams));
+        m_scheduledActionOwners.insert(id, client);
+        
+        QJsonObject result;
+        result["id"] = id;
+        result["frame"] = static_cast<qint64>(frame);
+        result["current_frame"] = static_cast<qint64>(currentFrame);
+        sendResponse(client, requestId, true, result);
+        
+    } else if (subCommand == "list_scheduled") {
+        QJsonArray actions;
+        QMetaObject::invokeMethod(m_emulator, "getScheduledActions", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonArray, actions));
+        quint64 currentFrame = 0;
+        QMetaObject::invokeMethod(m_emulator, "getCurrentFrame", emulatorCallType(),
+                                  Q_RETURN_ARG(quint64, currentFrame));
+        QJsonObject result;
+        result["actions"] = actions;
+        result["current_frame"] = static_cast<qint64>(currentFrame);
+        sendResponse(client, requestId, true, result);
+        
+    } else if (subCommand == "cancel_scheduled") {
+        const int id = params["id"].toInt(0);
+        bool cancelled = false;
+        QMetaObject::invokeMethod(m_emulator, "cancelScheduledAction", emulatorCallType(),
+                                  Q_RETURN_ARG(bool, cancelled), Q_ARG(int, id));
+        if (!cancelled) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        QString("No scheduled action with id %1").arg(id));
+            return;
+        }
+        m_scheduledActionOwners.remove(id);
+        QJsonObject result;
+        result["id"] = id;
+        result["cancelled"] = true;
+        sendResponse(client, requestId, true, result);
+        
+    } else if (subCommand == "clear_scheduled") {
+        QMetaObject::invokeMethod(m_emulator, "clearScheduledActions", emulatorCallType());
+        m_scheduledActionOwners.clear();
+        QJsonObject result;
+        result["cleared"] = true;
+        sendResponse(client, requestId, true, result);
+        
+    } else if (subCommand == "open_shared_state") {
+        // Memory-mapped state for harnesses on this host; see SharedStateRegion for the layout
+        const QString name = params["name"].toString(
+            QString("fujisan-state-%1").arg(QCoreApplication::applicationPid()));
+        if (!QRegularExpression("^[A-Za-z0-9_.-]{1,64}$").match(name).hasMatch() || name.startsWith('.')) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "Invalid name: use up to 64 letters, digits, '_', '-' or '.'");
+            return;
+        }
+        const QJsonArray ranges = params["ranges"].toArray();
+        QJsonObject layout;
+        QMetaObject::invokeMethod(m_emulator, "openSharedState", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, layout),
+                                  Q_ARG(QString, SharedStateRegion::pathForName(name)),
+                                  Q_ARG(QJsonArray, ranges));
+        if (layout.contains("error")) {
+            sendResponse(client, requestId, false, QJsonValue(), layout["error"].toString());
+            return;
+        }
+        sendResponse(client, requestId, true, layout);
+        
+    } else if (subCommand == "close_shared_state") {
+        QMetaObject::invokeMethod(m_emulator, "closeSharedState", emulatorCallType());
+        QJsonObject result;
+        result["closed"] = true;
+        sendResponse(client, requestId, true, result);
+        
+    } else if (subCommand == "movie_record_start") {
+        // Snapshot the machine and record every frame's input to an input movie
+        QString path = params["path"].toString();
+        if (path.isEmpty()) {
+            path = QString("movie_%1.fjm").arg(QDateTime::currentMSecsSinceEpoch());
+        }
+        QFileInfo fileInfo(path);
+        if (fileInfo.isRelative()) {
+            path = QDir::currentPath() + "/" + path;
+        }
+        const int verifyInterval = params["verify_interval"].toInt(InputMovie::kDefaultVerifyInterval);
+        if (verifyInterval < 0) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "verify_interval must be a non-negative integer");
+            return;
+        }
+        QJsonObject result;
+        QMetaObject::invokeMethod(m_emulator, "startMovieRecording", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, result), Q_ARG(QString, path),
+                                  Q_ARG(int, verifyInterval));
+        if (result.contains("error")) {
+            sendResponse(client, requestId, false, QJsonValue(), result["error"].toString());
+            return;
+        }
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "movie_record_stop") {
+        QJsonObject result;
+        QMetaObject::invokeMethod(m_emulator, "stopMovieRecording", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, result));
+        if (result.contains("error")) {
+            sendResponse(client, requestId, false, result, result["error"].toString());
+            return;
+        }
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "movie_status") {
+        QJsonObject result;
+        QMetaObject::invokeMethod(m_emulator, "movieStatus", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, result));
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "movie_play") {
+        // Replay a movie unpaced from its snapshot and verify its checksums
+        QString path = params["path"].toString();
+        if (path.isEmpty()) {
+            sendResponse(client, requestId, false, QJsonValue(), "Missing required parameter: path");
+            return;
+        }
+        QFileInfo fileInfo(path);
+        if (fileInfo.isRelative()) {
+            path = QDir::currentPath() + "/" + path;
+        }
+        const bool stopOnMismatch = params["stop_on_mismatch"].toBool(true);
+        QJsonObject result;
+        QMetaObject::invokeMethod(m_emulator, "playMovie", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, result), Q_ARG(QString, path),
+                                  Q_ARG(bool, stopOnMismatch));
+        if (result.contains("error")) {
+            sendResponse(client, requestId, false, QJsonValue(), result["error"].toString());
+            return;
+        }
+        sendResponse(client, requestId, true, result);
+
     } else if (subCommand == "save_state") {
         // Save state to specified file
         QString filename = params["filename"].toString();
@@ -1001,24 +1773,9 @@ void TCPServer::handleSystemCommand(QTcpSocket* client, const QJsonObject& reque
             m_emulator->setCurrentProfileName(profileName);
         }
         
-        bool success = m_emulator->saveState(filename);
-        
-        QJsonObject result;
-        result["saved"] = success;
-        result["filename"] = filename;
-        
-        if (success) {
-            sendResponse(client, requestId, true, result);
-            
-            // Send event to all clients
-            QJsonObject eventData;
-            eventData["type"] = "file";
-            eventData["filename"] = filename;
-            sendEventToAllClients("state_saved", eventData);
-        } else {
-            sendResponse(client, requestId, false, QJsonValue(), 
-                        "Failed to save state to file");
-        }
+        // Answered from onStateSaved() once the file is durable
+        m_pendingStateSaves.insert(filename, {client, requestId, "file"});
+        m_emulator->saveStateAsync(filename);
         
     } else if (subCommand == "load_state") {
         // Load state from specified file
@@ -1026,38 +1783,27 @@ void TCPServer::handleSystemCommand(QTcpSocket* client, const QJsonObject& reque
         
         if (filename.isEmpty()) {
             sendResponse(client, requestId, false, QJsonValue(), 
-                        "Filename parameter is required");
-            return;
-        }
-        
-        bool success = m_emulator->loadState(filename);
-        
-        QJsonObject result;
-        result["loaded"] = success;
-        result["filename"] = filename;
-        
-        if (success) {
-            result["profile"] = m_emulator->getCurrentProfileName();
-            sendResponse(client, requestId, true, result);
-            
-            // Send event to all clients
-            QJsonObject eventData;
-            eventData["type"] = "file";
-            eventData["filename"] = filename;
-            eventData["profile"] = m_emulator->getCurrentProfileName();
-            sendEventToAllClients("state_loaded", eventData);
-        } else {
-            sendResponse(client, requestId, false, QJsonValue(), 
+                        "Filename parameter is required");
+            return;
+        }
+        
+        if (!QFileInfo::exists(filename)) {
+            sendResponse(client, requestId, false, QJsonValue(), 
                         "Failed to load state from file");
+            return;
         }
         
+        // Answered from onStateLoaded() once the state has been applied
+        m_pendingStateLoads.insert(filename, {client, requestId, "file"});
+        m_emulator->loadStateAsync(filename);
+        
     } else {
         sendResponse(client, requestId, false, QJsonValue(), 
                     "Unknown system command: " + subCommand);
     }
 }
 
-void TCPServer::handleInputCommand(QTcpSocket* client, const QJsonObject& request, const QString& subCommand)
+void TCPServer::handleInputCommand(ClientId client, const QJsonObject& request, const QString& subCommand)
 {
     QJsonValue requestId = request.contains("id") ? request["id"] : QJsonValue();
     QJsonObject params = request["params"].toObject();
@@ -1072,16 +1818,16 @@ void TCPServer::handleInputCommand(QTcpSocket* client, const QJsonObject& reques
             return;
         }
         
-        // Inject each character using the emulator's character injection
-        for (int i = 0; i < text.length(); ++i) {
-            waitForCharacterInjectionIdle(m_emulator);
-            QChar ch = text.at(i);
-            m_emulator->injectCharacter(ch.toLatin1());
-        }
+        // The emulator types the text from its own frame loop; answer once the
+        // last key is in. "turbo" runs at host speed meanwhile.
+        const bool turbo = params["turbo"].toBool(false);
+        waitForCharacterInjectionIdle(m_emulator);
+        m_emulator->queueText(text.toLatin1(), turbo);
+        waitForCharacterInjectionIdle(m_emulator, 30000 + 200 * text.length());
         
         QJsonObject result;
         result["text"] = text;
-        result["characters_sent"] = text.length();
+        result["characters_sent"] = text.length() - m_emulator->queuedKeyCount();
         sendResponse(client, requestId, true, result);
         
     } else if (subCommand == "send_key") {
@@ -1373,39 +2119,27 @@ void TCPServer::handleInputCommand(QTcpSocket* client, const QJsonObject& reques
         sendResponse(client, requestId, true, result);
         
     } else if (subCommand == "start_joystick_stream") {
-        // Subscribe to joystick state changes
-        int rate = params["rate"].toInt(60);  // Default 60Hz
-        rate = qBound(10, rate, 120);  // Limit to 10-120Hz
-        
-        if (!m_joystickStreamTimer) {
-            m_joystickStreamTimer = new QTimer(this);
-            connect(m_joystickStreamTimer, &QTimer::timeout, this, &TCPServer::streamJoystickStates);
-        }
-        
+        // Subscribe to joystick and console key changes. The emulator reports them for
+        // the frame they take effect, so the old polling rate is only echoed back.
+        int rate = params["rate"].toInt(60);
+        rate = qBound(10, rate, 120);
+
         m_joystickStreamClients.insert(client);
-        
-        if (!m_joystickStreamTimer->isActive()) {
-            int interval = 1000 / rate;  // Convert Hz to milliseconds
-            m_joystickStreamTimer->start(interval);
-            
-            // Initialize last known states
-            m_lastJoy0State = m_emulator->getJoystickState(1);
-            m_lastJoy1State = m_emulator->getJoystickState(2);
-            m_lastTrig0 = m_emulator->getJoystickFire(1);
-            m_lastTrig1 = m_emulator->getJoystickFire(2);
-        }
-        
+        updateInputChangeReporting();
+
+        quint64 currentFrame = 0;
+        QMetaObject::invokeMethod(m_emulator, "getCurrentFrame", emulatorCallType(),
+                                  Q_RETURN_ARG(quint64, currentFrame));
         QJsonObject result;
         result["streaming"] = true;
         result["rate"] = rate;
+        result["current_frame"] = static_cast<qint64>(currentFrame);
         sendResponse(client, requestId, true, result);
         
     } else if (subCommand == "stop_joystick_stream") {
         // Unsubscribe from joystick state changes
-        m_joystickStreamClients.remove(client);
-        
-        if (m_joystickStreamClients.isEmpty() && m_joystickStreamTimer) {
-            m_joystickStreamTimer->stop();
+        if (m_joystickStreamClients.remove(client)) {
+            updateInputChangeReporting();
         }
         
         QJsonObject result;
@@ -1419,9 +2153,7 @@ void TCPServer::handleInputCommand(QTcpSocket* client, const QJsonObject& reques
         QJsonObject result;
         result["streaming"] = isStreaming;
         result["total_streaming_clients"] = m_joystickStreamClients.size();
-        if (m_joystickStreamTimer && m_joystickStreamTimer->isActive()) {
-            result["stream_rate"] = 1000 / m_joystickStreamTimer->interval();
-        }
+        result["mode"] = "per_frame";
         
         sendResponse(client, requestId, true, result);
         
@@ -1456,11 +2188,15 @@ void TCPServer::handleInputCommand(QTcpSocket* client, const QJsonObject& reques
     }
 }
 
-void TCPServer::handleDebugCommand(QTcpSocket* client, const QJsonObject& request, const QString& subCommand)
+void TCPServer::handleDebugCommand(ClientId client, const QJsonObject& request, const QString& subCommand)
 {
     QJsonValue requestId = request.contains("id") ? request["id"] : QJsonValue();
     QJsonObject params = request["params"].toObject();
     
+    if (!m_debugger && m_mainWindow) {
+        // The dock is built on first use; it does not have to be shown
+        m_mainWindow->ensureDebugger();
+    }
     if (!m_debugger) {
         sendResponse(client, requestId, false, QJsonValue(), 
                     "Debugger not available. Enable debugger window first.");
@@ -1525,7 +2261,15 @@ void TCPServer::handleDebugCommand(QTcpSocket* client, const QJsonObject& reques
             return;
         }
         
-        MEMORY_mem[address] = (unsigned char)value;
+        // On the emulator thread, like write_memory_block, which ends a movie recording
+        bool written = false;
+        QMetaObject::invokeMethod(m_emulator, "writeMemoryBlock", emulatorCallType(),
+                                  Q_RETURN_ARG(bool, written), Q_ARG(int, 0), Q_ARG(int, address),
+                                  Q_ARG(QByteArray, QByteArray(1, static_cast<char>(value))));
+        if (!written) {
+            sendResponse(client, requestId, false, QJsonValue(), "Emulator not initialized");
+            return;
+        }
         
         QJsonObject result;
         result["address"] = QString("$%1").arg(address, 4, 16, QChar('0')).toUpper();
@@ -1534,6 +2278,194 @@ void TCPServer::handleDebugCommand(QTcpSocket* client, const QJsonObject& reques
         
         sendResponse(client, requestId, true, result);
         
+    } else if (subCommand == "read_memory_block") {
+        // Bulk read of up to the whole address space (bank 0) or one 16 KB XE bank,
+        // as base64 or as raw bytes right after the response line. "diff" returns only
+        // the bytes that changed since this client's last diff read of the same range.
+        const int bank = params["bank"].toInt(0);
+        const int address = params["address"].toInt(0);
+        const int bankSize = bank == 0 ? 0x10000 : 0x4000;
+        const int length = params["length"].toInt(bankSize - address);
+        const QString encoding = params["encoding"].toString("base64");
+        const bool diff = params["diff"].toBool(false);
+        
+        if (encoding != "base64" && encoding != "binary") {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "encoding must be \"base64\" or \"binary\"");
+            return;
+        }
+        if (encoding == "binary" && (diff || client == m_batchClient)) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "binary encoding is not available in diff mode or inside a batch");
+            return;
+        }
+        if (address < 0 || length < 1 || address + length > bankSize) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        QString("Invalid memory range; bank %1 covers 0-%2").arg(bank).arg(bankSize - 1));
+            return;
+        }
+        
+        QByteArray block;
+        QMetaObject::invokeMethod(m_emulator, "readMemoryBlock", emulatorCallType(),
+                                  Q_RETURN_ARG(QByteArray, block), Q_ARG(int, bank),
+                                  Q_ARG(int, address), Q_ARG(int, length));
+        if (block.size() != length) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        QString("Memory bank %1 does not exist").arg(bank));
+            return;
+        }
+        
+        QJsonObject result;
+        result["bank"] = bank;
+        result["address"] = QString("$%1").arg(address, 4, 16, QChar('0')).toUpper();
+        result["length"] = length;
+        result["encoding"] = encoding;
+        
+        if (diff) {
+            QHash<QString, QByteArray>& bases = m_memoryDiffBases[client];
+            const QString key = QString("%1:%2:%3").arg(bank).arg(address).arg(length);
+            auto base = bases.find(key);
+            if (base == bases.end()) {
+                if (bases.size() >= kMaxMemoryDiffRanges) {
+                    bases.clear();  // Start over rather than track ranges without bound
+                }
+                result["full"] = true;
+                result["data"] = QString::fromLatin1(block.toBase64());
+                bases.insert(key, block);
+            } else {
+                // Changed runs, merging neighbours closer than a run's JSON overhead
+                const QByteArray& previous = base.value();
+                QJsonArray changes;
+                int changedBytes = 0;
+                int i = 0;
+                while (i < length) {
+                    if (block.at(i) == previous.at(i)) {
+                        ++i;
+                        continue;
+                    }
+                    const int start = i;
+                    int end = i + 1;
+                    for (int gap = 0; i < length && gap < 16; ++i) {
+                        if (block.at(i) != previous.at(i)) {
+                            changedBytes++;
+                            end = i + 1;
+                            gap = 0;
+                        } else {
+                            gap++;
+                        }
+                    }
+                    QJsonObject change;
+                    change["offset"] = start;
+                    change["data"] = QString::fromLatin1(block.mid(start, end - start).toBase64());
+                    changes.append(change);
+                    i = end;
+                }
+                result["full"] = false;
+                result["changes"] = changes;
+                result["changed_bytes"] = changedBytes;
+                base.value() = block;
+            }
+            sendResponse(client, requestId, true, result);
+        } else if (encoding == "binary") {
+            sendResponse(client, requestId, true, result);
+            m_hub->sendData(client, block);
+        } else {
+            result["data"] = QString::fromLatin1(block.toBase64());
+            sendResponse(client, requestId, true, result);
+        }
+        
+    } else if (subCommand == "write_memory_block") {
+        // Bulk write of base64 data into the address space (bank 0) or an XE bank
+        const int bank = params["bank"].toInt(0);
+        const int address = params["address"].toInt(-1);
+        const QByteArray data = QByteArray::fromBase64(params["data"].toString().toLatin1());
+        const int bankSize = bank == 0 ? 0x10000 : 0x4000;
+        
+        if (data.isEmpty() || address < 0 || address + data.size() > bankSize) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        QString("Invalid memory range or empty data; bank %1 covers 0-%2")
+                            .arg(bank).arg(bankSize - 1));
+            return;
+        }
+        
+        bool written = false;
+        QMetaObject::invokeMethod(m_emulator, "writeMemoryBlock", emulatorCallType(),
+                                  Q_RETURN_ARG(bool, written), Q_ARG(int, bank),
+                                  Q_ARG(int, address), Q_ARG(QByteArray, data));
+        if (!written) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        QString("Memory bank %1 does not exist").arg(bank));
+            return;
+        }
+        
+        QJsonObject result;
+        result["bank"] = bank;
+        result["address"] = QString("$%1").arg(address, 4, 16, QChar('0')).toUpper();
+        result["length"] = data.size();
+        result["written"] = true;
+        sendResponse(client, requestId, true, result);
+        
+    } else if (subCommand == "get_memory_banks") {
+        int banks = 0;
+        QMetaObject::invokeMethod(m_emulator, "extendedBankCount", emulatorCallType(),
+                                  Q_RETURN_ARG(int, banks));
+        QJsonObject result;
+        result["extended_banks"] = banks;
+        result["bank_size"] = 0x4000;
+        sendResponse(client, requestId, true, result);
+        
+    } else if (subCommand == "snapshot") {
+        // CPU and chip registers, banking state and, per "include", the CPU view,
+        // every XE bank and the cartridge image, all captured between the same two frames
+        const QJsonValue include = params["include"];
+        int sections = MachineSnapshot::AllSections;
+        if (include.isArray()) {
+            QStringList names;
+            for (const QJsonValue& name : include.toArray()) {
+                names << name.toString();
+            }
+            if (!MachineSnapshot::parseSections(names, &sections)) {
+                sendResponse(client, requestId, false, QJsonValue(),
+                            "include takes \"memory\", \"extended\" and \"cartridge\"");
+                return;
+            }
+        }
+        const QString encoding = params["encoding"].toString("base64");
+        if (encoding != "base64" && encoding != "binary") {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "encoding must be \"base64\" or \"binary\"");
+            return;
+        }
+        if (encoding == "binary" && client == m_batchClient) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "binary encoding is not available inside a batch");
+            return;
+        }
+        
+        MachineSnapshot snapshot;
+        AtariEmulator* emulator = m_emulator;
+        QMetaObject::invokeMethod(m_emulator, [emulator, sections, &snapshot]() {
+            snapshot = emulator->captureSnapshot(sections);
+        }, emulatorCallType());
+        if (!snapshot.isValid()) {
+            sendResponse(client, requestId, false, QJsonValue(), "Emulator is not running");
+            return;
+        }
+        
+        QJsonObject result = snapshot.toJson();
+        QJsonArray layout;
+        const QByteArray payload = snapshot.payload(sections, &layout);
+        result["layout"] = layout;
+        result["length"] = payload.size();
+        result["encoding"] = encoding;
+        if (encoding == "binary") {
+            sendResponse(client, requestId, true, result);
+            m_hub->sendData(client, payload);
+        } else {
+            result["data"] = QString::fromLatin1(payload.toBase64());
+            sendResponse(client, requestId, true, result);
+        }
+        
     } else if (subCommand == "add_breakpoint") {
         // Add breakpoint at specified address
         int address = params["address"].toInt();
@@ -1610,9 +2542,234 @@ void TCPServer::handleDebugCommand(QTcpSocket* client, const QJsonObject& reques
         QJsonObject eventData;
         sendEventToAllClients("breakpoints_cleared", eventData);
         
+    } else if (subCommand == "add_watchpoint") {
+        // Watch reads/writes/execution over an inclusive address range
+        int start = params.contains("start") ? params["start"].toInt(-1) : params["address"].toInt(-1);
+        int end = params.contains("end") ? params["end"].toInt(-1)
+                                         : start + params["length"].toInt(1) - 1;
+        const QString accessText = params["access"].toString("w").toLower();
+        const bool breakOnHit = params["break"].toBool(false);
+
+        int access = 0;
+        for (const QChar c : accessText) {
+            if (c == 'r') {
+                access |= AccessTraceRing::AccessRead;
+            } else if (c == 'w') {
+                access |= AccessTraceRing::AccessWrite;
+            } else if (c == 'x') {
+                access |= AccessTraceRing::AccessExecute;
+            } else {
+                access = 0;
+                break;
+            }
+        }
+        if (access == 0) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "Invalid watchpoint access. Use a combination of r, w and x");
+            return;
+        }
+        if (start < 0 || end > 65535 || start > end) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "Invalid watchpoint range. Must be within 0-65535");
+            return;
+        }
+
+        int id = -1;
+        QMetaObject::invokeMethod(m_emulator, "addWatchpoint", emulatorCallType(),
+                                  Q_RETURN_ARG(int, id), Q_ARG(int, start), Q_ARG(int, end),
+                                  Q_ARG(int, access), Q_ARG(bool, breakOnHit));
+
+        QJsonObject result;
+        result["id"] = id;
+        result["start"] = QString("$%1").arg(start, 4, 16, QChar('0')).toUpper();
+        result["end"] = QString("$%1").arg(end, 4, 16, QChar('0')).toUpper();
+        result["access"] = accessText;
+        result["break"] = breakOnHit;
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "remove_watchpoint") {
+        const int id = params["id"].toInt(-1);
+        bool removed = false;
+        QMetaObject::invokeMethod(m_emulator, "removeWatchpoint", emulatorCallType(),
+                                  Q_RETURN_ARG(bool, removed), Q_ARG(int, id));
+        if (!removed) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        QString("No watchpoint with id %1").arg(id));
+            return;
+        }
+        QJsonObject result;
+        result["id"] = id;
+        result["removed"] = true;
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "list_watchpoints") {
+        QJsonArray watchpoints;
+        QMetaObject::invokeMethod(m_emulator, "getWatchpoints", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonArray, watchpoints));
+        QJsonObject result;
+        result["watchpoints"] = watchpoints;
+        result["count"] = watchpoints.size();
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "clear_watchpoints") {
+        QMetaObject::invokeMethod(m_emulator, "clearWatchpoints", emulatorCallType());
+        QJsonObject result;
+        result["cleared"] = true;
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "drain_trace") {
+        // Bulk read of the watchpoint access trace; entries are removed as they are read
+        const int maxEntries = qBound(1, params["max"].toInt(4096), 65536);
+        AccessTraceRing& trace = m_emulator->accessTrace();
+        const QVector<AccessTraceEntry> entries = trace.drain(maxEntries);
+
+        // Compact rows: [frame, pc, address, access, value]
+        QJsonArray rows;
+        for (const AccessTraceEntry& entry : entries) {
+            rows.append(QJsonArray{static_cast<qint64>(entry.frame), entry.pc, entry.address,
+                                   entry.access, entry.value});
+        }
+        QJsonObject result;
+        result["entries"] = rows;
+        result["count"] = rows.size();
+        result["remaining"] = trace.size();
+        result["dropped"] = static_cast<qint64>(trace.takeDropped());
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "trace_start") {
+        // Record every instruction in start..end to a memory-mapped ring file
+        QString path = params["path"].toString();
+        if (path.isEmpty()) {
+            path = QDir::temp().filePath(
+                QString("fujisan_trace_%1.ftr").arg(QDateTime::currentMSecsSinceEpoch()));
+        }
+        QFileInfo fileInfo(path);
+        if (fileInfo.isRelative()) {
+            path = QDir::currentPath() + "/" + path;
+        }
+        const int sizeMB = params["size_mb"].toInt(64);
+        const int start = params.contains("start") ? params["start"].toInt(-1) : 0x0000;
+        const int end = params.contains("end") ? params["end"].toInt(-1) : 0xFFFF;
+        if (sizeMB < 1 || sizeMB > 4096) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "Invalid trace size. size_mb must be within 1-4096");
+            return;
+        }
+        QJsonObject result;
+        QMetaObject::invokeMethod(m_emulator, "startInstructionTrace", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, result), Q_ARG(QString, path),
+                                  Q_ARG(int, sizeMB), Q_ARG(int, start), Q_ARG(int, end));
+        if (result.contains("error")) {
+            sendResponse(client, requestId, false, QJsonValue(), result["error"].toString());
+            return;
+        }
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "trace_stop") {
+        QJsonObject result;
+        QMetaObject::invokeMethod(m_emulator, "stopInstructionTrace", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, result));
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "trace_status") {
+        QJsonObject result;
+        QMetaObject::invokeMethod(m_emulator, "instructionTraceStatus", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, result));
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "trace_tail") {
+        // The newest records of the current (or last) instruction trace, oldest first
+        const int count = qBound(1, params["count"].toInt(100), 65536);
+        QJsonArray records;
+        QMetaObject::invokeMethod(m_emulator, "instructionTraceTail", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonArray, records), Q_ARG(int, count));
+        QJsonObject result;
+        result["records"] = records;
+        result["count"] = records.size();
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "checksum_start") {
+        // XXH64 of RAM and the screen after every frame, for diffing two runs
+        QString path = params["path"].toString();
+        if (!path.isEmpty() && QFileInfo(path).isRelative()) {
+            path = QDir::currentPath() + "/" + path;
+        }
+        const int capacity = params["capacity"].toInt(FrameChecksumStream::kDefaultCapacity);
+        if (capacity < 1 || capacity > FrameChecksumStream::kMaxCapacity) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        QString("Invalid capacity. capacity must be within 1-%1")
+                            .arg(FrameChecksumStream::kMaxCapacity));
+            return;
+        }
+        QJsonObject result;
+        QMetaObject::invokeMethod(m_emulator, "startFrameChecksums", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, result), Q_ARG(QString, path),
+                                  Q_ARG(int, capacity));
+        if (result.contains("error")) {
+            sendResponse(client, requestId, false, QJsonValue(), result["error"].toString());
+            return;
+        }
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "checksum_stop") {
+        QJsonObject result;
+        QMetaObject::invokeMethod(m_emulator, "stopFrameChecksums", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, result));
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "checksum_status") {
+        QJsonObject result;
+        QMetaObject::invokeMethod(m_emulator, "frameChecksumStatus", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, result));
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "checksum_read") {
+        // Poll with the returned next_cursor to follow the stream without gaps
+        const qint64 cursor = qMax<qint64>(0, static_cast<qint64>(params["cursor"].toDouble(0)));
+        const int maxEntries = qBound(1, params["max"].toInt(4096), 65536);
+        QJsonObject result;
+        QMetaObject::invokeMethod(m_emulator, "readFrameChecksums", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, result), Q_ARG(qint64, cursor),
+                                  Q_ARG(int, maxEntries));
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "profile_start") {
+        // Exact cycles per address and per function until profile_stop
+        const bool splitBanks = params["split_banks"].toBool(false);
+        QMetaObject::invokeMethod(m_emulator, "startProfiling", emulatorCallType(),
+                                  Q_ARG(bool, splitBanks));
+        QJsonObject result;
+        result["profiling"] = true;
+        result["split_banks"] = splitBanks;
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "profile_stop" || subCommand == "profile_reset") {
+        // Stopping keeps the counters for get_profile; reset clears them
+        QMetaObject::invokeMethod(m_emulator,
+                                  subCommand == "profile_stop" ? "stopProfiling" : "resetProfile",
+                                  emulatorCallType());
+        QJsonObject result;
+        result["profiling"] = m_emulator->isProfiling();
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "get_profile") {
+        const int top = qBound(1, params["top"].toInt(20), 1000);
+        QJsonObject result;
+        QMetaObject::invokeMethod(m_emulator, "getProfile", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, result), Q_ARG(int, top));
+        sendResponse(client, requestId, true, result);
+
     } else if (subCommand == "pause") {
         // Pause emulation for debugging
-        if (!m_emulator->isEmulationPaused()) {
+        if (m_emulator->isRunToActive()) {
+            // Stop a running step over where it is; its own response follows
+            m_emulator->cancelRunTo();
+
+            QJsonObject result;
+            result["paused"] = true;
+            result["step_over_cancelled"] = true;
+            sendResponse(client, requestId, true, result);
+        } else if (!m_emulator->isEmulationPaused()) {
             m_emulator->pauseEmulation();
             
             QJsonObject result;
@@ -1698,50 +2855,27 @@ void TCPServer::handleDebugCommand(QTcpSocket* client, const QJsonObject& reques
     } else if (subCommand == "step_over") {
         // Step over subroutine calls
         if (m_emulator->isEmulationPaused()) {
+            if (m_emulator->isRunToActive()) {
+                sendResponse(client, requestId, false, QJsonValue(),
+                            "A step over is already in progress");
+                return;
+            }
             unsigned short currentPC = CPU_regPC;
             unsigned char opcode = MEMORY_mem[currentPC];
             
-            // Check if this is a JSR instruction (0x20)
-            if (opcode == 0x20) {
-                // JSR instruction - use instruction-level stepping to execute subroutine
-                unsigned short returnAddress = currentPC + 3;  // JSR is 3 bytes
-                
-                qDebug() << QString("TCP step_over: JSR at $%1, target return at $%2")
-                            .arg(currentPC, 4, 16, QChar('0')).toUpper()
-                            .arg(returnAddress, 4, 16, QChar('0')).toUpper();
-                
-                // Execute the JSR instruction first
-                m_emulator->stepOneInstruction();
-                
-                // Now we're inside the subroutine, step until we reach the return address
-                // Use a safety limit to prevent infinite loops
-                int maxSteps = 10000;  // Maximum instructions to execute
-                int stepCount = 0;
-                
-                while (CPU_regPC != returnAddress && stepCount < maxSteps) {
-                    m_emulator->stepOneInstruction();
-                    stepCount++;
-                    
-                    // Process events periodically for long subroutines
-                    if (stepCount % 100 == 0) {
-                        QCoreApplication::processEvents();
-                    }
-                }
-                
-                if (stepCount >= maxSteps) {
-                    qDebug() << QString("TCP step_over: Timeout after %1 steps, subroutine may not return")
-                                .arg(stepCount);
-                } else {
-                    qDebug() << QString("TCP step_over: Completed after %1 steps, PC=$%2")
-                                .arg(stepCount)
-                                .arg(CPU_regPC, 4, 16, QChar('0')).toUpper();
-                }
-            } else {
-                // Not a JSR, just step one instruction
-                m_emulator->stepOneInstruction();
-                qDebug() << QString("TCP step_over: Not JSR (opcode=$%1), single step")
-                            .arg(opcode, 2, 16, QChar('0')).toUpper();
+            // Only subroutine calls (JSR) are stepped over
+            if (opcodeInfo6502(opcode).flow == FlowKind6502::Call) {
+                // The emulator runs the subroutine at full speed until it returns to
+                // this stack depth; onRunToFinished() answers once it gets there.
+                m_pendingStepOvers.append({client, requestId, "step_over"});
+                QMetaObject::invokeMethod(m_emulator, "stepOver", Qt::QueuedConnection);
+                return;
             }
+
+            // Not a JSR, just step one instruction
+            m_emulator->stepOneInstruction();
+            qCDebug(lcTcpServer) << QString("step_over: Not JSR (opcode=$%1), single step")
+                        .arg(opcode, 2, 16, QChar('0')).toUpper();
             
             QJsonObject result;
             result["stepped"] = true;
@@ -1782,39 +2916,32 @@ void TCPServer::handleDebugCommand(QTcpSocket* client, const QJsonObject& reques
         result["address"] = QString("$%1").arg(address, 4, 16, QChar('0')).toUpper();
         result["lines"] = lines;
         
-        // Use the proper 6502 disassembler
+        // Shared table-driven decoder (disasm6502.h); wraps at $FFFF. With
+        // labels loaded, operands are shown by name and labelled lines say so.
+        const std::shared_ptr<const CodeAnalyzer::Labels> labels = m_emulator->codeAnalyzer().labels();
+        const bool symbolic = params["symbolic"].toBool(true) && !labels->isEmpty();
         QJsonArray disassembly;
         unsigned short currentAddr = (unsigned short)address;
-        
-        for (int i = 0; i < lines && currentAddr <= 65535; i++) {
-            DisassembledInstruction inst = disassemble6502(MEMORY_mem, currentAddr);
+        char instruction[kSymbolicText6502];
+        char hexBytes[kInstructionText6502];
+        
+        for (int i = 0; i < lines; i++) {
+            const int bytes = symbolic
+                ? formatInstructionSymbolic6502(MEMORY_mem, currentAddr, &CodeAnalyzer::lookupLabel,
+                                                labels.get(), instruction)
+                : formatInstruction6502(MEMORY_mem, currentAddr, instruction);
+            formatInstructionBytes6502(MEMORY_mem, currentAddr, hexBytes);
             
             QJsonObject line;
             line["address"] = QString("$%1").arg(currentAddr, 4, 16, QChar('0')).toUpper();
-            
-            // Build hex bytes string
-            QString hexBytes;
-            for (int j = 0; j < inst.bytes && (currentAddr + j) <= 65535; j++) {
-                hexBytes += QString("%1 ").arg(MEMORY_mem[currentAddr + j], 2, 16, QChar('0')).toUpper();
-            }
-            line["hex"] = hexBytes.trimmed();
-            
-            // Build instruction string
-            QString instruction = inst.mnemonic;
-            if (!inst.operand.isEmpty()) {
-                instruction += " " + inst.operand;
+            line["hex"] = QString::fromLatin1(hexBytes);
+            line["instruction"] = QString::fromLatin1(instruction);
+            if (symbolic && labels->contains(currentAddr)) {
+                line["label"] = QString::fromLatin1(labels->value(currentAddr));
             }
-            line["instruction"] = instruction;
-            
             disassembly.append(line);
             
-            // Advance to next instruction
-            currentAddr += inst.bytes;
-            
-            // Prevent infinite loop if we hit a bad instruction
-            if (inst.bytes == 0) {
-                currentAddr++;
-            }
+            currentAddr += bytes;
         }
         
         result["disassembly"] = disassembly;
@@ -1866,18 +2993,143 @@ void TCPServer::handleDebugCommand(QTcpSocket* client, const QJsonObject& reques
                         "Failed to load XEX file for debug: " + validatedPath);
         }
         
-    } else {
-        sendResponse(client, requestId, false, QJsonValue(), 
-                    "Unknown debug command: " + subCommand);
-    }
-}
-
-void TCPServer::handleConfigCommand(QTcpSocket* client, const QJsonObject& request, const QString& subCommand)
-{
-    QJsonValue requestId = request.contains("id") ? request["id"] : QJsonValue();
-    QJsonObject params = request["params"].toObject();
-    
-    if (subCommand == "get_machine_type") {
+    } else if (subCommand == "load_labels") {
+        // MADS .lab or ca65/VICE .lbl symbols for the disassembly
+        QString path = params["path"].toString();
+        QString validatedPath = validateAndNormalizePath(path);
+        if (validatedPath.isEmpty()) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "File not found or invalid path: " + path);
+            return;
+        }
+
+        QString error;
+        if (!m_emulator->codeAnalyzer().loadLabels(validatedPath, &error)) {
+            sendResponse(client, requestId, false, QJsonValue(), error);
+            return;
+        }
+        QJsonObject result;
+        result["path"] = validatedPath;
+        result["labels"] = m_emulator->codeAnalyzer().labels()->size();
+        sendResponse(client, requestId, true, result);
+
+    } else if (subCommand == "clear_labels") {
+        m_emulator->codeAnalyzer().clearLabels();
+        QJsonObject result;
+        result["labels"] = 0;
+        sendResponse(client, requestId, true, result);
+
+    } else {
+        sendResponse(client, requestId, false, QJsonValue(), 
+                    "Unknown debug command: " + subCommand);
+    }
+}
+
+void TCPServer::handleConfigCommand(ClientId client, const QJsonObject& request, const QString& subCommand)
+{
+    QJsonValue requestId = request.contains("id") ? request["id"] : QJsonValue();
+    QJsonObject params = request["params"].toObject();
+    
+    if (subCommand == "set_framing") {
+        // Request framing for this connection only; responses stay newline-delimited.
+        // TCPConnectionHub already switched it when it framed this request.
+        JsonMessageFramer::Framing framing = JsonMessageFramer::FramingBraces;
+        const QString mode = params["mode"].toString();
+        if (!JsonMessageFramer::parseFraming(mode, &framing)) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "Invalid framing mode (expected json, newline or length): " + mode);
+            return;
+        }
+        QJsonObject result;
+        result["mode"] = JsonMessageFramer::framingName(framing);
+        sendResponse(client, requestId, true, result);
+        
+    } else if (subCommand == "set_encoding") {
+        // Encoding of responses and events on this connection; requests stay JSON.
+        // This response still goes out in the old encoding, everything after in the new.
+        MessageEncoder::Encoding encoding = MessageEncoder::EncodingJson;
+        const QString encodingName = params["encoding"].toString("json");
+        const int compressThreshold = params["compress_threshold"].toInt(0);
+        if (!MessageEncoder::parseEncoding(encodingName, &encoding)) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "Invalid encoding (expected json, cbor or msgpack): " + encodingName);
+            return;
+        }
+        if (compressThreshold != 0 && (compressThreshold < MessageEncoder::kMinCompressThreshold ||
+                                       compressThreshold > JsonMessageFramer::kMaxMessageSize)) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        QString("compress_threshold must be 0 (off) or between %1 and %2 bytes")
+                            .arg(MessageEncoder::kMinCompressThreshold)
+                            .arg(JsonMessageFramer::kMaxMessageSize));
+            return;
+        }
+
+        QJsonObject result;
+        result["encoding"] = MessageEncoder::encodingName(encoding);
+        result["compress_threshold"] = compressThreshold;
+        result["framed"] = MessageEncoder(encoding, compressThreshold).isFramed();
+        sendResponse(client, requestId, true, result);
+        // Queued behind the response on the I/O thread, so the switch lands right after it
+        QMetaObject::invokeMethod(m_hub, "setEncoding", Qt::QueuedConnection,
+                                  Q_ARG(quint32, client), Q_ARG(int, encoding),
+                                  Q_ARG(int, compressThreshold));
+
+    } else if (subCommand == "subscribe_events") {
+        // Restrict broadcast events on this connection to the listed types; "*" (or no
+        // list) restores all. Responses and events a client asked for itself
+        // (streams, scheduled actions) are not affected.
+        const QJsonArray events = params["events"].toArray();
+        QSet<QString> subscription;
+        bool all = !params.contains("events");
+        for (const QJsonValue& value : events) {
+            const QString eventType = value.toString();
+            if (eventType.isEmpty()) {
+                sendResponse(client, requestId, false, QJsonValue(),
+                            "events must be an array of event type names");
+                return;
+            }
+            if (eventType == "*") {
+                all = true;
+            }
+            subscription.insert(eventType);
+        }
+        if (all) {
+            m_eventSubscriptions.remove(client);
+        } else {
+            m_eventSubscriptions.insert(client, subscription);
+        }
+        
+        QJsonObject result;
+        result["events"] = all ? QJsonArray{"*"} : QJsonArray::fromStringList(subscription.values());
+        sendResponse(client, requestId, true, result);
+        
+    } else if (subCommand == "set_backpressure") {
+        // What happens to events once this client stops reading and more than
+        // max_queued_kb is waiting in its socket
+        TCPConnectionHub::BackpressurePolicy policy = TCPConnectionHub::DropEvents;
+        const QString policyName = params["policy"].toString("drop");
+        const int maxQueuedKB = params["max_queued_kb"].toInt(
+            static_cast<int>(TCPConnectionHub::kDefaultEventBacklogLimit / 1024));
+        if (!TCPConnectionHub::parsePolicy(policyName, &policy)) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "Invalid policy (expected drop or coalesce): " + policyName);
+            return;
+        }
+        if (maxQueuedKB < 16 || maxQueuedKB > 65536) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "max_queued_kb must be between 16 and 65536");
+            return;
+        }
+        QMetaObject::invokeMethod(m_hub, "setBackpressure", Qt::BlockingQueuedConnection,
+                                  Q_ARG(quint32, client), Q_ARG(int, policy),
+                                  Q_ARG(qint64, static_cast<qint64>(maxQueuedKB) * 1024));
+        
+        QJsonObject result;
+        result["policy"] = TCPConnectionHub::policyName(policy);
+        result["max_queued_kb"] = maxQueuedKB;
+        sendResponse(client, requestId, true, result);
+        
+    } else if (subCommand == "get_machine_type") {
         // Get current machine type
         QString machineType = m_emulator->getMachineType();
         // Remove dash prefix for API consistency
@@ -2137,24 +3389,31 @@ void TCPServer::handleConfigCommand(QTcpSocket* client, const QJsonObject& reque
         sendEventToAllClients("rom_paths_changed", eventData);
         
     } else if (subCommand == "apply_restart") {
-        // Apply configuration changes that require restart
-        // Use the proper restart method that reinitializes with new settings
+        // Apply configuration changes. libatari800 is only re-initialised when a
+        // boot setting (machine, video system, BASIC, ROMs, display area, NetSIO)
+        // changed or "force" is set; artifacting, joysticks and speed go live.
+        const bool force = params["force"].toBool(false);
+        QStringList reasons;
         if (m_mainWindow) {
-            m_mainWindow->requestEmulatorRestart();
+            reasons = m_mainWindow->reconfigureEmulator(force);
         } else {
             // Fallback if MainWindow is not available
             m_emulator->coldRestart();
+            reasons << "forced";
         }
+        const bool restarted = !reasons.isEmpty();
         
         QJsonObject result;
-        result["restarted"] = true;
-        result["reason"] = "configuration_changes";
+        result["restarted"] = restarted;
+        result["reason"] = restarted ? "configuration_changes" : "applied_live";
+        result["restart_reasons"] = QJsonArray::fromStringList(reasons);
         sendResponse(client, requestId, true, result);
         
         // Send event to all clients
         QJsonObject eventData;
-        eventData["reason"] = "configuration_changes";
-        sendEventToAllClients("emulator_restarted", eventData);
+        eventData["reason"] = result["reason"];
+        eventData["restart_reasons"] = result["restart_reasons"];
+        sendEventToAllClients(restarted ? "emulator_restarted" : "configuration_applied", eventData);
         
     } else if (subCommand == "get_profiles") {
         // Get list of available configuration profiles
@@ -2283,7 +3542,7 @@ void TCPServer::handleConfigCommand(QTcpSocket* client, const QJsonObject& reque
     }
 }
 
-void TCPServer::handleStatusCommand(QTcpSocket* client, const QJsonObject& request, const QString& subCommand)
+void TCPServer::handleStatusCommand(ClientId client, const QJsonObject& request, const QString& subCommand)
 {
     QJsonValue requestId = request.contains("id") ? request["id"] : QJsonValue();
     
@@ -2293,103 +3552,490 @@ void TCPServer::handleStatusCommand(QTcpSocket* client, const QJsonObject& reque
         state["running"] = !m_emulator->isEmulationPaused();
         state["connected_clients"] = m_clients.count();
         state["server_port"] = m_port;
+        if (!m_localServerPath.isEmpty()) {
+            state["local_socket"] = m_localServerPath;
+        }
         
         // Add basic CPU state if available
         state["pc"] = QString("$%1").arg(CPU_regPC, 4, 16, QChar('0')).toUpper();
         state["a"] = QString("$%1").arg(CPU_regA, 2, 16, QChar('0')).toUpper();
         
         sendResponse(client, requestId, true, state);
+    } else if (subCommand == "get_connection") {
+        // Outbound counters and settings of the requesting connection
+        QJsonObject stats;
+        QMetaObject::invokeMethod(m_hub, "connectionStats", Qt::BlockingQueuedConnection,
+                                  Q_RETURN_ARG(QJsonObject, stats), Q_ARG(quint32, client));
+        const auto subscription = m_eventSubscriptions.constFind(client);
+        stats["events"] = subscription == m_eventSubscriptions.constEnd()
+                              ? QJsonArray{"*"}
+                              : QJsonArray::fromStringList(subscription.value().values());
+        stats["client_id"] = static_cast<qint64>(client);
+        sendResponse(client, requestId, true, stats);
+    } else if (subCommand == "get_metrics") {
+        // Per-command latency histograms and per-client byte counters
+        const bool reset = request["params"].toObject()["reset"].toBool(false);
+        QJsonObject serialisation;
+        QMetaObject::invokeMethod(m_hub, "serialisationMetrics", Qt::BlockingQueuedConnection,
+                                  Q_RETURN_ARG(QJsonObject, serialisation), Q_ARG(bool, reset));
+        QJsonObject commands;
+        for (auto it = m_commandMetrics.cbegin(); it != m_commandMetrics.cend(); ++it) {
+            QJsonObject metrics;
+            metrics["count"] = static_cast<qint64>(it.value().execution.count());
+            metrics["queue_wait"] = it.value().queueWait.toJson();
+            metrics["execution"] = it.value().execution.toJson();
+            metrics["serialisation"] = serialisation.value(it.key()).toObject();
+            commands[it.key()] = metrics;
+        }
+        QJsonArray clients;
+        for (ClientId id : m_clients) {
+            QJsonObject stats;
+            QMetaObject::invokeMethod(m_hub, "connectionStats", Qt::BlockingQueuedConnection,
+                                      Q_RETURN_ARG(QJsonObject, stats), Q_ARG(quint32, id));
+            stats["client_id"] = static_cast<qint64>(id);
+            clients.append(stats);
+        }
+        QJsonObject events;
+        for (auto it = serialisation.constBegin(); it != serialisation.constEnd(); ++it) {
+            if (it.key().startsWith("event:")) {
+                events[it.key().mid(6)] = it.value();
+            }
+        }
+        if (reset) {
+            m_commandMetrics.clear();
+        }
+
+        QJsonObject result;
+        result["commands"] = commands;
+        result["events"] = events;
+        result["clients"] = clients;
+        sendResponse(client, requestId, true, result);
+    } else if (subCommand == "get_audio_telemetry") {
+        // Per-frame audio samples; the ring is lock-free, so it is read directly
+        const QJsonObject params = request["params"].toObject();
+        const AudioTelemetryRing& telemetry = m_emulator->audioTelemetry();
+        const int maxSamples = qBound(1, params["max"].toInt(600), telemetry.capacity());
+        const quint64 recorded = telemetry.recorded();
+        // Without "since", return the most recent samples
+        quint64 cursor = params.contains("since")
+                             ? static_cast<quint64>(qMax<qint64>(0, params["since"].toVariant().toLongLong()))
+                             : recorded - qMin<quint64>(recorded, static_cast<quint64>(maxSamples));
+        quint64 lost = 0;
+        const QVector<AudioTelemetrySample> samples = telemetry.read(cursor, maxSamples, &lost);
+
+        QJsonArray rows;
+        for (const AudioTelemetrySample& sample : samples) {
+            rows.append(AudioTelemetryRing::toJson(sample));
+        }
+        QJsonObject result;
+        result["columns"] = QJsonArray::fromStringList(AudioTelemetryRing::csvHeader().split(','));
+        result["samples"] = rows;
+        result["count"] = rows.size();
+        result["next"] = static_cast<qint64>(cursor);
+        result["lost"] = static_cast<qint64>(lost);
+        result["capacity"] = telemetry.capacity();
+        sendResponse(client, requestId, true, result);
+    } else if (subCommand == "get_input_latency") {
+        // Input-to-frame and input-to-paint histograms; the monitor is thread-safe
+        const QJsonObject params = request["params"].toObject();
+        InputLatencyMonitor& monitor = m_emulator->inputLatency();
+        if (params.contains("enabled")) {
+            monitor.setEnabled(params["enabled"].toBool());
+        }
+        const QJsonObject result = monitor.toJson();
+        if (params["reset"].toBool(false)) {
+            monitor.reset();
+        }
+        sendResponse(client, requestId, true, result);
+    } else if (subCommand == "get_frame_pacing") {
+        // Frame deadline lateness and frame intervals, kept on the emulator thread
+        QJsonObject result;
+        QMetaObject::invokeMethod(m_emulator, "framePacingStatus", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, result));
+        QJsonObject scheduling;
+        QMetaObject::invokeMethod(m_emulator, "threadSchedulingStatus", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, scheduling));
+        result["scheduling"] = scheduling;
+        if (request["params"].toObject()["reset"].toBool(false)) {
+            QMetaObject::invokeMethod(m_emulator, "resetFramePacing", emulatorCallType());
+        }
+        sendResponse(client, requestId, true, result);
+    } else if (subCommand == "get_performance") {
+        // Rolling per-frame counters (PerformanceMonitor); lock-free, read directly.
+        // stream_ms pushes the same report as a "performance" event at that interval
+        const QJsonObject params = request["params"].toObject();
+        PerformanceMonitor& monitor = m_emulator->performance();
+        const int history = params["history"].toInt(0);
+        if (history < 0 || history > PerformanceMonitor::kWindow) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        QString("history must be 0-%1 samples").arg(PerformanceMonitor::kWindow));
+            return;
+        }
+        if (params.contains("stream_ms")) {
+            const int intervalMs = params["stream_ms"].toInt(-1);
+            if (intervalMs != 0 && (intervalMs < 100 || intervalMs > 60000)) {
+                sendResponse(client, requestId, false, QJsonValue(),
+                            "stream_ms must be 0 (stop) or 100-60000");
+                return;
+            }
+            if (intervalMs == 0) {
+                m_performanceClients.remove(client);
+            } else {
+                PerformanceSubscriber subscriber;
+                subscriber.intervalMs = intervalMs;
+                subscriber.history = history;
+                m_performanceClients.insert(client, subscriber);
+            }
+            updatePerformanceTimer();
+        }
+        if (params.contains("enabled")) {
+            monitor.setEnabled(params["enabled"].toBool());
+        }
+        QJsonObject result = monitor.toJson(history);
+        result["streaming_ms"] = m_performanceClients.value(client).intervalMs;
+        if (params["reset"].toBool(false)) {
+            monitor.reset();
+        }
+        sendResponse(client, requestId, true, result);
+    } else if (subCommand == "get_netsio") {
+        // Link health from the NetSIO layer; it keeps its own lock
+        sendResponse(client, requestId, true, m_emulator->netsioLinkStatus());
     } else {
         sendResponse(client, requestId, false, QJsonValue(), 
                     "Unknown status command: " + subCommand);
     }
 }
 
-void TCPServer::handleScreenCommand(QTcpSocket* client, const QJsonObject& request, const QString& subCommand)
+void TCPServer::updatePerformanceTimer()
+{
+    if (m_performanceClients.isEmpty()) {
+        if (m_performanceTimer) {
+            m_performanceTimer->stop();
+        }
+        return;
+    }
+    if (!m_performanceTimer) {
+        m_performanceTimer = new QTimer(this);
+        connect(m_performanceTimer, &QTimer::timeout, this, &TCPServer::sendPerformanceEvents);
+        m_performanceClock.start();
+    }
+    // Ticks at the shortest interval asked for; each client is sent its own
+    int interval = 0;
+    for (const PerformanceSubscriber& subscriber : m_performanceClients) {
+        interval = interval == 0 ? subscriber.intervalMs : qMin(interval, subscriber.intervalMs);
+    }
+    m_performanceTimer->start(interval);
+}
+
+void TCPServer::sendPerformanceEvents()
+{
+    const qint64 now = m_performanceClock.elapsed();
+    const PerformanceMonitor& monitor = m_emulator->performance();
+    QHash<int, QJsonObject> reports;  // by history length, built once per tick
+    for (auto it = m_performanceClients.begin(); it != m_performanceClients.end(); ++it) {
+        PerformanceSubscriber& subscriber = it.value();
+        // A little early still counts, so a client at the timer's own interval is never skipped
+        if (subscriber.lastSentMs && now - subscriber.lastSentMs < subscriber.intervalMs * 9 / 10) {
+            continue;
+        }
+        subscriber.lastSentMs = now;
+        if (!reports.contains(subscriber.history)) {
+            reports.insert(subscriber.history, monitor.toJson(subscriber.history));
+        }
+        sendEvent(it.key(), "performance", reports.value(subscriber.history));
+    }
+}
+
+void TCPServer::handleScreenCommand(ClientId client, const QJsonObject& request, const QString& subCommand)
 {
     QJsonValue requestId = request.contains("id") ? request["id"] : QJsonValue();
     QJsonObject params = request["params"].toObject();
     
     if (subCommand == "capture") {
-        // Save screenshot to file
+        // Copy the frame between two emulated frames, then encode it on the worker pool;
+        // the response follows once it is written (or encoded, for inline captures)
         QString filename = params["filename"].toString();
-        bool interlaced = params["interlaced"].toBool(false);
+        const QString inlineMode = params["inline"].isBool()
+                                       ? (params["inline"].toBool() ? QString("base64") : QString())
+                                       : params["inline"].toString();
+        if (!inlineMode.isEmpty() && inlineMode != "base64" && inlineMode != "binary") {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "Invalid inline mode (expected base64 or binary): " + inlineMode);
+            return;
+        }
+        if (inlineMode == "binary" && m_batchResponses && client == m_batchClient) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "Binary screenshots cannot be returned inside a batch");
+            return;
+        }
+
+        QString formatName = params["format"].toString();
+        if (formatName.isEmpty()) {
+            const QString suffix = QFileInfo(filename).suffix().toLower();
+            formatName = (suffix == "qoi" || suffix == "pcx") ? suffix : QString("png");
+        }
+        const bool interlaced = params["interlaced"].toBool(false);
+        if (formatName.compare("pcx", Qt::CaseInsensitive) == 0 || interlaced) {
+            // The core's own writer, kept for PCX and interlaced captures; runs on the
+            // emulator thread between frames
+            if (!inlineMode.isEmpty()) {
+                sendResponse(client, requestId, false, QJsonValue(),
+                            "PCX and interlaced screenshots can only be written to a file");
+                return;
+            }
+            if (filename.isEmpty()) {
+                filename = QString("screenshot_%1.pcx").arg(QDateTime::currentMSecsSinceEpoch());
+            } else if (!filename.endsWith(".pcx", Qt::CaseInsensitive)) {
+                const int lastDot = filename.lastIndexOf('.');
+                filename = (lastDot > filename.lastIndexOf('/') ? filename.left(lastDot) : filename) + ".pcx";
+            }
+            if (QFileInfo(filename).isRelative()) {
+                filename = QDir::currentPath() + "/" + filename;
+            }
+            bool success = false;
+            QMetaObject::invokeMethod(m_emulator, "saveCoreScreenshot", emulatorCallType(),
+                                      Q_RETURN_ARG(bool, success), Q_ARG(QString, filename),
+                                      Q_ARG(bool, interlaced));
+            if (!success) {
+                sendResponse(client, requestId, false, QJsonValue(), "Screenshot could not be written: " + filename);
+                return;
+            }
+            QJsonObject result;
+            result["filename"] = filename;
+            result["format"] = "pcx";
+            result["interlaced"] = interlaced;
+            result["timestamp"] = QDateTime::currentMSecsSinceEpoch();
+            result["size_bytes"] = QFileInfo(filename).size();
+            sendResponse(client, requestId, true, result);
+            return;
+        }
+
+        ScreenshotEncoder::Format format = ScreenshotEncoder::FormatPng;
+        if (!ScreenshotEncoder::parseFormat(formatName, &format)) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "Invalid format (expected png, qoi or pcx): " + formatName);
+            return;
+        }
+        if (filename.isEmpty() && inlineMode.isEmpty()) {
+            filename = QString("screenshot_%1.%2").arg(QDateTime::currentMSecsSinceEpoch())
+                                                  .arg(ScreenshotEncoder::formatName(format));
+        }
+        if (!filename.isEmpty() && QFileInfo(filename).isRelative()) {
+            filename = QDir::currentPath() + "/" + filename;
+        }
+
+        QImage frame;
+        QMetaObject::invokeMethod(m_emulator, "renderIndexedScreen", emulatorCallType(),
+                                  Q_RETURN_ARG(QImage, frame));
+        if (frame.isNull()) {
+            sendResponse(client, requestId, false, QJsonValue(), "Screen buffer not available");
+            return;
+        }
+        PendingCapture pending;
+        pending.client = client;
+        pending.requestId = requestId;
+        pending.inlineMode = inlineMode;
+        pending.format = format;
+        pending.frame = static_cast<qint64>(m_emulator->getCurrentFrame());
+        pending.timestamp = QDateTime::currentMSecsSinceEpoch();
+        m_pendingCaptures.insert(m_screenshotEncoder->submit(frame, format, filename), pending);
+
+    } else if (subCommand == "get_buffer") {
+        // One raw indexed frame plus its palette, both base64
+        QImage frame;
+        QMetaObject::invokeMethod(m_emulator, "renderIndexedScreen", emulatorCallType(),
+                                  Q_RETURN_ARG(QImage, frame));
+        if (frame.isNull()) {
+            sendResponse(client, requestId, false, QJsonValue(), "Screen buffer not available");
+            return;
+        }
+        QByteArray pixels;
+        pixels.reserve(frame.width() * frame.height());
+        for (int y = 0; y < frame.height(); ++y) {
+            pixels.append(reinterpret_cast<const char*>(frame.constScanLine(y)), frame.width());
+        }
+        const QByteArray palette = ScreenStreamEncoder::paletteToRgb(frame.colorTable());
+        QJsonObject result;
+        result["width"] = frame.width();
+        result["height"] = frame.height();
+        result["format"] = "indexed8";
+        result["data"] = QString::fromLatin1(pixels.toBase64());
+        result["palette"] = QString::fromLatin1(palette.toBase64());
+        sendResponse(client, requestId, true, result);
         
-        if (filename.isEmpty()) {
-            // Generate default filename if not provided
-            filename = QString("screenshot_%1.pcx").arg(QDateTime::currentMSecsSinceEpoch());
+    } else if (subCommand == "stream_start") {
+        ScreenStreamEncoder::Encoding encoding = ScreenStreamEncoder::EncodingFull;
+        const QString encodingName = params["encoding"].toString("full");
+        if (!ScreenStreamEncoder::parseEncoding(encodingName, &encoding)) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        "Invalid encoding (expected full, rows or delta): " + encodingName);
+            return;
+        }
+        const int jitterFrames = params["jitter_frames"].toInt(RemotePlaySession::kDefaultJitterFrames);
+        if (jitterFrames < 0 || jitterFrames > RemotePlaySession::kMaxJitterFrames) {
+            sendResponse(client, requestId, false, QJsonValue(),
+                        QString("jitter_frames must be 0-%1").arg(RemotePlaySession::kMaxJitterFrames));
+            return;
+        }
+        const int targetRttMs = params["target_rtt_ms"].toInt(50);
+        if (targetRttMs < 1 || targetRttMs > 10000) {
+            sendResponse(client, requestId, false, QJsonValue(), "target_rtt_ms must be 1-10000");
+            return;
         }
+        ScreenStreamSubscriber subscriber;
+        subscriber.encoder = ScreenStreamEncoder(encoding);
+        subscriber.session = RemotePlaySession(jitterFrames, params["adaptive"].toBool(false), targetRttMs);
+        subscriber.interval = qBound(1, params["interval"].toInt(1), 3600);
+        subscriber.audio = params["audio"].toBool(false);
+        m_screenStreamClients.insert(client, subscriber);
+        updateScreenStreamInterval();
+        
+        // Packets follow this response on the same socket
+        QJsonObject result;
+        result["streaming"] = true;
+        result["encoding"] = ScreenStreamEncoder::encodingName(encoding);
+        result["interval"] = subscriber.interval;
+        result["magic"] = ScreenStreamEncoder::kMagic;
+        result["header_size"] = ScreenStreamEncoder::kHeaderSize;
+        result["audio"] = subscriber.audio ? QJsonValue(m_streamAudioFormat) : QJsonValue(false);
+        result["jitter_frames"] = jitterFrames;
+        result["adaptive"] = subscriber.session.isAdaptive();
+        result["target_rtt_ms"] = targetRttMs;
+        sendResponse(client, requestId, true, result);
         
-        // Ensure PCX extension since PNG might not be compiled in
-        if (!filename.endsWith(".pcx", Qt::CaseInsensitive)) {
-            // Change extension to .pcx
-            int lastDot = filename.lastIndexOf('.');
-            if (lastDot != -1) {
-                filename = filename.left(lastDot) + ".pcx";
-            } else {
-                filename += ".pcx";
+    } else if (subCommand == "stream_input") {
+        // Remote play return channel: acknowledges a received frame and/or queues
+        // input for the jitter buffer, applied as the following frames are published
+        const auto it = m_screenStreamClients.find(client);
+        if (it == m_screenStreamClients.end()) {
+            sendResponse(client, requestId, false, QJsonValue(), "Not streaming; call screen.stream_start first");
+            return;
+        }
+        const bool hasInput = params.contains("joystick") || params.contains("keys");
+        if (hasInput && !params.contains("sequence")) {
+            sendResponse(client, requestId, false, QJsonValue(), "Input needs a sequence number");
+            return;
+        }
+        RemotePlaySession::InputPacket packet;
+        packet.sequence = static_cast<quint32>(params["sequence"].toDouble(0));
+        for (const QJsonValue& value : params["joystick"].toArray()) {
+            const QJsonObject entry = value.toObject();
+            RemotePlaySession::JoystickInput joystick;
+            joystick.player = entry["player"].toInt(1);
+            joystick.direction = entry["value"].toInt(15);
+            joystick.fire = entry["fire"].toBool(false);
+            if (joystick.player < 1 || joystick.player > 2 || joystick.direction < 0 || joystick.direction > 15) {
+                sendResponse(client, requestId, false, QJsonValue(),
+                            "Joystick entries need player 1-2 and value 0-15");
+                return;
+            }
+            packet.joysticks.append(joystick);
+        }
+        for (const QJsonValue& value : params["keys"].toArray()) {
+            const int akeyCode = value.toInt(-1);
+            if (akeyCode < 0 || akeyCode > 0xFF) {
+                sendResponse(client, requestId, false, QJsonValue(), "keys must be AKEY codes 0-255");
+                return;
+            }
+            packet.keys.append(akeyCode);
+        }
+
+        RemotePlaySession& session = it.value().session;
+        QJsonObject result;
+        if (params.contains("ack")) {
+            result["acknowledged"] = session.acknowledge(static_cast<quint64>(params["ack"].toDouble(-1)),
+                                                         LatencyHistogram::nowMicroseconds());
+        }
+        if (hasInput) {
+            result["queued"] = session.queueInput(packet, m_lastStreamFrame);
+        }
+        result["rtt_ms"] = session.smoothedRttUs() / 1000.0;
+        result["frame_skip"] = session.frameSkip();
+        sendResponse(client, requestId, true, result);
+        
+    } else if (subCommand == "stream_status") {
+        const auto it = m_screenStreamClients.constFind(client);
+        QJsonObject result;
+        result["streaming"] = it != m_screenStreamClients.constEnd();
+        if (it != m_screenStreamClients.constEnd()) {
+            const QJsonObject stats = it.value().session.stats();
+            for (auto stat = stats.constBegin(); stat != stats.constEnd(); ++stat) {
+                result[stat.key()] = stat.value();
             }
-            qDebug() << "TCP Server: Changed filename extension to PCX:" << filename;
+            result["encoding"] = ScreenStreamEncoder::encodingName(it.value().encoder.encoding());
+            result["interval"] = it.value().interval;
+            result["last_frame"] = static_cast<qint64>(it.value().lastFrame);
+            result["audio"] = it.value().audio;
+            result["audio_samples"] = static_cast<qint64>(it.value().audioSamples);
+            result["audio_overrun_bytes"] = static_cast<qint64>(m_emulator->streamAudioOverrunBytes());
+        }
+        sendResponse(client, requestId, true, result);
+        
+    } else if (subCommand == "stream_stop") {
+        const bool wasStreaming = m_screenStreamClients.remove(client) > 0;
+        updateScreenStreamInterval();
+        QJsonObject result;
+        result["streaming"] = false;
+        result["was_streaming"] = wasStreaming;
+        sendResponse(client, requestId, true, result);
+        
+    } else if (subCommand == "get_text") {
+        // Text mode lines of the display list, decoded from memory on the emulator thread
+        const int displayList = params.contains("display_list") ? params["display_list"].toInt(-1) : -1;
+        if (params.contains("display_list") && (displayList < 0 || displayList > 0xFFFF)) {
+            sendResponse(client, requestId, false, QJsonValue(), "display_list must be 0-65535");
+            return;
+        }
+        QJsonObject result;
+        QMetaObject::invokeMethod(m_emulator, "getScreenText", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, result), Q_ARG(int, displayList),
+                                  Q_ARG(bool, params["detail"].toBool(false)));
+        sendResponse(client, requestId, true, result);
+        
+    } else if (subCommand == "start_text_events") {
+        m_screenTextClients.insert(client);
+        updateScreenTextEvents();
+        QJsonObject result;
+        result["streaming"] = true;
+        sendResponse(client, requestId, true, result);
+        
+    } else if (subCommand == "stop_text_events") {
+        if (m_screenTextClients.remove(client)) {
+            updateScreenTextEvents();
         }
+        QJsonObject result;
+        result["streaming"] = false;
+        sendResponse(client, requestId, true, result);
         
-        // Use absolute path in current directory
+    } else if (subCommand == "record_start") {
+        // Lossless AVI of every frame plus audio, encoded on a background thread
+        QString filename = params["filename"].toString();
+        if (filename.isEmpty()) {
+            filename = QString("recording_%1.avi").arg(QDateTime::currentMSecsSinceEpoch());
+        }
         QFileInfo fileInfo(filename);
         if (fileInfo.isRelative()) {
             filename = QDir::currentPath() + "/" + filename;
         }
-        
-        // Call atari800 screen capture function with error handling
-        try {
-            qDebug() << "TCP Server: Attempting to save screenshot to:" << filename;
-            
-#ifdef SCREENSHOTS
-            bool success = Screen_SaveScreenshot(filename.toUtf8().constData(), interlaced ? 1 : 0);
-            
-            if (success) {
-                QJsonObject result;
-                result["filename"] = filename;
-                result["interlaced"] = interlaced;
-                result["timestamp"] = QDateTime::currentMSecsSinceEpoch();
-                result["size_bytes"] = QFileInfo(filename).size();
-                sendResponse(client, requestId, true, result);
-                qDebug() << "TCP Server: Screenshot saved successfully";
-            } else {
-                sendResponse(client, requestId, false, QJsonValue(), 
-                            "Screen_SaveScreenshot failed for: " + filename);
-                qDebug() << "TCP Server: Screen_SaveScreenshot returned false";
-            }
-#else
-            sendResponse(client, requestId, false, QJsonValue(), 
-                        "Screenshot support not compiled in (SCREENSHOTS not defined)");
-            qDebug() << "TCP Server: Screenshot support not available - SCREENSHOTS not defined";
-#endif
-        } catch (const std::exception& e) {
-            sendResponse(client, requestId, false, QJsonValue(), 
-                        QString("Exception during screenshot: %1").arg(e.what()));
-            qDebug() << "TCP Server: Exception during screenshot:" << e.what();
-        } catch (...) {
-            sendResponse(client, requestId, false, QJsonValue(), 
-                        "Unknown exception during screenshot");
-            qDebug() << "TCP Server: Unknown exception during screenshot";
+        QJsonObject result;
+        QMetaObject::invokeMethod(m_emulator, "startRecording", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, result), Q_ARG(QString, filename));
+        if (result.contains("error")) {
+            sendResponse(client, requestId, false, QJsonValue(), result["error"].toString());
+            return;
         }
+        sendResponse(client, requestId, true, result);
         
-    } else if (subCommand == "get_buffer") {
-        // Return raw screen buffer as base64
-        // This requires access to Screen_atari buffer
+    } else if (subCommand == "record_stop") {
         QJsonObject result;
-        result["width"] = 320;  // Standard Atari screen width
-        result["height"] = 240; // Standard Atari screen height
-        result["format"] = "ARGB32";
-        result["buffer_available"] = false; // Will implement this next
-        result["message"] = "Raw buffer access not yet implemented";
+        QMetaObject::invokeMethod(m_emulator, "stopRecording", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, result));
         sendResponse(client, requestId, true, result);
         
-    } else if (subCommand == "get_text") {
-        // Extract text from current screen (for text mode)
+    } else if (subCommand == "record_status") {
         QJsonObject result;
-        result["text"] = ""; // Will implement text extraction
-        result["mode"] = "unknown";
-        result["message"] = "Text extraction not yet implemented";
+        QMetaObject::invokeMethod(m_emulator, "recordingStatus", emulatorCallType(),
+                                  Q_RETURN_ARG(QJsonObject, result));
         sendResponse(client, requestId, true, result);
         
     } else {
@@ -2398,108 +4044,74 @@ void TCPServer::handleScreenCommand(QTcpSocket* client, const QJsonObject& reque
     }
 }
 
-void TCPServer::streamJoystickStates()
+void TCPServer::updateInputChangeReporting()
 {
-    if (m_joystickStreamClients.isEmpty() || !m_emulator) {
-        return;
+    if (m_emulator) {
+        m_emulator->setInputChangeReporting(!m_joystickStreamClients.isEmpty());
     }
-    
-    // Get current joystick states
-    int joy0State = m_emulator->getJoystickState(1);
-    int joy1State = m_emulator->getJoystickState(2);
-    bool trig0 = m_emulator->getJoystickFire(1);
-    bool trig1 = m_emulator->getJoystickFire(2);
-    
-    // Check for changes in joystick 1
-    if (joy0State != m_lastJoy0State || trig0 != m_lastTrig0) {
-        // Convert inverted value back to direction name
-        auto getDirectionInfo = [](int value) -> QPair<QString, int> {
-            const int CENTER = 0x0f ^ 0xff;
-            const int UP = 0x0e ^ 0xff;
-            const int DOWN = 0x0d ^ 0xff;
-            const int LEFT = 0x0b ^ 0xff;
-            const int RIGHT = 0x07 ^ 0xff;
-            const int UP_LEFT = 0x0a ^ 0xff;
-            const int UP_RIGHT = 0x06 ^ 0xff;
-            const int DOWN_LEFT = 0x09 ^ 0xff;
-            const int DOWN_RIGHT = 0x05 ^ 0xff;
-            
-            if (value == CENTER) return qMakePair(QString("CENTER"), 15);
-            else if (value == UP) return qMakePair(QString("UP"), 14);
-            else if (value == DOWN) return qMakePair(QString("DOWN"), 13);
-            else if (value == LEFT) return qMakePair(QString("LEFT"), 11);
-            else if (value == RIGHT) return qMakePair(QString("RIGHT"), 7);
-            else if (value == UP_LEFT) return qMakePair(QString("UP_LEFT"), 10);
-            else if (value == UP_RIGHT) return qMakePair(QString("UP_RIGHT"), 6);
-            else if (value == DOWN_LEFT) return qMakePair(QString("DOWN_LEFT"), 9);
-            else if (value == DOWN_RIGHT) return qMakePair(QString("DOWN_RIGHT"), 5);
-            else return qMakePair(QString("UNKNOWN"), -1);
-        };
-        
-        auto dirInfo = getDirectionInfo(joy0State);
-        auto prevDirInfo = getDirectionInfo(m_lastJoy0State);
-        
-        QJsonObject data;
-        data["player"] = 1;
-        data["direction"] = dirInfo.first;
-        data["direction_value"] = joy0State;
-        data["fire"] = trig0;
-        data["previous_direction"] = prevDirInfo.first;
-        data["previous_fire"] = m_lastTrig0;
-        data["timestamp"] = QDateTime::currentMSecsSinceEpoch();
-        
-        // Send to all subscribed clients
-        for (QTcpSocket* client : m_joystickStreamClients) {
-            sendEvent(client, "joystick_changed", data);
-        }
-        
-        m_lastJoy0State = joy0State;
-        m_lastTrig0 = trig0;
+}
+
+void TCPServer::sendToJoystickStreamClients(const QString& eventType, const QJsonObject& data)
+{
+    if (m_joystickStreamClients.isEmpty()) {
+        return;  // Changes still queued after the last client stopped streaming
     }
-    
-    // Check for changes in joystick 2
-    if (joy1State != m_lastJoy1State || trig1 != m_lastTrig1) {
-        auto getDirectionInfo = [](int value) -> QPair<QString, int> {
-            const int CENTER = 0x0f ^ 0xff;
-            const int UP = 0x0e ^ 0xff;
-            const int DOWN = 0x0d ^ 0xff;
-            const int LEFT = 0x0b ^ 0xff;
-            const int RIGHT = 0x07 ^ 0xff;
-            const int UP_LEFT = 0x0a ^ 0xff;
-            const int UP_RIGHT = 0x06 ^ 0xff;
-            const int DOWN_LEFT = 0x09 ^ 0xff;
-            const int DOWN_RIGHT = 0x05 ^ 0xff;
-            
-            if (value == CENTER) return qMakePair(QString("CENTER"), 15);
-            else if (value == UP) return qMakePair(QString("UP"), 14);
-            else if (value == DOWN) return qMakePair(QString("DOWN"), 13);
-            else if (value == LEFT) return qMakePair(QString("LEFT"), 11);
-            else if (value == RIGHT) return qMakePair(QString("RIGHT"), 7);
-            else if (value == UP_LEFT) return qMakePair(QString("UP_LEFT"), 10);
-            else if (value == UP_RIGHT) return qMakePair(QString("UP_RIGHT"), 6);
-            else if (value == DOWN_LEFT) return qMakePair(QString("DOWN_LEFT"), 9);
-            else if (value == DOWN_RIGHT) return qMakePair(QString("DOWN_RIGHT"), 5);
-            else return qMakePair(QString("UNKNOWN"), -1);
-        };
-        
-        auto dirInfo = getDirectionInfo(joy1State);
-        auto prevDirInfo = getDirectionInfo(m_lastJoy1State);
-        
-        QJsonObject data;
-        data["player"] = 2;
-        data["direction"] = dirInfo.first;
-        data["direction_value"] = joy1State;
-        data["fire"] = trig1;
-        data["previous_direction"] = prevDirInfo.first;
-        data["previous_fire"] = m_lastTrig1;
-        data["timestamp"] = QDateTime::currentMSecsSinceEpoch();
-        
-        // Send to all subscribed clients
-        for (QTcpSocket* client : m_joystickStreamClients) {
-            sendEvent(client, "joystick_changed", data);
-        }
-        
-        m_lastJoy1State = joy1State;
-        m_lastTrig1 = trig1;
+    QJsonObject event;
+    event["type"] = "event";
+    event["event"] = eventType;
+    event["data"] = data;
+    m_hub->broadcastEvent(m_joystickStreamClients.values().toVector(), eventType, event);
+}
+
+void TCPServer::onJoystickInputChanged(quint64 frame, int port, int direction, bool fire,
+                                       int previousDirection, bool previousFire)
+{
+    QJsonObject data;
+    data["player"] = port;
+    data["direction"] = AtariEmulator::joystickDirectionName(direction);
+    data["direction_value"] = direction;
+    data["fire"] = fire;
+    data["previous_direction"] = AtariEmulator::joystickDirectionName(previousDirection);
+    data["previous_direction_value"] = previousDirection;
+    data["previous_fire"] = previousFire;
+    data["frame"] = static_cast<qint64>(frame);
+    data["timestamp"] = QDateTime::currentMSecsSinceEpoch();
+    sendToJoystickStreamClients("joystick_changed", data);
+}
+
+void TCPServer::onConsoleInputChanged(quint64 frame, int keys, int previousKeys)
+{
+    QJsonObject data;
+    data["start"] = (keys & AtariEmulator::ConsoleStart) != 0;
+    data["select"] = (keys & AtariEmulator::ConsoleSelect) != 0;
+    data["option"] = (keys & AtariEmulator::ConsoleOption) != 0;
+    data["previous_start"] = (previousKeys & AtariEmulator::ConsoleStart) != 0;
+    data["previous_select"] = (previousKeys & AtariEmulator::ConsoleSelect) != 0;
+    data["previous_option"] = (previousKeys & AtariEmulator::ConsoleOption) != 0;
+    data["frame"] = static_cast<qint64>(frame);
+    data["timestamp"] = QDateTime::currentMSecsSinceEpoch();
+    sendToJoystickStreamClients("console_changed", data);
+}
+
+void TCPServer::updateScreenTextEvents()
+{
+    if (m_emulator) {
+        m_emulator->setScreenTextEvents(!m_screenTextClients.isEmpty());
+    }
+}
+
+void TCPServer::onScreenTextChanged(quint64 frame, const QStringList& rows)
+{
+    if (m_screenTextClients.isEmpty()) {
+        return;
     }
-}
\ No newline at end of file
+    QJsonObject data;
+    data["frame"] = static_cast<qint64>(frame);
+    data["rows"] = QJsonArray::fromStringList(rows);
+
+    QJsonObject event;
+    event["type"] = "event";
+    event["event"] = "screen_text_changed";
+    event["data"] = data;
+    m_hub->broadcastEvent(m_screenTextClients.values().toVector(), "screen_text_changed", event);
+}
@@ -0,0 +1,272 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "threadscheduling.h"
+
+#include <QStringList>
+#include <QThread>
+#include <thread>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <mmsystem.h>
+#elif defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#include <mach/mach_time.h>
+#include <mach/thread_policy.h>
+#include <pthread.h>
+#include <pthread/qos.h>
+#elif defined(Q_OS_LINUX)
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#if defined(Q_OS_WIN)
+// avrt.dll is loaded on first use, so a missing MMCSS service only costs the priority
+using AvSetMmThreadCharacteristicsFn = HANDLE(WINAPI*)(LPCWSTR, LPDWORD);
+using AvRevertMmThreadCharacteristicsFn = BOOL(WINAPI*)(HANDLE);
+using AvSetMmThreadPriorityFn = BOOL(WINAPI*)(HANDLE, int);
+constexpr int kAvrtPriorityHigh = 1;      // AVRT_PRIORITY_HIGH
+constexpr int kAvrtPriorityCritical = 2;  // AVRT_PRIORITY_CRITICAL
+
+struct Avrt {
+    AvSetMmThreadCharacteristicsFn setCharacteristics = nullptr;
+    AvRevertMmThreadCharacteristicsFn revert = nullptr;
+    AvSetMmThreadPriorityFn setPriority = nullptr;
+
+    Avrt()
+    {
+        if (HMODULE module = LoadLibraryW(L"avrt.dll")) {
+            setCharacteristics = reinterpret_cast<AvSetMmThreadCharacteristicsFn>(
+                reinterpret_cast<void*>(GetProcAddress(module, "AvSetMmThreadCharacteristicsW")));
+            revert = reinterpret_cast<AvRevertMmThreadCharacteristicsFn>(
+                reinterpret_cast<void*>(GetProcAddress(module, "AvRevertMmThreadCharacteristics")));
+            setPriority = reinterpret_cast<AvSetMmThreadPriorityFn>(
+                reinterpret_cast<void*>(GetProcAddress(module, "AvSetMmThreadPriority")));
+        }
+    }
+};
+
+const Avrt& avrt()
+{
+    static const Avrt instance;
+    return instance;
+}
+
+thread_local HANDLE t_mmcssTask = nullptr;
+#endif
+
+}  // namespace
+
+bool ThreadScheduling::parsePriority(const QString& name, Priority* priority)
+{
+    if (name == "normal") {
+        *priority = PriorityNormal;
+    } else if (name == "high") {
+        *priority = PriorityHigh;
+    } else if (name == "realtime") {
+        *priority = PriorityRealtime;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QString ThreadScheduling::priorityName(Priority priority)
+{
+    switch (priority) {
+    case PriorityHigh:
+        return "high";
+    case PriorityRealtime:
+        return "realtime";
+    default:
+        return "normal";
+    }
+}
+
+QJsonObject ThreadScheduling::applyToCurrentThread(Priority priority, int cpu, int periodUs)
+{
+    QJsonObject result;
+    result["priority"] = priorityName(priority);
+    QStringList errors;
+    Priority granted = PriorityNormal;
+    QString scheduler;
+
+#if defined(Q_OS_WIN)
+    const Avrt& api = avrt();
+    if (t_mmcssTask && api.revert) {
+        api.revert(t_mmcssTask);
+        t_mmcssTask = nullptr;
+    }
+    if (priority != PriorityNormal) {
+        DWORD taskIndex = 0;
+        t_mmcssTask = api.setCharacteristics ? api.setCharacteristics(L"Games", &taskIndex) : nullptr;
+        if (t_mmcssTask) {
+            const bool critical = priority == PriorityRealtime;
+            if (api.setPriority) {
+                api.setPriority(t_mmcssTask, critical ? kAvrtPriorityCritical : kAvrtPriorityHigh);
+            }
+            granted = priority;
+            scheduler = critical ? "MMCSS Games (critical)" : "MMCSS Games";
+        } else if (SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST)) {
+            errors << QString("MMCSS unavailable (error %1)").arg(GetLastError());
+            granted = PriorityHigh;
+            scheduler = "THREAD_PRIORITY_HIGHEST";
+        } else {
+            errors << QString("SetThreadPriority failed (error %1)").arg(GetLastError());
+        }
+    }
+    if (granted == PriorityNormal) {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_NORMAL);
+        scheduler = "THREAD_PRIORITY_NORMAL";
+    }
+
+    DWORD_PTR processMask = 0;
+    DWORD_PTR systemMask = 0;
+    GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask);
+    const DWORD_PTR mask = cpu >= 0 ? (DWORD_PTR(1) << cpu) : processMask;
+    result["affinity_applied"] = cpu < static_cast<int>(sizeof(DWORD_PTR) * 8) && (mask & processMask) &&
+                                 SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(Q_OS_MACOS)
+    if (priority == PriorityRealtime && periodUs > 0) {
+        // Frame period, with up to half of it computing and the whole of it as constraint
+        mach_timebase_info_data_t timebase;
+        mach_timebase_info(&timebase);
+        const double ticksPerUs = 1000.0 * timebase.denom / timebase.numer;
+        thread_time_constraint_policy_data_t policy;
+        policy.period = static_cast<uint32_t>(periodUs * ticksPerUs);
+        policy.computation = static_cast<uint32_t>(periodUs * ticksPerUs / 2);
+        policy.constraint = policy.period;
+        policy.preemptible = TRUE;
+        const kern_return_t status = thread_policy_set(
+            pthread_mach_thread_np(pthread_self()), THREAD_TIME_CONSTRAINT_POLICY,
+            reinterpret_cast<thread_policy_t>(&policy), THREAD_TIME_CONSTRAINT_POLICY_COUNT);
+        if (status == KERN_SUCCESS) {
+            granted = PriorityRealtime;
+            scheduler = "THREAD_TIME_CONSTRAINT_POLICY";
+        } else {
+            errors << QString("time-constraint policy refused (%1)").arg(status);
+        }
+    }
+    if (granted == PriorityNormal) {
+        // QoS can only be raised or lowered for the calling thread, which is the case here
+        const bool high = priority != PriorityNormal;
+        if (pthread_set_qos_class_self_np(high ? QOS_CLASS_USER_INTERACTIVE : QOS_CLASS_DEFAULT, 0) == 0) {
+            granted = high ? PriorityHigh : PriorityNormal;
+            scheduler = high ? "QOS_CLASS_USER_INTERACTIVE" : "QOS_CLASS_DEFAULT";
+        } else {
+            errors << "QoS class refused";
+        }
+    }
+    result["affinity_applied"] = false;
+    if (cpu >= 0) {
+        errors << "CPU affinity is not supported on macOS";
+    }
+#elif defined(Q_OS_LINUX)
+    Q_UNUSED(periodUs)
+    const pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    if (priority == PriorityRealtime) {
+        for (int policy : {SCHED_FIFO, SCHED_RR}) {
+            sched_param param;
+            param.sched_priority = sched_get_priority_min(policy) + 10;
+            const int error = pthread_setschedparam(pthread_self(), policy, &param);
+            if (error == 0) {
+                granted = PriorityRealtime;
+                scheduler = policy == SCHED_FIFO ? "SCHED_FIFO" : "SCHED_RR";
+                break;
+            }
+            errors << QString("%1: %2").arg(policy == SCHED_FIFO ? "SCHED_FIFO" : "SCHED_RR",
+                                             QString::fromLocal8Bit(std::strerror(error)));
+        }
+    }
+    if (granted != PriorityRealtime) {
+        sched_param param;
+        param.sched_priority = 0;
+        pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+        // On Linux nice values are per thread when set through the thread id
+        const int nice = priority == PriorityNormal ? 0 : -10;
+        if (setpriority(PRIO_PROCESS, static_cast<id_t>(tid), nice) == 0) {
+            granted = nice < 0 ? PriorityHigh : PriorityNormal;
+        } else {
+            errors << QString("nice %1: %2").arg(nice).arg(QString::fromLocal8Bit(std::strerror(errno)));
+        }
+        scheduler = granted == PriorityHigh ? "SCHED_OTHER nice -10" : "SCHED_OTHER";
+    }
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, &cpus);
+    } else {
+        for (int i = 0; i < cpuCount() && i < CPU_SETSIZE; ++i) {
+            CPU_SET(i, &cpus);
+        }
+    }
+    const int affinityError = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    result["affinity_applied"] = affinityError == 0;
+    if (affinityError != 0) {
+        errors << QString("affinity: %1").arg(QString::fromLocal8Bit(std::strerror(affinityError)));
+    }
+#else
+    Q_UNUSED(periodUs)
+    result["affinity_applied"] = false;
+    if (priority != PriorityNormal || cpu >= 0) {
+        errors << "thread scheduling is not supported on this platform";
+    }
+#endif
+
+    result["granted"] = priorityName(granted);
+    result["scheduler"] = scheduler;
+    result["cpu"] = cpu;
+    if (!errors.isEmpty()) {
+        result["error"] = errors.join("; ");
+    }
+    return result;
+}
+
+void ThreadScheduling::setHighResolutionTimer(bool enabled)
+{
+#if defined(Q_OS_WIN)
+    static bool active = false;
+    if (enabled != active) {
+        if (enabled) {
+            timeBeginPeriod(1);
+        } else {
+            timeEndPeriod(1);
+        }
+        active = enabled;
+    }
+#else
+    Q_UNUSED(enabled)
+#endif
+}
+
+void ThreadScheduling::waitUntil(std::chrono::steady_clock::time_point deadline, int spinUs)
+{
+    using namespace std::chrono;
+    // Sleeps can overshoot by a scheduler tick, so stop sleeping early and spin the rest
+    const microseconds spin(qMax(0, spinUs));
+    for (auto remaining = deadline - steady_clock::now(); remaining > spin;
+         remaining = deadline - steady_clock::now()) {
+        std::this_thread::sleep_for(remaining - spin);
+    }
+    while (steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+int ThreadScheduling::cpuCount()
+{
+    return qMax(1, QThread::idealThreadCount());
+}
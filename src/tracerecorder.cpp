@@ -0,0 +1,390 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "tracerecorder.h"
+#include "disasm6502.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const char kFileMagic[8] = {'F', 'J', 'T', 'R', 'A', 'C', 'E', '1'};
+const quint32 kChunkMagic = 0x4B435254;  // "TRCK"
+const quint32 kWrapMagic = 0x50415257;   // "WRAP"
+
+enum RecordFlag : unsigned char {
+    FlagPC = 0x01,
+    FlagA = 0x02,
+    FlagX = 0x04,
+    FlagY = 0x08,
+    FlagS = 0x10,
+    FlagP = 0x20,
+    FlagNextScanline = 0x40,
+    FlagScanline = 0x80,
+    FlagsFull = FlagPC | FlagA | FlagX | FlagY | FlagS | FlagP | FlagScanline
+};
+
+void put16(unsigned char* p, quint16 value)
+{
+    p[0] = static_cast<unsigned char>(value);
+    p[1] = static_cast<unsigned char>(value >> 8);
+}
+
+void put32(unsigned char* p, quint32 value)
+{
+    put16(p, static_cast<quint16>(value));
+    put16(p + 2, static_cast<quint16>(value >> 16));
+}
+
+void put64(unsigned char* p, quint64 value)
+{
+    put32(p, static_cast<quint32>(value));
+    put32(p + 4, static_cast<quint32>(value >> 32));
+}
+
+quint16 get16(const unsigned char* p)
+{
+    return static_cast<quint16>(p[0] | (p[1] << 8));
+}
+
+quint32 get32(const unsigned char* p)
+{
+    return get16(p) | (static_cast<quint32>(get16(p + 2)) << 16);
+}
+
+quint64 get64(const unsigned char* p)
+{
+    return get32(p) | (static_cast<quint64>(get32(p + 4)) << 32);
+}
+
+quint16 nextPC(const TraceRecorder::RawRecord& record)
+{
+    return static_cast<quint16>(record.pc + opcodeInfo6502(record.opcode).bytes);
+}
+
+}  // namespace
+
+TraceRecorder::TraceRecorder() = default;
+
+TraceRecorder::~TraceRecorder()
+{
+    stop();
+    if (m_map) {
+        m_file.unmap(m_map);
+    }
+}
+
+bool TraceRecorder::start(const QString& path, qint64 ringBytes, QString* error)
+{
+    stop();
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+        m_ring = nullptr;
+    }
+    m_file.close();
+    m_chunks.clear();
+
+    ringBytes = std::max(ringBytes, qint64(kMinRingBytes));
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate) ||
+        !m_file.resize(kHeaderBytes + ringBytes)) {
+        if (error) {
+            *error = QString("Cannot create trace file %1: %2").arg(path, m_file.errorString());
+        }
+        m_file.close();
+        return false;
+    }
+    m_map = m_file.map(0, kHeaderBytes + ringBytes);
+    if (!m_map) {
+        if (error) {
+            *error = QString("Cannot map trace file %1: %2").arg(path, m_file.errorString());
+        }
+        m_file.close();
+        return false;
+    }
+
+    m_ring = m_map + kHeaderBytes;
+    m_ringBytes = ringBytes;
+    m_writeOffset = 0;
+    m_wrapped = false;
+    m_records = 0;
+    m_dropped = 0;
+    m_path = path;
+    m_recording = true;
+    writeHeader();
+    return true;
+}
+
+void TraceRecorder::stop()
+{
+    if (!m_recording) {
+        return;
+    }
+    m_recording = false;
+    writeHeader();
+}
+
+void TraceRecorder::append(quint64 frame, const RawRecord* records, int count, int dropped)
+{
+    if (!m_recording) {
+        return;
+    }
+    m_dropped += static_cast<quint64>(std::max(0, dropped));
+    for (int done = 0; done < count; done += kMaxChunkRecords) {
+        appendChunk(frame, records + done, std::min(count - done, int(kMaxChunkRecords)));
+    }
+    writeHeader();
+}
+
+void TraceRecorder::appendChunk(quint64 frame, const RawRecord* records, int count)
+{
+    m_scratch.resize(static_cast<size_t>(kChunkHeaderBytes + maxEncodedBytes(count)));
+    const int payload = encode(records, count, m_scratch.data() + kChunkHeaderBytes);
+    const int bytes = kChunkHeaderBytes + payload;
+    put32(m_scratch.data(), kChunkMagic);
+    put32(m_scratch.data() + 4, static_cast<quint32>(payload));
+    put64(m_scratch.data() + 8, frame);
+    put32(m_scratch.data() + 16, static_cast<quint32>(count));
+
+    if (m_writeOffset + bytes > m_ringBytes) {
+        // The few oldest chunks between here and the end go with the wrap
+        while (!m_chunks.empty() && m_chunks.front().offset >= m_writeOffset) {
+            m_chunks.pop_front();
+        }
+        if (m_ringBytes - m_writeOffset >= 4) {
+            put32(m_ring + m_writeOffset, kWrapMagic);
+        }
+        m_writeOffset = 0;
+        m_wrapped = true;
+    }
+    while (!m_chunks.empty() && m_chunks.front().offset >= m_writeOffset &&
+           m_chunks.front().offset < m_writeOffset + bytes) {
+        m_chunks.pop_front();
+    }
+
+    std::memcpy(m_ring + m_writeOffset, m_scratch.data(), static_cast<size_t>(bytes));
+    m_chunks.push_back(Chunk{m_writeOffset, bytes, count, frame});
+    m_writeOffset += bytes;
+    m_records += static_cast<quint64>(count);
+}
+
+void TraceRecorder::writeHeader()
+{
+    if (!m_map) {
+        return;
+    }
+    quint32 flags = 0;
+    if (m_recording) {
+        flags |= kFlagRecording;
+    }
+    if (m_wrapped) {
+        flags |= kFlagWrapped;
+    }
+    std::memcpy(m_map, kFileMagic, sizeof(kFileMagic));
+    put32(m_map + 8, kVersion);
+    put32(m_map + 12, kHeaderBytes);
+    put64(m_map + 16, static_cast<quint64>(m_ringBytes));
+    put64(m_map + 24, static_cast<quint64>(m_chunks.empty() ? m_writeOffset : m_chunks.front().offset));
+    put64(m_map + 32, static_cast<quint64>(m_writeOffset));
+    put64(m_map + 40, m_records);
+    put64(m_map + 48, m_dropped);
+    put32(m_map + 56, flags);
+    put32(m_map + 60, static_cast<quint32>(m_chunks.size()));
+}
+
+QVector<TraceRecorder::Entry> TraceRecorder::tail(int count) const
+{
+    QVector<Entry> entries;
+    if (!m_map || count <= 0) {
+        return entries;
+    }
+    // Newest chunks first, then reverse into order
+    std::vector<RawRecord> decoded;
+    for (auto it = m_chunks.rbegin(); it != m_chunks.rend() && entries.size() < count; ++it) {
+        decoded.resize(static_cast<size_t>(it->records));
+        if (!decode(m_ring + it->offset + kChunkHeaderBytes, it->bytes - kChunkHeaderBytes,
+                    it->records, decoded.data())) {
+            break;
+        }
+        for (int i = it->records - 1; i >= 0 && entries.size() < count; --i) {
+            entries.append(Entry{it->frame, decoded[static_cast<size_t>(i)]});
+        }
+    }
+    std::reverse(entries.begin(), entries.end());
+    return entries;
+}
+
+QJsonObject TraceRecorder::status() const
+{
+    qint64 usedBytes = 0;
+    qint64 retained = 0;
+    for (const Chunk& chunk : m_chunks) {
+        usedBytes += chunk.bytes;
+        retained += chunk.records;
+    }
+    QJsonObject status;
+    status["recording"] = m_recording;
+    status["path"] = m_path;
+    status["ring_bytes"] = m_ringBytes;
+    status["used_bytes"] = usedBytes;
+    status["records"] = static_cast<qint64>(m_records);
+    status["retained_records"] = retained;
+    status["dropped"] = static_cast<qint64>(m_dropped);
+    status["chunks"] = static_cast<int>(m_chunks.size());
+    status["wrapped"] = m_wrapped;
+    status["bytes_per_record"] = retained > 0 ? double(usedBytes) / double(retained) : 0.0;
+    return status;
+}
+
+int TraceRecorder::encode(const RawRecord* records, int count, unsigned char* out)
+{
+    unsigned char* p = out;
+    for (int i = 0; i < count; ++i) {
+        const RawRecord& record = records[i];
+        unsigned char flags = FlagsFull;
+        if (i > 0) {
+            const RawRecord& previous = records[i - 1];
+            flags = 0;
+            if (record.pc != nextPC(previous)) {
+                flags |= FlagPC;
+            }
+            if (record.a != previous.a) {
+                flags |= FlagA;
+            }
+            if (record.x != previous.x) {
+                flags |= FlagX;
+            }
+            if (record.y != previous.y) {
+                flags |= FlagY;
+            }
+            if (record.s != previous.s) {
+                flags |= FlagS;
+            }
+            if (record.p != previous.p) {
+                flags |= FlagP;
+            }
+            if (record.scanline == static_cast<quint16>(previous.scanline + 1)) {
+                flags |= FlagNextScanline;
+            } else if (record.scanline != previous.scanline) {
+                flags |= FlagScanline;
+            }
+        }
+        *p++ = flags;
+        if (flags & FlagPC) {
+            put16(p, record.pc);
+            p += 2;
+        }
+        if (flags & FlagA) *p++ = record.a;
+        if (flags & FlagX) *p++ = record.x;
+        if (flags & FlagY) *p++ = record.y;
+        if (flags & FlagS) *p++ = record.s;
+        if (flags & FlagP) *p++ = record.p;
+        if (flags & FlagScanline) {
+            put16(p, record.scanline);
+            p += 2;
+        }
+        *p++ = record.opcode;
+        *p++ = record.cycle;
+    }
+    return static_cast<int>(p - out);
+}
+
+bool TraceRecorder::decode(const unsigned char* data, int bytes, int count, RawRecord* out)
+{
+    const unsigned char* p = data;
+    const unsigned char* end = data + bytes;
+    RawRecord record = {};
+    for (int i = 0; i < count; ++i) {
+        if (p >= end) {
+            return false;
+        }
+        const unsigned char flags = *p++;
+        const int fieldBytes = ((flags & FlagPC) ? 2 : 0) + ((flags & FlagA) ? 1 : 0) +
+                               ((flags & FlagX) ? 1 : 0) + ((flags & FlagY) ? 1 : 0) +
+                               ((flags & FlagS) ? 1 : 0) + ((flags & FlagP) ? 1 : 0) +
+                               ((flags & FlagScanline) ? 2 : 0) + 2;
+        if (end - p < fieldBytes || (i == 0 && flags != FlagsFull)) {
+            return false;
+        }
+        const quint16 predictedPC = nextPC(record);
+        if (flags & FlagPC) {
+            record.pc = get16(p);
+            p += 2;
+        } else {
+            record.pc = predictedPC;
+        }
+        if (flags & FlagA) record.a = *p++;
+        if (flags & FlagX) record.x = *p++;
+        if (flags & FlagY) record.y = *p++;
+        if (flags & FlagS) record.s = *p++;
+        if (flags & FlagP) record.p = *p++;
+        if (flags & FlagScanline) {
+            record.scanline = get16(p);
+            p += 2;
+        } else if (flags & FlagNextScanline) {
+            record.scanline++;
+        }
+        record.opcode = *p++;
+        record.cycle = *p++;
+        out[i] = record;
+    }
+    return true;
+}
+
+bool TraceRecorder::readFile(const QString& path, QVector<Entry>* entries, QString* error)
+{
+    auto fail = [error](const QString& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(QString("Cannot open trace file %1: %2").arg(path, file.errorString()));
+    }
+    const QByteArray contents = file.readAll();
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(contents.constData());
+    if (contents.size() < kHeaderBytes || std::memcmp(data, kFileMagic, sizeof(kFileMagic)) != 0 ||
+        get32(data + 8) != kVersion || get32(data + 12) != quint32(kHeaderBytes)) {
+        return fail(QString("Not a Fujisan trace file: %1").arg(path));
+    }
+    const qint64 ringBytes = static_cast<qint64>(get64(data + 16));
+    qint64 offset = static_cast<qint64>(get64(data + 24));
+    const quint32 chunks = get32(data + 60);
+    if (ringBytes != contents.size() - kHeaderBytes || offset > ringBytes) {
+        return fail(QString("Truncated trace file: %1").arg(path));
+    }
+
+    const unsigned char* ring = data + kHeaderBytes;
+    entries->clear();
+    std::vector<RawRecord> decoded;
+    for (quint32 i = 0; i < chunks; ++i) {
+        if (ringBytes - offset < 4 || get32(ring + offset) == kWrapMagic) {
+            offset = 0;
+        }
+        if (ringBytes - offset < kChunkHeaderBytes || get32(ring + offset) != kChunkMagic) {
+            return fail(QString("Corrupt trace chunk at offset %1 in %2").arg(offset).arg(path));
+        }
+        const int payload = static_cast<int>(get32(ring + offset + 4));
+        const quint64 frame = get64(ring + offset + 8);
+        const int records = static_cast<int>(get32(ring + offset + 16));
+        decoded.resize(static_cast<size_t>(std::max(0, records)));
+        if (payload < 0 || records < 0 || ringBytes - offset - kChunkHeaderBytes < payload ||
+            !decode(ring + offset + kChunkHeaderBytes, payload, records, decoded.data())) {
+            return fail(QString("Corrupt trace chunk at offset %1 in %2").arg(offset).arg(path));
+        }
+        for (const RawRecord& record : decoded) {
+            entries->append(Entry{frame, record});
+        }
+        offset += kChunkHeaderBytes + payload;
+    }
+    return true;
+}
@@ -4,11 +4,13 @@
  */
 
 #include "../include/unifiedaudiobackend.h"
+#include "../include/audiokernels.h"
 #include <QDebug>
 #include <QDateTime>
 #include <cstring>
 #include <algorithm>
 #include <cmath>
+#include <chrono>
 
 UnifiedAudioBackend::UnifiedAudioBackend(QObject *parent)
     : QObject(parent)
@@ -21,8 +23,16 @@ UnifiedAudioBackend::UnifiedAudioBackend(QObject *parent)
     , m_frameSize(4)
     , m_volume(1.0f)
     , m_resampleRatio(1.0f)
-    , m_resamplePhase(0.0f)
+    , m_resamplerQuality(AudioResampler::Sinc)
+    , m_resampling(false)
     , m_tempResampleBufferSize(0)
+    , m_driftCompensation(true)
+    , m_rateAdjustment(1.0)
+    , m_smoothedFillBytes(0.0)
+    , m_spaceAvailable(nullptr)
+    , m_spaceWaiter(false)
+    , m_outputBufferSize(0)
+    , m_scratchSize(0)
     , m_underrunCount(0)
     , m_overrunCount(0)
     , m_totalFramesProcessed(0)
@@ -41,11 +51,15 @@ UnifiedAudioBackend::UnifiedAudioBackend(QObject *parent)
             qWarning() << "Failed to initialize SDL audio:" << SDL_GetError();
         }
     }
+    m_spaceAvailable = SDL_CreateSemaphore(0);
 }
 
 UnifiedAudioBackend::~UnifiedAudioBackend()
 {
     shutdown();
+    if (m_spaceAvailable) {
+        SDL_DestroySemaphore(m_spaceAvailable);
+    }
 }
 
 bool UnifiedAudioBackend::initialize(int targetSampleRate, int channels, int sampleSize)
@@ -104,9 +118,23 @@ bool UnifiedAudioBackend::initialize(int targetSampleRate, int channels, int sam
     // Calculate resampling ratio
     m_resampleRatio = static_cast<float>(m_actualSampleRate) / static_cast<float>(m_targetSampleRate);
 
-    // Allocate resampling buffer
-    m_tempResampleBufferSize = (obtained.samples * m_channels * 2);  // Extra space for resampling
+    // The resampler also runs at equal rates when drift compensation is on, so
+    // the two clocks can be kept apart without trimming the frame timing
+    m_resampler.configure(m_channels, 1.0 / m_resampleRatio, obtained.samples, m_resamplerQuality);
+    m_resampling = std::abs(m_resampleRatio - 1.0f) > 0.001f || m_driftCompensation.load();
+    m_rateAdjustment.store(1.0);
+    m_smoothedFillBytes = 0.0;
+
+    // Allocate the callback's work buffers once. The mix runs at the emulator's
+    // rate, so it needs room for the most input one device buffer can consume.
+    const int sourceFrames = m_resampler.maxInputFrames(obtained.samples);
+    m_tempResampleBufferSize = std::max(sourceFrames, static_cast<int>(obtained.samples)) * m_channels;
     m_tempResampleBuffer = std::make_unique<float[]>(m_tempResampleBufferSize);
+    m_outputBufferSize = obtained.samples * m_channels;
+    m_outputBuffer = std::make_unique<float[]>(m_outputBufferSize);
+    m_scratchSize = (m_tempResampleBufferSize / m_channels) * m_frameSize;
+    m_highPriorityScratch = std::make_unique<unsigned char[]>(m_scratchSize);
+    m_lowPriorityScratch = std::make_unique<unsigned char[]>(m_scratchSize);
 
     // Calculate actual latency
     float actualLatencyMs = (static_cast<float>(obtained.samples) * 1000.0f) / static_cast<float>(m_actualSampleRate);
@@ -119,7 +147,9 @@ bool UnifiedAudioBackend::initialize(int targetSampleRate, int channels, int sam
     qDebug() << "  Sample size:" << m_sampleSize << "bytes";
     qDebug() << "  Buffer samples:" << obtained.samples;
     qDebug() << "  Actual latency:" << actualLatencyMs << "ms";
-    qDebug() << "  Resample ratio:" << m_resampleRatio;
+    qDebug() << "  Resample ratio:" << m_resampleRatio
+             << (m_resamplerQuality == AudioResampler::Sinc ? "(sinc)" : "(linear)");
+    qDebug() << "  Sample kernels:" << AudioKernels::instructionSet();
 
     // Reset statistics
     resetStats();
@@ -179,14 +209,45 @@ float UnifiedAudioBackend::getBufferFillPercent() const
     if (!m_initialized) return 0.0f;
 
     // Calculate combined buffer fill level
-    int lowPriorityFill = m_lowPriorityBuffer.size.load();
-    int highPriorityFill = m_highPriorityBuffer.size.load();
+    int lowPriorityFill = m_lowPriorityBuffer.available();
+    int highPriorityFill = m_highPriorityBuffer.available();
     int totalFill = lowPriorityFill + highPriorityFill;
     int totalCapacity = RING_BUFFER_SIZE * 2;  // Both buffers
 
     return (static_cast<float>(totalFill) / static_cast<float>(totalCapacity)) * 100.0f;
 }
 
+int UnifiedAudioBackend::targetQueuedBytes() const
+{
+    const int deviceFrames = m_channels > 0 ? m_outputBufferSize / m_channels : 0;
+    const int sourceFrames = static_cast<int>(2.0 * deviceFrames / m_resampleRatio);
+    return std::max(1, sourceFrames) * m_frameSize;
+}
+
+bool UnifiedAudioBackend::waitForQueuedBelow(int maxBytes, int timeoutMs)
+{
+    if (!m_initialized || !m_spaceAvailable) {
+        return false;
+    }
+
+    using namespace std::chrono;
+    const auto deadline = steady_clock::now() + milliseconds(timeoutMs);
+    m_spaceWaiter.store(true, std::memory_order_release);
+    bool drained = true;
+    while (m_lowPriorityBuffer.available() > maxBytes) {
+        const auto remaining = duration_cast<milliseconds>(deadline - steady_clock::now()).count();
+        if (remaining <= 0 || SDL_SemWaitTimeout(m_spaceAvailable, static_cast<Uint32>(remaining)) != 0) {
+            drained = m_lowPriorityBuffer.available() <= maxBytes;
+            break;
+        }
+    }
+    m_spaceWaiter.store(false, std::memory_order_release);
+    // Posts that raced with the last check would wake the next wait early
+    while (SDL_SemTryWait(m_spaceAvailable) == 0) {
+    }
+    return drained;
+}
+
 void UnifiedAudioBackend::resetStats()
 {
     m_underrunCount.store(0);
@@ -211,10 +272,20 @@ void UnifiedAudioBackend::audioCallback(Uint8* stream, int len)
 
     // Calculate destination samples (what SDL wants)
     int destinationSamples = len / (m_sampleSize * m_channels);
+    if (destinationSamples * m_channels > m_outputBufferSize) {
+        // SDL asks for the buffer size it reported; anything larger is clipped
+        destinationSamples = m_outputBufferSize / m_channels;
+    }
     m_totalFramesProcessed.fetch_add(destinationSamples);
+    m_lastCallbackUs.store(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
 
-    // Calculate source samples (what we need from emulator at target rate)
-    int sourceSamples = static_cast<int>(destinationSamples / m_resampleRatio);
+    // Calculate source samples (what we need from emulator at target rate); the
+    // resampler asks for exactly what its carried-over phase needs
+    if (m_resampling) {
+        updateDriftCompensation();
+    }
+    int sourceSamples = m_resampling ? m_resampler.inputFramesNeeded(destinationSamples) : destinationSamples;
     int sourceFloatSamples = sourceSamples * m_channels;
 
     if (sourceFloatSamples > m_tempResampleBufferSize) {
@@ -228,133 +299,56 @@ void UnifiedAudioBackend::audioCallback(Uint8* stream, int len)
 
     // Mix audio channels at emulator's sample rate (source rate)
     mixChannels(m_tempResampleBuffer.get(), sourceSamples);
+    if (m_spaceWaiter.load(std::memory_order_acquire)) {
+        SDL_SemPost(m_spaceAvailable);
+    }
 
-    // Apply resampling if needed
-    std::unique_ptr<float[]> resampledBuffer;
+    // Apply resampling if needed, into the preallocated output buffer
     float* finalBuffer = m_tempResampleBuffer.get();
     int finalSamples = sourceFloatSamples;
 
-    if (std::abs(m_resampleRatio - 1.0f) > 0.001f) {
-        // Need resampling - allocate output buffer
-        int destinationFloatSamples = destinationSamples * m_channels;
-        resampledBuffer = std::make_unique<float[]>(destinationFloatSamples);
-
-        // Simple linear interpolation resampling
-        for (int i = 0; i < destinationFloatSamples; i += m_channels) {
-            float sourcePos = i * m_resampleRatio / m_channels;
-            int sourceIndex = static_cast<int>(sourcePos) * m_channels;
-            float fraction = sourcePos - static_cast<int>(sourcePos);
-
-            for (int ch = 0; ch < m_channels; ch++) {
-                if (sourceIndex + m_channels < sourceFloatSamples) {
-                    // Linear interpolation
-                    float sample1 = m_tempResampleBuffer[sourceIndex + ch];
-                    float sample2 = m_tempResampleBuffer[sourceIndex + m_channels + ch];
-                    resampledBuffer[i + ch] = sample1 + fraction * (sample2 - sample1);
-                } else if (sourceIndex < sourceFloatSamples) {
-                    // Use last available sample
-                    resampledBuffer[i + ch] = m_tempResampleBuffer[sourceIndex + ch];
-                } else {
-                    // Silence for out-of-bounds
-                    resampledBuffer[i + ch] = 0.0f;
-                }
-            }
-        }
-
-        finalBuffer = resampledBuffer.get();
-        finalSamples = destinationFloatSamples;
+    if (m_resampling) {
+        const int produced = m_resampler.process(m_tempResampleBuffer.get(), sourceSamples,
+                                                 m_outputBuffer.get(), destinationSamples);
+        // Only short if the mix bus was clipped; pad with silence
+        std::fill(m_outputBuffer.get() + produced * m_channels,
+                  m_outputBuffer.get() + destinationSamples * m_channels, 0.0f);
+        finalBuffer = m_outputBuffer.get();
+        finalSamples = destinationSamples * m_channels;
     }
 
-    // Apply volume
+    // Volume, clamp and conversion to the device format in one pass
     float volume = m_volume.load();
-    if (volume < 0.99f && volume > 0.01f) {
-        for (int i = 0; i < finalSamples; i++) {
-            finalBuffer[i] *= volume;
-        }
-    } else if (volume <= 0.01f) {
+    if (volume <= 0.01f) {
         // Muted - output is already silence
         return;
+    } else if (volume >= 0.99f) {
+        volume = 1.0f;
     }
 
-    // Convert back to output format
     if (m_sampleSize == 1) {
-        // 8-bit unsigned
-        Uint8* output = stream;
-        for (int i = 0; i < finalSamples; i++) {
-            float sample = finalBuffer[i];
-            sample = std::max(-1.0f, std::min(1.0f, sample));  // Clamp
-            output[i] = static_cast<Uint8>((sample + 1.0f) * 127.5f);
-        }
+        AudioKernels::scaleToU8(finalBuffer, stream, finalSamples, volume);
     } else if (m_sampleSize == 2) {
-        // 16-bit signed
-        Sint16* output = reinterpret_cast<Sint16*>(stream);
-        for (int i = 0; i < finalSamples; i++) {
-            float sample = finalBuffer[i];
-            sample = std::max(-1.0f, std::min(1.0f, sample));  // Clamp
-            output[i] = static_cast<Sint16>(sample * 32767.0f);
-        }
+        AudioKernels::scaleToS16(finalBuffer, reinterpret_cast<qint16*>(stream), finalSamples, volume);
     }
 }
 
 void UnifiedAudioBackend::mixChannels(float* output, int frames)
 {
+    const int maxBytes = std::min(m_scratchSize, frames * m_frameSize);
+
     // Read from high priority buffer first (beeps, UI sounds)
-    unsigned char highPriorityData[8192];  // Stack buffer for real-time safety
-    int highPriorityBytes = readFromRingBuffer(highPriorityData,
-                                               std::min(static_cast<int>(sizeof(highPriorityData)),
-                                                       frames * m_frameSize),
-                                               HIGH_PRIORITY);
+    int highPriorityBytes = readFromRingBuffer(m_highPriorityScratch.get(), maxBytes, HIGH_PRIORITY);
 
     // Read from low priority buffer (background audio)
-    unsigned char lowPriorityData[8192];
-    int lowPriorityBytes = readFromRingBuffer(lowPriorityData,
-                                              std::min(static_cast<int>(sizeof(lowPriorityData)),
-                                                      frames * m_frameSize),
-                                              LOW_PRIORITY);
+    int lowPriorityBytes = readFromRingBuffer(m_lowPriorityScratch.get(), maxBytes, LOW_PRIORITY);
 
     // Convert and mix high priority audio
-    if (highPriorityBytes > 0) {
-        int highPriorityFrames = highPriorityBytes / m_frameSize;
-        for (int frame = 0; frame < std::min(highPriorityFrames, frames); frame++) {
-            for (int ch = 0; ch < m_channels; ch++) {
-                int sampleIndex = frame * m_channels + ch;
-                int byteIndex = frame * m_frameSize + ch * m_sampleSize;
-
-                float sample = 0.0f;
-                if (m_sampleSize == 1) {
-                    sample = (static_cast<float>(highPriorityData[byteIndex]) - 128.0f) / 128.0f;
-                } else if (m_sampleSize == 2) {
-                    Sint16 sample16 = *reinterpret_cast<Sint16*>(&highPriorityData[byteIndex]);
-                    sample = static_cast<float>(sample16) / 32768.0f;
-                }
-
-                output[sampleIndex] += sample;
-            }
-        }
-    }
+    mixInto(m_highPriorityScratch.get(), highPriorityBytes, output, frames, 1.0f);
 
     // Convert and mix low priority audio (attenuated if high priority is present)
-    if (lowPriorityBytes > 0) {
-        int lowPriorityFrames = lowPriorityBytes / m_frameSize;
-        float attenuation = (highPriorityBytes > 0) ? 0.3f : 1.0f;  // Duck background audio
-
-        for (int frame = 0; frame < std::min(lowPriorityFrames, frames); frame++) {
-            for (int ch = 0; ch < m_channels; ch++) {
-                int sampleIndex = frame * m_channels + ch;
-                int byteIndex = frame * m_frameSize + ch * m_sampleSize;
-
-                float sample = 0.0f;
-                if (m_sampleSize == 1) {
-                    sample = (static_cast<float>(lowPriorityData[byteIndex]) - 128.0f) / 128.0f;
-                } else if (m_sampleSize == 2) {
-                    Sint16 sample16 = *reinterpret_cast<Sint16*>(&lowPriorityData[byteIndex]);
-                    sample = static_cast<float>(sample16) / 32768.0f;
-                }
-
-                output[sampleIndex] += sample * attenuation;
-            }
-        }
-    }
+    float attenuation = (highPriorityBytes > 0) ? 0.3f : 1.0f;  // Duck background audio
+    mixInto(m_lowPriorityScratch.get(), lowPriorityBytes, output, frames, attenuation);
 
     // Check for underrun and update consecutive counter
     if (highPriorityBytes == 0 && lowPriorityBytes == 0) {
@@ -366,117 +360,59 @@ void UnifiedAudioBackend::mixChannels(float* output, int frames)
     }
 }
 
-bool UnifiedAudioBackend::writeToRingBuffer(const unsigned char* data, int length, AudioPriority priority)
+void UnifiedAudioBackend::mixInto(const unsigned char* data, int bytes, float* output, int frames, float gain)
 {
-    RingBuffer& buffer = (priority == HIGH_PRIORITY) ? m_highPriorityBuffer : m_lowPriorityBuffer;
+    const int samples = std::min(bytes / m_frameSize, frames) * m_channels;
+    if (samples <= 0) {
+        return;
+    }
+    if (m_sampleSize == 1) {
+        AudioKernels::accumulateU8(data, output, samples, gain);
+    } else if (m_sampleSize == 2) {
+        AudioKernels::accumulateS16(reinterpret_cast<const qint16*>(data), output, samples, gain);
+    }
+}
 
-    int writePos = buffer.writePos.load();
-    int readPos = buffer.readPos.load();
-    int currentSize = buffer.size.load();
+bool UnifiedAudioBackend::writeToRingBuffer(const unsigned char* data, int length, AudioPriority priority)
+{
+    AudioRing& buffer = (priority == HIGH_PRIORITY) ? m_highPriorityBuffer : m_lowPriorityBuffer;
 
-    // Check if we have enough space
-    if (currentSize + length > RING_BUFFER_SIZE) {
+    // All or nothing: a partial frame would shift every later sample
+    if (!buffer.write(data, length)) {
         m_overrunCount.fetch_add(1);
         m_consecutiveOverruns.fetch_add(1);
         return false;  // Buffer full
-    } else {
-        // Reset consecutive overruns if we successfully wrote data
-        m_consecutiveOverruns.store(0);
     }
 
-    // Write data (handle wrap-around)
-    int remaining = length;
-    int offset = 0;
-
-    while (remaining > 0) {
-        int chunkSize = std::min(remaining, RING_BUFFER_SIZE - writePos);
-        memcpy(buffer.data.get() + writePos, data + offset, chunkSize);
-
-        writePos = (writePos + chunkSize) % RING_BUFFER_SIZE;
-        offset += chunkSize;
-        remaining -= chunkSize;
-    }
-
-    // Update positions atomically
-    buffer.writePos.store(writePos);
-    buffer.size.fetch_add(length);
-
+    // Reset consecutive overruns if we successfully wrote data
+    m_consecutiveOverruns.store(0);
     return true;
 }
 
 int UnifiedAudioBackend::readFromRingBuffer(unsigned char* data, int maxLength, AudioPriority priority)
 {
-    RingBuffer& buffer = (priority == HIGH_PRIORITY) ? m_highPriorityBuffer : m_lowPriorityBuffer;
-
-    int currentSize = buffer.size.load();
-    int readPos = buffer.readPos.load();
-
-    int toRead = std::min(maxLength, currentSize);
-    if (toRead <= 0) {
-        return 0;
-    }
-
-    // Read data (handle wrap-around)
-    int remaining = toRead;
-    int offset = 0;
-
-    while (remaining > 0) {
-        int chunkSize = std::min(remaining, RING_BUFFER_SIZE - readPos);
-        memcpy(data + offset, buffer.data.get() + readPos, chunkSize);
-
-        readPos = (readPos + chunkSize) % RING_BUFFER_SIZE;
-        offset += chunkSize;
-        remaining -= chunkSize;
-    }
-
-    // Update positions atomically
-    buffer.readPos.store(readPos);
-    buffer.size.fetch_sub(toRead);
-
-    return toRead;
-}
-
-void UnifiedAudioBackend::resample(const float* input, int inputFrames, float* output, int outputFrames, int channels)
-{
-    // Use linear interpolation for high-quality resampling
-    resampleLinear(input, inputFrames, output, outputFrames, channels);
+    AudioRing& buffer = (priority == HIGH_PRIORITY) ? m_highPriorityBuffer : m_lowPriorityBuffer;
+    return buffer.read(data, maxLength);
 }
 
-void UnifiedAudioBackend::resampleLinear(const float* input, int inputFrames, float* output, int outputFrames, int channels)
+void UnifiedAudioBackend::updateDriftCompensation()
 {
-    if (!input || !output || inputFrames <= 0 || outputFrames <= 0 || channels <= 0) {
+    const double nominal = 1.0 / m_resampleRatio;
+    if (!m_driftCompensation.load()) {
+        m_resampler.setRatio(nominal * m_rateAdjustment.load());
         return;
     }
 
-    float ratio = static_cast<float>(inputFrames) / static_cast<float>(outputFrames);
-
-    for (int outFrame = 0; outFrame < outputFrames; outFrame++) {
-        float srcPos = static_cast<float>(outFrame) * ratio;
-        int srcFrame = static_cast<int>(srcPos);
-        float frac = srcPos - static_cast<float>(srcFrame);
-
-        // Ensure we don't read past the end
-        if (srcFrame >= inputFrames - 1) {
-            srcFrame = inputFrames - 1;
-            frac = 0.0f;
-        }
-
-        for (int ch = 0; ch < channels; ch++) {
-            int inIdx1 = srcFrame * channels + ch;
-            int inIdx2 = (srcFrame + 1) * channels + ch;
-            int outIdx = outFrame * channels + ch;
-
-            if (srcFrame < inputFrames - 1) {
-                // Linear interpolation between two samples
-                float sample1 = input[inIdx1];
-                float sample2 = input[inIdx2];
-                output[outIdx] = sample1 + frac * (sample2 - sample1);
-            } else {
-                // Just use the last sample
-                output[outIdx] = input[inIdx1];
-            }
-        }
-    }
+    // Hold the low priority ring at about two device buffers: a fuller ring means
+    // the emulator runs fast against the device clock, so consume input faster.
+    // Smoothed over ~20 callbacks and limited to +/-0.5%, like the Qt path's PI trim.
+    const double targetBytes = targetQueuedBytes();
+    const double fill = m_lowPriorityBuffer.available();
+    m_smoothedFillBytes = m_smoothedFillBytes == 0.0 ? fill : m_smoothedFillBytes + 0.05 * (fill - m_smoothedFillBytes);
+    const double error = (m_smoothedFillBytes - targetBytes) / targetBytes;
+    const double adjustment = 1.0 + std::max(-0.005, std::min(0.005, error * 0.005));
+    m_rateAdjustment.store(adjustment);
+    m_resampler.setRatio(nominal * adjustment);
 }
 
 void UnifiedAudioBackend::setPlatformOptimizations()
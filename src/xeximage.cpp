@@ -0,0 +1,100 @@
+/*
+ * Fujisan - Modern Atari Emulator
+ * Copyright (c) 2025 Paulo Garcia (8bitrelics.com)
+ *
+ * Licensed under the MIT License. See LICENSE file for details.
+ */
+
+#include "xeximage.h"
+
+namespace {
+int readWord(const QByteArray& file, int offset)
+{
+    return static_cast<quint8>(file[offset]) | (static_cast<quint8>(file[offset + 1]) << 8);
+}
+
+// Value a segment leaves in the vector at address, given what was there before
+int vectorAfter(const XexImage::Segment& segment, int address, int previous)
+{
+    int value = previous < 0 ? 0 : previous;
+    for (int byte = 0; byte < 2; ++byte) {
+        const int offset = address + byte - segment.start;
+        if (offset >= 0 && offset < segment.data.size()) {
+            value = (value & ~(0xFF << (8 * byte))) | (static_cast<quint8>(segment.data[offset]) << (8 * byte));
+        }
+    }
+    return value;
+}
+}
+
+bool XexImage::parse(const QByteArray& file, QString* error)
+{
+    m_segments.clear();
+    m_runAddress = -1;
+    const auto fail = [this, error](const QString& message) {
+        m_segments.clear();
+        m_runAddress = -1;
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    if (file.size() < 2 || readWord(file, 0) != 0xFFFF) {
+        return fail(QStringLiteral("Not an Atari binary file (no $FFFF header)"));
+    }
+    int offset = 2;
+    int runVector = -1;
+    while (offset < file.size()) {
+        if (offset + 4 > file.size()) {
+            return fail(QStringLiteral("Truncated segment header at offset %1").arg(offset));
+        }
+        int start = readWord(file, offset);
+        if (start == 0xFFFF) {
+            offset += 2;
+            if (offset + 4 > file.size()) {
+                return fail(QStringLiteral("Truncated segment header at offset %1").arg(offset));
+            }
+            start = readWord(file, offset);
+        }
+        const int end = readWord(file, offset + 2);
+        offset += 4;
+        if (end < start) {
+            return fail(QStringLiteral("Segment $%1-$%2 ends before it starts")
+                            .arg(start, 4, 16, QChar('0')).arg(end, 4, 16, QChar('0')));
+        }
+        const int length = end - start + 1;
+        if (offset + length > file.size()) {
+            return fail(QStringLiteral("Segment $%1-$%2 is truncated")
+                            .arg(start, 4, 16, QChar('0')).arg(end, 4, 16, QChar('0')));
+        }
+
+        Segment segment;
+        segment.start = static_cast<quint16>(start);
+        segment.data = file.mid(offset, length);
+        offset += length;
+        // DOS clears INITAD before each segment and calls it if the segment set it
+        if (start <= kInitVector + 1 && end >= kInitVector) {
+            segment.initAddress = vectorAfter(segment, kInitVector, 0);
+        }
+        if (start <= kRunVector + 1 && end >= kRunVector) {
+            runVector = vectorAfter(segment, kRunVector, runVector);
+        }
+        m_segments.append(segment);
+    }
+    if (m_segments.isEmpty()) {
+        return fail(QStringLiteral("Binary file has no segments"));
+    }
+    m_runAddress = runVector >= 0 ? runVector : m_segments.first().start;
+    return true;
+}
+
+bool XexImage::touches(int first, int last) const
+{
+    for (const Segment& segment : m_segments) {
+        if (segment.start <= last && segment.end() >= first) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,146 @@
+/*
+ * Fujisan Test Suite - ANTIC Text Decoder Tests
+ *
+ * Verifies screen.get_text's display list walk on hand-built memory images:
+ * the OS GRAPHICS 0 list with LMS and JVB, mixed GRAPHICS 1/2 and bitmap
+ * lines (which must still advance screen memory), internal code to ATASCII
+ * conversion including inverse video and lowercase, playfield widths, and
+ * runaway lists without a JVB.
+ */
+
+#include "antictextdecoder.h"
+
+#include <QtTest/QtTest>
+
+class TestAnticTextDecoder : public QObject {
+    Q_OBJECT
+
+private:
+    static constexpr int kDisplayList = 0x9C20;
+    static constexpr int kScreen = 0x9C40;
+    static constexpr int kNormalWidth = 0x22;  // DMACTL: normal playfield + DL DMA
+
+    QByteArray m_memory;
+
+    unsigned char* memory() { return reinterpret_cast<unsigned char*>(m_memory.data()); }
+
+    // Internal screen codes for ASCII text, as the E: handler stores it
+    static QByteArray internal(const QByteArray& ascii)
+    {
+        QByteArray codes;
+        for (char ch : ascii) {
+            const unsigned char c = static_cast<unsigned char>(ch);
+            codes.append(static_cast<char>(c < 0x60 ? c - 0x20 : c));
+        }
+        return codes;
+    }
+
+    void putDisplayList(const QByteArray& list)
+    {
+        m_memory.replace(kDisplayList, list.size(), list);
+    }
+
+    static QByteArray lms(int mode, int address)
+    {
+        return QByteArray(1, static_cast<char>(0x40 | mode))
+            + static_cast<char>(address & 0xFF) + static_cast<char>(address >> 8);
+    }
+
+    static QByteArray jvb(int address)
+    {
+        return QByteArray(1, '\x41') + static_cast<char>(address & 0xFF) + static_cast<char>(address >> 8);
+    }
+
+private slots:
+    void init()
+    {
+        m_memory = QByteArray(0x10000, '\0');
+    }
+
+    void testGraphics0Screen()
+    {
+        // The OS GRAPHICS 0 list: 24 blank lines, LMS mode 2, 23 more mode 2 lines
+        QByteArray list("\x70\x70\x70", 3);
+        list += lms(2, kScreen);
+        list += QByteArray(23, '\x02');
+        list += jvb(kDisplayList);
+        putDisplayList(list);
+        m_memory.replace(kScreen + 40, 5, internal("READY"));
+
+        const QVector<AnticTextDecoder::Line> lines =
+            AnticTextDecoder::decode(memory(), kDisplayList, kNormalWidth);
+        QCOMPARE(lines.size(), 24);
+        QCOMPARE(lines[0].scanline, 24);
+        QCOMPARE(lines[1].text.trimmed(), QString("READY"));
+        QCOMPARE(lines[1].text.size(), 40);
+        QCOMPARE(lines[1].address, quint16(kScreen + 40));
+        QCOMPARE(lines[23].scanline, 24 + 23 * 8);
+    }
+
+    void testGraphicsLinesAdvanceScreenMemory()
+    {
+        // GRAPHICS 1 line, two bitmap (mode 8) lines, GRAPHICS 2 line
+        QByteArray list = lms(6, kScreen);
+        list += QByteArray("\x08\x08\x07", 3);
+        list += jvb(kDisplayList);
+        putDisplayList(list);
+        m_memory.replace(kScreen, 5, internal("SCORE"));
+        // The mode 7 line starts after 20 (mode 6) + 2 * 10 (mode 8) bytes; colour bits set
+        QByteArray title = internal("GAME");
+        for (char& code : title) {
+            code = static_cast<char>(code | 0x80);
+        }
+        m_memory.replace(kScreen + 40, title.size(), title);
+
+        const QVector<AnticTextDecoder::Line> lines =
+            AnticTextDecoder::decode(memory(), kDisplayList, kNormalWidth);
+        QCOMPARE(lines.size(), 2);
+        QCOMPARE(lines[0].mode, 6);
+        QCOMPARE(lines[0].text.size(), 20);
+        QVERIFY(lines[0].text.startsWith("SCORE"));
+        QCOMPARE(lines[1].mode, 7);
+        QCOMPARE(lines[1].address, quint16(kScreen + 40));
+        QVERIFY(lines[1].text.startsWith("GAME"));
+        QCOMPARE(lines[1].scanline, 8 + 8 + 8);
+    }
+
+    void testInternalToAtascii()
+    {
+        QCOMPARE(AnticTextDecoder::internalToAtascii(0x00, 2), quint8(' '));
+        QCOMPARE(AnticTextDecoder::internalToAtascii(0x21, 2), quint8('A'));
+        QCOMPARE(AnticTextDecoder::internalToAtascii(0xA1, 2), quint8('A'));  // inverse
+        QCOMPARE(AnticTextDecoder::internalToAtascii(0x61, 2), quint8('a'));
+        QCOMPARE(AnticTextDecoder::internalToAtascii(0x40, 2), quint8(0x00)); // heart
+        QCOMPARE(AnticTextDecoder::internalToAtascii(0xE1, 7), quint8('A'));  // colour 3
+        QCOMPARE(AnticTextDecoder::atasciiToChar(0x00), QChar(' '));
+        QCOMPARE(AnticTextDecoder::atasciiToChar(0x7B), QChar(' '));
+    }
+
+    void testPlayfieldWidths()
+    {
+        QByteArray list = lms(2, kScreen);
+        list += jvb(kDisplayList);
+        putDisplayList(list);
+        QCOMPARE(AnticTextDecoder::decode(memory(), kDisplayList, 0x21).first().text.size(), 32);
+        QCOMPARE(AnticTextDecoder::decode(memory(), kDisplayList, 0x23).first().text.size(), 48);
+        QVERIFY(AnticTextDecoder::decode(memory(), kDisplayList, 0x00).isEmpty());
+
+        // Horizontal scrolling fetches the next width up
+        list = QByteArray(1, '\x52') + static_cast<char>(kScreen & 0xFF) + static_cast<char>(kScreen >> 8);
+        list += jvb(kDisplayList);
+        putDisplayList(list);
+        QCOMPARE(AnticTextDecoder::decode(memory(), kDisplayList, kNormalWidth).first().text.size(), 48);
+    }
+
+    void testRunawayListStops()
+    {
+        // Mode 2 lines forever (no JVB): stops at the bottom of the display
+        m_memory.fill('\x02', 0x10000);
+        const QVector<AnticTextDecoder::Line> lines =
+            AnticTextDecoder::decode(memory(), kDisplayList, kNormalWidth);
+        QCOMPARE(lines.size(), 30);
+    }
+};
+
+QTEST_MAIN(TestAnticTextDecoder)
+#include "test_antic_text_decoder.moc"
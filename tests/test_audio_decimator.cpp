@@ -0,0 +1,112 @@
+/*
+ * Fujisan Test Suite - Audio Decimator Tests
+ *
+ * Verifies how turbo-speed audio is fitted to real time: time compression
+ * emits 1/speed of the input with fractional windows carried across frames
+ * and averages what it drops, the pitch-preserving mode keeps whole frames
+ * and fades the edges next to dropped ones, 8-bit samples keep their 128
+ * midpoint, and real-time speed passes the input through untouched.
+ */
+
+#include "audiodecimator.h"
+
+#include <QtTest/QtTest>
+#include <vector>
+
+class TestAudioDecimator : public QObject {
+    Q_OBJECT
+
+private:
+    static constexpr int kFrameSamples = 882;  // one 50 Hz frame at 44.1 kHz
+
+    static const qint16* samples(const unsigned char* bytes)
+    {
+        return reinterpret_cast<const qint16*>(bytes);
+    }
+
+private slots:
+    void testRealTimePassesThrough()
+    {
+        AudioDecimator decimator;
+        decimator.configure(1, 2);
+        std::vector<qint16> input(kFrameSamples, 1234);
+        const unsigned char* output = nullptr;
+        const int bytes = decimator.process(reinterpret_cast<const unsigned char*>(input.data()),
+                                            kFrameSamples * 2, 1.0, &output);
+        QCOMPARE(bytes, kFrameSamples * 2);
+        QCOMPARE(output, reinterpret_cast<const unsigned char*>(input.data()));
+    }
+
+    void testTimeCompressionRate()
+    {
+        // 2.5x does not divide a frame evenly; the remainder carries over
+        AudioDecimator decimator;
+        decimator.configure(1, 2);
+        std::vector<qint16> input(kFrameSamples, -2000);
+        int total = 0;
+        for (int frame = 0; frame < 50; ++frame) {
+            const unsigned char* output = nullptr;
+            const int bytes = decimator.process(reinterpret_cast<const unsigned char*>(input.data()),
+                                                kFrameSamples * 2, 2.5, &output);
+            for (int i = 0; i < bytes / 2; ++i) {
+                QCOMPARE(samples(output)[i], qint16(-2000));
+            }
+            total += bytes / 2;
+        }
+        QCOMPARE(total, 50 * kFrameSamples * 2 / 5);
+    }
+
+    void testTimeCompressionAverages()
+    {
+        // Stereo, 2x: each output frame is the mean of two input frames per channel
+        AudioDecimator decimator;
+        decimator.configure(2, 2);
+        const qint16 input[8] = {100, -100, 300, -300, 1000, 0, 0, 1000};
+        const unsigned char* output = nullptr;
+        const int bytes = decimator.process(reinterpret_cast<const unsigned char*>(input), sizeof(input), 2.0, &output);
+        QCOMPARE(bytes, 8);
+        QCOMPARE(samples(output)[0], qint16(200));
+        QCOMPARE(samples(output)[1], qint16(-200));
+        QCOMPARE(samples(output)[2], qint16(500));
+        QCOMPARE(samples(output)[3], qint16(500));
+    }
+
+    void testPitchPreserveKeepsWholeFrames()
+    {
+        AudioDecimator decimator;
+        decimator.configure(1, 2);
+        decimator.setMode(AudioDecimator::PitchPreserve);
+        std::vector<qint16> input(kFrameSamples, 8000);
+        int kept = 0;
+        for (int frame = 0; frame < 40; ++frame) {
+            const unsigned char* output = nullptr;
+            const int bytes = decimator.process(reinterpret_cast<const unsigned char*>(input.data()),
+                                                kFrameSamples * 2, 4.0, &output);
+            if (bytes == 0) {
+                continue;
+            }
+            kept++;
+            QCOMPARE(bytes, kFrameSamples * 2);
+            // Unchanged in the middle, faded towards silence next to the dropped frames
+            QCOMPARE(samples(output)[kFrameSamples / 2], qint16(8000));
+            QVERIFY(qAbs(samples(output)[0]) < 8000 / 8);
+            QVERIFY(qAbs(samples(output)[kFrameSamples - 1]) < 8000 / 8);
+        }
+        QCOMPARE(kept, 10);
+    }
+
+    void testEightBitMidpoint()
+    {
+        AudioDecimator decimator;
+        decimator.configure(1, 1);
+        const unsigned char input[4] = {128, 128, 255, 1};
+        const unsigned char* output = nullptr;
+        const int bytes = decimator.process(input, sizeof(input), 2.0, &output);
+        QCOMPARE(bytes, 2);
+        QCOMPARE(int(output[0]), 128);
+        QCOMPARE(int(output[1]), 128);
+    }
+};
+
+QTEST_MAIN(TestAudioDecimator)
+#include "test_audio_decimator.moc"
@@ -0,0 +1,112 @@
+/*
+ * Fujisan Test Suite - Audio Kernel Tests
+ *
+ * Checks the real-time mix and output conversion loops of UnifiedAudioBackend
+ * against straightforward scalar references, on lengths that exercise both the
+ * vector body and the scalar tail: 16-bit accumulation with gain, volume and
+ * clamping on conversion, truncation towards zero, and the 8-bit paths.
+ */
+
+#include "audiokernels.h"
+
+#include <QtTest/QtTest>
+#include <QVector>
+#include <algorithm>
+
+class TestAudioKernels : public QObject {
+    Q_OBJECT
+
+private:
+    static QVector<qint16> pcmRamp(int samples)
+    {
+        QVector<qint16> pcm(samples);
+        for (int i = 0; i < samples; ++i) {
+            pcm[i] = static_cast<qint16>((i * 2731) % 65536 - 32768);
+        }
+        pcm[0] = -32768;
+        if (samples > 1) {
+            pcm[1] = 32767;
+        }
+        return pcm;
+    }
+
+private slots:
+    void testAccumulateS16_data()
+    {
+        QTest::addColumn<int>("samples");
+        QTest::newRow("tail only") << 5;
+        QTest::newRow("one vector") << 8;
+        QTest::newRow("vectors and tail") << 37;
+        QTest::newRow("device buffer") << 2048;
+    }
+
+    void testAccumulateS16()
+    {
+        QFETCH(int, samples);
+        const QVector<qint16> pcm = pcmRamp(samples);
+        QVector<float> mixed(samples, 0.25f);
+        AudioKernels::accumulateS16(pcm.constData(), mixed.data(), samples, 0.3f);
+        const float scale = 0.3f / 32768.0f;
+        for (int i = 0; i < samples; ++i) {
+            QCOMPARE(mixed[i], 0.25f + static_cast<float>(pcm[i]) * scale);
+        }
+    }
+
+    void testScaleToS16ClampsAndTruncates()
+    {
+        const QVector<float> input = {0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 1.7f, -3.0f, 0.99999f,
+                                      -0.00001f, 0.25f, 2.0f};
+        QVector<qint16> output(input.size());
+        AudioKernels::scaleToS16(input.constData(), output.data(), input.size(), 1.0f);
+        QCOMPARE(output[0], qint16(0));
+        QCOMPARE(output[1], qint16(16383));
+        QCOMPARE(output[2], qint16(-16383));
+        QCOMPARE(output[3], qint16(32767));
+        QCOMPARE(output[4], qint16(-32767));
+        QCOMPARE(output[5], qint16(32767));
+        QCOMPARE(output[6], qint16(-32767));
+        QCOMPARE(output[7], qint16(32766));
+        QCOMPARE(output[8], qint16(0));
+        QCOMPARE(output[10], qint16(32767));  // scalar tail clamps too
+    }
+
+    void testScaleToS16MatchesScalar()
+    {
+        const int samples = 1003;
+        QVector<float> input(samples);
+        for (int i = 0; i < samples; ++i) {
+            input[i] = static_cast<float>(i % 97) / 40.0f - 1.2f;
+        }
+        QVector<qint16> output(samples);
+        AudioKernels::scaleToS16(input.constData(), output.data(), samples, 0.6f);
+        for (int i = 0; i < samples; ++i) {
+            const float expected = std::max(-1.0f, std::min(1.0f, input[i] * 0.6f)) * 32767.0f;
+            QCOMPARE(output[i], static_cast<qint16>(expected));
+        }
+    }
+
+    void testEightBitPaths()
+    {
+        const quint8 pcm[4] = {0, 128, 255, 64};
+        float mixed[4] = {};
+        AudioKernels::accumulateU8(pcm, mixed, 4, 1.0f);
+        QCOMPARE(mixed[0], -1.0f);
+        QCOMPARE(mixed[1], 0.0f);
+        QCOMPARE(mixed[3], -0.5f);
+
+        quint8 output[4];
+        AudioKernels::scaleToU8(mixed, output, 4, 1.0f);
+        QCOMPARE(output[0], quint8(0));
+        QCOMPARE(output[1], quint8(127));
+        QCOMPARE(output[3], quint8(63));
+    }
+
+    void testInstructionSetNamed()
+    {
+        const QByteArray name(AudioKernels::instructionSet());
+        QVERIFY(name == "sse2" || name == "neon" || name == "scalar");
+    }
+};
+
+QTEST_MAIN(TestAudioKernels)
+#include "test_audio_kernels.moc"
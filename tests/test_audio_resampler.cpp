@@ -0,0 +1,170 @@
+/*
+ * Fujisan Test Suite - Audio Resampler Tests
+ *
+ * Drives AudioResampler the way the SDL callback does, in device-buffer sized
+ * calls. It checks that a sine stays continuous across call boundaries (the
+ * phase carries over), that sinc quality tracks the ideal signal more closely
+ * than linear, DC gain, rejection of content above the output Nyquist when
+ * downsampling, exact input accounting, and ratio changes mid-stream.
+ */
+
+#include "audioresampler.h"
+
+#include <QtTest/QtTest>
+#include <cmath>
+#include <vector>
+
+class TestAudioResampler : public QObject {
+    Q_OBJECT
+
+private:
+    static constexpr double kPi = 3.14159265358979323846;
+
+    // Resample a sine of the given frequency in callbacks of `block` frames and
+    // return the largest deviation from the ideal output after the lead-in
+    static double sineError(AudioResampler::Quality quality, double inputRate, double outputRate,
+                            double frequency, int block, int callbacks)
+    {
+        AudioResampler resampler;
+        const double ratio = inputRate / outputRate;
+        resampler.configure(2, ratio, block, quality);
+        std::vector<float> input;
+        std::vector<float> output(static_cast<size_t>(block) * 2);
+        long long inputPos = 0;
+        long long outputPos = 0;
+        double maxError = 0.0;
+        for (int callback = 0; callback < callbacks; ++callback) {
+            const int needed = resampler.inputFramesNeeded(block);
+            input.resize(static_cast<size_t>(needed) * 2);
+            for (int i = 0; i < needed; ++i) {
+                const float value = static_cast<float>(std::sin(2.0 * kPi * frequency * (inputPos + i) / inputRate));
+                input[2 * i] = value;
+                input[2 * i + 1] = -value;
+            }
+            inputPos += needed;
+            if (resampler.process(input.data(), needed, output.data(), block) != block) {
+                return 1e9;
+            }
+            for (int j = 0; j < block; ++j, ++outputPos) {
+                if (output[2 * j] != -output[2 * j + 1]) {
+                    return 1e9;  // channels mixed up
+                }
+                if (outputPos < 64) {
+                    continue;  // filter lead-in over the initial silence
+                }
+                const double ideal = std::sin(2.0 * kPi * frequency * outputPos * ratio / inputRate);
+                maxError = std::max(maxError, std::fabs(output[2 * j] - ideal));
+            }
+        }
+        return maxError;
+    }
+
+private slots:
+    void testPhaseCarriesAcrossCallbacks()
+    {
+        // An odd block size makes every boundary land at a different phase
+        const double sinc = sineError(AudioResampler::Sinc, 44100.0, 48000.0, 1000.0, 517, 60);
+        const double linear = sineError(AudioResampler::Linear, 44100.0, 48000.0, 1000.0, 517, 60);
+        QVERIFY2(sinc < 1e-3, qPrintable(QString::number(sinc)));
+        QVERIFY2(linear < 5e-3, qPrintable(QString::number(linear)));
+        QVERIFY(sinc < linear);
+    }
+
+    void testBrightToneStaysAccurate()
+    {
+        // 8 kHz is where linear interpolation's error becomes audible
+        const double sinc = sineError(AudioResampler::Sinc, 44100.0, 48000.0, 8000.0, 1024, 20);
+        const double linear = sineError(AudioResampler::Linear, 44100.0, 48000.0, 8000.0, 1024, 20);
+        QVERIFY2(sinc < 1e-2, qPrintable(QString::number(sinc)));
+        QVERIFY(sinc * 5 < linear);
+    }
+
+    void testUnityDcGain()
+    {
+        AudioResampler resampler;
+        resampler.configure(1, 1.3, 256, AudioResampler::Sinc);
+        std::vector<float> input(1024, 0.5f);
+        std::vector<float> output(256);
+        for (int callback = 0; callback < 3; ++callback) {
+            const int needed = resampler.inputFramesNeeded(256);
+            QCOMPARE(resampler.process(input.data(), needed, output.data(), 256), 256);
+        }
+        for (float sample : output) {
+            QVERIFY(std::fabs(sample - 0.5f) < 1e-4f);
+        }
+    }
+
+    void testDownsamplingRejectsAliases()
+    {
+        // 30 kHz in a 96 kHz stream cannot be represented at 44.1 kHz
+        AudioResampler resampler;
+        const double ratio = 96000.0 / 44100.0;
+        resampler.configure(1, ratio, 512, AudioResampler::Sinc);
+        std::vector<float> input;
+        std::vector<float> output(512);
+        long long inputPos = 0;
+        double peak = 0.0;
+        for (int callback = 0; callback < 10; ++callback) {
+            const int needed = resampler.inputFramesNeeded(512);
+            input.resize(needed);
+            for (int i = 0; i < needed; ++i) {
+                input[i] = static_cast<float>(std::sin(2.0 * kPi * 30000.0 * (inputPos + i) / 96000.0));
+            }
+            inputPos += needed;
+            resampler.process(input.data(), needed, output.data(), 512);
+            if (callback > 0) {
+                for (float sample : output) {
+                    peak = std::max(peak, std::fabs(static_cast<double>(sample)));
+                }
+            }
+        }
+        QVERIFY2(peak < 0.01, qPrintable(QString::number(peak)));
+    }
+
+    void testInputAccounting()
+    {
+        AudioResampler resampler;
+        resampler.configure(1, 0.5, 100, AudioResampler::Linear);
+        std::vector<float> input(200, 0.0f);
+        std::vector<float> output(100);
+        // Too little input: output stops short instead of reading past the end
+        QCOMPARE(resampler.process(input.data(), 10, output.data(), 100), 18);
+        const int needed = resampler.inputFramesNeeded(100);
+        QCOMPARE(resampler.process(input.data(), needed, output.data(), 100), 100);
+        QCOMPARE(resampler.inputFramesNeeded(0), 0);
+        QVERIFY(resampler.maxInputFrames(100) >= needed);
+    }
+
+    void testRatioChangesMidStream()
+    {
+        AudioResampler resampler;
+        resampler.configure(1, 1.0, 256, AudioResampler::Sinc);
+        resampler.setRatio(2.0);
+        QCOMPARE(resampler.ratio(), 1.0 + AudioResampler::kMaxRatioDeviation);
+        resampler.setRatio(1.003);
+        QCOMPARE(resampler.ratio(), 1.003);
+
+        // A ramp keeps rising through a ratio change: no jump back in time
+        std::vector<float> input;
+        std::vector<float> output(256);
+        long long inputPos = 0;
+        float previous = -1.0f;
+        for (int callback = 0; callback < 8; ++callback) {
+            resampler.setRatio(callback % 2 ? 0.998 : 1.004);
+            const int needed = resampler.inputFramesNeeded(256);
+            input.resize(needed);
+            for (int i = 0; i < needed; ++i) {
+                input[i] = static_cast<float>(inputPos + i) * 1e-4f;
+            }
+            inputPos += needed;
+            QCOMPARE(resampler.process(input.data(), needed, output.data(), 256), 256);
+            for (int j = callback == 0 ? 32 : 0; j < 256; ++j) {
+                QVERIFY(output[j] > previous);
+                previous = output[j];
+            }
+        }
+    }
+};
+
+QTEST_MAIN(TestAudioResampler)
+#include "test_audio_resampler.moc"
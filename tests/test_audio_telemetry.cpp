@@ -0,0 +1,131 @@
+/*
+ * Fujisan Test Suite - Audio Telemetry Ring Tests
+ *
+ * Verifies the per-frame audio flight recorder behind
+ * status.get_audio_telemetry and the diagnostics CSV: cursors that do not
+ * consume, overwriting the oldest samples with a lost count, independent
+ * readers, the CSV/JSON row layout, and a producer racing a reader.
+ */
+
+#include "audiotelemetry.h"
+
+#include <QThread>
+#include <QtTest/QtTest>
+
+class TestAudioTelemetry : public QObject {
+    Q_OBJECT
+
+private:
+    static AudioTelemetrySample sample(quint64 frame)
+    {
+        AudioTelemetrySample s;
+        s.frame = frame;
+        s.timeUs = static_cast<qint64>(frame) * 16683;
+        s.frameIntervalUs = 16683;
+        s.producedBytes = 1470;
+        s.queuedBytes = static_cast<qint32>(frame % 4096);
+        s.underruns = static_cast<quint32>(frame / 100);
+        s.speedTrim = 0.001f;
+        s.deviceClockUs = static_cast<qint64>(frame) * 1000;
+        s.backend = 2;
+        return s;
+    }
+
+private slots:
+    void testReadersKeepTheirOwnCursor()
+    {
+        AudioTelemetryRing ring(16);
+        for (quint64 frame = 0; frame < 10; ++frame) {
+            ring.record(sample(frame));
+        }
+        QCOMPARE(ring.recorded(), quint64(10));
+
+        quint64 first = 0;
+        QVector<AudioTelemetrySample> samples = ring.read(first, 4);
+        QCOMPARE(samples.size(), 4);
+        QCOMPARE(samples.first().frame, quint64(0));
+        QCOMPARE(first, quint64(4));
+
+        // Reading does not consume: a second reader sees everything
+        quint64 second = 0;
+        samples = ring.read(second, 100);
+        QCOMPARE(samples.size(), 10);
+        QCOMPARE(samples.last().frame, quint64(9));
+        QCOMPARE(samples.last().queuedBytes, qint32(9));
+        QCOMPARE(second, quint64(10));
+        QVERIFY(ring.read(second, 100).isEmpty());
+    }
+
+    void testOverwritesOldestAndCountsLost()
+    {
+        AudioTelemetryRing ring(8);
+        for (quint64 frame = 0; frame < 20; ++frame) {
+            ring.record(sample(frame));
+        }
+        quint64 cursor = 0;
+        quint64 lost = 0;
+        const QVector<AudioTelemetrySample> samples = ring.read(cursor, 100, &lost);
+        QCOMPARE(samples.size(), 8);
+        QCOMPARE(samples.first().frame, quint64(12));
+        QCOMPARE(lost, quint64(12));
+        QCOMPARE(cursor, quint64(20));
+
+        // A cursor past the end is clamped rather than waiting for the future
+        cursor = 1000;
+        QVERIFY(ring.read(cursor, 10).isEmpty());
+        QCOMPARE(cursor, quint64(20));
+    }
+
+    void testRowFormats()
+    {
+        const QStringList columns = AudioTelemetryRing::csvHeader().split(',');
+        const AudioTelemetrySample s = sample(300);
+        const QStringList csv = AudioTelemetryRing::toCsv(s).split(',');
+        const QJsonArray json = AudioTelemetryRing::toJson(s);
+        QCOMPARE(csv.size(), columns.size());
+        QCOMPARE(json.size(), columns.size());
+        QCOMPARE(columns.indexOf("underruns"), 6);
+        QCOMPARE(csv[6], QString("3"));
+        QCOMPARE(json[0].toInt(), 300);
+        QCOMPARE(json[columns.indexOf("device_free_bytes")].toInt(), -1);
+    }
+
+    void testConcurrentProducerAndReader()
+    {
+        AudioTelemetryRing ring(64);
+        constexpr quint64 kTotal = 200000;
+
+        QThread* producer = QThread::create([&ring]() {
+            for (quint64 frame = 0; frame < kTotal; ++frame) {
+                ring.record(sample(frame));
+            }
+        });
+        producer->start();
+
+        // Whatever the reader gets must be whole samples in increasing order
+        quint64 cursor = 0;
+        quint64 lastFrame = 0;
+        quint64 seen = 0;
+        quint64 lostTotal = 0;
+        bool intact = true;
+        while (cursor < kTotal) {
+            quint64 lost = 0;
+            const QVector<AudioTelemetrySample> samples = ring.read(cursor, 16, &lost);
+            lostTotal += lost;
+            for (const AudioTelemetrySample& s : samples) {
+                intact = intact && s.timeUs == static_cast<qint64>(s.frame) * 16683 &&
+                         s.deviceClockUs == static_cast<qint64>(s.frame) * 1000 &&
+                         (seen == 0 || s.frame > lastFrame);
+                lastFrame = s.frame;
+                seen++;
+            }
+        }
+        producer->wait();
+        delete producer;
+        QVERIFY(intact);
+        QCOMPARE(seen + lostTotal, kTotal);
+    }
+};
+
+QTEST_MAIN(TestAudioTelemetry)
+#include "test_audio_telemetry.moc"
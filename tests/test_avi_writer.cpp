@@ -0,0 +1,160 @@
+/*
+ * Fujisan Test Suite - AVI Writer Tests
+ *
+ * Verifies the recording file format: RLE8 keyframes and delta frames decode
+ * back to the exact palette indices, an unchanged screen costs a few bytes,
+ * and a finished file has consistent RIFF/movi sizes, frame counts and an
+ * idx1 entry for every video and audio chunk.
+ */
+
+#include "aviwriter.h"
+
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <QtTest/QtTest>
+
+class TestAviWriter : public QObject {
+    Q_OBJECT
+
+private:
+    static constexpr int kWidth = 384;
+    static constexpr int kHeight = 240;
+
+    // A playfield-like frame: solid bands, a text area with short runs and some noise
+    static QByteArray screen(int seed)
+    {
+        QByteArray pixels(kWidth * kHeight, '\0');
+        for (int y = 0; y < kHeight; ++y) {
+            for (int x = 0; x < kWidth; ++x) {
+                char value = static_cast<char>(y / 16 * 0x10 + 4);
+                if (y >= 100 && y < 108) {
+                    value = static_cast<char>(((x / 3 + y + seed) % 5) ? 0x94 : 0x9A);
+                } else if (y >= 200 && x < 64) {
+                    value = static_cast<char>((x * 31 + y * 17 + seed * 7) & 0xFF);
+                }
+                pixels[y * kWidth + x] = value;
+            }
+        }
+        return pixels;
+    }
+
+    static unsigned char* bytes(QByteArray& data) { return reinterpret_cast<unsigned char*>(data.data()); }
+
+    static quint32 u32(const QByteArray& data, int offset)
+    {
+        return qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(data.constData() + offset));
+    }
+
+private slots:
+    void testKeyframeRoundTrip()
+    {
+        QByteArray frame = screen(0);
+        QByteArray encoded;
+        AviWriter::encodeRle8(bytes(frame), nullptr, kWidth, kHeight, encoded);
+        QVERIFY(encoded.size() < frame.size() / 4);
+
+        QByteArray decoded(frame.size(), '\x55');
+        QVERIFY(AviWriter::decodeRle8(encoded, kWidth, kHeight, bytes(decoded)));
+        QCOMPARE(decoded, frame);
+    }
+
+    void testDeltaFrameRoundTrip()
+    {
+        QByteArray previous = screen(0);
+        QByteArray frame = screen(1);   // the text band and the noise change
+        frame[5 * kWidth + 200] = '\x0E';  // and a single sprite pixel
+        frame[(kHeight - 1) * kWidth] = '\x0F';
+
+        QByteArray encoded;
+        AviWriter::encodeRle8(bytes(frame), bytes(previous), kWidth, kHeight, encoded);
+        QByteArray key;
+        AviWriter::encodeRle8(bytes(frame), nullptr, kWidth, kHeight, key);
+        QVERIFY(encoded.size() < key.size());
+
+        QByteArray decoded = previous;
+        QVERIFY(AviWriter::decodeRle8(encoded, kWidth, kHeight, bytes(decoded)));
+        QCOMPARE(decoded, frame);
+    }
+
+    void testUnchangedFrameIsTiny()
+    {
+        QByteArray frame = screen(3);
+        QByteArray encoded;
+        AviWriter::encodeRle8(bytes(frame), bytes(frame), kWidth, kHeight, encoded);
+        QVERIFY(encoded.size() <= 8);
+
+        QByteArray decoded = frame;
+        QVERIFY(AviWriter::decodeRle8(encoded, kWidth, kHeight, bytes(decoded)));
+        QCOMPARE(decoded, frame);
+        QVERIFY(!AviWriter::decodeRle8(QByteArray("\x05\x01", 2), kWidth, kHeight, bytes(decoded)));
+    }
+
+    void testFileStructure()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.path() + "/capture.avi";
+
+        AviWriter::Format format;
+        for (int i = 0; i < 256; ++i) {
+            format.palette[i] = 0xFF000000u | static_cast<quint32>(i * 0x010101);
+        }
+        AviWriter writer;
+        QVERIFY(writer.open(path, format));
+        QByteArray frame = screen(0);
+        const QByteArray audio(1470, '\x10');  // one frame of 16-bit mono at 44.1 kHz
+        QVERIFY(writer.writeVideoFrame(bytes(frame)));
+        QVERIFY(writer.writeAudio(reinterpret_cast<const unsigned char*>(audio.constData()), audio.size()));
+        QVERIFY(writer.writeVideoFrame(nullptr));
+        frame = screen(1);
+        QVERIFY(writer.writeVideoFrame(bytes(frame)));
+        QVERIFY(writer.writeAudio(reinterpret_cast<const unsigned char*>(audio.constData()), audio.size()));
+        QVERIFY(writer.close());
+        QVERIFY(writer.close());
+        QCOMPARE(writer.videoFrames(), quint32(3));
+
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QByteArray data = file.readAll();
+        QCOMPARE(data.left(4), QByteArray("RIFF"));
+        QCOMPARE(qint64(u32(data, 4)), qint64(data.size() - 8));
+        QCOMPARE(data.mid(8, 4), QByteArray("AVI "));
+        QCOMPARE(writer.bytesWritten(), qint64(data.size()));
+
+        const int avih = data.indexOf("avih");
+        QVERIFY(avih > 0);
+        QCOMPARE(u32(data, avih + 8 + 16), quint32(3));  // dwTotalFrames
+        QCOMPARE(u32(data, avih + 8 + 24), quint32(2));  // dwStreams
+        QVERIFY(data.indexOf("vidsmrle") > avih);
+
+        const int movi = data.indexOf("movi");
+        QVERIFY(movi > avih);
+        const int idx1 = data.indexOf("idx1", movi);
+        QCOMPARE(qint64(u32(data, movi - 4)), qint64(idx1 - movi));
+        QCOMPARE(u32(data, idx1 + 4), quint32(5 * 16));
+
+        // Entries point at their chunks relative to 'movi'; the first is a keyframe
+        const QByteArray expected[5] = {"00dc", "01wb", "00dc", "00dc", "01wb"};
+        for (int i = 0; i < 5; ++i) {
+            const int entry = idx1 + 8 + i * 16;
+            QCOMPARE(data.mid(entry, 4), expected[i]);
+            const int chunk = movi + static_cast<int>(u32(data, entry + 8));
+            QCOMPARE(data.mid(chunk, 4), expected[i]);
+            QCOMPARE(u32(data, chunk + 4), u32(data, entry + 12));
+        }
+        QCOMPARE(u32(data, idx1 + 8 + 4), quint32(0x10));
+        QCOMPARE(u32(data, idx1 + 8 + 2 * 16 + 12), quint32(0));  // repeated frame
+    }
+
+    void testOpenFailureReportsError()
+    {
+        AviWriter writer;
+        QString error;
+        QVERIFY(!writer.open("/nonexistent-dir/capture.avi", AviWriter::Format(), &error));
+        QVERIFY(!error.isEmpty());
+        QVERIFY(!writer.isOpen());
+    }
+};
+
+QTEST_MAIN(TestAviWriter)
+#include "test_avi_writer.moc"
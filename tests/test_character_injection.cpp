@@ -4,6 +4,10 @@
  * Ensures injectCharacter() can be called from the UI thread while the emulator
  * runs on a worker thread: it must not call libatari800_next_frame() off the
  * emulator thread (regression from moveToThread + synchronous frame stepping).
+ * Also checks that queueText() is typed by processFrame() alone, at a few
+ * frames per key once the OS is reading the keyboard, and that a second
+ * instance cannot initialize the process-wide core while another owns it.
+ * Disk activity is kept in per-drive timestamps for the GUI to sample.
  */
 
 #include <QCoreApplication>
@@ -20,6 +24,8 @@ namespace {
 // Enough for post-release frames (kInjectPostReleaseFrameCount) plus margin; keep small because
 // each processFrame runs libatari800_next_frame() which can block seconds when NETSIO is enabled.
 constexpr int kMaxFramesForInjectTimersIdle = 16;
+// Cold boot to the BASIC READY prompt, after which the OS consumes keys from CH
+constexpr int kBootFrames = 300;
 }
 
 class TestCharacterInjection : public QObject {
@@ -123,6 +129,152 @@ private slots:
         QVERIFY2(thread.wait(5000), "emulator thread must stop before scope exit");
     }
 
+    void testQueuedTextIsTypedByFrameLoop()
+    {
+        QThread thread;
+        auto* emu = new AtariEmulator(nullptr);
+        emu->moveToThread(&thread);
+        thread.start();
+
+        bool initOk = false;
+        QMetaObject::invokeMethod(
+            emu,
+            [&initOk, emu]() {
+                initOk = emu->initializeWithDisplayConfig(
+                    true,
+                    QStringLiteral("-xl"),
+                    QStringLiteral("-pal"),
+                    QStringLiteral("none"),
+                    QStringLiteral("tv"),
+                    QStringLiteral("tv"),
+                    0,
+                    0,
+                    QStringLiteral("both"),
+                    false,
+                    false);
+                if (initOk) {
+                    emu->pauseEmulation();
+                    for (int i = 0; i < kBootFrames; ++i) {
+                        emu->processFrame();
+                    }
+                }
+            },
+            Qt::BlockingQueuedConnection);
+        QVERIFY(initOk);
+
+        QSignalSpy drained(emu, &AtariEmulator::textQueueDrained);
+        const QByteArray text = "10 PRINT 1234567890\n";
+        emu->queueText(text);
+        QCOMPARE(emu->queuedKeyCount(), text.size());
+        QVERIFY(!emu->isCharacterInjectionIdle());
+
+        // Two frames per key, three after a repeated one: well under the old six
+        const int maxFrames = 4 * text.size();
+        int frames = 0;
+        QMetaObject::invokeMethod(
+            emu,
+            [&frames, emu, maxFrames]() {
+                while (frames < maxFrames && !emu->isCharacterInjectionIdle()) {
+                    emu->processFrame();
+                    ++frames;
+                }
+            },
+            Qt::BlockingQueuedConnection);
+        QVERIFY2(emu->isCharacterInjectionIdle(), "queued text should drain from processFrame alone");
+        QCOMPARE(emu->queuedKeyCount(), 0);
+        QCOMPARE(drained.count(), 1);
+
+        // Cancelling drops what is left
+        emu->queueText("PRINT\n");
+        emu->cancelQueuedText();
+        QCOMPARE(emu->queuedKeyCount(), 0);
+
+        QMetaObject::invokeMethod(emu, "shutdown", Qt::BlockingQueuedConnection);
+        QMetaObject::invokeMethod(
+            emu, [emu]() { delete emu; }, Qt::BlockingQueuedConnection);
+        thread.quit();
+        QVERIFY2(thread.wait(5000), "emulator thread must stop before scope exit");
+    }
+
+    void testSecondInstanceCannotTakeCore()
+    {
+        AtariEmulator first(nullptr);
+        first.setDeferTimerStart(true);
+        first.enableAudio(false);
+
+        QVERIFY(first.initializeWithConfig(false, QStringLiteral("-xl"), QStringLiteral("-pal"),
+                                           QStringLiteral("none")));
+        QCOMPARE(AtariEmulator::coreOwner(), &first);
+        // Re-initializing the owner is a restart, not a second machine
+        QVERIFY(first.initializeWithConfig(false, QStringLiteral("-xl"), QStringLiteral("-pal"),
+                                           QStringLiteral("none")));
+
+        // Arm a breakpoint on the NMI handler (run every frame) and a watchpoint on
+        // RTCLOK, which the VBI it calls increments, before another machine comes and goes
+        const QByteArray nmiVector = first.readMemoryBlock(0, 0xFFFA, 2);
+        QCOMPARE(nmiVector.size(), 2);
+        const unsigned short nmiHandler = static_cast<unsigned short>(
+            static_cast<unsigned char>(nmiVector[0]) | static_cast<unsigned char>(nmiVector[1]) << 8);
+        first.addBreakpoint(nmiHandler);
+        QVERIFY(first.addWatchpoint(0x14, 0x14, AccessTraceRing::AccessWrite, false) >= 0);
+
+        {
+            AtariEmulator second(nullptr);
+            second.setDeferTimerStart(true);
+            second.enableAudio(false);
+            QVERIFY(!second.initializeWithConfig(false, QStringLiteral("-xl"), QStringLiteral("-pal"),
+                                                 QStringLiteral("none")));
+            QVERIFY(!second.isLibatari800Initialized());
+            second.shutdown();
+        }
+        QCOMPARE(AtariEmulator::coreOwner(), &first);
+        QVERIFY(first.isLibatari800Initialized());
+
+        // Destroying the second machine left the owner's hooks in the core
+        QSignalSpy hits(&first, &AtariEmulator::breakpointHit);
+        first.accessTrace().clear();
+        for (int i = 0; i < 3 && hits.isEmpty(); ++i) {
+            first.processFrame();
+        }
+        QCOMPARE(hits.count(), 1);
+        QCOMPARE(hits.first().first().value<unsigned short>(), nmiHandler);
+        first.removeBreakpoint(nmiHandler);
+        first.resumeEmulation();
+        first.processFrame();
+        QVERIFY2(first.accessTrace().size() > 0, "the watch callback should still reach the owner");
+
+        AtariEmulator second(nullptr);
+        second.setDeferTimerStart(true);
+        second.enableAudio(false);
+        first.shutdown();
+        QCOMPARE(AtariEmulator::coreOwner(), static_cast<AtariEmulator*>(nullptr));
+        QVERIFY(second.initializeWithConfig(false, QStringLiteral("-xl"), QStringLiteral("-pal"),
+                                            QStringLiteral("none")));
+        QCOMPARE(AtariEmulator::coreOwner(), &second);
+        second.shutdown();
+    }
+
+    void testDriveActivityIsSampledNotSignalled()
+    {
+        AtariEmulator emu(nullptr);
+        bool writing = true;
+        QVERIFY(!emu.driveActivity(1, 100, &writing));
+
+        emu.noteDiskActivity(1, false);
+        emu.noteDiskActivity(2, true);
+        QVERIFY(emu.driveActivity(1, 100, &writing));
+        QVERIFY(!writing);
+        QVERIFY(emu.driveActivity(2, 100, &writing));
+        QVERIFY(writing);
+        QVERIFY(!emu.driveActivity(3, 100));
+        QVERIFY(!emu.driveActivity(9, 100));
+
+        // The LED goes out once the hold time has passed without another access
+        QTest::qWait(30);
+        QVERIFY(!emu.driveActivity(1, 10));
+        QVERIFY(emu.driveActivity(1, 1000));
+    }
+
     void testInjectCharacterUnknownCharClearsPendingFrames()
     {
         QThread thread;
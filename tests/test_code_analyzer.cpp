@@ -0,0 +1,217 @@
+/*
+ * Fujisan Test Suite - Code Analyzer Tests
+ *
+ * Verifies the background code/data analysis behind the debugger's
+ * disassembly: recursive descent through branches, calls, jumps and JMP ($xxxx)
+ * vectors from entry points and the OS vectors, stopping at undocumented
+ * opcodes and overlapping instructions; re-tracing only the pages whose bytes
+ * changed, re-entered from code elsewhere; instruction-aligned backtracking;
+ * MADS and ca65/VICE label parsing; and a pass published from the worker.
+ */
+
+#include "codeanalyzer.h"
+
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+class TestCodeAnalyzer : public QObject {
+    Q_OBJECT
+
+private:
+    QByteArray m_memory;
+
+    unsigned char* memory() { return reinterpret_cast<unsigned char*>(m_memory.data()); }
+
+    void put(int address, const QByteArray& bytes)
+    {
+        m_memory.replace(address, bytes.size(), bytes);
+    }
+
+private slots:
+    void init()
+    {
+        m_memory = QByteArray(0x10000, '\0');
+    }
+
+    void testTracesFlowFromEntryPoint()
+    {
+        put(0x2000, QByteArray("\xA9\x00"        // LDA #$00
+                               "\xF0\x04"        // BEQ $2008
+                               "\x20\x00\x30"    // JSR $3000
+                               "\x60"            // RTS
+                               "\x6C\x20\x20"    // JMP ($2020)
+                               "\xFF\xFF", 13)); // not reached
+        put(0x2020, QByteArray("\x40\x20", 2));  // vector to $2040
+        put(0x2040, QByteArray("\xEA\x60", 2));  // NOP / RTS
+        put(0x3000, QByteArray("\x60", 1));
+
+        CodeFlowTracer tracer;
+        QCOMPARE(tracer.update(memory(), {0x2000}), int(CodeFlowTracer::kPages));
+        const unsigned char* kinds = tracer.kinds();
+        QCOMPARE(int(kinds[0x2000]), int(CodeFlowTracer::CodeStart));
+        QCOMPARE(int(kinds[0x2001]), int(CodeFlowTracer::CodeOperand));
+        QCOMPARE(int(kinds[0x2004]), int(CodeFlowTracer::CodeStart));
+        QCOMPARE(int(kinds[0x2006]), int(CodeFlowTracer::CodeOperand));
+        QCOMPARE(int(kinds[0x2007]), int(CodeFlowTracer::CodeStart));
+        QCOMPARE(int(kinds[0x2008]), int(CodeFlowTracer::CodeStart));
+        QCOMPARE(int(kinds[0x200B]), int(CodeFlowTracer::Unknown));
+        QCOMPARE(int(kinds[0x2020]), int(CodeFlowTracer::Unknown));  // the vector is data
+        QCOMPARE(int(kinds[0x2040]), int(CodeFlowTracer::CodeStart));
+        QCOMPARE(int(kinds[0x2041]), int(CodeFlowTracer::CodeStart));
+        QCOMPARE(int(kinds[0x3000]), int(CodeFlowTracer::CodeStart));
+        QCOMPARE(tracer.codeBytes(), 14);
+    }
+
+    void testOsVectorsAreRoots()
+    {
+        put(0x02E0, QByteArray("\x00\x50", 2));  // RUNAD = $5000
+        put(0xFFFC, QByteArray("\x00\xE0", 2));  // RESET = $E000
+        put(0x5000, QByteArray("\x60", 1));
+        put(0xE000, QByteArray("\x4C\x00\xE0", 3));
+
+        QCOMPARE(CodeFlowTracer::vectorEntryPoints(memory()).size(), 2);
+        CodeFlowTracer tracer;
+        tracer.update(memory(), {});
+        QCOMPARE(int(tracer.kinds()[0x5000]), int(CodeFlowTracer::CodeStart));
+        QCOMPARE(int(tracer.kinds()[0xE000]), int(CodeFlowTracer::CodeStart));
+        QCOMPARE(int(tracer.kinds()[0xE003]), int(CodeFlowTracer::Unknown));
+    }
+
+    void testStopsAtUndocumentedAndOverlap()
+    {
+        put(0x6000, QByteArray("\xEA\x02", 2));          // NOP, then an undocumented opcode
+        put(0x6100, QByteArray("\x4C\x02\x61", 3));      // JMP into its own operand
+        CodeFlowTracer tracer;
+        tracer.update(memory(), {0x6000, 0x6100});
+        QCOMPARE(int(tracer.kinds()[0x6000]), int(CodeFlowTracer::CodeStart));
+        QCOMPARE(int(tracer.kinds()[0x6001]), int(CodeFlowTracer::Unknown));
+        QCOMPARE(int(tracer.kinds()[0x6102]), int(CodeFlowTracer::CodeOperand));
+    }
+
+    void testRetracesOnlyChangedPages()
+    {
+        put(0x4000, QByteArray("\x4C\x00\x41", 3));  // JMP $4100
+        put(0x4100, QByteArray("\xEA\x60", 2));      // NOP / RTS
+        CodeFlowTracer tracer;
+        tracer.update(memory(), {0x4000});
+        QCOMPARE(tracer.update(memory(), {0x4000}), 0);
+
+        // Patched code in $41xx is re-entered from the JMP outside the page
+        put(0x4100, QByteArray("\xA9\x05\x60", 3));  // LDA #$05 / RTS
+        QCOMPARE(tracer.update(memory(), QVector<unsigned short>()), 1);
+        QCOMPARE(int(tracer.kinds()[0x4100]), int(CodeFlowTracer::CodeStart));
+        QCOMPARE(int(tracer.kinds()[0x4101]), int(CodeFlowTracer::CodeOperand));
+        QCOMPARE(int(tracer.kinds()[0x4102]), int(CodeFlowTracer::CodeStart));
+    }
+
+    void testStraddlingInstructionIsDropped()
+    {
+        put(0x50FE, QByteArray("\x20\x00\x60\x60", 4));  // JSR $6000 across the page boundary / RTS
+        put(0x6000, QByteArray("\x60", 1));
+        CodeFlowTracer tracer;
+        tracer.update(memory(), {0x50FE});
+        QCOMPARE(int(tracer.kinds()[0x5100]), int(CodeFlowTracer::CodeOperand));
+
+        // Patching its high operand byte in $51xx drops the JSR in $50xx too
+        put(0x5100, QByteArray("\x70", 1));  // JSR $7000
+        put(0x7000, QByteArray("\x60", 1));
+        QCOMPARE(tracer.update(memory(), QVector<unsigned short>()), 2);
+        QCOMPARE(int(tracer.kinds()[0x50FE]), int(CodeFlowTracer::Unknown));
+        QCOMPARE(int(tracer.kinds()[0x5101]), int(CodeFlowTracer::Unknown));
+
+        QCOMPARE(tracer.update(memory(), {0x50FE}), 0);
+        QCOMPARE(int(tracer.kinds()[0x50FE]), int(CodeFlowTracer::CodeStart));
+        QCOMPARE(int(tracer.kinds()[0x5101]), int(CodeFlowTracer::CodeStart));
+        QCOMPARE(int(tracer.kinds()[0x7000]), int(CodeFlowTracer::CodeStart));
+    }
+
+    void testInstructionStartBefore()
+    {
+        put(0x7000, QByteArray("\xA9\x00"       // LDA #$00
+                               "\x8D\x00\xD4"   // STA $D400
+                               "\xE8"           // INX
+                               "\xD0\xF8", 8)); // BNE $7000
+        CodeFlowTracer tracer;
+        tracer.update(memory(), {0x7000});
+        const unsigned char* kinds = tracer.kinds();
+
+        QCOMPARE(int(CodeFlowTracer::instructionStartBefore(kinds, memory(), 0x7006, 2, 50)), 0x7002);
+        QCOMPARE(int(CodeFlowTracer::instructionStartBefore(kinds, memory(), 0x7006, 10, 50)), 0x7000);
+        QCOMPARE(int(CodeFlowTracer::instructionStartBefore(kinds, memory(), 0x7100, 10, 50)), 0x7100 - 50);
+        QCOMPARE(int(CodeFlowTracer::instructionStartBefore(nullptr, memory(), 0x7006, 10, 16)), 0x7006 - 16);
+        QCOMPARE(int(CodeFlowTracer::instructionStartBefore(nullptr, memory(), 0x0010, 10, 50)), 0);
+    }
+
+    void testParseLabels()
+    {
+        const QByteArray mads("mads 2.1.6 build 8\n"
+                              "Label table:\n"
+                              "00\t0600\tSTART\n"
+                              "00\t0600\tSTART_ALIAS\n"
+                              "01\t4000\tBANKED\n"
+                              "00\t0610\tLOOP\r\n");
+        CodeAnalyzer::Labels labels = CodeAnalyzer::parseLabels(mads);
+        QCOMPARE(labels.size(), 2);
+        QCOMPARE(labels.value(0x0600), QByteArray("START"));  // first name wins
+        QCOMPARE(labels.value(0x0610), QByteArray("LOOP"));
+        QVERIFY(!labels.contains(0x4000));
+
+        const QByteArray ca65("al 000600 .start\n"
+                              "al C:0700 .loop\n"
+                              "garbage line here\n"
+                              "al 1FFFF .toolarge\n");
+        labels = CodeAnalyzer::parseLabels(ca65);
+        QCOMPARE(labels.size(), 2);
+        QCOMPARE(labels.value(0x0600), QByteArray("start"));
+        QCOMPARE(labels.value(0x0700), QByteArray("loop"));
+        QCOMPARE(CodeAnalyzer::lookupLabel(0x0700, &labels), "loop");
+        QVERIFY(!CodeAnalyzer::lookupLabel(0x0701, &labels));
+    }
+
+    void testLoadLabelsKeepsPreviousOnError()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.path() + "/program.lbl";
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("al 002000 .main\n");
+        file.close();
+
+        CodeAnalyzer analyzer;
+        QVERIFY(analyzer.labels()->isEmpty());
+        QVERIFY(analyzer.loadLabels(path));
+        QCOMPARE(analyzer.labels()->value(0x2000), QByteArray("main"));
+
+        QString error;
+        QVERIFY(!analyzer.loadLabels(dir.path() + "/missing.lab", &error));
+        QVERIFY(!error.isEmpty());
+        QCOMPARE(analyzer.labels()->size(), 1);
+
+        analyzer.clearLabels();
+        QVERIFY(analyzer.labels()->isEmpty());
+    }
+
+    void testAnalyzerPublishesFromWorker()
+    {
+        put(0x2000, QByteArray("\x20\x00\x30\x60", 4));  // JSR $3000 / RTS
+        put(0x3000, QByteArray("\x60", 1));
+
+        CodeAnalyzer analyzer;
+        QVERIFY(!analyzer.analysis());
+        analyzer.addEntryPoint(0x2000);
+        analyzer.submit(memory());
+        QTRY_VERIFY(analyzer.analysis() != nullptr);
+        std::shared_ptr<const CodeAnalyzer::Analysis> analysis = analyzer.analysis();
+        QCOMPARE(int(analysis->kinds[0x3000]), int(CodeFlowTracer::CodeStart));
+
+        // An observed PC adds a root without an explicit entry point
+        put(0x5000, QByteArray("\xEA\x60", 2));
+        analyzer.submit(memory(), 0x5000);
+        QTRY_VERIFY(analyzer.analysis()->generation > analysis->generation);
+        QTRY_COMPARE(int(analyzer.analysis()->kinds[0x5001]), int(CodeFlowTracer::CodeStart));
+    }
+};
+
+QTEST_MAIN(TestCodeAnalyzer)
+#include "test_code_analyzer.moc"
@@ -0,0 +1,254 @@
+/*
+ * Fujisan Test Suite - Cycle Profiler Tests
+ *
+ * Verifies the profile behind debug.get_profile: each instruction is charged
+ * the cycles to the next record (stalls included, across a frame wrap, with
+ * the opcode's base cycles across a gap), JSR/RTS, interrupts/RTI and TXS
+ * drive the call graph with self and inclusive cycles, recursion counts once,
+ * XE banks split the $4000-$7FFF window, and report() orders the top N.
+ */
+
+#include "cycleprofiler.h"
+
+#include <QtTest/QtTest>
+#include <vector>
+
+class TestCycleProfiler : public QObject {
+    Q_OBJECT
+
+private:
+    // Builds records on a running beam position, PAL by default
+    struct Trace {
+        std::vector<TraceRecorder::RawRecord> records;
+        int position = 0;
+        int framePosition = 312 * CycleProfiler::kCyclesPerLine;
+
+        Trace& add(quint16 pc, quint8 opcode, int cycles, quint8 s = 0xFF, quint8 x = 0, quint8 bank = 0)
+        {
+            TraceRecorder::RawRecord r = {};
+            r.pc = pc;
+            r.opcode = opcode;
+            r.s = s;
+            r.x = x;
+            r.p = 0x30;
+            r.bank = bank;
+            r.scanline = static_cast<quint16>(position / CycleProfiler::kCyclesPerLine);
+            r.cycle = static_cast<quint8>(position % CycleProfiler::kCyclesPerLine);
+            records.push_back(r);
+            position = (position + cycles) % framePosition;
+            return *this;
+        }
+    };
+
+    static void feed(CycleProfiler& profiler, const Trace& trace)
+    {
+        profiler.addFrame(trace.records.data(), static_cast<int>(trace.records.size()));
+    }
+
+    static const CycleProfiler::Function* function(const CycleProfiler::Report& report, quint16 entry,
+                                                   bool interrupt = false)
+    {
+        for (const CycleProfiler::Function& f : report.functions) {
+            if (f.entry == entry && f.interrupt == interrupt) {
+                return &f;
+            }
+        }
+        return nullptr;
+    }
+
+private slots:
+    void testStallsChargedToInstruction()
+    {
+        // STA WSYNC waits for the end of the line: the wait is its cost
+        Trace trace;
+        trace.add(0x2000, 0xEA, 2)
+             .add(0x2001, 0x8D, 4 + 60)
+             .add(0x2004, 0xEA, 2)
+             .add(0x2005, 0xEA, 2);  // last one is pending until the next record
+        CycleProfiler profiler;
+        feed(profiler, trace);
+
+        QCOMPARE(profiler.cyclesAt(0x2000), quint64(2));
+        QCOMPARE(profiler.cyclesAt(0x2001), quint64(64));
+        QCOMPARE(profiler.cyclesAt(0x2004), quint64(2));
+        QCOMPARE(profiler.cyclesAt(0x2005), quint64(0));
+        QCOMPARE(profiler.cycles(), quint64(68));
+        QCOMPARE(profiler.instructions(), quint64(3));
+        QCOMPARE(profiler.frames(), quint64(1));
+    }
+
+    void testFrameWrapAndGaps()
+    {
+        CycleProfiler profiler;
+        Trace first;
+        first.position = 311 * CycleProfiler::kCyclesPerLine + 110;
+        first.add(0x2000, 0xEA, 6);
+        feed(profiler, first);
+        Trace second;
+        second.position = 2;
+        second.add(0x2001, 0xEA, 500)   // a gap longer than any instruction
+              .add(0x2002, 0xEA, 2);
+        feed(profiler, second);
+
+        QCOMPARE(profiler.cyclesAt(0x2000), quint64(6));  // 4 to the end of the frame, then 2
+        QCOMPARE(profiler.cyclesAt(0x2001), quint64(2));  // NOP's base cycles
+        QCOMPARE(profiler.frames(), quint64(2));
+
+        // Records lost in between: the pending instruction is not timed across them
+        Trace third;
+        third.position = 9000;
+        third.add(0x2003, 0xEA, 2).add(0x2004, 0xEA, 2);
+        profiler.addFrame(third.records.data(), static_cast<int>(third.records.size()), false);
+        QCOMPARE(profiler.cyclesAt(0x2002), quint64(0));
+        QCOMPARE(profiler.cyclesAt(0x2003), quint64(2));
+    }
+
+    void testJsrRtsSelfAndInclusive()
+    {
+        Trace trace;
+        trace.add(0x2000, 0x20, 6, 0xFF)   // JSR $3000
+             .add(0x3000, 0xEA, 2, 0xFD)
+             .add(0x3001, 0x20, 6, 0xFD)   // JSR $3100
+             .add(0x3100, 0xEA, 2, 0xFB)
+             .add(0x3101, 0x60, 6, 0xFB)   // RTS
+             .add(0x3004, 0x60, 6, 0xFD)   // RTS
+             .add(0x2003, 0xEA, 2, 0xFF)
+             .add(0x2004, 0xEA, 2, 0xFF);
+        CycleProfiler profiler;
+        feed(profiler, trace);
+        QCOMPARE(profiler.callDepth(), 0);
+
+        const CycleProfiler::Report report = profiler.report(10, 10);
+        const CycleProfiler::Function* outer = function(report, 0x3000);
+        const CycleProfiler::Function* inner = function(report, 0x3100);
+        QVERIFY(outer);
+        QVERIFY(inner);
+        QCOMPARE(outer->calls, quint64(1));
+        QCOMPARE(inner->calls, quint64(1));
+        QCOMPARE(inner->selfCycles, quint64(8));
+        QCOMPARE(inner->inclusiveCycles, quint64(8));
+        QCOMPARE(outer->selfCycles, quint64(14));
+        QCOMPARE(outer->inclusiveCycles, quint64(22));
+        QCOMPARE(report.functions.first().entry, quint16(0x3000));
+    }
+
+    void testInterruptAndRti()
+    {
+        Trace trace;
+        trace.add(0x2000, 0xEA, 2 + 7, 0xFF)  // the NMI sequence follows the NOP
+             .add(0xE000, 0x48, 3, 0xFC)      // PHA
+             .add(0xE001, 0x68, 4, 0xFB)      // PLA
+             .add(0xE002, 0x40, 6, 0xFC)      // RTI
+             .add(0x2001, 0xEA, 2, 0xFF)
+             .add(0x2002, 0xEA, 2, 0xFF);
+        CycleProfiler profiler;
+        feed(profiler, trace);
+        QCOMPARE(profiler.callDepth(), 0);
+
+        const CycleProfiler::Report report = profiler.report(10, 10);
+        QVERIFY(!function(report, 0xE000, false));
+        const CycleProfiler::Function* handler = function(report, 0xE000, true);
+        QVERIFY(handler);
+        QCOMPARE(handler->calls, quint64(1));
+        QCOMPARE(handler->inclusiveCycles, quint64(13));
+    }
+
+    void testTxsAndOpenFrames()
+    {
+        Trace trace;
+        trace.add(0x2000, 0x20, 6, 0xFF)          // JSR $3000
+             .add(0x3000, 0xA2, 2, 0xFD, 0xFF)    // LDX #$FF
+             .add(0x3002, 0x9A, 2, 0xFD, 0xFF)    // TXS: the stack is reset
+             .add(0x3003, 0x20, 6, 0xFF)          // JSR $3100, never returns
+             .add(0x3100, 0xEA, 2, 0xFD)
+             .add(0x3101, 0xEA, 2, 0xFD);
+        CycleProfiler profiler;
+        feed(profiler, trace);
+        QCOMPARE(profiler.callDepth(), 1);
+
+        const CycleProfiler::Report report = profiler.report(10, 10);
+        const CycleProfiler::Function* reset = function(report, 0x3000);
+        const CycleProfiler::Function* open = function(report, 0x3100);
+        QVERIFY(reset);
+        QVERIFY(open);
+        QCOMPARE(reset->inclusiveCycles, quint64(4));
+        QCOMPARE(open->inclusiveCycles, quint64(2));  // counts up to now
+    }
+
+    void testRecursionCountsOnce()
+    {
+        Trace trace;
+        trace.add(0x2000, 0x20, 6, 0xFF)   // JSR $3000
+             .add(0x3000, 0x20, 6, 0xFD)   // JSR $3000 again
+             .add(0x3000, 0x60, 6, 0xFB)   // RTS
+             .add(0x3003, 0x60, 6, 0xFD)   // RTS
+             .add(0x2003, 0xEA, 2, 0xFF);
+        CycleProfiler profiler;
+        feed(profiler, trace);
+
+        const CycleProfiler::Report report = profiler.report(10, 10);
+        const CycleProfiler::Function* recursive = function(report, 0x3000);
+        QVERIFY(recursive);
+        QCOMPARE(recursive->calls, quint64(2));
+        QCOMPARE(recursive->inclusiveCycles, quint64(18));
+        QCOMPARE(recursive->selfCycles, quint64(18));
+    }
+
+    void testSplitBanks()
+    {
+        Trace trace;
+        trace.add(0x4000, 0xEA, 2, 0xFF, 0, 1)
+             .add(0x4000, 0xEA, 4, 0xFF, 0, 2)
+             .add(0x2000, 0xEA, 2, 0xFF, 0, 2)   // outside the window: always bank 0
+             .add(0x2001, 0xEA, 2);
+
+        CycleProfiler merged;
+        feed(merged, trace);
+        QCOMPARE(merged.cyclesAt(0x4000), quint64(6));
+
+        CycleProfiler split;
+        split.setSplitBanks(true);
+        QCOMPARE(split.cyclesAt(0x4000, 1), quint64(0));
+        split.reset();
+        feed(split, trace);
+        QCOMPARE(split.cyclesAt(0x4000), quint64(0));
+        QCOMPARE(split.cyclesAt(0x4000, 1), quint64(2));
+        QCOMPARE(split.cyclesAt(0x4000, 2), quint64(4));
+        QCOMPARE(split.cyclesAt(0x2000), quint64(2));
+
+        const CycleProfiler::Report report = split.report(10, 10);
+        QVERIFY(report.splitBanks);
+        QCOMPARE(report.hotspots.size(), 3);
+        QCOMPARE(report.hotspots[0].address, quint16(0x4000));
+        QCOMPARE(report.hotspots[0].bank, quint8(2));
+    }
+
+    void testReportTopN()
+    {
+        Trace trace;
+        for (int i = 0; i < 5; ++i) {
+            trace.add(static_cast<quint16>(0x2000 + i), 0xEA, 2 + i);
+        }
+        trace.add(0x2005, 0xEA, 2);
+        CycleProfiler profiler;
+        feed(profiler, trace);
+
+        const quint64 before = profiler.report(1, 1).generation;
+        const CycleProfiler::Report report = profiler.report(2, 0);
+        QCOMPARE(report.hotspots.size(), 2);
+        QCOMPARE(report.hotspots[0].address, quint16(0x2004));
+        QCOMPARE(report.hotspots[0].cycles, quint64(6));
+        QCOMPARE(report.hotspots[1].address, quint16(0x2003));
+        QCOMPARE(report.functions.size(), 0);
+        QCOMPARE(report.cycles, quint64(20));
+        QCOMPARE(report.generation, before);
+
+        profiler.reset();
+        QVERIFY(profiler.report(1, 1).generation != before);
+        QCOMPARE(profiler.cycles(), quint64(0));
+        QCOMPARE(profiler.report(10, 10).hotspots.size(), 0);
+    }
+};
+
+QTEST_MAIN(TestCycleProfiler)
+#include "test_cycle_profiler.moc"
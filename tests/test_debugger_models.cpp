@@ -0,0 +1,211 @@
+/*
+ * Fujisan Test Suite - Debugger Model Tests
+ *
+ * Verifies the incremental models behind the debugger's memory and
+ * disassembly views: the first memory refresh resets the model, later ones
+ * signal only the runs of rows whose bytes changed and highlight those bytes
+ * until the next refresh, and a smaller region is labelled from its own base
+ * address. The disassembly listing signals just the lines whose text changed
+ * (PC marker moves, breakpoints, patched code) with a full reset only when
+ * its length changes, and with labels loaded gets a row per label and named
+ * operands.
+ */
+
+#include "debuggermodels.h"
+
+#include <QSignalSpy>
+#include <QtTest/QtTest>
+
+class TestDebuggerModels : public QObject {
+    Q_OBJECT
+
+private:
+    QByteArray m_memory;
+
+    unsigned char* memory() { return reinterpret_cast<unsigned char*>(m_memory.data()); }
+
+    void put(int address, const QByteArray& bytes)
+    {
+        m_memory.replace(address, bytes.size(), bytes);
+    }
+
+    static int firstRow(const QSignalSpy& spy, int signal)
+    {
+        return spy.at(signal).at(0).value<QModelIndex>().row();
+    }
+
+    static int lastRow(const QSignalSpy& spy, int signal)
+    {
+        return spy.at(signal).at(1).value<QModelIndex>().row();
+    }
+
+private slots:
+    void init()
+    {
+        m_memory = QByteArray(0x10000, '\0');
+    }
+
+    void testMemoryFirstRefreshResets()
+    {
+        MemoryViewModel model;
+        QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+        put(0xE000, QByteArray("\xA9" "ABC", 4));
+
+        QCOMPARE(model.refresh(memory()), 0);
+        QCOMPARE(resetSpy.count(), 1);
+        QCOMPARE(model.rowCount(), 4096);
+        QCOMPARE(model.columnCount(), 17);
+        QCOMPARE(model.data(model.index(0xE00, 0)).toString(), QString("A9"));
+        QCOMPARE(model.data(model.index(0xE00, MemoryViewModel::kAsciiColumn)).toString(),
+                 QString(".ABC............"));
+        QCOMPARE(model.headerData(0xE00, Qt::Vertical).toString(), QString("E000"));
+        QVERIFY(!model.isChanged(0xE000));
+    }
+
+    void testMemoryRegionOfABank()
+    {
+        MemoryViewModel model;
+        model.refresh(memory());
+        QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+        model.setRegion(0x4000, 0x4000);
+        QCOMPARE(resetSpy.count(), 1);
+        QCOMPARE(model.rowCount(), 0x400);
+        QCOMPARE(model.headerData(1, Qt::Vertical).toString(), QString("4010"));
+
+        QByteArray bank(0x4000, '\0');
+        bank[0x10] = char(0x7F);
+        QCOMPARE(model.refresh(reinterpret_cast<const unsigned char*>(bank.constData())), 0);
+        QCOMPARE(resetSpy.count(), 2);  // primed again
+        QCOMPARE(model.data(model.index(1, 0)).toString(), QString("7F"));
+
+        model.setRegion(0x20000);  // a 128 KB cartridge image
+        QCOMPARE(model.headerData(0x1FFF, Qt::Vertical).toString(), QString("01FFF0"));
+    }
+
+    void testMemorySignalsOnlyChangedRows()
+    {
+        MemoryViewModel model;
+        model.refresh(memory());
+        QSignalSpy changedSpy(&model, &QAbstractItemModel::dataChanged);
+
+        // Two adjacent rows and one far away: two runs
+        put(0x0600, QByteArray("\x01", 1));
+        put(0x061F, QByteArray("\x02", 1));
+        put(0xD000, QByteArray("\x03", 1));
+        QCOMPARE(model.refresh(memory()), 3);
+        QCOMPARE(changedSpy.count(), 2);
+        QCOMPARE(firstRow(changedSpy, 0), 0x60);
+        QCOMPARE(lastRow(changedSpy, 0), 0x61);
+        QCOMPARE(firstRow(changedSpy, 1), 0xD00);
+        QCOMPARE(lastRow(changedSpy, 1), 0xD00);
+
+        QVERIFY(model.isChanged(0x0600));
+        QVERIFY(!model.isChanged(0x0601));
+        QVERIFY(model.data(model.index(0x60, 0), Qt::ForegroundRole).isValid());
+        QVERIFY(!model.data(model.index(0x60, 1), Qt::ForegroundRole).isValid());
+        QVERIFY(model.data(model.index(0x61, MemoryViewModel::kAsciiColumn), Qt::ForegroundRole).isValid());
+        QCOMPARE(model.data(model.index(0xD00, 0)).toString(), QString("03"));
+    }
+
+    void testMemoryHighlightClearsOnNextRefresh()
+    {
+        MemoryViewModel model;
+        model.refresh(memory());
+        put(0x2000, QByteArray("\x55", 1));
+        model.refresh(memory());
+
+        QSignalSpy changedSpy(&model, &QAbstractItemModel::dataChanged);
+        QCOMPARE(model.refresh(memory()), 0);
+        QCOMPARE(changedSpy.count(), 1);  // repaint the row to drop its highlight
+        QCOMPARE(firstRow(changedSpy, 0), 0x200);
+        QVERIFY(!model.isChanged(0x2000));
+
+        QCOMPARE(model.refresh(memory()), 0);
+        QCOMPARE(changedSpy.count(), 1);  // nothing left to repaint
+    }
+
+    void testDisassemblySignalsChangedLines()
+    {
+        // LDA #$00 / STA $D01A / INX / BNE $3000
+        put(0x3000, QByteArray("\xA9\x00\x8D\x1A\xD0\xE8\xD0\xF8", 8));
+        DisassemblyModel model;
+        QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+        QSignalSpy changedSpy(&model, &QAbstractItemModel::dataChanged);
+        const QSet<unsigned short> noBreakpoints;
+
+        QCOMPARE(model.refresh(memory(), 0x3000, 0x3000, 4, 80, noBreakpoints), 4);
+        QCOMPARE(resetSpy.count(), 1);
+        QCOMPARE(model.currentRow(), 0);
+        QCOMPARE(model.lineText(0), QString("-> 3000: A9 00    LDA #$00"));
+        QCOMPARE(model.lineText(3), QString("   3006: D0 F8    BNE $3000"));
+        QVERIFY(model.data(model.index(0), Qt::BackgroundRole).isValid());
+
+        // Same memory and PC: nothing to repaint
+        QCOMPARE(model.refresh(memory(), 0x3000, 0x3000, 4, 80, noBreakpoints), 0);
+        QCOMPARE(changedSpy.count(), 0);
+
+        // The PC marker moves from line 0 to line 1
+        QCOMPARE(model.refresh(memory(), 0x3000, 0x3002, 4, 80, noBreakpoints), 2);
+        QCOMPARE(changedSpy.count(), 1);
+        QCOMPARE(firstRow(changedSpy, 0), 0);
+        QCOMPARE(lastRow(changedSpy, 0), 1);
+        QCOMPARE(model.currentRow(), 1);
+        QVERIFY(!model.data(model.index(1), Qt::ForegroundRole).isValid());
+
+        // Patched operand: the line is repainted and highlighted once
+        put(0x3004, QByteArray("\xD4", 1));
+        QCOMPARE(model.refresh(memory(), 0x3000, 0x3002, 4, 80, noBreakpoints), 1);
+        QCOMPARE(model.lineText(1), QString("-> 3002: 8D 1A D4 STA $D41A"));
+        QVERIFY(model.data(model.index(1), Qt::ForegroundRole).isValid());
+        QCOMPARE(model.refresh(memory(), 0x3000, 0x3002, 4, 80, noBreakpoints), 1);
+        QVERIFY(!model.data(model.index(1), Qt::ForegroundRole).isValid());
+        QCOMPARE(resetSpy.count(), 1);
+    }
+
+    void testDisassemblyBreakpointsAndLength()
+    {
+        put(0x4000, QByteArray("\xEA\xEA\xEA\xEA", 4));
+        DisassemblyModel model;
+        QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+        model.refresh(memory(), 0x4000, 0x4000, 3, 80, {});
+
+        QCOMPARE(model.refresh(memory(), 0x4000, 0x4000, 3, 80, {0x4002}), 1);
+        QCOMPARE(model.lineText(2), QString("B  4002: EA       NOP"));
+
+        // A different line count resets instead of diffing
+        QCOMPARE(model.refresh(memory(), 0x4000, 0x4000, 4, 80, {0x4002}), 4);
+        QCOMPARE(resetSpy.count(), 2);
+
+        // Stops once past the PC + maxForward
+        model.refresh(memory(), 0x4000, 0x4000, 100, 1, {});
+        QCOMPARE(model.rowCount(), 2);
+
+        model.clear();
+        QCOMPARE(model.rowCount(), 0);
+        QCOMPARE(model.currentRow(), -1);
+    }
+
+    void testDisassemblyLabelRows()
+    {
+        // LOOP: DEX / BNE LOOP / RTS
+        put(0x5000, QByteArray("\xCA\xD0\xFD\x60", 4));
+        QHash<unsigned short, QByteArray> labels;
+        labels.insert(0x5000, "LOOP");
+        DisassemblyModel model;
+
+        model.refresh(memory(), 0x5000, 0x5001, 3, 80, {}, &labels);
+        QCOMPARE(model.rowCount(), 4);  // three instructions plus the label
+        QCOMPARE(model.lineText(0), QString("         LOOP:"));
+        QCOMPARE(model.lineText(1), QString("   5000: CA       DEX"));
+        QCOMPARE(model.lineText(2), QString("-> 5001: D0 FD    BNE LOOP"));
+        QCOMPARE(model.currentRow(), 2);
+
+        // Without labels the listing is plain again
+        model.refresh(memory(), 0x5000, 0x5001, 3, 80, {});
+        QCOMPARE(model.rowCount(), 3);
+        QCOMPARE(model.lineText(1), QString("-> 5001: D0 FD    BNE $5000"));
+    }
+};
+
+QTEST_MAIN(TestDebuggerModels)
+#include "test_debugger_models.moc"
@@ -0,0 +1,182 @@
+/*
+ * Fujisan Test Suite - 6502 Decoder Tests
+ *
+ * Verifies the shared opcode table and text formatters behind the debugger
+ * window, debug.disassemble and step over: instruction sizes agree with the
+ * addressing modes, flow-control kinds and base cycle counts of known
+ * opcodes, operand text for every mode, branch targets in both directions,
+ * operands that wrap at $FFFF, how undocumented opcodes are shown, and label
+ * substitution in the symbolic formatter.
+ */
+
+#include "disasm6502.h"
+
+#include <QtTest/QtTest>
+
+class TestDisasm6502 : public QObject {
+    Q_OBJECT
+
+private:
+    QByteArray m_memory;
+
+    const unsigned char* memory() const { return reinterpret_cast<const unsigned char*>(m_memory.constData()); }
+
+    void put(int address, const QByteArray& bytes)
+    {
+        m_memory.replace(address, bytes.size(), bytes);
+    }
+
+    QString text(int address)
+    {
+        char out[kInstructionText6502];
+        formatInstruction6502(memory(), static_cast<unsigned short>(address), out);
+        return QString::fromLatin1(out);
+    }
+
+    static const char* testLabel(unsigned short address, const void*)
+    {
+        switch (address) {
+            case 0x0080: return "PTR";
+            case 0x3000: return "LOOP";
+            case 0xE456: return "CIOV";
+            case 0x5000: return "A_LABEL_FAR_LONGER_THAN_THIRTY_TWO_CHARACTERS";
+            default: return nullptr;
+        }
+    }
+
+    QString symbolic(int address)
+    {
+        char out[kSymbolicText6502];
+        formatInstructionSymbolic6502(memory(), static_cast<unsigned short>(address), &testLabel, nullptr, out);
+        return QString::fromLatin1(out);
+    }
+
+private slots:
+    void init()
+    {
+        m_memory = QByteArray(0x10000, '\0');
+    }
+
+    void testSizesMatchModes()
+    {
+        for (int opcode = 0; opcode < 256; ++opcode) {
+            const OpcodeInfo6502& info = opcodeInfo6502(static_cast<unsigned char>(opcode));
+            int expected = 2;
+            switch (info.mode) {
+                case AddressMode6502::Implied:
+                case AddressMode6502::Accumulator:
+                    expected = 1;
+                    break;
+                case AddressMode6502::Absolute:
+                case AddressMode6502::AbsoluteX:
+                case AddressMode6502::AbsoluteY:
+                case AddressMode6502::Indirect:
+                    expected = 3;
+                    break;
+                default:
+                    break;
+            }
+            QCOMPARE(int(info.bytes), expected);
+            QCOMPARE(info.flow == FlowKind6502::Branch, info.mode == AddressMode6502::Relative);
+        }
+    }
+
+    void testFlowKindsAndCycles()
+    {
+        QCOMPARE(opcodeInfo6502(0x20).flow, FlowKind6502::Call);
+        QCOMPARE(opcodeInfo6502(0x60).flow, FlowKind6502::Return);
+        QCOMPARE(opcodeInfo6502(0x40).flow, FlowKind6502::ReturnFromInterrupt);
+        QCOMPARE(opcodeInfo6502(0x00).flow, FlowKind6502::Break);
+        QCOMPARE(opcodeInfo6502(0x4C).flow, FlowKind6502::Jump);
+        QCOMPARE(opcodeInfo6502(0x6C).flow, FlowKind6502::JumpIndirect);
+        QCOMPARE(opcodeInfo6502(0xA9).flow, FlowKind6502::None);
+
+        QCOMPARE(int(opcodeInfo6502(0x20).cycles), 6);  // JSR
+        QCOMPARE(int(opcodeInfo6502(0xBD).cycles), 4);  // LDA abs,X (+1 on a page cross)
+        QCOMPARE(int(opcodeInfo6502(0x9D).cycles), 5);  // STA abs,X always pays the extra cycle
+        QCOMPARE(int(opcodeInfo6502(0x91).cycles), 6);  // STA (zp),Y
+        QCOMPARE(int(opcodeInfo6502(0xFE).cycles), 7);  // INC abs,X
+        QCOMPARE(int(opcodeInfo6502(0x68).cycles), 4);  // PLA
+    }
+
+    void testOperandText()
+    {
+        put(0x2000, QByteArray("\xA9\x0F" "\xB5\x80" "\xB6\x81" "\x8D\x00\xD4"
+                               "\x9D\x34\x12" "\xB9\xCD\xAB" "\x6C\xFE\x02" "\x81\x10"
+                               "\xB1\x12" "\x0A" "\xEA", 24));
+        int address = 0x2000;
+        const QStringList expected = {"LDA #$0F", "LDA $80,X", "LDX $81,Y", "STA $D400",
+                                      "STA $1234,X", "LDA $ABCD,Y", "JMP ($02FE)", "STA ($10,X)",
+                                      "LDA ($12),Y", "ASL", "NOP"};
+        for (const QString& line : expected) {
+            char out[kInstructionText6502];
+            const int bytes = formatInstruction6502(memory(), static_cast<unsigned short>(address), out);
+            QCOMPARE(QString::fromLatin1(out), line);
+            address += bytes;
+        }
+        QCOMPARE(address, 0x2000 + 24);
+    }
+
+    void testBranchTargets()
+    {
+        put(0x3000, QByteArray("\xD0\xFE", 2));  // BNE to itself
+        QCOMPARE(text(0x3000), QString("BNE $3000"));
+        put(0x3010, QByteArray("\x10\x7F", 2));  // furthest forward
+        QCOMPARE(text(0x3010), QString("BPL $3091"));
+        put(0x0000, QByteArray("\xF0\x80", 2));  // backwards across $0000
+        QCOMPARE(text(0x0000), QString("BEQ $FF82"));
+    }
+
+    void testOperandsWrapAtTopOfMemory()
+    {
+        put(0xFFFF, QByteArray("\x20", 1));
+        put(0x0000, QByteArray("\x00\xE4", 2));
+        QCOMPARE(text(0xFFFF), QString("JSR $E400"));
+
+        char hex[kInstructionText6502];
+        QCOMPARE(formatInstructionBytes6502(memory(), 0xFFFF, hex), 8);
+        QCOMPARE(QString::fromLatin1(hex), QString("20 00 E4"));
+    }
+
+    void testUndocumentedOpcodes()
+    {
+        put(0x4000, QByteArray("\x02\xFF", 2));
+        char out[kInstructionText6502];
+        QCOMPARE(formatInstruction6502(memory(), 0x4000, out), 1);
+        QCOMPARE(QString::fromLatin1(out), QString("???"));
+        QCOMPARE(int(opcodeInfo6502(0x02).cycles), 0);
+        QCOMPARE(text(0x4001), QString("???"));
+    }
+
+    void testSymbolicOperands()
+    {
+        put(0x2000, QByteArray("\x20\x56\xE4"   // JSR CIOV
+                               "\xB1\x80"       // LDA (PTR),Y
+                               "\xA9\x80"       // LDA #$80 stays numeric
+                               "\xD0\xF7"       // BNE $2000 (no label)
+                               "\x4C\x00\x50"  // JMP to a long label
+                               "\x8D\x00\xD4"  // STA $D400 (no label)
+                               "\x6C\x80\x00", 18)); // JMP (PTR)
+        QCOMPARE(symbolic(0x2000), QString("JSR CIOV"));
+        QCOMPARE(symbolic(0x2003), QString("LDA (PTR),Y"));
+        QCOMPARE(symbolic(0x2005), QString("LDA #$80"));
+        QCOMPARE(symbolic(0x2007), QString("BNE $2000"));
+        QCOMPARE(symbolic(0x2009), QString("JMP A_LABEL_FAR_LONGER_THAN_THIRTY_T"));  // cut at 32
+        QCOMPARE(symbolic(0x200C), QString("STA $D400"));
+        QCOMPARE(symbolic(0x200F), QString("JMP (PTR)"));
+
+        put(0x3002, QByteArray("\xD0\xFC", 2));  // BNE LOOP
+        QCOMPARE(symbolic(0x3002), QString("BNE LOOP"));
+        char out[kSymbolicText6502];
+        QCOMPARE(formatInstructionSymbolic6502(memory(), 0x3002, nullptr, nullptr, out), 2);
+        QCOMPARE(QString::fromLatin1(out), QString("BNE $3000"));
+
+        unsigned short target = 0;
+        QVERIFY(operandAddress6502(memory(), 0x2003, &target));
+        QCOMPARE(int(target), 0x80);
+        QVERIFY(!operandAddress6502(memory(), 0x2005, &target));
+    }
+};
+
+QTEST_MAIN(TestDisasm6502)
+#include "test_disasm6502.moc"
@@ -0,0 +1,167 @@
+/*
+ * Fujisan Test Suite - Disk Image Cache Tests
+ *
+ * Verifies DiskImageCache: images read once and shared across mounts until
+ * the file changes, LRU eviction, copy-on-write overlays that leave the
+ * original untouched, sector diffs for single and double density ATRs and
+ * XFDs, and commit / discard of an overlay.
+ */
+
+#include "diskimagecache.h"
+
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+
+namespace {
+// Single density ATR: 16-byte header, 128-byte sectors
+QByteArray makeAtr(int sectors, int sectorSize = 128)
+{
+    const int bootSize = sectorSize == 256 ? 128 : sectorSize;
+    const int dataBytes = 3 * bootSize + (sectors - 3) * sectorSize;
+    QByteArray image(16 + dataBytes, '\0');
+    image[0] = char(0x96);
+    image[1] = char(0x02);
+    image[2] = char((dataBytes / 16) & 0xFF);
+    image[3] = char(((dataBytes / 16) >> 8) & 0xFF);
+    image[4] = char(sectorSize & 0xFF);
+    image[5] = char(sectorSize >> 8);
+    return image;
+}
+
+bool writeFile(const QString& path, const QByteArray& bytes)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(bytes) == bytes.size();
+}
+
+QByteArray readFile(const QString& path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+}
+
+class TestDiskImageCache : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testImageIsSharedUntilFileChanges()
+    {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("game.atr");
+        QVERIFY(writeFile(path, makeAtr(720)));
+
+        DiskImageCache cache(dir.path());
+        const QByteArray first = cache.image(path);
+        const QByteArray second = cache.image(path);
+        QCOMPARE(first.size(), 16 + 720 * 128);
+        QCOMPARE(second.constData(), first.constData());  // same bytes, no second read
+        QCOMPARE(cache.cachedImageCount(), 1);
+
+        // A different size (or timestamp) is a new image
+        QVERIFY(writeFile(path, makeAtr(1040)));
+        QCOMPARE(cache.image(path).size(), 16 + 1040 * 128);
+        QCOMPARE(cache.cachedBytes(), qint64(16 + 1040 * 128));
+
+        QString error;
+        QVERIFY(cache.image(dir.filePath("missing.atr"), &error).isEmpty());
+        QVERIFY(!error.isEmpty());
+    }
+
+    void testEvictsLeastRecentlyUsed()
+    {
+        QTemporaryDir dir;
+        DiskImageCache cache(dir.path());
+        const QByteArray image = makeAtr(720);
+        for (const char* name : {"a.atr", "b.atr", "c.atr"}) {
+            QVERIFY(writeFile(dir.filePath(name), image));
+        }
+        cache.image(dir.filePath("a.atr"));
+        cache.image(dir.filePath("b.atr"));
+        cache.image(dir.filePath("a.atr"));  // b is now the oldest
+        cache.setMaxCachedBytes(2 * image.size());
+        cache.image(dir.filePath("c.atr"));
+        QCOMPARE(cache.cachedImageCount(), 2);
+        QCOMPARE(cache.cachedBytes(), qint64(2 * image.size()));
+    }
+
+    void testLayouts()
+    {
+        DiskImageCache::Layout layout;
+        QVERIFY(DiskImageCache::layoutOf(makeAtr(720), &layout));
+        QCOMPARE(layout.sectorCount, 720);
+        QCOMPARE(layout.offset(4), 16 + 3 * 128);
+
+        // Double density: the three boot sectors are stored short
+        QVERIFY(DiskImageCache::layoutOf(makeAtr(720, 256), &layout));
+        QCOMPARE(layout.sectorCount, 720);
+        QCOMPARE(layout.size(3), 128);
+        QCOMPARE(layout.size(4), 256);
+        QCOMPARE(layout.offset(5), 16 + 3 * 128 + 256);
+
+        QVERIFY(DiskImageCache::layoutOf(QByteArray(720 * 128, '\0'), &layout));  // XFD
+        QCOMPARE(layout.headerBytes, 0);
+        QCOMPARE(layout.sectorCount, 720);
+
+        QVERIFY(!DiskImageCache::layoutOf(QByteArray(1000, '\0'), &layout));
+    }
+
+    void testOverlayLeavesOriginalUntouched()
+    {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("work.atr");
+        const QByteArray pristine = makeAtr(720);
+        QVERIFY(writeFile(path, pristine));
+
+        DiskImageCache cache(dir.path());
+        const QString working = cache.beginOverlay(1, path);
+        QVERIFY(!working.isEmpty());
+        QVERIFY(working != path);
+        QVERIFY(cache.hasOverlay(1));
+        QVERIFY(!cache.overlayChanged(1));
+        QVERIFY(cache.changedSectors(1).isEmpty());
+
+        // What the core would do: write sectors 2 and 400 of the mounted copy
+        QByteArray modified = pristine;
+        DiskImageCache::Layout layout;
+        QVERIFY(DiskImageCache::layoutOf(modified, &layout));
+        modified[layout.offset(2)] = 'x';
+        modified[layout.offset(400) + 127] = 'y';
+        QVERIFY(writeFile(working, modified));
+
+        QVERIFY(cache.overlayChanged(1));
+        QCOMPARE(cache.changedSectors(1), QVector<int>({2, 400}));
+        QCOMPARE(cache.overlaySector(1, 2).at(0), 'x');
+        QCOMPARE(readFile(path), pristine);
+
+        cache.discardOverlay(1);
+        QVERIFY(!cache.hasOverlay(1));
+        QVERIFY(!QFile::exists(working));
+        QCOMPARE(readFile(path), pristine);
+    }
+
+    void testCommitWritesBack()
+    {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("save.atr");
+        QVERIFY(writeFile(path, makeAtr(720)));
+
+        DiskImageCache cache(dir.path());
+        const QString working = cache.beginOverlay(2, path);
+        QByteArray modified = readFile(working);
+        modified[16] = 'z';
+        QVERIFY(writeFile(working, modified));
+
+        QString error;
+        QVERIFY(cache.commitOverlay(2, &error));
+        QVERIFY(!cache.hasOverlay(2));
+        QCOMPARE(readFile(path), modified);
+        QCOMPARE(cache.image(path), modified);  // the cache has the committed bytes
+
+        QVERIFY(!cache.commitOverlay(2, &error));  // nothing left to commit
+        QVERIFY(error.contains("no disk overlay"));
+    }
+};
+
+QTEST_MAIN(TestDiskImageCache)
+#include "test_disk_image_cache.moc"
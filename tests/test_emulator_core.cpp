@@ -0,0 +1,526 @@
+/*
+ * Fujisan Test Suite - Emulator Core Tests
+ *
+ * Drives AtariEmulator on the real libatari800 without a frame timer:
+ * fastLoadXex() refusing segments over its stack return address and
+ * counting the frames its INIT routines run, and core breakpoints halting
+ * mid-frame in front of the flagged instruction, resuming off it without
+ * firing again, staying unarmed while disabled, and leaving the frames of
+ * an unarmed machine exactly as they were; stepOver() returning from a
+ * JSR, running on through deeper recursion that reaches the same return
+ * address, stopping at a breakpoint inside the routine, ending on a pause
+ * or cancelRunTo(), and stepping once on anything but a JSR; run-ahead
+ * staying off while a disk is attached, so the image is not re-opened;
+ * a turbo paste and a tape load overlapping on the user's speed.
+ */
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QSettings>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtWidgets/QApplication>
+#include <QtTest/QtTest>
+
+#include "atariemulator.h"
+
+extern "C" {
+#include "sio.h"
+}
+
+namespace {
+// An XL without BASIC is in the self test, with the OS running VBIs, well before this
+constexpr int kBootFrames = 120;
+
+QByteArray word(int value)
+{
+    QByteArray bytes;
+    bytes.append(static_cast<char>(value & 0xFF));
+    bytes.append(static_cast<char>((value >> 8) & 0xFF));
+    return bytes;
+}
+
+QByteArray segment(int start, const QByteArray& data)
+{
+    return word(start) + word(start + data.size() - 1) + data;
+}
+
+QByteArray xexHeader()
+{
+    return QByteArray("\xFF\xFF", 2);
+}
+
+// LDA VCOUNT / CMP #$40 / BNE $0600 / STA $0680 / INC $0681 / JMP $060A: the
+// STA at kMidFrameStore runs once, halfway down the first frame that reaches line 128
+constexpr unsigned short kMidFrameStore = 0x0607;
+
+QByteArray midFrameProgram()
+{
+    const QByteArray code("\xAD\x0B\xD4\xC9\x40\xD0\xF9\x8D\x80\x06\xEE\x81\x06\x4C\x0A\x06", 16);
+    return xexHeader() + segment(0x0600, code) + segment(0x0680, QByteArray(2, '\x00'))
+           + segment(0x02E0, word(0x0600));
+}
+
+// Step-over code at $0600: the JSR there returns to kReturnAddress, into a
+// routine at $0610
+constexpr unsigned short kReturnAddress = 0x0603;
+
+QByteArray stepOverProgram(const QByteArray& afterCall, const QByteArray& routine)
+{
+    QByteArray code(0x20, '\xEA');
+    code.replace(0x00, 3, QByteArray("\x20\x10\x06", 3));
+    code.replace(0x03, afterCall.size(), afterCall);
+    code.replace(0x10, routine.size(), routine);
+    return code;
+}
+
+// LDA #$2A / STA $0680 / RTS
+const QByteArray kStoreRoutine("\xA9\x2A\x8D\x80\x06\x60", 6);
+// JMP $0603
+const QByteArray kSpin("\x4C\x03\x06", 3);
+
+// A blank single density ATR: the 16 byte header, then 720 sectors of 128 bytes
+QByteArray blankAtr()
+{
+    QByteArray header(16, '\x00');
+    header[0] = '\x96';
+    header[1] = '\x02';
+    header[2] = '\x80';  // 5760 paragraphs of 16 bytes
+    header[3] = '\x16';
+    header[4] = '\x80';  // 128 byte sectors
+    return header + QByteArray(720 * 128, '\x00');
+}
+
+QByteArray casChunk(const QByteArray& id, int aux, const QByteArray& data)
+{
+    return id + word(data.size()) + word(aux) + data;
+}
+
+// A CAS tape of three standard records, each after a 10 s gap, so a load is
+// still in progress for as long as a test runs
+QByteArray casTape()
+{
+    QByteArray tape = casChunk("FUJI", 0, QByteArray()) + casChunk("baud", 600, QByteArray());
+    const QByteArray record = QByteArray("\x55\x55\xFC", 3) + QByteArray(129, '\x00');
+    for (int i = 0; i < 3; ++i) {
+        tape += casChunk("data", 10000, record);
+    }
+    return tape;
+}
+
+// All of RAM and the screen, so two runs can be compared frame for frame
+QByteArray frameOutput(const AtariEmulator& emu)
+{
+    return emu.readMemoryBlock(0, 0, 0x10000)
+           + QByteArray(reinterpret_cast<const char*>(libatari800_get_screen_ptr()), 384 * 240);
+}
+}  // namespace
+
+class TestEmulatorCore : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_tempDir;
+
+    static bool boot(AtariEmulator& emu)
+    {
+        emu.setDeferTimerStart(true);
+        emu.enableAudio(false);
+        if (!emu.initializeWithConfig(false, QStringLiteral("-xl"), QStringLiteral("-pal"),
+                                      QStringLiteral("none"))) {
+            return false;
+        }
+        for (int i = 0; i < kBootFrames; ++i) {
+            emu.processFrame();
+        }
+        return true;
+    }
+
+    static unsigned short nmiHandler(const AtariEmulator& emu)
+    {
+        const QByteArray vector = emu.readMemoryBlock(0, 0xFFFA, 2);
+        return static_cast<unsigned short>(static_cast<unsigned char>(vector[0])
+                                           | (static_cast<unsigned char>(vector[1]) << 8));
+    }
+
+    // Pauses and puts the CPU on $0600 with the stepOverProgram() given
+    static void enterProgram(AtariEmulator& emu, const QByteArray& code)
+    {
+        emu.pauseEmulation();
+        QVERIFY(emu.writeMemoryBlock(0, 0x0600, code));
+        QVERIFY(emu.writeMemoryBlock(0, 0x0680, QByteArray(2, '\x00')));
+        CPU_regPC = 0x0600;
+    }
+
+    static QByteArray runFrames(AtariEmulator& emu, int frames)
+    {
+        for (int i = 0; i < frames; ++i) {
+            emu.processFrame();
+        }
+        return frameOutput(emu);
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_tempDir.isValid());
+        QCoreApplication::setOrganizationName(QStringLiteral("8bitrelics"));
+        QCoreApplication::setApplicationName(QStringLiteral("Fujisan"));
+        QSettings::setDefaultFormat(QSettings::IniFormat);
+        QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, m_tempDir.path());
+    }
+
+    void testFastLoadRejectsSegmentsOverTheStackReturn()
+    {
+        AtariEmulator emu(nullptr);
+        QVERIFY(boot(emu));
+
+        // LDA #$2A / STA $0680 / RTS, plus a byte at $01FF under the final RTS's address
+        const QByteArray code("\xA9\x2A\x8D\x80\x06\x60", 6);
+        const QByteArray xex = xexHeader() + segment(0x0600, code) + segment(0x01FF, QByteArray(1, '\x00'))
+                               + segment(0x02E0, word(0x0600));
+        QString error;
+        QVERIFY(!emu.fastLoadXex(xex, &error));
+        QVERIFY2(error.contains("$01FE-$01FF"), qPrintable(error));
+        // Refused before anything was written
+        QVERIFY(emu.readMemoryBlock(0, 0x0600, code.size()) != code);
+
+        // Lower in the stack page is the program's business
+        const QByteArray low = xexHeader() + segment(0x0600, code) + segment(0x0140, QByteArray(4, '\x00'))
+                               + segment(0x02E0, word(0x0600));
+        QVERIFY2(emu.fastLoadXex(low, &error), qPrintable(error));
+        QCOMPARE(emu.readMemoryBlock(0, 0x0600, code.size()), code);
+        emu.shutdown();
+    }
+
+    void testFastLoadInitFramesAreCounted()
+    {
+        AtariEmulator emu(nullptr);
+        QVERIFY(boot(emu));
+
+        // INIT: LDA RTCLOK+2 / CMP RTCLOK+2 / BEQ *-2 / LDA #$2A / STA $0680 / RTS,
+        // which returns only after the next vertical blank
+        const QByteArray init("\xA5\x14\xC5\x14\xF0\xFC\xA9\x2A\x8D\x80\x06\x60", 12);
+        const QByteArray xex = xexHeader() + segment(0x0600, init) + segment(0x02E2, word(0x0600))
+                               + segment(0x0700, QByteArray("\x60", 1)) + segment(0x02E0, word(0x0700));
+        const quint64 framesBefore = emu.getCurrentFrame();
+        QString error;
+        QVERIFY2(emu.fastLoadXex(xex, &error), qPrintable(error));
+        QCOMPARE(emu.readMemoryBlock(0, 0x0680, 1), QByteArray("\x2A", 1));
+        QVERIFY(emu.getCurrentFrame() > framesBefore);
+        emu.shutdown();
+    }
+
+    void testRunAheadStaysOffWhileADiskIsAttached()
+    {
+        AtariEmulator emu(nullptr);
+        QVERIFY(boot(emu));
+        emu.setRunAheadFrames(2);
+        emu.processFrame();
+        QVERIFY(emu.getRunAheadStatus()["active"].toBool());
+
+        const QString atrPath = m_tempDir.filePath(QStringLiteral("runahead.atr"));
+        QFile atr(atrPath);
+        QVERIFY(atr.open(QIODevice::WriteOnly));
+        atr.write(blankAtr());
+        atr.close();
+        QVERIFY(emu.mountDiskImage(1, atrPath));
+        runFrames(emu, 5);
+        QVERIFY(!emu.getRunAheadStatus()["active"].toBool());
+        QCOMPARE(int(SIO_drive_status[0]), int(SIO_READ_WRITE));
+
+        // A restored state would re-mount D1: from its file, and fail now that the
+        // file is gone (where an open file can be removed at all)
+        if (QFile::remove(atrPath)) {
+            runFrames(emu, 5);
+            QCOMPARE(int(SIO_drive_status[0]), int(SIO_READ_WRITE));
+            QCOMPARE(QString::fromLocal8Bit(SIO_filename[0]), atrPath);
+        }
+        QCOMPARE(emu.getDiskImagePath(1), atrPath);
+
+        emu.dismountDiskImage(1);
+        emu.processFrame();
+        QVERIFY(emu.getRunAheadStatus()["active"].toBool());
+        emu.shutdown();
+    }
+
+    void testSpeedBoostsOverlapOnTheUserSpeed()
+    {
+        AtariEmulator emu(nullptr);
+        QVERIFY(boot(emu));
+        emu.setEmulationSpeed(200);
+        // LDA #$34 / STA PACTL / JMP *: the cassette motor stays on
+        const QByteArray code("\xA9\x34\x8D\x02\xD3\x4C\x05\x06", 8);
+        QString error;
+        QVERIFY2(emu.fastLoadXex(xexHeader() + segment(0x0600, code) + segment(0x02E0, word(0x0600)), &error),
+                 qPrintable(error));
+        const QString tapePath = m_tempDir.filePath(QStringLiteral("boost.cas"));
+        QFile tape(tapePath);
+        QVERIFY(tape.open(QIODevice::WriteOnly));
+        tape.write(casTape());
+        tape.close();
+        const auto tapeLoading = [&emu]() {
+            return emu.getCassetteStatus()["tape_acceleration"].toObject()["active"].toBool();
+        };
+        // Nothing reads CH, so the first key of this stays queued and the paste never drains
+        const QByteArray text(200, 'A');
+
+        // Tape first, then a paste that ends before it does
+        QVERIFY(emu.insertCassette(tapePath, true));
+        for (int i = 0; i < 10 && !tapeLoading(); ++i) {
+            emu.processFrame();
+        }
+        QVERIFY(tapeLoading());
+        QCOMPARE(emu.getCurrentEmulationSpeed(), 0);
+        emu.queueText(text, true);
+        QCOMPARE(emu.getCurrentEmulationSpeed(), 0);
+        emu.cancelQueuedText();
+        QCOMPARE(emu.getCurrentEmulationSpeed(), 0);
+        // A speed chosen meanwhile is the one the last boost returns to
+        emu.setEmulationSpeed(300);
+        QCOMPARE(emu.getCurrentEmulationSpeed(), 0);
+        emu.ejectCassette();
+        QCOMPARE(emu.getCurrentEmulationSpeed(), 300);
+
+        // A paste first, then a tape load that ends before it does
+        emu.queueText(text, true);
+        QCOMPARE(emu.getCurrentEmulationSpeed(), 0);
+        QVERIFY(emu.insertCassette(tapePath, true));
+        for (int i = 0; i < 10 && !tapeLoading(); ++i) {
+            emu.processFrame();
+        }
+        QVERIFY(tapeLoading());
+        emu.ejectCassette();
+        QVERIFY(!tapeLoading());
+        QCOMPARE(emu.getCurrentEmulationSpeed(), 0);
+        emu.cancelQueuedText();
+        QCOMPARE(emu.getCurrentEmulationSpeed(), 300);
+        emu.shutdown();
+    }
+
+    void testBreakpointHaltsMidFrameInFrontOfTheInstruction()
+    {
+        AtariEmulator emu(nullptr);
+        QVERIFY(boot(emu));
+        QSignalSpy hits(&emu, &AtariEmulator::breakpointHit);
+        emu.addBreakpoint(kMidFrameStore);
+        QString error;
+        QVERIFY2(emu.fastLoadXex(midFrameProgram(), &error), qPrintable(error));
+
+        for (int i = 0; i < 3 && hits.isEmpty(); ++i) {
+            emu.processFrame();
+        }
+        QCOMPARE(hits.count(), 1);
+        QCOMPARE(hits.first().first().value<unsigned short>(), kMidFrameStore);
+        QVERIFY(emu.isEmulationPaused());
+        QCOMPARE(CPU_regPC, kMidFrameStore);
+        QCOMPARE(CPU_regA, static_cast<unsigned char>(0x40));
+        // The STA has not run yet
+        QCOMPARE(emu.readMemoryBlock(0, 0x0680, 1), QByteArray(1, '\x00'));
+
+        // Frames run while halted idle at the breakpoint and report nothing more
+        emu.processFrame();
+        QCOMPARE(CPU_regPC, kMidFrameStore);
+        QCOMPARE(hits.count(), 1);
+        emu.shutdown();
+    }
+
+    void testResumeStepsOffTheBreakpoint()
+    {
+        AtariEmulator emu(nullptr);
+        QVERIFY(boot(emu));
+        QSignalSpy hits(&emu, &AtariEmulator::breakpointHit);
+        emu.addBreakpoint(kMidFrameStore);
+        QString error;
+        QVERIFY2(emu.fastLoadXex(midFrameProgram(), &error), qPrintable(error));
+        for (int i = 0; i < 3 && hits.isEmpty(); ++i) {
+            emu.processFrame();
+        }
+        QCOMPARE(hits.count(), 1);
+
+        emu.resumeEmulation();
+        QVERIFY(!emu.isEmulationPaused());
+        QVERIFY(emu.hasBreakpoint(kMidFrameStore));
+        runFrames(emu, 3);
+        QCOMPARE(hits.count(), 1);
+        QVERIFY(!emu.isEmulationPaused());
+        // The flagged STA ran, and the loop after it is running
+        QCOMPARE(emu.readMemoryBlock(0, 0x0680, 1), QByteArray("\x40", 1));
+        QVERIFY(emu.readMemoryBlock(0, 0x0681, 1) != QByteArray(1, '\x00'));
+        emu.shutdown();
+    }
+
+    void testDisabledBreakpointsStayUnarmed()
+    {
+        AtariEmulator emu(nullptr);
+        QVERIFY(boot(emu));
+        QSignalSpy hits(&emu, &AtariEmulator::breakpointHit);
+        // The OS runs its NMI handler at least once every frame
+        const unsigned short handler = nmiHandler(emu);
+        emu.setBreakpointsEnabled(false);
+        emu.addBreakpoint(handler);
+        runFrames(emu, 3);
+        QCOMPARE(hits.count(), 0);
+        QVERIFY(!emu.isEmulationPaused());
+
+        emu.setBreakpointsEnabled(true);
+        emu.processFrame();
+        QCOMPARE(hits.count(), 1);
+        QCOMPARE(hits.first().first().value<unsigned short>(), handler);
+        QCOMPARE(CPU_regPC, handler);
+        emu.shutdown();
+    }
+
+    void testUnarmedBreakpointsLeaveFramesUnchanged()
+    {
+        constexpr int kFrames = 30;
+        AtariEmulator emu(nullptr);
+        QVERIFY(boot(emu));
+        QSignalSpy hits(&emu, &AtariEmulator::breakpointHit);
+        const QString statePath = m_tempDir.filePath(QStringLiteral("unarmed.a8s"));
+        QVERIFY(emu.saveState(statePath));
+        const QByteArray reference = runFrames(emu, kFrames);
+
+        // A breakpoint that was set and removed again leaves nothing armed
+        QVERIFY(emu.loadState(statePath));
+        emu.addBreakpoint(nmiHandler(emu));
+        emu.removeBreakpoint(nmiHandler(emu));
+        QVERIFY(runFrames(emu, kFrames) == reference);
+
+        // Nor does one that is set while breakpoints are disabled
+        QVERIFY(emu.loadState(statePath));
+        emu.setBreakpointsEnabled(false);
+        emu.addBreakpoint(nmiHandler(emu));
+        QVERIFY(runFrames(emu, kFrames) == reference);
+        QCOMPARE(hits.count(), 0);
+        emu.shutdown();
+    }
+
+    void testStepOverReturnsFromTheCall()
+    {
+        AtariEmulator emu(nullptr);
+        QVERIFY(boot(emu));
+        enterProgram(emu, stepOverProgram(kSpin, kStoreRoutine));
+        const unsigned char stack = CPU_regS;
+        QSignalSpy finished(&emu, &AtariEmulator::runToFinished);
+
+        QVERIFY(emu.stepOver());
+        QTRY_COMPARE(finished.count(), 1);
+        QCOMPARE(finished.first().at(0).value<unsigned short>(), kReturnAddress);
+        QVERIFY(finished.first().at(1).toBool());
+        QCOMPARE(CPU_regPC, kReturnAddress);
+        QCOMPARE(CPU_regS, stack);
+        QCOMPARE(emu.readMemoryBlock(0, 0x0680, 1), QByteArray("\x2A", 1));
+        QVERIFY(!emu.isRunToActive());
+        QVERIFY(emu.isEmulationPaused());
+        emu.shutdown();
+    }
+
+    void testStepOverRunsThroughDeeperRecursion()
+    {
+        AtariEmulator emu(nullptr);
+        QVERIFY(boot(emu));
+        // The code after the call is an RTS, and the routine recurses through the JSR
+        // at $0600 until $0681 counts down: DEC $0681 / BEQ +3 / JMP $0600 / RTS.
+        // The inner calls return to $0603 with the stack two and four bytes deeper.
+        enterProgram(emu, stepOverProgram(QByteArray("\x60", 1),
+                                          QByteArray("\xCE\x81\x06\xF0\x03\x4C\x00\x06\x60", 9)));
+        QVERIFY(emu.writeMemoryBlock(0, 0x0681, QByteArray("\x03", 1)));
+        const unsigned char stack = CPU_regS;
+        QSignalSpy finished(&emu, &AtariEmulator::runToFinished);
+
+        QVERIFY(emu.stepOver());
+        QTRY_COMPARE(finished.count(), 1);
+        QCOMPARE(finished.first().at(0).value<unsigned short>(), kReturnAddress);
+        QVERIFY(finished.first().at(1).toBool());
+        QCOMPARE(CPU_regS, stack);
+        QCOMPARE(emu.readMemoryBlock(0, 0x0681, 1), QByteArray(1, '\x00'));
+        emu.shutdown();
+    }
+
+    void testStepOverStopsAtABreakpointInside()
+    {
+        AtariEmulator emu(nullptr);
+        QVERIFY(boot(emu));
+        enterProgram(emu, stepOverProgram(kSpin, kStoreRoutine));
+        const unsigned short store = 0x0612;
+        emu.addBreakpoint(store);
+        QSignalSpy finished(&emu, &AtariEmulator::runToFinished);
+        QSignalSpy hits(&emu, &AtariEmulator::breakpointHit);
+
+        QVERIFY(emu.stepOver());
+        QTRY_COMPARE(finished.count(), 1);
+        QCOMPARE(finished.first().at(0).value<unsigned short>(), store);
+        QVERIFY(!finished.first().at(1).toBool());
+        QCOMPARE(hits.count(), 1);
+        QCOMPARE(hits.first().first().value<unsigned short>(), store);
+        QCOMPARE(CPU_regPC, store);
+        QCOMPARE(emu.readMemoryBlock(0, 0x0680, 1), QByteArray(1, '\x00'));
+        QVERIFY(!emu.isRunToActive());
+        emu.shutdown();
+    }
+
+    void testStepOverEndsOnPauseOrCancel()
+    {
+        AtariEmulator emu(nullptr);
+        QVERIFY(boot(emu));
+        // A routine that never returns: JMP $0610
+        const QByteArray code = stepOverProgram(kSpin, QByteArray("\x4C\x10\x06", 3));
+        enterProgram(emu, code);
+        const unsigned char stack = CPU_regS;
+        QSignalSpy finished(&emu, &AtariEmulator::runToFinished);
+
+        QVERIFY(emu.stepOver());
+        QVERIFY(emu.isRunToActive());
+        QVERIFY(finished.isEmpty());
+        emu.cancelRunTo();
+        QCOMPARE(finished.count(), 1);
+        QVERIFY(!finished.first().at(1).toBool());
+        QVERIFY(!emu.isRunToActive());
+        // The slice queued before the cancel finds nothing left to run
+        const quint64 frame = emu.getCurrentFrame();
+        QCoreApplication::processEvents();
+        QCOMPARE(emu.getCurrentFrame(), frame);
+        QCOMPARE(finished.count(), 1);
+
+        enterProgram(emu, code);
+        CPU_regS = stack;
+        QVERIFY(emu.stepOver());
+        QVERIFY(emu.isRunToActive());
+        emu.pauseEmulation();
+        QCOMPARE(finished.count(), 2);
+        QVERIFY(!finished.last().at(1).toBool());
+        QVERIFY(!emu.isRunToActive());
+        QVERIFY(emu.isEmulationPaused());
+        emu.shutdown();
+    }
+
+    void testStepOverStepsOtherOpcodesOnce()
+    {
+        AtariEmulator emu(nullptr);
+        QVERIFY(boot(emu));
+        enterProgram(emu, stepOverProgram(kSpin, kStoreRoutine));
+        CPU_regPC = kReturnAddress;
+        QSignalSpy finished(&emu, &AtariEmulator::runToFinished);
+        QSignalSpy stepped(&emu, &AtariEmulator::debugStepped);
+        const quint64 frame = emu.getCurrentFrame();
+
+        QVERIFY(!emu.stepOver());
+        QVERIFY(!emu.isRunToActive());
+        QCOMPARE(stepped.count(), 1);
+        QCOMPARE(emu.getCurrentFrame(), frame + 1);
+        QCOMPARE(CPU_regPC, kReturnAddress);
+        QCoreApplication::processEvents();
+        QVERIFY(finished.isEmpty());
+        emu.shutdown();
+    }
+};
+
+int main(int argc, char** argv)
+{
+    QApplication app(argc, argv);
+    TestEmulatorCore test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_emulator_core.moc"
@@ -0,0 +1,145 @@
+/*
+ * Fujisan Test Suite - Fast-Load Image Tests
+ *
+ * Verifies the parsers behind AtariEmulator's direct-to-memory loading:
+ * XexImage (segments, repeated $FFFF markers, INIT and RUN vectors, the
+ * first-segment default, truncated and malformed files) and
+ * BasicProgramImage (SAVE header checks and relocation to LOMEM).
+ */
+
+#include "xeximage.h"
+#include "basicprogramimage.h"
+
+#include <QtTest/QtTest>
+
+namespace {
+QByteArray word(int value)
+{
+    QByteArray bytes;
+    bytes.append(static_cast<char>(value & 0xFF));
+    bytes.append(static_cast<char>((value >> 8) & 0xFF));
+    return bytes;
+}
+
+QByteArray segment(int start, const QByteArray& data)
+{
+    return word(start) + word(start + data.size() - 1) + data;
+}
+
+// VNTP at $0100 as Atari BASIC saves it; tables of the given sizes
+QByteArray basicProgram(int names, int values, int statements)
+{
+    const int vntp = 0x0100;
+    const int vntd = vntp + names;
+    const int vvtp = vntd + 1;
+    const int stmtab = vvtp + values;
+    const int stmcur = stmtab + statements - 6;
+    const int starp = stmtab + statements;
+    QByteArray file = word(0) + word(vntp) + word(vntd) + word(vvtp) + word(stmtab) + word(stmcur) + word(starp);
+    file += QByteArray(starp - vntp, '\x42');
+    return file;
+}
+}
+
+class TestFastLoadImages : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testSegmentsAndRunVector()
+    {
+        const QByteArray file = word(0xFFFF) + segment(0x2000, "\xA9\x01\x60") +
+                                word(0xFFFF) + segment(0x2100, "data") +
+                                segment(XexImage::kRunVector, word(0x2000));
+        XexImage xex;
+        QVERIFY(xex.parse(file));
+        QCOMPARE(xex.segments().size(), 3);
+        QCOMPARE(int(xex.segments()[0].start), 0x2000);
+        QCOMPARE(xex.segments()[0].end(), 0x2002);
+        QCOMPARE(xex.segments()[1].data, QByteArray("data"));
+        QCOMPARE(xex.segments()[0].initAddress, -1);
+        QCOMPARE(xex.runAddress(), 0x2000);
+        QVERIFY(xex.touches(0x2103, 0x3000));
+        QVERIFY(!xex.touches(0x2104, 0x3000));
+    }
+
+    void testInitVectorsPerSegment()
+    {
+        // Two INIT routines, then RUNAD and INITAD written by one segment
+        const QByteArray file = word(0xFFFF) + segment(0x3000, "\x60") +
+                                segment(XexImage::kInitVector, word(0x3000)) +
+                                segment(0x4000, "\x60") +
+                                segment(XexImage::kInitVector, word(0x4000)) +
+                                segment(XexImage::kRunVector, word(0x5000) + word(0x3000));
+        XexImage xex;
+        QVERIFY(xex.parse(file));
+        QCOMPARE(xex.segments()[0].initAddress, -1);
+        QCOMPARE(xex.segments()[1].initAddress, 0x3000);
+        QCOMPARE(xex.segments()[3].initAddress, 0x4000);
+        QCOMPARE(xex.segments()[4].initAddress, 0x3000);
+        QCOMPARE(xex.runAddress(), 0x5000);
+    }
+
+    void testRunDefaultsToFirstSegment()
+    {
+        XexImage xex;
+        QVERIFY(xex.parse(word(0xFFFF) + segment(0x0600, "\x60") + segment(0x2000, "x")));
+        QCOMPARE(xex.runAddress(), 0x0600);
+    }
+
+    void testMalformedFiles()
+    {
+        XexImage xex;
+        QString error;
+        QVERIFY(!xex.parse(segment(0x2000, "x"), &error));  // no header
+        QVERIFY(error.contains("$FFFF"));
+        QVERIFY(!xex.parse(word(0xFFFF)));  // no segments
+        QVERIFY(!xex.parse(word(0xFFFF) + word(0x2000) + word(0x1FFF)));  // ends before it starts
+        QVERIFY(!xex.parse(word(0xFFFF) + word(0x2000) + word(0x2003) + "ab", &error));
+        QVERIFY(error.contains("truncated"));
+        QVERIFY(!xex.parse(word(0xFFFF) + segment(0x2000, "ok") + word(0x3000)));  // half a header
+        QVERIFY(xex.segments().isEmpty());
+        QCOMPARE(xex.runAddress(), -1);
+    }
+
+    void testBasicRelocation()
+    {
+        const QByteArray file = basicProgram(5, 16, 24);
+        BasicProgramImage basic;
+        QVERIFY(basic.parse(file));
+        QCOMPARE(basic.bodyOffset(), 0x0100);
+        QCOMPARE(basic.body().size(), file.size() - BasicProgramImage::kHeaderBytes);
+
+        const quint16 lomem = 0x1CFC;
+        QCOMPARE(basic.endAddress(lomem), lomem + 0x0100 + 5 + 1 + 16 + 24);
+        const QByteArray page = basic.zeroPage(lomem);
+        QCOMPARE(page.size(), 18);
+        QCOMPARE(page.left(2), word(lomem));                       // LOMEM
+        QCOMPARE(page.mid(2, 2), word(lomem + 0x0100));            // VNTP
+        QCOMPARE(page.mid(12, 2), word(basic.endAddress(lomem)));  // STARP
+        QCOMPARE(page.mid(14, 2), word(basic.endAddress(lomem)));  // RUNSTK
+        QCOMPARE(page.mid(16, 2), word(basic.endAddress(lomem)));  // MEMTOP
+    }
+
+    void testBasicRejectsBadHeaders()
+    {
+        BasicProgramImage basic;
+        QString error;
+        QVERIFY(!basic.parse(QByteArray(10, '\0'), &error));
+
+        QByteArray notLomem = basicProgram(5, 16, 24);
+        notLomem[0] = 1;
+        QVERIFY(!basic.parse(notLomem, &error));
+        QVERIFY(error.contains("LOMEM"));
+
+        QVERIFY(!basic.parse(basicProgram(5, 12, 24)));  // value table not in 8-byte entries
+
+        QByteArray truncated = basicProgram(5, 16, 24);
+        truncated.chop(1);
+        QVERIFY(!basic.parse(truncated, &error));
+        QVERIFY(error.contains("truncated"));
+        QVERIFY(basic.body().isEmpty());
+    }
+};
+
+QTEST_MAIN(TestFastLoadImages)
+#include "test_fast_load_images.moc"
@@ -0,0 +1,137 @@
+/*
+ * Fujisan Test Suite - Frame Checksum Stream Tests
+ *
+ * Verifies FrameChecksumStream: XXH64 against the reference vectors, ring
+ * reads by cursor across wraparound with an overwritten-entry count, nothing
+ * recorded while stopped, and one line per frame in the checksum file.
+ */
+
+#include "framechecksumstream.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+namespace {
+QByteArray ramImage(int frame)
+{
+    QByteArray ram(65536, '\0');
+    ram[0x80] = char(frame);
+    return ram;
+}
+}  // namespace
+
+class TestFrameChecksumStream : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+
+    void addFrames(FrameChecksumStream& stream, int first, int count)
+    {
+        const QByteArray screen(384 * 240, '\x94');
+        for (int frame = first; frame < first + count; ++frame) {
+            const QByteArray ram = ramImage(frame);
+            stream.add(quint64(frame), ram.constData(), ram.size(), screen.constData(), screen.size());
+        }
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+    }
+
+    void testHashMatchesReferenceVectors()
+    {
+        QCOMPARE(FrameChecksumStream::hash("", 0), quint64(0xEF46DB3751D8E999ull));
+        QCOMPARE(FrameChecksumStream::hash("abc", 3), quint64(0x44BC2CF5AD770999ull));
+        const QByteArray text("Nobody inspects the spammish repetition");  // exercises the 32-byte stripes
+        QCOMPARE(FrameChecksumStream::hash(text.constData(), text.size()), quint64(0xFBCEA83C8A378BF1ull));
+
+        const QByteArray a = ramImage(1);
+        const QByteArray b = ramImage(2);
+        QVERIFY(FrameChecksumStream::hash(a.constData(), a.size()) !=
+                FrameChecksumStream::hash(b.constData(), b.size()));
+    }
+
+    void testReadByCursor()
+    {
+        FrameChecksumStream stream;
+        QVERIFY(stream.start(8, QString()));
+        addFrames(stream, 1, 5);
+
+        quint64 dropped = 99;
+        QVector<FrameChecksumStream::Entry> entries = stream.read(0, 3, &dropped);
+        QCOMPARE(entries.size(), 3);
+        QCOMPARE(dropped, quint64(0));
+        QCOMPARE(entries.first().frame, quint64(1));
+        QCOMPARE(entries.last().sequence, quint64(2));
+
+        entries = stream.read(entries.last().sequence + 1, 100);
+        QCOMPARE(entries.size(), 2);
+        QCOMPARE(entries.last().frame, quint64(5));
+        QVERIFY(stream.read(stream.nextSequence(), 100).isEmpty());
+    }
+
+    void testWraparoundReportsDropped()
+    {
+        FrameChecksumStream stream;
+        QVERIFY(stream.start(4, QString()));
+        addFrames(stream, 10, 10);
+        QCOMPARE(stream.size(), 4);
+        QCOMPARE(stream.nextSequence(), quint64(10));
+
+        quint64 dropped = 0;
+        const QVector<FrameChecksumStream::Entry> entries = stream.read(2, 100, &dropped);
+        QCOMPARE(dropped, quint64(4));
+        QCOMPARE(entries.size(), 4);
+        QCOMPARE(entries.first().sequence, quint64(6));
+        QCOMPARE(entries.first().frame, quint64(16));
+        QCOMPARE(entries.last().frame, quint64(19));
+    }
+
+    void testNothingRecordedWhileStopped()
+    {
+        FrameChecksumStream stream;
+        addFrames(stream, 0, 3);
+        QCOMPARE(stream.nextSequence(), quint64(0));
+
+        QVERIFY(stream.start(4, QString()));
+        addFrames(stream, 0, 2);
+        stream.stop();
+        addFrames(stream, 2, 2);
+        QCOMPARE(stream.nextSequence(), quint64(2));
+        QCOMPARE(stream.read(0, 10).size(), 2);  // still readable after stop
+    }
+
+    void testFileHasOneLinePerFrame()
+    {
+        const QString path = m_dir.filePath("run.sums");
+        FrameChecksumStream stream;
+        QVERIFY(stream.start(2, path));
+        addFrames(stream, 1, 5);
+        const FrameChecksumStream::Entry newest = stream.read(stream.nextSequence() - 1, 1).first();
+        stream.stop();
+
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QList<QByteArray> lines = file.readAll().split('\n');
+        QCOMPARE(lines.size(), 6);  // five lines and the empty tail after the last newline
+        QVERIFY(lines.first().startsWith("1 "));
+        QCOMPARE(lines.at(4) + '\n', FrameChecksumStream::formatLine(newest));
+        QCOMPARE(lines.at(4).split(' ').at(1).size(), 16);
+    }
+
+    void testUnwritableFileFails()
+    {
+        FrameChecksumStream stream;
+        QString error;
+        QVERIFY(!stream.start(4, m_dir.filePath("missing/dir/run.sums"), &error));
+        QVERIFY(!error.isEmpty());
+        QVERIFY(!stream.isActive());
+    }
+};
+
+QTEST_GUILESS_MAIN(TestFrameChecksumStream)
+#include "test_frame_checksum_stream.moc"
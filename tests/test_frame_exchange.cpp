@@ -0,0 +1,164 @@
+/*
+ * Fujisan Test Suite - Frame Exchange Tests
+ *
+ * Verifies the triple buffer that hands rendered frames from the emulator
+ * thread to EmulatorWidget: newest-frame-wins, drop accounting, notification
+ * rules, dirty areas carried across dropped frames and that buffers are
+ * never reallocated.
+ */
+
+#include "frameexchange.h"
+
+#include <QSet>
+#include <QThread>
+#include <QtTest/QtTest>
+#include <atomic>
+
+class TestFrameExchange : public QObject {
+    Q_OBJECT
+
+private:
+    static void stamp(QImage& image, quint32 value)
+    {
+        *reinterpret_cast<quint32*>(image.scanLine(0)) = value;
+    }
+
+    static quint32 readStamp(const QImage& image)
+    {
+        return *reinterpret_cast<const quint32*>(image.constScanLine(0));
+    }
+
+private slots:
+    void testNothingPublishedInitially()
+    {
+        FrameExchange exchange(384, 240, QImage::Format_RGB32);
+        QVERIFY(!exchange.acquire());
+        QCOMPARE(exchange.frontBuffer().size(), QSize(384, 240));
+        QCOMPARE(exchange.droppedFrames(), quint64(0));
+    }
+
+    void testPublishThenAcquire()
+    {
+        FrameExchange exchange(16, 16, QImage::Format_RGB32);
+        stamp(exchange.backBuffer(), 0x11);
+        QVERIFY(exchange.publish());     // consumer idle -> needs notification
+        QVERIFY(exchange.acquire());
+        QCOMPARE(readStamp(exchange.frontBuffer()), quint32(0x11));
+        QVERIFY(!exchange.acquire());    // nothing new
+    }
+
+    void testNewestFrameWinsAndDropsAreCounted()
+    {
+        FrameExchange exchange(16, 16, QImage::Format_RGB32);
+        for (quint32 i = 1; i <= 5; ++i) {
+            stamp(exchange.backBuffer(), i);
+            const bool notify = exchange.publish();
+            QCOMPARE(notify, i == 1);    // only the first unseen frame notifies
+        }
+        QVERIFY(exchange.acquire());
+        QCOMPARE(readStamp(exchange.frontBuffer()), quint32(5));
+        QCOMPARE(exchange.droppedFrames(), quint64(4));
+        QCOMPARE(exchange.publishedFrames(), quint64(5));
+    }
+
+    void testSequenceTravelsWithBuffer()
+    {
+        FrameExchange exchange(16, 16, QImage::Format_Indexed8);
+        for (quint64 frame = 100; frame < 110; ++frame) {
+            stamp(exchange.backBuffer(), static_cast<quint32>(frame));
+            exchange.publish(frame);
+            if (frame % 4 == 0) {
+                QVERIFY(exchange.acquire());
+                QCOMPARE(exchange.frontSequence(), frame);
+                QCOMPARE(readStamp(exchange.frontBuffer()), static_cast<quint32>(frame));
+            }
+        }
+        QVERIFY(exchange.acquire());
+        QCOMPARE(exchange.frontSequence(), quint64(109));
+    }
+
+    void testDirtyRectTravelsWithBuffer()
+    {
+        FrameExchange exchange(16, 16, QImage::Format_Indexed8);
+        QCOMPARE(exchange.frontDirtyRect(), QRect(0, 0, 16, 16));
+
+        exchange.publish(1);  // null dirty rect: the whole frame
+        QVERIFY(exchange.acquire());
+        QCOMPARE(exchange.frontDirtyRect(), QRect(0, 0, 16, 16));
+
+        exchange.publish(2, QRect(0, 3, 16, 2));
+        QVERIFY(exchange.acquire());
+        QCOMPARE(exchange.frontDirtyRect(), QRect(0, 3, 16, 2));
+
+        exchange.publish(3, QRect(0, 10, 16, 40));  // clipped to the buffer
+        QVERIFY(exchange.acquire());
+        QCOMPARE(exchange.frontDirtyRect(), QRect(0, 10, 16, 6));
+    }
+
+    void testDroppedFrameDirtyRectIsCarriedOver()
+    {
+        FrameExchange exchange(16, 16, QImage::Format_Indexed8);
+        exchange.publish(1);
+        QVERIFY(exchange.acquire());
+
+        exchange.publish(2, QRect(0, 1, 16, 1));
+        exchange.publish(3, QRect(0, 8, 16, 1));   // replaces frame 2 unseen
+        QVERIFY(exchange.acquire());
+        QCOMPARE(exchange.frontSequence(), quint64(3));
+        QCOMPARE(exchange.frontDirtyRect(), QRect(0, 1, 16, 8));
+
+        exchange.publish(4, QRect(0, 12, 16, 1));  // frame 3 was seen: nothing to carry
+        QVERIFY(exchange.acquire());
+        QCOMPARE(exchange.frontDirtyRect(), QRect(0, 12, 16, 1));
+    }
+
+    void testBuffersAreNeverReallocated()
+    {
+        FrameExchange exchange(16, 16, QImage::Format_RGB32);
+        QSet<const uchar*> seen;
+        for (int i = 0; i < 30; ++i) {
+            seen.insert(exchange.backBuffer().constBits());
+            exchange.publish();
+            if (i % 3 == 0) {
+                exchange.acquire();
+                seen.insert(exchange.frontBuffer().constBits());
+            }
+        }
+        QCOMPARE(seen.size(), 3);
+    }
+
+    void testConcurrentProducerConsumer()
+    {
+        FrameExchange exchange(16, 16, QImage::Format_RGB32);
+        constexpr quint32 kFrames = 20000;
+        std::atomic<bool> done{false};
+
+        QThread* producer = QThread::create([&]() {
+            for (quint32 i = 1; i <= kFrames; ++i) {
+                stamp(exchange.backBuffer(), i);
+                exchange.publish();
+            }
+            done.store(true);
+        });
+        producer->start();
+
+        quint32 last = 0;
+        bool monotonic = true;
+        while (!done.load()) {
+            if (exchange.acquire()) {
+                const quint32 value = readStamp(exchange.frontBuffer());
+                monotonic = monotonic && value > last;
+                last = value;
+            }
+        }
+        producer->wait();
+        delete producer;
+
+        QVERIFY(monotonic);
+        exchange.acquire();
+        QCOMPARE(readStamp(exchange.frontBuffer()), kFrames);
+    }
+};
+
+QTEST_MAIN(TestFrameExchange)
+#include "test_frame_exchange.moc"
@@ -0,0 +1,137 @@
+/*
+ * Fujisan Test Suite - FujiNet-PC Log Parser Tests
+ *
+ * Verifies FujiNetLogParser: lines split across chunks and on the literal
+ * "\n" FujiNet-PC prints, drive activity from command frames, reads, writes
+ * and completions, the device ID timeout, the include-only log filter; and
+ * that LogTailBuffer keeps exactly the newest bytes.
+ */
+
+#include "fujinetlogparser.h"
+
+#include <QtTest/QtTest>
+
+using DriveEvent = FujiNetLogParser::DriveEvent;
+
+class TestFujiNetLogParser : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testLinesSplitAcrossChunks()
+    {
+        FujiNetLogParser parser;
+        QVector<DriveEvent> events;
+        QVector<QByteArray> lines;
+        parser.feed("first line\nsecond ", 0, events, &lines);
+        QCOMPARE(lines, QVector<QByteArray>{"first line"});
+        parser.feed("half\r\n\n  \nthird\\nfourth\\r\\nfifth", 0, events, &lines);
+        QCOMPARE(lines, (QVector<QByteArray>{"first line", "second half", "third", "fourth"}));
+        parser.flush(0, events, &lines);
+        QCOMPARE(lines.last(), QByteArray("fifth"));
+        QVERIFY(events.isEmpty());
+    }
+
+    void testBackslashThatIsNotALineBreak()
+    {
+        FujiNetLogParser parser;
+        QVector<DriveEvent> events;
+        QVector<QByteArray> lines;
+        parser.feed("path C:\\fujinet\\sd\n", 0, events, &lines);
+        QCOMPARE(lines, QVector<QByteArray>{"path C:\\fujinet\\sd"});
+    }
+
+    void testDriveActivity()
+    {
+        FujiNetLogParser parser;
+        QVector<DriveEvent> events;
+        parser.feed("CF: 31 52 6c 01 f0\nATR READ\nCOMPLETE\n"
+                    "CF: 33 57 01 00 00\nATR WRITE\nCOMPLETE\n"
+                    "CF: 32 52 01 00 00\nXEX READ\n", 0, events, nullptr);
+        QCOMPARE(events.size(), 5);
+        QCOMPARE(int(events[0].type), int(DriveEvent::Start));
+        QCOMPARE(events[0].drive, 1);
+        QVERIFY(!events[0].writing);
+        QCOMPARE(int(events[1].type), int(DriveEvent::Complete));
+        QCOMPARE(events[2].drive, 3);
+        QVERIFY(events[2].writing);
+        QCOMPARE(int(events[3].type), int(DriveEvent::Complete));
+        QCOMPARE(events[4].drive, 2);
+    }
+
+    void testOperationNeedsRecentCommandFrame()
+    {
+        FujiNetLogParser parser;
+        QVector<DriveEvent> events;
+        parser.feed("ATR READ\n", 0, events, nullptr);       // no command frame yet
+        parser.feed("CF: 45 52 00 00 00\nATR READ\n", 0, events, nullptr);  // not a disk drive
+        QVERIFY(events.isEmpty());
+
+        parser.feed("CF: 31 52 01 00 00\n", 1000, events, nullptr);
+        parser.feed("ATR READ\n", 1000 + FujiNetLogParser::kDeviceIdTimeoutMs + 1, events, nullptr);
+        QVERIFY(events.isEmpty());
+
+        parser.feed("CF: 31 52 01 00 00\n", 5000, events, nullptr);
+        parser.feed("ATX READ\n", 5100, events, nullptr);
+        QCOMPARE(events.size(), 1);
+        QCOMPARE(events[0].drive, 1);
+    }
+
+    void testSubstringAndRegexFilters()
+    {
+        FujiNetLogParser parser;
+        QVERIFY(parser.acceptsLine("anything"));
+
+        parser.setFilter("SIO", false);
+        QVERIFY(parser.acceptsLine("SIO CMD"));
+        QVERIFY(!parser.acceptsLine("sio cmd"));    // case-sensitive
+
+        parser.setFilter("^CF: 3[1-8]", true);
+        QVERIFY(parser.acceptsLine("CF: 31 52"));
+        QVERIFY(!parser.acceptsLine("CF: 45 52"));
+
+        parser.setFilter("([", true);                // invalid: show everything
+        QVERIFY(parser.acceptsLine("whatever"));
+
+        // Filtered lines still drive the LEDs
+        parser.setFilter("nothing matches this", false);
+        QVector<DriveEvent> events;
+        QVector<QByteArray> lines;
+        parser.feed("CF: 31 52 01 00 00\nATR READ\n", 0, events, &lines);
+        QVERIFY(lines.isEmpty());
+        QCOMPARE(events.size(), 1);
+    }
+
+    void testOverlongPartialLineIsProcessed()
+    {
+        FujiNetLogParser parser;
+        QVector<DriveEvent> events;
+        QVector<QByteArray> lines;
+        parser.feed(QByteArray(FujiNetLogParser::kMaxLineBytes + 1, 'x'), 0, events, &lines);
+        QCOMPARE(lines.size(), 1);
+        parser.feed("y\n", 0, events, &lines);
+        QCOMPARE(lines.size(), 2);
+        QCOMPARE(lines[1], QByteArray("y"));
+    }
+
+    void testLogTailKeepsNewestBytes()
+    {
+        LogTailBuffer tail(8);
+        QCOMPARE(tail.toByteArray(), QByteArray());
+        tail.append("abc");
+        QCOMPARE(tail.toByteArray(), QByteArray("abc"));
+        tail.append("defgh");
+        QCOMPARE(tail.toByteArray(), QByteArray("abcdefgh"));
+        tail.append("ij");                           // wraps
+        QCOMPARE(tail.toByteArray(), QByteArray("cdefghij"));
+        tail.append("0123456789");                   // longer than the ring
+        QCOMPARE(tail.toByteArray(), QByteArray("23456789"));
+        QCOMPARE(tail.size(), 8);
+        tail.clear();
+        QCOMPARE(tail.size(), 0);
+        tail.append("z");
+        QCOMPARE(tail.toByteArray(), QByteArray("z"));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestFujiNetLogParser)
+#include "test_fujinet_log_parser.moc"
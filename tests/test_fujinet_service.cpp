@@ -2,7 +2,9 @@
  * Fujisan Test Suite - FujiNet Service Tests
  *
  * Uses a local QTcpServer as an HTTP mock to test FujiNetService
- * health check, connection state, and drive polling.
+ * health check, connection state, drive polling, the /events push
+ * channel with its fallback to polling, and the request scheduler
+ * (coalescing, priorities, batched mounts) against a slow server.
  */
 
 #include <QCoreApplication>
@@ -37,6 +39,33 @@ public:
         m_pathResponses[path] = {statusCode, body};
     }
 
+    // Answer path with an open-ended text/event-stream; push() writes to it
+    void setStreamForPath(const QString& path) { m_streamPath = path; }
+
+    void push(const QByteArray& data)
+    {
+        for (QTcpSocket* socket : m_streams) {
+            socket->write(data);
+            socket->flush();
+        }
+    }
+
+    void closeStreams()
+    {
+        for (QTcpSocket* socket : m_streams) {
+            socket->disconnectFromHost();
+        }
+        m_streams.clear();
+    }
+
+    int requestCount(const QString& path) const { return m_requestCounts.value(path); }
+    int streamCount() const { return m_streams.size(); }
+
+    // Answer every request this long after it arrives, like a busy FujiNet-PC
+    void setDelay(int ms) { m_delayMs = ms; }
+    // Paths (with query) in arrival order
+    QStringList requestLog() const { return m_requestLog; }
+
 private slots:
     void handleConnection()
     {
@@ -56,6 +85,22 @@ private slots:
                     }
                 }
 
+                m_requestCounts[path]++;
+                m_requestLog.append(path);
+                if (!m_streamPath.isEmpty() && path == m_streamPath) {
+                    socket->write("HTTP/1.1 200 OK\r\n"
+                                  "Content-Type: text/event-stream\r\n"
+                                  "Cache-Control: no-cache\r\n"
+                                  "Connection: close\r\n"
+                                  "\r\n"
+                                  ": hello\n\n");
+                    socket->flush();
+                    m_streams.append(socket);
+                    connect(socket, &QTcpSocket::disconnected, this,
+                            [this, socket]() { m_streams.removeAll(socket); });
+                    return;
+                }
+
                 int code = m_statusCode;
                 QString body = m_body;
                 if (m_pathResponses.contains(path)) {
@@ -74,9 +119,12 @@ private slots:
                     .arg(body.length())
                     .arg(body);
 
-                socket->write(response.toUtf8());
-                socket->flush();
-                socket->disconnectFromHost();
+                const QByteArray bytes = response.toUtf8();
+                QTimer::singleShot(m_delayMs, socket, [socket, bytes]() {
+                    socket->write(bytes);
+                    socket->flush();
+                    socket->disconnectFromHost();
+                });
             });
         }
     }
@@ -85,6 +133,11 @@ private:
     int m_statusCode = 200;
     QString m_body;
     QMap<QString, QPair<int, QString>> m_pathResponses;
+    QMap<QString, int> m_requestCounts;
+    QStringList m_requestLog;
+    int m_delayMs = 0;
+    QString m_streamPath;
+    QList<QTcpSocket*> m_streams;
 };
 
 class TestFujiNetService : public QObject {
@@ -229,6 +282,160 @@ private slots:
         svc.stopDrivePolling();
         // No crash
     }
+
+    // ---------------------------------------------------------------
+    // Event channel: pushed drive tables replace polling
+    // ---------------------------------------------------------------
+    void testEventChannelPushesDrives()
+    {
+        m_server->setStreamForPath("/events");
+
+        FujiNetService svc;
+        svc.setServerUrl(QString("http://127.0.0.1:%1").arg(m_port));
+        QSignalSpy connSpy(&svc, &FujiNetService::connected);
+        // FujiNetDrive is not a registered metatype, so record it directly
+        QVector<FujiNetDrive> drives;
+        int driveUpdates = 0;
+        connect(&svc, &FujiNetService::driveStatusUpdated, this,
+                [&](const QVector<FujiNetDrive>& update) { drives = update; driveUpdates++; });
+
+        svc.startDrivePolling(100);
+        QTRY_VERIFY_WITH_TIMEOUT(svc.isEventChannelLive(), 3000);
+        QCOMPARE(connSpy.count(), 1);
+
+        // Polling stopped: the "/" count settles after the catch-up query
+        QTest::qWait(200);
+        const int polled = m_server->requestCount("/");
+        QTest::qWait(400);
+        QCOMPARE(m_server->requestCount("/"), polled);
+
+        driveUpdates = 0;
+        m_server->push("event: drives\n"
+                       "data: {\"drives\": [{\"slot\": 0, \"filename\": \"/GAME.ATR\", \"mode\": \"w\"}]}\n\n");
+        QTRY_COMPARE_WITH_TIMEOUT(driveUpdates, 1, 3000);
+        QCOMPARE(drives.size(), 8);
+        QCOMPARE(drives[0].filename, QString("/GAME.ATR"));
+        QVERIFY(!drives[0].isEmpty);
+        QVERIFY(!drives[0].isReadOnly);
+        QVERIFY(drives[1].isEmpty);
+
+        // A bare change notice fetches the table once
+        const int before = m_server->requestCount("/");
+        m_server->push("event: mount\ndata: {}\n\n");
+        QTRY_COMPARE_WITH_TIMEOUT(m_server->requestCount("/"), before + 1, 3000);
+
+        // The stream dropping brings polling back
+        m_server->closeStreams();
+        QTRY_VERIFY_WITH_TIMEOUT(!svc.isEventChannelLive(), 3000);
+        const int afterDrop = m_server->requestCount("/");
+        QTRY_VERIFY_WITH_TIMEOUT(m_server->requestCount("/") >= afterDrop + 2, 3000);
+
+        svc.stopDrivePolling();
+    }
+
+    // ---------------------------------------------------------------
+    // Event channel: a server without /events keeps polling
+    // ---------------------------------------------------------------
+    void testEventChannelFallbackToPolling()
+    {
+        m_server->setResponseForPath("/events", 404, "Not Found");
+
+        FujiNetService svc;
+        svc.setServerUrl(QString("http://127.0.0.1:%1").arg(m_port));
+        svc.startDrivePolling(100);
+
+        QTRY_VERIFY_WITH_TIMEOUT(m_server->requestCount("/events") >= 1, 3000);
+        QTRY_VERIFY_WITH_TIMEOUT(m_server->requestCount("/") >= 3, 3000);
+        QVERIFY(!svc.isEventChannelLive());
+
+        svc.stopDrivePolling();
+        const int stopped = m_server->requestCount("/");
+        QTest::qWait(300);
+        QVERIFY(m_server->requestCount("/") <= stopped + 1);  // one may be in flight
+    }
+
+    // ---------------------------------------------------------------
+    // Scheduler: repeated status queries to a slow server coalesce
+    // ---------------------------------------------------------------
+    void testSchedulerCoalescesPolls()
+    {
+        m_server->setDelay(200);
+
+        FujiNetService svc;
+        svc.setServerUrl(QString("http://127.0.0.1:%1").arg(m_port));
+        for (int i = 0; i < 10; ++i) {
+            svc.queryDriveStatus();
+        }
+        const FujiNetRequestScheduler* scheduler = svc.requestScheduler();
+        QCOMPARE(scheduler->inFlightCount(), 1);
+        QCOMPARE(scheduler->queuedCount(), 1);  // one fresh query behind the slow one
+        QCOMPARE(scheduler->coalescedCount(), quint64(8));
+
+        QTRY_VERIFY_WITH_TIMEOUT(!scheduler->isPending("/") && scheduler->inFlightCount() == 0, 3000);
+        QCOMPARE(m_server->requestCount("/"), 2);
+    }
+
+    // ---------------------------------------------------------------
+    // Scheduler: user mounts start before queued background polls
+    // ---------------------------------------------------------------
+    void testSchedulerUserBeforeBackground()
+    {
+        m_server->setDelay(150);
+
+        FujiNetService svc;
+        svc.setServerUrl(QString("http://127.0.0.1:%1").arg(m_port));
+        QSignalSpy mountSpy(&svc, &FujiNetService::mountSuccess);
+
+        svc.queryDriveStatus();   // takes the two connections
+        svc.checkConnection();
+        svc.queryMountStatus();   // queued
+        svc.getHosts();           // queued
+        svc.mount(2, 0, "/GAME.ATR", true);
+
+        QVERIFY(mountSpy.wait(3000));
+        QTRY_VERIFY_WITH_TIMEOUT(m_server->requestLog().size() >= 5, 3000);
+        const QStringList log = m_server->requestLog();
+        int mountAt = -1;
+        for (int i = 0; i < log.size(); ++i) {
+            if (log[i].startsWith("/browse/host/1/GAME.ATR")) {
+                mountAt = i;
+                break;
+            }
+        }
+        QCOMPARE(mountAt, 2);  // right after the two already running
+        QVERIFY(svc.requestScheduler()->inFlightCount() <= FujiNetRequestScheduler::kDefaultMaxInFlight);
+    }
+
+    // ---------------------------------------------------------------
+    // Batched mounts refresh the slot status once
+    // ---------------------------------------------------------------
+    void testApplyDiskSlotsRefreshesOnce()
+    {
+        FujiNetService svc;
+        svc.setServerUrl(QString("http://127.0.0.1:%1").arg(m_port));
+        QSignalSpy mountSpy(&svc, &FujiNetService::mountSuccess);
+        QSignalSpy unmountSpy(&svc, &FujiNetService::unmountSuccess);
+
+        QVector<FujiNetDiskSlot> diskSlots(3);
+        diskSlots[0].slotNumber = 0;
+        diskSlots[0].hostSlot = 0;
+        diskSlots[0].filename = "/A.ATR";
+        diskSlots[0].isEmpty = false;
+        diskSlots[1].slotNumber = 1;
+        diskSlots[1].hostSlot = 0;
+        diskSlots[1].filename = "/B.ATR";
+        diskSlots[1].accessMode = 2;
+        diskSlots[1].isEmpty = false;
+        diskSlots[2].slotNumber = 2;  // empty: eject
+        svc.applyDiskSlots(diskSlots);
+
+        QTRY_COMPARE_WITH_TIMEOUT(mountSpy.count(), 2, 3000);
+        QTRY_COMPARE_WITH_TIMEOUT(unmountSpy.count(), 1, 3000);
+        QTRY_COMPARE_WITH_TIMEOUT(m_server->requestCount("/slot"), 1, 3000);
+        QTest::qWait(200);
+        QCOMPARE(m_server->requestCount("/slot"), 1);
+        QVERIFY(m_server->requestLog().contains("/browse/host/1/B.ATR?action=newmount&mode=w&slot=2"));
+    }
 };
 
 QTEST_MAIN(TestFujiNetService)
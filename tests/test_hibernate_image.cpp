@@ -0,0 +1,114 @@
+/*
+ * Fujisan Test Suite - Hibernate Image Tests
+ *
+ * Verifies HibernateImage: the metadata and raw state written on quit come
+ * back unchanged through the memory mapping, the state starts on an aligned
+ * offset, and missing, foreign and truncated files are rejected instead of
+ * being handed to the core.
+ */
+
+#include "hibernateimage.h"
+
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+
+class TestHibernateImage : public QObject {
+    Q_OBJECT
+
+private:
+    static QByteArray sampleState()
+    {
+        QByteArray state(70000, Qt::Uninitialized);
+        for (int i = 0; i < state.size(); ++i) {
+            state[i] = static_cast<char>(i * 7);
+        }
+        return state;
+    }
+
+    static QJsonObject sampleMetadata()
+    {
+        QJsonObject boot;
+        boot["machine_type"] = "-xl";
+        QJsonObject metadata;
+        metadata["boot_config"] = boot;
+        metadata["profile"] = "Default";
+        metadata["frame"] = 123456;
+        return metadata;
+    }
+
+private slots:
+    void testRoundTripThroughMapping()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.filePath("hibernate.fjh");
+        const QByteArray state = sampleState();
+        QVERIFY(HibernateImage::write(path, sampleMetadata(), state));
+
+        HibernateImage image;
+        QVERIFY2(image.open(path), qPrintable(image.errorString()));
+        QCOMPARE(image.stateSize(), qint64(state.size()));
+        QCOMPARE(QByteArray(reinterpret_cast<const char*>(image.stateData()), state.size()), state);
+        const QJsonObject metadata = image.metadata();
+        QCOMPARE(metadata["profile"].toString(), QStringLiteral("Default"));
+        QCOMPARE(metadata["frame"].toInt(), 123456);
+        QCOMPARE(metadata["boot_config"].toObject()["machine_type"].toString(), QStringLiteral("-xl"));
+        QCOMPARE(metadata["state_size"].toInt(), state.size());
+
+        image.close();
+        QVERIFY(!image.isOpen());
+        QVERIFY(image.stateData() == nullptr);
+    }
+
+    void testStateIsAligned()
+    {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("hibernate.fjh");
+        QVERIFY(HibernateImage::write(path, sampleMetadata(), sampleState()));
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const qint64 offset = file.size() - sampleState().size();
+        QCOMPARE(offset % HibernateImage::kStateAlignment, qint64(0));
+    }
+
+    void testEmptyStateIsNotWritten()
+    {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("hibernate.fjh");
+        QVERIFY(!HibernateImage::write(path, sampleMetadata(), QByteArray()));
+        QVERIFY(!QFile::exists(path));
+    }
+
+    void testMissingAndForeignFilesAreRejected()
+    {
+        QTemporaryDir dir;
+        HibernateImage image;
+        QVERIFY(!image.open(dir.filePath("missing.fjh")));
+        QVERIFY(!image.errorString().isEmpty());
+
+        const QString foreign = dir.filePath("foreign.fjh");
+        QFile file(foreign);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("FUJISANZ plus some compressed save state");
+        file.close();
+        QVERIFY(!image.open(foreign));
+        QVERIFY(!image.isOpen());
+    }
+
+    void testTruncatedFilesAreRejected()
+    {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("hibernate.fjh");
+        QVERIFY(HibernateImage::write(path, sampleMetadata(), sampleState()));
+        QFile file(path);
+        const qint64 size = file.size();
+        for (qint64 cut : {size - 1, qint64(100), qint64(10), qint64(3)}) {
+            QVERIFY(file.resize(cut));
+            HibernateImage image;
+            QVERIFY(!image.open(path));
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(TestHibernateImage)
+#include "test_hibernate_image.moc"
@@ -0,0 +1,112 @@
+/*
+ * Fujisan Test Suite - Input Latency Monitor Tests
+ *
+ * Verifies the input lag harness behind status.get_input_latency: nothing is
+ * recorded while disabled, an input counts for the frame whose snapshot came
+ * after it (not the one already running), bursts keep the oldest timestamp,
+ * a later paint presents every earlier frame, and frames that are never
+ * painted are evicted and counted.
+ */
+
+#include "inputlatencymonitor.h"
+
+#include <QThread>
+#include <QtTest/QtTest>
+
+class TestInputLatencyMonitor : public QObject {
+    Q_OBJECT
+
+private:
+    static QJsonObject stage(const InputLatencyMonitor& monitor, const char* source, const char* name)
+    {
+        return monitor.toJson()["sources"].toObject()[source].toObject()[name].toObject();
+    }
+
+private slots:
+    void testDisabledRecordsNothing()
+    {
+        InputLatencyMonitor monitor;
+        monitor.markInput(InputLatencyMonitor::Keyboard);
+        monitor.beginFrame();
+        monitor.endFrame(1);
+        monitor.framePresented(1);
+        QCOMPARE(stage(monitor, "keyboard", "to_frame")["count"].toInt(), 0);
+        QCOMPARE(monitor.toJson()["enabled"].toBool(), false);
+    }
+
+    void testInputToFrameToPresent()
+    {
+        InputLatencyMonitor monitor;
+        monitor.setEnabled(true);
+        monitor.markInput(InputLatencyMonitor::Joystick);
+        QThread::msleep(2);
+        monitor.beginFrame();
+        monitor.endFrame(10);
+        QCOMPARE(stage(monitor, "joystick", "to_frame")["count"].toInt(), 1);
+        QVERIFY(stage(monitor, "joystick", "to_frame")["max_us"].toInt() >= 2000);
+        QCOMPARE(stage(monitor, "joystick", "to_present")["count"].toInt(), 0);
+
+        monitor.framePresented(9);  // an older frame does not show the input
+        QCOMPARE(stage(monitor, "joystick", "to_present")["count"].toInt(), 0);
+        monitor.framePresented(10);
+        QCOMPARE(stage(monitor, "joystick", "to_present")["count"].toInt(), 1);
+        QCOMPARE(monitor.toJson()["frame_to_present"].toObject()["count"].toInt(), 1);
+        QVERIFY(stage(monitor, "joystick", "to_present")["max_us"].toInt() >=
+                stage(monitor, "joystick", "to_frame")["max_us"].toInt());
+        QCOMPARE(stage(monitor, "keyboard", "to_frame")["count"].toInt(), 0);
+    }
+
+    void testInputDuringFrameCountsForTheNext()
+    {
+        InputLatencyMonitor monitor;
+        monitor.setEnabled(true);
+        monitor.beginFrame();
+        monitor.markInput(InputLatencyMonitor::Keyboard);  // after the snapshot
+        monitor.endFrame(1);
+        QCOMPARE(stage(monitor, "keyboard", "to_frame")["count"].toInt(), 0);
+        monitor.beginFrame();
+        monitor.endFrame(2);
+        QCOMPARE(stage(monitor, "keyboard", "to_frame")["count"].toInt(), 1);
+    }
+
+    void testBurstKeepsOldestAndLaterPaintPresentsAll()
+    {
+        InputLatencyMonitor monitor;
+        monitor.setEnabled(true);
+        monitor.markInput(InputLatencyMonitor::Keyboard);
+        QThread::msleep(3);
+        monitor.markInput(InputLatencyMonitor::Keyboard);
+        monitor.beginFrame();
+        monitor.endFrame(5);
+        QCOMPARE(stage(monitor, "keyboard", "to_frame")["count"].toInt(), 1);
+        QVERIFY(stage(monitor, "keyboard", "to_frame")["max_us"].toInt() >= 3000);
+
+        monitor.markInput(InputLatencyMonitor::SdlJoystick);
+        monitor.beginFrame();
+        monitor.endFrame(6);
+        monitor.framePresented(7);  // frame 5 and 6 were superseded before a paint
+        QCOMPARE(stage(monitor, "keyboard", "to_present")["count"].toInt(), 1);
+        QCOMPARE(stage(monitor, "sdl_joystick", "to_present")["count"].toInt(), 1);
+
+        monitor.reset();
+        QCOMPARE(stage(monitor, "keyboard", "to_frame")["count"].toInt(), 0);
+    }
+
+    void testUnpresentedFramesAreEvicted()
+    {
+        InputLatencyMonitor monitor;
+        monitor.setEnabled(true);
+        const int frames = InputLatencyMonitor::kMaxInFlight + 6;
+        for (int frame = 1; frame <= frames; ++frame) {
+            monitor.markInput(InputLatencyMonitor::Keyboard);
+            monitor.beginFrame();
+            monitor.endFrame(frame);
+        }
+        QCOMPARE(monitor.toJson()["unpresented"].toInt(), 6);
+        monitor.framePresented(frames);
+        QCOMPARE(stage(monitor, "keyboard", "to_present")["count"].toInt(), InputLatencyMonitor::kMaxInFlight);
+    }
+};
+
+QTEST_MAIN(TestInputLatencyMonitor)
+#include "test_input_latency_monitor.moc"
@@ -0,0 +1,208 @@
+/*
+ * Fujisan Test Suite - Input Movie Tests
+ *
+ * Verifies InputMovie: identical consecutive frames merged into one run,
+ * checksums due every verify interval, the file format round-tripping,
+ * playback returning every frame in order with its checksums, and truncated
+ * or corrupt files rejected; on the real core, memory writes, fast loads,
+ * step over and instruction steps ending a recording.
+ */
+
+#include "inputmovie.h"
+#include "atariemulator.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QtWidgets/QApplication>
+#include <QtTest/QtTest>
+
+namespace {
+struct TestInput {
+    unsigned char joystick = 0x0F;
+    unsigned char trigger = 1;
+    unsigned char key = 0;
+    unsigned char console = 7;
+};
+
+InputMovie makeMovie(int verifyInterval = 4)
+{
+    InputMovie movie;
+    movie.begin(QByteArray("state-bytes"), int(sizeof(TestInput)), verifyInterval);
+    TestInput input;
+    for (int frame = 0; frame < 10; ++frame) {
+        input.joystick = frame < 6 ? 0x0F : 0x0B;  // idle, then held left
+        movie.appendFrame(&input);
+        if (movie.checksumDue()) {
+            movie.addChecksum(quint64(frame) * 3, quint64(frame) * 5);
+        }
+    }
+    return movie;
+}
+}  // namespace
+
+class TestInputMovie : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+
+    QString path(const QString& name) const { return m_dir.filePath(name); }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+        QCoreApplication::setOrganizationName(QStringLiteral("8bitrelics"));
+        QCoreApplication::setApplicationName(QStringLiteral("Fujisan"));
+        QSettings::setDefaultFormat(QSettings::IniFormat);
+        QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, m_dir.path());
+    }
+
+    void testIdenticalFramesShareARun()
+    {
+        const InputMovie movie = makeMovie();
+        QCOMPARE(movie.frameCount(), quint64(10));
+        QCOMPARE(movie.runCount(), 2);
+        QCOMPARE(movie.inputSize(), int(sizeof(TestInput)));
+    }
+
+    void testChecksumCadence()
+    {
+        const InputMovie movie = makeMovie(4);
+        QCOMPARE(movie.checksums().size(), 2);
+        QCOMPARE(movie.checksums().at(0).frame, quint64(4));
+        QCOMPARE(movie.checksums().at(1).frame, quint64(8));
+        QCOMPARE(movie.checksums().at(0).ram, quint64(9));
+
+        const InputMovie unverified = makeMovie(0);
+        QVERIFY(unverified.checksums().isEmpty());
+    }
+
+    void testSaveLoadRoundTrip()
+    {
+        const InputMovie original = makeMovie();
+        QString error;
+        QVERIFY2(original.save(path("round.fjm"), &error), qPrintable(error));
+
+        InputMovie loaded;
+        QVERIFY2(loaded.load(path("round.fjm"), &error), qPrintable(error));
+        QCOMPARE(loaded.state(), QByteArray("state-bytes"));
+        QCOMPARE(loaded.frameCount(), original.frameCount());
+        QCOMPARE(loaded.runCount(), original.runCount());
+        QCOMPARE(loaded.verifyInterval(), 4);
+        QCOMPARE(loaded.checksums().size(), 2);
+        QCOMPARE(loaded.checksums().at(1).screen, quint64(35));
+    }
+
+    void testPlayerReplaysFramesInOrder()
+    {
+        const InputMovie movie = makeMovie();
+        InputMovie::Player player(movie);
+        TestInput input;
+        QList<int> joystick;
+        QList<quint64> checkedAt;
+        while (player.nextFrame(&input)) {
+            joystick.append(input.joystick);
+            if (const InputMovie::Checksum* expected = player.checksumAfterFrame()) {
+                QCOMPARE(expected->frame, player.framesPlayed());
+                checkedAt.append(expected->frame);
+            }
+        }
+        QCOMPARE(joystick.size(), 10);
+        QCOMPARE(joystick.at(5), 0x0F);
+        QCOMPARE(joystick.at(6), 0x0B);
+        QCOMPARE(checkedAt, (QList<quint64>{4, 8}));
+        QCOMPARE(player.framesPlayed(), quint64(10));
+        QVERIFY(!player.nextFrame(&input));
+    }
+
+    void testRejectsTruncatedAndCorruptFiles()
+    {
+        QVERIFY(makeMovie().save(path("good.fjm")));
+        QFile good(path("good.fjm"));
+        QVERIFY(good.open(QIODevice::ReadOnly));
+        const QByteArray bytes = good.readAll();
+
+        auto write = [this](const QString& name, const QByteArray& data) {
+            QFile file(path(name));
+            return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+        };
+
+        InputMovie movie;
+        QString error;
+        QVERIFY(write("truncated.fjm", bytes.left(bytes.size() - 1)));
+        QVERIFY(!movie.load(path("truncated.fjm"), &error));
+        QVERIFY(!error.isEmpty());
+
+        QByteArray badMagic = bytes;
+        badMagic[0] = 'X';
+        QVERIFY(write("magic.fjm", badMagic));
+        QVERIFY(!movie.load(path("magic.fjm")));
+
+        // A run count that no longer adds up to the frame total
+        QByteArray badFrames = bytes;
+        badFrames[24] = char(bytes[24] + 1);
+        QVERIFY(write("frames.fjm", badFrames));
+        QVERIFY(!movie.load(path("frames.fjm")));
+        QCOMPARE(movie.frameCount(), quint64(0));
+
+        QVERIFY(!movie.load(path("missing.fjm")));
+    }
+
+    void testChangesOutsideTheInputEndARecording()
+    {
+        AtariEmulator emu(nullptr);
+        emu.setDeferTimerStart(true);
+        emu.enableAudio(false);
+        QVERIFY(emu.initializeWithConfig(false, QStringLiteral("-xl"), QStringLiteral("-pal"),
+                                         QStringLiteral("none")));
+        for (int i = 0; i < 120; ++i) {
+            emu.processFrame();
+        }
+        const auto recording = [&emu]() { return emu.movieStatus()["recording"].toBool(); };
+
+        // Frames the machine runs on its own input are recorded
+        QVERIFY(!emu.startMovieRecording(path("poke.fjm"), 10).contains("error"));
+        emu.processFrame();
+        QVERIFY(recording());
+        QCOMPARE(emu.movieStatus()["frames"].toInt(), 1);
+        QVERIFY(emu.writeMemoryBlock(0, 0x0680, QByteArray("\x2A", 1)));
+        QVERIFY(!recording());
+        QVERIFY(QFile::exists(path("poke.fjm")));
+
+        // An XEX whose program is an RTS at $0600
+        const QByteArray xex("\xFF\xFF\x00\x06\x00\x06\x60\xE0\x02\xE1\x02\x00\x06", 13);
+        QVERIFY(!emu.startMovieRecording(path("fastload.fjm"), 10).contains("error"));
+        QString error;
+        QVERIFY2(emu.fastLoadXex(xex, &error), qPrintable(error));
+        QVERIFY(!recording());
+
+        // JSR $0610 / JMP $0603, with an RTS at $0610
+        QByteArray code(0x11, '\xEA');
+        code.replace(0, 6, QByteArray("\x20\x10\x06\x4C\x03\x06", 6));
+        code[0x10] = '\x60';
+        emu.pauseEmulation();
+        QVERIFY(emu.writeMemoryBlock(0, 0x0600, code));
+        CPU_regPC = 0x0600;
+        QVERIFY(!emu.startMovieRecording(path("stepover.fjm"), 10).contains("error"));
+        QVERIFY(emu.stepOver());
+        QVERIFY(!recording());
+        QTRY_VERIFY(!emu.isRunToActive());
+
+        QVERIFY(!emu.startMovieRecording(path("step.fjm"), 10).contains("error"));
+        emu.stepOneInstruction();
+        QVERIFY(!recording());
+        emu.shutdown();
+    }
+};
+
+int main(int argc, char** argv)
+{
+    QApplication app(argc, argv);
+    TestInputMovie test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_input_movie.moc"
@@ -0,0 +1,87 @@
+/*
+ * Fujisan Test Suite - Latency Histogram Tests
+ *
+ * Verifies the fixed-bucket histograms behind status.get_metrics: log2 bucket
+ * bounds, percentiles reported as bucket upper bounds but never above the
+ * largest sample, the JSON summary, negative samples and reset.
+ */
+
+#include "latencyhistogram.h"
+
+#include <QtTest/QtTest>
+
+class TestLatencyHistogram : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testEmpty()
+    {
+        const LatencyHistogram histogram;
+        QCOMPARE(histogram.count(), quint64(0));
+        QCOMPARE(histogram.percentile(0.5), qint64(0));
+        const QJsonObject json = histogram.toJson();
+        QCOMPARE(json["count"].toInt(), 0);
+        QCOMPARE(json["mean_us"].toDouble(), 0.0);
+    }
+
+    void testPercentilesUseBucketBounds()
+    {
+        LatencyHistogram histogram;
+        // 90 fast samples (5 us, bucket [4, 8)) and 10 slow ones (1000 us, bucket [512, 1024))
+        for (int i = 0; i < 90; ++i) {
+            histogram.record(5);
+        }
+        for (int i = 0; i < 10; ++i) {
+            histogram.record(1000);
+        }
+        QCOMPARE(histogram.count(), quint64(100));
+        QCOMPARE(histogram.percentile(0.50), qint64(7));
+        QCOMPARE(histogram.percentile(0.90), qint64(7));
+        QCOMPARE(histogram.percentile(0.99), qint64(1000));  // bucket bound 1023, capped at max
+        QCOMPARE(histogram.maxMicroseconds(), qint64(1000));
+        QCOMPARE(histogram.totalMicroseconds(), qint64(90 * 5 + 10 * 1000));
+    }
+
+    void testJsonSummary()
+    {
+        LatencyHistogram histogram;
+        histogram.record(0);
+        histogram.record(1);
+        histogram.record(-3);  // clock skew: counted as 0
+        histogram.record(2);
+        const QJsonObject json = histogram.toJson();
+        QCOMPARE(json["count"].toInt(), 4);
+        QCOMPARE(json["total_us"].toInt(), 3);
+        QCOMPARE(json["mean_us"].toDouble(), 0.75);
+        QCOMPARE(json["max_us"].toInt(), 2);
+        QCOMPARE(json["p50_us"].toInt(), 1);
+        QCOMPARE(json["p99_us"].toInt(), 2);
+    }
+
+    void testHugeSamplesLandInLastBucket()
+    {
+        LatencyHistogram histogram;
+        histogram.record(qint64(1) << 40);
+        QCOMPARE(histogram.percentile(1.0), qint64(1) << 40);
+    }
+
+    void testReset()
+    {
+        LatencyHistogram histogram;
+        histogram.record(100);
+        histogram.reset();
+        QCOMPARE(histogram.count(), quint64(0));
+        QCOMPARE(histogram.maxMicroseconds(), qint64(0));
+        histogram.record(3);
+        QCOMPARE(histogram.percentile(0.5), qint64(3));
+    }
+
+    void testClockIsMonotonic()
+    {
+        const qint64 first = LatencyHistogram::nowMicroseconds();
+        QVERIFY(LatencyHistogram::nowMicroseconds() >= first);
+    }
+};
+
+QTEST_MAIN(TestLatencyHistogram)
+#include "test_latency_histogram.moc"
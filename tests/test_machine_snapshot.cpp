@@ -0,0 +1,120 @@
+/*
+ * Fujisan Test Suite - Machine Snapshot Tests
+ *
+ * Verifies MachineSnapshot: XE banks and cartridge banks sliced out of the
+ * captured memory, chip registers read back by name and reported in JSON,
+ * and the binary payload holding only the requested, captured sections with
+ * a layout that locates each of them.
+ */
+
+#include "machinesnapshot.h"
+
+#include <QtTest/QtTest>
+
+class TestMachineSnapshot : public QObject {
+    Q_OBJECT
+
+private:
+    // A 130XE with a 16 KB two-bank cartridge; bank n is filled with n
+    static MachineSnapshot xeSnapshot()
+    {
+        MachineSnapshot snapshot;
+        snapshot.sections = MachineSnapshot::AllSections;
+        snapshot.frame = 42;
+        snapshot.pc = 0xE459;
+        snapshot.memory = QByteArray(MachineSnapshot::kMemorySize, '\x00');
+        snapshot.extendedBanks = 4;
+        snapshot.mappedBank = 2;
+        for (int bank = 1; bank <= 4; ++bank) {
+            snapshot.extendedRam.append(QByteArray(MachineSnapshot::kBankSize, char(bank)));
+        }
+        snapshot.cartridgeType = 12;
+        snapshot.cartridgeState = 1;
+        snapshot.cartridgeSize = 0x4000;
+        snapshot.cartridge = QByteArray(0x2000, 'A') + QByteArray(0x2000, 'B');
+        for (int chip = 0; chip < MachineSnapshot::ChipCount; ++chip) {
+            const int count = MachineSnapshot::registerNames(static_cast<MachineSnapshot::Chip>(chip)).size();
+            snapshot.registers[chip] = QByteArray(count, '\x00');
+        }
+        return snapshot;
+    }
+
+private slots:
+    void testBanks()
+    {
+        const MachineSnapshot snapshot = xeSnapshot();
+        QCOMPARE(snapshot.bank(0).size(), int(MachineSnapshot::kMemorySize));
+        QCOMPARE(snapshot.bank(3), QByteArray(MachineSnapshot::kBankSize, '\x03'));
+        QVERIFY(snapshot.bank(5).isEmpty());
+        QVERIFY(snapshot.bank(-1).isEmpty());
+
+        QCOMPARE(snapshot.cartridgeBank(1, 0x2000), QByteArray(0x2000, 'B'));
+        QVERIFY(snapshot.cartridgeBank(2, 0x2000).isEmpty());
+        QVERIFY(snapshot.cartridgeBank(0, 0).isEmpty());
+    }
+
+    void testRegistersByName()
+    {
+        MachineSnapshot snapshot = xeSnapshot();
+        QVERIFY(snapshot.isValid());
+        QVERIFY(!MachineSnapshot().isValid());
+
+        // GTIA, POKEY up to AUDCTL and PIA are in address order
+        QCOMPARE(MachineSnapshot::registerNames(MachineSnapshot::Gtia).indexOf("COLBK"), 0x1A);
+        QCOMPARE(MachineSnapshot::registerNames(MachineSnapshot::Pokey).indexOf("AUDCTL"), 0x08);
+        QCOMPARE(MachineSnapshot::registerNames(MachineSnapshot::Pia).indexOf("PBCTL"), 0x03);
+
+        snapshot.registers[MachineSnapshot::Gtia][0x1A] = char(0x94);
+        snapshot.registers[MachineSnapshot::Pia][1] = char(0xE3);
+        QCOMPARE(snapshot.registerValue(MachineSnapshot::Gtia, "COLBK"), 0x94);
+        QCOMPARE(snapshot.registerValue(MachineSnapshot::Pia, "PORTB"), 0xE3);
+        QCOMPARE(snapshot.registerValue(MachineSnapshot::Antic, "COLBK"), -1);
+
+        const QJsonObject json = snapshot.toJson();
+        QCOMPARE(json["frame"].toInt(), 42);
+        QCOMPARE(json["cpu"].toObject()["pc"].toInt(), 0xE459);
+        QCOMPARE(json["extended_banks"].toInt(), 4);
+        QCOMPARE(json["mapped_bank"].toInt(), 2);
+        QCOMPARE(json["cartridge"].toObject()["size"].toInt(), 0x4000);
+        const QJsonObject registers = json["registers"].toObject();
+        QCOMPARE(registers["gtia"].toObject()["COLBK"].toInt(), 0x94);
+        QCOMPARE(registers["pia"].toObject()["PORTB"].toInt(), 0xE3);
+        QCOMPARE(registers["antic"].toObject().size(), 11);
+    }
+
+    void testPayloadLayout()
+    {
+        MachineSnapshot snapshot = xeSnapshot();
+        QJsonArray layout;
+        const QByteArray all = snapshot.payload(MachineSnapshot::AllSections, &layout);
+        QCOMPARE(all.size(), MachineSnapshot::kMemorySize + 4 * MachineSnapshot::kBankSize + 0x4000);
+        QCOMPARE(layout.size(), 3);
+        const QJsonObject extended = layout[1].toObject();
+        QCOMPARE(extended["section"].toString(), QString("extended"));
+        QCOMPARE(extended["offset"].toInt(), int(MachineSnapshot::kMemorySize));
+        QCOMPARE(all.mid(extended["offset"].toInt() + MachineSnapshot::kBankSize, 1), QByteArray("\x02", 1));
+
+        // Only what was both asked for and captured
+        layout = QJsonArray();
+        snapshot.sections = MachineSnapshot::CpuMemory | MachineSnapshot::CartridgeImage;
+        const QByteArray cart = snapshot.payload(MachineSnapshot::ExtendedRam | MachineSnapshot::CartridgeImage,
+                                                 &layout);
+        QCOMPARE(cart, snapshot.cartridge);
+        QCOMPARE(layout.size(), 1);
+        QCOMPARE(layout[0].toObject()["offset"].toInt(), 0);
+        QVERIFY(snapshot.payload(0, nullptr).isEmpty());
+    }
+
+    void testParseSections()
+    {
+        int sections = -1;
+        QVERIFY(MachineSnapshot::parseSections({"extended", "cartridge"}, &sections));
+        QCOMPARE(sections, int(MachineSnapshot::ExtendedRam | MachineSnapshot::CartridgeImage));
+        QVERIFY(MachineSnapshot::parseSections({}, &sections));
+        QCOMPARE(sections, 0);
+        QVERIFY(!MachineSnapshot::parseSections({"memory", "registers"}, &sections));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestMachineSnapshot)
+#include "test_machine_snapshot.moc"
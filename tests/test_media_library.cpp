@@ -0,0 +1,249 @@
+/*
+ * Fujisan Test Suite - Media Library Tests
+ *
+ * Verifies MediaLibrary: ATR geometry and DOS 2 directory, XEX segments and
+ * run address, CAR type and checksum and CAS description read from the
+ * images; searches over names, titles and directories; the index surviving a
+ * save and load; and background scans that read only new or changed files
+ * and forget the ones that are gone.
+ */
+
+#include "medialibrary.h"
+
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+namespace {
+bool writeFile(const QString& path, const QByteArray& bytes)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(bytes) == bytes.size();
+}
+
+// Single density 720-sector ATR with a bootable first sector and a DOS 2
+// directory holding the given "NAME.EXT" files
+QByteArray atrImage(const QStringList& files)
+{
+    constexpr int kSectors = 720;
+    const int dataBytes = kSectors * 128;
+    QByteArray image(16 + dataBytes, '\0');
+    image[0] = char(0x96);
+    image[1] = char(0x02);
+    image[2] = char((dataBytes / 16) & 0xFF);
+    image[3] = char((dataBytes / 16) >> 8);
+    image[4] = char(128);
+    image[16] = char(0x00);
+    image[17] = char(0x03);  // boot sector count
+
+    const int directory = 16 + 360 * 128;
+    for (int i = 0; i < files.size(); ++i) {
+        const int offset = directory + i * 16;
+        const QStringList parts = files[i].split('.');
+        image[offset] = char(0x42);  // in use, DOS 2
+        image[offset + 1] = char(1);
+        image[offset + 3] = char(4 + i);
+        const QByteArray name = parts[0].toLatin1().leftJustified(8, ' ');
+        const QByteArray extension = parts.value(1).toLatin1().leftJustified(3, ' ');
+        image.replace(offset + 5, 8, name);
+        image.replace(offset + 13, 3, extension);
+    }
+    return image;
+}
+
+QByteArray xexImage()
+{
+    // $2000-$2002, then RUNAD -> $2000
+    return QByteArray::fromHex("ffff00200220a9008d" "e002e1020020");
+}
+
+QByteArray carImage(quint32 type, bool goodChecksum)
+{
+    QByteArray data(8192, '\0');
+    data[0] = char(0x4C);
+    data[100] = char(0x10);
+    quint32 sum = 0x4C + 0x10 + (goodChecksum ? 0 : 1);
+    QByteArray header("CART");
+    for (quint32 value : {type, sum, quint32(0)}) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            header.append(char((value >> shift) & 0xFF));
+        }
+    }
+    return header + data;
+}
+
+QByteArray casChunk(const char* id, const QByteArray& data, int aux = 0)
+{
+    QByteArray chunk(id, 4);
+    chunk.append(char(data.size() & 0xFF)).append(char(data.size() >> 8));
+    chunk.append(char(aux & 0xFF)).append(char(aux >> 8));
+    return chunk + data;
+}
+
+QByteArray casImage()
+{
+    return casChunk("FUJI", "Star Raiders Tape") + casChunk("baud", QByteArray(), 600)
+           + casChunk("data", QByteArray(132, 'U'), 20000) + casChunk("data", QByteArray(132, 'U'), 250);
+}
+}  // namespace
+
+class TestMediaLibrary : public QObject {
+    Q_OBJECT
+
+private:
+    static MediaLibrary::Entry inspected(const QString& path)
+    {
+        MediaLibrary::Entry entry;
+        QString error;
+        if (!MediaLibrary::inspect(path, &entry, &error)) {
+            qWarning() << "inspect failed:" << path << error;
+        }
+        return entry;
+    }
+
+    static bool scan(MediaLibrary& library, int* filesRead = nullptr)
+    {
+        QSignalSpy finished(&library, &MediaLibrary::scanFinished);
+        library.rescan();
+        if (!finished.wait(10000)) {
+            return false;
+        }
+        if (filesRead) {
+            *filesRead = finished.first().at(1).toInt();
+        }
+        return true;
+    }
+
+private slots:
+    void testKindFromExtension()
+    {
+        MediaLibrary::Kind kind;
+        QVERIFY(MediaLibrary::kindForPath("/games/Boulder.ATR", &kind));
+        QCOMPARE(kind, MediaLibrary::Disk);
+        QVERIFY(MediaLibrary::kindForPath("demo.xex", &kind));
+        QCOMPARE(kind, MediaLibrary::Executable);
+        QVERIFY(MediaLibrary::kindForPath("tape.cas", &kind));
+        QCOMPARE(kind, MediaLibrary::Cassette);
+        QVERIFY(MediaLibrary::kindForPath("basic.rom", &kind));
+        QCOMPARE(kind, MediaLibrary::Cartridge);
+        QVERIFY(!MediaLibrary::kindForPath("readme.txt", &kind));
+    }
+
+    void testInspectDiskDirectory()
+    {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("dos.atr");
+        QVERIFY(writeFile(path, atrImage({"DOS.SYS", "DUP.SYS", "AUTORUN"})));
+        const MediaLibrary::Entry entry = inspected(path);
+        QCOMPARE(entry.kind, MediaLibrary::Disk);
+        QCOMPARE(entry.details["sectors"].toInt(), 720);
+        QCOMPARE(entry.details["sector_size"].toInt(), 128);
+        QVERIFY(entry.details["bootable"].toBool());
+        QVERIFY(entry.details["dos"].toBool());
+        QCOMPARE(entry.files, QStringList({"DOS.SYS", "DUP.SYS", "AUTORUN"}));
+        QCOMPARE(entry.sha1.size(), 40);
+
+        // A game disk with arbitrary bytes where a directory would be has none
+        QByteArray game = atrImage({});
+        game.replace(16 + 360 * 128, 4, QByteArray::fromHex("420102ff"));
+        QVERIFY(writeFile(path, game));
+        QVERIFY(inspected(path).files.isEmpty());
+    }
+
+    void testInspectExecutableCartridgeCassette()
+    {
+        QTemporaryDir dir;
+        QVERIFY(writeFile(dir.filePath("demo.xex"), xexImage()));
+        MediaLibrary::Entry entry = inspected(dir.filePath("demo.xex"));
+        QCOMPARE(entry.details["segments"].toInt(), 2);
+        QCOMPARE(entry.details["run_address"].toInt(), 0x2000);
+        QCOMPARE(entry.details["first_address"].toInt(), 0x2000);
+
+        QVERIFY(writeFile(dir.filePath("broken.xex"), QByteArray("MZ")));
+        QVERIFY(inspected(dir.filePath("broken.xex")).details.contains("error"));
+
+        QVERIFY(writeFile(dir.filePath("good.car"), carImage(1, true)));
+        entry = inspected(dir.filePath("good.car"));
+        QCOMPARE(entry.details["format"].toString(), QString("car"));
+        QCOMPARE(entry.details["cart_type"].toInt(), 1);
+        QVERIFY(entry.details["checksum_ok"].toBool());
+        QVERIFY(writeFile(dir.filePath("bad.car"), carImage(1, false)));
+        QVERIFY(!inspected(dir.filePath("bad.car")).details["checksum_ok"].toBool());
+        QVERIFY(writeFile(dir.filePath("plain.rom"), QByteArray(8192, 'x')));
+        QCOMPARE(inspected(dir.filePath("plain.rom")).details["format"].toString(), QString("raw"));
+
+        QVERIFY(writeFile(dir.filePath("tape.cas"), casImage()));
+        entry = inspected(dir.filePath("tape.cas"));
+        QCOMPARE(entry.title, QString("Star Raiders Tape"));
+        QCOMPARE(entry.details["blocks"].toInt(), 2);
+        QCOMPARE(entry.details["baud"].toInt(), 600);
+    }
+
+    void testScanSearchAndPersist()
+    {
+        QTemporaryDir dir;
+        QDir(dir.path()).mkpath("games/tapes");
+        QVERIFY(writeFile(dir.filePath("games/dos.atr"), atrImage({"DOS.SYS", "MULE.BAS"})));
+        QVERIFY(writeFile(dir.filePath("games/demo.xex"), xexImage()));
+        QVERIFY(writeFile(dir.filePath("games/tapes/tape.cas"), casImage()));
+        QVERIFY(writeFile(dir.filePath("games/copy.xex"), xexImage()));
+        QVERIFY(writeFile(dir.filePath("games/notes.txt"), "not media"));
+
+        const QString indexPath = dir.filePath("index.json");
+        MediaLibrary library(indexPath);
+        library.setFolders({dir.filePath("games")});
+        int filesRead = -1;
+        QVERIFY(scan(library, &filesRead));
+        QCOMPARE(filesRead, 4);
+        QCOMPARE(library.count(), 4);
+        QVERIFY(!library.isScanning());
+
+        QCOMPARE(library.search("mule").size(), 1);  // from the disk directory
+        QCOMPARE(library.search("raiders tape").size(), 1);  // every word of the title
+        QCOMPARE(library.search("raiders disk").size(), 0);
+        QCOMPARE(library.search(QString()).size(), 4);
+        QCOMPARE(library.search(QString(), 2).size(), 2);
+        QCOMPARE(library.entriesOfKind(MediaLibrary::Executable).size(), 2);
+        const MediaLibrary::Entry demo = library.entry(QFileInfo(dir.filePath("games/demo.xex")).absoluteFilePath());
+        QCOMPARE(library.pathsForHash(demo.sha1).size(), 2);
+
+        MediaLibrary reloaded(indexPath);
+        QVERIFY(reloaded.load());
+        QCOMPARE(reloaded.count(), 4);
+        const MediaLibrary::Entry disk = reloaded.search("dos.atr").value(0);
+        QCOMPARE(disk.files, QStringList({"DOS.SYS", "MULE.BAS"}));
+        QCOMPARE(disk.details["sectors"].toInt(), 720);
+    }
+
+    void testRescanReadsOnlyChangesAndDropsGoneFiles()
+    {
+        QTemporaryDir dir;
+        QVERIFY(writeFile(dir.filePath("a.xex"), xexImage()));
+        QVERIFY(writeFile(dir.filePath("b.xex"), xexImage()));
+        QVERIFY(writeFile(dir.filePath("c.cas"), casImage()));
+
+        MediaLibrary library;
+        library.setFolders({dir.path()});
+        int filesRead = -1;
+        QVERIFY(scan(library, &filesRead));
+        QCOMPARE(filesRead, 3);
+
+        QVERIFY(scan(library, &filesRead));
+        QCOMPARE(filesRead, 0);
+        QCOMPARE(library.count(), 3);
+
+        QVERIFY(QFile::remove(dir.filePath("b.xex")));
+        QVERIFY(writeFile(dir.filePath("c.cas"), casImage() + casChunk("data", QByteArray(132, 'U'), 250)));
+        QVERIFY(scan(library, &filesRead));
+        QCOMPARE(filesRead, 1);
+        QCOMPARE(library.count(), 2);
+        QVERIFY(!library.contains(QFileInfo(dir.filePath("b.xex")).absoluteFilePath()));
+        QCOMPARE(library.search("c.cas").value(0).details["blocks"].toInt(), 3);
+
+        library.clear();
+        QCOMPARE(library.count(), 0);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestMediaLibrary)
+#include "test_media_library.moc"
@@ -0,0 +1,178 @@
+/*
+ * Fujisan Test Suite - Message Encoder Tests
+ *
+ * Verifies MessageEncoder: default newline-delimited JSON, CBOR and
+ * MessagePack with the hex strings of address, register and memory fields
+ * and integral numbers turned into native integers, every other string
+ * (the id too) left alone, the length-prefixed framing with its compressed flag, and a
+ * memory dump shrinking several times over once deflated.
+ */
+
+#include "messageencoder.h"
+
+#include <QCborMap>
+#include <QCborValue>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QtEndian>
+#include <QtTest/QtTest>
+
+namespace {
+QJsonObject registersResponse()
+{
+    QJsonObject registers;
+    registers["pc"] = "$E477";
+    registers["a"] = "$1F";
+    registers["label"] = "$ is not hex";
+    QJsonObject response;
+    response["type"] = "response";
+    response["status"] = "success";
+    response["result"] = registers;
+    response["frame"] = 1200.0;
+    response["fps"] = 59.92;
+    return response;
+}
+
+QJsonObject memoryDump(int length)
+{
+    QJsonArray bytes;
+    for (int i = 0; i < length; ++i) {
+        bytes.append(QString("$%1").arg((i * 3) & 0x1F, 2, 16, QChar('0')).toUpper());
+    }
+    QJsonObject result;
+    result["address"] = "$0600";
+    result["data"] = bytes;
+    QJsonObject response;
+    response["type"] = "response";
+    response["result"] = result;
+    return response;
+}
+
+quint32 frameHeader(const QByteArray& frame)
+{
+    return qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(frame.constData()));
+}
+}  // namespace
+
+class TestMessageEncoder : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testDefaultIsNewlineJson()
+    {
+        const MessageEncoder encoder;
+        QVERIFY(!encoder.isFramed());
+        const QByteArray line = encoder.encode(registersResponse());
+        QVERIFY(line.endsWith('\n'));
+        QCOMPARE(line.count('\n'), 1);
+        QCOMPARE(QJsonDocument::fromJson(line).object(), registersResponse());
+    }
+
+    void testCborUsesNativeIntegers()
+    {
+        const MessageEncoder encoder(MessageEncoder::EncodingCbor, 0);
+        QVERIFY(encoder.isFramed());
+        const QByteArray frame = encoder.encode(registersResponse());
+        QCOMPARE(int(frameHeader(frame)), frame.size() - 4);
+
+        const QCborMap map = QCborValue::fromCbor(frame.mid(4)).toMap();
+        const QCborMap result = map.value(QStringLiteral("result")).toMap();
+        QVERIFY(result.value(QStringLiteral("pc")).isInteger());
+        QCOMPARE(result.value(QStringLiteral("pc")).toInteger(), qint64(0xE477));
+        QCOMPARE(result.value(QStringLiteral("a")).toInteger(), qint64(0x1F));
+        QCOMPARE(result.value(QStringLiteral("label")).toString(), QString("$ is not hex"));
+        QVERIFY(map.value(QStringLiteral("frame")).isInteger());
+        QVERIFY(map.value(QStringLiteral("fps")).isDouble());
+    }
+
+    void testMsgPackBytes()
+    {
+        QJsonObject message;
+        message["pc"] = "$E477";
+        message["n"] = -1.0;
+        message["ok"] = true;
+        const QByteArray payload = MessageEncoder::toMsgPack(message);
+        // fixmap(3), keys in QJsonObject order: "n" -1, "ok" true, "pc" uint16 0xE477
+        const QByteArray expected("\x83\xA1n\xFF\xA2ok\xC3\xA2pc\xCD\xE4\x77", 15);
+        QCOMPARE(payload, expected);
+
+        const MessageEncoder encoder(MessageEncoder::EncodingMsgPack, 0);
+        const QByteArray frame = encoder.encode(message);
+        QCOMPARE(frame.mid(4), expected);
+        QCOMPARE(frameHeader(frame), quint32(expected.size()));
+    }
+
+    void testOnlyHexFieldsBecomeIntegers()
+    {
+        QJsonObject result;
+        result["text"] = "$12";
+        result["rows"] = QJsonArray{"$12", "READY"};
+        result["label"] = "$FF";
+        result["address"] = "$-1";
+        result["data"] = QJsonArray{"$0A", "$FF"};
+        QJsonObject response;
+        response["id"] = "$1";
+        response["result"] = result;
+
+        const QCborMap map = QCborValue::fromCbor(MessageEncoder::toCbor(response)).toMap();
+        QCOMPARE(map.value(QStringLiteral("id")).toString(), QString("$1"));
+        const QCborMap cbor = map.value(QStringLiteral("result")).toMap();
+        QCOMPARE(cbor.value(QStringLiteral("text")).toString(), QString("$12"));
+        QCOMPARE(cbor.value(QStringLiteral("rows")).toArray().at(0).toString(), QString("$12"));
+        QCOMPARE(cbor.value(QStringLiteral("label")).toString(), QString("$FF"));
+        QCOMPARE(cbor.value(QStringLiteral("address")).toString(), QString("$-1"));
+        QCOMPARE(cbor.value(QStringLiteral("data")).toArray().at(1).toInteger(), qint64(0xFF));
+
+        // fixmap(1) "id" fixstr "$1", not the integer 1
+        QJsonObject idOnly;
+        idOnly["id"] = "$1";
+        QCOMPARE(MessageEncoder::toMsgPack(idOnly), QByteArray("\x81\xA2id\xA2$1", 7));
+        QJsonObject textOnly;
+        textOnly["text"] = "$12";
+        QCOMPARE(MessageEncoder::toMsgPack(textOnly), QByteArray("\x81\xA4text\xA3$12", 10));
+    }
+
+    void testCompressionShrinksLargePayloads()
+    {
+        const QJsonObject dump = memoryDump(4096);
+        const int plainSize = MessageEncoder().encode(dump).size();
+        const int cborSize = MessageEncoder(MessageEncoder::EncodingCbor, 0).encode(dump).size();
+        QVERIFY(cborSize * 2 < plainSize);  // one or two bytes per value instead of "$XX"
+
+        bool compressed = false;
+        const QByteArray frame = MessageEncoder(MessageEncoder::EncodingJson, 1024).encode(dump, &compressed);
+        QVERIFY(compressed);
+        const quint32 header = frameHeader(frame);
+        QVERIFY(header & MessageEncoder::kCompressedFlag);
+        QCOMPARE(int(header & ~MessageEncoder::kCompressedFlag), frame.size() - 4);
+        QVERIFY(frame.size() * 4 < plainSize);
+
+        // qUncompress wants the uncompressed size ahead of the zlib stream
+        QByteArray stream(4, Qt::Uninitialized);
+        qToBigEndian(quint32(plainSize), reinterpret_cast<uchar*>(stream.data()));
+        stream.append(frame.mid(4));
+        QCOMPARE(QJsonDocument::fromJson(qUncompress(stream)).object(), dump);
+    }
+
+    void testSmallMessagesStayUncompressed()
+    {
+        bool compressed = true;
+        const QByteArray frame =
+            MessageEncoder(MessageEncoder::EncodingCbor, 1024).encode(registersResponse(), &compressed);
+        QVERIFY(!compressed);
+        QVERIFY(!(frameHeader(frame) & MessageEncoder::kCompressedFlag));
+    }
+
+    void testEncodingNames()
+    {
+        MessageEncoder::Encoding encoding = MessageEncoder::EncodingJson;
+        QVERIFY(MessageEncoder::parseEncoding("msgpack", &encoding));
+        QCOMPARE(encoding, MessageEncoder::EncodingMsgPack);
+        QCOMPARE(MessageEncoder::encodingName(encoding), QString("msgpack"));
+        QVERIFY(!MessageEncoder::parseEncoding("xml", &encoding));
+        QVERIFY(MessageEncoder(MessageEncoder::EncodingCbor, 0) != MessageEncoder(MessageEncoder::EncodingCbor, 512));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestMessageEncoder)
+#include "test_message_encoder.moc"
@@ -0,0 +1,150 @@
+/*
+ * Fujisan Test Suite - Performance Monitor Tests
+ *
+ * Verifies PerformanceMonitor: nothing recorded while disabled, the rolling
+ * window wrapping at kWindow, percentiles and the per-unit histograms of
+ * summary(), reset(), emulation speed from the frame intervals, and the
+ * status.get_performance JSON with and without history.
+ */
+
+#include "performancemonitor.h"
+
+#include <QJsonArray>
+#include <QtTest/QtTest>
+
+class TestPerformanceMonitor : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testDisabledRecordsNothing()
+    {
+        PerformanceMonitor monitor;
+        QVERIFY(!monitor.isEnabled());
+        monitor.record(PerformanceMonitor::Render, 100);
+        QVERIFY(monitor.window(PerformanceMonitor::Render).isEmpty());
+
+        monitor.setEnabled(true);
+        monitor.record(PerformanceMonitor::Render, 100);
+        QCOMPARE(monitor.window(PerformanceMonitor::Render), QVector<qint32>{100});
+        QVERIFY(monitor.window(PerformanceMonitor::EmulatedFrame).isEmpty());
+    }
+
+    void testWindowWraps()
+    {
+        PerformanceMonitor monitor;
+        monitor.setEnabled(true);
+        const int window = PerformanceMonitor::kWindow;
+        for (int i = 0; i < window + 10; ++i) {
+            monitor.record(PerformanceMonitor::EmulatedFrame, i);
+        }
+        const QVector<qint32> samples = monitor.window(PerformanceMonitor::EmulatedFrame);
+        QCOMPARE(samples.size(), window);
+        QCOMPARE(samples.first(), 10);
+        QCOMPARE(samples.last(), window + 9);
+
+        const QJsonObject entry = monitor.toJson()["metrics"].toObject()["emulated_frame"].toObject();
+        QCOMPARE(entry["count"].toInt(), window);
+        QCOMPARE(entry["recorded"].toInt(), window + 10);
+        QCOMPARE(entry["max_all_time"].toInt(), window + 9);
+        QCOMPARE(entry["min"].toInt(), 10);
+    }
+
+    void testSummary()
+    {
+        QVector<qint32> samples;
+        for (int i = 1; i <= 100; ++i) {
+            samples.append(i);
+        }
+        QJsonObject summary = PerformanceMonitor::summary(PerformanceMonitor::Render, samples);
+        QCOMPARE(summary["unit"].toString(), QString("us"));
+        QCOMPARE(summary["count"].toInt(), 100);
+        QCOMPARE(summary["last"].toInt(), 100);
+        QCOMPARE(summary["p50"].toInt(), 50);
+        QCOMPARE(summary["p90"].toInt(), 90);
+        QCOMPARE(summary["p99"].toInt(), 99);
+        QCOMPARE(summary["mean"].toDouble(), 50.5);
+
+        // log2 buckets: 1 -> 0, 2-3 -> 1, 4-7 -> 2, ... 1000 -> 9
+        summary = PerformanceMonitor::summary(PerformanceMonitor::Render, {1, 2, 3, 4, 1000});
+        const QJsonArray log2 = summary["histogram"].toArray();
+        QCOMPARE(log2.size(), 10);
+        QCOMPARE(log2[0].toInt(), 1);
+        QCOMPARE(log2[1].toInt(), 2);
+        QCOMPARE(log2[2].toInt(), 1);
+        QCOMPARE(log2[9].toInt(), 1);
+
+        summary = PerformanceMonitor::summary(PerformanceMonitor::AudioFill, {0, 15, 19, 100});
+        QCOMPARE(summary["unit"].toString(), QString("percent"));
+        const QJsonArray fill = summary["histogram"].toArray();
+        QCOMPARE(fill.size(), 10);
+        QCOMPARE(fill[0].toInt(), 1);
+        QCOMPARE(fill[1].toInt(), 2);
+        QCOMPARE(fill[9].toInt(), 1);
+
+        summary = PerformanceMonitor::summary(PerformanceMonitor::AudioUnderruns, {0, 2, 0, 1});
+        QCOMPARE(summary["unit"].toString(), QString("count"));
+        QCOMPARE(summary["sum"].toInt(), 3);
+        QVERIFY(!summary.contains("histogram"));
+
+        summary = PerformanceMonitor::summary(PerformanceMonitor::GuiStall, {});
+        QCOMPARE(summary["count"].toInt(), 0);
+        QVERIFY(!summary.contains("p50"));
+    }
+
+    void testReset()
+    {
+        PerformanceMonitor monitor;
+        monitor.setEnabled(true);
+        monitor.record(PerformanceMonitor::SioWait, 5000);
+        monitor.record(PerformanceMonitor::SioWait, 200);
+        monitor.reset();
+        QVERIFY(monitor.window(PerformanceMonitor::SioWait).isEmpty());
+
+        monitor.record(PerformanceMonitor::SioWait, 300);
+        QCOMPARE(monitor.window(PerformanceMonitor::SioWait), QVector<qint32>{300});
+        const QJsonObject entry = monitor.toJson()["metrics"].toObject()["sio_wait"].toObject();
+        QCOMPARE(entry["recorded"].toInt(), 1);
+        QCOMPARE(entry["total"].toInt(), 300);
+        QCOMPARE(entry["max_all_time"].toInt(), 300);
+    }
+
+    void testEmulationPercent()
+    {
+        PerformanceMonitor monitor;
+        QCOMPARE(monitor.emulationPercent(), 0.0);
+        monitor.setEnabled(true);
+        monitor.setNominalFrameUs(20000);
+        for (int i = 0; i < 10; ++i) {
+            monitor.record(PerformanceMonitor::FrameInterval, 40000);
+        }
+        QCOMPARE(monitor.emulationPercent(), 50.0);
+        monitor.setNominalFrameUs(40000);
+        QCOMPARE(monitor.emulationPercent(), 100.0);
+    }
+
+    void testJsonHistory()
+    {
+        PerformanceMonitor monitor;
+        monitor.setEnabled(true);
+        for (int i = 1; i <= 5; ++i) {
+            monitor.record(PerformanceMonitor::PresentLatency, i * 1000);
+        }
+        QJsonObject json = monitor.toJson();
+        QVERIFY(json["enabled"].toBool());
+        QCOMPARE(json["window"].toInt(), int(PerformanceMonitor::kWindow));
+        QJsonObject metrics = json["metrics"].toObject();
+        QCOMPARE(metrics.size(), int(PerformanceMonitor::kMetricCount));
+        QVERIFY(!metrics["present_latency"].toObject().contains("history"));
+
+        json = monitor.toJson(3);
+        metrics = json["metrics"].toObject();
+        const QJsonArray history = metrics["present_latency"].toObject()["history"].toArray();
+        QCOMPARE(history.size(), 3);
+        QCOMPARE(history[0].toInt(), 3000);
+        QCOMPARE(history[2].toInt(), 5000);
+        QVERIFY(metrics["gui_stall"].toObject()["history"].toArray().isEmpty());
+    }
+};
+
+QTEST_GUILESS_MAIN(TestPerformanceMonitor)
+#include "test_performance_monitor.moc"
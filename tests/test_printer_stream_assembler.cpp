@@ -0,0 +1,111 @@
+/*
+ * Fujisan Test Suite - Printer Stream Assembler Tests
+ *
+ * Verifies how PrinterWidget turns FujiNet-PC's whole-job /print payloads
+ * into appended chunks: repeats are duplicates, a job that grows yields just
+ * its new tail, and a payload that no longer matches the start or end of
+ * what was seen is a new job.
+ */
+
+#include "printerstreamassembler.h"
+
+#include <QtTest/QtTest>
+
+class TestPrinterStreamAssembler : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testFirstPayloadIsNewJob()
+    {
+        PrinterStreamAssembler stream;
+        const PrinterStreamAssembler::Update update = stream.feed("10 PRINT \"HI\"\n");
+        QCOMPARE(int(update.kind), int(PrinterStreamAssembler::NewJob));
+        QCOMPARE(update.delta, QByteArray("10 PRINT \"HI\"\n"));
+        QCOMPARE(stream.received(), qint64(14));
+    }
+
+    void testDuplicate()
+    {
+        PrinterStreamAssembler stream;
+        stream.feed("READY\n");
+        const PrinterStreamAssembler::Update update = stream.feed("READY\n");
+        QCOMPARE(int(update.kind), int(PrinterStreamAssembler::Duplicate));
+        QVERIFY(update.delta.isEmpty());
+    }
+
+    void testGrowingJobReturnsOnlyNewTail()
+    {
+        PrinterStreamAssembler stream;
+        QByteArray job;
+        for (int line = 0; line < 200; ++line) {
+            const QByteArray text = QByteArray::number(line * 10) + " REM LINE\n";
+            job += text;
+            const PrinterStreamAssembler::Update update = stream.feed(job);
+            QCOMPARE(int(update.kind),
+                     int(line == 0 ? PrinterStreamAssembler::NewJob : PrinterStreamAssembler::Appended));
+            QCOMPARE(update.delta, text);
+        }
+        QCOMPARE(stream.received(), qint64(job.size()));
+        QCOMPARE(int(stream.feed(job).kind), int(PrinterStreamAssembler::Duplicate));
+    }
+
+    void testDifferentJobDetected()
+    {
+        const QByteArray first(300, 'a');
+
+        // Same length, different start
+        PrinterStreamAssembler head;
+        head.feed(first);
+        QByteArray changedHead = first;
+        changedHead[0] = 'b';
+        QCOMPARE(int(head.feed(changedHead).kind), int(PrinterStreamAssembler::NewJob));
+
+        // Longer, but what was the end no longer lines up
+        PrinterStreamAssembler tail;
+        tail.feed(first);
+        QByteArray changedTail = first + "more";
+        changedTail[first.size() - 1] = 'z';
+        const PrinterStreamAssembler::Update update = tail.feed(changedTail);
+        QCOMPARE(int(update.kind), int(PrinterStreamAssembler::NewJob));
+        QCOMPARE(update.delta, changedTail);
+        QCOMPARE(tail.received(), qint64(changedTail.size()));
+    }
+
+    void testShorterPayloadIsNewJob()
+    {
+        PrinterStreamAssembler stream;
+        stream.feed("LISTING THAT WAS LONG\n");
+        const PrinterStreamAssembler::Update update = stream.feed("SHORT\n");
+        QCOMPARE(int(update.kind), int(PrinterStreamAssembler::NewJob));
+        QCOMPARE(update.delta, QByteArray("SHORT\n"));
+        // And it continues from there
+        QCOMPARE(stream.feed("SHORT\nNEXT\n").delta, QByteArray("NEXT\n"));
+    }
+
+    void testShortJobGrowsPastWindow()
+    {
+        // A job that starts smaller than the windows keeps checking its head
+        PrinterStreamAssembler stream;
+        stream.feed("AB");
+        const QByteArray longer = "AB" + QByteArray(PrinterStreamAssembler::kWindowBytes * 2, 'x');
+        QCOMPARE(int(stream.feed(longer).kind), int(PrinterStreamAssembler::Appended));
+        QByteArray changed = longer + "y";
+        changed[1] = 'Q';
+        QCOMPARE(int(stream.feed(changed).kind), int(PrinterStreamAssembler::NewJob));
+    }
+
+    void testEmptyAndReset()
+    {
+        PrinterStreamAssembler stream;
+        QCOMPARE(int(stream.feed(QByteArray()).kind), int(PrinterStreamAssembler::Duplicate));
+        QCOMPARE(stream.received(), qint64(0));
+
+        stream.feed("PAGE 1\n");
+        stream.reset();
+        QCOMPARE(stream.received(), qint64(0));
+        QCOMPARE(int(stream.feed("PAGE 1\n").kind), int(PrinterStreamAssembler::NewJob));
+    }
+};
+
+QTEST_MAIN(TestPrinterStreamAssembler)
+#include "test_printer_stream_assembler.moc"
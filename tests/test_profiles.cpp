@@ -1,8 +1,10 @@
 /*
  * Fujisan Test Suite - Configuration Profile Tests
  *
- * Verifies ConfigurationProfile JSON serialization round-trip and
- * ProfileStorage file I/O, listing, and deletion.
+ * Verifies ConfigurationProfile JSON serialization round-trip,
+ * ProfileStorage file I/O, listing, and deletion, and that
+ * ConfigurationProfileManager's in-memory index follows the profile
+ * directory and serves loads without reading the file.
  */
 
 #include <QCoreApplication>
@@ -12,6 +14,7 @@
 #include <QtTest/QtTest>
 
 #include "configurationprofile.h"
+#include "configurationprofilemanager.h"
 
 class TestProfiles : public QObject {
     Q_OBJECT
@@ -404,6 +407,57 @@ private slots:
         p.updateLastUsed();
         QVERIFY(p.lastUsed > before);
     }
+
+    // ---------------------------------------------------------------
+    // Manager index: picks up profiles added, edited and removed on disk
+    // ---------------------------------------------------------------
+    void testManagerIndexFollowsDisk()
+    {
+        ConfigurationProfileManager manager;
+        QVERIFY(manager.profileExists("Default"));
+        QVERIFY(!manager.profileExists("watched"));
+
+        ConfigurationProfile p = makeFullProfile();
+        p.name = "watched";
+        p.description = "first";
+        QVERIFY(ProfileStorage::saveProfileToFile("watched", p));
+        QTRY_VERIFY(manager.getProfileNames().contains("watched"));
+        QCOMPARE(manager.getProfileDescription("watched"), QString("first"));
+
+        p.description = "edited outside Fujisan";
+        QVERIFY(ProfileStorage::saveProfileToFile("watched", p));
+        QTRY_COMPARE(manager.getProfileDescription("watched"), QString("edited outside Fujisan"));
+
+        QVERIFY(ProfileStorage::deleteProfileFile("watched"));
+        QTRY_VERIFY(!manager.profileExists("watched"));
+        QCOMPARE(manager.getProfileNames().first(), QString("Default"));
+    }
+
+    // ---------------------------------------------------------------
+    // Manager loadProfile: served from the index, lastUsed written behind
+    // ---------------------------------------------------------------
+    void testManagerLoadProfileFromIndex()
+    {
+        ConfigurationProfile loaded;
+        {
+            ConfigurationProfileManager manager;
+
+            // Saved after the last scan: the load rescans instead of failing
+            ConfigurationProfile p = makeFullProfile();
+            p.name = "indexed";
+            QVERIFY(ProfileStorage::saveProfileToFile("indexed", p));
+            loaded = manager.loadProfile("indexed");
+            QVERIFY(loaded.isValid());
+            QCOMPARE(loaded.machineType, p.machineType);
+            QCOMPARE(manager.getProfileLastUsed("indexed"), loaded.lastUsed);
+
+            QVERIFY(!manager.loadProfile("no such profile").isValid());
+        }   // destruction waits for the background write
+
+        const ConfigurationProfile onDisk = ProfileStorage::loadProfileFromFile("indexed");
+        QCOMPARE(onDisk.lastUsed.toSecsSinceEpoch(), loaded.lastUsed.toSecsSinceEpoch());
+        ProfileStorage::deleteProfileFile("indexed");
+    }
 };
 
 QTEST_MAIN(TestProfiles)
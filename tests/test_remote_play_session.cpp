@@ -0,0 +1,143 @@
+/*
+ * Fujisan Test Suite - Remote Play Session Tests
+ *
+ * Verifies RemotePlaySession: input is released jitter_frames after it
+ * arrived, bursts play out one packet per frame but never beyond twice the
+ * delay, late and duplicate sequence numbers are dropped (across wraparound),
+ * a rewind releases everything, and acknowledged frames drive the smoothed
+ * round trip and the adaptive frame skip.
+ */
+
+#include "remoteplaysession.h"
+
+#include <QtTest/QtTest>
+
+class TestRemotePlaySession : public QObject {
+    Q_OBJECT
+
+private:
+    static RemotePlaySession::InputPacket packet(quint32 sequence, int direction = 15)
+    {
+        RemotePlaySession::InputPacket input;
+        input.sequence = sequence;
+        RemotePlaySession::JoystickInput joystick;
+        joystick.direction = direction;
+        input.joysticks.append(joystick);
+        return input;
+    }
+
+private slots:
+    void testInputIsHeldForTheJitterDelay()
+    {
+        RemotePlaySession session(3, false, 50);
+        QVERIFY(session.queueInput(packet(1, 14), 100));
+        QVERIFY(session.takeDueInput(101).isEmpty());
+        QVERIFY(session.takeDueInput(102).isEmpty());
+        const QVector<RemotePlaySession::InputPacket> due = session.takeDueInput(103);
+        QCOMPARE(due.size(), 1);
+        QCOMPARE(due.first().joysticks.first().direction, 14);
+        QCOMPARE(session.queuedInput(), 0);
+    }
+
+    void testBurstPlaysOutOnePacketPerFrame()
+    {
+        RemotePlaySession session(2, false, 50);
+        for (quint32 sequence = 1; sequence <= 3; ++sequence) {
+            QVERIFY(session.queueInput(packet(sequence), 200));
+        }
+        QCOMPARE(session.takeDueInput(202).size(), 1);
+        QCOMPARE(session.takeDueInput(203).size(), 1);
+        QCOMPARE(session.takeDueInput(204).size(), 1);
+        QCOMPARE(session.queuedInput(), 0);
+    }
+
+    void testBacklogIsNeverHeldPastTwiceTheDelay()
+    {
+        RemotePlaySession session(1, false, 50);
+        for (quint32 sequence = 1; sequence <= 10; ++sequence) {
+            QVERIFY(session.queueInput(packet(sequence), 50));
+        }
+        // Release frames 51, 52, then capped at 50 + 2 * 1 + 1
+        QCOMPARE(session.takeDueInput(52).size(), 2);
+        QCOMPARE(session.takeDueInput(53).size(), 8);
+    }
+
+    void testLateAndDuplicateInputIsDropped()
+    {
+        RemotePlaySession session(0, false, 50);
+        QVERIFY(session.queueInput(packet(5), 10));
+        QVERIFY(!session.queueInput(packet(5), 10));
+        QVERIFY(!session.queueInput(packet(4), 10));
+        QCOMPARE(session.stats()["late_input"].toInt(), 2);
+
+        // The client's counter may wrap
+        RemotePlaySession wrapping(0, false, 50);
+        QVERIFY(wrapping.queueInput(packet(0xFFFFFFFEu), 10));
+        QVERIFY(wrapping.queueInput(packet(1), 10));
+    }
+
+    void testRewindReleasesEverything()
+    {
+        RemotePlaySession session(5, false, 50);
+        QVERIFY(session.takeDueInput(500).isEmpty());
+        QVERIFY(session.queueInput(packet(1), 500));
+        QVERIFY(session.queueInput(packet(2), 500));
+        QCOMPARE(session.takeDueInput(400).size(), 2);
+        QCOMPARE(session.stats()["applied_input"].toInt(), 2);
+    }
+
+    void testAcknowledgementsSmoothTheRoundTrip()
+    {
+        RemotePlaySession session(2, true, 50);
+        session.frameSent(10, 1000000);
+        QVERIFY(session.acknowledge(10, 1040000));
+        QCOMPARE(session.smoothedRttUs(), qint64(40000));
+        QCOMPARE(session.frameSkip(), 1);
+        QVERIFY(!session.acknowledge(10, 1050000));
+        QVERIFY(!session.acknowledge(11, 1050000));
+
+        // One slow sample moves the estimate by an eighth
+        session.frameSent(11, 2000000);
+        QVERIFY(session.acknowledge(11, 2200000));
+        QCOMPARE(session.smoothedRttUs(), qint64(60000));
+        QCOMPARE(session.frameSkip(), 2);
+    }
+
+    void testAcknowledgingForgetsEarlierFrames()
+    {
+        RemotePlaySession session(2, false, 50);
+        for (quint64 frame = 1; frame <= 5; ++frame) {
+            session.frameSent(frame, qint64(frame) * 16000);
+        }
+        QVERIFY(session.acknowledge(3, 100000));
+        QCOMPARE(session.stats()["frames_in_flight"].toInt(), 2);
+        QVERIFY(!session.acknowledge(2, 110000));
+    }
+
+    void testFrameSkipNeedsAdaptiveAndIsCapped()
+    {
+        RemotePlaySession fixed(2, false, 10);
+        fixed.frameSent(1, 0);
+        QVERIFY(fixed.acknowledge(1, 500000));
+        QCOMPARE(fixed.frameSkip(), 1);
+
+        RemotePlaySession adaptive(2, true, 10);
+        adaptive.frameSent(1, 0);
+        QVERIFY(adaptive.acknowledge(1, 500000));
+        QCOMPARE(adaptive.frameSkip(), RemotePlaySession::kMaxFrameSkip);
+    }
+
+    void testSentFramesAreBounded()
+    {
+        RemotePlaySession session;
+        for (quint64 frame = 0; frame < 500; ++frame) {
+            session.frameSent(frame, 0);
+        }
+        QCOMPARE(session.stats()["frames_in_flight"].toInt(), RemotePlaySession::kMaxFramesInFlight);
+        QVERIFY(!session.acknowledge(0, 1000));
+        QVERIFY(session.acknowledge(499, 1000));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestRemotePlaySession)
+#include "test_remote_play_session.moc"
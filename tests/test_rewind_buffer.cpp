@@ -0,0 +1,143 @@
+/*
+ * Fujisan Test Suite - Rewind Buffer Tests
+ *
+ * Verifies the snapshot ring behind system.rewind: exact round-trips through
+ * the XOR/zero-run deltas, states of varying size, eviction of the oldest
+ * history when the arena budget is exhausted, and compression of near-identical
+ * snapshots.
+ */
+
+#include "rewindbuffer.h"
+
+#include <QtTest/QtTest>
+#include <QRandomGenerator>
+#include <cstring>
+#include <vector>
+
+class TestRewindBuffer : public QObject {
+    Q_OBJECT
+
+private:
+    static constexpr int kStateSize = 70000;
+
+    // A "state" that changes a few scattered bytes per frame, like RAM between snapshots
+    static std::vector<unsigned char> mutate(const std::vector<unsigned char>& previous, quint32 seed)
+    {
+        std::vector<unsigned char> next = previous;
+        QRandomGenerator rng(seed);
+        for (int i = 0; i < 64; ++i) {
+            next[rng.bounded(static_cast<quint32>(next.size()))] = static_cast<unsigned char>(rng.generate());
+        }
+        return next;
+    }
+
+private slots:
+    void testEmptyBuffer()
+    {
+        RewindBuffer buffer(kStateSize, 1 << 20);
+        QCOMPARE(buffer.depth(), 0);
+        QVERIFY(buffer.rewind(0, nullptr, nullptr) == nullptr);
+    }
+
+    void testRoundTripThroughDeltas()
+    {
+        RewindBuffer buffer(kStateSize, 8 << 20);
+        std::vector<std::vector<unsigned char>> history;
+        std::vector<unsigned char> state(kStateSize, 0xAA);
+        for (quint32 frame = 0; frame < 20; ++frame) {
+            state = mutate(state, frame + 1);
+            history.push_back(state);
+            buffer.push(state.data(), kStateSize, frame * 10);
+        }
+        QCOMPARE(buffer.depth(), 20);
+        QCOMPARE(buffer.frameAt(3), quint64(160));
+
+        int size = 0;
+        quint64 frame = 0;
+        const unsigned char* restored = buffer.rewind(3, &size, &frame);
+        QVERIFY(restored != nullptr);
+        QCOMPARE(size, kStateSize);
+        QCOMPARE(frame, quint64(160));
+        QVERIFY(std::memcmp(restored, history[16].data(), kStateSize) == 0);
+        QCOMPARE(buffer.depth(), 17);
+
+        // Keep going back one at a time to the oldest state
+        for (int i = 15; i >= 0; --i) {
+            restored = buffer.rewind(1, &size, &frame);
+            QVERIFY(restored != nullptr);
+            QVERIFY(std::memcmp(restored, history[i].data(), kStateSize) == 0);
+        }
+        QCOMPARE(buffer.depth(), 1);
+        QVERIFY(buffer.rewind(1, nullptr, nullptr) == nullptr);
+    }
+
+    void testPushAfterRewindContinuesHistory()
+    {
+        RewindBuffer buffer(kStateSize, 8 << 20);
+        std::vector<unsigned char> a(kStateSize, 1), b = mutate(a, 7), c = mutate(b, 8), d = mutate(b, 9);
+        buffer.push(a.data(), kStateSize, 0);
+        buffer.push(b.data(), kStateSize, 1);
+        buffer.push(c.data(), kStateSize, 2);
+        QVERIFY(buffer.rewind(1, nullptr, nullptr) != nullptr);  // back to b
+        buffer.push(d.data(), kStateSize, 3);                     // new branch from b
+
+        const unsigned char* restored = buffer.rewind(1, nullptr, nullptr);
+        QVERIFY(std::memcmp(restored, b.data(), kStateSize) == 0);
+        restored = buffer.rewind(1, nullptr, nullptr);
+        QVERIFY(std::memcmp(restored, a.data(), kStateSize) == 0);
+    }
+
+    void testStatesOfDifferentSize()
+    {
+        RewindBuffer buffer(kStateSize, 4 << 20);
+        std::vector<unsigned char> small(1000, 0x55), large(kStateSize, 0x33);
+        buffer.push(large.data(), kStateSize, 0);
+        buffer.push(small.data(), 1000, 1);
+        buffer.push(large.data(), kStateSize, 2);
+
+        int size = 0;
+        const unsigned char* restored = buffer.rewind(1, &size, nullptr);
+        QCOMPARE(size, 1000);
+        QVERIFY(std::memcmp(restored, small.data(), 1000) == 0);
+        restored = buffer.rewind(1, &size, nullptr);
+        QCOMPARE(size, kStateSize);
+        QVERIFY(std::memcmp(restored, large.data(), kStateSize) == 0);
+    }
+
+    void testBudgetEvictsOldestFirst()
+    {
+        // Small budget: only a handful of deltas fit
+        RewindBuffer buffer(kStateSize, 4096);
+        std::vector<std::vector<unsigned char>> history;
+        std::vector<unsigned char> state(kStateSize, 0);
+        for (quint32 frame = 0; frame < 200; ++frame) {
+            state = mutate(state, frame + 100);
+            history.push_back(state);
+            buffer.push(state.data(), kStateSize, frame);
+            QVERIFY(buffer.usedBytes() <= buffer.budgetBytes());
+        }
+        const int depth = buffer.depth();
+        QVERIFY(depth > 1);
+        QVERIFY(depth < 200);
+        QCOMPARE(buffer.frameAt(depth - 1), quint64(200 - depth));
+
+        // The oldest surviving state is still reconstructed exactly
+        const unsigned char* restored = buffer.rewind(depth - 1, nullptr, nullptr);
+        QVERIFY(std::memcmp(restored, history[200 - depth].data(), kStateSize) == 0);
+    }
+
+    void testDeltasAreCompact()
+    {
+        RewindBuffer buffer(kStateSize, 64 << 20);
+        std::vector<unsigned char> state(kStateSize, 0x10);
+        for (quint32 frame = 0; frame < 100; ++frame) {
+            state = mutate(state, frame + 1000);
+            buffer.push(state.data(), kStateSize, frame);
+        }
+        // 64 changed bytes per snapshot -> a few hundred bytes per delta, not 70 KB
+        QVERIFY(buffer.usedBytes() < 99 * 1024);
+    }
+};
+
+QTEST_MAIN(TestRewindBuffer)
+#include "test_rewind_buffer.moc"
@@ -0,0 +1,188 @@
+/*
+ * Fujisan Test Suite - ROM Image Cache Tests
+ *
+ * Verifies RomImageCache: images resolved to a copy named by their SHA-1,
+ * read once until the source changes, identical images deduplicated, a store
+ * written by one instance reused by another without writing, a known hash
+ * from the media index skipping the read, and sources passed through when
+ * the cache is off, missing or too large.
+ */
+
+#include "romimagecache.h"
+
+#include <QCryptographicHash>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+namespace {
+bool writeFile(const QString& path, const QByteArray& bytes)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(bytes) == bytes.size();
+}
+
+QByteArray readFile(const QString& path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+QByteArray romImage(char fill, int size = 16384)
+{
+    QByteArray bytes(size, fill);
+    bytes[0] = 'R';
+    return bytes;
+}
+}  // namespace
+
+class TestRomImageCache : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+
+    QString path(const QString& name) const { return m_dir.filePath(name); }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+    }
+
+    void testDisabledPassesThrough()
+    {
+        RomImageCache cache;
+        QVERIFY(!cache.isEnabled());
+        QVERIFY(writeFile(path("os.rom"), romImage('a')));
+        QCOMPARE(cache.resolve(path("os.rom")), path("os.rom"));
+        QCOMPARE(cache.reads(), 0);
+    }
+
+    void testResolveToContentAddressedCopy()
+    {
+        const QByteArray image = romImage('b');
+        QVERIFY(writeFile(path("basic.rom"), image));
+
+        RomImageCache cache;
+        cache.setDirectory(path("store1"));
+        QVERIFY(cache.isEnabled());
+        const QString copy = cache.resolve(path("basic.rom"));
+        const QString hash = QString::fromLatin1(QCryptographicHash::hash(image, QCryptographicHash::Sha1).toHex());
+        QCOMPARE(QFileInfo(copy).fileName(), hash + ".rom");
+        QCOMPARE(readFile(copy), image);
+        QCOMPARE(cache.reads(), 1);
+        QCOMPARE(cache.imports(), 1);
+
+        // Cold boots after the first only stat the source
+        QCOMPARE(cache.resolve(path("basic.rom")), copy);
+        QCOMPARE(cache.resolve(path("basic.rom")), copy);
+        QCOMPARE(cache.hits(), 2);
+        QCOMPARE(cache.reads(), 1);
+    }
+
+    void testIdenticalImagesShareOneCopy()
+    {
+        QVERIFY(writeFile(path("first.car"), romImage('c')));
+        QVERIFY(writeFile(path("second.car"), romImage('c')));
+
+        RomImageCache cache;
+        cache.setDirectory(path("store2"));
+        const QString first = cache.resolve(path("first.car"));
+        QCOMPARE(cache.resolve(path("second.car")), first);
+        QCOMPARE(cache.imports(), 1);
+        QCOMPARE(QDir(path("store2")).entryList(QDir::Files).size(), 1);
+    }
+
+    void testChangedSourceIsReadAgain()
+    {
+        QVERIFY(writeFile(path("changing.rom"), romImage('d')));
+        RomImageCache cache;
+        cache.setDirectory(path("store3"));
+        const QString before = cache.resolve(path("changing.rom"));
+
+        const QByteArray changed = romImage('e', 8192);
+        QVERIFY(writeFile(path("changing.rom"), changed));
+        const QString after = cache.resolve(path("changing.rom"));
+        QVERIFY(after != before);
+        QCOMPARE(readFile(after), changed);
+        QCOMPARE(cache.reads(), 2);
+    }
+
+    void testStoreSharedBetweenInstances()
+    {
+        QVERIFY(writeFile(path("shared.rom"), romImage('f')));
+        QString copy;
+        {
+            RomImageCache first;
+            first.setDirectory(path("store4"));
+            copy = first.resolve(path("shared.rom"));
+            QCOMPARE(first.imports(), 1);
+        }
+
+        // Another worker, or the next run: reads the source to hash it, writes nothing
+        RomImageCache second;
+        second.setDirectory(path("store4"));
+        QCOMPARE(second.resolve(path("shared.rom")), copy);
+        QCOMPARE(second.reads(), 1);
+        QCOMPARE(second.imports(), 0);
+    }
+
+    void testKnownHashSkipsTheRead()
+    {
+        const QByteArray image = romImage('h');
+        QVERIFY(writeFile(path("known.car"), image));
+        const QFileInfo info(path("known.car"));
+        const QByteArray hash = QCryptographicHash::hash(image, QCryptographicHash::Sha1).toHex();
+        QString copy;
+        {
+            RomImageCache first;
+            first.setDirectory(path("store7"));
+            copy = first.resolve(path("known.car"));
+        }
+
+        // A media index that already hashed the file lets the next run skip reading it
+        RomImageCache second;
+        second.setDirectory(path("store7"));
+        QVERIFY(second.addKnownImage(path("known.car"), info.size(), info.lastModified(), hash));
+        QCOMPARE(second.resolve(path("known.car")), copy);
+        QCOMPARE(second.reads(), 0);
+        QCOMPARE(second.hits(), 1);
+
+        // Without the copy in the store the hash alone is not trusted
+        RomImageCache third;
+        third.setDirectory(path("store8"));
+        QVERIFY(!third.addKnownImage(path("known.car"), info.size(), info.lastModified(), hash));
+        QCOMPARE(third.resolve(path("known.car")), QDir(path("store8")).filePath(QString::fromLatin1(hash) + ".rom"));
+        QCOMPARE(third.reads(), 1);
+    }
+
+    void testUnusableSourcesPassThrough()
+    {
+        RomImageCache cache;
+        cache.setDirectory(path("store5"));
+        QCOMPARE(cache.resolve(QString()), QString());
+        QCOMPARE(cache.resolve(path("missing.rom")), path("missing.rom"));
+
+        QVERIFY(writeFile(path("huge.car"), QByteArray(int(RomImageCache::kMaxImageBytes) + 1, 'x')));
+        QCOMPARE(cache.resolve(path("huge.car")), path("huge.car"));
+        QCOMPARE(cache.reads(), 0);
+    }
+
+    void testDeletedCopyIsRestored()
+    {
+#ifdef Q_OS_WIN
+        QSKIP("A mapped file cannot be deleted on Windows");
+#endif
+        QVERIFY(writeFile(path("restored.rom"), romImage('g')));
+        RomImageCache cache;
+        cache.setDirectory(path("store6"));
+        const QString copy = cache.resolve(path("restored.rom"));
+        QVERIFY(QFile::remove(copy));
+        QCOMPARE(cache.resolve(path("restored.rom")), copy);
+        QVERIFY(QFileInfo::exists(copy));
+        QCOMPARE(cache.imports(), 2);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestRomImageCache)
+#include "test_rom_image_cache.moc"
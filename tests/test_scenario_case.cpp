@@ -0,0 +1,149 @@
+/*
+ * Fujisan Test Suite - Scenario Case Tests
+ *
+ * Verifies ScenarioCase: scripts of system.schedule and batch requests turned
+ * into frame-synchronous actions with the same checks system.schedule makes,
+ * expectations on screen text, memory ranges, the 64 KB checksum and the PC,
+ * and one failure message per unmet expectation.
+ */
+
+#include "scenariocase.h"
+
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QtTest/QtTest>
+
+class TestScenarioCase : public QObject {
+    Q_OBJECT
+
+private:
+    static QJsonObject job(const char* json)
+    {
+        return QJsonDocument::fromJson(QByteArray(json)).object();
+    }
+
+private slots:
+    void testScriptOfRequestsAndBatches()
+    {
+        ScenarioCase scenario;
+        QString error;
+        QVERIFY2(scenario.parse(job(R"({"script": [
+            {"command": "system.schedule", "params": {"in_frames": 100, "action": "console",
+                                                      "params": {"start": true}}},
+            {"command": "batch", "params": {"commands": [
+                {"command": "system.schedule", "params": {"frame": 300, "action": "joystick",
+                                                          "params": {"player": 1, "value": 11}}},
+                {"command": "system.schedule", "params": {"frame": 300, "action": "save_state",
+                                                          "params": {"filename": "out/level"}}}]}}]})"),
+                                &error), qPrintable(error));
+        QCOMPARE(scenario.actions.size(), 3);
+        QVERIFY(scenario.actions[0].relative);
+        QCOMPARE(scenario.actions[0].frame, quint64(100));
+        QCOMPARE(scenario.actions[1].type, QString("joystick"));
+        QVERIFY(!scenario.actions[1].relative);
+        QCOMPARE(scenario.actions[2].params["filename"].toString(), QString("out/level.a8s"));
+        QVERIFY(!scenario.hasExpectations());
+    }
+
+    void testInvalidScripts()
+    {
+        ScenarioCase scenario;
+        QString error;
+        QVERIFY(!scenario.parse(job(R"({"script": [{"command": "input.send_text", "params": {"text": "RUN"}}]})"),
+                                &error));
+        QVERIFY(error.startsWith("script[0]: input.send_text is not supported"));
+
+        QVERIFY(!scenario.parse(job(R"({"script": [{"command": "batch", "params": {"commands": [
+            {"command": "system.schedule", "params": {"in_frames": 1, "action": "joystick",
+                                                      "params": {"player": 3}}}]}}]})"), &error));
+        QCOMPARE(error, QString("script[0]: commands[0]: joystick needs player 1-2 and value 0-15"));
+
+        QVERIFY(!scenario.parse(job(R"({"script": [{"command": "system.schedule",
+                                                     "params": {"action": "pause"}}]})"), &error));
+        QCOMPARE(error, QString("script[0]: frame or in_frames parameter is required"));
+
+        QVERIFY(!scenario.parse(job(R"({"script": [{"command": "batch", "params": {"commands": [
+            {"command": "batch", "params": {"commands": []}}]}}]})"), &error));
+        QCOMPARE(error, QString("script[0]: commands[0]: Batches cannot be nested"));
+        QVERIFY(scenario.actions.isEmpty());
+    }
+
+    void testValidateAction()
+    {
+        QString error;
+        QVERIFY(ScenarioCase::validateAction("capture", QJsonObject(), &error));
+        QVERIFY(!ScenarioCase::validateAction("reset", QJsonObject(), &error));
+        QVERIFY(error.startsWith("action must be one of: joystick"));
+        QJsonObject write{{"address", 0xFFFF}, {"data", QJsonArray{1, 2}}};
+        QVERIFY(!ScenarioCase::validateAction("write_memory", write, &error));
+        write["address"] = 0x600;
+        QVERIFY(ScenarioCase::validateAction("write_memory", write, &error));
+        QVERIFY(!ScenarioCase::validateAction("char", QJsonObject{{"char", "AB"}}, &error));
+
+        int address = -1;
+        QVERIFY(ScenarioCase::parseAddress("$D01A", &address));
+        QCOMPARE(address, 0xD01A);
+        QVERIFY(ScenarioCase::parseAddress("0x600", &address));
+        QCOMPARE(address, 0x600);
+        QVERIFY(ScenarioCase::parseAddress(1536, &address));
+        QCOMPARE(address, 1536);
+        QVERIFY(!ScenarioCase::parseAddress("$10000", &address));
+        QVERIFY(!ScenarioCase::parseAddress("READY", &address));
+    }
+
+    void testVerifyExpectations()
+    {
+        QByteArray memory(0x10000, '\0');
+        memory[0x600] = char(0xA9);
+        memory[0x601] = char(0x42);
+        const QString rangeSha1 = QString::fromLatin1(
+            QCryptographicHash::hash(memory.mid(0x600, 16), QCryptographicHash::Sha1).toHex());
+        const QString memorySha1 = QString::fromLatin1(
+            QCryptographicHash::hash(memory, QCryptographicHash::Sha1).toHex());
+
+        QJsonObject expect{{"screen_text", QJsonArray{"READY", "BASIC"}},
+                           {"memory", QJsonArray{QJsonObject{{"address", "$0600"}, {"length", 16},
+                                                             {"sha1", rangeSha1.toUpper()}},
+                                                 QJsonObject{{"address", 0x601}, {"bytes", QJsonArray{0x42}}}}},
+                           {"memory_sha1", memorySha1},
+                           {"pc", "$E459"},
+                           {"check_every", 10}};
+        ScenarioCase scenario;
+        QString error;
+        QVERIFY2(scenario.parse(QJsonObject{{"expect", expect}}, &error), qPrintable(error));
+        QVERIFY(scenario.hasExpectations());
+        QCOMPARE(scenario.checkEvery, 10);
+
+        const QStringList screen = {"ATARI BASIC", "", "READY"};
+        QJsonObject result = scenario.verify(screen, memory, 0xE459);
+        QVERIFY(result["ok"].toBool());
+        QVERIFY(result["failures"].toArray().isEmpty());
+
+        // Every unmet expectation is reported, each once
+        QByteArray changed = memory;
+        changed[0x601] = char(0x43);
+        result = scenario.verify({"BOOT ERROR"}, changed, 0x2000);
+        QVERIFY(!result["ok"].toBool());
+        const QJsonArray failures = result["failures"].toArray();
+        QCOMPARE(failures.size(), 6);
+        QCOMPARE(failures[0].toString(), QString("screen text \"READY\" not found"));
+        QCOMPARE(failures[3].toString(), QString("memory $0601 holds 43"));
+        QCOMPARE(failures[5].toString(), QString("pc is $2000"));
+    }
+
+    void testInvalidExpectations()
+    {
+        ScenarioCase scenario;
+        QString error;
+        QVERIFY(!scenario.parse(job(R"({"expect": {"memory": [{"address": "$FFF0", "length": 32,
+                                        "sha1": "0000000000000000000000000000000000000000"}]}})"), &error));
+        QCOMPARE(error, QString("expect.memory[0]: range must be non-empty and inside memory"));
+        QVERIFY(!scenario.parse(job(R"({"expect": {"memory": [{"address": "$0600", "length": 4}]}})"), &error));
+        QVERIFY(!scenario.parse(job(R"({"expect": {"pc": "start"}})"), &error));
+        QVERIFY(scenario.parse(job(R"({"expect": {"screen_text": "READY"}})"), &error));
+        QCOMPARE(scenario.screenText, QStringList({"READY"}));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestScenarioCase)
+#include "test_scenario_case.moc"
@@ -0,0 +1,259 @@
+/*
+ * Fujisan Test Suite - Screen Stream Encoder Tests
+ *
+ * Decodes the binary packets of screen.stream_start the way a client would and
+ * checks that full, row and delta encodings all reproduce the frames exactly,
+ * that the palette is only resent when it changes, and that deltas fall back to
+ * a full frame when they would not be smaller. Audio packets carry their format
+ * in the header and the first sample's index ahead of the PCM.
+ */
+
+#include "screenstreamencoder.h"
+
+#include <QRandomGenerator>
+#include <QtEndian>
+#include <QtTest/QtTest>
+#include <cstring>
+
+class TestScreenStreamEncoder : public QObject {
+    Q_OBJECT
+
+private:
+    static constexpr int kWidth = 384;
+    static constexpr int kHeight = 240;
+
+    struct Packet {
+        int type = 0;
+        int width = 0;
+        int height = 0;
+        int reserved = 0;
+        quint64 frame = 0;
+        QByteArray payload;
+    };
+
+    static QVector<Packet> split(const QByteArray& stream)
+    {
+        QVector<Packet> packets;
+        const uchar* data = reinterpret_cast<const uchar*>(stream.constData());
+        int pos = 0;
+        while (pos + ScreenStreamEncoder::kHeaderSize <= stream.size()) {
+            if (data[pos] != ScreenStreamEncoder::kMagic) {
+                break;
+            }
+            Packet packet;
+            packet.type = data[pos + 1];
+            packet.width = qFromLittleEndian<quint16>(data + pos + 2);
+            packet.height = qFromLittleEndian<quint16>(data + pos + 4);
+            packet.reserved = qFromLittleEndian<quint16>(data + pos + 6);
+            packet.frame = qFromLittleEndian<quint64>(data + pos + 8);
+            const int size = static_cast<int>(qFromLittleEndian<quint32>(data + pos + 16));
+            pos += ScreenStreamEncoder::kHeaderSize;
+            packet.payload = stream.mid(pos, size);
+            pos += size;
+            packets.append(packet);
+        }
+        return packets;
+    }
+
+    static quint32 readVarint(const QByteArray& payload, int& pos)
+    {
+        quint32 value = 0;
+        int shift = 0;
+        while (pos < payload.size()) {
+            const uchar byte = static_cast<uchar>(payload.at(pos++));
+            value |= static_cast<quint32>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                break;
+            }
+            shift += 7;
+        }
+        return value;
+    }
+
+    // Client-side decoder: applies one frame packet onto screen
+    static void apply(const Packet& packet, QByteArray& screen)
+    {
+        screen.resize(packet.width * packet.height);
+        if (packet.type == ScreenStreamEncoder::PacketFull) {
+            screen = packet.payload;
+        } else if (packet.type == ScreenStreamEncoder::PacketRows) {
+            const uchar* in = reinterpret_cast<const uchar*>(packet.payload.constData());
+            const int rows = qFromLittleEndian<quint16>(in);
+            int pos = 2;
+            for (int r = 0; r < rows; ++r) {
+                const int y = qFromLittleEndian<quint16>(in + pos);
+                std::memcpy(screen.data() + y * packet.width, in + pos + 2, static_cast<size_t>(packet.width));
+                pos += 2 + packet.width;
+            }
+        } else if (packet.type == ScreenStreamEncoder::PacketDelta) {
+            int pos = 0;
+            int target = 0;
+            while (pos < packet.payload.size()) {
+                target += static_cast<int>(readVarint(packet.payload, pos));
+                const int count = static_cast<int>(readVarint(packet.payload, pos));
+                std::memcpy(screen.data() + target, packet.payload.constData() + pos, static_cast<size_t>(count));
+                pos += count;
+                target += count;
+            }
+        }
+    }
+
+    static QVector<QRgb> grayPalette(int offset)
+    {
+        QVector<QRgb> palette(256);
+        for (int i = 0; i < 256; ++i) {
+            palette[i] = qRgb((i + offset) & 0xFF, i, i);
+        }
+        return palette;
+    }
+
+    // A frame that changes a small block per step, like a moving sprite
+    static QByteArray frameAt(int step)
+    {
+        QByteArray frame(kWidth * kHeight, 0x04);
+        for (int y = 0; y < 8; ++y) {
+            std::memset(frame.data() + (20 + y + step) * kWidth + 10 + step * 3, 0x1E, 8);
+        }
+        return frame;
+    }
+
+    void roundTrip(ScreenStreamEncoder::Encoding encoding, int expectedType)
+    {
+        ScreenStreamEncoder encoder(encoding);
+        const QVector<QRgb> palette = grayPalette(0);
+        QByteArray screen;
+        for (int step = 0; step < 30; ++step) {
+            const QByteArray frame = frameAt(step);
+            QByteArray stream;
+            encoder.encode(reinterpret_cast<const uchar*>(frame.constData()), kWidth, kHeight, kWidth,
+                           palette, quint64(step), stream);
+            const QVector<Packet> packets = split(stream);
+            QCOMPARE(packets.size(), step == 0 ? 2 : 1);
+            const Packet& packet = packets.last();
+            QCOMPARE(packet.type, step == 0 ? int(ScreenStreamEncoder::PacketFull) : expectedType);
+            QCOMPARE(packet.frame, quint64(step));
+            apply(packet, screen);
+            QCOMPARE(screen, frame);
+        }
+    }
+
+private slots:
+    void testFirstFrameSendsPaletteAndFullFrame()
+    {
+        ScreenStreamEncoder encoder(ScreenStreamEncoder::EncodingDelta);
+        const QByteArray frame = frameAt(0);
+        QByteArray stream;
+        encoder.encode(reinterpret_cast<const uchar*>(frame.constData()), kWidth, kHeight, kWidth,
+                       grayPalette(0), 7, stream);
+        const QVector<Packet> packets = split(stream);
+        QCOMPARE(packets.size(), 2);
+        QCOMPARE(packets[0].type, int(ScreenStreamEncoder::PacketPalette));
+        QCOMPARE(packets[0].payload.size(), 768);
+        QCOMPARE(static_cast<uchar>(packets[0].payload.at(3 * 5)), uchar(5));  // red of entry 5
+        QCOMPARE(packets[1].type, int(ScreenStreamEncoder::PacketFull));
+        QCOMPARE(packets[1].width, kWidth);
+        QCOMPARE(packets[1].height, kHeight);
+        QCOMPARE(packets[1].payload, frame);
+    }
+
+    void testFullRoundTrip() { roundTrip(ScreenStreamEncoder::EncodingFull, ScreenStreamEncoder::PacketFull); }
+    void testRowsRoundTrip() { roundTrip(ScreenStreamEncoder::EncodingRows, ScreenStreamEncoder::PacketRows); }
+    void testDeltaRoundTrip() { roundTrip(ScreenStreamEncoder::EncodingDelta, ScreenStreamEncoder::PacketDelta); }
+
+    void testPaletteResentOnlyOnChange()
+    {
+        ScreenStreamEncoder encoder(ScreenStreamEncoder::EncodingRows);
+        const QByteArray frame = frameAt(0);
+        const uchar* pixels = reinterpret_cast<const uchar*>(frame.constData());
+        QByteArray stream;
+        encoder.encode(pixels, kWidth, kHeight, kWidth, grayPalette(0), 0, stream);
+        stream.clear();
+        encoder.encode(pixels, kWidth, kHeight, kWidth, grayPalette(0), 1, stream);
+        QCOMPARE(split(stream).size(), 1);
+        stream.clear();
+        encoder.encode(pixels, kWidth, kHeight, kWidth, grayPalette(9), 2, stream);
+        const QVector<Packet> packets = split(stream);
+        QCOMPARE(packets.size(), 2);
+        QCOMPARE(packets[0].type, int(ScreenStreamEncoder::PacketPalette));
+        // Unchanged frame: a rows packet with no rows
+        QCOMPARE(packets[1].type, int(ScreenStreamEncoder::PacketRows));
+        QCOMPARE(packets[1].payload.size(), 2);
+    }
+
+    void testNoisyDeltaFallsBackToFullFrame()
+    {
+        ScreenStreamEncoder encoder(ScreenStreamEncoder::EncodingDelta);
+        const QVector<QRgb> palette = grayPalette(0);
+        QRandomGenerator rng(42);
+        QByteArray screen;
+        for (int step = 0; step < 3; ++step) {
+            QByteArray frame(kWidth * kHeight, 0);
+            for (char& c : frame) {
+                c = static_cast<char>(rng.generate());
+            }
+            QByteArray stream;
+            encoder.encode(reinterpret_cast<const uchar*>(frame.constData()), kWidth, kHeight, kWidth,
+                           palette, quint64(step), stream);
+            const Packet packet = split(stream).last();
+            QCOMPARE(packet.type, int(ScreenStreamEncoder::PacketFull));
+            apply(packet, screen);
+            QCOMPARE(screen, frame);
+        }
+    }
+
+    void testStrideIsHonoured()
+    {
+        const int stride = kWidth + 12;
+        QByteArray padded(stride * kHeight, char(0x7F));
+        const QByteArray frame = frameAt(3);
+        for (int y = 0; y < kHeight; ++y) {
+            std::memcpy(padded.data() + y * stride, frame.constData() + y * kWidth, kWidth);
+        }
+        ScreenStreamEncoder encoder(ScreenStreamEncoder::EncodingFull);
+        QByteArray stream;
+        encoder.encode(reinterpret_cast<const uchar*>(padded.constData()), kWidth, kHeight, stride,
+                       grayPalette(0), 0, stream);
+        QCOMPARE(split(stream).last().payload, frame);
+    }
+
+    void testAudioPacketCarriesFormatAndFirstSample()
+    {
+        QByteArray pcm(1470, 0);
+        for (int i = 0; i < pcm.size(); ++i) {
+            pcm[i] = static_cast<char>(i * 7);
+        }
+        QByteArray stream;
+        ScreenStreamEncoder::appendAudio(stream, 44100, 1, 16, 120, 88200, pcm);
+        const QVector<Packet> packets = split(stream);
+        QCOMPARE(packets.size(), 1);
+        const Packet& packet = packets.first();
+        QCOMPARE(packet.type, int(ScreenStreamEncoder::PacketAudio));
+        QCOMPARE(packet.width, 44100);
+        QCOMPARE(packet.height, 1);
+        QCOMPARE(packet.reserved, 16);
+        QCOMPARE(packet.frame, quint64(120));
+        QCOMPARE(qFromLittleEndian<quint64>(reinterpret_cast<const uchar*>(packet.payload.constData())),
+                 quint64(88200));
+        QCOMPARE(packet.payload.mid(8), pcm);
+
+        // Frame packets keep a zero reserved field
+        ScreenStreamEncoder encoder(ScreenStreamEncoder::EncodingFull);
+        const QByteArray frame = frameAt(0);
+        stream.clear();
+        encoder.encode(reinterpret_cast<const uchar*>(frame.constData()), kWidth, kHeight, kWidth,
+                       grayPalette(0), 0, stream);
+        QCOMPARE(split(stream).last().reserved, 0);
+    }
+
+    void testParseEncoding()
+    {
+        ScreenStreamEncoder::Encoding encoding = ScreenStreamEncoder::EncodingFull;
+        QVERIFY(ScreenStreamEncoder::parseEncoding("delta", &encoding));
+        QCOMPARE(encoding, ScreenStreamEncoder::EncodingDelta);
+        QVERIFY(!ScreenStreamEncoder::parseEncoding("png", &encoding));
+        QCOMPARE(ScreenStreamEncoder::encodingName(ScreenStreamEncoder::EncodingRows), QString("rows"));
+    }
+};
+
+QTEST_MAIN(TestScreenStreamEncoder)
+#include "test_screen_stream_encoder.moc"
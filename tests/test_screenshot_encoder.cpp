@@ -0,0 +1,184 @@
+/*
+ * Fujisan Test Suite - Screenshot Encoder Tests
+ *
+ * Verifies ScreenshotEncoder: indexed PNG and QOI output decoding back to the
+ * frame's colours, asynchronous submits reported per ticket and written to
+ * disk, and failures for frames that are not indexed or paths that cannot be
+ * written.
+ */
+
+#include "screenshotencoder.h"
+
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+namespace {
+QImage testFrame()
+{
+    QImage frame(384, 240, QImage::Format_Indexed8);
+    QVector<QRgb> palette(256);
+    for (int i = 0; i < 256; ++i) {
+        palette[i] = qRgb(i, (i * 7) & 0xFF, 255 - i);
+    }
+    frame.setColorTable(palette);
+    for (int y = 0; y < frame.height(); ++y) {
+        uchar* line = frame.scanLine(y);
+        for (int x = 0; x < frame.width(); ++x) {
+            // Runs, repeats and jumps, so every QOI operation is used
+            line[x] = x < 100 ? 0x94 : static_cast<uchar>((x / 3 + y) & 0xFF);
+        }
+    }
+    return frame;
+}
+
+// Minimal QOI decoder (RGB, as written by the encoder)
+QImage decodeQoi(const QByteArray& data)
+{
+    if (data.size() < 22 || !data.startsWith("qoif")) {
+        return QImage();
+    }
+    const uchar* p = reinterpret_cast<const uchar*>(data.constData());
+    const int width = (p[4] << 24) | (p[5] << 16) | (p[6] << 8) | p[7];
+    const int height = (p[8] << 24) | (p[9] << 16) | (p[10] << 8) | p[11];
+    QImage image(width, height, QImage::Format_RGB32);
+    QRgb seen[64] = {};
+    int r = 0, g = 0, b = 0, a = 255;
+    int pos = 14;
+    int run = 0;
+    const int end = data.size() - 8;
+    for (int i = 0; i < width * height; ++i) {
+        if (run > 0) {
+            run--;
+        } else if (pos < end) {
+            const int op = p[pos++];
+            if (op == 0xFE) {
+                r = p[pos++]; g = p[pos++]; b = p[pos++];
+            } else if (op == 0xFF) {
+                r = p[pos++]; g = p[pos++]; b = p[pos++]; a = p[pos++];
+            } else if ((op & 0xC0) == 0x00) {
+                const QRgb c = seen[op];
+                r = qRed(c); g = qGreen(c); b = qBlue(c); a = qAlpha(c);
+            } else if ((op & 0xC0) == 0x40) {
+                r = (r + ((op >> 4) & 3) - 2) & 0xFF;
+                g = (g + ((op >> 2) & 3) - 2) & 0xFF;
+                b = (b + (op & 3) - 2) & 0xFF;
+            } else if ((op & 0xC0) == 0x80) {
+                const int second = p[pos++];
+                const int dg = (op & 0x3F) - 32;
+                r = (r + dg - 8 + ((second >> 4) & 0x0F)) & 0xFF;
+                g = (g + dg) & 0xFF;
+                b = (b + dg - 8 + (second & 0x0F)) & 0xFF;
+            } else {
+                run = op & 0x3F;
+            }
+            seen[(r * 3 + g * 5 + b * 7 + a * 11) % 64] = qRgba(r, g, b, a);
+        }
+        image.setPixel(i % width, i / width, qRgb(r, g, b));
+    }
+    return image;
+}
+
+void compareColours(const QImage& decoded, const QImage& frame)
+{
+    QCOMPARE(decoded.size(), frame.size());
+    for (int y = 0; y < frame.height(); ++y) {
+        for (int x = 0; x < frame.width(); ++x) {
+            if (decoded.pixel(x, y) != frame.pixel(x, y)) {
+                QFAIL(qPrintable(QString("Pixel %1,%2 differs").arg(x).arg(y)));
+            }
+        }
+    }
+}
+}  // namespace
+
+class TestScreenshotEncoder : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+    }
+
+    void testPngIsLossless()
+    {
+        const QImage frame = testFrame();
+        const QByteArray png = ScreenshotEncoder::encode(frame, ScreenshotEncoder::FormatPng);
+        QVERIFY(png.startsWith("\x89PNG"));
+        const QImage decoded = QImage::fromData(png, "PNG");
+        QCOMPARE(decoded.format(), QImage::Format_Indexed8);
+        compareColours(decoded.convertToFormat(QImage::Format_RGB32), frame);
+    }
+
+    void testQoiIsLossless()
+    {
+        const QImage frame = testFrame();
+        const QByteArray qoi = ScreenshotEncoder::encode(frame, ScreenshotEncoder::FormatQoi);
+        QVERIFY(qoi.endsWith(QByteArray("\0\0\0\0\0\0\0\1", 8)));
+        compareColours(decodeQoi(qoi), frame);
+        QVERIFY(qoi.size() < frame.width() * frame.height());  // runs and the index pay off
+    }
+
+    void testAsyncSubmitWritesFile()
+    {
+        ScreenshotEncoder encoder;
+        QSignalSpy spy(&encoder, &ScreenshotEncoder::finished);
+        const QString path = m_dir.filePath("shots/frame.qoi");
+        const quint64 fileTicket = encoder.submit(testFrame(), ScreenshotEncoder::FormatQoi, path);
+        const quint64 inlineTicket = encoder.submit(testFrame(), ScreenshotEncoder::FormatPng);
+        QVERIFY(fileTicket != inlineTicket);
+        encoder.waitForDone();
+        QCOMPARE(spy.count(), 2);
+
+        for (const QList<QVariant>& arguments : spy) {
+            QVERIFY(arguments.at(3).toString().isEmpty());
+            const QByteArray data = arguments.at(1).toByteArray();
+            if (arguments.at(0).toULongLong() == fileTicket) {
+                QCOMPARE(arguments.at(2).toString(), path);
+                QFile file(path);
+                QVERIFY(file.open(QIODevice::ReadOnly));
+                QCOMPARE(file.readAll(), data);
+            } else {
+                QVERIFY(arguments.at(2).toString().isEmpty());
+                QVERIFY(data.startsWith("\x89PNG"));
+            }
+        }
+    }
+
+    void testFailures()
+    {
+        QString error;
+        QVERIFY(ScreenshotEncoder::encode(QImage(), ScreenshotEncoder::FormatPng, &error).isEmpty());
+        QVERIFY(!error.isEmpty());
+        error.clear();
+        QVERIFY(ScreenshotEncoder::encode(QImage(8, 8, QImage::Format_RGB32),
+                                          ScreenshotEncoder::FormatQoi, &error).isEmpty());
+        QVERIFY(!error.isEmpty());
+
+        // A directory where the file should go cannot be replaced
+        QVERIFY(QDir().mkpath(m_dir.filePath("taken.png")));
+        ScreenshotEncoder encoder;
+        QSignalSpy spy(&encoder, &ScreenshotEncoder::finished);
+        encoder.submit(testFrame(), ScreenshotEncoder::FormatPng, m_dir.filePath("taken.png"));
+        encoder.waitForDone();
+        QCOMPARE(spy.count(), 1);
+        QVERIFY(spy.first().at(1).toByteArray().isEmpty());
+        QVERIFY(!spy.first().at(3).toString().isEmpty());
+    }
+
+    void testFormatNames()
+    {
+        ScreenshotEncoder::Format format = ScreenshotEncoder::FormatPng;
+        QVERIFY(ScreenshotEncoder::parseFormat("QOI", &format));
+        QCOMPARE(format, ScreenshotEncoder::FormatQoi);
+        QCOMPARE(ScreenshotEncoder::formatName(format), QString("qoi"));
+        QVERIFY(!ScreenshotEncoder::parseFormat("bmp", &format));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestScreenshotEncoder)
+#include "test_screenshot_encoder.moc"
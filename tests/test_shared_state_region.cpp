@@ -0,0 +1,121 @@
+/*
+ * Fujisan Test Suite - Shared State Region Tests
+ *
+ * Verifies the memory-mapped state published for local harnesses: the header
+ * and range table a reader sees, RAM ranges and registers after a publish,
+ * the seqlock sequence staying even between frames, range validation, and
+ * the file going away on close.
+ */
+
+#include "sharedstateregion.h"
+
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <QtTest/QtTest>
+
+class TestSharedStateRegion : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+
+    // What an external reader does: map the file on its own
+    static QByteArray readFile(const QString& path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return QByteArray();
+        }
+        return file.readAll();
+    }
+
+    static quint32 u32(const QByteArray& data, int offset)
+    {
+        return qFromLittleEndian<quint32>(data.constData() + offset);
+    }
+
+private slots:
+    void testHeaderAndRangeTable()
+    {
+        SharedStateRegion region;
+        QString error;
+        const QString path = m_dir.filePath("state-header");
+        QVERIFY2(region.open(path, {{0x0080, 16}, {0x0600, 256}}, &error), qPrintable(error));
+
+        const QByteArray data = readFile(path);
+        QCOMPARE(u32(data, 0), SharedStateRegion::kMagic);
+        QCOMPARE(qFromLittleEndian<quint16>(data.constData() + 4), SharedStateRegion::kVersion);
+        QCOMPARE(static_cast<int>(u32(data, 12)), data.size());
+        QCOMPARE(u32(data, 48), 2u);
+
+        const QJsonObject layout = region.layout();
+        QCOMPARE(layout.value("path").toString(), path);
+        const QJsonArray ranges = layout.value("ranges").toArray();
+        QCOMPARE(ranges.size(), 2);
+        const int entry = static_cast<int>(u32(data, 52)) + 16;
+        QCOMPARE(u32(data, entry), 0x0600u);
+        QCOMPARE(u32(data, entry + 4), 256u);
+        QCOMPARE(static_cast<int>(u32(data, entry + 8)), ranges.at(1).toObject().value("offset").toInt());
+    }
+
+    void testPublishWritesStateWithEvenSequence()
+    {
+        SharedStateRegion region;
+        QString error;
+        const QString path = m_dir.filePath("state-publish");
+        QVERIFY(region.open(path, {{0x0600, 4}}, &error));
+
+        QByteArray memory(0x10000, '\0');
+        memory[0x0600] = 0x11;
+        memory[0x0603] = 0x44;
+        QByteArray screen(SharedStateRegion::kScreenWidth * SharedStateRegion::kScreenHeight, '\x0e');
+        SharedStateRegion::Registers registers;
+        registers.pc = 0xE477;
+        registers.a = 0x42;
+        QVector<QRgb> palette(256, qRgb(1, 2, 3));
+
+        region.publish(99, registers, reinterpret_cast<const unsigned char*>(screen.constData()), palette,
+                       reinterpret_cast<const unsigned char*>(memory.constData()));
+        region.publish(100, registers, reinterpret_cast<const unsigned char*>(screen.constData()), palette,
+                       reinterpret_cast<const unsigned char*>(memory.constData()));
+
+        const QByteArray data = readFile(path);
+        QCOMPARE(u32(data, 8), 4u);  // two frames, even again after each
+        QCOMPARE(qFromLittleEndian<quint64>(data.constData() + 16), quint64(100));
+        QCOMPARE(qFromLittleEndian<quint16>(data.constData() + 24), quint16(0xE477));
+        QCOMPARE(static_cast<quint8>(data.at(26)), quint8(0x42));
+        QCOMPARE(qFromLittleEndian<quint64>(data.constData() + 56), quint64(2));
+
+        const QJsonObject layout = region.layout();
+        const int ram = layout.value("ranges").toArray().first().toObject().value("offset").toInt();
+        QCOMPARE(data.mid(ram, 4), memory.mid(0x0600, 4));
+        QCOMPARE(data.at(layout.value("screen_offset").toInt() + 1000), '\x0e');
+        const int rgb = layout.value("palette_offset").toInt();
+        QCOMPARE(data.mid(rgb, 3), QByteArray("\x01\x02\x03", 3));
+    }
+
+    void testRejectsRangesOutsideMemory()
+    {
+        SharedStateRegion region;
+        QString error;
+        QVERIFY(!region.open(m_dir.filePath("state-bad"), {{0xFFF0, 32}}, &error));
+        QVERIFY(!error.isEmpty());
+        QVERIFY(!region.isOpen());
+        QVERIFY(!QFile::exists(m_dir.filePath("state-bad")) || readFile(m_dir.filePath("state-bad")).isEmpty());
+    }
+
+    void testCloseRemovesFile()
+    {
+        SharedStateRegion region;
+        QString error;
+        const QString path = m_dir.filePath("state-close");
+        QVERIFY(region.open(path, {}, &error));
+        QVERIFY(QFile::exists(path));
+        region.close();
+        QVERIFY(!QFile::exists(path));
+        QVERIFY(region.layout().isEmpty());
+    }
+};
+
+QTEST_MAIN(TestSharedStateRegion)
+#include "test_shared_state_region.moc"
@@ -0,0 +1,122 @@
+/*
+ * Fujisan Test Suite - SSE Stream Parser Tests
+ *
+ * Verifies the text/event-stream parser behind FujiNetService's event
+ * channel: events split across arbitrary chunks, LF/CRLF/CR line endings
+ * (including a CRLF split between chunks), multi-line data, comments and
+ * keepalives, event names and ids, retry hints and oversized lines.
+ */
+
+#include "ssestreamparser.h"
+
+#include <QtTest/QtTest>
+
+class TestSseStreamParser : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testSingleEvent()
+    {
+        SseStreamParser parser;
+        const QVector<SseStreamParser::Event> events =
+            parser.feed("event: drives\ndata: {\"slot\":1}\n\n");
+        QCOMPARE(events.size(), 1);
+        QCOMPARE(events[0].name, QByteArray("drives"));
+        QCOMPARE(events[0].data, QByteArray("{\"slot\":1}"));
+    }
+
+    void testSplitAcrossChunks()
+    {
+        const QByteArray stream = "data: one\n\nevent: mount\ndata: two\n\n";
+        // Every split point gives the same events
+        for (int split = 0; split <= stream.size(); ++split) {
+            SseStreamParser parser;
+            QVector<SseStreamParser::Event> events = parser.feed(stream.left(split));
+            events += parser.feed(stream.mid(split));
+            QCOMPARE(events.size(), 2);
+            QCOMPARE(events[0].name, QByteArray("message"));
+            QCOMPARE(events[0].data, QByteArray("one"));
+            QCOMPARE(events[1].name, QByteArray("mount"));
+            QCOMPARE(events[1].data, QByteArray("two"));
+        }
+
+        // One byte at a time
+        SseStreamParser parser;
+        QVector<SseStreamParser::Event> events;
+        for (char c : stream) {
+            events += parser.feed(QByteArray(1, c));
+        }
+        QCOMPARE(events.size(), 2);
+        QCOMPARE(parser.pendingBytes(), 0);
+    }
+
+    void testLineEndings()
+    {
+        SseStreamParser crlf;
+        QCOMPARE(crlf.feed("data: a\r\n\r\n").size(), 1);
+
+        SseStreamParser cr;
+        const QVector<SseStreamParser::Event> events = cr.feed("data: b\r\rdata: c\r\r");
+        QCOMPARE(events.size(), 2);
+        QCOMPARE(events[1].data, QByteArray("c"));
+
+        // CR at the end of one chunk, LF at the start of the next: one line end
+        SseStreamParser split;
+        QCOMPARE(split.feed("data: d\r").size(), 0);
+        QCOMPARE(split.feed("\n").size(), 0);
+        QCOMPARE(split.feed("\r").size(), 1);
+    }
+
+    void testMultiLineDataAndFields()
+    {
+        SseStreamParser parser;
+        const QVector<SseStreamParser::Event> events =
+            parser.feed("id: 7\ndata:first\ndata: second\ndata\n\ndata: next\n\n");
+        QCOMPARE(events.size(), 2);
+        QCOMPARE(events[0].data, QByteArray("first\nsecond\n"));  // bare "data" adds an empty line
+        QCOMPARE(events[0].id, QByteArray("7"));
+        QCOMPARE(events[1].id, QByteArray("7"));  // ids carry over
+        QCOMPARE(events[1].name, QByteArray("message"));
+    }
+
+    void testCommentsAndEmptyEvents()
+    {
+        SseStreamParser parser;
+        QCOMPARE(parser.feed(": keepalive\n\n").size(), 0);
+        QCOMPARE(parser.feed("event: lonely\n\n").size(), 0);  // no data, not dispatched
+        const QVector<SseStreamParser::Event> events = parser.feed("data: x\n\n");
+        QCOMPARE(events.size(), 1);
+        QCOMPARE(events[0].name, QByteArray("message"));  // the name reset with the blank line
+    }
+
+    void testRetry()
+    {
+        SseStreamParser parser;
+        QCOMPARE(parser.retryMs(), -1);
+        parser.feed("retry: 1500\n");
+        QCOMPARE(parser.retryMs(), 1500);
+        parser.feed("retry: soon\n");
+        QCOMPARE(parser.retryMs(), 1500);
+        parser.reset();
+        QCOMPARE(parser.retryMs(), -1);
+    }
+
+    void testOversizedLineDropped()
+    {
+        SseStreamParser parser;
+        const QByteArray big(SseStreamParser::kMaxLineBytes / 2 + 1, 'x');
+        parser.feed("data: ");
+        parser.feed(big);
+        parser.feed(big);
+        QCOMPARE(parser.pendingBytes(), 0);
+        parser.feed(big);  // still the same line: ignored
+        QCOMPARE(parser.pendingBytes(), 0);
+
+        const QVector<SseStreamParser::Event> events = parser.feed("\ndata: ok\n\n");
+        QCOMPARE(events.size(), 1);
+        QCOMPARE(events[0].data, QByteArray("ok"));
+    }
+};
+
+QTEST_MAIN(TestSseStreamParser)
+#include "test_sse_stream_parser.moc"
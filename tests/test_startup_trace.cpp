@@ -0,0 +1,164 @@
+/*
+ * Fujisan Test Suite - Startup Trace Tests
+ *
+ * Verifies StartupTrace: nothing is recorded until it is enabled, scopes on
+ * several threads land on their own named tracks, the first frame closes the
+ * trace, and the Chrome trace JSON and the benchmark summary carry the
+ * recorded phases.
+ */
+
+#include "startuptrace.h"
+
+#include <QtTest/QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+#include <QThread>
+
+class TestStartupTrace : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init()
+    {
+        StartupTrace::reset();
+    }
+
+    void cleanup()
+    {
+        StartupTrace::reset();
+    }
+
+    void testDisabledRecordsNothing()
+    {
+        QVERIFY(!StartupTrace::isEnabled());
+        {
+            StartupTrace::Scope trace("phase");
+        }
+        StartupTrace::addInstant("mark");
+        StartupTrace::markFirstFrame();
+        QVERIFY(StartupTrace::events().isEmpty());
+        QVERIFY(!StartupTrace::firstFrameSeen());
+    }
+
+    void testScopesAcrossThreads()
+    {
+        StartupTrace::enable(QString(), false);
+        {
+            StartupTrace::Scope trace("gui_phase");
+            QThread::msleep(2);
+        }
+        QThread worker;
+        worker.setObjectName("emulator");
+        worker.start();
+        QObject context;
+        context.moveToThread(&worker);
+        QMetaObject::invokeMethod(&context, []() {
+            StartupTrace::Scope trace("worker_phase");
+        }, Qt::BlockingQueuedConnection);
+        worker.quit();
+        worker.wait();
+
+        const QVector<StartupTrace::Event> events = StartupTrace::events();
+        QCOMPARE(events.size(), 2);
+        QCOMPARE(events[0].name, QByteArray("gui_phase"));
+        QVERIFY(events[0].durationUs >= 1000);
+        QCOMPARE(events[1].name, QByteArray("worker_phase"));
+        QVERIFY(events[0].thread != events[1].thread);
+        QCOMPARE(StartupTrace::threadNames().value(events[1].thread), QString("emulator"));
+    }
+
+    void testFirstFrameClosesTrace()
+    {
+        StartupTrace::enable(QString(), false);
+        StartupTrace::addComplete("early", 0, 10);
+        StartupTrace::markFirstFrame();
+        QVERIFY(StartupTrace::firstFrameSeen());
+        StartupTrace::addComplete("late", 0, 10);
+        StartupTrace::addInstant("late_mark");
+        StartupTrace::markFirstFrame();
+
+        const QVector<StartupTrace::Event> events = StartupTrace::events();
+        QCOMPARE(events.size(), 2);
+        QCOMPARE(events[1].name, QByteArray("first_frame"));
+        QCOMPARE(events[1].durationUs, qint64(-1));
+    }
+
+    void testChromeJsonAndSummary()
+    {
+        StartupTrace::enable(QString(), false);
+        StartupTrace::addComplete("libatari800_init", 100, 4000);
+        StartupTrace::addComplete("libatari800_init", 5000, 1000);  // summary keeps the longest
+        StartupTrace::markFirstFrame();
+
+        const QJsonDocument doc = QJsonDocument::fromJson(StartupTrace::toChromeJson());
+        QVERIFY(doc.isObject());
+        const QJsonArray traceEvents = doc.object()["traceEvents"].toArray();
+        int complete = 0, instant = 0, meta = 0;
+        for (const QJsonValue& value : traceEvents) {
+            const QJsonObject event = value.toObject();
+            const QString ph = event["ph"].toString();
+            if (ph == "X") {
+                complete++;
+                QCOMPARE(event["name"].toString(), QString("libatari800_init"));
+                QVERIFY(event.contains("dur"));
+            } else if (ph == "i") {
+                instant++;
+                QCOMPARE(event["name"].toString(), QString("first_frame"));
+            } else if (ph == "M") {
+                meta++;
+                QVERIFY(!event["args"].toObject()["name"].toString().isEmpty());
+            }
+        }
+        QCOMPARE(complete, 2);
+        QCOMPARE(instant, 1);
+        QCOMPARE(meta, 1);
+
+        const QJsonObject summary = StartupTrace::summary();
+        QCOMPARE(summary["phases"].toObject()["libatari800_init"].toDouble(), 4.0);
+        QVERIFY(summary["time_to_first_frame_ms"].toDouble() >= 0.0);
+    }
+
+    void testTraceFileWrittenOnFirstFrame()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.filePath("startup.json");
+        StartupTrace::enable(path, false);
+        {
+            StartupTrace::Scope trace("phase");
+        }
+        QVERIFY(!QFile::exists(path));
+        StartupTrace::markFirstFrame();
+
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+        QCOMPARE(doc.object()["traceEvents"].toArray().size(), 3);  // thread name, phase, first_frame
+    }
+
+    void testArguments()
+    {
+        QByteArray arg0("fujisan"), arg1("--startup-trace"), arg2("out.json");
+        char* argv[] = {arg0.data(), arg1.data(), arg2.data()};
+        StartupTrace::enableFromArguments(3, argv);
+        QVERIFY(StartupTrace::isEnabled());
+        QVERIFY(!StartupTrace::isBenchmark());
+
+        StartupTrace::reset();
+        QByteArray bench("--startup-benchmark");
+        char* benchArgv[] = {arg0.data(), bench.data()};
+        StartupTrace::enableFromArguments(2, benchArgv);
+        QVERIFY(StartupTrace::isBenchmark());
+
+        StartupTrace::reset();
+        char* plainArgv[] = {arg0.data()};
+        if (!qEnvironmentVariableIsSet("FUJISAN_STARTUP_TRACE")) {
+            StartupTrace::enableFromArguments(1, plainArgv);
+            QVERIFY(!StartupTrace::isEnabled());
+        }
+    }
+};
+
+QTEST_MAIN(TestStartupTrace)
+#include "test_startup_trace.moc"
@@ -0,0 +1,127 @@
+/*
+ * Fujisan Test Suite - State File Worker Tests
+ *
+ * Verifies save-state file I/O done off the emulator thread: compressed
+ * round-trips, reading legacy uncompressed .a8s files, the .meta sidecar,
+ * and that the async save() signal fires only after the file is complete.
+ */
+
+#include "statefileworker.h"
+
+#include <QtTest/QtTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QThread>
+
+class TestStateFileWorker : public QObject {
+    Q_OBJECT
+
+private:
+    static QByteArray fakeState()
+    {
+        // Mostly-zero RAM with a header, like a real LIBATARI800_StateSave buffer
+        QByteArray state("ATARI800");
+        state.append(QByteArray(70000, '\0'));
+        for (int i = 0; i < 256; ++i) {
+            state[100 + i * 37] = static_cast<char>(i);
+        }
+        return state;
+    }
+
+private slots:
+    void testEncodeDecodeRoundTrip()
+    {
+        const QByteArray raw = fakeState();
+        const QByteArray encoded = StateFileWorker::encode(raw);
+        QVERIFY(encoded.startsWith("FUJISANZ"));
+        QVERIFY(encoded.size() < raw.size() / 4);
+
+        QByteArray decoded;
+        QVERIFY(StateFileWorker::decode(encoded, decoded));
+        QCOMPARE(decoded, raw);
+    }
+
+    void testLegacyUncompressedFile()
+    {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("legacy.a8s");
+        const QByteArray raw = fakeState();
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(raw);
+        file.close();
+
+        QByteArray loaded;
+        QString profile;
+        QVERIFY(StateFileWorker::readStateFile(path, loaded, profile));
+        QCOMPARE(loaded, raw);
+        QVERIFY(profile.isEmpty());
+    }
+
+    void testWriteReadWithProfile()
+    {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("state.a8s");
+        QVERIFY(StateFileWorker::writeStateFile(path, fakeState(), "Test Profile"));
+        QVERIFY(QFileInfo::exists(path + ".meta"));
+
+        QByteArray loaded;
+        QString profile;
+        QVERIFY(StateFileWorker::readStateFile(path, loaded, profile));
+        QCOMPARE(loaded, fakeState());
+        QCOMPARE(profile, QString("Test Profile"));
+    }
+
+    void testCorruptFileIsRejected()
+    {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("corrupt.a8s");
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("FUJISANZ garbage");
+        file.close();
+
+        QByteArray loaded;
+        QString profile;
+        QVERIFY(!StateFileWorker::readStateFile(path, loaded, profile));
+        QVERIFY(!StateFileWorker::readStateFile(dir.filePath("missing.a8s"), loaded, profile));
+    }
+
+    void testAsyncSaveSignalsAfterFileIsComplete()
+    {
+        QTemporaryDir dir;
+        const QString path = dir.filePath("async.a8s");
+
+        QThread thread;
+        StateFileWorker worker;
+        worker.moveToThread(&thread);
+        thread.start();
+
+        QSignalSpy savedSpy(&worker, &StateFileWorker::saved);
+        QSignalSpy loadedSpy(&worker, &StateFileWorker::loaded);
+        QMetaObject::invokeMethod(&worker, "save", Qt::QueuedConnection,
+                                  Q_ARG(QString, path), Q_ARG(QByteArray, fakeState()),
+                                  Q_ARG(QString, QString("P")));
+        QVERIFY(savedSpy.wait(5000));
+        QCOMPARE(savedSpy.first().at(1).toBool(), true);
+
+        // The file is complete by the time saved() arrives
+        QByteArray loaded;
+        QString profile;
+        QVERIFY(StateFileWorker::readStateFile(path, loaded, profile));
+        QCOMPARE(loaded, fakeState());
+
+        QMetaObject::invokeMethod(&worker, "load", Qt::QueuedConnection, Q_ARG(QString, path));
+        QVERIFY(loadedSpy.wait(5000));
+        QCOMPARE(loadedSpy.first().at(1).toByteArray(), fakeState());
+        QCOMPARE(loadedSpy.first().at(2).toString(), QString("P"));
+        QCOMPARE(loadedSpy.first().at(3).toBool(), true);
+
+        thread.quit();
+        thread.wait();
+        worker.moveToThread(QThread::currentThread());
+    }
+};
+
+QTEST_MAIN(TestStateFileWorker)
+#include "test_state_file_worker.moc"
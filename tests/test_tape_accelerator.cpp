@@ -0,0 +1,103 @@
+/*
+ * Fujisan Test Suite - Tape Accelerator Tests
+ *
+ * Verifies TapeAccelerator: a load starts only after the cassette motor has
+ * run for a few frames with data left on the tape, survives the motor gaps
+ * between records, and ends once the motor stays off, at the end of the tape,
+ * or when the tape is removed or set to record.
+ */
+
+#include "tapeaccelerator.h"
+
+#include <QtTest/QtTest>
+
+class TestTapeAccelerator : public QObject {
+    Q_OBJECT
+
+private:
+    static constexpr int kSize = 200;
+
+    // Runs `frames` frames with the given motor state; returns the last non-trivial transition
+    static TapeAccelerator::Transition run(TapeAccelerator& accelerator, int frames, bool motorOn,
+                                           int position = 10)
+    {
+        TapeAccelerator::Transition last = TapeAccelerator::NoChange;
+        for (int i = 0; i < frames; ++i) {
+            const TapeAccelerator::Transition transition =
+                accelerator.update(true, motorOn, false, position, kSize);
+            if (transition != TapeAccelerator::NoChange) {
+                last = transition;
+            }
+        }
+        return last;
+    }
+
+private slots:
+    void testStartsAfterMotorRuns()
+    {
+        TapeAccelerator accelerator;
+        QCOMPARE(run(accelerator, TapeAccelerator::kStartFrames - 1, true), TapeAccelerator::NoChange);
+        QVERIFY(!accelerator.isActive());
+        QCOMPARE(accelerator.update(true, true, false, 10, kSize), TapeAccelerator::Start);
+        QVERIFY(accelerator.isActive());
+        QCOMPARE(accelerator.status()["loads"].toInt(), 1);
+    }
+
+    void testMotorBlipDoesNotStart()
+    {
+        TapeAccelerator accelerator;
+        for (int i = 0; i < 20; ++i) {
+            QCOMPARE(run(accelerator, TapeAccelerator::kStartFrames - 1, true), TapeAccelerator::NoChange);
+            QCOMPARE(run(accelerator, 1, false), TapeAccelerator::NoChange);
+        }
+        QVERIFY(!accelerator.isActive());
+    }
+
+    void testRecordGapKeepsLoading()
+    {
+        TapeAccelerator accelerator;
+        QCOMPARE(run(accelerator, TapeAccelerator::kStartFrames, true), TapeAccelerator::Start);
+        QCOMPARE(run(accelerator, TapeAccelerator::kStopFrames - 1, false), TapeAccelerator::NoChange);
+        QCOMPARE(run(accelerator, 50, true, 20), TapeAccelerator::NoChange);
+        QVERIFY(accelerator.isActive());
+        QCOMPARE(run(accelerator, TapeAccelerator::kStopFrames, false, 20), TapeAccelerator::Stop);
+        QVERIFY(!accelerator.isActive());
+        QVERIFY(accelerator.status()["accelerated_frames"].toInt() > 50);
+    }
+
+    void testEndOfTapeStops()
+    {
+        TapeAccelerator accelerator;
+        QCOMPARE(run(accelerator, TapeAccelerator::kStartFrames, true), TapeAccelerator::Start);
+        QCOMPARE(accelerator.update(true, true, false, kSize, kSize), TapeAccelerator::Stop);
+        // The OS may keep the motor running past the last block; nothing is left to load
+        QCOMPARE(run(accelerator, 20, true, kSize), TapeAccelerator::NoChange);
+        QVERIFY(!accelerator.isActive());
+    }
+
+    void testRemovedOrRecordingTapeStops()
+    {
+        TapeAccelerator accelerator;
+        QCOMPARE(run(accelerator, TapeAccelerator::kStartFrames, true), TapeAccelerator::Start);
+        QCOMPARE(accelerator.update(false, true, false, 0, 0), TapeAccelerator::Stop);
+
+        QCOMPARE(run(accelerator, TapeAccelerator::kStartFrames, true), TapeAccelerator::Start);
+        QCOMPARE(accelerator.update(true, true, true, 10, kSize), TapeAccelerator::Stop);
+        for (int i = 0; i < 20; ++i) {
+            QCOMPARE(accelerator.update(true, true, true, 10, kSize), TapeAccelerator::NoChange);
+        }
+        QCOMPARE(accelerator.status()["loads"].toInt(), 2);
+    }
+
+    void testResetForgetsLoadSilently()
+    {
+        TapeAccelerator accelerator;
+        QCOMPARE(run(accelerator, TapeAccelerator::kStartFrames, true), TapeAccelerator::Start);
+        accelerator.reset();
+        QVERIFY(!accelerator.isActive());
+        QCOMPARE(run(accelerator, TapeAccelerator::kStopFrames, false), TapeAccelerator::NoChange);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestTapeAccelerator)
+#include "test_tape_accelerator.moc"
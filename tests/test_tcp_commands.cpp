@@ -4,7 +4,8 @@
  * Spins up a real MainWindow (hidden), TCP server on an ephemeral port, and a
  * local QTcpSocket client. Covers protocol errors plus commands used by
  * vscode-fastbasic-debugger (fujisanClient.ts): status.get_state, config.set_hard_drive,
- * media.load_xex, debug.load_xex_for_debug, system.get_speed, and input.send_text validation.
+ * media.load_xex, debug.load_xex_for_debug, system.get_speed, input.send_text validation and
+ * screen.get_buffer, batch requests and config.set_framing.
  * One hidden MainWindow is shared across all slots (avoids repeated libatari800 teardown).
  */
 
@@ -12,17 +13,22 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
 #include <QHostAddress>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QLocalSocket>
 #include <QSettings>
 #include <QTcpSocket>
 #include <QTemporaryDir>
+#include <QThread>
 #include <QtTest/QtTest>
 
 #include "mainwindow.h"
 #include "tcpserver.h"
+#include "tracerecorder.h"
 
 class TestTcpCommands : public QObject {
     Q_OBJECT
@@ -30,6 +36,7 @@ class TestTcpCommands : public QObject {
 private:
     QTemporaryDir m_tempDir;
     QByteArray m_readBuffer;
+    QStringList m_seenEvents;  // event names passed over by waitForResponse()
     MainWindow* m_mainWindow = nullptr;
     TCPServer* m_tcp = nullptr;
     QTcpSocket* m_socket = nullptr;
@@ -99,6 +106,9 @@ private:
                     continue;
                 }
                 const QJsonObject o = doc.object();
+                if (o.value(QStringLiteral("type")).toString() == QStringLiteral("event")) {
+                    m_seenEvents.append(o.value(QStringLiteral("event")).toString());
+                }
                 if (o.value(QStringLiteral("type")).toString() == QStringLiteral("response")
                     && o.value(QStringLiteral("id")).toString() == id) {
                     return o;
@@ -209,6 +219,63 @@ private slots:
         QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
         const QJsonObject res = resp.value(QStringLiteral("result")).toObject();
         QVERIFY(res.contains(QStringLiteral("speed")) || res.contains(QStringLiteral("percentage")));
+        // No display to lock to without V-Sync
+        QCOMPARE(res.value(QStringLiteral("refresh_locked")).toBool(), false);
+        QVERIFY(res.value(QStringLiteral("paced_fps")).toDouble() > 0.0);
+    }
+
+    void testSystemConfigureRunAhead()
+    {
+        QJsonObject params;
+        params[QStringLiteral("frames")] = 2;
+        QJsonObject resp = sendCommand(QStringLiteral("system.configure_run_ahead"), QStringLiteral("ra1"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        QCOMPARE(resp.value(QStringLiteral("result")).toObject().value(QStringLiteral("frames")).toInt(), 2);
+
+        params[QStringLiteral("frames")] = 9;
+        resp = sendCommand(QStringLiteral("system.configure_run_ahead"), QStringLiteral("ra2"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+
+        params[QStringLiteral("frames")] = 0;
+        resp = sendCommand(QStringLiteral("system.configure_run_ahead"), QStringLiteral("ra3"), params);
+        const QJsonObject result = resp.value(QStringLiteral("result")).toObject();
+        QCOMPARE(result.value(QStringLiteral("frames")).toInt(), 0);
+        QVERIFY(result.contains(QStringLiteral("active")));
+    }
+
+    void testSystemConfigureScheduling()
+    {
+        QJsonObject resp = sendCommand(QStringLiteral("system.configure_scheduling"), QStringLiteral("ts1"));
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        QJsonObject result = resp.value(QStringLiteral("result")).toObject();
+        QVERIFY(result.contains(QStringLiteral("precise_timing")));
+        QVERIFY(result.value(QStringLiteral("cpu_count")).toInt() >= 1);
+
+        QJsonObject params;
+        params[QStringLiteral("priority")] = QStringLiteral("urgent");
+        resp = sendCommand(QStringLiteral("system.configure_scheduling"), QStringLiteral("ts2"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+
+        params[QStringLiteral("priority")] = QStringLiteral("normal");
+        params[QStringLiteral("cpu")] = 100000;
+        resp = sendCommand(QStringLiteral("system.configure_scheduling"), QStringLiteral("ts3"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+
+        params[QStringLiteral("cpu")] = -1;
+        params[QStringLiteral("precise_timing")] = false;
+        resp = sendCommand(QStringLiteral("system.configure_scheduling"), QStringLiteral("ts4"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        result = resp.value(QStringLiteral("result")).toObject();
+        QCOMPARE(result.value(QStringLiteral("granted")).toString(), QStringLiteral("normal"));
+
+        params = QJsonObject();
+        params[QStringLiteral("reset")] = true;
+        resp = sendCommand(QStringLiteral("status.get_frame_pacing"), QStringLiteral("fp1"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        result = resp.value(QStringLiteral("result")).toObject();
+        QVERIFY(result.value(QStringLiteral("lateness")).toObject().contains(QStringLiteral("p99_us")));
+        QVERIFY(result.value(QStringLiteral("interval")).toObject().contains(QStringLiteral("count")));
+        QVERIFY(result.contains(QStringLiteral("missed_frames")));
     }
 
     void testMissingCommand()
@@ -264,6 +331,593 @@ private slots:
         QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
     }
 
+    void testScreenGetBuffer()
+    {
+        const QJsonObject resp = sendCommand(QStringLiteral("screen.get_buffer"), QStringLiteral("sb1"));
+        QVERIFY(!resp.isEmpty());
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        const QJsonObject res = resp.value(QStringLiteral("result")).toObject();
+        QCOMPARE(res.value(QStringLiteral("format")).toString(), QStringLiteral("indexed8"));
+        const int width = res.value(QStringLiteral("width")).toInt();
+        const int height = res.value(QStringLiteral("height")).toInt();
+        QCOMPARE(QByteArray::fromBase64(res.value(QStringLiteral("data")).toString().toLatin1()).size(),
+                 width * height);
+        QCOMPARE(QByteArray::fromBase64(res.value(QStringLiteral("palette")).toString().toLatin1()).size(), 768);
+    }
+
+    void testScreenGetText()
+    {
+        QJsonObject resp = sendCommand(QStringLiteral("screen.get_text"), QStringLiteral("txt-1"),
+                                       QJsonObject{{QStringLiteral("detail"), true}});
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        const QJsonObject result = resp.value(QStringLiteral("result")).toObject();
+        const QJsonArray rows = result.value(QStringLiteral("rows")).toArray();
+        QCOMPARE(result.value(QStringLiteral("lines")).toArray().size(), rows.size());
+        QVERIFY(result.contains(QStringLiteral("display_list")));
+
+        resp = sendCommand(QStringLiteral("screen.get_text"), QStringLiteral("txt-bad"),
+                           QJsonObject{{QStringLiteral("display_list"), 70000}});
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+    }
+
+    void testStatusGetMetrics()
+    {
+        QJsonObject resp = sendCommand(QStringLiteral("status.get_state"), QStringLiteral("m-s"));
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        resp = sendCommand(QStringLiteral("status.get_metrics"), QStringLiteral("m-1"));
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        const QJsonObject result = resp.value(QStringLiteral("result")).toObject();
+        const QJsonObject state = result.value(QStringLiteral("commands")).toObject()
+                                      .value(QStringLiteral("status.get_state")).toObject();
+        QVERIFY(state.value(QStringLiteral("count")).toInt() > 0);
+        QVERIFY(state.value(QStringLiteral("serialisation")).toObject()
+                    .value(QStringLiteral("count")).toInt() > 0);
+        QVERIFY(state.value(QStringLiteral("execution")).toObject().contains(QStringLiteral("p99_us")));
+        const QJsonArray clients = result.value(QStringLiteral("clients")).toArray();
+        QVERIFY(!clients.isEmpty());
+        QVERIFY(clients.first().toObject().value(QStringLiteral("bytes_in")).toDouble() > 0);
+    }
+
+    void testStatusGetAudioTelemetry()
+    {
+        QJsonObject params;
+        params[QStringLiteral("since")] = 0;
+        params[QStringLiteral("max")] = 10;
+        const QJsonObject resp = sendCommand(QStringLiteral("status.get_audio_telemetry"), QStringLiteral("at1"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        const QJsonObject result = resp.value(QStringLiteral("result")).toObject();
+        const QJsonArray columns = result.value(QStringLiteral("columns")).toArray();
+        QCOMPARE(columns.first().toString(), QStringLiteral("frame"));
+        const QJsonArray samples = result.value(QStringLiteral("samples")).toArray();
+        QVERIFY(samples.size() <= 10);
+        QCOMPARE(result.value(QStringLiteral("count")).toInt(), samples.size());
+        for (const QJsonValue& row : samples) {
+            QCOMPARE(row.toArray().size(), columns.size());
+        }
+        QVERIFY(result.value(QStringLiteral("next")).toDouble() >= samples.size());
+        QVERIFY(result.value(QStringLiteral("capacity")).toInt() > 0);
+    }
+
+    void testStatusGetInputLatency()
+    {
+        QJsonObject params;
+        params[QStringLiteral("enabled")] = true;
+        QJsonObject resp = sendCommand(QStringLiteral("status.get_input_latency"), QStringLiteral("il1"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        QJsonObject result = resp.value(QStringLiteral("result")).toObject();
+        QCOMPARE(result.value(QStringLiteral("enabled")).toBool(), true);
+        const QJsonObject keyboard = result.value(QStringLiteral("sources")).toObject()
+                                         .value(QStringLiteral("keyboard")).toObject();
+        QVERIFY(keyboard.contains(QStringLiteral("to_frame")));
+        QVERIFY(keyboard.contains(QStringLiteral("to_present")));
+
+        params[QStringLiteral("enabled")] = false;
+        params[QStringLiteral("reset")] = true;
+        resp = sendCommand(QStringLiteral("status.get_input_latency"), QStringLiteral("il2"), params);
+        result = resp.value(QStringLiteral("result")).toObject();
+        QCOMPARE(result.value(QStringLiteral("enabled")).toBool(), false);
+    }
+
+    void testStatusGetNetsio()
+    {
+        QJsonObject resp = sendCommand(QStringLiteral("status.get_netsio"), QStringLiteral("ns1"));
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        const QJsonObject result = resp.value(QStringLiteral("result")).toObject();
+        QVERIFY(result.contains(QStringLiteral("enabled")));
+        QVERIFY(result.contains(QStringLiteral("connected")));
+        if (result.contains(QStringLiteral("sync_timeout_ms"))) {
+            QVERIFY(result.value(QStringLiteral("sync_timeout_ms")).toDouble() >= 40.0);
+            QVERIFY(result.value(QStringLiteral("stalled_ms")).toDouble() >= 0.0);
+        }
+    }
+
+    void testStatusGetPerformance()
+    {
+        QJsonObject params;
+        params[QStringLiteral("enabled")] = true;
+        params[QStringLiteral("history")] = 8;
+        QJsonObject resp = sendCommand(QStringLiteral("status.get_performance"), QStringLiteral("pf1"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        QJsonObject result = resp.value(QStringLiteral("result")).toObject();
+        QCOMPARE(result.value(QStringLiteral("enabled")).toBool(), true);
+        QCOMPARE(result.value(QStringLiteral("window")).toInt(), 512);
+        const QJsonObject metrics = result.value(QStringLiteral("metrics")).toObject();
+        QCOMPARE(metrics.size(), 8);
+        QVERIFY(metrics.value(QStringLiteral("frame_interval")).toObject().contains(QStringLiteral("history")));
+        QCOMPARE(metrics.value(QStringLiteral("audio_fill")).toObject()
+                     .value(QStringLiteral("unit")).toString(), QStringLiteral("percent"));
+
+        params = QJsonObject();
+        params[QStringLiteral("history")] = 513;
+        resp = sendCommand(QStringLiteral("status.get_performance"), QStringLiteral("pf2"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+
+        params = QJsonObject();
+        params[QStringLiteral("enabled")] = false;
+        params[QStringLiteral("reset")] = true;
+        params[QStringLiteral("stream_ms")] = 0;
+        resp = sendCommand(QStringLiteral("status.get_performance"), QStringLiteral("pf3"), params);
+        result = resp.value(QStringLiteral("result")).toObject();
+        QCOMPARE(result.value(QStringLiteral("enabled")).toBool(), false);
+        QCOMPARE(result.value(QStringLiteral("streaming_ms")).toInt(), 0);
+    }
+
+    void testScreenRecordStartStop()
+    {
+        const QString path = m_tempDir.filePath(QStringLiteral("capture.avi"));
+        QJsonObject params;
+        params[QStringLiteral("filename")] = path;
+        QJsonObject resp = sendCommand(QStringLiteral("screen.record_start"), QStringLiteral("rec1"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        QCOMPARE(resp.value(QStringLiteral("result")).toObject().value(QStringLiteral("recording")).toBool(), true);
+
+        // A second recording is refused while the first runs
+        resp = sendCommand(QStringLiteral("screen.record_start"), QStringLiteral("rec2"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+
+        resp = sendCommand(QStringLiteral("screen.record_stop"), QStringLiteral("rec3"));
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        const QJsonObject result = resp.value(QStringLiteral("result")).toObject();
+        QCOMPARE(result.value(QStringLiteral("recording")).toBool(), false);
+        QCOMPARE(result.value(QStringLiteral("files")).toArray().first().toString(), path);
+        QVERIFY(QFileInfo(path).size() > 0);
+    }
+
+    void testScreenStreamInvalidEncoding()
+    {
+        QJsonObject params;
+        params[QStringLiteral("encoding")] = QStringLiteral("jpeg");
+        const QJsonObject resp = sendCommand(QStringLiteral("screen.stream_start"), QStringLiteral("ss1"), params);
+        QVERIFY(!resp.isEmpty());
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+    }
+
+    void testScreenStreamInputNeedsStream()
+    {
+        QJsonObject params;
+        params[QStringLiteral("sequence")] = 1;
+        params[QStringLiteral("keys")] = QJsonArray{63};
+        QJsonObject resp = sendCommand(QStringLiteral("screen.stream_input"), QStringLiteral("si1"), params);
+        QVERIFY(!resp.isEmpty());
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+
+        resp = sendCommand(QStringLiteral("screen.stream_status"), QStringLiteral("si2"));
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        QCOMPARE(resp.value(QStringLiteral("result")).toObject().value(QStringLiteral("streaming")).toBool(), false);
+    }
+
+    void testBatchCollectsResponses()
+    {
+        QJsonArray commands;
+        commands.append(QJsonObject{{QStringLiteral("command"), QStringLiteral("status.get_state")},
+                                    {QStringLiteral("id"), QStringLiteral("b-s")}});
+        commands.append(QJsonObject{{QStringLiteral("command"), QStringLiteral("nope.cmd")},
+                                    {QStringLiteral("id"), QStringLiteral("b-bad")}});
+        commands.append(QJsonObject{{QStringLiteral("command"), QStringLiteral("system.get_speed")},
+                                    {QStringLiteral("id"), QStringLiteral("b-g")}});
+        QJsonObject params;
+        params[QStringLiteral("commands")] = commands;
+        const QJsonObject resp = sendCommand(QStringLiteral("batch"), QStringLiteral("b1"), params);
+        QVERIFY(!resp.isEmpty());
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        const QJsonObject res = resp.value(QStringLiteral("result")).toObject();
+        QCOMPARE(res.value(QStringLiteral("executed")).toInt(), 3);
+        QCOMPARE(res.value(QStringLiteral("errors")).toInt(), 1);
+        const QJsonArray responses = res.value(QStringLiteral("responses")).toArray();
+        QCOMPARE(responses.size(), 3);
+        QCOMPARE(responses.at(0).toObject().value(QStringLiteral("id")).toString(), QStringLiteral("b-s"));
+        QCOMPARE(responses.at(1).toObject().value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+        QCOMPARE(responses.at(2).toObject().value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+
+        // The sub-responses were not also written on their own
+        QVERIFY(waitForResponse(QStringLiteral("b-s"), 200).isEmpty());
+
+        params[QStringLiteral("stop_on_error")] = true;
+        const QJsonObject stopped = sendCommand(QStringLiteral("batch"), QStringLiteral("b2"), params);
+        QCOMPARE(stopped.value(QStringLiteral("result")).toObject().value(QStringLiteral("executed")).toInt(), 2);
+    }
+
+    void testScheduleListAndCancel()
+    {
+        QJsonObject params;
+        params[QStringLiteral("in_frames")] = 10;
+        params[QStringLiteral("action")] = QStringLiteral("teleport");
+        QJsonObject resp = sendCommand(QStringLiteral("system.schedule"), QStringLiteral("sch-bad"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+
+        // Far enough ahead that it cannot run during the test
+        params[QStringLiteral("in_frames")] = 1000000;
+        params[QStringLiteral("action")] = QStringLiteral("write_memory");
+        params[QStringLiteral("params")] = QJsonObject{{QStringLiteral("address"), 0x0600},
+                                                      {QStringLiteral("data"), QJsonArray{1, 2, 3}}};
+        resp = sendCommand(QStringLiteral("system.schedule"), QStringLiteral("sch-1"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        const QJsonObject scheduled = resp.value(QStringLiteral("result")).toObject();
+        const int id = scheduled.value(QStringLiteral("id")).toInt();
+        QVERIFY(id > 0);
+        QCOMPARE(scheduled.value(QStringLiteral("frame")).toDouble(),
+                 scheduled.value(QStringLiteral("current_frame")).toDouble() + 1000000);
+
+        resp = sendCommand(QStringLiteral("system.list_scheduled"), QStringLiteral("sch-list"));
+        const QJsonArray actions = resp.value(QStringLiteral("result")).toObject()
+                                       .value(QStringLiteral("actions")).toArray();
+        QCOMPARE(actions.size(), 1);
+        QCOMPARE(actions.first().toObject().value(QStringLiteral("type")).toString(),
+                 QStringLiteral("write_memory"));
+
+        resp = sendCommand(QStringLiteral("system.cancel_scheduled"), QStringLiteral("sch-c"),
+                           QJsonObject{{QStringLiteral("id"), id}});
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        resp = sendCommand(QStringLiteral("system.cancel_scheduled"), QStringLiteral("sch-c2"),
+                           QJsonObject{{QStringLiteral("id"), id}});
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+    }
+
+    void testMemoryBlockRoundTripAndDiff()
+    {
+        QJsonObject resp = sendCommand(QStringLiteral("debug.read_memory_block"), QStringLiteral("mb-all"));
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        const QByteArray all = QByteArray::fromBase64(
+            resp.value(QStringLiteral("result")).toObject().value(QStringLiteral("data")).toString().toLatin1());
+        QCOMPARE(all.size(), 65536);
+
+        const QByteArray pattern("\x11\x22\x33\x44", 4);
+        QJsonObject params;
+        params[QStringLiteral("address")] = 0x0600;
+        params[QStringLiteral("data")] = QString::fromLatin1(pattern.toBase64());
+        resp = sendCommand(QStringLiteral("debug.write_memory_block"), QStringLiteral("mb-w"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+
+        params = QJsonObject{{QStringLiteral("address"), 0x0600}, {QStringLiteral("length"), 4}};
+        resp = sendCommand(QStringLiteral("debug.read_memory_block"), QStringLiteral("mb-r"), params);
+        QCOMPARE(QByteArray::fromBase64(resp.value(QStringLiteral("result")).toObject()
+                                            .value(QStringLiteral("data")).toString().toLatin1()),
+                 pattern);
+
+        // OS ROM does not change, so the second diff read has nothing to report
+        params = QJsonObject{{QStringLiteral("address"), 0xE000}, {QStringLiteral("length"), 256},
+                             {QStringLiteral("diff"), true}};
+        resp = sendCommand(QStringLiteral("debug.read_memory_block"), QStringLiteral("mb-d1"), params);
+        QVERIFY(resp.value(QStringLiteral("result")).toObject().value(QStringLiteral("full")).toBool());
+        resp = sendCommand(QStringLiteral("debug.read_memory_block"), QStringLiteral("mb-d2"), params);
+        const QJsonObject second = resp.value(QStringLiteral("result")).toObject();
+        QVERIFY(!second.value(QStringLiteral("full")).toBool());
+        QCOMPARE(second.value(QStringLiteral("changes")).toArray().size(), 0);
+
+        params = QJsonObject{{QStringLiteral("address"), 0xFFFF}, {QStringLiteral("length"), 2}};
+        resp = sendCommand(QStringLiteral("debug.read_memory_block"), QStringLiteral("mb-bad"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+    }
+
+    void testDebugSnapshot()
+    {
+        QJsonObject params{{QStringLiteral("include"), QJsonArray{QStringLiteral("memory")}}};
+        QJsonObject resp = sendCommand(QStringLiteral("debug.snapshot"), QStringLiteral("snap"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        const QJsonObject result = resp.value(QStringLiteral("result")).toObject();
+        const QJsonArray layout = result.value(QStringLiteral("layout")).toArray();
+        QCOMPARE(layout.size(), 1);
+        QCOMPARE(layout[0].toObject().value(QStringLiteral("length")).toInt(), 65536);
+        const QByteArray data = QByteArray::fromBase64(result.value(QStringLiteral("data")).toString().toLatin1());
+        QCOMPARE(data.size(), 65536);
+        const QJsonObject registers = result.value(QStringLiteral("registers")).toObject();
+        QVERIFY(registers.value(QStringLiteral("antic")).toObject().contains(QStringLiteral("DMACTL")));
+        QVERIFY(registers.value(QStringLiteral("pia")).toObject().contains(QStringLiteral("PORTB")));
+
+        params = QJsonObject{{QStringLiteral("include"), QJsonArray()}};
+        resp = sendCommand(QStringLiteral("debug.snapshot"), QStringLiteral("snap-regs"), params);
+        QCOMPARE(resp.value(QStringLiteral("result")).toObject().value(QStringLiteral("length")).toInt(), 0);
+
+        params = QJsonObject{{QStringLiteral("include"), QJsonArray{QStringLiteral("registers")}}};
+        resp = sendCommand(QStringLiteral("debug.snapshot"), QStringLiteral("snap-bad"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+    }
+
+    void testDebugLoadLabelsSymbolicDisassembly()
+    {
+        const QString labelPath = m_tempDir.path() + QStringLiteral("/program.lab");
+        QFile labelFile(labelPath);
+        QVERIFY(labelFile.open(QIODevice::WriteOnly));
+        labelFile.write("mads 2.1.0\nLabel table:\n00\t0600\tSTART\n");
+        labelFile.close();
+
+        // JSR $0600 at $0600
+        QJsonObject params;
+        params[QStringLiteral("address")] = 0x0600;
+        params[QStringLiteral("data")] = QString::fromLatin1(QByteArray("\x20\x00\x06", 3).toBase64());
+        QJsonObject resp = sendCommand(QStringLiteral("debug.write_memory_block"), QStringLiteral("lb-w"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+
+        params = QJsonObject{{QStringLiteral("path"), labelPath}};
+        resp = sendCommand(QStringLiteral("debug.load_labels"), QStringLiteral("lb-load"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        QCOMPARE(resp.value(QStringLiteral("result")).toObject().value(QStringLiteral("labels")).toInt(), 1);
+
+        params = QJsonObject{{QStringLiteral("address"), 0x0600}, {QStringLiteral("lines"), 1}};
+        resp = sendCommand(QStringLiteral("debug.disassemble"), QStringLiteral("lb-dis"), params);
+        QJsonObject line = resp.value(QStringLiteral("result")).toObject()
+                               .value(QStringLiteral("disassembly")).toArray().at(0).toObject();
+        QCOMPARE(line.value(QStringLiteral("instruction")).toString(), QStringLiteral("JSR START"));
+        QCOMPARE(line.value(QStringLiteral("label")).toString(), QStringLiteral("START"));
+
+        resp = sendCommand(QStringLiteral("debug.clear_labels"), QStringLiteral("lb-clear"));
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        resp = sendCommand(QStringLiteral("debug.disassemble"), QStringLiteral("lb-dis2"), params);
+        line = resp.value(QStringLiteral("result")).toObject()
+                   .value(QStringLiteral("disassembly")).toArray().at(0).toObject();
+        QCOMPARE(line.value(QStringLiteral("instruction")).toString(), QStringLiteral("JSR $0600"));
+        QVERIFY(!line.contains(QStringLiteral("label")));
+
+        params = QJsonObject{{QStringLiteral("path"), m_tempDir.path() + QStringLiteral("/missing.lab")}};
+        resp = sendCommand(QStringLiteral("debug.load_labels"), QStringLiteral("lb-missing"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+    }
+
+    void testDebugInstructionTrace()
+    {
+        const QString path = m_tempDir.filePath(QStringLiteral("run.ftr"));
+        QJsonObject params{{QStringLiteral("path"), path}, {QStringLiteral("size_mb"), 1},
+                           {QStringLiteral("start"), 0x0600}, {QStringLiteral("end"), 0x06FF}};
+        QJsonObject resp = sendCommand(QStringLiteral("debug.trace_start"), QStringLiteral("tr-start"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        QJsonObject result = resp.value(QStringLiteral("result")).toObject();
+        QCOMPARE(result.value(QStringLiteral("recording")).toBool(), true);
+        QCOMPARE(result.value(QStringLiteral("start")).toString(), QStringLiteral("$0600"));
+        QCOMPARE(result.value(QStringLiteral("end")).toString(), QStringLiteral("$06FF"));
+        QCOMPARE(QFileInfo(path).size(), qint64(TraceRecorder::kHeaderBytes + (1 << 20)));
+
+        resp = sendCommand(QStringLiteral("debug.trace_status"), QStringLiteral("tr-status"));
+        QCOMPARE(resp.value(QStringLiteral("result")).toObject().value(QStringLiteral("path")).toString(), path);
+
+        resp = sendCommand(QStringLiteral("debug.trace_stop"), QStringLiteral("tr-stop"));
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        result = resp.value(QStringLiteral("result")).toObject();
+        QCOMPARE(result.value(QStringLiteral("recording")).toBool(), false);
+
+        // Whatever was recorded before the stop is still readable
+        resp = sendCommand(QStringLiteral("debug.trace_tail"), QStringLiteral("tr-tail"),
+                           QJsonObject{{QStringLiteral("count"), 10}});
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        result = resp.value(QStringLiteral("result")).toObject();
+        QCOMPARE(result.value(QStringLiteral("count")).toInt(),
+                 result.value(QStringLiteral("records")).toArray().size());
+        QVERIFY(result.value(QStringLiteral("count")).toInt() <= 10);
+        for (const QJsonValue& row : result.value(QStringLiteral("records")).toArray()) {
+            const int pc = row.toObject().value(QStringLiteral("pc")).toInt();
+            QVERIFY(pc >= 0x0600 && pc <= 0x06FF);
+        }
+        QVector<TraceRecorder::Entry> entries;
+        QVERIFY(TraceRecorder::readFile(path, &entries));
+
+        params[QStringLiteral("start")] = 0x0700;
+        resp = sendCommand(QStringLiteral("debug.trace_start"), QStringLiteral("tr-range"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+        params[QStringLiteral("start")] = 0x0600;
+        params[QStringLiteral("size_mb")] = 0;
+        resp = sendCommand(QStringLiteral("debug.trace_start"), QStringLiteral("tr-size"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+    }
+
+    void testDebugProfile()
+    {
+        QJsonObject resp = sendCommand(QStringLiteral("debug.profile_start"), QStringLiteral("pf-start"),
+                                       QJsonObject{{QStringLiteral("split_banks"), true}});
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        QCOMPARE(resp.value(QStringLiteral("result")).toObject().value(QStringLiteral("split_banks")).toBool(),
+                 true);
+
+        resp = sendCommand(QStringLiteral("debug.get_profile"), QStringLiteral("pf-get"),
+                           QJsonObject{{QStringLiteral("top"), 5}});
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        QJsonObject result = resp.value(QStringLiteral("result")).toObject();
+        QCOMPARE(result.value(QStringLiteral("profiling")).toBool(), true);
+        QCOMPARE(result.value(QStringLiteral("split_banks")).toBool(), true);
+        QVERIFY(result.value(QStringLiteral("addresses")).isArray());
+        QVERIFY(result.value(QStringLiteral("functions")).isArray());
+        QVERIFY(result.value(QStringLiteral("addresses")).toArray().size() <= 5);
+        for (const QJsonValue& row : result.value(QStringLiteral("addresses")).toArray()) {
+            QVERIFY(row.toObject().value(QStringLiteral("address")).toString().startsWith(QLatin1Char('$')));
+        }
+
+        resp = sendCommand(QStringLiteral("debug.profile_stop"), QStringLiteral("pf-stop"));
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        QCOMPARE(resp.value(QStringLiteral("result")).toObject().value(QStringLiteral("profiling")).toBool(),
+                 false);
+
+        resp = sendCommand(QStringLiteral("debug.profile_reset"), QStringLiteral("pf-reset"));
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        resp = sendCommand(QStringLiteral("debug.get_profile"), QStringLiteral("pf-empty"));
+        result = resp.value(QStringLiteral("result")).toObject();
+        QCOMPARE(result.value(QStringLiteral("cycles")).toInt(), 0);
+        QCOMPARE(result.value(QStringLiteral("addresses")).toArray().size(), 0);
+    }
+
+    void testAcceptsWhileGuiThreadBusy()
+    {
+        // Sockets live on the server's I/O thread: connecting and sending need no
+        // event processing here, only the response waits for the GUI thread
+        QTcpSocket second;
+        second.connectToHost(QHostAddress::LocalHost, m_port);
+        QVERIFY(second.waitForConnected(5000));
+        second.write("{\"command\":\"status.get_state\",\"id\":\"busy\"}\n");
+        QVERIFY(second.waitForBytesWritten(5000));
+        QThread::msleep(100);
+
+        QByteArray received;
+        QElapsedTimer t;
+        t.start();
+        while (!received.contains("\"busy\"") && t.elapsed() < 10000) {
+            QCoreApplication::processEvents();
+            if (second.waitForReadyRead(50)) {
+                received += second.readAll();
+            }
+        }
+        QVERIFY(received.contains("\"connected\""));
+        QVERIFY(received.contains("\"busy\""));
+        second.disconnectFromHost();
+    }
+
+    void testEventSubscriptionFiltersBroadcasts()
+    {
+        QJsonObject params;
+        params[QStringLiteral("events")] = QJsonArray{QStringLiteral("emulation_resumed")};
+        QJsonObject resp = sendCommand(QStringLiteral("config.subscribe_events"), QStringLiteral("sub-1"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+
+        m_seenEvents.clear();
+        sendCommand(QStringLiteral("system.pause"), QStringLiteral("sub-p"));
+        sendCommand(QStringLiteral("system.resume"), QStringLiteral("sub-r"));
+        // Events travel in order with responses, so both have arrived by now
+        resp = sendCommand(QStringLiteral("status.get_connection"), QStringLiteral("sub-c"));
+        QVERIFY(m_seenEvents.contains(QStringLiteral("emulation_resumed")));
+        QVERIFY(!m_seenEvents.contains(QStringLiteral("emulation_paused")));
+        const QJsonObject stats = resp.value(QStringLiteral("result")).toObject();
+        QCOMPARE(stats.value(QStringLiteral("events")).toArray().first().toString(),
+                 QStringLiteral("emulation_resumed"));
+        QVERIFY(stats.value(QStringLiteral("events_sent")).toInt() > 0);
+
+        resp = sendCommand(QStringLiteral("config.set_backpressure"), QStringLiteral("sub-bp"),
+                           QJsonObject{{QStringLiteral("policy"), QStringLiteral("hoard")}});
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+        resp = sendCommand(QStringLiteral("config.set_backpressure"), QStringLiteral("sub-bp2"),
+                           QJsonObject{{QStringLiteral("policy"), QStringLiteral("coalesce")},
+                                       {QStringLiteral("max_queued_kb"), 256}});
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+
+        params[QStringLiteral("events")] = QJsonArray{QStringLiteral("*")};
+        sendCommand(QStringLiteral("config.subscribe_events"), QStringLiteral("sub-all"), params);
+    }
+
+    void testJoystickStreamReportsFrameStampedChanges()
+    {
+        QJsonObject resp = sendCommand(QStringLiteral("input.start_joystick_stream"), QStringLiteral("js-start"));
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        QVERIFY(resp.value(QStringLiteral("result")).toObject().contains(QStringLiteral("current_frame")));
+
+        m_seenEvents.clear();
+        QJsonObject params{{QStringLiteral("player"), 2}, {QStringLiteral("direction"), QStringLiteral("LEFT")},
+                           {QStringLiteral("fire"), true}};
+        sendCommand(QStringLiteral("input.joystick"), QStringLiteral("js-set"), params);
+        // The change is reported once a frame has run with it
+        QElapsedTimer t;
+        t.start();
+        int poll = 0;
+        while (!m_seenEvents.contains(QStringLiteral("joystick_changed")) && t.elapsed() < 5000) {
+            sendCommand(QStringLiteral("input.get_joystick_stream_status"), QStringLiteral("js-poll-%1").arg(poll++));
+        }
+        QVERIFY(m_seenEvents.contains(QStringLiteral("joystick_changed")));
+
+        sendCommand(QStringLiteral("input.joystick_release"), QStringLiteral("js-rel"),
+                    QJsonObject{{QStringLiteral("player"), 2}});
+        resp = sendCommand(QStringLiteral("input.stop_joystick_stream"), QStringLiteral("js-stop"));
+        QVERIFY(!resp.value(QStringLiteral("result")).toObject().value(QStringLiteral("streaming")).toBool());
+        resp = sendCommand(QStringLiteral("input.get_joystick_stream_status"), QStringLiteral("js-status"));
+        QCOMPARE(resp.value(QStringLiteral("result")).toObject().value(QStringLiteral("total_streaming_clients")).toInt(), 0);
+    }
+
+    void testLocalSocketAndSharedState()
+    {
+        const QString name = QStringLiteral("fujisan-test-%1").arg(QCoreApplication::applicationPid());
+        m_tcp->setLocalServerName(name);
+        QVERIFY(!m_tcp->localServerPath().isEmpty());
+
+        // Same protocol over the local socket
+        QLocalSocket local;
+        local.connectToServer(m_tcp->localServerPath());
+        QVERIFY(local.waitForConnected(5000));
+        local.write("{\"command\":\"status.get_state\",\"id\":\"local\"}\n");
+        QByteArray received;
+        QElapsedTimer t;
+        t.start();
+        while (!received.contains("\"local\"") && t.elapsed() < 10000) {
+            QCoreApplication::processEvents();
+            if (local.waitForReadyRead(50)) {
+                received += local.readAll();
+            }
+        }
+        QVERIFY(received.contains("\"connected\""));
+        QVERIFY(received.contains("\"local_socket\""));
+        local.disconnectFromServer();
+        m_tcp->setLocalServerName(QString());
+        QVERIFY(m_tcp->localServerPath().isEmpty());
+
+        QJsonObject params{{QStringLiteral("name"), name},
+                           {QStringLiteral("ranges"), QJsonArray{QJsonObject{{QStringLiteral("address"), 0x0600},
+                                                                             {QStringLiteral("length"), 16}}}}};
+        QJsonObject resp = sendCommand(QStringLiteral("system.open_shared_state"), QStringLiteral("ss-open"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        const QString path = resp.value(QStringLiteral("result")).toObject().value(QStringLiteral("path")).toString();
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.read(4), QByteArray("FJSS"));
+        file.close();
+
+        resp = sendCommand(QStringLiteral("system.open_shared_state"), QStringLiteral("ss-bad"),
+                           QJsonObject{{QStringLiteral("name"), QStringLiteral("../escape")}});
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("error"));
+
+        sendCommand(QStringLiteral("system.close_shared_state"), QStringLiteral("ss-close"));
+        QVERIFY(!QFile::exists(path));
+    }
+
+    void testConfigSetFramingNewline()
+    {
+        QJsonObject params;
+        params[QStringLiteral("mode")] = QStringLiteral("newline");
+        QJsonObject resp = sendCommand(QStringLiteral("config.set_framing"), QStringLiteral("f1"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        QCOMPARE(resp.value(QStringLiteral("result")).toObject().value(QStringLiteral("mode")).toString(),
+                 QStringLiteral("newline"));
+
+        // sendCommand() already terminates each request with a newline
+        resp = sendCommand(QStringLiteral("status.get_state"), QStringLiteral("f2"));
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+
+        params[QStringLiteral("mode")] = QStringLiteral("json");
+        resp = sendCommand(QStringLiteral("config.set_framing"), QStringLiteral("f3"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+    }
+
+    void testConfigApplyRestartOnlyWhenNeeded()
+    {
+        QJsonObject params;
+        params[QStringLiteral("force")] = true;
+        QJsonObject resp = sendCommand(QStringLiteral("config.apply_restart"), QStringLiteral("ar1"), params);
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        QJsonObject result = resp.value(QStringLiteral("result")).toObject();
+        QCOMPARE(result.value(QStringLiteral("restarted")).toBool(), true);
+        QCOMPARE(result.value(QStringLiteral("restart_reasons")).toArray().first().toString(),
+                 QStringLiteral("forced"));
+
+        // The core was just booted from the saved settings: nothing needs a reinit
+        resp = sendCommand(QStringLiteral("config.apply_restart"), QStringLiteral("ar2"));
+        QCOMPARE(resp.value(QStringLiteral("status")).toString(), QStringLiteral("success"));
+        result = resp.value(QStringLiteral("result")).toObject();
+        QCOMPARE(result.value(QStringLiteral("restarted")).toBool(), false);
+        QCOMPARE(result.value(QStringLiteral("reason")).toString(), QStringLiteral("applied_live"));
+        QVERIFY(result.value(QStringLiteral("restart_reasons")).toArray().isEmpty());
+    }
+
     void testConfigSetHardDriveH4()
     {
         const QString hdir = m_tempDir.path() + QStringLiteral("/h4host");
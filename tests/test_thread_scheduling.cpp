@@ -0,0 +1,68 @@
+/*
+ * Fujisan Test Suite - Thread Scheduling Tests
+ *
+ * Verifies ThreadScheduling: priority names parse and print back, asking for
+ * normal priority on any CPU always succeeds and reports what was applied, and
+ * the sleep-then-spin wait returns after (never before) its deadline, also for
+ * deadlines that have already passed.
+ */
+
+#include "threadscheduling.h"
+
+#include <QtTest/QtTest>
+
+class TestThreadScheduling : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testPriorityNamesRoundTrip()
+    {
+        for (ThreadScheduling::Priority priority :
+             {ThreadScheduling::PriorityNormal, ThreadScheduling::PriorityHigh, ThreadScheduling::PriorityRealtime}) {
+            ThreadScheduling::Priority parsed = ThreadScheduling::PriorityNormal;
+            QVERIFY(ThreadScheduling::parsePriority(ThreadScheduling::priorityName(priority), &parsed));
+            QCOMPARE(parsed, priority);
+        }
+        ThreadScheduling::Priority unchanged = ThreadScheduling::PriorityHigh;
+        QVERIFY(!ThreadScheduling::parsePriority("urgent", &unchanged));
+        QCOMPARE(unchanged, ThreadScheduling::PriorityHigh);
+    }
+
+    void testNormalPriorityIsGranted()
+    {
+        const QJsonObject result =
+            ThreadScheduling::applyToCurrentThread(ThreadScheduling::PriorityNormal, -1, 16667);
+        QCOMPARE(result["priority"].toString(), QStringLiteral("normal"));
+        QCOMPARE(result["granted"].toString(), QStringLiteral("normal"));
+        QCOMPARE(result["cpu"].toInt(), -1);
+        QVERIFY(!result["scheduler"].toString().isEmpty());
+        QVERIFY(result.contains("affinity_applied"));
+        QVERIFY(ThreadScheduling::cpuCount() >= 1);
+    }
+
+    void testWaitUntilNeverReturnsEarly()
+    {
+        using namespace std::chrono;
+        ThreadScheduling::setHighResolutionTimer(true);
+        for (int delayUs : {200, 3000, 10000}) {
+            const auto deadline = steady_clock::now() + microseconds(delayUs);
+            ThreadScheduling::waitUntil(deadline);
+            const auto after = steady_clock::now();
+            QVERIFY(after >= deadline);
+            // Generous bound: only catches a wait that oversleeps by whole frames
+            QVERIFY(duration_cast<milliseconds>(after - deadline).count() < 50);
+        }
+        ThreadScheduling::setHighResolutionTimer(false);
+    }
+
+    void testPastDeadlineReturnsAtOnce()
+    {
+        using namespace std::chrono;
+        const auto start = steady_clock::now();
+        ThreadScheduling::waitUntil(start - milliseconds(5));
+        QVERIFY(duration_cast<milliseconds>(steady_clock::now() - start).count() < 50);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestThreadScheduling)
+#include "test_thread_scheduling.moc"
@@ -0,0 +1,193 @@
+/*
+ * Fujisan Test Suite - Trace Recorder Tests
+ *
+ * Verifies the ring file behind debug.trace_start: delta-encoded records
+ * decode back exactly and shrink straight-line code, long batches are split
+ * into chunks, the oldest chunks are overwritten once the ring wraps, tail()
+ * returns the newest records across chunks, and the header and chunk walk on
+ * disk read back with readFile() while recording and after stop().
+ */
+
+#include "tracerecorder.h"
+
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+#include <cstring>
+#include <vector>
+
+class TestTraceRecorder : public QObject {
+    Q_OBJECT
+
+private:
+    static TraceRecorder::RawRecord record(quint16 pc, quint8 opcode, quint8 a, quint8 x,
+                                           quint16 scanline, quint8 cycle)
+    {
+        TraceRecorder::RawRecord r = {};
+        r.pc = pc;
+        r.opcode = opcode;
+        r.a = a;
+        r.x = x;
+        r.s = 0xFF;
+        r.p = 0x30;
+        r.scanline = scanline;
+        r.cycle = cycle;
+        return r;
+    }
+
+    // Jumps all over with changing registers: close to the 12-byte worst case
+    static std::vector<TraceRecorder::RawRecord> noisy(int count, quint32 seed)
+    {
+        std::vector<TraceRecorder::RawRecord> records(static_cast<size_t>(count));
+        for (TraceRecorder::RawRecord& r : records) {
+            seed = seed * 1103515245u + 12345u;
+            r.pc = static_cast<quint16>(seed >> 8);
+            r.a = static_cast<quint8>(seed >> 3);
+            r.x = static_cast<quint8>(seed >> 11);
+            r.y = static_cast<quint8>(seed >> 19);
+            r.s = static_cast<quint8>(seed >> 5);
+            r.p = static_cast<quint8>(seed >> 13);
+            r.opcode = static_cast<quint8>(seed >> 21);
+            r.cycle = static_cast<quint8>(seed >> 7);
+            r.scanline = static_cast<quint16>((seed >> 16) % 312);
+            r.bank = 0;
+        }
+        return records;
+    }
+
+    static bool same(const TraceRecorder::RawRecord& a, const TraceRecorder::RawRecord& b)
+    {
+        return std::memcmp(&a, &b, sizeof(a)) == 0;
+    }
+
+private slots:
+    void testEncodeRoundTrip()
+    {
+        const TraceRecorder::RawRecord records[] = {
+            record(0x2000, 0xA9, 0x00, 0x03, 40, 17),  // LDA #$05
+            record(0x2002, 0x8D, 0x05, 0x03, 40, 20),  // STA $D40A
+            record(0x2005, 0xE8, 0x05, 0x03, 41, 2),   // INX
+            record(0x2006, 0xD0, 0x05, 0x04, 41, 4),   // BNE $2000
+            record(0x2000, 0xA9, 0x05, 0x04, 100, 7),  // taken: explicit PC and scanline
+        };
+        const int count = 5;
+        std::vector<unsigned char> encoded(static_cast<size_t>(TraceRecorder::maxEncodedBytes(count)));
+        const int bytes = TraceRecorder::encode(records, count, encoded.data());
+        // Full, then flags + opcode + cycle plus A, nothing, X, PC and scanline
+        QCOMPARE(bytes, 12 + 4 + 3 + 4 + 7);
+
+        TraceRecorder::RawRecord decoded[count];
+        QVERIFY(TraceRecorder::decode(encoded.data(), bytes, count, decoded));
+        for (int i = 0; i < count; ++i) {
+            QVERIFY2(same(decoded[i], records[i]), qPrintable(QString("record %1").arg(i)));
+        }
+        QVERIFY(!TraceRecorder::decode(encoded.data(), bytes - 1, count, decoded));
+    }
+
+    void testSplitsLongBatchesIntoChunks()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        TraceRecorder recorder;
+        QVERIFY(recorder.start(dir.path() + "/split.ftr", 0));  // raised to the minimum
+        QVERIFY(recorder.isRecording());
+
+        const std::vector<TraceRecorder::RawRecord> records = noisy(10000, 1);
+        recorder.append(7, records.data(), 10000, 3);
+        QJsonObject status = recorder.status();
+        QCOMPARE(status["chunks"].toInt(), 3);
+        QCOMPARE(status["records"].toInt(), 10000);
+        QCOMPARE(status["dropped"].toInt(), 3);
+        QCOMPARE(static_cast<qint64>(status["ring_bytes"].toDouble()), qint64(TraceRecorder::kMinRingBytes));
+
+        const QVector<TraceRecorder::Entry> tail = recorder.tail(5000);
+        QCOMPARE(tail.size(), 5000);
+        QCOMPARE(tail.first().frame, quint64(7));
+        QVERIFY(same(tail.first().record, records[5000]));
+        QVERIFY(same(tail.last().record, records[9999]));
+    }
+
+    void testWrapOverwritesOldestChunks()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.path() + "/wrap.ftr";
+        TraceRecorder recorder;
+        QVERIFY(recorder.start(path, TraceRecorder::kMinRingBytes));
+
+        // ~48 KB a frame: the 1 MB ring holds about 21 of 40
+        const int perFrame = 4096;
+        std::vector<TraceRecorder::RawRecord> last;
+        for (int frame = 0; frame < 40; ++frame) {
+            last = noisy(perFrame, static_cast<quint32>(frame) + 100);
+            recorder.append(static_cast<quint64>(frame), last.data(), perFrame);
+        }
+        const QJsonObject status = recorder.status();
+        QVERIFY(status["wrapped"].toBool());
+        QCOMPARE(status["records"].toInt(), 40 * perFrame);
+        const int retained = status["retained_records"].toInt();
+        QVERIFY(retained < 40 * perFrame);
+        QVERIFY(retained > 10 * perFrame);
+        QVERIFY(status["used_bytes"].toDouble() <= TraceRecorder::kMinRingBytes);
+
+        QVector<TraceRecorder::Entry> onDisk;
+        QString error;
+        QVERIFY2(TraceRecorder::readFile(path, &onDisk, &error), qPrintable(error));
+        QCOMPARE(onDisk.size(), retained);
+        QCOMPARE(onDisk.last().frame, quint64(39));
+        QVERIFY(onDisk.first().frame > 0);
+        QVERIFY(same(onDisk.last().record, last.back()));
+
+        const QVector<TraceRecorder::Entry> tail = recorder.tail(retained + 100);
+        QCOMPARE(tail.size(), retained);
+        QCOMPARE(tail.first().frame, onDisk.first().frame);
+        QVERIFY(same(tail.first().record, onDisk.first().record));
+    }
+
+    void testFileReadableAfterStop()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.path() + "/stop.ftr";
+        TraceRecorder recorder;
+        QVERIFY(recorder.start(path, TraceRecorder::kMinRingBytes));
+        const TraceRecorder::RawRecord first = record(0x0600, 0xEA, 1, 2, 8, 9);
+        recorder.append(1, &first, 1);
+
+        QVector<TraceRecorder::Entry> entries;
+        QVERIFY(TraceRecorder::readFile(path, &entries));
+        QCOMPARE(entries.size(), 1);
+
+        recorder.stop();
+        QVERIFY(!recorder.isRecording());
+        recorder.append(2, &first, 1);  // ignored once stopped
+        QCOMPARE(recorder.tail(10).size(), 1);
+        QVERIFY(TraceRecorder::readFile(path, &entries));
+        QCOMPARE(entries.size(), 1);
+        QVERIFY(same(entries.first().record, first));
+        QCOMPARE(recorder.status()["recording"].toBool(), false);
+    }
+
+    void testRejectsBadFiles()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        TraceRecorder recorder;
+        QString error;
+        QVERIFY(!recorder.start(dir.path() + "/missing/dir/trace.ftr", TraceRecorder::kMinRingBytes, &error));
+        QVERIFY(!error.isEmpty());
+        QVERIFY(!recorder.isRecording());
+
+        const QString path = dir.path() + "/other.bin";
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QByteArray(128, 'x'));
+        file.close();
+        QVector<TraceRecorder::Entry> entries;
+        error.clear();
+        QVERIFY(!TraceRecorder::readFile(path, &entries, &error));
+        QVERIFY(error.contains("Not a Fujisan trace file"));
+    }
+};
+
+QTEST_MAIN(TestTraceRecorder)
+#include "test_trace_recorder.moc"